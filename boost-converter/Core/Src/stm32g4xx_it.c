@@ -90,6 +90,7 @@ void NMI_Handler(void)
 void HardFault_Handler(void)
 {
   /* USER CODE BEGIN HardFault_IRQn 0 */
+  EVERT_FAULT_RECORD_CAPTURE_FAULT(FRT_HARD_FAULT);
   EVERT_BOOST_CONVERTER_hal_error("HardFault_Handler");
   /* USER CODE END HardFault_IRQn 0 */
   while (1)
@@ -105,7 +106,8 @@ void HardFault_Handler(void)
 void MemManage_Handler(void)
 {
   /* USER CODE BEGIN MemoryManagement_IRQn 0 */
-
+  EVERT_FAULT_RECORD_CAPTURE_FAULT(FRT_MEM_MANAGE);
+  EVERT_BOOST_CONVERTER_hal_error("MemManage_Handler");
   /* USER CODE END MemoryManagement_IRQn 0 */
   while (1)
   {
@@ -120,6 +122,7 @@ void MemManage_Handler(void)
 void BusFault_Handler(void)
 {
   /* USER CODE BEGIN BusFault_IRQn 0 */
+  EVERT_FAULT_RECORD_CAPTURE_FAULT(FRT_BUS_FAULT);
   EVERT_BOOST_CONVERTER_hal_error("BusFault_Handler");
   /* USER CODE END BusFault_IRQn 0 */
   while (1)
@@ -135,6 +138,7 @@ void BusFault_Handler(void)
 void UsageFault_Handler(void)
 {
   /* USER CODE BEGIN UsageFault_IRQn 0 */
+  EVERT_FAULT_RECORD_CAPTURE_FAULT(FRT_USAGE_FAULT);
   EVERT_BOOST_CONVERTER_hal_error("UsageFault_Handler");
   /* USER CODE END UsageFault_IRQn 0 */
   while (1)
@@ -289,4 +293,12 @@ void LPUART1_IRQHandler(void)
 
 /* USER CODE BEGIN 1 */
 
+/**
+  * @brief This function handles the window watchdog early wakeup interrupt (one count before the reset).
+  */
+void WWDG_IRQHandler(void)
+{
+  EVERT_WATCHDOG_OnEarlyWakeup();
+}
+
 /* USER CODE END 1 */
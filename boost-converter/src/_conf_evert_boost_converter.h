@@ -20,6 +20,60 @@
 #define EVERT_CONSTRAINT_BC_DUTY_CYCLE_MPPT_MIN 0.1f
 #define EVERT_CONSTRAINT_BC_DUTY_CYCLE_MPPT_MAX 0.8f
 
+// ISR timing
+#define EVERT_CONSTANT_BC_ISR_HF_PERIOD (1.0f / 10000.0f) // htim2, 10 kHz
+#define EVERT_CONSTANT_BC_ISR_LF_PERIOD_MS (10.0f)         // htim3, 100 Hz
+
+// MPPT (operating point is the PV voltage reference of the control loops)
+#define EVERT_SETTING_BC_MPPT_ALGORITHM BCMA_PERTURB_AND_OBSERVE
+#define EVERT_SETTING_BC_MPPT_OBSERVE_INTERVAL_MS (100.0f)           // Settle time between perturbations
+#define EVERT_SETTING_BC_MPPT_OPERATING_POINT_MARGIN (5.0f)         // V, inside the input voltage warnings
+#define EVERT_SETTING_BC_MPPT_OPERATING_POINT_MIN (EVERT_CONSTRAINT_BC_VOLTAGE_IN_LOW_WARNING + EVERT_SETTING_BC_MPPT_OPERATING_POINT_MARGIN)
+#define EVERT_SETTING_BC_MPPT_OPERATING_POINT_MAX (EVERT_CONSTRAINT_BC_VOLTAGE_IN_HIGH_WARNING - EVERT_SETTING_BC_MPPT_OPERATING_POINT_MARGIN)
+#define EVERT_SETTING_BC_MPPT_VOLTAGE_DIRECTION (1.0f)               // Sign of dVpv/d(operating point)
+#define EVERT_SETTING_BC_MPPT_STEP_MIN (0.2f)                        // V
+#define EVERT_SETTING_BC_MPPT_STEP_MAX (5.0f)                        // V
+#define EVERT_SETTING_BC_MPPT_STEP_SCALE_PO (0.2f)                   // V per W/V, variable-step P&O
+#define EVERT_SETTING_BC_MPPT_STEP_SCALE_INC (0.2f)                  // V per W/V, incremental conductance
+#define EVERT_SETTING_BC_MPPT_INC_TOLERANCE (0.002f)                 // |dI/dV + I/V| below this is considered at the MPP
+#define EVERT_SETTING_BC_MPPT_DELTA_EPSILON (0.0001f)                // Deltas below this are treated as zero
+#define EVERT_SETTING_BC_MPPT_POWER_OPEN_CIRCUIT (5.0f)               // W, below this the string is taken as open circuit
+#define EVERT_SETTING_BC_MPPT_SWEEP_INTERVAL_MS (300000.0f)          // Global sweep every 5 minutes, 0 = disabled
+#define EVERT_SETTING_BC_MPPT_SWEEP_STEPS (24)
+#define EVERT_SETTING_BC_MPPT_OSCILLATION_WINDOW (16)
+#define EVERT_SETTING_BC_MPPT_OSCILLATION_THRESHOLD (0.3f)
+#define EVERT_SETTING_BC_MPPT_POWER_LIMIT_BAND (0.03f) // Hold the operating point within this fraction below the power limit
+#define EVERT_SETTING_BC_DISPATCH_TIMEOUT_MS (2000.0f)   // No batch limit from the CCU this long: unlimited, warnings throttle locally again
+
+// Control loops (10 kHz)
+#define EVERT_SETTING_BC_CONTROL_VOLTAGE_KP (0.5f)                   // A/V
+#define EVERT_SETTING_BC_CONTROL_VOLTAGE_KI (50.0f)                  // A/(V*s)
+#define EVERT_SETTING_BC_CONTROL_CURRENT_KP (0.02f)                  // 1/A
+#define EVERT_SETTING_BC_CONTROL_CURRENT_KI (20.0f)                  // 1/(A*s)
+#define EVERT_SETTING_BC_CONTROL_CURRENT_MAX EVERT_CONSTRAINT_BC_CURRENT_HIGH_WARNING
+#define EVERT_SETTING_BC_CONTROL_CURRENT_SLEW_RATE (500.0f)          // A/s, limits the current reference on irradiance steps
+
+// Interleaving / current sharing (paralleled converters, phase index = CAN device id - 1)
+#define EVERT_CONSTANT_BC_INTERLEAVE_PHASE_MAX (4)                   // Size of the peer table of the current share
+#define EVERT_SETTING_BC_INTERLEAVE_PHASE_COUNT (2)
+#define EVERT_SETTING_BC_INTERLEAVE_HRTIM_SYNC (1)                   // BC1 drives HRTIM SCOUT, the others reset on SCIN
+#define EVERT_SETTING_BC_INTERLEAVE_SHARED_INPUT (0)                 // The phases on one PV input share its current, separate strings keep their own MPPT
+#define EVERT_SETTING_BC_SHARE_KP (0.1f)                             // A/A
+#define EVERT_SETTING_BC_SHARE_KI (1.0f)                             // A/(A*s)
+#define EVERT_SETTING_BC_SHARE_TRIM_MAX (1.0f)                       // A, max correction on the current reference
+#define EVERT_SETTING_BC_SHARE_PEER_TIMEOUT_MS (500)                 // Peer current older than this disables the trim
+
+// Delta telemetry (boost_converter_telemetry.h, sampled by the data task)
+#define EVERT_SETTING_BC_TELEMETRY_KEYFRAME_INTERVAL (10)             // Samples per keyframe, 1 s at EVERT_SETTING_DEVICE_TASK_SEND_DATA_INTERVAL
+
+// Firmware update (boost_converter_update.h)
+#define EVERT_SETTING_BC_UPDATE_ACK_INTERVAL (16)                     // Blocks per BCCM_UPDATE_STATUS while receiving
+
+// Watchdog supervisor (watchdog.h, IWDG timeout and WWDG window in _conf_evert_hal.h)
+#define EVERT_SETTING_BC_WATCHDOG_LOOP_DEADLINE_MS (20)
+#define EVERT_SETTING_BC_WATCHDOG_ISR_HF_DEADLINE_MS (5)              // 10 kHz, the WWDG holds the exact window
+#define EVERT_SETTING_BC_WATCHDOG_ISR_LF_DEADLINE_MS (50)             // 100 Hz
+
 #define EVERT_CONSTRAINT_BC_VOLTAGE_OUT_HYSTERESIS 50.0f
 #define EVERT_CONSTRAINT_BC_VOLTAGE_OUT_HIGH_CRITICAL 900.0f
 #define EVERT_CONSTRAINT_BC_VOLTAGE_OUT_HIGH_WARNING 800.0f
@@ -4,13 +4,16 @@
 // Constants (hardware specific)
 #define EVERT_CONSTANT_DEVICE_FREQUENCY_HRCK (170000000)
 #define EVERT_CONSTANT_DEVICE_MCU_VOLTAGE (3300)
-#define EVERT_CONSTANT_DEVICE_ADC_BOOT_TIME (1000)
+#define EVERT_CONSTANT_DEVICE_ADC_BOOT_TIME (1000) // Upper bound of DS_BOOTING_ADC, the readings settle by sample count well before
+#define EVERT_CONSTANT_DEVICE_EVENT_QUEUE_SIZE (16) // Power of 2
 
 // Settings (software adjustable)
 #define EVERT_SETTING_DEVICE_TASK_SEND_ANNOUNCEMENT_INTERVAL (1000)
 #define EVERT_SETTING_DEVICE_TASK_SEND_DATA_INTERVAL (100)
 #define EVERT_SETTING_DEVICE_TASK_SEND_PING_INTERVAL (1000)
 #define EVERT_SETTING_DEVICE_TASK_SEND_STATUS_INTERVAL (100)
+#define EVERT_SETTING_DEVICE_HEARTBEAT_TIMEOUT (3000) // CCU heartbeat, 0 = not supervised
+#define EVERT_SETTING_DEVICE_RECOVERY_TIME (500)      // Alarms below non-operational this long before DS_NON_OPERATIONAL recovers
 
 // Constraints (hardware specific / software adjustable)
 #define EVERT_CONSTRAINT_DEVICE_CPU_TEMP_HYSTERESIS (2.5f)
@@ -16,4 +16,50 @@
 #define EVERT_HAL_CONF_FZ2812_ENABLE (false)
 #define EVERT_HAL_CONF_FZ2812_COUNT (0)
 
+// Scope (waveform capture)
+#define EVERT_HAL_CONF_SCOPE_ENABLE (false)
+#define EVERT_HAL_CONF_SCOPE_CHANNEL_COUNT (0)
+
+// Telemetry (binary records over UART TX DMA, two buffers of BUFFER_SIZE bytes)
+#define EVERT_HAL_CONF_TELEMETRY_ENABLE (false)
+#define EVERT_HAL_CONF_TELEMETRY_BUFFER_SIZE (0)
+#define EVERT_HAL_CONF_TELEMETRY_PAYLOAD_MAX (0)
+
+// Delta telemetry (signals quantized and delta encoded over CAN, the table in boost_converter_telemetry.c)
+#define EVERT_HAL_CONF_DELTA_TELEMETRY_ENABLE (true)
+#define EVERT_HAL_CONF_DELTA_TELEMETRY_SIGNAL_COUNT (48)
+
+// Variable registry (remote read/write/subscribe, .evert_registry section in the linker script)
+#define EVERT_HAL_CONF_REGISTRY_ENABLE (true)
+#define EVERT_HAL_CONF_REGISTRY_SUBSCRIPTION_COUNT (16)
+
+// Fault record (.noinit RAM, fault log in the 4 kB below the parameter store, see FAULTS in the linker script)
+#define EVERT_HAL_CONF_FAULT_RECORD_ENABLE (true)
+#define EVERT_HAL_CONF_FAULT_RECORD_ADDRESS (0x0807D000)
+#define EVERT_HAL_CONF_FAULT_RECORD_REGION_SIZE (0x1000)
+#define EVERT_HAL_CONF_FAULT_RECORD_EVENT_COUNT (16)
+#define EVERT_HAL_CONF_FAULT_RECORD_RESET (true) // Reset after a capture unless a debugger is attached
+
+// Watchdog supervisor (IWDG on the task checkpoints, WWDG on the HF ISR timing window)
+#define EVERT_HAL_CONF_WATCHDOG_ENABLE (true)
+#define EVERT_HAL_CONF_WATCHDOG_CHECKPOINT_COUNT (8)
+#define EVERT_HAL_CONF_WATCHDOG_IWDG_TIMEOUT_MS (100)
+#define EVERT_HAL_CONF_WATCHDOG_WWDG_ENABLE (true)
+#define EVERT_HAL_CONF_WATCHDOG_WWDG_DIVIDER (10) // HF ISR calls per refresh, 1 ms at 10 kHz
+#define EVERT_HAL_CONF_WATCHDOG_WWDG_PRESCALER (LL_WWDG_PRESCALER_4) // 4096 * 4 / 170 MHz = 96 us per count, reset after 6.2 ms
+#define EVERT_HAL_CONF_WATCHDOG_WWDG_WINDOW (0x7A) // No refresh within 5 counts (0.48 ms) of the last
+
+// Time synchronization (SYNC/FOLLOW-UP from the CCU over CAN)
+#define EVERT_HAL_CONF_TIME_SYNC_ENABLE (true)
+
+// Parameter store (last 8 kB of flash, bank 2 in dual bank mode, see PARAMS in the linker script)
+#define EVERT_HAL_CONF_PARAM_STORE_ENABLE (true)
+#define EVERT_HAL_CONF_PARAM_STORE_ADDRESS (0x0807E000)
+#define EVERT_HAL_CONF_PARAM_STORE_REGION_SIZE (0x1000)
+#define EVERT_HAL_CONF_PARAM_STORE_KEY_COUNT (64)
+
+// Firmware update (A/B bank slots behind the bootloader, firmware_image.h)
+#define EVERT_HAL_CONF_FIRMWARE_UPDATE_ENABLE (true)
+#define EVERT_HAL_CONF_FIRMWARE_UPDATE_TRIAL_TIMEOUT_MS (300000) // New image not operational within 5 min: back to the old one
+
 #endif // EVERT_HAL_CONF_
\ No newline at end of file
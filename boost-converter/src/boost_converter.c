@@ -8,13 +8,19 @@
  *              * boost_converter_alarms.h (alarms) | boost_converter_alarms.c
  *              * boost_converter_calibration.h
  *              * boost_converter_constraints.h
+ *              * boost_converter_control.h (voltage/current loops) | boost_converter_control.c
+ *              * boost_converter_interleave.h (interleaving/current sharing) | boost_converter_interleave.c
  *              * boost_converter_mppt.h (MPPT) | boost_converter_mppt.c
+ *              * boost_converter_parameters.h (persistent calibrations/constraints) | boost_converter_parameters.c
+ *              * boost_converter_protocol.h (CAN methods)
  *              * boost_converter_readings.h (readings) | boost_converter_readings.c
+ *              * boost_converter_update.h (firmware update over CAN) | boost_converter_update.c
  *
  ******************************************************************************
  **/
 
 // std/ST includes
+#include <string.h>
 #include "stm32g4xx_hal.h"
 #include "stm32g4xx_hal_hrtim.h"
 
@@ -62,17 +68,26 @@ static volatile bool adc_completed[1] = {false};
 /// @return 0 if successful
 int EVERT_BOOST_CONVERTER_main()
 {
+    // Running image first: on its first boot after an update it takes the fault log and the parameters over
+    EVERT_BOOST_CONVERTER_UpdateInit();
+
+    // Move a fault record left by the last reset to flash before anything can fault again
+    EVERT_FAULT_RECORD_Init();
+
     HAL_DMA_RegisterCallback(&hdma_adc1, HAL_DMA_XFER_ERROR_CB_ID, HAL_DMA_ErrorCallback);
 
     // Check the ID selection
     io_state.id_selection = HAL_GPIO_ReadPin(EVERT_BOOST_CONVERTER_GPIO_DEF_ID_SELECTION.port, EVERT_BOOST_CONVERTER_GPIO_DEF_ID_SELECTION.pin);
 
+    EVERT_CAN_DeviceIdentifierTypeDef device_id = io_state.id_selection == GPIO_PIN_RESET ? CAN_DEVICE_IDENTIFIER_BOOST_CONVERTER1 : CAN_DEVICE_IDENTIFIER_BOOST_CONVERTER2;
+
     // Initialize the time
     time.start_time = HAL_GetTick();
 
     // Initialize sub-systems
     EVERT_BOOST_CONVERTER_InitCalibrations();
     EVERT_BOOST_CONVERTER_InitConstraints();
+    EVERT_BOOST_CONVERTER_ParametersInit();
     EVERT_BOOST_CONVERTER_InitFilters();
     EVERT_BOOST_CONVERTER_InitAlarmRegister();
     EVERT_DEVICE_SetVersionInfo(DEVICE_VERSION_MAJOR, DEVICE_VERSION_MINOR, DEVICE_VERSION_PATCH);
@@ -85,16 +100,33 @@ int EVERT_BOOST_CONVERTER_main()
     HAL_TIM_Base_Start_IT(&htim2); // 10 kHz (HF ISR)
     HAL_TIM_Base_Start_IT(&htim3); // 100 Hz (LF ISR)
 
-    // Start PWM output/timer
+    // Preload the compare register and transfer it on roll-over, so duty updates never cut a period short
+    hhrtim1.Instance->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_A].TIMxCR |= HRTIM_TIMCR_PREEN | HRTIM_TIMCR_TRSTU;
+
+    // Phase shift the carrier by 360°/N against the paralleled units
+    EVERT_BOOST_CONVERTER_InterleaveInit(device_id - CAN_DEVICE_IDENTIFIER_BOOST_CONVERTER1);
+
+    // Start PWM output/timer (the master timer is the carrier reference for TIMER_A)
     HAL_HRTIM_WaveformOutputStart(&hhrtim1, HRTIM_OUTPUT_TA1);
-    HAL_HRTIM_WaveformCounterStart(&hhrtim1, HRTIM_TIMERID_TIMER_A);
+    HAL_HRTIM_WaveformCounterStart(&hhrtim1, HRTIM_TIMERID_MASTER | HRTIM_TIMERID_TIMER_A);
 
     // Start the mppt-control
     EVERT_BOOST_CONVERTER_SetDutyCycle(0.0f);
+    EVERT_BOOST_CONVERTER_ControlInit();
     EVERT_BOOST_CONVERTER_MpptInit();
 
-    EVERT_CAN_DeviceIdentifierTypeDef device_id = io_state.id_selection == GPIO_PIN_RESET ? CAN_DEVICE_IDENTIFIER_BOOST_CONVERTER1 : CAN_DEVICE_IDENTIFIER_BOOST_CONVERTER2;
+    EVERT_TIME_SYNC_Init();
     EVERT_CAN_Handler_Init(&hfdcan1, &can_handler, device_id, rx_fifo_items, tx_fifo_items, EVERT_CONSTRAINT_CAN_BUFFER_SIZE);
+    EVERT_BOOST_CONVERTER_RegistryInit();
+    EVERT_BOOST_CONVERTER_TelemetryInit();
+    EVERT_BOOST_CONVERTER_FaultInit();
+
+    // Supervisor last, the deadlines run from here
+    EVERT_WATCHDOG_Init();
+    EVERT_WATCHDOG_Register(BCWC_LOOP, "Loop", EVERT_SETTING_BC_WATCHDOG_LOOP_DEADLINE_MS);
+    EVERT_WATCHDOG_Register(BCWC_ISR_HF, "HF ISR", EVERT_SETTING_BC_WATCHDOG_ISR_HF_DEADLINE_MS);
+    EVERT_WATCHDOG_Register(BCWC_ISR_LF, "LF ISR", EVERT_SETTING_BC_WATCHDOG_ISR_LF_DEADLINE_MS);
+    EVERT_WATCHDOG_Start();
 
     return 0;
 }
@@ -107,6 +139,9 @@ void EVERT_BOOST_CONVERTER_loop()
     time.elapsed_time = time.current_time - time.start_time;
     time.delta_time = time.current_time - time.last_time;
 
+    EVERT_WATCHDOG_Checkin(BCWC_LOOP);
+    EVERT_WATCHDOG_Process();
+
     EVERT_DEVICE_Update(time.elapsed_time, time.delta_time);
 
     // Process the CAN messages
@@ -117,6 +152,13 @@ void EVERT_BOOST_CONVERTER_loop()
         EVERT_HAL_BreakPoint("Error processing RX buffer\n");
     }
 
+    // Registry subscriptions, telemetry frames, fault record chunks and the update status go out with this pass over the TX buffer
+    EVERT_BOOST_CONVERTER_RegistryProcess(time.delta_time);
+    EVERT_BOOST_CONVERTER_TelemetryProcess();
+    EVERT_BOOST_CONVERTER_FaultProcess();
+    EVERT_PARAM_STORE_Process();
+    EVERT_BOOST_CONVERTER_UpdateProcess();
+
     EVERT_CAN_ProcessBufferStatusTypeDef txStatus = EVERT_CAN_Handler_ProcessTxBuffer(&can_handler);
 
     if (txStatus != CAN_PBS_OK && txStatus != CAN_PBS_IDLE && txStatus != CAN_PBS_WAITING_FOR_INTERNAL_BUFFER)
@@ -124,6 +166,14 @@ void EVERT_BOOST_CONVERTER_loop()
         EVERT_HAL_BreakPoint("Error processing TX buffer\n");
     }
 
+    // Bus load and error counters once per statistics window, then the peripheral status from them
+    if (EVERT_CAN_Handler_UpdateStatistics(&can_handler, time.delta_time))
+    {
+        EVERT_DEVICE_PeripheralStatus_Update();
+    }
+
+    EVERT_TIME_SYNC_Process();
+
     time.last_time = time.current_time;
 }
 
@@ -160,9 +210,8 @@ void EVERT_BOOST_CONVERTER_SetDutyCycle(float32_t duty_cycle)
         compare_value = HRTIMER_COMPARE_MAX;
     }
 
-    // Set the new compare value
+    // Set the new compare value (preloaded, takes effect at the next period)
     __HAL_HRTIM_SETCOMPARE(&hhrtim1, HRTIM_TIMERINDEX_TIMER_A, HRTIM_COMPAREUNIT_1, compare_value);
-    hhrtim1.Instance->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_A].CNTxR = 0;
 }
 
 // __weak Callbacks - Alarms
@@ -188,21 +237,180 @@ void __overrides EVERT_BOOST_CONVERTER_AlarmChangedState(EVERT_BOOST_CONVERTER_A
     }
 }
 
+/// @brief Any of the listed alarms set
+static bool EVERT_BOOST_CONVERTER_IsAnyAlarmSet(const EVERT_BOOST_CONVERTER_AlarmIndexTypeDef *alarms, const uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (EVERT_SR_IsBitSet(&alarm_register, alarms[i]))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/// @brief Send the device state, [1] result, [2] internal, [3] propagated, [4..6] version
+static void EVERT_BOOST_CONVERTER_SendDeviceState()
+{
+    uint8_t data[7] = {
+        BCCM_DEVICE_STATE,
+        EVERT_DEVICE_State_Get(SS_RESULT),
+        EVERT_DEVICE_State_Get(SS_INTERNAL),
+        EVERT_DEVICE_State_Get(SS_PROPAGATED),
+        DEVICE_VERSION_MAJOR,
+        DEVICE_VERSION_MINOR,
+        DEVICE_VERSION_PATCH};
+
+    if (EVERT_CAN_Handler_Transmit(&can_handler, sizeof(data), data) != CAN_FS_OK)
+    {
+        EVERT_HAL_BreakPoint("CAN Error: Device State\n");
+    }
+}
+
 // __weak Callbacks - CAN
 void __overrides EVERT_CAN_OnMessageReceived(EVERT_CAN_HandlerTypeDef *handler, const EVERT_CAN_FrameTypeDef frame)
 {
     UNUSED(handler);
     UNUSED(frame);
 
+    // Addressed to another node, broadcasts (target 0) go to everyone
+    if (frame.identifier.target_id != CAN_DEVICE_IDENTIFIER_UNIDENTIFIED && frame.identifier.target_id != handler->identifier.source_id)
+    {
+        return;
+    }
+
     if (frame.data.length > 0)
     {
         uint32_t method = frame.data.data[0];
         uint32_t param1 = frame.data.data[1];
 
-        if (method == 1)
+        if (method == BCCM_SET_RUNNING)
         {
             mppt_state.status = param1 == 0 ? BCS_STANDBY : BCS_RUNNING;
         }
+        else if (method == BCCM_INTERLEAVE_CONFIG)
+        {
+            EVERT_BOOST_CONVERTER_InterleaveSetPhase(param1, frame.data.data[2]);
+        }
+        else if (method == BCCM_CURRENT_SHARE && frame.data.length >= 7 && frame.identifier.source_id != handler->identifier.source_id)
+        {
+            float32_t current;
+            memcpy(&current, &frame.data.data[1], sizeof(current));
+            EVERT_BOOST_CONVERTER_InterleaveOnPeerCurrent(frame.data.data[5], current, frame.data.data[6] != 0);
+        }
+        else if (method == BCCM_PARAM_READ)
+        {
+            EVERT_BOOST_CONVERTER_ParametersOnRead(param1);
+        }
+        else if (method == BCCM_PARAM_WRITE && frame.data.length >= 7)
+        {
+            float32_t value;
+            memcpy(&value, &frame.data.data[3], sizeof(value));
+            EVERT_BOOST_CONVERTER_ParametersOnWrite(param1, value);
+        }
+        else if (method == BCCM_PARAM_ERASE)
+        {
+            EVERT_BOOST_CONVERTER_ParametersOnErase(param1);
+        }
+        else if (method == BCCM_FAULT_READ)
+        {
+            EVERT_BOOST_CONVERTER_FaultOnRead(param1);
+        }
+        else if (method == BCCM_UPDATE_BEGIN && frame.data.length >= 5)
+        {
+            uint32_t size;
+            memcpy(&size, &frame.data.data[1], sizeof(size));
+            EVERT_BOOST_CONVERTER_UpdateOnBegin(size);
+        }
+        else if (method == BCCM_UPDATE_DATA && frame.data.length >= 2)
+        {
+            EVERT_BOOST_CONVERTER_UpdateOnData(frame.identifier.message_id, &frame.data.data[1], frame.data.length - 1);
+        }
+        else if (method == BCCM_UPDATE_END)
+        {
+            EVERT_BOOST_CONVERTER_UpdateOnEnd();
+        }
+        else if (method == BCCM_UPDATE_ACTIVATE)
+        {
+            EVERT_BOOST_CONVERTER_UpdateOnActivate();
+        }
+        else if (method == BCCM_DEVICE_ACK)
+        {
+            EVERT_DEVICE_PostEvent(DE_HANDSHAKE_ACK);
+        }
+        else if (method == BCCM_DEVICE_HEARTBEAT && frame.data.length >= 2)
+        {
+            EVERT_DEVICE_Heartbeat(param1 <= DS_EMERGENCY_SHUTDOWN ? (EVERT_DEVICE_StateTypeDef)param1 : DS_UNKNOWN);
+        }
+        else if (method == BCCM_DEVICE_RESET)
+        {
+            EVERT_DEVICE_PostEvent(DE_RESET);
+        }
+        else if (method == BCCM_POWER_LIMIT && frame.data.length >= 5)
+        {
+            float32_t power_limit;
+            memcpy(&power_limit, &frame.data.data[1], sizeof(power_limit));
+            EVERT_BOOST_CONVERTER_MpptSetPowerLimit(power_limit == power_limit ? power_limit : -1.0f); // NaN: unlimited
+        }
+        else if (method == BCCM_POWER_LIMIT_BATCH && frame.data.length >= 7)
+        {
+            // Three devices per frame, the message id selects the group
+            int32_t slot = (int32_t)handler->identifier.source_id - 1 - 3 * (int32_t)frame.identifier.message_id;
+
+            if (slot >= 0 && slot < 3)
+            {
+                uint16_t power_limit;
+                memcpy(&power_limit, &frame.data.data[1 + 2 * slot], sizeof(power_limit));
+
+                if (power_limit != 0xFFFE)
+                {
+                    EVERT_BOOST_CONVERTER_MpptDispatch(power_limit == 0xFFFF ? -1.0f : (float32_t)power_limit);
+                }
+            }
+        }
+        else if (method == BCCM_TIME_SYNC)
+        {
+            // The message id is the sequence, the start of frame is the local time of the SYNC
+            EVERT_TIME_SYNC_OnSync(frame.identifier.message_id, handler->rx_timestamp);
+        }
+        else if (method == BCCM_TIME_FOLLOW_UP && frame.data.length >= 7)
+        {
+            uint64_t master_us = 0;
+            memcpy(&master_us, &frame.data.data[1], 6);
+            EVERT_TIME_SYNC_OnFollowUp(frame.identifier.message_id, master_us);
+        }
+        else if (method == BCCM_TELEMETRY_LIST && frame.data.length >= 2)
+        {
+            EVERT_BOOST_CONVERTER_TelemetryOnList(param1);
+        }
+        else if (method >= BCCM_VAR_READ && method <= BCCM_VAR_LIST && frame.data.length >= 3)
+        {
+            uint16_t id;
+            memcpy(&id, &frame.data.data[1], sizeof(id));
+
+            if (method == BCCM_VAR_READ)
+            {
+                EVERT_BOOST_CONVERTER_RegistryOnRead(id);
+            }
+            else if (method == BCCM_VAR_WRITE && frame.data.length >= 7)
+            {
+                uint32_t value;
+                memcpy(&value, &frame.data.data[3], sizeof(value));
+                EVERT_BOOST_CONVERTER_RegistryOnWrite(id, value);
+            }
+            else if (method == BCCM_VAR_SUBSCRIBE && frame.data.length >= 5)
+            {
+                uint16_t period_ms;
+                memcpy(&period_ms, &frame.data.data[3], sizeof(period_ms));
+                EVERT_BOOST_CONVERTER_RegistryOnSubscribe(id, period_ms);
+            }
+            else if (method == BCCM_VAR_LIST)
+            {
+                EVERT_BOOST_CONVERTER_RegistryOnList(id);
+            }
+        }
     }
 
     // if (frame.identifier.target_id == &handler->identifier)
@@ -221,24 +429,76 @@ void __overrides EVERT_CAN_OnErrorReceived(EVERT_CAN_HandlerTypeDef *handler)
 // __weak Callbacks - State
 void __overrides EVERT_DEVICE_Derived_OnDeviceStateChange(const EVERT_DEVICE_StateTypeDef new_state, const EVERT_DEVICE_StateTypeDef old_state)
 {
-    UNUSED(new_state);
     UNUSED(old_state);
+
+    // An image on trial is kept once the device got operational
+    if (new_state == DS_OPERATIONAL || new_state == DS_OPERATIONAL_WARNING)
+    {
+        EVERT_FIRMWARE_UPDATE_Confirm();
+    }
+}
+
+bool __overrides EVERT_DEVICE_Derived_IsAdcSettled()
+{
+    return EVERT_BOOST_CONVERTER_ReadingsSettled();
 }
 
 void __overrides EVERT_DEVICE_Derived_OnEnterState_BootingComms()
 {
-    EVERT_DEVICE_State_Set(SS_INTERNAL, DS_HANDSHAKE_ACKNOWLEDGED);
+    // The CAN handler is up since init, announce to the CCU
+    EVERT_DEVICE_PostEvent(DE_BOOT_COMMS_DONE);
+}
+
+/// @brief Boost converter alarms on the device level: critical ones stop the converter, warnings throttle it
+EVERT_DEVICE_StateTypeDef __overrides EVERT_DEVICE_Derived_Alarm_Check()
+{
+    if (EVERT_BOOST_CONVERTER_IsAnyAlarmSet(BOOST_CONVERTER_ALARMS_Standby, sizeof(BOOST_CONVERTER_ALARMS_Standby) / sizeof(BOOST_CONVERTER_ALARMS_Standby[0])))
+    {
+        return DS_NON_OPERATIONAL;
+    }
+
+    if (EVERT_BOOST_CONVERTER_IsAnyAlarmSet(BOOST_CONVERTER_ALARMS_ThrottleDown, sizeof(BOOST_CONVERTER_ALARMS_ThrottleDown) / sizeof(BOOST_CONVERTER_ALARMS_ThrottleDown[0])))
+    {
+        return DS_OPERATIONAL_WARNING;
+    }
+
+    return DS_OPERATIONAL;
+}
+
+/// @brief Send the power report for the CCU dispatch, [1..2] input power W, [3..4] available power W, [5..6] output voltage 0.1 V
+static void EVERT_BOOST_CONVERTER_SendPowerReport()
+{
+    float32_t values[3] = {fi_power_in, mppt_state.available_power, fi_voltage_out * 10.0f};
+    uint8_t data[7] = {BCCM_POWER_REPORT};
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        EVERT_BOOST_CONVERTER_CLAMP(values[i], 0.0f, 65535.0f);
+        uint16_t value = (uint16_t)(values[i] + 0.5f);
+        memcpy(&data[1 + 2 * i], &value, sizeof(value));
+    }
+
+    EVERT_CAN_FifoStatusTypeDef status = EVERT_CAN_Handler_Transmit(&can_handler, sizeof(data), data);
+    if (status != CAN_FS_OK)
+    {
+        EVERT_HAL_BreakPoint("CAN Error: Power Report\n");
+    }
 }
 
 // __weak Callbacks - Task Scheduler
 void __overrides EVERT_TASK_SCHEDULER_OnTaskSendAnnouncement(void)
 {
+    EVERT_BOOST_CONVERTER_SendDeviceState();
 }
 void __overrides EVERT_TASK_SCHEDULER_OnTaskSendData(void)
 {
+    EVERT_BOOST_CONVERTER_InterleaveSendCurrent();
+    EVERT_BOOST_CONVERTER_SendPowerReport();
+    EVERT_BOOST_CONVERTER_TelemetrySample();
 }
 void __overrides EVERT_TASK_SCHEDULER_OnTaskSendDeviceStatus(void)
 {
+    EVERT_BOOST_CONVERTER_SendDeviceState();
 }
 void __overrides EVERT_TASK_SCHEDULER_OnTaskSendPing(void)
 {
@@ -248,13 +508,31 @@ void __overrides EVERT_TASK_SCHEDULER_OnTaskSendPing(void)
 
     // Send a ping message
     uint8_t data[7] = {0};
-    EVERT_CAN_FifoStatusTypeDef status = EVERT_CAN_Handler_Transmit(&can_handler, sizeof(data), &data);
+    EVERT_CAN_FifoStatusTypeDef status = EVERT_CAN_Handler_Transmit(&can_handler, sizeof(data), data);
     if (status != CAN_FS_OK)
     {
         EVERT_HAL_BreakPoint("CAN Error: Ping\n");
     }
 }
 
+// __weak Callbacks - Device
+void __overrides EVERT_DEVICE_PeripheralStatus_PopulateObject(EVERT_DEVICE_PeripheralStatusTypeDef *status)
+{
+    status->Adc1ErrorCode = HAL_ADC_GetError(&hadc1);
+    status->DmaAdc1ErrorCode = HAL_DMA_GetError(&hdma_adc1);
+    status->DmaAdc1State = (uint8_t)HAL_DMA_GetState(&hdma_adc1);
+
+    status->ClockFrequency = HAL_RCC_GetSysClockFreq();
+    status->ClockHseStatus = READ_BIT(RCC->CR, RCC_CR_HSEON) != 0;
+    status->ClockHseReady = __HAL_RCC_GET_FLAG(RCC_FLAG_HSERDY) != 0;
+
+    // Sampled by EVERT_CAN_Handler_UpdateStatistics
+    status->Can1Rec = can_handler.statistics.rec;
+    status->Can1Tec = can_handler.statistics.tec;
+    status->Can1Psr = can_handler.statistics.psr;
+    status->Can1ErrorCode = can_handler.statistics.error_code;
+}
+
 // Peripheral Callbacks
 void EVERT_BOOST_CONVERTER_ISR_10KHZ_IRQHandler()
 {
@@ -265,17 +543,40 @@ void EVERT_BOOST_CONVERTER_ISR_10KHZ_IRQHandler()
 
     EVERT_BOOST_CONVERTER_Readings();
 
+    // Run the voltage/current control loops
+    EVERT_BOOST_CONVERTER_ControlRun();
+
+    EVERT_WATCHDOG_Checkin(BCWC_ISR_HF);
+    EVERT_WATCHDOG_WindowCheckin();
+
     // Set ADC conversion flag
     adc_completed[0] = false;
 }
 
 void EVERT_BOOST_CONVERTER_ISR_100HZ_IRQHandler()
 {
-    // Check the alarms/constraints
-    EVERT_BOOST_CONVERTER_AlarmCheck();
+    // Check the alarms/constraints, not on the filters still filling up (critical alarms latch)
+    if (EVERT_BOOST_CONVERTER_ReadingsSettled())
+    {
+        EVERT_BOOST_CONVERTER_AlarmCheck();
+    }
 
     // Run the MPPT algorithm
     EVERT_BOOST_CONVERTER_MpptRun();
+
+    // Run the current share loop
+    EVERT_BOOST_CONVERTER_InterleaveRun();
+
+    // Re-evaluate the device state against the alarms
+    EVERT_DEVICE_OnLfTick();
+
+    EVERT_WATCHDOG_Checkin(BCWC_ISR_LF);
+}
+
+/// @brief Outputs off, any context (watchdog expiry, fatal errors)
+void __overrides EVERT_WATCHDOG_OnSafeState(void)
+{
+    HRTIM1->sCommonRegs.ODISR = HRTIM_OUTPUT_TA1;
 }
 
 void __overrides HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
@@ -295,52 +596,51 @@ void __overrides EVERT_INVERTER_FDCAN_RxFifo0Callback(FDCAN_HandleTypeDef *hfdca
 // Error Callbacks
 void EVERT_BOOST_CONVERTER_hal_error(char *error_message)
 {
-    EVERT_BOOST_CONVERTER_CommonErrorCallback(error_message);
+    EVERT_BOOST_CONVERTER_CommonErrorCallback(error_message, 0);
 }
 
 void HAL_ADC_ErrorCallback(ADC_HandleTypeDef *hadc)
 {
     UNUSED(hadc);
-    EVERT_BOOST_CONVERTER_CommonErrorCallback("ADC Error\n");
+    EVERT_BOOST_CONVERTER_CommonErrorCallback("ADC Error\n", EVERT_FAULT_RECORD_CALLER());
 }
 
 void HAL_DMA_ErrorCallback(DMA_HandleTypeDef *hdma)
 {
     UNUSED(hdma);
-    EVERT_BOOST_CONVERTER_CommonErrorCallback("DMA Error\n");
+    EVERT_BOOST_CONVERTER_CommonErrorCallback("DMA Error\n", EVERT_FAULT_RECORD_CALLER());
 }
 
 void HAL_FDCAN_ErrorCallback(FDCAN_HandleTypeDef *hfdcan)
 {
     UNUSED(hfdcan);
-    EVERT_BOOST_CONVERTER_CommonErrorCallback("FDCAN Error\n");
+    EVERT_BOOST_CONVERTER_CommonErrorCallback("FDCAN Error\n", EVERT_FAULT_RECORD_CALLER());
 }
 
 void HAL_FLASH_OperationErrorCallback(uint32_t ReturnValue)
 {
     UNUSED(ReturnValue);
-    EVERT_BOOST_CONVERTER_CommonErrorCallback("FLASH Error\n");
+    EVERT_BOOST_CONVERTER_CommonErrorCallback("FLASH Error\n", EVERT_FAULT_RECORD_CALLER());
 }
 
 void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
 {
     UNUSED(hi2c);
-    EVERT_BOOST_CONVERTER_CommonErrorCallback("I2C Error\n");
+    EVERT_BOOST_CONVERTER_CommonErrorCallback("I2C Error\n", EVERT_FAULT_RECORD_CALLER());
 }
 
 void HAL_TIM_ErrorCallback(TIM_HandleTypeDef *htim)
 {
     UNUSED(htim);
-    EVERT_BOOST_CONVERTER_CommonErrorCallback("TIM Error\n");
+    EVERT_BOOST_CONVERTER_CommonErrorCallback("TIM Error\n", EVERT_FAULT_RECORD_CALLER());
 }
 
-void EVERT_BOOST_CONVERTER_CommonErrorCallback(char *error_message)
+void EVERT_BOOST_CONVERTER_CommonErrorCallback(char *error_message, const uint32_t pc)
 {
+    EVERT_WATCHDOG_EnterSafeState();
     EVERT_HAL_BreakPoint(error_message);
 
-    __disable_irq();
-
-    while (1)
-    {
-    }
+    // Kept across the reset, reported on the next boot
+    EVERT_FAULT_RECORD_CaptureError(error_message, pc);
+    EVERT_FAULT_RECORD_Halt();
 }
\ No newline at end of file
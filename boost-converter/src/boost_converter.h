@@ -8,8 +8,15 @@
  *              * boost_converter_alarms.h (alarms) | boost_converter_alarms.c
  *              * boost_converter_calibration.h
  *              * boost_converter_constraints.h
+ *              * boost_converter_control.h (voltage/current loops) | boost_converter_control.c
+ *              * boost_converter_fault.h (fault record reporting) | boost_converter_fault.c
+ *              * boost_converter_interleave.h (interleaving/current sharing) | boost_converter_interleave.c
  *              * boost_converter_mppt.h (MPPT) | boost_converter_mppt.c
+ *              * boost_converter_parameters.h (persistent calibrations/constraints) | boost_converter_parameters.c
+ *              * boost_converter_protocol.h (CAN methods)
  *              * boost_converter_readings.h (readings) | boost_converter_readings.c
+ *              * boost_converter_registry.h (remote variable access) | boost_converter_registry.c
+ *              * boost_converter_telemetry.h (delta telemetry over CAN) | boost_converter_telemetry.c
  *
  ******************************************************************************
  **/
@@ -38,6 +45,7 @@
 #include "evert_hal.h"
 #include "gpio_definition.h"
 #include "task_scheduler.h"
+#include "time_sync.h"
 
 // Boost Converter includes
 #include "_conf_evert_device.h"
@@ -46,15 +54,25 @@
 #include "boost_converter_alarms.h"
 #include "boost_converter_calibration.h"
 #include "boost_converter_constraints.h"
+#include "boost_converter_control.h"
+#include "boost_converter_fault.h"
+#include "boost_converter_interleave.h"
 #include "boost_converter_mppt.h"
+#include "boost_converter_parameters.h"
+#include "boost_converter_protocol.h"
 #include "boost_converter_readings.h"
+#include "boost_converter_registry.h"
+#include "boost_converter_telemetry.h"
+#include "boost_converter_update.h"
 
+#ifndef DEVICE_VERSION_MAJOR
 /// @brief Device major version for the boost converter
 #define DEVICE_VERSION_MAJOR 2
 /// @brief Device minor version for the boost converter
 #define DEVICE_VERSION_MINOR 13
 /// @brief Device path version for the boost converter
 #define DEVICE_VERSION_PATCH 33
+#endif
 
 #define EVERT_BOOST_CONVERTER_EMA(new_value, prev_value, multiplier) (prev_value = multiplier * new_value + (1.0f - multiplier) * prev_value)
 #define EVERT_BOOST_CONVERTER_CLAMP(value, min, max) (value = (value < min) ? min : ((value > max) ? max : value))
@@ -77,6 +95,15 @@ typedef struct
     GPIO_PinState id_selection;
 } EVERT_BOOST_CONVERTER_IoStateTypeDef;
 
+/// @brief Watchdog checkpoints for the boost converter (watchdog.h)
+/// @details Each one checks in at least once per deadline (EVERT_SETTING_BC_WATCHDOG_*_DEADLINE_MS)
+typedef enum
+{
+    BCWC_LOOP = 0,
+    BCWC_ISR_HF = 1,
+    BCWC_ISR_LF = 2,
+} EVERT_BOOST_CONVERTER_WatchdogCheckpointTypeDef;
+
 /// @brief Status enumeration for the boost converter
 /// @details Contains the status of the boost converter
 typedef enum
@@ -86,18 +113,49 @@ typedef enum
     BCS_THROTTLE_DOWN = 2,
 } EVERT_BOOST_CONVERTER_StatusTypeDef;
 
+/// @brief MPPT algorithm enumeration for the boost converter
+/// @details Selects the tracking algorithm used between global sweeps
+typedef enum
+{
+    BCMA_PERTURB_AND_OBSERVE = 0,
+    BCMA_INCREMENTAL_CONDUCTANCE = 1,
+} EVERT_BOOST_CONVERTER_MpptAlgorithmTypeDef;
+
+/// @brief MPPT phase enumeration for the boost converter
+/// @details Tracking around the current maximum, or sweeping the full range to find the global maximum
+typedef enum
+{
+    BCMP_TRACKING = 0,
+    BCMP_SWEEPING = 1,
+} EVERT_BOOST_CONVERTER_MpptPhaseTypeDef;
+
 /// @brief MPPT state structure for the boost converter
-/// @details Contains the status, duty cycle, perturb step, observe interval, observe timer, current perturb step, previous duty cycle, and previous power
+/// @details Contains the status, algorithm and phase, the operating point being tracked, the previous observation and the global sweep state
 typedef struct
 {
     EVERT_BOOST_CONVERTER_StatusTypeDef status;
+    EVERT_BOOST_CONVERTER_MpptAlgorithmTypeDef algorithm;
+    EVERT_BOOST_CONVERTER_MpptPhaseTypeDef phase;
     float32_t duty_cycle;
-    float32_t perturb_step;
-    uint32_t observe_interval;
+    float32_t operating_point;
     float32_t observe_timer;
     float32_t current_perturb_step;
-    float32_t previous_duty_cycle;
+    bool oscillating;
+    float32_t power_limit;     // W, set by the CCU (BCCM_POWER_LIMIT, BCCM_POWER_LIMIT_BATCH), < 0 = unlimited
+    float32_t dispatch_timer;  // ms since the last BCCM_POWER_LIMIT_BATCH, past EVERT_SETTING_BC_DISPATCH_TIMEOUT_MS local control only
+    float32_t available_power; // W, estimate of the string power without the limit (BCCM_POWER_REPORT)
+
+    // Previous observation
+    float32_t previous_operating_point;
+    float32_t previous_voltage;
+    float32_t previous_current;
     float32_t previous_power;
+
+    // Global sweep
+    float32_t sweep_timer;
+    uint32_t sweep_index;
+    float32_t sweep_best_operating_point;
+    float32_t sweep_best_power;
 } EVERT_BOOST_CONVERTER_MpptStateTypeDef;
 
 extern EVERT_BOOST_CONVERTER_TimeTypeDef time;
@@ -109,6 +167,7 @@ int EVERT_BOOST_CONVERTER_main();
 void EVERT_BOOST_CONVERTER_loop();
 
 void EVERT_BOOST_CONVERTER_SetDutyCycle(float32_t duty_cycle);
+void EVERT_BOOST_CONVERTER_MpptSetAlgorithm(EVERT_BOOST_CONVERTER_MpptAlgorithmTypeDef algorithm);
 
 // __weak Callbacks - CAN
 void __overrides EVERT_CAN_OnMessageReceived(EVERT_CAN_HandlerTypeDef *handler, const EVERT_CAN_FrameTypeDef frame);
@@ -124,6 +183,9 @@ void __overrides EVERT_TASK_SCHEDULER_OnTaskSendData();
 void __overrides EVERT_TASK_SCHEDULER_OnTaskSendDeviceStatus();
 void __overrides EVERT_TASK_SCHEDULER_OnTaskSendPing();
 
+// __weak Callbacks - Watchdog
+void __overrides EVERT_WATCHDOG_OnSafeState(void);
+
 // Peripheral Callbacks
 void EVERT_BOOST_CONVERTER_ISR_10KHZ_IRQHandler();
 void EVERT_BOOST_CONVERTER_ISR_100HZ_IRQHandler();
@@ -138,6 +200,6 @@ void HAL_FDCAN_ErrorCallback(FDCAN_HandleTypeDef *hfdcan);
 void HAL_FLASH_OperationErrorCallback(uint32_t ReturnValue);
 void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c);
 void HAL_TIM_ErrorCallback(TIM_HandleTypeDef *htim);
-void EVERT_BOOST_CONVERTER_CommonErrorCallback(char *error_message);
+void EVERT_BOOST_CONVERTER_CommonErrorCallback(char *error_message, const uint32_t pc);
 
 #endif // EVERT_BOOST_CONVERTER_MAIN_H_
\ No newline at end of file
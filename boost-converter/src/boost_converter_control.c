@@ -0,0 +1,79 @@
+/**
+ ******************************************************************************
+ * @file    boost_converter_control.c
+ * @author  Evert Firmware Team
+ * @brief   Cascaded input voltage / inductor current control for the Evert Boost Converter
+ *
+ ******************************************************************************
+ **/
+
+#include "boost_converter.h"
+#include "boost_converter_control.h"
+#include "boost_converter_interleave.h"
+#include "boost_converter_readings.h"
+
+EVERT_BOOST_CONVERTER_ControlStateTypeDef control_state;
+
+/// @brief Initialize the control loops
+/// @details The loops stay disabled until the MPPT leaves standby
+void EVERT_BOOST_CONVERTER_ControlInit(void)
+{
+    EVERT_PID_Init(&control_state.pi_voltage, EVERT_SETTING_BC_CONTROL_VOLTAGE_KP, EVERT_SETTING_BC_CONTROL_VOLTAGE_KI, 0.0f, EVERT_CONSTANT_BC_ISR_HF_PERIOD, 0.0f, EVERT_SETTING_BC_CONTROL_CURRENT_MAX);
+    EVERT_PID_SetRateLimit(&control_state.pi_voltage, EVERT_SETTING_BC_CONTROL_CURRENT_SLEW_RATE);
+
+    EVERT_PID_Init(&control_state.pi_current, EVERT_SETTING_BC_CONTROL_CURRENT_KP, EVERT_SETTING_BC_CONTROL_CURRENT_KI, 0.0f, EVERT_CONSTANT_BC_ISR_HF_PERIOD, EVERT_CONSTRAINT_BC_DUTY_CYCLE_MIN, EVERT_CONSTRAINT_BC_DUTY_CYCLE_MPPT_MAX);
+
+    control_state.voltage_reference = EVERT_SETTING_BC_MPPT_OPERATING_POINT_MAX;
+    control_state.current_reference = 0.0f;
+    control_state.duty_cycle_feed_forward = 0.0f;
+    control_state.enabled = false;
+}
+
+/// @brief Set the PV (input) voltage reference, normally from the MPPT
+/// @param voltage_reference
+void EVERT_BOOST_CONVERTER_ControlSetVoltageReference(const float32_t voltage_reference)
+{
+    control_state.voltage_reference = voltage_reference;
+}
+
+/// @brief Run the cascaded control loops
+/// @details Called from the 10 kHz ISR right after the readings
+void EVERT_BOOST_CONVERTER_ControlRun(void)
+{
+    float32_t voltage_in = rt_voltage_in;
+    float32_t voltage_out = rt_voltage_out;
+    float32_t current_in = rt_current_in;
+
+    if (mppt_state.status == BCS_STANDBY)
+    {
+        if (control_state.enabled)
+        {
+            control_state.enabled = false;
+            control_state.current_reference = 0.0f;
+            EVERT_BOOST_CONVERTER_SetDutyCycle(0.0f);
+        }
+
+        return;
+    }
+
+    // Steady state duty of an ideal boost, D = 1 - Vin/Vout, leaves the current PI with only the error to correct
+    control_state.duty_cycle_feed_forward = (voltage_out > voltage_in && voltage_out > 0.0f) ? (1.0f - (voltage_in / voltage_out)) : 0.0f;
+
+    if (!control_state.enabled)
+    {
+        // Bumpless start from the current duty cycle and zero current reference
+        EVERT_PID_Bumpless(&control_state.pi_voltage, 0.0f, voltage_in, control_state.voltage_reference, 0.0f);
+        EVERT_PID_Bumpless(&control_state.pi_current, mppt_state.duty_cycle, 0.0f, current_in, control_state.duty_cycle_feed_forward);
+        control_state.enabled = true;
+    }
+
+    // Input voltage above the reference means the PV string can deliver more, so the error is inverted (Vin - Vref)
+    control_state.current_reference = EVERT_PID_Update(&control_state.pi_voltage, voltage_in, control_state.voltage_reference, 0.0f);
+
+    // Current share trim of the phases on a shared input, bounded to EVERT_SETTING_BC_SHARE_TRIM_MAX, zero otherwise
+    control_state.current_reference += interleave_state.share_trim;
+    EVERT_PID_CLAMP(control_state.current_reference, 0.0f, EVERT_SETTING_BC_CONTROL_CURRENT_MAX);
+
+    float32_t duty_cycle = EVERT_PID_Update(&control_state.pi_current, control_state.current_reference, current_in, control_state.duty_cycle_feed_forward);
+    EVERT_BOOST_CONVERTER_SetDutyCycle(duty_cycle);
+}
@@ -0,0 +1,39 @@
+/**
+ ******************************************************************************
+ * @file    boost_converter_control.h
+ * @author  Evert Firmware Team
+ * @brief   Cascaded input voltage / inductor current control for the Evert Boost Converter
+ *          * MPPT (100 Hz) -> PV voltage reference
+ *          * Input voltage PI (10 kHz) -> inductor current reference
+ *          * Current share trim (100 Hz, boost_converter_interleave.h) -> added to the current reference
+ *          * Inductor current PI (10 kHz) -> duty cycle
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_BOOST_CONVERTER_CONTROL_H_
+#define EVERT_BOOST_CONVERTER_CONTROL_H_
+
+#include <stdbool.h>
+#include "arm_math.h"
+#include "pid_controller.h"
+#include "_conf_evert_boost_converter.h"
+
+/// @brief Control state structure for the boost converter
+/// @details Contains the voltage and current controllers and the references passed between them
+typedef struct
+{
+    EVERT_PID_StateTypeDef pi_voltage;
+    EVERT_PID_StateTypeDef pi_current;
+    float32_t voltage_reference;
+    float32_t current_reference;
+    float32_t duty_cycle_feed_forward;
+    bool enabled;
+} EVERT_BOOST_CONVERTER_ControlStateTypeDef;
+
+extern EVERT_BOOST_CONVERTER_ControlStateTypeDef control_state;
+
+void EVERT_BOOST_CONVERTER_ControlInit(void);
+void EVERT_BOOST_CONVERTER_ControlSetVoltageReference(const float32_t voltage_reference);
+void EVERT_BOOST_CONVERTER_ControlRun(void);
+
+#endif // EVERT_BOOST_CONVERTER_CONTROL_H_
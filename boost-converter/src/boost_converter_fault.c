@@ -0,0 +1,94 @@
+/**
+ ******************************************************************************
+ * @file    boost_converter_fault.c
+ * @author  Evert Firmware Team
+ * @brief   Fault record reporting for the boost converter
+ *
+ ******************************************************************************
+ **/
+
+#include <string.h>
+#include "boost_converter.h"
+#include "boost_converter_fault.h"
+
+#define EVERT_BOOST_CONVERTER_FAULT_CHUNK_SIZE (5)
+#define EVERT_BOOST_CONVERTER_FAULT_TX_RESERVE (4) // TX buffer slots left for the control traffic
+
+extern EVERT_CAN_HandlerTypeDef can_handler;
+
+EVERT_BOOST_CONVERTER_FaultStateTypeDef fault_state;
+
+/// @brief [1] reset flags (RCC->CSR bits 24-31), [2] type (FRT_NONE: no record), [3..6] pc
+static void EVERT_BOOST_CONVERTER_FaultSendSummary(const EVERT_FAULT_RECORD_TypeDef *record, const uint32_t reset_cause)
+{
+    uint8_t data[7] = {BCCM_FAULT_SUMMARY};
+    uint32_t pc = record != NULL ? record->frame.pc : 0;
+
+    data[1] = (uint8_t)(reset_cause >> 24);
+    data[2] = record != NULL ? record->type : FRT_NONE;
+    memcpy(&data[3], &pc, sizeof(pc));
+
+    if (EVERT_CAN_Handler_Transmit(&can_handler, sizeof(data), data) != CAN_FS_OK)
+    {
+        EVERT_HAL_BreakPoint("CAN Error: Fault Summary\n");
+    }
+}
+
+void EVERT_BOOST_CONVERTER_FaultInit(void)
+{
+    fault_state.record = NULL;
+    fault_state.chunk = 0;
+    fault_state.chunk_count = (sizeof(EVERT_FAULT_RECORD_TypeDef) + EVERT_BOOST_CONVERTER_FAULT_CHUNK_SIZE - 1) / EVERT_BOOST_CONVERTER_FAULT_CHUNK_SIZE;
+    fault_state.summary_sent = false;
+}
+
+/// @brief Summary of record (index), 0 = newest, then the record itself in chunks
+void EVERT_BOOST_CONVERTER_FaultOnRead(const uint8_t index)
+{
+    const EVERT_FAULT_RECORD_TypeDef *record = EVERT_FAULT_RECORD_Get(index);
+
+    EVERT_BOOST_CONVERTER_FaultSendSummary(record, record != NULL ? record->reset_cause : 0);
+
+    fault_state.record = record;
+    fault_state.chunk = 0;
+}
+
+/// @brief Send the boot summary and the pending chunks as the TX buffer drains, call from the main loop
+void EVERT_BOOST_CONVERTER_FaultProcess(void)
+{
+    if (!fault_state.summary_sent)
+    {
+        // This boot's reset cause, with the record it left (if any)
+        fault_state.summary_sent = true;
+        EVERT_BOOST_CONVERTER_FaultSendSummary(fault_record.new_record ? EVERT_FAULT_RECORD_GetLatest() : NULL, fault_record.reset_cause);
+    }
+
+    // [1] chunk, [2..6] record bytes (chunk * 5)
+    while (fault_state.record != NULL && can_handler.tx_fifo_buffer.count + EVERT_BOOST_CONVERTER_FAULT_TX_RESERVE < can_handler.tx_fifo_buffer.size)
+    {
+        uint32_t offset = fault_state.chunk * EVERT_BOOST_CONVERTER_FAULT_CHUNK_SIZE;
+        uint32_t length = sizeof(EVERT_FAULT_RECORD_TypeDef) - offset;
+        uint8_t data[7] = {BCCM_FAULT_CHUNK, fault_state.chunk};
+
+        if (length > EVERT_BOOST_CONVERTER_FAULT_CHUNK_SIZE)
+        {
+            length = EVERT_BOOST_CONVERTER_FAULT_CHUNK_SIZE;
+        }
+
+        memcpy(&data[2], (const uint8_t *)fault_state.record + offset, length);
+        EVERT_CAN_Handler_Transmit(&can_handler, (uint8_t)(2 + length), data);
+
+        if (++fault_state.chunk >= fault_state.chunk_count)
+        {
+            fault_state.record = NULL;
+        }
+    }
+}
+
+/// @brief Alarm register and device state at the capture
+void __overrides EVERT_FAULT_RECORD_OnCapture(EVERT_FAULT_RECORD_TypeDef *record)
+{
+    record->alarms[0] = alarm_register.reg;
+    record->state_internal = (uint8_t)EVERT_DEVICE_State_Get(SS_INTERNAL);
+    record->state_propagated = (uint8_t)EVERT_DEVICE_State_Get(SS_PROPAGATED);
+}
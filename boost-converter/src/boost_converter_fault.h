@@ -0,0 +1,35 @@
+/**
+ ******************************************************************************
+ * @file    boost_converter_fault.h
+ * @author  Evert Firmware Team
+ * @brief   Fault record reporting for the boost converter
+ *          * Capture and storage: fault_record.h (.noinit RAM, fault log in flash)
+ *          * CAN: BCCM_FAULT_SUMMARY once after boot (reset cause, last record), BCCM_FAULT_READ streams a
+ *            record as BCCM_FAULT_CHUNK frames
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_BOOST_CONVERTER_FAULT_H_
+#define EVERT_BOOST_CONVERTER_FAULT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "_conf_evert_boost_converter.h"
+#include "fault_record.h"
+
+/// @brief Chunks still to send of the record being read
+typedef struct
+{
+    const EVERT_FAULT_RECORD_TypeDef *record; // NULL: idle
+    uint8_t chunk;
+    uint8_t chunk_count;
+    bool summary_sent; // Boot summary
+} EVERT_BOOST_CONVERTER_FaultStateTypeDef;
+
+extern EVERT_BOOST_CONVERTER_FaultStateTypeDef fault_state;
+
+void EVERT_BOOST_CONVERTER_FaultInit(void);
+void EVERT_BOOST_CONVERTER_FaultOnRead(const uint8_t index);
+void EVERT_BOOST_CONVERTER_FaultProcess(void);
+
+#endif // EVERT_BOOST_CONVERTER_FAULT_H_
@@ -0,0 +1,165 @@
+/**
+ ******************************************************************************
+ * @file    boost_converter_interleave.c
+ * @author  Evert Firmware Team
+ * @brief   Interleaved operation and current sharing for paralleled Evert Boost Converters
+ *
+ ******************************************************************************
+ **/
+
+#include <string.h>
+#include "boost_converter.h"
+#include "boost_converter_interleave.h"
+#include "boost_converter_readings.h"
+
+EVERT_BOOST_CONVERTER_InterleaveStateTypeDef interleave_state;
+
+extern EVERT_CAN_HandlerTypeDef can_handler;
+extern HRTIM_HandleTypeDef hhrtim1;
+
+/// @brief Initialize interleaving and the current share loop
+/// @details Must be called before the HRTIM counters are started
+/// @param phase_index Phase of this unit, 0 is the carrier master
+void EVERT_BOOST_CONVERTER_InterleaveInit(const uint8_t phase_index)
+{
+    EVERT_PID_Init(&interleave_state.pi_share, EVERT_SETTING_BC_SHARE_KP, EVERT_SETTING_BC_SHARE_KI, 0.0f, EVERT_CONSTANT_BC_ISR_LF_PERIOD_MS / 1000.0f, -EVERT_SETTING_BC_SHARE_TRIM_MAX, EVERT_SETTING_BC_SHARE_TRIM_MAX);
+
+    memset(interleave_state.peers, 0, sizeof(interleave_state.peers));
+    interleave_state.peer_current = 0.0f;
+    interleave_state.share_count = 1;
+    interleave_state.share_trim = 0.0f;
+
+    HRTIM_Master_TypeDef *master = &hhrtim1.Instance->sMasterRegs;
+    HRTIM_Timerx_TypeDef *timer_a = &hhrtim1.Instance->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_A];
+
+    // Master timer runs at the PWM period and is the carrier reference for TIMER_A
+    master->MCR = (master->MCR & ~HRTIM_MCR_CK_PSC) | (timer_a->TIMxCR & HRTIM_TIMCR_CK_PSC);
+    master->MPER = timer_a->PERxR;
+
+#if EVERT_SETTING_BC_INTERLEAVE_HRTIM_SYNC
+    // SCOUT/SCIN are daisy-chained between the units, a CAN frame can't hold a 25 us carrier to a fraction of a period
+    master->MCR &= ~(HRTIM_MCR_SYNC_IN | HRTIM_MCR_SYNCRSTM | HRTIM_MCR_SYNCSTRTM | HRTIM_MCR_SYNC_OUT | HRTIM_MCR_SYNC_SRC);
+
+    if (phase_index == 0)
+    {
+        master->MCR |= HRTIM_SYNCOUTPUTSOURCE_MASTER_START | HRTIM_SYNCOUTPUTPOLARITY_POSITIVE;
+    }
+    else
+    {
+        master->MCR |= HRTIM_SYNCINPUTSOURCE_EXTERNALEVENT | HRTIM_MCR_SYNCRSTM | HRTIM_MCR_SYNCSTRTM;
+    }
+#endif
+
+    EVERT_BOOST_CONVERTER_InterleaveSetPhase(phase_index, EVERT_SETTING_BC_INTERLEAVE_PHASE_COUNT);
+}
+
+/// @brief Set the phase of this unit
+/// @details TIMER_A is reset by the master timer, delayed by 360°/N per phase
+/// @param phase_index
+/// @param phase_count
+void EVERT_BOOST_CONVERTER_InterleaveSetPhase(const uint8_t phase_index, const uint8_t phase_count)
+{
+    if (phase_count == 0 || phase_count > EVERT_CONSTANT_BC_INTERLEAVE_PHASE_MAX || phase_index >= phase_count)
+    {
+        return;
+    }
+
+    interleave_state.phase_index = phase_index;
+    interleave_state.phase_count = phase_count;
+
+    HRTIM_Master_TypeDef *master = &hhrtim1.Instance->sMasterRegs;
+    HRTIM_Timerx_TypeDef *timer_a = &hhrtim1.Instance->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_A];
+
+    if (phase_index == 0)
+    {
+        timer_a->RSTxR = HRTIM_RSTR_MSTPER;
+    }
+    else
+    {
+        master->MCMP1R = (master->MPER * phase_index) / phase_count;
+        timer_a->RSTxR = HRTIM_RSTR_MSTCMP1;
+    }
+}
+
+/// @brief Store the input current reported by a peer unit
+/// @param phase_index Phase of the peer
+/// @param current Peer input current (A)
+/// @param running Peer is not in standby
+void EVERT_BOOST_CONVERTER_InterleaveOnPeerCurrent(const uint8_t phase_index, const float32_t current, const bool running)
+{
+    if (phase_index >= EVERT_CONSTANT_BC_INTERLEAVE_PHASE_MAX)
+    {
+        return;
+    }
+
+    EVERT_BOOST_CONVERTER_InterleavePeerTypeDef *peer = &interleave_state.peers[phase_index];
+    peer->current = current;
+    peer->running = running;
+    peer->tick = HAL_GetTick();
+}
+
+/// @brief Broadcast the own input current for the peer's current share loop
+void EVERT_BOOST_CONVERTER_InterleaveSendCurrent(void)
+{
+    float32_t current = fi_current_in;
+    uint8_t data[7] = {0};
+
+    data[0] = BCCM_CURRENT_SHARE;
+    memcpy(&data[1], &current, sizeof(current));
+    data[5] = interleave_state.phase_index;
+    data[6] = mppt_state.status != BCS_STANDBY;
+
+    EVERT_CAN_FifoStatusTypeDef status = EVERT_CAN_Handler_Transmit(&can_handler, sizeof(data), data);
+    if (status != CAN_FS_OK)
+    {
+        EVERT_HAL_BreakPoint("CAN Error: Current Share\n");
+    }
+}
+
+/// @brief Run the current share loop
+/// @details Called from the 100 Hz ISR, drives the own current towards 1/N of the total, N the units running
+/// with a current share frame within EVERT_SETTING_BC_SHARE_PEER_TIMEOUT_MS (this one included). Each unit on a
+/// string of its own tracks its maximum, the trim stays at zero then. The voltage loop integrator would absorb
+/// a trim of its own unit, the share integrator holds while that loop is in control and the trim is proportional
+void EVERT_BOOST_CONVERTER_InterleaveRun(void)
+{
+    float32_t own_current = fi_current_in;
+    float32_t total_current = own_current;
+    uint8_t share_count = 1;
+    uint32_t tick = HAL_GetTick();
+
+    for (uint8_t i = 0; i < interleave_state.phase_count; i++)
+    {
+        const EVERT_BOOST_CONVERTER_InterleavePeerTypeDef *peer = &interleave_state.peers[i];
+
+        if (i != interleave_state.phase_index && peer->running && (tick - peer->tick) < EVERT_SETTING_BC_SHARE_PEER_TIMEOUT_MS)
+        {
+            total_current += peer->current;
+            share_count++;
+        }
+    }
+
+    interleave_state.share_count = share_count;
+    interleave_state.peer_current = (share_count > 1) ? (total_current - own_current) / (share_count - 1) : 0.0f;
+
+    if (!EVERT_SETTING_BC_INTERLEAVE_SHARED_INPUT || share_count == 1 || mppt_state.status == BCS_STANDBY)
+    {
+        EVERT_PID_Reset(&interleave_state.pi_share);
+        interleave_state.share_trim = 0.0f;
+        return;
+    }
+
+    const EVERT_PID_StateTypeDef *pi_voltage = &control_state.pi_voltage;
+    bool voltage_in_control = control_state.enabled && pi_voltage->Output > pi_voltage->OutputMin && pi_voltage->Output < pi_voltage->OutputMax;
+    float32_t integral = interleave_state.pi_share.Integral;
+    float32_t share_current = total_current / share_count;
+
+    interleave_state.share_trim = EVERT_PID_Update(&interleave_state.pi_share, share_current, own_current, 0.0f);
+
+    if (voltage_in_control)
+    {
+        interleave_state.pi_share.Integral = integral;
+    }
+
+    EVERT_PID_CLAMP(interleave_state.pi_share.Integral, -EVERT_SETTING_BC_SHARE_TRIM_MAX, EVERT_SETTING_BC_SHARE_TRIM_MAX);
+}
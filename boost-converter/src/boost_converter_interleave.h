@@ -0,0 +1,52 @@
+/**
+ ******************************************************************************
+ * @file    boost_converter_interleave.h
+ * @author  Evert Firmware Team
+ * @brief   Interleaved operation and current sharing for paralleled Evert Boost Converters
+ *          * Carrier sync: HRTIM master timer, BC1 drives SCOUT, the other phases reset on SCIN
+ *          * Phase offset: TIMER_A resets on master compare 1 = period * phase / N (360°/N)
+ *          * Current share: input current of each unit over CAN (100 ms) -> trim towards 1/N of the total on the
+ *            current reference (100 Hz), N the units running; only for phases on one input
+ *            (EVERT_SETTING_BC_INTERLEAVE_SHARED_INPUT), the trim integrator holds while the voltage loop is in control
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_BOOST_CONVERTER_INTERLEAVE_H_
+#define EVERT_BOOST_CONVERTER_INTERLEAVE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "arm_math.h"
+#include "pid_controller.h"
+#include "_conf_evert_boost_converter.h"
+
+/// @brief Last current share frame of a peer unit
+typedef struct
+{
+    float32_t current;
+    uint32_t tick;
+    bool running;
+} EVERT_BOOST_CONVERTER_InterleavePeerTypeDef;
+
+/// @brief Interleave state structure for the boost converter
+/// @details Contains the phase assignment, the last current reported by each peer and the current share trim
+typedef struct
+{
+    uint8_t phase_index;
+    uint8_t phase_count;
+    EVERT_BOOST_CONVERTER_InterleavePeerTypeDef peers[EVERT_CONSTANT_BC_INTERLEAVE_PHASE_MAX]; // By phase index, the own one unused
+    float32_t peer_current; // Average of the peers sharing the current
+    uint8_t share_count;    // Units sharing the current, this one included
+    EVERT_PID_StateTypeDef pi_share;
+    float32_t share_trim;
+} EVERT_BOOST_CONVERTER_InterleaveStateTypeDef;
+
+extern EVERT_BOOST_CONVERTER_InterleaveStateTypeDef interleave_state;
+
+void EVERT_BOOST_CONVERTER_InterleaveInit(const uint8_t phase_index);
+void EVERT_BOOST_CONVERTER_InterleaveSetPhase(const uint8_t phase_index, const uint8_t phase_count);
+void EVERT_BOOST_CONVERTER_InterleaveOnPeerCurrent(const uint8_t phase_index, const float32_t current, const bool running);
+void EVERT_BOOST_CONVERTER_InterleaveSendCurrent(void);
+void EVERT_BOOST_CONVERTER_InterleaveRun(void);
+
+#endif // EVERT_BOOST_CONVERTER_INTERLEAVE_H_
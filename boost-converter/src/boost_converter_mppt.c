@@ -1,87 +1,345 @@
 #include "boost_converter_mppt.h"
 #include "boost_converter_readings.h"
+#include "oscillation_detector.h"
 
-static void EVERT_BOOST_CONVERTER_MpptObserve();
-static void EVERT_BOOST_CONVERTER_MpptPerturb();
+static EVERT_OSCILLATION_DETECTOR_StateTypeDef mppt_oscillation_detector;
+static int8_t mppt_oscillation_buffer[EVERT_SETTING_BC_MPPT_OSCILLATION_WINDOW];
+
+static void EVERT_BOOST_CONVERTER_MpptApply(float32_t operating_point);
+static void EVERT_BOOST_CONVERTER_MpptObserve(float32_t voltage, float32_t current, float32_t power);
+static float32_t EVERT_BOOST_CONVERTER_MpptLimitStep(float32_t power);
+static float32_t EVERT_BOOST_CONVERTER_MpptPerturbAndObserve(float32_t power);
+static float32_t EVERT_BOOST_CONVERTER_MpptIncrementalConductance(float32_t voltage, float32_t current);
+static void EVERT_BOOST_CONVERTER_MpptSweepStart(void);
+static void EVERT_BOOST_CONVERTER_MpptSweepStep(float32_t power);
 
 void EVERT_BOOST_CONVERTER_MpptInit(void)
 {
     EVERT_BOOST_CONVERTER_SetDutyCycle(0.0f);
+    EVERT_OSCILLATION_DETECTOR_Init(&mppt_oscillation_detector, mppt_oscillation_buffer, EVERT_SETTING_BC_MPPT_OSCILLATION_WINDOW, EVERT_SETTING_BC_MPPT_OSCILLATION_THRESHOLD);
 
     mppt_state.status = BCS_STANDBY;
-    mppt_state.perturb_step = 0.01f;
-    mppt_state.current_perturb_step = mppt_state.perturb_step;
-    mppt_state.observe_interval = 1000;
+    mppt_state.algorithm = EVERT_SETTING_BC_MPPT_ALGORITHM;
+    mppt_state.phase = BCMP_TRACKING;
+    mppt_state.operating_point = EVERT_SETTING_BC_MPPT_OPERATING_POINT_MAX;
     mppt_state.observe_timer = 0.0f;
-    mppt_state.previous_duty_cycle = 0.0f;
+    mppt_state.current_perturb_step = EVERT_SETTING_BC_MPPT_STEP_MIN;
+    mppt_state.oscillating = false;
+    mppt_state.power_limit = -1.0f;
+    mppt_state.dispatch_timer = EVERT_SETTING_BC_DISPATCH_TIMEOUT_MS;
+    mppt_state.available_power = 0.0f;
+    mppt_state.previous_operating_point = EVERT_SETTING_BC_MPPT_OPERATING_POINT_MAX;
+    mppt_state.previous_voltage = 0.0f;
+    mppt_state.previous_current = 0.0f;
     mppt_state.previous_power = 0.0f;
+
+    // First sweep one interval after the start, the tracker takes the string from open circuit to its nearest
+    // maximum meanwhile
+    mppt_state.sweep_timer = 0.0f;
+    mppt_state.sweep_index = 0;
+    mppt_state.sweep_best_operating_point = EVERT_SETTING_BC_MPPT_OPERATING_POINT_MAX;
+    mppt_state.sweep_best_power = 0.0f;
+}
+
+/// @brief Power limit from the CCU dispatch, < 0 = unlimited (MPPT only)
+void EVERT_BOOST_CONVERTER_MpptSetPowerLimit(const float32_t power_limit)
+{
+    mppt_state.power_limit = power_limit;
+}
+
+/// @brief Power limit from the CCU plant-level dispatch (BCCM_POWER_LIMIT_BATCH), < 0 = unlimited
+/// @details While these keep coming the CCU derates on warnings instead of the local throttling
+void EVERT_BOOST_CONVERTER_MpptDispatch(const float32_t power_limit)
+{
+    mppt_state.power_limit = power_limit;
+    mppt_state.dispatch_timer = 0.0f;
+}
+
+/// @brief The CCU dispatches this converter, its batch limits are recent
+bool EVERT_BOOST_CONVERTER_MpptIsDispatched(void)
+{
+    return mppt_state.dispatch_timer < EVERT_SETTING_BC_DISPATCH_TIMEOUT_MS;
+}
+
+void EVERT_BOOST_CONVERTER_MpptSetAlgorithm(EVERT_BOOST_CONVERTER_MpptAlgorithmTypeDef algorithm)
+{
+    mppt_state.algorithm = algorithm;
+    mppt_state.current_perturb_step = EVERT_SETTING_BC_MPPT_STEP_MIN;
+    EVERT_OSCILLATION_DETECTOR_Reset(&mppt_oscillation_detector);
 }
 
 void EVERT_BOOST_CONVERTER_MpptRun(void)
 {
-    // 100 Hz ISR = 0.1s = 100 ms
-    const float32_t delta_time_ms = 100.0f;
-    mppt_state.observe_timer += delta_time_ms;
+    // Called from the 100 Hz ISR
+    mppt_state.observe_timer += EVERT_CONSTANT_BC_ISR_LF_PERIOD_MS;
+    mppt_state.sweep_timer += EVERT_CONSTANT_BC_ISR_LF_PERIOD_MS;
 
-    if (mppt_state.observe_timer >= mppt_state.observe_interval)
+    // Dispatch gone quiet: drop its limit, the converter runs on its own again
+    if (EVERT_BOOST_CONVERTER_MpptIsDispatched())
     {
-        if (mppt_state.status == BCS_THROTTLE_DOWN)
-        {
-            EVERT_BOOST_CONVERTER_SetDutyCycle(mppt_state.duty_cycle - mppt_state.perturb_step);
-        }
-        else if (mppt_state.status == BCS_STANDBY)
-        {
-            EVERT_BOOST_CONVERTER_SetDutyCycle(0.0f);
-        }
-        else
+        mppt_state.dispatch_timer += EVERT_CONSTANT_BC_ISR_LF_PERIOD_MS;
+
+        if (!EVERT_BOOST_CONVERTER_MpptIsDispatched())
         {
-            EVERT_BOOST_CONVERTER_MpptObserve();
-            EVERT_BOOST_CONVERTER_MpptPerturb();
+            mppt_state.power_limit = -1.0f;
         }
+    }
+
+    if (mppt_state.observe_timer < EVERT_SETTING_BC_MPPT_OBSERVE_INTERVAL_MS)
+    {
+        return;
+    }
 
-        mppt_state.observe_timer = 0;
+    mppt_state.observe_timer = 0;
+
+    // Dispatched: warnings are reported in the device state and the CCU derates this converter with the others,
+    // without it back off locally
+    if (mppt_state.status == BCS_THROTTLE_DOWN && !EVERT_BOOST_CONVERTER_MpptIsDispatched())
+    {
+        // Back off towards open circuit (higher PV voltage, less power)
+        mppt_state.phase = BCMP_TRACKING;
+        EVERT_BOOST_CONVERTER_MpptApply(mppt_state.operating_point + (EVERT_SETTING_BC_MPPT_VOLTAGE_DIRECTION * EVERT_SETTING_BC_MPPT_STEP_MAX));
+        return;
+    }
+
+    if (mppt_state.status == BCS_STANDBY)
+    {
+        // The control loops hold the duty cycle at zero, restart from open circuit
+        mppt_state.phase = BCMP_TRACKING;
+        EVERT_BOOST_CONVERTER_MpptApply(EVERT_SETTING_BC_MPPT_OPERATING_POINT_MAX);
+        return;
     }
+
+    float32_t voltage = fi_voltage_in;
+    float32_t current = fi_current_in;
+    float32_t power = fi_power_in;
+
+    // Curtailed by the CCU: above the limit back off towards open circuit, just below it hold
+    bool limited = mppt_state.power_limit >= 0.0f;
+
+    // Available power for the CCU: held at the limit the string gives at least the current power, otherwise the
+    // tracker sits on the maximum (the sweep passes through lower points, keep the last estimate meanwhile)
+    if (limited && power > mppt_state.power_limit * (1.0f - EVERT_SETTING_BC_MPPT_POWER_LIMIT_BAND))
+    {
+        mppt_state.available_power = (power > mppt_state.available_power) ? power : mppt_state.available_power;
+    }
+    else if (mppt_state.phase != BCMP_SWEEPING)
+    {
+        mppt_state.available_power = power;
+    }
+
+    if (mppt_state.phase == BCMP_SWEEPING)
+    {
+        EVERT_BOOST_CONVERTER_MpptSweepStep(power);
+    }
+    else if (limited && power > mppt_state.power_limit)
+    {
+        mppt_state.current_perturb_step = EVERT_SETTING_BC_MPPT_VOLTAGE_DIRECTION * ((power > mppt_state.power_limit * (1.0f + EVERT_SETTING_BC_MPPT_POWER_LIMIT_BAND)) ? EVERT_BOOST_CONVERTER_MpptLimitStep(power) : EVERT_SETTING_BC_MPPT_STEP_MIN);
+        EVERT_BOOST_CONVERTER_MpptApply(mppt_state.operating_point + mppt_state.current_perturb_step);
+    }
+    else if (limited && power >= mppt_state.power_limit * (1.0f - EVERT_SETTING_BC_MPPT_POWER_LIMIT_BAND))
+    {
+        // Held, at 0 W as well (open circuit, where the trackers would head down to the maximum)
+        EVERT_BOOST_CONVERTER_MpptApply(mppt_state.operating_point);
+    }
+    else if (!limited && EVERT_SETTING_BC_MPPT_SWEEP_INTERVAL_MS > 0.0f && mppt_state.sweep_timer >= EVERT_SETTING_BC_MPPT_SWEEP_INTERVAL_MS)
+    {
+        EVERT_BOOST_CONVERTER_MpptSweepStart();
+    }
+    else
+    {
+        EVERT_BOOST_CONVERTER_MpptObserve(voltage, current, power);
+    }
+
+    mppt_state.previous_voltage = voltage;
+    mppt_state.previous_current = current;
+    mppt_state.previous_power = power;
 }
 
-void EVERT_BOOST_CONVERTER_MpptObserve()
+static void EVERT_BOOST_CONVERTER_MpptApply(float32_t operating_point)
 {
-    float32_t current_duty_cycle = mppt_state.duty_cycle;
+    EVERT_BOOST_CONVERTER_CLAMP(operating_point, EVERT_SETTING_BC_MPPT_OPERATING_POINT_MIN, EVERT_SETTING_BC_MPPT_OPERATING_POINT_MAX);
 
-    // Are we currently cycling up or down?
-    // At the start of the MPPT algorithm, we are cycling up from 0.0f starting at 0.1f or something
-    bool is_cycling_up = current_duty_cycle > mppt_state.previous_duty_cycle;
+    mppt_state.previous_operating_point = mppt_state.operating_point;
+    mppt_state.operating_point = operating_point;
 
-    // Absolute the current perturbation size to avoid double negatives (-- = +)
-    float32_t perturb_size = mppt_state.current_perturb_step >= 0 ? mppt_state.current_perturb_step : -mppt_state.current_perturb_step;
+    EVERT_BOOST_CONVERTER_ControlSetVoltageReference(operating_point);
+}
 
-    // Is the power increasing or decreasing?
-    bool power_increasing = fi_power_in > mppt_state.previous_power;
+static void EVERT_BOOST_CONVERTER_MpptObserve(float32_t voltage, float32_t current, float32_t power)
+{
+    float32_t delta = (mppt_state.algorithm == BCMA_INCREMENTAL_CONDUCTANCE)
+                          ? EVERT_BOOST_CONVERTER_MpptIncrementalConductance(voltage, current)
+                          : EVERT_BOOST_CONVERTER_MpptPerturbAndObserve(power);
+
+    // Open circuit, the reference above the string voltage: the power is flat at zero and gives the trackers no
+    // direction, the maximum is below
+    if (power < EVERT_SETTING_BC_MPPT_POWER_OPEN_CIRCUIT)
+    {
+        delta = -EVERT_SETTING_BC_MPPT_VOLTAGE_DIRECTION * EVERT_SETTING_BC_MPPT_STEP_MAX;
+    }
 
-    if (power_increasing)
+    // Curtailed, below the limit: towards the maximum no further than the missing power
+    if (mppt_state.power_limit >= 0.0f)
     {
-        // Power is increasing, if we are cycling up, we are on the right track, if not, we need to change direction
-        mppt_state.current_perturb_step = is_cycling_up ? perturb_size : -perturb_size;
+        float32_t step_max = EVERT_BOOST_CONVERTER_MpptLimitStep(power);
+        EVERT_BOOST_CONVERTER_CLAMP(delta, -step_max, step_max);
+    }
+
+    // A step further into a limit of the range is clamped away and the operating point would stay there (open
+    // circuit at the top, no power until the next sweep): turn around
+    if (mppt_state.operating_point >= EVERT_SETTING_BC_MPPT_OPERATING_POINT_MAX && delta >= 0.0f)
+    {
+        delta = -EVERT_SETTING_BC_MPPT_STEP_MIN;
+    }
+    else if (mppt_state.operating_point <= EVERT_SETTING_BC_MPPT_OPERATING_POINT_MIN && delta <= 0.0f)
+    {
+        delta = EVERT_SETTING_BC_MPPT_STEP_MIN;
+    }
+
+    // Hunting around the maximum: fall back to the smallest step until the direction settles
+    if (delta != 0.0f)
+    {
+        EVERT_OSCILLATION_DETECTOR_InjectData(&mppt_oscillation_detector, delta);
+    }
+
+    mppt_state.oscillating = EVERT_OSCILLATION_DETECTOR_IsOscillating(&mppt_oscillation_detector);
+
+    if (mppt_state.oscillating)
+    {
+        delta = (delta > 0.0f) ? EVERT_SETTING_BC_MPPT_STEP_MIN : ((delta < 0.0f) ? -EVERT_SETTING_BC_MPPT_STEP_MIN : 0.0f);
+    }
+
+    mppt_state.current_perturb_step = delta;
+    EVERT_BOOST_CONVERTER_MpptApply(mppt_state.operating_point + delta);
+}
+
+/// @brief Largest step towards the power limit: the power missing or in excess at the slope just observed
+/// @details A larger step jumps over the band, backs off and cycles around it; near open circuit, where the curve is
+/// steep, a full step off the limit takes several 100 W more than asked
+/// @return Step size, EVERT_SETTING_BC_MPPT_STEP_MAX without a slope (held, start-up)
+static float32_t EVERT_BOOST_CONVERTER_MpptLimitStep(float32_t power)
+{
+    float32_t delta_operating_point = mppt_state.operating_point - mppt_state.previous_operating_point;
+    float32_t delta_power = power - mppt_state.previous_power;
+
+    if ((delta_operating_point < EVERT_SETTING_BC_MPPT_DELTA_EPSILON && delta_operating_point > -EVERT_SETTING_BC_MPPT_DELTA_EPSILON) ||
+        (delta_power < EVERT_SETTING_BC_MPPT_DELTA_EPSILON && delta_power > -EVERT_SETTING_BC_MPPT_DELTA_EPSILON))
+    {
+        return EVERT_SETTING_BC_MPPT_STEP_MAX;
+    }
+
+    float32_t step = (mppt_state.power_limit - power) * delta_operating_point / delta_power;
+    step = (step >= 0.0f) ? step : -step;
+    EVERT_BOOST_CONVERTER_CLAMP(step, EVERT_SETTING_BC_MPPT_STEP_MIN, EVERT_SETTING_BC_MPPT_STEP_MAX);
+
+    return step;
+}
+
+/// @brief Variable-step perturb and observe
+/// @details Step is proportional to |dP/dX|, large far from the maximum and small close to it
+/// @return Signed change of the operating point
+static float32_t EVERT_BOOST_CONVERTER_MpptPerturbAndObserve(float32_t power)
+{
+    float32_t delta_power = power - mppt_state.previous_power;
+    float32_t delta_operating_point = mppt_state.operating_point - mppt_state.previous_operating_point;
+
+    // No previous perturbation (start-up, held), keep going in the last direction. Into a limit of the range
+    // EVERT_BOOST_CONVERTER_MpptObserve turns it around
+    if (delta_operating_point < EVERT_SETTING_BC_MPPT_DELTA_EPSILON && delta_operating_point > -EVERT_SETTING_BC_MPPT_DELTA_EPSILON)
+    {
+        return (mppt_state.current_perturb_step >= 0.0f) ? EVERT_SETTING_BC_MPPT_STEP_MIN : -EVERT_SETTING_BC_MPPT_STEP_MIN;
+    }
+
+    float32_t slope = delta_power / delta_operating_point;
+    float32_t step = EVERT_SETTING_BC_MPPT_STEP_SCALE_PO * ((slope >= 0.0f) ? slope : -slope);
+    EVERT_BOOST_CONVERTER_CLAMP(step, EVERT_SETTING_BC_MPPT_STEP_MIN, EVERT_SETTING_BC_MPPT_STEP_MAX);
+
+    // Move in the direction of increasing power
+    return (slope >= 0.0f) ? step : -step;
+}
+
+/// @brief Incremental conductance
+/// @details At the maximum dP/dV = 0, i.e. dI/dV = -I/V. The sign of dI/dV + I/V tells on which side we are.
+/// @return Signed change of the operating point
+static float32_t EVERT_BOOST_CONVERTER_MpptIncrementalConductance(float32_t voltage, float32_t current)
+{
+    float32_t delta_voltage = voltage - mppt_state.previous_voltage;
+    float32_t delta_current = current - mppt_state.previous_current;
+    float32_t voltage_direction;
+    float32_t step;
+
+    if (voltage < EVERT_SETTING_BC_MPPT_DELTA_EPSILON)
+    {
+        return 0.0f;
+    }
+
+    if (delta_voltage < EVERT_SETTING_BC_MPPT_DELTA_EPSILON && delta_voltage > -EVERT_SETTING_BC_MPPT_DELTA_EPSILON)
+    {
+        // Voltage unchanged, any current change is an irradiance change; follow it
+        if (delta_current < EVERT_SETTING_BC_MPPT_DELTA_EPSILON && delta_current > -EVERT_SETTING_BC_MPPT_DELTA_EPSILON)
+        {
+            return 0.0f;
+        }
+
+        voltage_direction = (delta_current > 0.0f) ? 1.0f : -1.0f;
+        step = EVERT_SETTING_BC_MPPT_STEP_MIN;
     }
     else
     {
-        // Power is decreasing, if we are cycling up; reverse, if not continue
-        mppt_state.current_perturb_step = is_cycling_up ? -perturb_size : +perturb_size;
+        float32_t error = (delta_current / delta_voltage) + (current / voltage);
+
+        if (error < EVERT_SETTING_BC_MPPT_INC_TOLERANCE && error > -EVERT_SETTING_BC_MPPT_INC_TOLERANCE)
+        {
+            return 0.0f;
+        }
+
+        // dP/dV = V * error
+        float32_t slope = voltage * error;
+        voltage_direction = (slope > 0.0f) ? 1.0f : -1.0f;
+        step = EVERT_SETTING_BC_MPPT_STEP_SCALE_INC * ((slope >= 0.0f) ? slope : -slope);
+        EVERT_BOOST_CONVERTER_CLAMP(step, EVERT_SETTING_BC_MPPT_STEP_MIN, EVERT_SETTING_BC_MPPT_STEP_MAX);
     }
+
+    return voltage_direction * EVERT_SETTING_BC_MPPT_VOLTAGE_DIRECTION * step;
 }
 
-void EVERT_BOOST_CONVERTER_MpptPerturb()
+/// @brief Start a global sweep over the full operating range
+/// @details Partial shading gives a P-V curve with several local maxima, the trackers only find the nearest one
+static void EVERT_BOOST_CONVERTER_MpptSweepStart(void)
 {
-    float32_t current_power = fi_power_in;
-    float32_t current_duty_cycle = mppt_state.duty_cycle;
-    float32_t new_duty_cycle = current_duty_cycle + mppt_state.current_perturb_step;
+    mppt_state.phase = BCMP_SWEEPING;
+    mppt_state.sweep_index = 0;
+    mppt_state.sweep_best_operating_point = mppt_state.operating_point;
+    mppt_state.sweep_best_power = fi_power_in;
 
-    // Clamp the new duty cycle
-    EVERT_BOOST_CONVERTER_CLAMP(new_duty_cycle, EVERT_CONSTRAINT_BC_DUTY_CYCLE_MPPT_MIN, EVERT_CONSTRAINT_BC_DUTY_CYCLE_MPPT_MAX);
+    EVERT_BOOST_CONVERTER_MpptApply(EVERT_SETTING_BC_MPPT_OPERATING_POINT_MIN);
+}
 
-    // Set the new duty cycle
-    EVERT_BOOST_CONVERTER_SetDutyCycle(new_duty_cycle);
+static void EVERT_BOOST_CONVERTER_MpptSweepStep(float32_t power)
+{
+    // The power measured now belongs to the operating point applied one observe interval ago
+    if (power > mppt_state.sweep_best_power)
+    {
+        mppt_state.sweep_best_power = power;
+        mppt_state.sweep_best_operating_point = mppt_state.operating_point;
+    }
 
-    // Store the current state
-    mppt_state.previous_duty_cycle = current_duty_cycle;
-    mppt_state.previous_power = current_power;
-}
\ No newline at end of file
+    mppt_state.sweep_index++;
+
+    if (mppt_state.sweep_index < EVERT_SETTING_BC_MPPT_SWEEP_STEPS)
+    {
+        const float32_t range = EVERT_SETTING_BC_MPPT_OPERATING_POINT_MAX - EVERT_SETTING_BC_MPPT_OPERATING_POINT_MIN;
+        EVERT_BOOST_CONVERTER_MpptApply(EVERT_SETTING_BC_MPPT_OPERATING_POINT_MIN + (range * mppt_state.sweep_index) / (EVERT_SETTING_BC_MPPT_SWEEP_STEPS - 1));
+        return;
+    }
+
+    // Sweep done, resume tracking from the best point found
+    EVERT_BOOST_CONVERTER_MpptApply(mppt_state.sweep_best_operating_point);
+    mppt_state.previous_operating_point = mppt_state.operating_point;
+    mppt_state.current_perturb_step = EVERT_SETTING_BC_MPPT_STEP_MIN;
+    mppt_state.phase = BCMP_TRACKING;
+    mppt_state.sweep_timer = 0.0f;
+
+    EVERT_OSCILLATION_DETECTOR_Reset(&mppt_oscillation_detector);
+}
@@ -10,5 +10,8 @@ extern volatile float32_t fi_power_in;
 
 void EVERT_BOOST_CONVERTER_MpptInit(void);
 void EVERT_BOOST_CONVERTER_MpptRun(void);
+void EVERT_BOOST_CONVERTER_MpptSetPowerLimit(const float32_t power_limit);
+void EVERT_BOOST_CONVERTER_MpptDispatch(const float32_t power_limit);
+bool EVERT_BOOST_CONVERTER_MpptIsDispatched(void);
 
 #endif // EVERT_BOOST_CONVERTER_MPPT_H_
\ No newline at end of file
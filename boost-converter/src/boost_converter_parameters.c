@@ -0,0 +1,190 @@
+/**
+ ******************************************************************************
+ * @file    boost_converter_parameters.c
+ * @author  Evert Firmware Team
+ * @brief   Persistent calibrations and constraints for the boost converter
+ *
+ ******************************************************************************
+ **/
+
+#include <math.h>
+#include <string.h>
+#include "boost_converter.h"
+#include "boost_converter_parameters.h"
+
+_Static_assert(BCPK_COUNT <= EVERT_PARAM_STORE_KEY_COUNT, "EVERT_HAL_CONF_PARAM_STORE_KEY_COUNT too small");
+
+extern EVERT_CAN_HandlerTypeDef can_handler;
+
+/// @brief RAM copy each key lives in
+static float32_t *const parameters[BCPK_COUNT] = {
+    [BCPK_CURRENT_IN_SLOPE] = &calibration_current.current_in_slope,
+    [BCPK_CURRENT_IN_INTERCEPT] = &calibration_current.current_in_intercept,
+    [BCPK_VOLTAGE_IN_SLOPE] = &calibration_voltage.voltage_in_slope,
+    [BCPK_VOLTAGE_IN_INTERCEPT] = &calibration_voltage.voltage_in_intercept,
+    [BCPK_VOLTAGE_OUT_SLOPE] = &calibration_voltage.voltage_out_slope,
+    [BCPK_VOLTAGE_OUT_INTERCEPT] = &calibration_voltage.voltage_out_intercept,
+
+    [BCPK_CURRENT_HYSTERESIS] = &constraints_current.current_hysteresis,
+    [BCPK_CURRENT_HIGH_CRITICAL] = &constraints_current.current_high_critical,
+    [BCPK_CURRENT_HIGH_WARNING] = &constraints_current.current_high_warning,
+    [BCPK_COIL_TEMP_HYSTERESIS] = &constraints_temperature.coil_temp_hysteresis,
+    [BCPK_COIL_TEMP_CRITICAL] = &constraints_temperature.coil_temp_critical,
+    [BCPK_COIL_TEMP_WARNING] = &constraints_temperature.coil_temp_warning,
+    [BCPK_SCHOTTKY_TEMP_HYSTERESIS] = &constraints_temperature.schottky_temp_hysteresis,
+    [BCPK_SCHOTTKY_TEMP_CRITICAL] = &constraints_temperature.schottky_temp_critical,
+    [BCPK_SCHOTTKY_TEMP_WARNING] = &constraints_temperature.schottky_temp_warning,
+    [BCPK_MOSFET_TEMP_HYSTERESIS] = &constraints_temperature.mosfet_temp_hysteresis,
+    [BCPK_MOSFET_TEMP_CRITICAL] = &constraints_temperature.mosfet_temp_critical,
+    [BCPK_MOSFET_TEMP_WARNING] = &constraints_temperature.mosfet_temp_warning,
+    [BCPK_VOLTAGE_OUT_HYSTERESIS] = &constraints_voltage.voltage_out_hysteresis,
+    [BCPK_VOLTAGE_OUT_HIGH_CRITICAL] = &constraints_voltage.voltage_out_high_critical,
+    [BCPK_VOLTAGE_OUT_HIGH_WARNING] = &constraints_voltage.voltage_out_high_warning,
+    [BCPK_VOLTAGE_IN_HYSTERESIS] = &constraints_voltage.voltage_in_hysteresis,
+    [BCPK_VOLTAGE_IN_HIGH_CRITICAL] = &constraints_voltage.voltage_in_high_critical,
+    [BCPK_VOLTAGE_IN_HIGH_WARNING] = &constraints_voltage.voltage_in_high_warning,
+    [BCPK_VOLTAGE_IN_LOW_WARNING] = &constraints_voltage.voltage_in_low_warning,
+    [BCPK_VOLTAGE_IN_LOW_CRITICAL] = &constraints_voltage.voltage_in_low_critical,
+};
+
+/// @brief Compiled-in values, restored by an erase
+static float32_t parameter_defaults[BCPK_COUNT];
+
+/// @brief Accepted range of a written value, PSS_OUT_OF_RANGE outside it
+static const struct
+{
+    float32_t min;
+    float32_t max;
+} parameter_ranges[BCPK_COUNT] = {
+    [BCPK_CURRENT_IN_SLOPE] = {-0.05f, 0.05f}, // A per ADC count
+    [BCPK_CURRENT_IN_INTERCEPT] = {-50.0f, 50.0f},
+    [BCPK_VOLTAGE_IN_SLOPE] = {-0.5f, 0.5f}, // V per ADC count
+    [BCPK_VOLTAGE_IN_INTERCEPT] = {-500.0f, 500.0f},
+    [BCPK_VOLTAGE_OUT_SLOPE] = {-0.5f, 0.5f},
+    [BCPK_VOLTAGE_OUT_INTERCEPT] = {-1000.0f, 1000.0f},
+
+    [BCPK_CURRENT_HYSTERESIS] = {0.0f, 5.0f}, // A
+    [BCPK_CURRENT_HIGH_CRITICAL] = {0.0f, 20.0f},
+    [BCPK_CURRENT_HIGH_WARNING] = {0.0f, 20.0f},
+    [BCPK_COIL_TEMP_HYSTERESIS] = {0.0f, 20.0f}, // deg C
+    [BCPK_COIL_TEMP_CRITICAL] = {0.0f, 150.0f},
+    [BCPK_COIL_TEMP_WARNING] = {0.0f, 150.0f},
+    [BCPK_SCHOTTKY_TEMP_HYSTERESIS] = {0.0f, 20.0f},
+    [BCPK_SCHOTTKY_TEMP_CRITICAL] = {0.0f, 150.0f},
+    [BCPK_SCHOTTKY_TEMP_WARNING] = {0.0f, 150.0f},
+    [BCPK_MOSFET_TEMP_HYSTERESIS] = {0.0f, 20.0f},
+    [BCPK_MOSFET_TEMP_CRITICAL] = {0.0f, 150.0f},
+    [BCPK_MOSFET_TEMP_WARNING] = {0.0f, 150.0f},
+    [BCPK_VOLTAGE_OUT_HYSTERESIS] = {0.0f, 100.0f}, // V
+    [BCPK_VOLTAGE_OUT_HIGH_CRITICAL] = {0.0f, 1000.0f},
+    [BCPK_VOLTAGE_OUT_HIGH_WARNING] = {0.0f, 1000.0f},
+    [BCPK_VOLTAGE_IN_HYSTERESIS] = {0.0f, 50.0f},
+    [BCPK_VOLTAGE_IN_HIGH_CRITICAL] = {0.0f, 300.0f},
+    [BCPK_VOLTAGE_IN_HIGH_WARNING] = {0.0f, 300.0f},
+    [BCPK_VOLTAGE_IN_LOW_WARNING] = {0.0f, 300.0f},
+    [BCPK_VOLTAGE_IN_LOW_CRITICAL] = {0.0f, 300.0f},
+};
+
+/// @brief Load the stored parameters over the compiled-in defaults
+/// @details Call after EVERT_BOOST_CONVERTER_InitCalibrations/InitConstraints
+void EVERT_BOOST_CONVERTER_ParametersInit(void)
+{
+    for (uint32_t key = 0; key < BCPK_COUNT; key++)
+    {
+        parameter_defaults[key] = *parameters[key];
+    }
+
+    if (EVERT_PARAM_STORE_Init() != PSS_OK)
+    {
+        // Keep running on the defaults, reads/writes report PSS_NOT_INITIALIZED
+        EVERT_HAL_BreakPoint("Parameter store init failed\n");
+        return;
+    }
+
+    for (uint32_t key = 0; key < BCPK_COUNT; key++)
+    {
+        EVERT_PARAM_STORE_GetFloat(key, parameters[key]);
+    }
+}
+
+/// @brief Answer with the key, the status and the value now in use
+static void EVERT_BOOST_CONVERTER_ParametersSendValue(const uint8_t key, const EVERT_PARAM_STORE_StatusTypeDef status)
+{
+    uint8_t data[7] = {0};
+
+    data[0] = BCCM_PARAM_VALUE;
+    data[1] = key;
+    data[2] = status;
+
+    if (key < BCPK_COUNT)
+    {
+        memcpy(&data[3], parameters[key], sizeof(float32_t));
+    }
+
+    if (EVERT_CAN_Handler_Transmit(&can_handler, sizeof(data), data) != CAN_FS_OK)
+    {
+        EVERT_HAL_BreakPoint("CAN Error: Parameter Value\n");
+    }
+}
+
+void EVERT_BOOST_CONVERTER_ParametersOnRead(const uint8_t key)
+{
+    float32_t value;
+    EVERT_PARAM_STORE_StatusTypeDef status = key < BCPK_COUNT ? EVERT_PARAM_STORE_GetFloat(key, &value) : PSS_INVALID_KEY;
+
+    // PSS_NOT_FOUND: the default is in use
+    EVERT_BOOST_CONVERTER_ParametersSendValue(key, status);
+}
+
+/// @brief Whether a write or an erase of the key is taken now
+/// @details Calibrations and constraints change the readings and the alarm levels the power stage runs on,
+///          they are only swapped with it off (BCS_STANDBY)
+static EVERT_PARAM_STORE_StatusTypeDef EVERT_BOOST_CONVERTER_ParametersWritable(const uint8_t key)
+{
+    if (key >= BCPK_COUNT)
+    {
+        return PSS_INVALID_KEY;
+    }
+
+    return mppt_state.status == BCS_STANDBY ? PSS_OK : PSS_BUSY;
+}
+
+void EVERT_BOOST_CONVERTER_ParametersOnWrite(const uint8_t key, const float32_t value)
+{
+    EVERT_PARAM_STORE_StatusTypeDef status = EVERT_BOOST_CONVERTER_ParametersWritable(key);
+
+    if (status == PSS_OK && (!isfinite(value) || value < parameter_ranges[key].min || value > parameter_ranges[key].max))
+    {
+        status = PSS_OUT_OF_RANGE;
+    }
+
+    if (status == PSS_OK)
+    {
+        status = EVERT_PARAM_STORE_SetFloat(key, value);
+    }
+
+    // Takes effect right away, the next readings/alarm check use it
+    if (status == PSS_OK)
+    {
+        *parameters[key] = value;
+    }
+
+    EVERT_BOOST_CONVERTER_ParametersSendValue(key, status);
+}
+
+void EVERT_BOOST_CONVERTER_ParametersOnErase(const uint8_t key)
+{
+    EVERT_PARAM_STORE_StatusTypeDef status = EVERT_BOOST_CONVERTER_ParametersWritable(key);
+
+    if (status == PSS_OK)
+    {
+        status = EVERT_PARAM_STORE_Erase(key);
+    }
+
+    if (status == PSS_OK)
+    {
+        *parameters[key] = parameter_defaults[key];
+    }
+
+    EVERT_BOOST_CONVERTER_ParametersSendValue(key, status);
+}
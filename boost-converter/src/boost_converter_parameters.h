@@ -0,0 +1,63 @@
+/**
+ ******************************************************************************
+ * @file    boost_converter_parameters.h
+ * @author  Evert Firmware Team
+ * @brief   Persistent calibrations and constraints for the boost converter
+ *          * Defaults: _conf_evert_boost_converter.h (EVERT_CALIBRATION_BC_*, EVERT_CONSTRAINT_BC_*)
+ *          * Storage: param_store.h, a stored value overrides the default at boot
+ *          * CAN: BCCM_PARAM_READ/WRITE/ERASE, answered with BCCM_PARAM_VALUE
+ *          * Writes and erases only in BCS_STANDBY (PSS_BUSY), written values finite and inside the range of
+ *            the key (PSS_OUT_OF_RANGE)
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_BOOST_CONVERTER_PARAMETERS_H_
+#define EVERT_BOOST_CONVERTER_PARAMETERS_H_
+
+#include <stdint.h>
+#include "arm_math.h"
+#include "_conf_evert_boost_converter.h"
+
+/// @brief Parameter keys for the boost converter
+/// @details Persisted in flash, never renumber (new keys go before BCPK_COUNT)
+typedef enum
+{
+    // Calibrations
+    BCPK_CURRENT_IN_SLOPE = 0,
+    BCPK_CURRENT_IN_INTERCEPT = 1,
+    BCPK_VOLTAGE_IN_SLOPE = 2,
+    BCPK_VOLTAGE_IN_INTERCEPT = 3,
+    BCPK_VOLTAGE_OUT_SLOPE = 4,
+    BCPK_VOLTAGE_OUT_INTERCEPT = 5,
+
+    // Constraints
+    BCPK_CURRENT_HYSTERESIS = 6,
+    BCPK_CURRENT_HIGH_CRITICAL = 7,
+    BCPK_CURRENT_HIGH_WARNING = 8,
+    BCPK_COIL_TEMP_HYSTERESIS = 9,
+    BCPK_COIL_TEMP_CRITICAL = 10,
+    BCPK_COIL_TEMP_WARNING = 11,
+    BCPK_SCHOTTKY_TEMP_HYSTERESIS = 12,
+    BCPK_SCHOTTKY_TEMP_CRITICAL = 13,
+    BCPK_SCHOTTKY_TEMP_WARNING = 14,
+    BCPK_MOSFET_TEMP_HYSTERESIS = 15,
+    BCPK_MOSFET_TEMP_CRITICAL = 16,
+    BCPK_MOSFET_TEMP_WARNING = 17,
+    BCPK_VOLTAGE_OUT_HYSTERESIS = 18,
+    BCPK_VOLTAGE_OUT_HIGH_CRITICAL = 19,
+    BCPK_VOLTAGE_OUT_HIGH_WARNING = 20,
+    BCPK_VOLTAGE_IN_HYSTERESIS = 21,
+    BCPK_VOLTAGE_IN_HIGH_CRITICAL = 22,
+    BCPK_VOLTAGE_IN_HIGH_WARNING = 23,
+    BCPK_VOLTAGE_IN_LOW_WARNING = 24,
+    BCPK_VOLTAGE_IN_LOW_CRITICAL = 25,
+
+    BCPK_COUNT
+} EVERT_BOOST_CONVERTER_ParameterKeyTypeDef;
+
+void EVERT_BOOST_CONVERTER_ParametersInit(void);
+void EVERT_BOOST_CONVERTER_ParametersOnRead(const uint8_t key);
+void EVERT_BOOST_CONVERTER_ParametersOnWrite(const uint8_t key, const float32_t value);
+void EVERT_BOOST_CONVERTER_ParametersOnErase(const uint8_t key);
+
+#endif // EVERT_BOOST_CONVERTER_PARAMETERS_H_
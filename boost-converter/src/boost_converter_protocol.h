@@ -0,0 +1,54 @@
+/**
+ ******************************************************************************
+ * @file    boost_converter_protocol.h
+ * @author  Evert Firmware Team
+ * @brief   CAN methods of the Evert Boost Converter
+ *          * Data: [0] method, the rest per method, mirrored on the host side by ccu/src/ccu_protocol.h
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_BOOST_CONVERTER_PROTOCOL_H_
+#define EVERT_BOOST_CONVERTER_PROTOCOL_H_
+
+/// @brief CAN method enumeration for the boost converter
+/// @details First data byte of every frame addressed to/sent by the boost converter
+typedef enum
+{
+    BCCM_SET_RUNNING = 1,       // [1] 0 = standby, otherwise running
+    BCCM_INTERLEAVE_CONFIG = 2, // [1] phase index, [2] phase count
+    BCCM_CURRENT_SHARE = 3,     // [1..4] input current (float32), [5] phase index, [6] running
+    BCCM_PARAM_READ = 4,        // [1] key (boost_converter_parameters.h)
+    BCCM_PARAM_WRITE = 5,       // [1] key, [3..6] value (float32), stored and applied
+    BCCM_PARAM_ERASE = 6,       // [1] key, back to the compiled-in default
+    BCCM_PARAM_VALUE = 7,       // [1] key, [2] status (EVERT_PARAM_STORE_StatusTypeDef), [3..6] value in use (float32)
+    BCCM_VAR_READ = 8,          // [1..2] id (boost_converter_registry.h)
+    BCCM_VAR_WRITE = 9,         // [1..2] id, [3..6] value (raw bits, low bytes for narrow types)
+    BCCM_VAR_SUBSCRIBE = 10,    // [1..2] id, [3..4] period ms, 0 = unsubscribe (id 0xFFFF: all)
+    BCCM_VAR_LIST = 11,         // [1..2] index in the registry table
+    BCCM_VAR_VALUE = 12,        // [1..2] id, [3..6] value
+    BCCM_VAR_STATUS = 13,       // [1..2] id, [3] status (EVERT_REGISTRY_StatusTypeDef), [4] subscription slot
+    BCCM_VAR_ENTRY = 14,        // [1..2] id, [3] type << 4 | access, [4..6] name hash bits 0-23
+    BCCM_VAR_STREAM = 15,       // [1..6] [slot][value]... of the due subscriptions
+    BCCM_FAULT_READ = 16,       // [1] record index, 0 = newest (boost_converter_fault.h)
+    BCCM_FAULT_SUMMARY = 17,    // [1] reset flags (RCC->CSR >> 24), [2] type (EVERT_FAULT_RECORD_TypeTypeDef), [3..6] pc
+    BCCM_FAULT_CHUNK = 18,      // [1] chunk, [2..6] record bytes from chunk * 5
+    BCCM_DEVICE_STATE = 19,     // [1] result, [2] internal, [3] propagated state, [4..6] version (announcement/status)
+    BCCM_DEVICE_ACK = 20,       // CCU acknowledged the announcement
+    BCCM_DEVICE_HEARTBEAT = 21, // [1] propagated state (EVERT_DEVICE_StateTypeDef), within EVERT_SETTING_DEVICE_HEARTBEAT_TIMEOUT
+    BCCM_DEVICE_RESET = 22,     // Clear an emergency shutdown once the critical alarms are gone
+    BCCM_POWER_LIMIT = 23,      // [1..4] input power limit in W (float32), negative = unlimited (CCU dispatch)
+    BCCM_POWER_LIMIT_BATCH = 24, // Broadcast, [1..6] input power limits in W (uint16) of the devices 3 * message id + 1..3, 0xFFFF = unlimited, 0xFFFE = unchanged
+    BCCM_POWER_REPORT = 25,     // [1..2] input power W, [3..4] available power W (uint16), [5..6] output voltage in 0.1 V (uint16)
+    BCCM_TIME_SYNC = 26,        // Broadcast, message id = sequence, the start of frame is the sync point (time_sync.h)
+    BCCM_TIME_FOLLOW_UP = 27,   // Broadcast, message id = sequence of the SYNC, [1..6] CCU time of its start of frame in us (48 bit)
+    BCCM_TELEMETRY_LIST = 28,   // [1] first index: the delta telemetry table from there on (boost_converter_telemetry.h), 0 also asks for a keyframe
+    BCCM_TELEMETRY_SIGNAL = 29, // Message id = index, [1..2] id (0xFFFF: past the end), [3..6] resolution (float32)
+    BCCM_TELEMETRY_FRAME = 30,  // Message id = sequence, [1..6] payload (delta_telemetry.h)
+    BCCM_UPDATE_BEGIN = 31,     // [1..4] application bytes: erase the update slot (boost_converter_update.h)
+    BCCM_UPDATE_DATA = 32,      // Message id = block index bits 0-7, [1..6] stream bytes from block * 6 (image header, application)
+    BCCM_UPDATE_STATUS = 33,    // Message id 1: gap in the blocks, [1] state (EVERT_FIRMWARE_UPDATE_StateTypeDef), [2] result (EVERT_FIRMWARE_UPDATE_ResultTypeDef), [3..6] stream bytes taken
+    BCCM_UPDATE_END = 34,       // Stream complete: check it, FUS_READY once it holds
+    BCCM_UPDATE_ACTIVATE = 35,  // Boot the new image, standby only
+} EVERT_BOOST_CONVERTER_CanMethodTypeDef;
+
+#endif // EVERT_BOOST_CONVERTER_PROTOCOL_H_
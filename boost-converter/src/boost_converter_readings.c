@@ -41,6 +41,11 @@ float32_t firstate_voltage_in[FIR_NUM_TAPS + FIR_BLOCK_SIZE - 1];  // State buff
 float32_t firstate_voltage_out[FIR_NUM_TAPS + FIR_BLOCK_SIZE - 1]; // State buffer
 float32_t firstate_current_in[FIR_NUM_TAPS + FIR_BLOCK_SIZE - 1];  // State buffer
 
+// ADC Converted 'real-time' values (not averaged, used by the control loops)
+volatile float32_t rt_voltage_in;
+volatile float32_t rt_voltage_out;
+volatile float32_t rt_current_in;
+
 // ADC Converted 'filtered' values
 volatile float32_t fi_mcu_temperature;
 volatile float32_t fi_mcu_vref_int;
@@ -49,6 +54,9 @@ volatile float32_t fi_voltage_out;
 volatile float32_t fi_current_in;
 volatile float32_t fi_power_in;
 
+// HF readings since the ADC started, saturates
+volatile uint32_t readings_sample_count = 0;
+
 void EVERT_BOOST_CONVERTER_InitFilters(void)
 {
     arm_fir_init_f32(&fir_voltage_in, FIR_NUM_TAPS, FIR_COEFFS, firstate_voltage_in, FIR_BLOCK_SIZE);
@@ -58,7 +66,21 @@ void EVERT_BOOST_CONVERTER_InitFilters(void)
 
 void EVERT_BOOST_CONVERTER_Readings(void)
 {
-    // ADC 1
+    // Real-time values, the EMA and FIR below add several ms of delay which the control loops can not afford
+    rt_voltage_in = EVERT_HAL_ADC_Lerp(adc1_buffer[EVERT_CONSTANT_BC_ADC1_RANK_VOLTAGE_IN], calibration_voltage.voltage_in_slope, calibration_voltage.voltage_in_intercept);
+    rt_voltage_out = EVERT_HAL_ADC_Lerp(adc1_buffer[EVERT_CONSTANT_BC_ADC1_RANK_VOLTAGE_OUT], calibration_voltage.voltage_out_slope, calibration_voltage.voltage_out_intercept);
+    rt_current_in = EVERT_HAL_ADC_Lerp(adc1_buffer[EVERT_CONSTANT_BC_ADC1_RANK_CURRENT_IN], calibration_current.current_in_slope, calibration_current.current_in_intercept);
+
+    // ADC 1, the first sample seeds the EMAs instead of rising from 0 over ~160 samples
+    if (readings_sample_count == 0)
+    {
+        adc_mcu_temperature = adc1_buffer[EVERT_CONSTANT_BC_ADC1_RANK_MCU_TEMPERATURE];
+        adc_mcu_vref_int = adc1_buffer[EVERT_CONSTANT_BC_ADC1_RANK_MCU_VREF_INT];
+        adc_voltage_in = adc1_buffer[EVERT_CONSTANT_BC_ADC1_RANK_VOLTAGE_IN];
+        adc_voltage_out = adc1_buffer[EVERT_CONSTANT_BC_ADC1_RANK_VOLTAGE_OUT];
+        adc_current_in = adc1_buffer[EVERT_CONSTANT_BC_ADC1_RANK_CURRENT_IN];
+    }
+
     EVERT_BOOST_CONVERTER_EMA(adc1_buffer[EVERT_CONSTANT_BC_ADC1_RANK_MCU_TEMPERATURE], adc_mcu_temperature, 0.05f);
     EVERT_BOOST_CONVERTER_EMA(adc1_buffer[EVERT_CONSTANT_BC_ADC1_RANK_MCU_VREF_INT], adc_mcu_vref_int, 0.05f);
     EVERT_BOOST_CONVERTER_EMA(adc1_buffer[EVERT_CONSTANT_BC_ADC1_RANK_VOLTAGE_IN], adc_voltage_in, 0.05f);
@@ -72,14 +94,30 @@ void EVERT_BOOST_CONVERTER_Readings(void)
     uf_voltage_out = EVERT_HAL_ADC_Lerp(adc_voltage_out, calibration_voltage.voltage_out_slope, calibration_voltage.voltage_out_intercept);
     uf_current_in = EVERT_HAL_ADC_Lerp(adc_current_in, calibration_current.current_in_slope, calibration_current.current_in_intercept);
 
-    // Update filtered values
-    arm_fir_f32(&fir_voltage_in, &uf_voltage_in, &fi_voltage_in, 1);
-    arm_fir_f32(&fir_voltage_out, &uf_voltage_out, &fi_voltage_out, 1);
-    arm_fir_f32(&fir_current_in, &uf_current_in, &fi_current_in, 1);
+    // Update filtered values, through locals: the FIR takes no volatile pointers
+    const float32_t unfiltered[3] = {uf_voltage_in, uf_voltage_out, uf_current_in};
+    float32_t filtered[3];
+    arm_fir_f32(&fir_voltage_in, &unfiltered[0], &filtered[0], 1);
+    arm_fir_f32(&fir_voltage_out, &unfiltered[1], &filtered[1], 1);
+    arm_fir_f32(&fir_current_in, &unfiltered[2], &filtered[2], 1);
+    fi_voltage_in = filtered[0];
+    fi_voltage_out = filtered[1];
+    fi_current_in = filtered[2];
 
     EVERT_BOOST_CONVERTER_CLAMP(fi_voltage_in, 0.0f, 1000.0f);
     EVERT_BOOST_CONVERTER_CLAMP(fi_voltage_out, 0.0f, 1000.0f);
     EVERT_BOOST_CONVERTER_CLAMP(fi_current_in, 0.0f, 15.0f);
 
     fi_power_in = fi_voltage_in * fi_current_in;
+
+    if (readings_sample_count < UINT32_MAX)
+    {
+        readings_sample_count++;
+    }
+}
+
+/// @brief Filtered readings valid, ends DS_BOOTING_ADC
+bool EVERT_BOOST_CONVERTER_ReadingsSettled(void)
+{
+    return readings_sample_count >= EVERT_CONSTANT_BC_READINGS_SETTLE_SAMPLES;
 }
\ No newline at end of file
@@ -19,6 +19,9 @@
 #define FIR_NUM_TAPS 51  // Number of filter taps
 #define FIR_BLOCK_SIZE 1 // Process one sample at a time
 
+// Readings settled: the FIR states filled, the EMAs start from the first sample (5.1 ms at 10 kHz)
+#define EVERT_CONSTANT_BC_READINGS_SETTLE_SAMPLES (FIR_NUM_TAPS)
+
 // ADC Buffers
 extern volatile uint16_t adc1_buffer[EVERT_CONSTANT_BC_ADC1_CONVERSION_COUNT];
 
@@ -36,6 +39,11 @@ extern volatile float32_t uf_voltage_in;
 extern volatile float32_t uf_voltage_out;
 extern volatile float32_t uf_current_in;
 
+// ADC Converted 'real-time' values (not averaged, used by the control loops)
+extern volatile float32_t rt_voltage_in;
+extern volatile float32_t rt_voltage_out;
+extern volatile float32_t rt_current_in;
+
 // ADC Converted 'filtered' values
 extern volatile float32_t fi_mcu_temperature;
 extern volatile float32_t fi_mcu_vref_int;
@@ -44,7 +52,10 @@ extern volatile float32_t fi_voltage_out;
 extern volatile float32_t fi_current_in;
 extern volatile float32_t fi_power_in;
 
+extern volatile uint32_t readings_sample_count;
+
 void EVERT_BOOST_CONVERTER_InitFilters(void);
 void EVERT_BOOST_CONVERTER_Readings(void);
+bool EVERT_BOOST_CONVERTER_ReadingsSettled(void);
 
 #endif // EVERT_BOOST_CONVERTER_READINGS_H_
\ No newline at end of file
@@ -0,0 +1,184 @@
+/**
+ ******************************************************************************
+ * @file    boost_converter_registry.c
+ * @author  Evert Firmware Team
+ * @brief   Remote read/write/subscribe of boost converter variables over CAN
+ *
+ ******************************************************************************
+ **/
+
+#include <string.h>
+#include "boost_converter.h"
+#include "boost_converter_registry.h"
+
+extern EVERT_CAN_HandlerTypeDef can_handler;
+
+// Readings
+EVERT_REGISTRY_VARIABLE(BCRV_VOLTAGE_IN, fi_voltage_in, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_VOLTAGE_OUT, fi_voltage_out, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_CURRENT_IN, fi_current_in, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_POWER_IN, fi_power_in, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_MCU_TEMPERATURE, fi_mcu_temperature, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_VOLTAGE_IN_RAW, rt_voltage_in, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_VOLTAGE_OUT_RAW, rt_voltage_out, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_CURRENT_IN_RAW, rt_current_in, RGT_F32, RGA_READ);
+
+// MPPT
+EVERT_REGISTRY_VARIABLE(BCRV_MPPT_STATUS, mppt_state.status, EVERT_REGISTRY_TYPE_OF_ENUM(mppt_state.status), RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_MPPT_PHASE, mppt_state.phase, EVERT_REGISTRY_TYPE_OF_ENUM(mppt_state.phase), RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_MPPT_DUTY_CYCLE, mppt_state.duty_cycle, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_MPPT_OPERATING_POINT, mppt_state.operating_point, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_MPPT_OSCILLATING, mppt_state.oscillating, RGT_BOOL, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_MPPT_CURRENT_PERTURB_STEP, mppt_state.current_perturb_step, RGT_F32, RGA_READ_WRITE);
+EVERT_REGISTRY_VARIABLE(BCRV_MPPT_POWER_LIMIT, mppt_state.power_limit, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_MPPT_AVAILABLE_POWER, mppt_state.available_power, RGT_F32, RGA_READ);
+
+// Control
+EVERT_REGISTRY_VARIABLE(BCRV_CONTROL_VOLTAGE_REFERENCE, control_state.voltage_reference, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_CONTROL_CURRENT_REFERENCE, control_state.current_reference, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_CONTROL_DUTY_FEED_FORWARD, control_state.duty_cycle_feed_forward, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_CONTROL_ENABLED, control_state.enabled, RGT_BOOL, RGA_READ);
+
+// Interleave
+EVERT_REGISTRY_VARIABLE(BCRV_INTERLEAVE_PHASE_INDEX, interleave_state.phase_index, RGT_U8, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_INTERLEAVE_PHASE_COUNT, interleave_state.phase_count, RGT_U8, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_INTERLEAVE_PEER_CURRENT, interleave_state.peer_current, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_INTERLEAVE_SHARE_TRIM, interleave_state.share_trim, RGT_F32, RGA_READ);
+
+// CAN, the load in 1/1000 of the bit rate, the waits in us
+EVERT_REGISTRY_VARIABLE(BCRV_CAN_LOAD, can_handler.statistics.load_permille, RGT_U16, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_CAN_LOAD_PEAK, can_handler.statistics.load_peak_permille, RGT_U16, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_CAN_RX_FRAMES, can_handler.statistics.rx_frame_count, RGT_U32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_CAN_TX_FRAMES, can_handler.statistics.tx_frame_count, RGT_U32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_CAN_RX_BUFFER_HIGH_WATER, can_handler.statistics.rx_buffer_high_water, RGT_U16, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_CAN_TX_BUFFER_HIGH_WATER, can_handler.statistics.tx_buffer_high_water, RGT_U16, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_CAN_RX_BUFFER_FULL, can_handler.statistics.rx_buffer_full_count, RGT_U32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_CAN_TX_BUFFER_FULL, can_handler.statistics.tx_buffer_full_count, RGT_U32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_CAN_RX_FIFO_LOST, can_handler.statistics.rx_fifo_lost_count, RGT_U32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_CAN_TX_WAIT_AVERAGE, can_handler.statistics.tx_wait_average_us, RGT_U32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_CAN_TX_WAIT_MAX, can_handler.statistics.tx_wait_max_us, RGT_U32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_CAN_RX_WAIT_MAX, can_handler.statistics.rx_wait_max_us, RGT_U32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_CAN_REC, can_handler.statistics.rec, RGT_U8, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_CAN_TEC, can_handler.statistics.tec, RGT_U8, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_CAN_PSR, can_handler.statistics.psr, RGT_U32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_CAN_BUS_OFF, can_handler.statistics.bus_off_count, RGT_U32, RGA_READ);
+
+// Time synchronization, the error of the last pair in us, the rate in ppb
+EVERT_REGISTRY_VARIABLE(BCRV_TIME_SYNC_LOCKED, time_sync.locked, RGT_BOOL, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_TIME_SYNC_ERROR, time_sync.error_us, RGT_I32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_TIME_SYNC_RATE, time_sync.rate_ppb, RGT_I32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_TIME_SYNC_STEPS, time_sync.step_count, RGT_U32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_TIME_SYNC_MISMATCHES, time_sync.mismatch_count, RGT_U32, RGA_READ);
+
+// Boot phases in ms, time to operational after a reset
+EVERT_REGISTRY_VARIABLE(BCRV_BOOT_INIT, device_boot_timing.InitMs, RGT_U32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_BOOT_ADC, device_boot_timing.AdcMs, RGT_U32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_BOOT_COMMS, device_boot_timing.CommsMs, RGT_U32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_BOOT_HANDSHAKE, device_boot_timing.HandshakeMs, RGT_U32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_BOOT_OPERATIONAL, device_boot_timing.OperationalMs, RGT_U32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_BOOT_ADC_TIMEOUT, device_boot_timing.AdcTimeout, RGT_BOOL, RGA_READ);
+EVERT_REGISTRY_VARIABLE(BCRV_BOOT_ADC_SAMPLES, readings_sample_count, RGT_U32, RGA_READ);
+
+static void EVERT_BOOST_CONVERTER_RegistryTransmit(const uint8_t *data, const uint8_t length)
+{
+    if (EVERT_CAN_Handler_Transmit(&can_handler, length, data) != CAN_FS_OK)
+    {
+        EVERT_HAL_BreakPoint("CAN Error: Registry\n");
+    }
+}
+
+/// @brief [1..2] id, [3] status, [4] slot (subscriptions)
+static void EVERT_BOOST_CONVERTER_RegistrySendStatus(const uint16_t id, const EVERT_REGISTRY_StatusTypeDef status, const uint8_t slot)
+{
+    uint8_t data[5] = {BCCM_VAR_STATUS};
+
+    memcpy(&data[1], &id, sizeof(id));
+    data[3] = status;
+    data[4] = slot;
+
+    EVERT_BOOST_CONVERTER_RegistryTransmit(data, sizeof(data));
+}
+
+/// @brief [1..2] id, [3..6] value, errors go out as BCCM_VAR_STATUS
+static void EVERT_BOOST_CONVERTER_RegistrySendValue(const uint16_t id)
+{
+    uint32_t value;
+    EVERT_REGISTRY_StatusTypeDef status = EVERT_REGISTRY_Read(id, &value);
+
+    if (status != RGS_OK)
+    {
+        EVERT_BOOST_CONVERTER_RegistrySendStatus(id, status, 0);
+        return;
+    }
+
+    uint8_t data[7] = {BCCM_VAR_VALUE};
+    memcpy(&data[1], &id, sizeof(id));
+    memcpy(&data[3], &value, sizeof(value));
+
+    EVERT_BOOST_CONVERTER_RegistryTransmit(data, sizeof(data));
+}
+
+void EVERT_BOOST_CONVERTER_RegistryInit(void)
+{
+    EVERT_REGISTRY_Init();
+}
+
+void EVERT_BOOST_CONVERTER_RegistryOnRead(const uint16_t id)
+{
+    EVERT_BOOST_CONVERTER_RegistrySendValue(id);
+}
+
+void EVERT_BOOST_CONVERTER_RegistryOnWrite(const uint16_t id, const uint32_t value)
+{
+    EVERT_REGISTRY_StatusTypeDef status = EVERT_REGISTRY_Write(id, value);
+
+    if (status != RGS_OK)
+    {
+        EVERT_BOOST_CONVERTER_RegistrySendStatus(id, status, 0);
+        return;
+    }
+
+    // Read back, the host sees what the device holds now
+    EVERT_BOOST_CONVERTER_RegistrySendValue(id);
+}
+
+void EVERT_BOOST_CONVERTER_RegistryOnSubscribe(const uint16_t id, const uint16_t period_ms)
+{
+    uint8_t slot = 0;
+    EVERT_REGISTRY_StatusTypeDef status = (period_ms == 0) ? EVERT_REGISTRY_Unsubscribe(id) : EVERT_REGISTRY_Subscribe(id, period_ms, &slot);
+
+    EVERT_BOOST_CONVERTER_RegistrySendStatus(id, status, slot);
+}
+
+/// @brief [1..2] id, [3] type << 4 | access, [4..6] name hash bits 0-23
+void EVERT_BOOST_CONVERTER_RegistryOnList(const uint16_t index)
+{
+    const EVERT_REGISTRY_EntryTypeDef *entry = EVERT_REGISTRY_GetEntry(index);
+
+    if (entry == NULL)
+    {
+        EVERT_BOOST_CONVERTER_RegistrySendStatus(EVERT_REGISTRY_ID_ALL, RGS_NOT_FOUND, 0);
+        return;
+    }
+
+    uint8_t data[7] = {BCCM_VAR_ENTRY};
+    memcpy(&data[1], &entry->id, sizeof(entry->id));
+    data[3] = (uint8_t)(entry->type << 4 | entry->access);
+    memcpy(&data[4], &entry->name_hash, 3);
+
+    EVERT_BOOST_CONVERTER_RegistryTransmit(data, sizeof(data));
+}
+
+/// @brief Send the due subscriptions, call from the main loop
+void EVERT_BOOST_CONVERTER_RegistryProcess(const uint32_t delta_ms)
+{
+    EVERT_REGISTRY_Update(delta_ms);
+
+    uint8_t data[7] = {BCCM_VAR_STREAM};
+    uint32_t length;
+
+    while ((length = EVERT_REGISTRY_Pack(&data[1], sizeof(data) - 1)) > 0)
+    {
+        EVERT_BOOST_CONVERTER_RegistryTransmit(data, (uint8_t)(length + 1));
+    }
+}
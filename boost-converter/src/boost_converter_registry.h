@@ -0,0 +1,96 @@
+/**
+ ******************************************************************************
+ * @file    boost_converter_registry.h
+ * @author  Evert Firmware Team
+ * @brief   Remote read/write/subscribe of boost converter variables over CAN
+ *          * Table: registry.h, entries in boost_converter_registry.c (BCRV_* ids)
+ *          * CAN: BCCM_VAR_READ/WRITE/SUBSCRIBE/LIST, answered with BCCM_VAR_VALUE/STATUS/ENTRY
+ *          * Subscriptions go out as BCCM_VAR_STREAM frames, [slot][value]... packed
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_BOOST_CONVERTER_REGISTRY_H_
+#define EVERT_BOOST_CONVERTER_REGISTRY_H_
+
+#include <stdint.h>
+#include "_conf_evert_boost_converter.h"
+
+/// @brief Variable ids for the boost converter
+/// @details Used by the host, never renumber (new ids go at the end of a group)
+typedef enum
+{
+    // Readings
+    BCRV_VOLTAGE_IN = 0x0001,
+    BCRV_VOLTAGE_OUT = 0x0002,
+    BCRV_CURRENT_IN = 0x0003,
+    BCRV_POWER_IN = 0x0004,
+    BCRV_MCU_TEMPERATURE = 0x0005,
+    BCRV_VOLTAGE_IN_RAW = 0x0010,
+    BCRV_VOLTAGE_OUT_RAW = 0x0011,
+    BCRV_CURRENT_IN_RAW = 0x0012,
+
+    // MPPT
+    BCRV_MPPT_STATUS = 0x0100,
+    BCRV_MPPT_PHASE = 0x0101,
+    BCRV_MPPT_DUTY_CYCLE = 0x0102,
+    BCRV_MPPT_OPERATING_POINT = 0x0103,
+    BCRV_MPPT_OSCILLATING = 0x0104,
+    BCRV_MPPT_CURRENT_PERTURB_STEP = 0x0105,
+    BCRV_MPPT_POWER_LIMIT = 0x0106,
+    BCRV_MPPT_AVAILABLE_POWER = 0x0107,
+
+    // Control
+    BCRV_CONTROL_VOLTAGE_REFERENCE = 0x0200,
+    BCRV_CONTROL_CURRENT_REFERENCE = 0x0201,
+    BCRV_CONTROL_DUTY_FEED_FORWARD = 0x0202,
+    BCRV_CONTROL_ENABLED = 0x0203,
+
+    // Interleave
+    BCRV_INTERLEAVE_PHASE_INDEX = 0x0300,
+    BCRV_INTERLEAVE_PHASE_COUNT = 0x0301,
+    BCRV_INTERLEAVE_PEER_CURRENT = 0x0302,
+    BCRV_INTERLEAVE_SHARE_TRIM = 0x0303,
+
+    // CAN (EVERT_CAN_StatisticsTypeDef)
+    BCRV_CAN_LOAD = 0x0400,
+    BCRV_CAN_LOAD_PEAK = 0x0401,
+    BCRV_CAN_RX_FRAMES = 0x0402,
+    BCRV_CAN_TX_FRAMES = 0x0403,
+    BCRV_CAN_RX_BUFFER_HIGH_WATER = 0x0404,
+    BCRV_CAN_TX_BUFFER_HIGH_WATER = 0x0405,
+    BCRV_CAN_RX_BUFFER_FULL = 0x0406,
+    BCRV_CAN_TX_BUFFER_FULL = 0x0407,
+    BCRV_CAN_RX_FIFO_LOST = 0x0408,
+    BCRV_CAN_TX_WAIT_AVERAGE = 0x0409,
+    BCRV_CAN_TX_WAIT_MAX = 0x040A,
+    BCRV_CAN_RX_WAIT_MAX = 0x040B,
+    BCRV_CAN_REC = 0x040C,
+    BCRV_CAN_TEC = 0x040D,
+    BCRV_CAN_PSR = 0x040E,
+    BCRV_CAN_BUS_OFF = 0x040F,
+
+    // Time synchronization (EVERT_TIME_SYNC_HandlerTypeDef)
+    BCRV_TIME_SYNC_LOCKED = 0x0500,
+    BCRV_TIME_SYNC_ERROR = 0x0501,
+    BCRV_TIME_SYNC_RATE = 0x0502,
+    BCRV_TIME_SYNC_STEPS = 0x0503,
+    BCRV_TIME_SYNC_MISMATCHES = 0x0504,
+
+    // Boot (EVERT_DEVICE_BootTimingTypeDef)
+    BCRV_BOOT_INIT = 0x0600,
+    BCRV_BOOT_ADC = 0x0601,
+    BCRV_BOOT_COMMS = 0x0602,
+    BCRV_BOOT_HANDSHAKE = 0x0603,
+    BCRV_BOOT_OPERATIONAL = 0x0604,
+    BCRV_BOOT_ADC_TIMEOUT = 0x0605,
+    BCRV_BOOT_ADC_SAMPLES = 0x0606,
+} EVERT_BOOST_CONVERTER_RegistryIdTypeDef;
+
+void EVERT_BOOST_CONVERTER_RegistryInit(void);
+void EVERT_BOOST_CONVERTER_RegistryOnRead(const uint16_t id);
+void EVERT_BOOST_CONVERTER_RegistryOnWrite(const uint16_t id, const uint32_t value);
+void EVERT_BOOST_CONVERTER_RegistryOnSubscribe(const uint16_t id, const uint16_t period_ms);
+void EVERT_BOOST_CONVERTER_RegistryOnList(const uint16_t index);
+void EVERT_BOOST_CONVERTER_RegistryProcess(const uint32_t delta_ms);
+
+#endif // EVERT_BOOST_CONVERTER_REGISTRY_H_
@@ -0,0 +1,180 @@
+/**
+ ******************************************************************************
+ * @file    boost_converter_telemetry.c
+ * @author  Evert Firmware Team
+ * @brief   Delta telemetry of the boost converter over CAN
+ *
+ ******************************************************************************
+ **/
+
+#include <string.h>
+#include "boost_converter.h"
+#include "boost_converter_telemetry.h"
+
+#define EVERT_BOOST_CONVERTER_TELEMETRY_TX_RESERVE (4) // TX buffer slots left for the control traffic
+#define EVERT_BOOST_CONVERTER_TELEMETRY_END (0xFFFF)   // BCCM_TELEMETRY_SIGNAL id past the end of the table
+
+extern EVERT_CAN_HandlerTypeDef can_handler;
+
+EVERT_DELTA_TELEMETRY_HandlerTypeDef delta_telemetry;
+
+/// @brief Signals in the order they are packed, the host learns them with BCCM_TELEMETRY_LIST
+/// @details Resolution: the step the host sees, coarser steps change less often and cost fewer bits
+static const EVERT_DELTA_TELEMETRY_SignalTypeDef telemetry_signals[] = {
+    // Readings
+    {BCRV_VOLTAGE_IN, 0.01f},
+    {BCRV_VOLTAGE_OUT, 0.1f},
+    {BCRV_CURRENT_IN, 0.001f},
+    {BCRV_POWER_IN, 0.1f},
+    {BCRV_MCU_TEMPERATURE, 0.1f},
+    {BCRV_VOLTAGE_IN_RAW, 0.01f},
+    {BCRV_VOLTAGE_OUT_RAW, 0.1f},
+    {BCRV_CURRENT_IN_RAW, 0.001f},
+
+    // MPPT
+    {BCRV_MPPT_STATUS, 1.0f},
+    {BCRV_MPPT_PHASE, 1.0f},
+    {BCRV_MPPT_DUTY_CYCLE, 0.0001f},
+    {BCRV_MPPT_OPERATING_POINT, 0.01f},
+    {BCRV_MPPT_OSCILLATING, 1.0f},
+    {BCRV_MPPT_CURRENT_PERTURB_STEP, 0.001f},
+    {BCRV_MPPT_POWER_LIMIT, 0.1f},
+    {BCRV_MPPT_AVAILABLE_POWER, 0.1f},
+
+    // Control
+    {BCRV_CONTROL_VOLTAGE_REFERENCE, 0.01f},
+    {BCRV_CONTROL_CURRENT_REFERENCE, 0.001f},
+    {BCRV_CONTROL_DUTY_FEED_FORWARD, 0.0001f},
+    {BCRV_CONTROL_ENABLED, 1.0f},
+
+    // Interleave
+    {BCRV_INTERLEAVE_PHASE_INDEX, 1.0f},
+    {BCRV_INTERLEAVE_PHASE_COUNT, 1.0f},
+    {BCRV_INTERLEAVE_PEER_CURRENT, 0.001f},
+    {BCRV_INTERLEAVE_SHARE_TRIM, 0.001f},
+
+    // CAN
+    {BCRV_CAN_LOAD, 1.0f},
+    {BCRV_CAN_LOAD_PEAK, 1.0f},
+    {BCRV_CAN_TX_BUFFER_HIGH_WATER, 1.0f},
+    {BCRV_CAN_TX_WAIT_MAX, 1.0f},
+    {BCRV_CAN_REC, 1.0f},
+    {BCRV_CAN_TEC, 1.0f},
+
+    // Time synchronization
+    {BCRV_TIME_SYNC_LOCKED, 1.0f},
+    {BCRV_TIME_SYNC_ERROR, 1.0f},
+    {BCRV_TIME_SYNC_RATE, 10.0f},
+};
+
+#define EVERT_BOOST_CONVERTER_TELEMETRY_SIGNAL_COUNT (sizeof(telemetry_signals) / sizeof(telemetry_signals[0]))
+
+_Static_assert(EVERT_BOOST_CONVERTER_TELEMETRY_SIGNAL_COUNT <= EVERT_DELTA_TELEMETRY_SIGNAL_COUNT, "EVERT_HAL_CONF_DELTA_TELEMETRY_SIGNAL_COUNT too small");
+
+static const EVERT_REGISTRY_EntryTypeDef *telemetry_entries[EVERT_BOOST_CONVERTER_TELEMETRY_SIGNAL_COUNT];
+static uint32_t telemetry_list_index = UINT32_MAX; // Next table entry to list, beyond the end marker: idle
+
+/// @brief Registry variable as a float, NaN for an id without an entry
+static float32_t EVERT_BOOST_CONVERTER_TelemetryLoad(const EVERT_REGISTRY_EntryTypeDef *entry)
+{
+    if (entry == NULL)
+    {
+        return NAN;
+    }
+
+    switch (entry->type)
+    {
+    case RGT_U8:
+    case RGT_BOOL:
+        return (float32_t)*(volatile uint8_t *)entry->address;
+    case RGT_I8:
+        return (float32_t)*(volatile int8_t *)entry->address;
+    case RGT_U16:
+        return (float32_t)*(volatile uint16_t *)entry->address;
+    case RGT_I16:
+        return (float32_t)*(volatile int16_t *)entry->address;
+    case RGT_U32:
+        return (float32_t)*(volatile uint32_t *)entry->address;
+    case RGT_I32:
+        return (float32_t)*(volatile int32_t *)entry->address;
+    default:
+        return *(volatile float32_t *)entry->address;
+    }
+}
+
+void EVERT_BOOST_CONVERTER_TelemetryInit(void)
+{
+    for (uint32_t i = 0; i < EVERT_BOOST_CONVERTER_TELEMETRY_SIGNAL_COUNT; i++)
+    {
+        telemetry_entries[i] = EVERT_REGISTRY_Find(telemetry_signals[i].id);
+    }
+
+    EVERT_DELTA_TELEMETRY_Init(&delta_telemetry, telemetry_signals, EVERT_BOOST_CONVERTER_TELEMETRY_SIGNAL_COUNT, EVERT_SETTING_BC_TELEMETRY_KEYFRAME_INTERVAL);
+}
+
+/// @brief Data task: sample every signal, the frames follow from EVERT_BOOST_CONVERTER_TelemetryProcess
+void EVERT_BOOST_CONVERTER_TelemetrySample(void)
+{
+    float32_t values[EVERT_BOOST_CONVERTER_TELEMETRY_SIGNAL_COUNT];
+
+    for (uint32_t i = 0; i < EVERT_BOOST_CONVERTER_TELEMETRY_SIGNAL_COUNT; i++)
+    {
+        values[i] = EVERT_BOOST_CONVERTER_TelemetryLoad(telemetry_entries[i]);
+    }
+
+    EVERT_DELTA_TELEMETRY_Sample(&delta_telemetry, values);
+}
+
+/// @brief List the table from index on. Index 0: the host starts over, the next sample is a keyframe.
+void EVERT_BOOST_CONVERTER_TelemetryOnList(const uint8_t index)
+{
+    telemetry_list_index = index;
+
+    if (index == 0)
+    {
+        EVERT_DELTA_TELEMETRY_RequestKeyframe(&delta_telemetry);
+    }
+}
+
+/// @brief Message id = index, [1..2] id, [3..6] resolution (float32), id EVERT_BOOST_CONVERTER_TELEMETRY_END past the end
+static void EVERT_BOOST_CONVERTER_TelemetrySendSignal(const uint32_t index)
+{
+    uint16_t id = EVERT_BOOST_CONVERTER_TELEMETRY_END;
+    float32_t resolution = 0.0f;
+
+    if (index < EVERT_BOOST_CONVERTER_TELEMETRY_SIGNAL_COUNT)
+    {
+        id = telemetry_signals[index].id;
+        resolution = telemetry_signals[index].resolution;
+    }
+
+    uint8_t data[7] = {BCCM_TELEMETRY_SIGNAL};
+    memcpy(&data[1], &id, sizeof(id));
+    memcpy(&data[3], &resolution, sizeof(resolution));
+
+    EVERT_CAN_Identifier_SetMessageId(&can_handler.identifier, (EVERT_CAN_MessageIdTypeDef)index);
+    EVERT_CAN_Handler_Transmit(&can_handler, sizeof(data), data);
+    EVERT_CAN_Identifier_SetMessageId(&can_handler.identifier, 0);
+}
+
+/// @brief Main loop: the table being listed, then the frames of the current sample while the TX buffer has room,
+/// message id = sequence
+void EVERT_BOOST_CONVERTER_TelemetryProcess(void)
+{
+    uint8_t data[7] = {BCCM_TELEMETRY_FRAME};
+    uint8_t sequence;
+    uint32_t length;
+
+    while (telemetry_list_index <= EVERT_BOOST_CONVERTER_TELEMETRY_SIGNAL_COUNT && can_handler.tx_fifo_buffer.count + EVERT_BOOST_CONVERTER_TELEMETRY_TX_RESERVE < can_handler.tx_fifo_buffer.size)
+    {
+        EVERT_BOOST_CONVERTER_TelemetrySendSignal(telemetry_list_index++);
+    }
+
+    while (can_handler.tx_fifo_buffer.count + EVERT_BOOST_CONVERTER_TELEMETRY_TX_RESERVE < can_handler.tx_fifo_buffer.size &&
+           (length = EVERT_DELTA_TELEMETRY_Pack(&delta_telemetry, &data[1], sizeof(data) - 1, &sequence)) > 0)
+    {
+        EVERT_CAN_Identifier_SetMessageId(&can_handler.identifier, (EVERT_CAN_MessageIdTypeDef)sequence);
+        EVERT_CAN_Handler_Transmit(&can_handler, (uint8_t)(length + 1), data);
+        EVERT_CAN_Identifier_SetMessageId(&can_handler.identifier, 0);
+    }
+}
@@ -0,0 +1,28 @@
+/**
+ ******************************************************************************
+ * @file    boost_converter_telemetry.h
+ * @author  Evert Firmware Team
+ * @brief   Delta telemetry of the boost converter over CAN
+ *          * Codec: delta_telemetry.h, the signals are registry variables (BCRV_* ids) at a fixed resolution,
+ *            table in boost_converter_telemetry.c
+ *          * Sampled by the data task, the frames go out from the main loop as the TX buffer has room
+ *          * CAN: BCCM_TELEMETRY_FRAME, the table on BCCM_TELEMETRY_LIST as BCCM_TELEMETRY_SIGNAL frames from the
+ *            requested index to the end marker, paced like the frames
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_BOOST_CONVERTER_TELEMETRY_H_
+#define EVERT_BOOST_CONVERTER_TELEMETRY_H_
+
+#include <stdint.h>
+#include "_conf_evert_boost_converter.h"
+#include "delta_telemetry.h"
+
+extern EVERT_DELTA_TELEMETRY_HandlerTypeDef delta_telemetry;
+
+void EVERT_BOOST_CONVERTER_TelemetryInit(void);
+void EVERT_BOOST_CONVERTER_TelemetrySample(void);
+void EVERT_BOOST_CONVERTER_TelemetryOnList(const uint8_t index);
+void EVERT_BOOST_CONVERTER_TelemetryProcess(void);
+
+#endif // EVERT_BOOST_CONVERTER_TELEMETRY_H_
@@ -0,0 +1,148 @@
+/**
+ ******************************************************************************
+ * @file    boost_converter_update.c
+ * @author  Evert Firmware Team
+ * @brief   Firmware update of the boost converter over CAN
+ *
+ ******************************************************************************
+ **/
+
+#include <string.h>
+#include "boost_converter.h"
+#include "boost_converter_update.h"
+
+#define EVERT_BOOST_CONVERTER_UPDATE_TX_RESERVE (2) // TX buffer slots left for the control traffic
+
+extern EVERT_CAN_HandlerTypeDef can_handler;
+
+EVERT_BOOST_CONVERTER_UpdateStateTypeDef update_state;
+
+/// @brief Message id = gap report, [1] state, [2] result, [3..6] stream bytes taken
+static void EVERT_BOOST_CONVERTER_UpdateSendStatus(void)
+{
+    uint8_t data[7] = {BCCM_UPDATE_STATUS, (uint8_t)firmware_update.state, (uint8_t)update_state.result};
+
+    memcpy(&data[3], &firmware_update.received, sizeof(firmware_update.received));
+
+    EVERT_CAN_Identifier_SetMessageId(&can_handler.identifier, update_state.status_gap ? EVERT_BOOST_CONVERTER_UPDATE_STATUS_GAP : 0);
+    EVERT_CAN_FifoStatusTypeDef status = EVERT_CAN_Handler_Transmit(&can_handler, sizeof(data), data);
+    EVERT_CAN_Identifier_SetMessageId(&can_handler.identifier, 0);
+
+    update_state.status_gap = false;
+
+    if (status != CAN_FS_OK)
+    {
+        EVERT_HAL_BreakPoint("CAN Error: Update Status\n");
+    }
+}
+
+static void EVERT_BOOST_CONVERTER_UpdateOnCommand(const EVERT_FIRMWARE_UPDATE_ResultTypeDef result)
+{
+    update_state.result = result;
+    update_state.status_due = true;
+}
+
+/// @brief First thing at boot: trial state of the running image, fault log and parameters taken over on its first boot
+void EVERT_BOOST_CONVERTER_UpdateInit(void)
+{
+    EVERT_FIRMWARE_UPDATE_Init(FIT_BOOST_CONVERTER);
+
+    update_state.block = 0;
+    update_state.result = FUR_OK;
+    update_state.reported_state = firmware_update.state;
+    update_state.status_due = false;
+    update_state.status_gap = false;
+    update_state.gap_reported = false;
+}
+
+/// @brief Erase the slot for an application of size bytes, the blocks follow once the state is FUS_RECEIVING
+void EVERT_BOOST_CONVERTER_UpdateOnBegin(const uint32_t size)
+{
+    EVERT_FIRMWARE_UPDATE_ResultTypeDef result = EVERT_FIRMWARE_UPDATE_Begin(size);
+
+    if (result == FUR_OK)
+    {
+        update_state.block = 0;
+        update_state.gap_reported = false;
+    }
+
+    EVERT_BOOST_CONVERTER_UpdateOnCommand(result);
+}
+
+/// @brief Block with the sequence number (bits 0-7 of the block index), taken only in order
+void EVERT_BOOST_CONVERTER_UpdateOnData(const uint8_t sequence, const uint8_t *data, const uint32_t length)
+{
+    if (firmware_update.state != FUS_RECEIVING)
+    {
+        return; // A late block of a failed or finished stream, the state change was reported
+    }
+
+    if (sequence != (uint8_t)update_state.block)
+    {
+        // Lost or repeated blocks: the bytes taken tell the CCU where to go on, once per gap
+        if (!update_state.gap_reported)
+        {
+            update_state.gap_reported = true;
+            update_state.status_due = true;
+            update_state.status_gap = true;
+        }
+
+        return;
+    }
+
+    update_state.result = EVERT_FIRMWARE_UPDATE_Write(update_state.block * EVERT_BOOST_CONVERTER_UPDATE_BLOCK_SIZE, data, length);
+
+    if (update_state.result != FUR_OK)
+    {
+        update_state.status_due = true;
+        return;
+    }
+
+    update_state.block++;
+    update_state.gap_reported = false;
+
+    if (update_state.block % EVERT_SETTING_BC_UPDATE_ACK_INTERVAL == 0 || firmware_update.received == firmware_update.size)
+    {
+        update_state.status_due = true;
+    }
+}
+
+void EVERT_BOOST_CONVERTER_UpdateOnEnd(void)
+{
+    EVERT_BOOST_CONVERTER_UpdateOnCommand(EVERT_FIRMWARE_UPDATE_Finish());
+}
+
+/// @brief Boot the new image, the converter must be in standby
+void EVERT_BOOST_CONVERTER_UpdateOnActivate(void)
+{
+    if (mppt_state.status != BCS_STANDBY)
+    {
+        EVERT_BOOST_CONVERTER_UpdateOnCommand(FUR_REFUSED);
+        return;
+    }
+
+    EVERT_BOOST_CONVERTER_UpdateOnCommand(EVERT_FIRMWARE_UPDATE_Activate()); // Returns only if it cannot
+}
+
+/// @brief Erase and verification steps, the due status, call from the main loop
+void EVERT_BOOST_CONVERTER_UpdateProcess(void)
+{
+    EVERT_FIRMWARE_UPDATE_Process();
+
+    if (firmware_update.state != update_state.reported_state)
+    {
+        update_state.reported_state = firmware_update.state;
+        update_state.status_due = true;
+
+        if (firmware_update.state == FUS_FAILED)
+        {
+            update_state.result = firmware_update.result;
+        }
+    }
+
+    if (update_state.status_due && can_handler.tx_fifo_buffer.count + EVERT_BOOST_CONVERTER_UPDATE_TX_RESERVE < can_handler.tx_fifo_buffer.size)
+    {
+        update_state.status_due = false;
+        EVERT_BOOST_CONVERTER_UpdateSendStatus();
+    }
+}
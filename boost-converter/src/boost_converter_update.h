@@ -0,0 +1,48 @@
+/**
+ ******************************************************************************
+ * @file    boost_converter_update.h
+ * @author  Evert Firmware Team
+ * @brief   Firmware update of the boost converter over CAN
+ *          * Flash side: firmware_update.h (other bank, erased and verified from the main loop), the bootloader
+ *            switches the bank (bootloader/)
+ *          * CAN: BCCM_UPDATE_BEGIN erases the slot, BCCM_UPDATE_DATA blocks carry the stream (image header,
+ *            application) 6 bytes each, BCCM_UPDATE_END checks it, BCCM_UPDATE_ACTIVATE boots it (standby only)
+ *          * BCCM_UPDATE_STATUS answers: every EVERT_SETTING_BC_UPDATE_ACK_INTERVAL blocks and on the last one
+ *            (acknowledgement), once per gap or repeat in the block sequence with message id
+ *            EVERT_BOOST_CONVERTER_UPDATE_STATUS_GAP (the CCU goes back to the bytes taken), on every state change
+ *            and every command
+ *          * The running image is confirmed once the device gets operational
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_BOOST_CONVERTER_UPDATE_H_
+#define EVERT_BOOST_CONVERTER_UPDATE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "_conf_evert_boost_converter.h"
+#include "firmware_update.h"
+
+#define EVERT_BOOST_CONVERTER_UPDATE_BLOCK_SIZE (6) // Stream bytes per BCCM_UPDATE_DATA
+#define EVERT_BOOST_CONVERTER_UPDATE_STATUS_GAP (1)  // Message id of a BCCM_UPDATE_STATUS on a gap
+
+typedef struct
+{
+    uint32_t block;                             // Next block expected
+    EVERT_FIRMWARE_UPDATE_ResultTypeDef result; // Of the last command or block
+    EVERT_FIRMWARE_UPDATE_StateTypeDef reported_state;
+    bool status_due;
+    bool status_gap;   // The due status reports a gap
+    bool gap_reported; // Status sent for the gap, until the next block is taken
+} EVERT_BOOST_CONVERTER_UpdateStateTypeDef;
+
+extern EVERT_BOOST_CONVERTER_UpdateStateTypeDef update_state;
+
+void EVERT_BOOST_CONVERTER_UpdateInit(void);
+void EVERT_BOOST_CONVERTER_UpdateOnBegin(const uint32_t size);
+void EVERT_BOOST_CONVERTER_UpdateOnData(const uint8_t sequence, const uint8_t *data, const uint32_t length);
+void EVERT_BOOST_CONVERTER_UpdateOnEnd(void);
+void EVERT_BOOST_CONVERTER_UpdateOnActivate(void);
+void EVERT_BOOST_CONVERTER_UpdateProcess(void);
+
+#endif // EVERT_BOOST_CONVERTER_UPDATE_H_
@@ -0,0 +1,227 @@
+/**
+ ******************************************************************************
+ * @file    bootloader.c
+ * @author  Evert Firmware Team
+ * @brief   Bootloader of the A/B firmware update (libs/core/src/firmware_image.h has the layout)
+ *          * Runs from the first 16 kB of the bank booted from, before the application and its watchdogs
+ *          * Other bank marked to activate (first boot there): switch the bank (BFB2), the option byte
+ *            reload resets into it
+ *          * Image on trial: one boot state mark per boot, rejected once they run out or its CRC does not
+ *            match, then back to the other bank if it holds an image to fall back to
+ *          * Registers only, no HAL, no .data/.bss (linker script): nothing the application has to clean up
+ *
+ ******************************************************************************
+ **/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "stm32g4xx.h"
+#include "firmware_image.h"
+
+#define EVERT_BOOTLOADER_FLASH_KEY1 (0x45670123u)
+#define EVERT_BOOTLOADER_FLASH_KEY2 (0xCDEF89ABu)
+#define EVERT_BOOTLOADER_FLASH_OPTKEY1 (0x08192A3Bu)
+#define EVERT_BOOTLOADER_FLASH_OPTKEY2 (0x4C5D6E7Fu)
+#define EVERT_BOOTLOADER_FLASH_SR_ERRORS (FLASH_SR_OPERR | FLASH_SR_PROGERR | FLASH_SR_WRPERR | FLASH_SR_PGAERR | FLASH_SR_SIZERR | FLASH_SR_PGSERR | FLASH_SR_MISERR | FLASH_SR_FASTERR | FLASH_SR_RDERR | FLASH_SR_OPTVERR)
+
+typedef void (*EVERT_BOOTLOADER_HandlerTypeDef)(void);
+
+/// @brief Vector table entry: the initial stack pointer (an object address) or a handler
+typedef union
+{
+    uint32_t *stack;
+    EVERT_BOOTLOADER_HandlerTypeDef handler;
+} EVERT_BOOTLOADER_VectorTypeDef;
+
+extern uint32_t _estack;
+
+void Reset_Handler(void);
+void EVERT_BOOTLOADER_DefaultHandler(void);
+
+/// @brief Reset and the faults only, interrupts stay off until the application runs
+__attribute__((section(".isr_vector"), used)) const EVERT_BOOTLOADER_VectorTypeDef evert_bootloader_vectors[] = {
+    {.stack = &_estack},
+    {.handler = Reset_Handler},
+    {.handler = EVERT_BOOTLOADER_DefaultHandler}, // NMI
+    {.handler = EVERT_BOOTLOADER_DefaultHandler}, // HardFault
+    {.handler = EVERT_BOOTLOADER_DefaultHandler}, // MemManage
+    {.handler = EVERT_BOOTLOADER_DefaultHandler}, // BusFault
+    {.handler = EVERT_BOOTLOADER_DefaultHandler}, // UsageFault
+};
+
+void EVERT_BOOTLOADER_DefaultHandler(void)
+{
+    while (true)
+    {
+    }
+}
+
+static void EVERT_BOOTLOADER_WaitForFlash(void)
+{
+    while ((FLASH->SR & FLASH_SR_BSY) != 0U)
+    {
+    }
+}
+
+/// @brief Boot state double word of the bank booted from, programmed once (to 0)
+static void EVERT_BOOTLOADER_Mark(const uint64_t *word)
+{
+    if (EVERT_FIRMWARE_IMAGE_IsMarked(word))
+    {
+        return;
+    }
+
+    volatile uint32_t *address = (volatile uint32_t *)(uintptr_t)word;
+
+    EVERT_BOOTLOADER_WaitForFlash();
+    FLASH->KEYR = EVERT_BOOTLOADER_FLASH_KEY1;
+    FLASH->KEYR = EVERT_BOOTLOADER_FLASH_KEY2;
+    FLASH->SR = EVERT_BOOTLOADER_FLASH_SR_ERRORS | FLASH_SR_EOP;
+
+    FLASH->CR |= FLASH_CR_PG;
+    address[0] = (uint32_t)EVERT_FIRMWARE_IMAGE_MARK;
+    __ISB();
+    address[1] = (uint32_t)(EVERT_FIRMWARE_IMAGE_MARK >> 32);
+    EVERT_BOOTLOADER_WaitForFlash();
+    FLASH->CR &= ~FLASH_CR_PG;
+
+    FLASH->CR |= FLASH_CR_LOCK;
+}
+
+/// @brief Boot the other bank: BFB2 against the bank booted from, the option byte reload resets. Does not return.
+static void EVERT_BOOTLOADER_SwitchBank(void)
+{
+    bool bank2 = (SYSCFG->MEMRMP & SYSCFG_MEMRMP_FB_MODE) != 0U;
+
+    EVERT_BOOTLOADER_WaitForFlash();
+    FLASH->KEYR = EVERT_BOOTLOADER_FLASH_KEY1;
+    FLASH->KEYR = EVERT_BOOTLOADER_FLASH_KEY2;
+    FLASH->OPTKEYR = EVERT_BOOTLOADER_FLASH_OPTKEY1;
+    FLASH->OPTKEYR = EVERT_BOOTLOADER_FLASH_OPTKEY2;
+    FLASH->SR = EVERT_BOOTLOADER_FLASH_SR_ERRORS | FLASH_SR_EOP;
+
+    if (bank2)
+    {
+        FLASH->OPTR &= ~FLASH_OPTR_BFB2;
+    }
+    else
+    {
+        FLASH->OPTR |= FLASH_OPTR_BFB2;
+    }
+
+    FLASH->CR |= FLASH_CR_OPTSTRT;
+    EVERT_BOOTLOADER_WaitForFlash();
+
+    FLASH->CR |= FLASH_CR_OBL_LAUNCH;
+
+    while (true)
+    {
+    }
+}
+
+/// @brief CRC-32 of the application against its header, on the CRC unit (reflected in and out: crc.h)
+static bool EVERT_BOOTLOADER_IsCrcValid(const EVERT_FIRMWARE_IMAGE_HeaderTypeDef *header)
+{
+    const uint32_t *words = (const uint32_t *)(EVERT_FIRMWARE_IMAGE_ACTIVE_BASE + EVERT_FIRMWARE_IMAGE_APP_OFFSET);
+
+    RCC->AHB1ENR |= RCC_AHB1ENR_CRCEN;
+    (void)RCC->AHB1ENR;
+
+    CRC->INIT = EVERT_CRC32_INIT;
+    CRC->POL = 0x04C11DB7u;
+    CRC->CR = CRC_CR_REV_IN_0 | CRC_CR_REV_IN_1 | CRC_CR_REV_OUT | CRC_CR_RESET;
+
+    for (uint32_t i = 0; i < header->size / sizeof(uint32_t); i++)
+    {
+        CRC->DR = words[i];
+    }
+
+    uint32_t crc = CRC->DR ^ EVERT_CRC32_XOR_OUT;
+
+    CRC->CR = CRC_CR_RESET;
+    RCC->AHB1ENR &= ~RCC_AHB1ENR_CRCEN;
+
+    return crc == header->crc;
+}
+
+/// @brief Application of the bank booted from, with its own vector table and stack. Does not return.
+static void EVERT_BOOTLOADER_Jump(void)
+{
+    const uint32_t *vectors = (const uint32_t *)(EVERT_FIRMWARE_IMAGE_ACTIVE_BASE + EVERT_FIRMWARE_IMAGE_APP_OFFSET);
+
+    SCB->VTOR = (uint32_t)(uintptr_t)vectors;
+    __DSB();
+    __ISB();
+
+    __set_MSP(vectors[0]);
+    ((EVERT_BOOTLOADER_HandlerTypeDef)(uintptr_t)vectors[1])();
+
+    while (true)
+    {
+    }
+}
+
+/// @brief Update steps of the boot state, see the file header
+static void EVERT_BOOTLOADER_CheckImages(void)
+{
+    const EVERT_FIRMWARE_IMAGE_HeaderTypeDef *header = EVERT_FIRMWARE_IMAGE_Header(EVERT_FIRMWARE_IMAGE_ACTIVE_BASE);
+    const EVERT_FIRMWARE_IMAGE_StateTypeDef *state = EVERT_FIRMWARE_IMAGE_State(EVERT_FIRMWARE_IMAGE_ACTIVE_BASE);
+    const EVERT_FIRMWARE_IMAGE_StateTypeDef *other = EVERT_FIRMWARE_IMAGE_State(EVERT_FIRMWARE_IMAGE_OTHER_BASE);
+
+    // New image, activated and never booted
+    if (EVERT_FIRMWARE_IMAGE_IsHeaderValid(EVERT_FIRMWARE_IMAGE_Header(EVERT_FIRMWARE_IMAGE_OTHER_BASE)) &&
+        EVERT_FIRMWARE_IMAGE_HasVectors(EVERT_FIRMWARE_IMAGE_OTHER_BASE) && EVERT_FIRMWARE_IMAGE_IsMarked(&other->activate) &&
+        EVERT_FIRMWARE_IMAGE_AttemptCount(other) == 0 && !EVERT_FIRMWARE_IMAGE_IsMarked(&other->rejected))
+    {
+        EVERT_BOOTLOADER_SwitchBank();
+    }
+
+    if (!EVERT_FIRMWARE_IMAGE_IsHeaderValid(header))
+    {
+        return; // Flashed over SWD
+    }
+
+    bool confirmed = EVERT_FIRMWARE_IMAGE_IsMarked(&state->confirmed);
+    uint32_t attempts = EVERT_FIRMWARE_IMAGE_AttemptCount(state);
+
+    if (EVERT_FIRMWARE_IMAGE_IsMarked(&state->rejected) || (!confirmed && attempts >= EVERT_FIRMWARE_IMAGE_ATTEMPT_COUNT) || !EVERT_BOOTLOADER_IsCrcValid(header))
+    {
+        EVERT_BOOTLOADER_Mark(&state->rejected);
+
+        if (EVERT_FIRMWARE_IMAGE_IsFallback(EVERT_FIRMWARE_IMAGE_OTHER_BASE))
+        {
+            EVERT_BOOTLOADER_SwitchBank();
+        }
+
+        return; // Nothing to go back to, boot it anyway
+    }
+
+    if (!confirmed)
+    {
+        EVERT_BOOTLOADER_Mark(&state->attempts[attempts]);
+    }
+}
+
+void Reset_Handler(void)
+{
+    RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN;
+    (void)RCC->APB2ENR;
+
+    if ((FLASH->OPTR & FLASH_OPTR_DBANK) != 0U)
+    {
+        EVERT_BOOTLOADER_CheckImages();
+    }
+
+    if (EVERT_FIRMWARE_IMAGE_HasVectors(EVERT_FIRMWARE_IMAGE_ACTIVE_BASE))
+    {
+        EVERT_BOOTLOADER_Jump();
+    }
+
+    // No application in this bank (erased, or an update cut short on a single bank device)
+    if ((FLASH->OPTR & FLASH_OPTR_DBANK) != 0U && EVERT_FIRMWARE_IMAGE_IsFallback(EVERT_FIRMWARE_IMAGE_OTHER_BASE))
+    {
+        EVERT_BOOTLOADER_SwitchBank();
+    }
+
+    EVERT_BOOTLOADER_DefaultHandler();
+}
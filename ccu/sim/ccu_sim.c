@@ -0,0 +1,400 @@
+/**
+ ******************************************************************************
+ * @file    ccu_sim.c
+ * @author  Evert Firmware Team
+ * @brief   Plant simulation for the dispatch optimizer (ccu_optimizer.h)
+ *          evert_ccu_sim [-m ccu|local|both] [-t seconds] [-x W] [-c file.csv]
+ *          * Plant models, 1 ms steps:
+ *              * String: MPP power from an irradiance profile, the boost converter follows its limit or the MPP
+ *                with a first order lag (the MPPT steps), a first order temperature with the coil warning
+ *              * Boost converter firmware: power report every 100 ms with the available power estimate of
+ *                boost_converter_mppt.c, local throttling on warnings (BCS_THROTTLE_DOWN) when not dispatched
+ *              * DC bus: capacitor energy, the inverter holds it at nominal with a PI up to its rating and the
+ *                export limit (ramped), the strings warn above SIM_BUS_VOLTAGE_WARNING
+ *          * Modes: ccu runs the optimizer at EVERT_SETTING_CCU_OPTIMIZER_PERIOD_MS on the reports, local the
+ *            converters on their own; both compares them on the same profile
+ *
+ ******************************************************************************
+ **/
+
+#include <getopt.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ccu_optimizer.h"
+
+#define SIM_STEP (0.001f)            // s
+#define SIM_STRING_COUNT (2)         // Boost converters 1 and 2
+#define SIM_STRING_POWER_RATED (2500.0f) // W at full irradiance
+#define SIM_STRING_TAU (0.3f)        // s, MPPT settling
+#define SIM_THROTTLE_RATE (250.0f)   // W/s, local back-off: EVERT_SETTING_BC_MPPT_STEP_MAX every observe interval
+#define SIM_REPORT_PERIOD (0.1f)     // s, BCCM_POWER_REPORT with the data task
+#define SIM_DISPATCH_TIMEOUT (2.0f)  // s, EVERT_SETTING_BC_DISPATCH_TIMEOUT_MS
+#define SIM_LIMIT_BAND (0.03f)       // EVERT_SETTING_BC_MPPT_POWER_LIMIT_BAND
+
+#define SIM_TEMPERATURE_AMBIENT (25.0f)  // °C
+#define SIM_TEMPERATURE_RISE (0.02f)     // K/W, steady state coil temperature rise
+#define SIM_TEMPERATURE_TAU (8.0f)       // s
+#define SIM_TEMPERATURE_WARNING (70.0f)  // EVERT_CONSTRAINT_BC_COIL_TEMP_WARNING
+#define SIM_TEMPERATURE_HYSTERESIS (2.5f)
+
+#define SIM_BUS_CAPACITANCE (0.002f)     // F
+#define SIM_BUS_VOLTAGE_NOMINAL (800.0f) // EVERT_SETTING_INVERTER_VOLTAGE_BUS_NOMINAL
+#define SIM_BUS_VOLTAGE_WARNING (860.0f) // Output overvoltage warning of the converters
+#define SIM_BUS_VOLTAGE_HYSTERESIS (20.0f)
+#define SIM_BUS_VOLTAGE_CRITICAL (900.0f) // EVERT_CONSTRAINT_BC_VOLTAGE_OUT_HIGH_CRITICAL, converters to standby
+#define SIM_INVERTER_KP (20.0f)          // W/V
+#define SIM_INVERTER_KI (200.0f)         // W/(V*s)
+#define SIM_INVERTER_CAP_RAMP (1000.0f)  // W/s, the inverter moves to a new export limit at this rate
+
+typedef enum
+{
+    SIM_MODE_LOCAL = 0,
+    SIM_MODE_CCU = 1
+} SIM_ModeTypeDef;
+
+typedef struct
+{
+    float power;       // W
+    float limit;       // W, < 0 = unlimited
+    float dispatch_timer;
+    float available;   // W, estimate as in the firmware
+    float temperature; // °C
+    bool temperature_warning;
+    bool bus_warning;
+
+    // Last report
+    float report_power;
+    float report_available;
+    float report_bus_voltage;
+} SIM_StringTypeDef;
+
+typedef struct
+{
+    SIM_StringTypeDef strings[SIM_STRING_COUNT];
+    float bus_voltage;
+    float inverter_integral;
+    float inverter_power; // W DC
+    float inverter_cap;   // W AC, rating and export limit after the ramp
+
+    // Metrics
+    float energy_available; // Wh DC at the MPP
+    float energy_allowed;   // Wh AC, what the export limit and the rating leave of the MPP
+    float energy_exported;  // Wh AC
+    float bus_voltage_max;
+    float time_over_warning; // s
+    float time_warning;      // s, any string in warning
+    uint32_t standby_count;  // Critical bus overvoltage events
+} SIM_PlantTypeDef;
+
+/// @brief Irradiance per string (0..1): morning ramp, full sun, a cloud over string 2, full sun
+static float SIM_Irradiance(const uint32_t string, const float t)
+{
+    float irradiance = t < 20.0f ? 0.3f + 0.7f * t / 20.0f : 1.0f;
+
+    if (string == 1 && t >= 70.0f && t < 80.0f)
+    {
+        irradiance *= 0.4f;
+    }
+
+    return irradiance;
+}
+
+/// @brief Export limit profile: the configured limit between 40 s and 100 s, none otherwise
+static float SIM_ExportLimit(const float export_limit, const float t)
+{
+    return (t >= 40.0f && t < 100.0f) ? export_limit : -1.0f;
+}
+
+static void SIM_StringStep(SIM_StringTypeDef *string, const float mpp, const bool dispatched_mode)
+{
+    bool warning = string->temperature_warning || string->bus_warning;
+    bool dispatched = dispatched_mode && string->dispatch_timer < SIM_DISPATCH_TIMEOUT;
+    float target = mpp;
+
+    string->dispatch_timer += SIM_STEP;
+
+    if (!dispatched)
+    {
+        string->limit = -1.0f;
+    }
+
+    if (warning && !dispatched)
+    {
+        // BCS_THROTTLE_DOWN: back off as long as the warning lasts
+        target = fmaxf(string->power - SIM_THROTTLE_RATE * SIM_STRING_TAU, 0.0f);
+    }
+    else if (string->limit >= 0.0f)
+    {
+        target = fminf(mpp, string->limit);
+    }
+
+    string->power += (target - string->power) * SIM_STEP / SIM_STRING_TAU;
+
+    // Available power estimate of boost_converter_mppt.c
+    bool at_limit = string->limit >= 0.0f && string->power > string->limit * (1.0f - SIM_LIMIT_BAND);
+    string->available = at_limit ? fmaxf(string->available, string->power) : string->power;
+
+    // Coil temperature and its warning with hysteresis
+    float steady = SIM_TEMPERATURE_AMBIENT + SIM_TEMPERATURE_RISE * string->power;
+    string->temperature += (steady - string->temperature) * SIM_STEP / SIM_TEMPERATURE_TAU;
+
+    if (string->temperature > SIM_TEMPERATURE_WARNING)
+    {
+        string->temperature_warning = true;
+    }
+    else if (string->temperature < SIM_TEMPERATURE_WARNING - SIM_TEMPERATURE_HYSTERESIS)
+    {
+        string->temperature_warning = false;
+    }
+}
+
+static void SIM_BusStep(SIM_PlantTypeDef *plant, const float export_limit)
+{
+    float input = 0.0f;
+
+    for (uint32_t i = 0; i < SIM_STRING_COUNT; i++)
+    {
+        input += plant->strings[i].power;
+    }
+
+    // Inverter: PI on the bus voltage, up to its rating and the export limit (AC, ramped)
+    float cap = EVERT_SETTING_CCU_OPTIMIZER_INVERTER_POWER_MAX;
+
+    if (export_limit >= 0.0f && export_limit < cap)
+    {
+        cap = export_limit;
+    }
+
+    plant->inverter_cap += fminf(fmaxf(cap - plant->inverter_cap, -SIM_INVERTER_CAP_RAMP * SIM_STEP), SIM_INVERTER_CAP_RAMP * SIM_STEP);
+    cap = plant->inverter_cap / EVERT_SETTING_CCU_OPTIMIZER_INVERTER_EFFICIENCY;
+
+    float error = plant->bus_voltage - SIM_BUS_VOLTAGE_NOMINAL;
+    plant->inverter_integral = fminf(fmaxf(plant->inverter_integral + SIM_INVERTER_KI * error * SIM_STEP, 0.0f), cap);
+    plant->inverter_power = fminf(fmaxf(SIM_INVERTER_KP * error + plant->inverter_integral, 0.0f), cap);
+
+    // C/2 * dV^2/dt = P_in - P_out
+    float energy = 0.5f * SIM_BUS_CAPACITANCE * plant->bus_voltage * plant->bus_voltage + (input - plant->inverter_power) * SIM_STEP;
+    plant->bus_voltage = sqrtf(fmaxf(2.0f * energy / SIM_BUS_CAPACITANCE, 0.0f));
+
+    for (uint32_t i = 0; i < SIM_STRING_COUNT; i++)
+    {
+        SIM_StringTypeDef *string = &plant->strings[i];
+
+        if (plant->bus_voltage > SIM_BUS_VOLTAGE_WARNING)
+        {
+            string->bus_warning = true;
+        }
+        else if (plant->bus_voltage < SIM_BUS_VOLTAGE_WARNING - SIM_BUS_VOLTAGE_HYSTERESIS)
+        {
+            string->bus_warning = false;
+        }
+    }
+
+    // Critical: the converters drop to standby, the bus discharges into the inverter
+    if (plant->bus_voltage > SIM_BUS_VOLTAGE_CRITICAL)
+    {
+        for (uint32_t i = 0; i < SIM_STRING_COUNT; i++)
+        {
+            plant->strings[i].power = 0.0f;
+        }
+
+        plant->standby_count++;
+    }
+}
+
+static void SIM_Run(const SIM_ModeTypeDef mode, const float duration, const float export_limit, FILE *csv)
+{
+    SIM_PlantTypeDef plant;
+    EVERT_CCU_OPTIMIZER_StateTypeDef optimizer;
+    EVERT_CCU_OPTIMIZER_LimitsTypeDef limits = {.export_limit = -1.0f, .inverter_power_max = EVERT_SETTING_CCU_OPTIMIZER_INVERTER_POWER_MAX};
+    const uint32_t optimizer_steps = (uint32_t)(EVERT_SETTING_CCU_OPTIMIZER_PERIOD_MS / 1000.0f / SIM_STEP + 0.5f);
+    const uint32_t report_steps = (uint32_t)(SIM_REPORT_PERIOD / SIM_STEP + 0.5f);
+    const uint32_t steps = (uint32_t)(duration / SIM_STEP);
+
+    memset(&plant, 0, sizeof(plant));
+    plant.bus_voltage = SIM_BUS_VOLTAGE_NOMINAL;
+    plant.inverter_cap = EVERT_SETTING_CCU_OPTIMIZER_INVERTER_POWER_MAX;
+
+    for (uint32_t i = 0; i < SIM_STRING_COUNT; i++)
+    {
+        plant.strings[i].limit = -1.0f;
+        plant.strings[i].dispatch_timer = SIM_DISPATCH_TIMEOUT;
+        plant.strings[i].temperature = SIM_TEMPERATURE_AMBIENT;
+    }
+
+    EVERT_CCU_OPTIMIZER_Init(&optimizer, &limits);
+
+    for (uint32_t step = 0; step < steps; step++)
+    {
+        float t = step * SIM_STEP;
+        float limit = SIM_ExportLimit(export_limit, t);
+        float mpp_total = 0.0f;
+        bool any_warning = false;
+
+        for (uint32_t i = 0; i < SIM_STRING_COUNT; i++)
+        {
+            float mpp = SIM_STRING_POWER_RATED * SIM_Irradiance(i, t);
+            SIM_StringStep(&plant.strings[i], mpp, mode == SIM_MODE_CCU);
+            mpp_total += mpp;
+            any_warning |= plant.strings[i].temperature_warning || plant.strings[i].bus_warning;
+        }
+
+        SIM_BusStep(&plant, limit);
+
+        if (step % report_steps == 0)
+        {
+            for (uint32_t i = 0; i < SIM_STRING_COUNT; i++)
+            {
+                SIM_StringTypeDef *string = &plant.strings[i];
+                string->report_power = roundf(string->power);
+                string->report_available = roundf(string->available);
+                string->report_bus_voltage = roundf(plant.bus_voltage * 10.0f) / 10.0f;
+            }
+        }
+
+        if (mode == SIM_MODE_CCU && step % optimizer_steps == 0)
+        {
+            EVERT_CCU_OPTIMIZER_StringTypeDef strings[EVERT_CONSTANT_CCU_DEVICE_COUNT];
+            memset(strings, 0, sizeof(strings));
+
+            for (uint32_t i = 0; i < SIM_STRING_COUNT; i++)
+            {
+                const SIM_StringTypeDef *string = &plant.strings[i];
+
+                strings[1 + i] = (EVERT_CCU_OPTIMIZER_StringTypeDef){
+                    .present = true,
+                    .warning = string->temperature_warning || string->bus_warning,
+                    .power = string->report_power,
+                    .available = string->report_available,
+                    .bus_voltage = string->report_bus_voltage,
+                    .cap = NAN,
+                };
+            }
+
+            optimizer.limits.export_limit = limit;
+            EVERT_CCU_OPTIMIZER_Run(&optimizer, strings, optimizer_steps * SIM_STEP);
+
+            // BCCM_POWER_LIMIT_BATCH, whole watts
+            for (uint32_t i = 0; i < SIM_STRING_COUNT; i++)
+            {
+                float setpoint = optimizer.setpoints[1 + i];
+                plant.strings[i].limit = isnan(setpoint) ? -1.0f : roundf(setpoint);
+                plant.strings[i].dispatch_timer = 0.0f;
+            }
+        }
+
+        // Metrics
+        float allowed = fminf(mpp_total * EVERT_SETTING_CCU_OPTIMIZER_INVERTER_EFFICIENCY, plant.inverter_cap);
+
+        plant.energy_available += mpp_total * SIM_STEP / 3600.0f;
+        plant.energy_allowed += allowed * SIM_STEP / 3600.0f;
+        plant.energy_exported += plant.inverter_power * EVERT_SETTING_CCU_OPTIMIZER_INVERTER_EFFICIENCY * SIM_STEP / 3600.0f;
+        plant.bus_voltage_max = fmaxf(plant.bus_voltage_max, plant.bus_voltage);
+        plant.time_over_warning += plant.bus_voltage > SIM_BUS_VOLTAGE_WARNING ? SIM_STEP : 0.0f;
+        plant.time_warning += any_warning ? SIM_STEP : 0.0f;
+
+        if (csv != NULL && step % 10 == 0)
+        {
+            fprintf(csv, "%s,%.3f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n", mode == SIM_MODE_CCU ? "ccu" : "local", t,
+                    plant.strings[0].power, plant.strings[0].limit, plant.strings[0].temperature,
+                    plant.strings[1].power, plant.strings[1].limit, plant.strings[1].temperature,
+                    plant.bus_voltage, plant.inverter_power, limit);
+        }
+    }
+
+    printf("%-5s exported %7.2f Wh of %7.2f Wh allowed (%5.1f %%, MPP %7.2f Wh), wasted %6.2f Wh, bus max %5.1f V, "
+           "%5.2f s over %.0f V, %5.1f s in warning, %u standby\n",
+           mode == SIM_MODE_CCU ? "ccu" : "local", plant.energy_exported, plant.energy_allowed,
+           100.0f * plant.energy_exported / plant.energy_allowed, plant.energy_available,
+           plant.energy_allowed - plant.energy_exported, plant.bus_voltage_max, plant.time_over_warning,
+           SIM_BUS_VOLTAGE_WARNING, plant.time_warning, plant.standby_count);
+}
+
+static void SIM_Usage(const char *program)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -m, --mode ccu|local|both  Dispatch by the optimizer, local throttling only, or both (default)\n"
+            "  -t, --time S               Simulated time (default 120 s)\n"
+            "  -x, --export-limit W       Export limit between 40 s and 100 s (default 2000 W)\n"
+            "  -c, --csv FILE             Traces every 10 ms\n",
+            program);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option options[] = {
+        {"mode", required_argument, NULL, 'm'},
+        {"time", required_argument, NULL, 't'},
+        {"export-limit", required_argument, NULL, 'x'},
+        {"csv", required_argument, NULL, 'c'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}};
+
+    const char *mode = "both";
+    const char *csv_path = NULL;
+    float duration = 120.0f;
+    float export_limit = 2000.0f;
+    int option;
+
+    while ((option = getopt_long(argc, argv, "m:t:x:c:h", options, NULL)) != -1)
+    {
+        switch (option)
+        {
+        case 'm':
+            mode = optarg;
+            break;
+
+        case 't':
+            duration = strtof(optarg, NULL);
+            break;
+
+        case 'x':
+            export_limit = strtof(optarg, NULL);
+            break;
+
+        case 'c':
+            csv_path = optarg;
+            break;
+
+        default:
+            SIM_Usage(argv[0]);
+            return option == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    FILE *csv = NULL;
+
+    if (csv_path != NULL)
+    {
+        csv = fopen(csv_path, "w");
+
+        if (csv == NULL)
+        {
+            perror("SIM: csv");
+            return EXIT_FAILURE;
+        }
+
+        fprintf(csv, "mode,time_s,power1_w,limit1_w,temperature1_c,power2_w,limit2_w,temperature2_c,bus_v,inverter_w,export_limit_w\n");
+    }
+
+    if (strcmp(mode, "local") == 0 || strcmp(mode, "both") == 0)
+    {
+        SIM_Run(SIM_MODE_LOCAL, duration, export_limit, csv);
+    }
+
+    if (strcmp(mode, "ccu") == 0 || strcmp(mode, "both") == 0)
+    {
+        SIM_Run(SIM_MODE_CCU, duration, export_limit, csv);
+    }
+
+    if (csv != NULL)
+    {
+        fclose(csv);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,50 @@
+#ifndef EVERT_CCU_CONF_
+#define EVERT_CCU_CONF_
+
+// Constants (protocol/build specific)
+#define EVERT_CONSTANT_CCU_DEVICE_ID (15)           // Source id of the CCU on the bus (4 bits)
+#define EVERT_CONSTANT_CCU_DEVICE_COUNT (16)        // One slot per 4 bit device id
+#define EVERT_CONSTANT_CCU_QUEUE_SIZE (1024)        // Frames between the I/O and the worker thread, power of 2
+#define EVERT_CONSTANT_CCU_TIMESERIES_SERIES (64)   // Series in the store
+#define EVERT_CONSTANT_CCU_TIMESERIES_SAMPLES (4096) // Samples per series (ring), power of 2
+#define EVERT_CONSTANT_CCU_TICK_MS (10)             // Worker tick (supervision, heartbeat, dispatch)
+
+// Settings (software adjustable)
+#define EVERT_SETTING_CCU_INTERFACE "vcan0"
+#define EVERT_SETTING_CCU_HEARTBEAT_INTERVAL_MS (1000) // Below EVERT_SETTING_DEVICE_HEARTBEAT_TIMEOUT of the devices
+#define EVERT_SETTING_CCU_DEVICE_TIMEOUT_MS (3500)     // No frame (ping, status) this long: offline
+#define EVERT_SETTING_CCU_DISPATCH_REFRESH_MS (1000)   // Setpoints are sent on change and refreshed at this interval
+#define EVERT_SETTING_CCU_STATUS_INTERVAL_MS (5000)    // Device table on stderr, 0 = off
+#define EVERT_SETTING_CCU_TELEMETRY_LIST_TIMEOUT_MS (200) // Listing of a device without an answer this long: ended, the next device lists
+
+// Time synchronization (ccu_timesync.h)
+#define EVERT_SETTING_CCU_BITRATE (500000)                 // bit/s of the interface (ip link set can0 type can bitrate)
+#define EVERT_SETTING_CCU_TIME_SYNC_INTERVAL_MS (500)      // SYNC period, below EVERT_TIME_SYNC_HOLDOVER_MS of the devices, 0 = off
+#define EVERT_SETTING_CCU_TIME_SYNC_ECHO_TIMEOUT_MS (100)  // SYNC not back from the bus this long: given up, the next one goes out
+
+// Dispatch optimizer (ccu_optimizer.h)
+#define EVERT_SETTING_CCU_OPTIMIZER_PERIOD_MS (50)              // 20 Hz, 10 to 100 Hz, multiple of EVERT_CONSTANT_CCU_TICK_MS
+#define EVERT_SETTING_CCU_OPTIMIZER_REPORT_TIMEOUT_MS (500)     // Strings without a BCCM_POWER_REPORT this long are left out
+#define EVERT_SETTING_CCU_OPTIMIZER_EXPORT_LIMIT (-1.0f)        // W AC at the grid connection, < 0 = none
+#define EVERT_SETTING_CCU_OPTIMIZER_INVERTER_POWER_MAX (3000.0f) // W AC rating of the inverter
+#define EVERT_SETTING_CCU_OPTIMIZER_INVERTER_EFFICIENCY (0.96f)
+#define EVERT_SETTING_CCU_OPTIMIZER_BUS_VOLTAGE_HIGH (840.0f)   // V, inverter bus nominal 800 V, above it the bus trim integrates
+#define EVERT_SETTING_CCU_OPTIMIZER_BUS_KI (50.0f)              // W/(V*s)
+#define EVERT_SETTING_CCU_OPTIMIZER_BUS_TRIM_RELEASE (200.0f)   // W/s, trim decay once the bus is back below the threshold
+#define EVERT_SETTING_CCU_OPTIMIZER_RAMP (500.0f)               // W/s, rise of the plant target and of each setpoint
+#define EVERT_SETTING_CCU_OPTIMIZER_WARNING_BACKOFF (100.0f)    // W/s, derating of a string in warning
+#define EVERT_SETTING_CCU_OPTIMIZER_RELEASE_MARGIN (0.1f)       // Strings are released below this fraction under the cap
+#define EVERT_SETTING_CCU_OPTIMIZER_SETPOINT_BAND (0.03f)       // EVERT_SETTING_BC_MPPT_POWER_LIMIT_BAND, a string this close is held at its setpoint
+#define EVERT_SETTING_CCU_OPTIMIZER_PROBE (0.05f)               // Fraction above the setpoint assumed available for a string held at it
+#define EVERT_SETTING_CCU_OPTIMIZER_PROBE_TIME (1.0f)           // s, a string below its setpoint keeps it this long (MPPT steps), then its power counts
+
+// Firmware update (ccu_update.h)
+#define EVERT_SETTING_CCU_UPDATE_BUS_SHARE (0.3f)           // Fraction of EVERT_SETTING_CCU_BITRATE the blocks take
+#define EVERT_SETTING_CCU_UPDATE_WINDOW (64)                // Blocks sent past the acknowledged bytes, 4 device acknowledgements
+#define EVERT_SETTING_CCU_UPDATE_ACK_TIMEOUT_MS (200)       // No progress this long: back to the acknowledged bytes
+#define EVERT_SETTING_CCU_UPDATE_COMMAND_TIMEOUT_MS (500)   // BEGIN, END not answered this long: sent again, ACTIVATE period
+#define EVERT_SETTING_CCU_UPDATE_RETRY_COUNT (10)           // Timeouts in a row before the update fails
+#define EVERT_SETTING_CCU_UPDATE_ERASE_TIMEOUT_MS (10000)   // BEGIN to FUS_RECEIVING, ~22 ms per 2 kB page
+#define EVERT_SETTING_CCU_UPDATE_BOOT_TIMEOUT_MS (60000)    // Setpoint 0 to operational with the new version
+
+#endif // EVERT_CCU_CONF_
@@ -0,0 +1,542 @@
+/**
+ ******************************************************************************
+ * @file    ccu.c
+ * @author  Evert Firmware Team
+ * @brief   Central Control Unit service: all devices of the plant over SocketCAN
+ *
+ ******************************************************************************
+ **/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include "ccu.h"
+#include "ccu_devices.h"
+#include "ccu_dispatch.h"
+#include "ccu_telemetry.h"
+#include "ccu_timesync.h"
+#include "ccu_update.h"
+
+#define EVERT_CCU_EPOLL_EVENTS (8)
+#define EVERT_CCU_IO_RETRY_MS (1) // TX retry while the interface queue is full (ENOBUFS raises no EPOLLOUT)
+
+EVERT_CCU_HandlerTypeDef ccu;
+
+static void *EVERT_CCU_IoThread(void *argument);
+static void *EVERT_CCU_WorkerThread(void *argument);
+static void EVERT_CCU_OnFrame(const EVERT_CCU_FrameTypeDef *frame);
+static void EVERT_CCU_OnTick(const uint64_t now_us);
+static void EVERT_CCU_OnCommand(char *line);
+
+static void EVERT_CCU_Signal(const int fd)
+{
+    uint64_t one = 1;
+    ssize_t result = write(fd, &one, sizeof(one));
+    (void)result; // Only fails when the counter is saturated, the other side is awake then anyway
+}
+
+static void EVERT_CCU_Drain(const int fd)
+{
+    uint64_t count;
+    ssize_t result = read(fd, &count, sizeof(count));
+    (void)result;
+}
+
+static bool EVERT_CCU_EpollAdd(const int epoll_fd, const int fd, const uint32_t events)
+{
+    struct epoll_event event = {.events = events, .data.fd = fd};
+
+    return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+bool EVERT_CCU_Init(const char *interface, const bool commands)
+{
+    memset(&ccu, 0, sizeof(ccu));
+    ccu.rx_event_fd = -1;
+    ccu.tx_event_fd = -1;
+    ccu.stop_fd = -1;
+    ccu.commands = commands;
+
+    EVERT_CCU_QUEUE_Init(&ccu.rx_queue);
+    EVERT_CCU_QUEUE_Init(&ccu.tx_queue);
+    atomic_init(&ccu.running, false);
+    atomic_init(&ccu.tx_error_count, 0);
+
+    EVERT_CCU_TIMESERIES_Init(&ccu.timeseries);
+    EVERT_CCU_TELEMETRY_Init(&ccu.timeseries);
+    EVERT_CCU_DEVICES_Init();
+    EVERT_CCU_DISPATCH_Init();
+    EVERT_CCU_TIMESYNC_Init(EVERT_SETTING_CCU_BITRATE);
+    EVERT_CCU_UPDATE_Init(EVERT_SETTING_CCU_BITRATE);
+
+    ccu.rx_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ccu.tx_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ccu.stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (ccu.rx_event_fd < 0 || ccu.tx_event_fd < 0 || ccu.stop_fd < 0)
+    {
+        perror("CCU: eventfd");
+        return false;
+    }
+
+    return EVERT_CCU_SOCKETCAN_Open(&ccu.socketcan, interface);
+}
+
+/// @brief Subscribe on every handshake, device 0 = every device (before EVERT_CCU_Start)
+bool EVERT_CCU_AddSubscription(const uint8_t device_id, const uint16_t variable_id, const uint16_t period_ms)
+{
+    if (ccu.subscription_count >= EVERT_CCU_SUBSCRIPTION_COUNT)
+    {
+        return false;
+    }
+
+    ccu.subscriptions[ccu.subscription_count++] = (EVERT_CCU_SubscriptionTypeDef){device_id, variable_id, period_ms};
+
+    return true;
+}
+
+bool EVERT_CCU_Start(void)
+{
+    ccu.start_us = EVERT_CCU_GetTimeUs();
+    ccu.status_last_us = ccu.start_us;
+    atomic_store(&ccu.running, true);
+
+    if (pthread_create(&ccu.io_thread, NULL, EVERT_CCU_IoThread, NULL) != 0)
+    {
+        atomic_store(&ccu.running, false);
+        return false;
+    }
+
+    if (pthread_create(&ccu.worker_thread, NULL, EVERT_CCU_WorkerThread, NULL) != 0)
+    {
+        EVERT_CCU_Stop();
+        pthread_join(ccu.io_thread, NULL);
+        return false;
+    }
+
+    return true;
+}
+
+/// @brief Stop both threads, async-signal-safe
+void EVERT_CCU_Stop(void)
+{
+    atomic_store(&ccu.running, false);
+    EVERT_CCU_Signal(ccu.stop_fd);
+}
+
+void EVERT_CCU_Join(void)
+{
+    pthread_join(ccu.worker_thread, NULL);
+    pthread_join(ccu.io_thread, NULL);
+}
+
+void EVERT_CCU_Deinit(void)
+{
+    EVERT_CCU_SOCKETCAN_Close(&ccu.socketcan);
+
+    int *fds[] = {&ccu.rx_event_fd, &ccu.tx_event_fd, &ccu.stop_fd};
+
+    for (uint32_t i = 0; i < sizeof(fds) / sizeof(fds[0]); i++)
+    {
+        if (*fds[i] >= 0)
+        {
+            close(*fds[i]);
+            *fds[i] = -1;
+        }
+    }
+}
+
+/// @brief Queue a frame for the bus, worker thread only
+void EVERT_CCU_Transmit(const EVERT_CCU_FrameTypeDef *frame)
+{
+    if (EVERT_CCU_QUEUE_Push(&ccu.tx_queue, frame))
+    {
+        ccu.tx_pending = true;
+    }
+}
+
+void EVERT_CCU_PrintStatus(FILE *file)
+{
+    uint64_t now_us = EVERT_CCU_GetTimeUs();
+
+    fprintf(file, "CCU: up %" PRIu64 " s, rx %" PRIu64 " tx %" PRIu64 " frames, dropped rx %" PRIuFAST32 " tx %" PRIuFAST32 ", errors %" PRIu64 ", %u series\n",
+            (now_us - ccu.start_us) / 1000000u, ccu.socketcan.rx_count, ccu.socketcan.tx_count,
+            atomic_load(&ccu.rx_queue.drop_count), atomic_load(&ccu.tx_queue.drop_count),
+            ccu.socketcan.error_count + atomic_load(&ccu.tx_error_count), ccu.timeseries.series_count);
+
+    EVERT_CCU_DEVICES_Print(file, now_us);
+    EVERT_CCU_DISPATCH_Print(file);
+    EVERT_CCU_TIMESYNC_Print(file);
+    EVERT_CCU_UPDATE_Print(file);
+    EVERT_CCU_TELEMETRY_Print(file);
+}
+
+//
+// #region "I/O Thread"
+//
+
+/// @brief Write the TX queue to the socket until it is empty or the socket is full
+/// @return true if frames are left (wait for EPOLLOUT or retry)
+static bool EVERT_CCU_IoFlush(void)
+{
+    const EVERT_CCU_FrameTypeDef *frame;
+
+    while ((frame = EVERT_CCU_QUEUE_Peek(&ccu.tx_queue)) != NULL)
+    {
+        EVERT_CCU_SOCKETCAN_StatusTypeDef status = EVERT_CCU_SOCKETCAN_Write(&ccu.socketcan, frame);
+
+        if (status == CSS_AGAIN)
+        {
+            return true;
+        }
+
+        if (status == CSS_ERROR)
+        {
+            atomic_fetch_add(&ccu.tx_error_count, 1); // Dropped, e.g. bus off
+        }
+
+        EVERT_CCU_QUEUE_Consume(&ccu.tx_queue);
+    }
+
+    return false;
+}
+
+static void *EVERT_CCU_IoThread(void *argument)
+{
+    (void)argument;
+
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+
+    if (epoll_fd < 0 ||
+        !EVERT_CCU_EpollAdd(epoll_fd, ccu.socketcan.fd, EPOLLIN) ||
+        !EVERT_CCU_EpollAdd(epoll_fd, ccu.tx_event_fd, EPOLLIN) ||
+        !EVERT_CCU_EpollAdd(epoll_fd, ccu.stop_fd, EPOLLIN))
+    {
+        perror("CCU: epoll (I/O)");
+        EVERT_CCU_Stop();
+        return NULL;
+    }
+
+    bool tx_blocked = false;
+    struct epoll_event events[EVERT_CCU_EPOLL_EVENTS];
+
+    while (atomic_load(&ccu.running))
+    {
+        int count = epoll_wait(epoll_fd, events, EVERT_CCU_EPOLL_EVENTS, tx_blocked ? EVERT_CCU_IO_RETRY_MS : -1);
+
+        if (count < 0 && errno != EINTR)
+        {
+            perror("CCU: epoll_wait (I/O)");
+            break;
+        }
+
+        bool received = false;
+
+        for (int i = 0; i < count; i++)
+        {
+            int fd = events[i].data.fd;
+
+            if (fd == ccu.socketcan.fd && (events[i].events & EPOLLIN))
+            {
+                EVERT_CCU_FrameTypeDef frame;
+                EVERT_CCU_SOCKETCAN_StatusTypeDef status;
+
+                while ((status = EVERT_CCU_SOCKETCAN_Read(&ccu.socketcan, &frame)) != CSS_AGAIN)
+                {
+                    if (status == CSS_ERROR)
+                    {
+                        break;
+                    }
+
+                    if (status == CSS_OK)
+                    {
+                        received |= EVERT_CCU_QUEUE_Push(&ccu.rx_queue, &frame);
+                    }
+                }
+            }
+            else if (fd == ccu.tx_event_fd)
+            {
+                EVERT_CCU_Drain(ccu.tx_event_fd);
+            }
+        }
+
+        // One wake-up per batch
+        if (received)
+        {
+            EVERT_CCU_Signal(ccu.rx_event_fd);
+        }
+
+        bool blocked = EVERT_CCU_IoFlush();
+
+        if (blocked != tx_blocked)
+        {
+            struct epoll_event event = {.events = EPOLLIN | (blocked ? EPOLLOUT : 0), .data.fd = ccu.socketcan.fd};
+            epoll_ctl(epoll_fd, EPOLL_CTL_MOD, ccu.socketcan.fd, &event);
+            tx_blocked = blocked;
+        }
+    }
+
+    close(epoll_fd);
+
+    return NULL;
+}
+
+//
+// #endregion "I/O Thread"
+//
+
+//
+// #region "Worker Thread"
+//
+
+static void *EVERT_CCU_WorkerThread(void *argument)
+{
+    (void)argument;
+
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    struct itimerspec tick = {
+        .it_interval = {.tv_sec = 0, .tv_nsec = EVERT_CONSTANT_CCU_TICK_MS * 1000000L},
+        .it_value = {.tv_sec = 0, .tv_nsec = EVERT_CONSTANT_CCU_TICK_MS * 1000000L}};
+
+    if (epoll_fd < 0 || timer_fd < 0 || timerfd_settime(timer_fd, 0, &tick, NULL) < 0 ||
+        !EVERT_CCU_EpollAdd(epoll_fd, ccu.rx_event_fd, EPOLLIN) ||
+        !EVERT_CCU_EpollAdd(epoll_fd, timer_fd, EPOLLIN) ||
+        !EVERT_CCU_EpollAdd(epoll_fd, ccu.stop_fd, EPOLLIN) ||
+        (ccu.commands && !EVERT_CCU_EpollAdd(epoll_fd, STDIN_FILENO, EPOLLIN)))
+    {
+        perror("CCU: epoll (worker)");
+        EVERT_CCU_Stop();
+        return NULL;
+    }
+
+    char command[128];
+    size_t command_length = 0;
+    struct epoll_event events[EVERT_CCU_EPOLL_EVENTS];
+
+    while (atomic_load(&ccu.running))
+    {
+        int count = epoll_wait(epoll_fd, events, EVERT_CCU_EPOLL_EVENTS, -1);
+
+        if (count < 0 && errno != EINTR)
+        {
+            perror("CCU: epoll_wait (worker)");
+            break;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            int fd = events[i].data.fd;
+
+            if (fd == ccu.rx_event_fd)
+            {
+                EVERT_CCU_Drain(ccu.rx_event_fd);
+
+                EVERT_CCU_FrameTypeDef frame;
+
+                while (EVERT_CCU_QUEUE_Pop(&ccu.rx_queue, &frame))
+                {
+                    EVERT_CCU_OnFrame(&frame);
+                }
+            }
+            else if (fd == timer_fd)
+            {
+                EVERT_CCU_Drain(timer_fd);
+                EVERT_CCU_OnTick(EVERT_CCU_GetTimeUs());
+            }
+            else if (fd == STDIN_FILENO)
+            {
+                char buffer[64];
+                ssize_t length = read(STDIN_FILENO, buffer, sizeof(buffer));
+
+                if (length <= 0)
+                {
+                    // End of input, keep running without commands
+                    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, STDIN_FILENO, NULL);
+                    continue;
+                }
+
+                for (ssize_t n = 0; n < length; n++)
+                {
+                    if (buffer[n] == '\n' || command_length == sizeof(command) - 1)
+                    {
+                        command[command_length] = '\0';
+                        EVERT_CCU_OnCommand(command);
+                        command_length = 0;
+                    }
+                    else
+                    {
+                        command[command_length++] = buffer[n];
+                    }
+                }
+            }
+        }
+
+        if (ccu.tx_pending)
+        {
+            ccu.tx_pending = false;
+            EVERT_CCU_Signal(ccu.tx_event_fd);
+        }
+    }
+
+    close(timer_fd);
+    close(epoll_fd);
+
+    return NULL;
+}
+
+static void EVERT_CCU_OnFrame(const EVERT_CCU_FrameTypeDef *frame)
+{
+    // Own frame back from the bus, only the SYNC gets this far (ccu_socketcan.c)
+    if (frame->identifier.source_id == EVERT_CONSTANT_CCU_DEVICE_ID)
+    {
+        EVERT_CCU_TIMESYNC_OnEcho(frame);
+        return;
+    }
+
+    // Frames addressed to another node (peer to peer, e.g. current share is broadcast and kept)
+    if (frame->identifier.target_id != EVERT_CCU_PROTOCOL_BROADCAST && frame->identifier.target_id != EVERT_CONSTANT_CCU_DEVICE_ID)
+    {
+        return;
+    }
+
+    EVERT_CCU_DEVICES_OnFrame(frame);
+    EVERT_CCU_TELEMETRY_OnFrame(frame);
+    EVERT_CCU_UPDATE_OnFrame(frame);
+}
+
+static void EVERT_CCU_OnTick(const uint64_t now_us)
+{
+    EVERT_CCU_DEVICES_Process(now_us);
+    EVERT_CCU_DISPATCH_Process(now_us);
+    EVERT_CCU_TIMESYNC_Process(now_us);
+    EVERT_CCU_TELEMETRY_Process(now_us);
+    EVERT_CCU_UPDATE_Process(now_us);
+
+    if (EVERT_SETTING_CCU_STATUS_INTERVAL_MS > 0 && now_us - ccu.status_last_us >= (uint64_t)EVERT_SETTING_CCU_STATUS_INTERVAL_MS * 1000u)
+    {
+        ccu.status_last_us = now_us;
+        EVERT_CCU_PrintStatus(stderr);
+    }
+}
+
+/// @brief Operator commands, one per line:
+///        setpoint <device> <W|off>, optimize <on|off>, limit <W|off>, reset <device>, state <propagated state>,
+///        subscribe <device> <variable id> <period ms>, update <device> <file.bin> <major.minor.patch>, status,
+///        export <file>, quit
+static void EVERT_CCU_OnCommand(char *line)
+{
+    char *save = NULL;
+    char *name = strtok_r(line, " \t\r", &save);
+    char *arguments[3] = {NULL, NULL, NULL};
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        arguments[i] = strtok_r(NULL, " \t\r", &save);
+    }
+
+    if (name == NULL)
+    {
+        return;
+    }
+
+    if (strcmp(name, "setpoint") == 0 && arguments[1] != NULL)
+    {
+        float power = strcmp(arguments[1], "off") == 0 ? NAN : strtof(arguments[1], NULL);
+        EVERT_CCU_DISPATCH_SetPowerSetpoint((uint8_t)strtoul(arguments[0], NULL, 0), power);
+    }
+    else if (strcmp(name, "optimize") == 0 && arguments[0] != NULL)
+    {
+        EVERT_CCU_DISPATCH_SetOptimizer(strcmp(arguments[0], "on") == 0);
+    }
+    else if (strcmp(name, "limit") == 0 && arguments[0] != NULL)
+    {
+        EVERT_CCU_DISPATCH_SetExportLimit(strcmp(arguments[0], "off") == 0 ? NAN : strtof(arguments[0], NULL));
+    }
+    else if (strcmp(name, "reset") == 0 && arguments[0] != NULL)
+    {
+        EVERT_CCU_DEVICES_Reset((uint8_t)strtoul(arguments[0], NULL, 0));
+    }
+    else if (strcmp(name, "state") == 0 && arguments[0] != NULL)
+    {
+        EVERT_CCU_DEVICES_SetPropagatedState((EVERT_DEVICE_StateTypeDef)strtoul(arguments[0], NULL, 0));
+    }
+    else if (strcmp(name, "subscribe") == 0 && arguments[2] != NULL)
+    {
+        EVERT_CCU_TELEMETRY_Subscribe((uint8_t)strtoul(arguments[0], NULL, 0), (uint16_t)strtoul(arguments[1], NULL, 0), (uint16_t)strtoul(arguments[2], NULL, 0));
+    }
+    else if (strcmp(name, "update") == 0 && arguments[2] != NULL)
+    {
+        unsigned version[3];
+
+        if (sscanf(arguments[2], "%u.%u.%u", &version[0], &version[1], &version[2]) != 3 ||
+            !EVERT_CCU_UPDATE_Load((uint8_t)strtoul(arguments[0], NULL, 0), arguments[1], (uint8_t[3]){version[0], version[1], version[2]}))
+        {
+            fprintf(stderr, "CCU: update of device %s not queued\n", arguments[0]);
+        }
+    }
+    else if (strcmp(name, "status") == 0)
+    {
+        EVERT_CCU_PrintStatus(stdout);
+    }
+    else if (strcmp(name, "export") == 0 && arguments[0] != NULL)
+    {
+        FILE *file = fopen(arguments[0], "w");
+
+        if (file != NULL)
+        {
+            EVERT_CCU_TIMESERIES_ExportCsv(&ccu.timeseries, file);
+            fclose(file);
+        }
+        else
+        {
+            perror("CCU: export");
+        }
+    }
+    else if (strcmp(name, "quit") == 0)
+    {
+        EVERT_CCU_Stop();
+    }
+    else
+    {
+        fprintf(stderr, "CCU: unknown command %s\n", name);
+    }
+}
+
+//
+// #endregion "Worker Thread"
+//
+
+// __weak Callbacks - Devices
+void EVERT_CCU_DEVICES_OnOffline(const EVERT_CCU_DeviceTypeDef *device)
+{
+    fprintf(stderr, "CCU: device %u offline\n", device->id);
+
+    // Listings of a device that is gone would hold up the others
+    EVERT_CCU_TELEMETRY_Forget(device->id);
+}
+
+void EVERT_CCU_DEVICES_OnAcknowledged(const EVERT_CCU_DeviceTypeDef *device)
+{
+    fprintf(stderr, "CCU: device %u acknowledged after %" PRIu64 " ms\n", device->id, device->handshake_us / 1000u);
+
+    // Types of the registry variables first, the subscriptions stream them
+    EVERT_CCU_TELEMETRY_Discover(device->id);
+
+    for (uint32_t i = 0; i < ccu.subscription_count; i++)
+    {
+        const EVERT_CCU_SubscriptionTypeDef *subscription = &ccu.subscriptions[i];
+
+        if (subscription->device_id == 0 || subscription->device_id == device->id)
+        {
+            EVERT_CCU_TELEMETRY_Subscribe(device->id, subscription->variable_id, subscription->period_ms);
+        }
+    }
+}
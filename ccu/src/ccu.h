@@ -0,0 +1,82 @@
+/**
+ ******************************************************************************
+ * @file    ccu.h
+ * @author  Evert Firmware Team
+ * @brief   Central Control Unit service: all devices of the plant over SocketCAN
+ *          * Config: _conf_evert_ccu.h
+ *          * Threads:
+ *              * I/O: epoll on the CAN socket, frames in -> RX queue, TX queue -> socket
+ *              * Worker: RX queue -> devices/telemetry, tick (supervision, heartbeat, dispatch), commands
+ *              * The queues are lock-free SPSC (ccu_queue.h), eventfds wake the other side
+ *          * Related:
+ *              * ccu_protocol.h (identifier/frame codec, methods)
+ *              * ccu_socketcan.h (socket)
+ *              * ccu_devices.h (handshake, heartbeat, supervision)
+ *              * ccu_telemetry.h | ccu_timeseries.h (ingestion, store)
+ *              * ccu_delta_telemetry.h (decoder of the device delta telemetry)
+ *              * ccu_dispatch.h | ccu_optimizer.h (power setpoints, plant-level dispatch)
+ *              * ccu_timesync.h (time synchronization master)
+ *              * ccu_update.h (firmware update of the devices)
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_CCU_H_
+#define EVERT_CCU_H_
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "_conf_evert_ccu.h"
+#include "ccu_protocol.h"
+#include "ccu_queue.h"
+#include "ccu_socketcan.h"
+#include "ccu_timeseries.h"
+
+#define EVERT_CCU_SUBSCRIPTION_COUNT (16) // Subscriptions made on every handshake
+
+typedef struct
+{
+    uint8_t device_id; // 0 = every device
+    uint16_t variable_id;
+    uint16_t period_ms;
+} EVERT_CCU_SubscriptionTypeDef;
+
+typedef struct
+{
+    EVERT_CCU_SOCKETCAN_HandlerTypeDef socketcan;
+    EVERT_CCU_QueueTypeDef rx_queue; // I/O -> worker
+    EVERT_CCU_QueueTypeDef tx_queue; // Worker -> I/O
+    int rx_event_fd;
+    int tx_event_fd;
+    int stop_fd;
+    bool tx_pending; // Worker: frames queued since the last I/O wake-up
+    bool commands;   // Worker reads commands from stdin
+
+    pthread_t io_thread;
+    pthread_t worker_thread;
+    atomic_bool running;
+
+    EVERT_CCU_TIMESERIES_StoreTypeDef timeseries;
+    EVERT_CCU_SubscriptionTypeDef subscriptions[EVERT_CCU_SUBSCRIPTION_COUNT];
+    uint32_t subscription_count;
+
+    uint64_t start_us;
+    uint64_t status_last_us;
+    atomic_uint_fast64_t tx_error_count;
+} EVERT_CCU_HandlerTypeDef;
+
+extern EVERT_CCU_HandlerTypeDef ccu;
+
+bool EVERT_CCU_Init(const char *interface, const bool commands);
+bool EVERT_CCU_AddSubscription(const uint8_t device_id, const uint16_t variable_id, const uint16_t period_ms);
+bool EVERT_CCU_Start(void);
+void EVERT_CCU_Stop(void);
+void EVERT_CCU_Join(void);
+void EVERT_CCU_Deinit(void);
+
+void EVERT_CCU_Transmit(const EVERT_CCU_FrameTypeDef *frame);
+void EVERT_CCU_PrintStatus(FILE *file);
+
+#endif // EVERT_CCU_H_
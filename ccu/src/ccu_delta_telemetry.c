@@ -0,0 +1,164 @@
+/**
+ ******************************************************************************
+ * @file    ccu_delta_telemetry.c
+ * @author  Evert Firmware Team
+ * @brief   Decoder of the device delta telemetry
+ *
+ ******************************************************************************
+ **/
+
+#include <string.h>
+#include "ccu_delta_telemetry.h"
+
+#define EVERT_CCU_DELTA_TELEMETRY_GROUP_SIZE (8)
+
+/// @brief Zig-zag varint at payload[*position], advances the position
+/// @return false: truncated or longer than the encoder writes
+static bool EVERT_CCU_DELTA_TELEMETRY_ReadVarint(const uint8_t *payload, const uint32_t length, uint32_t *position, int32_t *value)
+{
+    uint32_t raw = 0;
+
+    for (uint32_t i = 0; i < EVERT_CCU_DELTA_TELEMETRY_VARINT_MAX; i++)
+    {
+        if (*position >= length)
+        {
+            return false;
+        }
+
+        uint8_t byte = payload[(*position)++];
+        raw |= (uint32_t)(byte & 0x7F) << (7 * i);
+
+        if ((byte & 0x80) == 0)
+        {
+            *value = (int32_t)(raw >> 1) ^ -(int32_t)(raw & 1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void EVERT_CCU_DELTA_TELEMETRY_Reset(EVERT_CCU_DELTA_TELEMETRY_DecoderTypeDef *decoder)
+{
+    memset(decoder, 0, sizeof(*decoder));
+}
+
+/// @brief Table entry from BCCM_TELEMETRY_SIGNAL
+/// @return true: an entry was missed, list again from signal_count
+bool EVERT_CCU_DELTA_TELEMETRY_OnSignal(EVERT_CCU_DELTA_TELEMETRY_DecoderTypeDef *decoder, const uint8_t index, const uint16_t id, const float resolution)
+{
+    if (decoder->complete)
+    {
+        return false;
+    }
+
+    if (id == EVERT_CCU_DELTA_TELEMETRY_END || index >= EVERT_CCU_DELTA_TELEMETRY_SIGNAL_COUNT)
+    {
+        decoder->complete = index == decoder->signal_count;
+        return !decoder->complete;
+    }
+
+    if (index != decoder->signal_count)
+    {
+        return false; // Past a missed entry, or a repeat
+    }
+
+    decoder->id[index] = id;
+    decoder->resolution[index] = resolution;
+    decoder->valid[index] = false;
+    decoder->signal_count++;
+
+    return false;
+}
+
+/// @brief Payload of a BCCM_TELEMETRY_FRAME
+/// @param updated Indices of the values the frame set (valid ones only), up to capacity
+/// @return Number of updated indices
+uint32_t EVERT_CCU_DELTA_TELEMETRY_Decode(EVERT_CCU_DELTA_TELEMETRY_DecoderTypeDef *decoder, const uint8_t sequence, const uint8_t *payload, const uint32_t length, uint8_t *updated, const uint32_t capacity)
+{
+    if (!decoder->complete || length == 0)
+    {
+        return 0;
+    }
+
+    if (decoder->started && sequence != (uint8_t)(decoder->sequence + 1))
+    {
+        // Lost frames: whatever they changed is unknown until the next keyframe
+        decoder->lost_count += (uint8_t)(sequence - decoder->sequence - 1);
+        memset(decoder->valid, 0, sizeof(decoder->valid));
+    }
+
+    decoder->started = true;
+    decoder->sequence = sequence;
+    decoder->frame_count++;
+    decoder->byte_count += length;
+
+    bool keyframe = (payload[0] & EVERT_CCU_DELTA_TELEMETRY_KEYFRAME) != 0;
+    uint32_t index = payload[0] & EVERT_CCU_DELTA_TELEMETRY_INDEX_MASK;
+    uint32_t position = 1;
+    uint32_t count = 0;
+    int32_t value;
+
+    decoder->keyframe_count += keyframe;
+
+    while (position < length)
+    {
+        if (keyframe)
+        {
+            if (index >= decoder->signal_count || !EVERT_CCU_DELTA_TELEMETRY_ReadVarint(payload, length, &position, &value))
+            {
+                decoder->error_count++;
+                break;
+            }
+
+            decoder->value[index] = value;
+            decoder->valid[index] = true;
+
+            if (count < capacity)
+            {
+                updated[count++] = (uint8_t)index;
+            }
+
+            index++;
+            continue;
+        }
+
+        uint8_t mask = payload[position++];
+
+        for (uint32_t bit = 0; bit < EVERT_CCU_DELTA_TELEMETRY_GROUP_SIZE && mask != 0; bit++, mask >>= 1)
+        {
+            if ((mask & 1) == 0)
+            {
+                continue;
+            }
+
+            if (index + bit >= decoder->signal_count || !EVERT_CCU_DELTA_TELEMETRY_ReadVarint(payload, length, &position, &value))
+            {
+                decoder->error_count++;
+                decoder->value_count += count;
+                return count;
+            }
+
+            if (decoder->valid[index + bit])
+            {
+                decoder->value[index + bit] += value;
+
+                if (count < capacity)
+                {
+                    updated[count++] = (uint8_t)(index + bit);
+                }
+            }
+        }
+
+        index += EVERT_CCU_DELTA_TELEMETRY_GROUP_SIZE;
+    }
+
+    decoder->value_count += count;
+
+    return count;
+}
+
+float EVERT_CCU_DELTA_TELEMETRY_Value(const EVERT_CCU_DELTA_TELEMETRY_DecoderTypeDef *decoder, const uint32_t index)
+{
+    return index < decoder->signal_count ? (float)decoder->value[index] * decoder->resolution[index] : 0.0f;
+}
@@ -0,0 +1,56 @@
+/**
+ ******************************************************************************
+ * @file    ccu_delta_telemetry.h
+ * @author  Evert Firmware Team
+ * @brief   Decoder of the device delta telemetry (libs/core/src/delta_telemetry.h has the format)
+ *          * Table: BCCM_TELEMETRY_LIST asks the device for it, the BCCM_TELEMETRY_SIGNAL answers (message id =
+ *            index) run up to the end marker. Entries after a missed one are dropped, the end marker then asks
+ *            again from the gap. Frames before the table is complete are dropped.
+ *          * Frames: message id = sequence. A gap invalidates every signal, a keyframe validates the signals it
+ *            carries, the differences only apply to valid signals.
+ *          * Decoded values are the quantized steps times the resolution of the signal
+ *          * Worker thread only
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_CCU_DELTA_TELEMETRY_H_
+#define EVERT_CCU_DELTA_TELEMETRY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define EVERT_CCU_DELTA_TELEMETRY_SIGNAL_COUNT (128) // Index limit of the format
+#define EVERT_CCU_DELTA_TELEMETRY_END (0xFFFF)       // BCCM_TELEMETRY_SIGNAL id past the end of the table
+#define EVERT_CCU_DELTA_TELEMETRY_KEYFRAME (0x80)
+#define EVERT_CCU_DELTA_TELEMETRY_INDEX_MASK (0x7F)
+#define EVERT_CCU_DELTA_TELEMETRY_VARINT_MAX (4)
+
+typedef struct
+{
+    // Table
+    uint16_t id[EVERT_CCU_DELTA_TELEMETRY_SIGNAL_COUNT];
+    float resolution[EVERT_CCU_DELTA_TELEMETRY_SIGNAL_COUNT];
+    uint32_t signal_count;
+    bool complete; // End marker received
+
+    // Values
+    int32_t value[EVERT_CCU_DELTA_TELEMETRY_SIGNAL_COUNT];
+    bool valid[EVERT_CCU_DELTA_TELEMETRY_SIGNAL_COUNT];
+    bool started; // A frame was decoded, sequence holds its number
+    uint8_t sequence;
+
+    // Statistics
+    uint64_t frame_count;
+    uint64_t keyframe_count; // Frames
+    uint64_t byte_count;     // Payload bytes
+    uint64_t value_count;    // Values decoded
+    uint64_t lost_count;     // Frames missing in the sequence
+    uint64_t error_count;    // Malformed payloads
+} EVERT_CCU_DELTA_TELEMETRY_DecoderTypeDef;
+
+void EVERT_CCU_DELTA_TELEMETRY_Reset(EVERT_CCU_DELTA_TELEMETRY_DecoderTypeDef *decoder);
+bool EVERT_CCU_DELTA_TELEMETRY_OnSignal(EVERT_CCU_DELTA_TELEMETRY_DecoderTypeDef *decoder, const uint8_t index, const uint16_t id, const float resolution);
+uint32_t EVERT_CCU_DELTA_TELEMETRY_Decode(EVERT_CCU_DELTA_TELEMETRY_DecoderTypeDef *decoder, const uint8_t sequence, const uint8_t *payload, const uint32_t length, uint8_t *updated, const uint32_t capacity);
+float EVERT_CCU_DELTA_TELEMETRY_Value(const EVERT_CCU_DELTA_TELEMETRY_DecoderTypeDef *decoder, const uint32_t index);
+
+#endif // EVERT_CCU_DELTA_TELEMETRY_H_
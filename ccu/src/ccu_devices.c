@@ -0,0 +1,216 @@
+/**
+ ******************************************************************************
+ * @file    ccu_devices.c
+ * @author  Evert Firmware Team
+ * @brief   Device table of the CCU: handshake, heartbeat and ping supervision
+ *
+ ******************************************************************************
+ **/
+
+#include <inttypes.h>
+#include <string.h>
+#include "ccu.h"
+#include "ccu_devices.h"
+
+typedef struct
+{
+    EVERT_CCU_DeviceTypeDef devices[EVERT_CONSTANT_CCU_DEVICE_COUNT];
+    EVERT_DEVICE_StateTypeDef propagated_state; // Plant state sent with the heartbeat
+    uint64_t heartbeat_last_us;
+} EVERT_CCU_DEVICES_HandlerTypeDef;
+
+static EVERT_CCU_DEVICES_HandlerTypeDef devices;
+
+static const char *EVERT_CCU_DEVICES_StateName(const EVERT_DEVICE_StateTypeDef state)
+{
+    static const char *names[] = {"unknown", "booting", "booting adc", "booting comms", "booting done", "announcing", "acknowledged", "operational", "warning", "non-operational", "emergency"};
+
+    return (uint32_t)state < sizeof(names) / sizeof(names[0]) ? names[state] : "?";
+}
+
+static EVERT_CCU_DeviceKindTypeDef EVERT_CCU_DEVICES_KindOf(const uint8_t id)
+{
+    switch (id)
+    {
+    case CDI_BOOST_CONVERTER1:
+    case CDI_BOOST_CONVERTER2:
+        return CDK_BOOST_CONVERTER;
+
+    case CDI_INVERTER:
+        return CDK_INVERTER;
+
+    default:
+        return CDK_UNKNOWN;
+    }
+}
+
+static void EVERT_CCU_DEVICES_Send(const uint8_t id, const EVERT_CCU_PriorityTypeDef priority, const uint8_t length, const uint8_t *data)
+{
+    EVERT_CCU_FrameTypeDef frame;
+    EVERT_CCU_PROTOCOL_Create(&frame, id, priority, length, data);
+    EVERT_CCU_Transmit(&frame);
+}
+
+void EVERT_CCU_DEVICES_Init(void)
+{
+    memset(&devices, 0, sizeof(devices));
+
+    for (uint8_t id = 0; id < EVERT_CONSTANT_CCU_DEVICE_COUNT; id++)
+    {
+        devices.devices[id].id = id;
+        devices.devices[id].kind = EVERT_CCU_DEVICES_KindOf(id);
+    }
+
+    devices.propagated_state = DS_OPERATIONAL;
+}
+
+void EVERT_CCU_DEVICES_OnFrame(const EVERT_CCU_FrameTypeDef *frame)
+{
+    uint8_t id = frame->identifier.source_id;
+
+    if (id == CDI_UNIDENTIFIED || id == EVERT_CONSTANT_CCU_DEVICE_ID)
+    {
+        return;
+    }
+
+    EVERT_CCU_DeviceTypeDef *device = &devices.devices[id];
+    device->last_seen_us = frame->timestamp_us;
+    device->rx_count++;
+
+    if (!device->online)
+    {
+        device->online = true;
+        device->online_since_us = frame->timestamp_us;
+        EVERT_CCU_DEVICES_OnOnline(device);
+    }
+
+    if (frame->length < 4 || frame->data[0] != BCCM_DEVICE_STATE)
+    {
+        return;
+    }
+
+    EVERT_DEVICE_StateTypeDef previous = device->internal;
+    device->result = (EVERT_DEVICE_StateTypeDef)frame->data[1];
+    device->internal = (EVERT_DEVICE_StateTypeDef)frame->data[2];
+    device->propagated = (EVERT_DEVICE_StateTypeDef)frame->data[3];
+
+    if (frame->length >= 7)
+    {
+        memcpy(device->version, &frame->data[4], sizeof(device->version));
+    }
+
+    if (device->internal == DS_HANDSHAKE_ANNOUNCING)
+    {
+        if (device->announce_since_us == 0)
+        {
+            device->announce_since_us = frame->timestamp_us;
+        }
+
+        // Every announcement, an ack lost on the bus is answered with the next one
+        uint8_t data[1] = {BCCM_DEVICE_ACK};
+        EVERT_CCU_DEVICES_Send(id, CMP_HIGH, sizeof(data), data);
+        device->ack_count++;
+    }
+    else if (previous == DS_HANDSHAKE_ANNOUNCING && device->announce_since_us != 0)
+    {
+        device->handshake_us = frame->timestamp_us - device->announce_since_us;
+        device->announce_since_us = 0;
+        EVERT_CCU_DEVICES_OnAcknowledged(device);
+    }
+}
+
+/// @brief Heartbeat and supervision, call from the worker tick
+void EVERT_CCU_DEVICES_Process(const uint64_t now_us)
+{
+    for (uint8_t id = 1; id < EVERT_CONSTANT_CCU_DEVICE_COUNT; id++)
+    {
+        EVERT_CCU_DeviceTypeDef *device = &devices.devices[id];
+
+        if (device->online && now_us - device->last_seen_us > (uint64_t)EVERT_SETTING_CCU_DEVICE_TIMEOUT_MS * 1000u)
+        {
+            device->online = false;
+            device->offline_count++;
+            device->announce_since_us = 0;
+            device->internal = DS_UNKNOWN;
+            device->result = DS_UNKNOWN;
+            EVERT_CCU_DEVICES_OnOffline(device);
+        }
+    }
+
+    if (now_us - devices.heartbeat_last_us < (uint64_t)EVERT_SETTING_CCU_HEARTBEAT_INTERVAL_MS * 1000u)
+    {
+        return;
+    }
+
+    devices.heartbeat_last_us = now_us;
+
+    for (uint8_t id = 1; id < EVERT_CONSTANT_CCU_DEVICE_COUNT; id++)
+    {
+        if (devices.devices[id].online)
+        {
+            uint8_t data[2] = {BCCM_DEVICE_HEARTBEAT, (uint8_t)devices.propagated_state};
+            EVERT_CCU_DEVICES_Send(id, CMP_HIGH, sizeof(data), data);
+        }
+    }
+}
+
+/// @brief Plant state propagated to the devices with the next heartbeat
+void EVERT_CCU_DEVICES_SetPropagatedState(const EVERT_DEVICE_StateTypeDef state)
+{
+    devices.propagated_state = state;
+    devices.heartbeat_last_us = 0;
+}
+
+/// @brief Clear an emergency shutdown (the device only leaves it without critical alarms)
+void EVERT_CCU_DEVICES_Reset(const uint8_t id)
+{
+    uint8_t data[1] = {BCCM_DEVICE_RESET};
+    EVERT_CCU_DEVICES_Send(id, CMP_HIGH, sizeof(data), data);
+}
+
+const EVERT_CCU_DeviceTypeDef *EVERT_CCU_DEVICES_Get(const uint8_t id)
+{
+    return id < EVERT_CONSTANT_CCU_DEVICE_COUNT ? &devices.devices[id] : NULL;
+}
+
+/// @brief Online and past the handshake, it takes setpoints
+bool EVERT_CCU_DEVICES_IsReady(const uint8_t id)
+{
+    const EVERT_CCU_DeviceTypeDef *device = EVERT_CCU_DEVICES_Get(id);
+
+    return device != NULL && device->online &&
+           (device->internal == DS_HANDSHAKE_ACKNOWLEDGED || device->internal == DS_OPERATIONAL || device->internal == DS_OPERATIONAL_WARNING);
+}
+
+void EVERT_CCU_DEVICES_Print(FILE *file, const uint64_t now_us)
+{
+    for (uint8_t id = 1; id < EVERT_CONSTANT_CCU_DEVICE_COUNT; id++)
+    {
+        const EVERT_CCU_DeviceTypeDef *device = &devices.devices[id];
+
+        if (device->rx_count == 0)
+        {
+            continue;
+        }
+
+        fprintf(file, "CCU: device %2u %-7s %-15s (result %s) v%u.%u.%u seen %" PRIu64 " ms ago, handshake %" PRIu64 " ms, %u acks, %u offline\n",
+                id, device->online ? "online" : "offline", EVERT_CCU_DEVICES_StateName(device->internal), EVERT_CCU_DEVICES_StateName(device->result),
+                device->version[0], device->version[1], device->version[2], (now_us - device->last_seen_us) / 1000u, device->handshake_us / 1000u,
+                device->ack_count, device->offline_count);
+    }
+}
+
+__attribute__((weak)) void EVERT_CCU_DEVICES_OnOnline(const EVERT_CCU_DeviceTypeDef *device)
+{
+    fprintf(stderr, "CCU: device %u online\n", device->id);
+}
+
+__attribute__((weak)) void EVERT_CCU_DEVICES_OnOffline(const EVERT_CCU_DeviceTypeDef *device)
+{
+    fprintf(stderr, "CCU: device %u offline\n", device->id);
+}
+
+__attribute__((weak)) void EVERT_CCU_DEVICES_OnAcknowledged(const EVERT_CCU_DeviceTypeDef *device)
+{
+    fprintf(stderr, "CCU: device %u acknowledged after %" PRIu64 " ms\n", device->id, device->handshake_us / 1000u);
+}
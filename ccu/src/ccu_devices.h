@@ -0,0 +1,69 @@
+/**
+ ******************************************************************************
+ * @file    ccu_devices.h
+ * @author  Evert Firmware Team
+ * @brief   Device table of the CCU: handshake, heartbeat and ping supervision
+ *          * Handshake: a device announces with BCCM_DEVICE_STATE in DS_HANDSHAKE_ANNOUNCING, the CCU acknowledges
+ *            (BCCM_DEVICE_ACK) every announcement it sees
+ *          * Heartbeat: BCCM_DEVICE_HEARTBEAT with the plant state to propagate, to every online device
+ *            (the devices fall back to announcing without it, EVERT_SETTING_DEVICE_HEARTBEAT_TIMEOUT)
+ *          * Supervision: any frame (ping, status, data) counts, silent for EVERT_SETTING_CCU_DEVICE_TIMEOUT_MS
+ *            marks a device offline
+ *          * Worker thread only
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_CCU_DEVICES_H_
+#define EVERT_CCU_DEVICES_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "_conf_evert_ccu.h"
+#include "ccu_protocol.h"
+
+typedef enum
+{
+    CDK_UNKNOWN = 0,
+    CDK_BOOST_CONVERTER = 1,
+    CDK_INVERTER = 2
+} EVERT_CCU_DeviceKindTypeDef;
+
+typedef struct
+{
+    uint8_t id;
+    EVERT_CCU_DeviceKindTypeDef kind;
+    bool online;
+
+    // Last BCCM_DEVICE_STATE
+    EVERT_DEVICE_StateTypeDef result;
+    EVERT_DEVICE_StateTypeDef internal;
+    EVERT_DEVICE_StateTypeDef propagated;
+    uint8_t version[3];
+
+    // Supervision
+    uint64_t last_seen_us;
+    uint64_t online_since_us;
+    uint64_t rx_count;
+    uint32_t offline_count;
+
+    // Handshake
+    uint64_t announce_since_us; // First announcement of the current handshake, 0 if none
+    uint64_t handshake_us;      // Last announcement to acknowledged
+    uint32_t ack_count;
+} EVERT_CCU_DeviceTypeDef;
+
+void EVERT_CCU_DEVICES_Init(void);
+void EVERT_CCU_DEVICES_OnFrame(const EVERT_CCU_FrameTypeDef *frame);
+void EVERT_CCU_DEVICES_Process(const uint64_t now_us);
+void EVERT_CCU_DEVICES_SetPropagatedState(const EVERT_DEVICE_StateTypeDef state);
+void EVERT_CCU_DEVICES_Reset(const uint8_t id);
+const EVERT_CCU_DeviceTypeDef *EVERT_CCU_DEVICES_Get(const uint8_t id);
+bool EVERT_CCU_DEVICES_IsReady(const uint8_t id);
+void EVERT_CCU_DEVICES_Print(FILE *file, const uint64_t now_us);
+
+void EVERT_CCU_DEVICES_OnOnline(const EVERT_CCU_DeviceTypeDef *device);
+void EVERT_CCU_DEVICES_OnOffline(const EVERT_CCU_DeviceTypeDef *device);
+void EVERT_CCU_DEVICES_OnAcknowledged(const EVERT_CCU_DeviceTypeDef *device);
+
+#endif // EVERT_CCU_DEVICES_H_
@@ -0,0 +1,316 @@
+/**
+ ******************************************************************************
+ * @file    ccu_dispatch.c
+ * @author  Evert Firmware Team
+ * @brief   Power setpoint dispatch from the CCU to the devices
+ *
+ ******************************************************************************
+ **/
+
+#include <inttypes.h>
+#include <math.h>
+#include <string.h>
+#include "ccu.h"
+#include "ccu_devices.h"
+#include "ccu_dispatch.h"
+#include "ccu_telemetry.h"
+
+#define EVERT_CCU_DISPATCH_BATCH_GROUP_COUNT ((EVERT_CONSTANT_CCU_DEVICE_COUNT + EVERT_CCU_BATCH_GROUP_SIZE - 2) / EVERT_CCU_BATCH_GROUP_SIZE) // Device ids from 1
+
+_Static_assert(EVERT_SETTING_CCU_OPTIMIZER_PERIOD_MS >= 10 && EVERT_SETTING_CCU_OPTIMIZER_PERIOD_MS <= 100, "The optimizer runs at 10 to 100 Hz");
+
+static EVERT_CCU_DISPATCH_SetpointTypeDef setpoints[EVERT_CONSTANT_CCU_DEVICE_COUNT];
+
+static struct
+{
+    bool enabled;
+    EVERT_CCU_OPTIMIZER_StateTypeDef state;
+    uint64_t run_us;
+    uint16_t sent[EVERT_CONSTANT_CCU_DEVICE_COUNT]; // Last limit in a batch, EVERT_CCU_BATCH_UNCHANGED if none
+    uint64_t batch_sent_us[EVERT_CCU_DISPATCH_BATCH_GROUP_COUNT];
+    uint64_t batch_count;
+} optimizer;
+
+static void EVERT_CCU_DISPATCH_Send(const uint8_t device_id, const uint8_t length, const uint8_t *data)
+{
+    EVERT_CCU_FrameTypeDef frame;
+    EVERT_CCU_PROTOCOL_Create(&frame, device_id, CMP_NORMAL, length, data);
+    EVERT_CCU_Transmit(&frame);
+}
+
+/// @brief [1..4] power limit in W (float32), negative = unlimited
+static void EVERT_CCU_DISPATCH_SendPowerLimit(const uint8_t device_id, const float power)
+{
+    float limit = isnan(power) ? -1.0f : power;
+    uint8_t data[5] = {BCCM_POWER_LIMIT};
+    memcpy(&data[1], &limit, sizeof(limit));
+
+    EVERT_CCU_DISPATCH_Send(device_id, sizeof(data), data);
+}
+
+static void EVERT_CCU_DISPATCH_SendSetpoint(const uint8_t device_id, const EVERT_CCU_DISPATCH_SetpointTypeDef *setpoint)
+{
+    const EVERT_CCU_DeviceTypeDef *device = EVERT_CCU_DEVICES_Get(device_id);
+
+    if (device->kind == CDK_BOOST_CONVERTER)
+    {
+        // Limit first, a converter starting up never overshoots the new setpoint; the optimizer sends its own
+        bool running = isnan(setpoint->power) || setpoint->power > 0.0f;
+
+        if (running && !optimizer.enabled)
+        {
+            EVERT_CCU_DISPATCH_SendPowerLimit(device_id, setpoint->power);
+        }
+
+        uint8_t data[2] = {BCCM_SET_RUNNING, running ? 1 : 0};
+        EVERT_CCU_DISPATCH_Send(device_id, sizeof(data), data);
+    }
+    else if (device->kind == CDK_INVERTER)
+    {
+        EVERT_CCU_DISPATCH_SendPowerLimit(device_id, setpoint->power);
+    }
+}
+
+/// @brief Limit of one string in a batch
+static uint16_t EVERT_CCU_DISPATCH_BatchLimit(const float power)
+{
+    if (isnan(power))
+    {
+        return EVERT_CCU_BATCH_UNLIMITED;
+    }
+
+    return (uint16_t)fminf(fmaxf(power + 0.5f, 0.0f), (float)EVERT_CCU_BATCH_LIMIT_MAX);
+}
+
+/// @brief Optimizer inputs from the device table and the latest power reports
+static void EVERT_CCU_DISPATCH_OptimizerInputs(EVERT_CCU_OPTIMIZER_StringTypeDef *strings, const uint64_t now_us)
+{
+    static const uint16_t ids[3] = {EVERT_CCU_TIMESERIES_POWER_REPORT_POWER, EVERT_CCU_TIMESERIES_POWER_REPORT_AVAILABLE, EVERT_CCU_TIMESERIES_POWER_REPORT_BUS_VOLTAGE};
+
+    memset(strings, 0, sizeof(EVERT_CCU_OPTIMIZER_StringTypeDef) * EVERT_CONSTANT_CCU_DEVICE_COUNT);
+
+    for (uint8_t id = 1; id < EVERT_CONSTANT_CCU_DEVICE_COUNT; id++)
+    {
+        const EVERT_CCU_DeviceTypeDef *device = EVERT_CCU_DEVICES_Get(id);
+        EVERT_CCU_OPTIMIZER_StringTypeDef *string = &strings[id];
+        float values[3];
+        bool fresh = true;
+
+        // Stopped converters are in standby, nothing to dispatch
+        if (device->kind != CDK_BOOST_CONVERTER || !EVERT_CCU_DEVICES_IsReady(id) || setpoints[id].power == 0.0f)
+        {
+            continue;
+        }
+
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            EVERT_CCU_TIMESERIES_SampleTypeDef sample;
+
+            fresh &= EVERT_CCU_TIMESERIES_Latest(&ccu.timeseries, EVERT_CCU_TIMESERIES_KEY(id, CTS_POWER_REPORT, ids[i]), &sample) &&
+                     now_us - sample.timestamp_us < (uint64_t)EVERT_SETTING_CCU_OPTIMIZER_REPORT_TIMEOUT_MS * 1000u;
+            values[i] = sample.value;
+        }
+
+        if (!fresh)
+        {
+            continue;
+        }
+
+        string->present = true;
+        string->warning = device->internal == DS_OPERATIONAL_WARNING;
+        string->power = values[0];
+        string->available = values[1];
+        string->bus_voltage = values[2];
+        string->cap = setpoints[id].power;
+    }
+}
+
+/// @brief Broadcast the changed and the due limits, one frame per group of three devices
+static void EVERT_CCU_DISPATCH_SendBatches(const EVERT_CCU_OPTIMIZER_StringTypeDef *strings, const uint64_t now_us)
+{
+    for (uint8_t group = 0; group < EVERT_CCU_DISPATCH_BATCH_GROUP_COUNT; group++)
+    {
+        uint8_t data[1 + 2 * EVERT_CCU_BATCH_GROUP_SIZE] = {BCCM_POWER_LIMIT_BATCH};
+        bool changed = false;
+        bool any = false;
+
+        for (uint8_t slot = 0; slot < EVERT_CCU_BATCH_GROUP_SIZE; slot++)
+        {
+            uint8_t id = 1 + group * EVERT_CCU_BATCH_GROUP_SIZE + slot;
+            uint16_t limit = EVERT_CCU_BATCH_UNCHANGED;
+
+            if (id < EVERT_CONSTANT_CCU_DEVICE_COUNT && strings[id].present)
+            {
+                limit = EVERT_CCU_DISPATCH_BatchLimit(optimizer.state.setpoints[id]);
+                changed |= limit != optimizer.sent[id];
+                any = true;
+            }
+
+            memcpy(&data[1 + 2 * slot], &limit, sizeof(limit));
+        }
+
+        if (!any || (!changed && now_us - optimizer.batch_sent_us[group] < (uint64_t)EVERT_SETTING_CCU_DISPATCH_REFRESH_MS * 1000u))
+        {
+            continue;
+        }
+
+        EVERT_CCU_FrameTypeDef frame;
+        EVERT_CCU_PROTOCOL_Create(&frame, CDI_UNIDENTIFIED, CMP_NORMAL, sizeof(data), data);
+        frame.identifier.message_id = group;
+        EVERT_CCU_Transmit(&frame);
+
+        for (uint8_t slot = 0; slot < EVERT_CCU_BATCH_GROUP_SIZE; slot++)
+        {
+            uint8_t id = 1 + group * EVERT_CCU_BATCH_GROUP_SIZE + slot;
+
+            if (id < EVERT_CONSTANT_CCU_DEVICE_COUNT && strings[id].present)
+            {
+                optimizer.sent[id] = EVERT_CCU_DISPATCH_BatchLimit(optimizer.state.setpoints[id]);
+                EVERT_CCU_TELEMETRY_Record(id, CTS_SETPOINT, 0, now_us, optimizer.state.setpoints[id]);
+            }
+        }
+
+        optimizer.batch_sent_us[group] = now_us;
+        optimizer.batch_count++;
+    }
+}
+
+/// @brief Run the optimizer when due and send its limits
+static void EVERT_CCU_DISPATCH_Optimize(const uint64_t now_us)
+{
+    uint64_t elapsed_us = now_us - optimizer.run_us;
+
+    if (elapsed_us < (uint64_t)EVERT_SETTING_CCU_OPTIMIZER_PERIOD_MS * 1000u)
+    {
+        return;
+    }
+
+    EVERT_CCU_OPTIMIZER_StringTypeDef strings[EVERT_CONSTANT_CCU_DEVICE_COUNT];
+    EVERT_CCU_DISPATCH_OptimizerInputs(strings, now_us);
+
+    // First run or after a stall: one nominal period, not the gap
+    float dt = (optimizer.run_us == 0 || elapsed_us > 4u * EVERT_SETTING_CCU_OPTIMIZER_PERIOD_MS * 1000u) ? EVERT_SETTING_CCU_OPTIMIZER_PERIOD_MS / 1000.0f : elapsed_us / 1e6f;
+
+    EVERT_CCU_OPTIMIZER_Run(&optimizer.state, strings, dt);
+    EVERT_CCU_DISPATCH_SendBatches(strings, now_us);
+
+    optimizer.run_us = now_us;
+}
+
+void EVERT_CCU_DISPATCH_Init(void)
+{
+    EVERT_CCU_OPTIMIZER_LimitsTypeDef limits = {
+        .export_limit = EVERT_SETTING_CCU_OPTIMIZER_EXPORT_LIMIT,
+        .inverter_power_max = EVERT_SETTING_CCU_OPTIMIZER_INVERTER_POWER_MAX,
+    };
+
+    memset(setpoints, 0, sizeof(setpoints));
+    memset(&optimizer, 0, sizeof(optimizer));
+    EVERT_CCU_OPTIMIZER_Init(&optimizer.state, &limits);
+
+    for (uint32_t i = 0; i < EVERT_CONSTANT_CCU_DEVICE_COUNT; i++)
+    {
+        setpoints[i].power = NAN;
+        optimizer.sent[i] = EVERT_CCU_BATCH_UNCHANGED;
+    }
+}
+
+/// @brief Plant-level dispatch on or off, off the setpoints are sent again as plain limits
+void EVERT_CCU_DISPATCH_SetOptimizer(const bool enabled)
+{
+    if (enabled == optimizer.enabled)
+    {
+        return;
+    }
+
+    optimizer.enabled = enabled;
+
+    for (uint32_t i = 0; i < EVERT_CONSTANT_CCU_DEVICE_COUNT; i++)
+    {
+        setpoints[i].dirty = true;
+        optimizer.sent[i] = EVERT_CCU_BATCH_UNCHANGED;
+    }
+}
+
+/// @brief Export limit at the grid connection in W AC, < 0 or NAN = none
+void EVERT_CCU_DISPATCH_SetExportLimit(const float power)
+{
+    optimizer.state.limits.export_limit = isnan(power) ? -1.0f : power;
+}
+
+/// @brief State of the last optimizer run, NULL with the optimizer off
+const EVERT_CCU_OPTIMIZER_StateTypeDef *EVERT_CCU_DISPATCH_GetOptimizer(void)
+{
+    return optimizer.enabled ? &optimizer.state : NULL;
+}
+
+void EVERT_CCU_DISPATCH_Print(FILE *file)
+{
+    if (!optimizer.enabled)
+    {
+        fprintf(file, "CCU: optimizer off\n");
+        return;
+    }
+
+    const EVERT_CCU_OPTIMIZER_StateTypeDef *state = &optimizer.state;
+
+    fprintf(file, "CCU: optimizer %s, available %.0f W, target %.0f W, bus %.1f V, trim %.0f W, export limit %.0f W, %" PRIu64 " batches\n",
+            state->constrained ? "curtailing" : "released", state->available, state->target, state->bus_voltage, state->bus_trim,
+            state->limits.export_limit, optimizer.batch_count);
+}
+
+void EVERT_CCU_DISPATCH_SetPowerSetpoint(const uint8_t device_id, const float power)
+{
+    if (device_id >= EVERT_CONSTANT_CCU_DEVICE_COUNT)
+    {
+        return;
+    }
+
+    EVERT_CCU_DISPATCH_SetpointTypeDef *setpoint = &setpoints[device_id];
+    bool changed = !setpoint->set || (isnan(power) != isnan(setpoint->power)) || (!isnan(power) && power != setpoint->power);
+
+    setpoint->power = power;
+    setpoint->set = true;
+    setpoint->dirty |= changed;
+}
+
+float EVERT_CCU_DISPATCH_GetPowerSetpoint(const uint8_t device_id)
+{
+    return device_id < EVERT_CONSTANT_CCU_DEVICE_COUNT ? setpoints[device_id].power : NAN;
+}
+
+/// @brief Send the changed and the due setpoints, call from the worker tick
+void EVERT_CCU_DISPATCH_Process(const uint64_t now_us)
+{
+    for (uint8_t id = 1; id < EVERT_CONSTANT_CCU_DEVICE_COUNT; id++)
+    {
+        EVERT_CCU_DISPATCH_SetpointTypeDef *setpoint = &setpoints[id];
+        bool ready = EVERT_CCU_DEVICES_IsReady(id);
+
+        // Back from a handshake, the device starts from its defaults
+        setpoint->dirty |= ready && !setpoint->ready;
+        setpoint->ready = ready;
+
+        if (!setpoint->set || !ready)
+        {
+            continue;
+        }
+
+        if (!setpoint->dirty && now_us - setpoint->sent_us < (uint64_t)EVERT_SETTING_CCU_DISPATCH_REFRESH_MS * 1000u)
+        {
+            continue;
+        }
+
+        EVERT_CCU_DISPATCH_SendSetpoint(id, setpoint);
+        EVERT_CCU_TELEMETRY_Record(id, CTS_SETPOINT, 0, now_us, setpoint->power);
+
+        setpoint->dirty = false;
+        setpoint->sent_us = now_us;
+        setpoint->sent_count++;
+    }
+
+    if (optimizer.enabled)
+    {
+        EVERT_CCU_DISPATCH_Optimize(now_us);
+    }
+}
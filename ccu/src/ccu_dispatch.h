@@ -0,0 +1,46 @@
+/**
+ ******************************************************************************
+ * @file    ccu_dispatch.h
+ * @author  Evert Firmware Team
+ * @brief   Power setpoint dispatch from the CCU to the devices
+ *          * Setpoint per device in W: > 0 runs the device limited to it, 0 stops it, NAN releases it
+ *            (unlimited, the device runs on its own, e.g. MPPT only)
+ *          * Sent on change and refreshed every EVERT_SETTING_CCU_DISPATCH_REFRESH_MS, only to devices past the
+ *            handshake; a device coming back gets its setpoint again right away
+ *          * Boost converter: BCCM_SET_RUNNING + BCCM_POWER_LIMIT, inverter: BCCM_POWER_LIMIT
+ *          * Optimizer (ccu_optimizer.h) on: the boost converter limits come from the plant-level dispatch every
+ *            EVERT_SETTING_CCU_OPTIMIZER_PERIOD_MS, broadcast as BCCM_POWER_LIMIT_BATCH on change and refreshed;
+ *            the setpoints above cap the strings then, 0 still stops a converter
+ *          * Worker thread only
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_CCU_DISPATCH_H_
+#define EVERT_CCU_DISPATCH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "_conf_evert_ccu.h"
+#include "ccu_optimizer.h"
+
+typedef struct
+{
+    float power;       // W, NAN = released
+    bool set;          // A setpoint was ever given
+    bool dirty;        // Changed since the last send
+    bool ready;        // Device ready at the last pass
+    uint64_t sent_us;  // Last send
+    uint32_t sent_count;
+} EVERT_CCU_DISPATCH_SetpointTypeDef;
+
+void EVERT_CCU_DISPATCH_Init(void);
+void EVERT_CCU_DISPATCH_SetPowerSetpoint(const uint8_t device_id, const float power);
+float EVERT_CCU_DISPATCH_GetPowerSetpoint(const uint8_t device_id);
+void EVERT_CCU_DISPATCH_Process(const uint64_t now_us);
+void EVERT_CCU_DISPATCH_SetOptimizer(const bool enabled);
+void EVERT_CCU_DISPATCH_SetExportLimit(const float power);
+const EVERT_CCU_OPTIMIZER_StateTypeDef *EVERT_CCU_DISPATCH_GetOptimizer(void);
+void EVERT_CCU_DISPATCH_Print(FILE *file);
+
+#endif // EVERT_CCU_DISPATCH_H_
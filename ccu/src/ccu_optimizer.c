@@ -0,0 +1,169 @@
+/**
+ ******************************************************************************
+ * @file    ccu_optimizer.c
+ * @author  Evert Firmware Team
+ * @brief   Plant-level power dispatch: curtailment and setpoints for the strings (boost converters)
+ *
+ ******************************************************************************
+ **/
+
+#include <math.h>
+#include <string.h>
+#include "ccu_optimizer.h"
+
+void EVERT_CCU_OPTIMIZER_Init(EVERT_CCU_OPTIMIZER_StateTypeDef *state, const EVERT_CCU_OPTIMIZER_LimitsTypeDef *limits)
+{
+    memset(state, 0, sizeof(*state));
+    state->limits = *limits;
+
+    for (uint32_t i = 0; i < EVERT_CONSTANT_CCU_DEVICE_COUNT; i++)
+    {
+        state->setpoints[i] = NAN;
+    }
+}
+
+/// @brief DC power the inverter may take: its rating and the export limit, through its efficiency
+static float EVERT_CCU_OPTIMIZER_PowerCap(const EVERT_CCU_OPTIMIZER_LimitsTypeDef *limits)
+{
+    float cap = limits->inverter_power_max;
+
+    if (limits->export_limit >= 0.0f && limits->export_limit < cap)
+    {
+        cap = limits->export_limit;
+    }
+
+    return cap / EVERT_SETTING_CCU_OPTIMIZER_INVERTER_EFFICIENCY;
+}
+
+/// @brief Power a string can give this period
+/// @param below Time the string is below its setpoint band, updated
+/// @param held Set when the string sits at its setpoint or climbs to it, its real available power is unknown then
+/// @param limited Set when the string has a bound of its own (warning, operator cap)
+static float EVERT_CCU_OPTIMIZER_Available(const EVERT_CCU_OPTIMIZER_StringTypeDef *string, const float setpoint, float *below, const float dt, bool *held, bool *limited)
+{
+    float available = fmaxf(string->available, string->power);
+    bool at_setpoint = !isnan(setpoint) && string->power >= setpoint * (1.0f - EVERT_SETTING_CCU_OPTIMIZER_SETPOINT_BAND);
+
+    // Held at its setpoint the string may have more, probe above it so the allocation can grow
+    if (at_setpoint)
+    {
+        available = fmaxf(available, setpoint * (1.0f + EVERT_SETTING_CCU_OPTIMIZER_PROBE));
+    }
+    // Below it the string keeps the probe over its power: its tracker climbs to a new setpoint in steps, the reported
+    // power would take the setpoint back down every period
+    else if (!isnan(setpoint))
+    {
+        available = fmaxf(available, fminf(setpoint, string->power * (1.0f + EVERT_SETTING_CCU_OPTIMIZER_PROBE)));
+    }
+
+    // Climbing the string counts as held until it had the time, then it is at its maximum
+    *below = (at_setpoint || isnan(setpoint)) ? 0.0f : *below + dt;
+    *held = at_setpoint || (!isnan(setpoint) && *below < EVERT_SETTING_CCU_OPTIMIZER_PROBE_TIME);
+
+    *limited = false;
+
+    // Back off from the own power as long as the warning lasts, like the local throttling did
+    if (string->warning)
+    {
+        available = fminf(available, string->power - EVERT_SETTING_CCU_OPTIMIZER_WARNING_BACKOFF * dt);
+        *limited = true;
+    }
+
+    if (!isnan(string->cap))
+    {
+        available = fminf(available, string->cap);
+        *limited = true;
+    }
+
+    return fmaxf(available, 0.0f);
+}
+
+/// @brief Compute the setpoints for one period
+/// @param strings EVERT_CONSTANT_CCU_DEVICE_COUNT entries, slot = device id
+/// @param dt Time since the last run (s)
+void EVERT_CCU_OPTIMIZER_Run(EVERT_CCU_OPTIMIZER_StateTypeDef *state, const EVERT_CCU_OPTIMIZER_StringTypeDef *strings, const float dt)
+{
+    float available[EVERT_CONSTANT_CCU_DEVICE_COUNT] = {0};
+    bool limited[EVERT_CONSTANT_CCU_DEVICE_COUNT] = {false};
+    bool any_held = false;
+
+    state->available = 0.0f;
+    state->bus_voltage = 0.0f;
+
+    for (uint32_t i = 0; i < EVERT_CONSTANT_CCU_DEVICE_COUNT; i++)
+    {
+        if (!strings[i].present)
+        {
+            state->setpoints[i] = NAN;
+            state->below[i] = 0.0f;
+            continue;
+        }
+
+        bool held;
+        available[i] = EVERT_CCU_OPTIMIZER_Available(&strings[i], state->setpoints[i], &state->below[i], dt, &held, &limited[i]);
+        any_held |= held;
+        state->available += available[i];
+        state->bus_voltage = fmaxf(state->bus_voltage, strings[i].bus_voltage);
+    }
+
+    // Bus loop: the inverter holds the bus at nominal, above the high threshold it cannot take the power
+    float bus_error = state->bus_voltage - EVERT_SETTING_CCU_OPTIMIZER_BUS_VOLTAGE_HIGH;
+
+    if (bus_error > 0.0f)
+    {
+        state->bus_trim += EVERT_SETTING_CCU_OPTIMIZER_BUS_KI * bus_error * dt;
+    }
+    else
+    {
+        state->bus_trim -= EVERT_SETTING_CCU_OPTIMIZER_BUS_TRIM_RELEASE * dt;
+    }
+
+    state->bus_trim = fminf(fmaxf(state->bus_trim, 0.0f), state->available);
+
+    float cap = EVERT_CCU_OPTIMIZER_PowerCap(&state->limits);
+
+    float target = fmaxf(fminf(state->available, cap) - state->bus_trim, 0.0f);
+
+    // Down at once (export, bus), up ramped so the inverter follows
+    if (state->constrained)
+    {
+        target = fminf(target, state->target + EVERT_SETTING_CCU_OPTIMIZER_RAMP * dt);
+    }
+
+    // Within the margin below the cap the strings stay limited at their available power, so a rising
+    // irradiance cannot overshoot the cap before the next period; strings held at their setpoints are
+    // probed up to their real power before the plant is released
+    state->constrained = state->bus_trim > 0.0f || state->available > cap * (1.0f - EVERT_SETTING_CCU_OPTIMIZER_RELEASE_MARGIN) ||
+                         (state->constrained && any_held);
+    state->target = target;
+
+    float ratio = state->available > 0.0f ? fminf(state->target / state->available, 1.0f) : 0.0f;
+
+    for (uint32_t i = 0; i < EVERT_CONSTANT_CCU_DEVICE_COUNT; i++)
+    {
+        if (!strings[i].present)
+        {
+            continue;
+        }
+
+        if (!state->constrained && !limited[i])
+        {
+            state->setpoints[i] = NAN;
+            continue;
+        }
+
+        float setpoint = state->constrained ? available[i] * ratio : available[i];
+
+        // Down at once (export, bus), up ramped from where the string is
+        float previous = isnan(state->setpoints[i]) ? strings[i].power : state->setpoints[i];
+
+        if (setpoint > previous)
+        {
+            setpoint = fminf(setpoint, previous + EVERT_SETTING_CCU_OPTIMIZER_RAMP * dt);
+        }
+
+        state->setpoints[i] = fmaxf(setpoint, 0.0f);
+    }
+
+    state->run_count++;
+}
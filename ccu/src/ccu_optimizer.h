@@ -0,0 +1,62 @@
+/**
+ ******************************************************************************
+ * @file    ccu_optimizer.h
+ * @author  Evert Firmware Team
+ * @brief   Plant-level power dispatch: curtailment and setpoints for the strings (boost converters)
+ *          * Inputs: per string the power, the available power and the bus voltage (BCCM_POWER_REPORT), the
+ *            warning state; for the plant the export limit and the inverter rating
+ *          * Target: the available power capped by the export limit and the inverter (AC, through the
+ *            inverter efficiency), less the bus trim: an integrator on the bus voltage above
+ *            EVERT_SETTING_CCU_OPTIMIZER_BUS_VOLTAGE_HIGH for when the inverter cannot take the power
+ *          * Allocation: the same curtailment ratio for every string, warnings derate their string and the others
+ *            take over; the target and the setpoints fall at once and rise ramped; strings held at their setpoints
+ *            are probed above them, a probe stands EVERT_SETTING_CCU_OPTIMIZER_PROBE_TIME for the string to climb to
+ *            it; with headroom and none held the strings are released (MPPT only)
+ *          * Pure computation, no I/O: driven by ccu_dispatch.c at EVERT_SETTING_CCU_OPTIMIZER_PERIOD_MS and by
+ *            the plant simulation (sim/ccu_sim.c)
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_CCU_OPTIMIZER_H_
+#define EVERT_CCU_OPTIMIZER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "_conf_evert_ccu.h"
+
+/// @brief One string as seen by the optimizer, slot = device id
+typedef struct
+{
+    bool present;      // Boost converter ready with a fresh report, otherwise ignored and released
+    bool warning;      // DS_OPERATIONAL_WARNING: derated instead of throttling locally
+    float power;       // W, input power
+    float available;   // W, input power without the limit (estimate of the device)
+    float bus_voltage; // V, output voltage
+    float cap;         // W, upper bound of the operator (manual setpoint), NAN = none
+} EVERT_CCU_OPTIMIZER_StringTypeDef;
+
+typedef struct
+{
+    float export_limit;       // W AC, < 0 = none
+    float inverter_power_max; // W AC
+} EVERT_CCU_OPTIMIZER_LimitsTypeDef;
+
+typedef struct
+{
+    EVERT_CCU_OPTIMIZER_LimitsTypeDef limits;
+    float setpoints[EVERT_CONSTANT_CCU_DEVICE_COUNT]; // W, NAN = released
+    float below[EVERT_CONSTANT_CCU_DEVICE_COUNT];     // s, string below its setpoint band
+
+    // Last run
+    bool constrained;  // Curtailing, the setpoints hold the strings below their available power
+    float available;   // W DC, sum over the present strings
+    float target;      // W DC
+    float bus_voltage; // V, highest of the strings
+    float bus_trim;    // W DC taken off the target by the bus loop
+    uint64_t run_count;
+} EVERT_CCU_OPTIMIZER_StateTypeDef;
+
+void EVERT_CCU_OPTIMIZER_Init(EVERT_CCU_OPTIMIZER_StateTypeDef *state, const EVERT_CCU_OPTIMIZER_LimitsTypeDef *limits);
+void EVERT_CCU_OPTIMIZER_Run(EVERT_CCU_OPTIMIZER_StateTypeDef *state, const EVERT_CCU_OPTIMIZER_StringTypeDef *strings, const float dt);
+
+#endif // EVERT_CCU_OPTIMIZER_H_
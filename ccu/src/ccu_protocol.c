@@ -0,0 +1,165 @@
+/**
+ ******************************************************************************
+ * @file    ccu_protocol.c
+ * @author  Evert Firmware Team
+ * @brief   Evert CAN protocol on the host side
+ *
+ ******************************************************************************
+ **/
+
+#include <string.h>
+#include "_conf_evert_ccu.h"
+#include "ccu_protocol.h"
+
+static void EVERT_CCU_PROTOCOL_AppendBits(uint8_t *bits, uint32_t *count, const uint32_t value, const uint32_t width)
+{
+    for (uint32_t i = width; i > 0; i--)
+    {
+        bits[(*count)++] = (value >> (i - 1)) & 1u;
+    }
+}
+
+/// @brief Bits on the wire of a classic frame: SOF to CRC with the stuff bits, then the fixed tail
+uint32_t EVERT_CCU_PROTOCOL_FrameBits(const struct can_frame *frame)
+{
+    uint8_t bits[160];
+    uint32_t count = 0;
+    uint32_t rtr = (frame->can_id & CAN_RTR_FLAG) != 0;
+    uint32_t length = frame->len > CAN_MAX_DLEN ? CAN_MAX_DLEN : frame->len;
+
+    EVERT_CCU_PROTOCOL_AppendBits(bits, &count, 0, 1); // SOF
+
+    if (frame->can_id & CAN_EFF_FLAG)
+    {
+        uint32_t id = frame->can_id & CAN_EFF_MASK;
+        EVERT_CCU_PROTOCOL_AppendBits(bits, &count, id >> 18, 11);
+        EVERT_CCU_PROTOCOL_AppendBits(bits, &count, 3, 2); // SRR, IDE
+        EVERT_CCU_PROTOCOL_AppendBits(bits, &count, id & 0x3FFFFu, 18);
+        EVERT_CCU_PROTOCOL_AppendBits(bits, &count, rtr, 1);
+        EVERT_CCU_PROTOCOL_AppendBits(bits, &count, 0, 2); // r1, r0
+    }
+    else
+    {
+        EVERT_CCU_PROTOCOL_AppendBits(bits, &count, frame->can_id & CAN_SFF_MASK, 11);
+        EVERT_CCU_PROTOCOL_AppendBits(bits, &count, rtr, 1);
+        EVERT_CCU_PROTOCOL_AppendBits(bits, &count, 0, 2); // IDE, r0
+    }
+
+    EVERT_CCU_PROTOCOL_AppendBits(bits, &count, length, 4);
+
+    for (uint32_t i = 0; i < length && !rtr; i++)
+    {
+        EVERT_CCU_PROTOCOL_AppendBits(bits, &count, frame->data[i], 8);
+    }
+
+    // CRC-15 over SOF to the end of the data field
+    uint32_t crc = 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t next = bits[i] ^ ((crc >> 14) & 1u);
+        crc = (crc << 1) & 0x7FFFu;
+
+        if (next)
+        {
+            crc ^= 0x4599u;
+        }
+    }
+
+    EVERT_CCU_PROTOCOL_AppendBits(bits, &count, crc, 15);
+
+    // A stuff bit after five equal bits, it counts towards the next run
+    uint32_t stuffed = 0;
+    uint32_t run = 0;
+    uint8_t last = 2;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        run = bits[i] == last ? run + 1 : 1;
+        last = bits[i];
+
+        if (run == 5)
+        {
+            stuffed++;
+            last ^= 1u;
+            run = 1;
+        }
+    }
+
+    return count + stuffed + EVERT_CCU_PROTOCOL_TAIL_BITS;
+}
+
+uint32_t EVERT_CCU_PROTOCOL_IdentifierToUint32(const EVERT_CCU_IdentifierTypeDef *identifier)
+{
+    return (identifier->message_id & 0xFFu)           // Bits 0 - 7
+           | ((identifier->source_id & 0x0Fu) << 8)   // Bits 8 - 11
+           | ((identifier->target_id & 0x0Fu) << 12)  // Bits 12 - 15
+           | ((EVERT_CCU_PROTOCOL_FLAG & 0x0Fu) << 16) // Bits 16 - 19
+           | ((identifier->priority & 0x0Fu) << 20);  // Bits 20 - 23
+}
+
+/// @return false for ids of other protocols on the same bus
+bool EVERT_CCU_PROTOCOL_IdentifierFromUint32(const uint32_t id, EVERT_CCU_IdentifierTypeDef *identifier)
+{
+    if (((id >> 16) & 0x0Fu) != EVERT_CCU_PROTOCOL_FLAG || (id >> 24) != 0)
+    {
+        return false;
+    }
+
+    identifier->message_id = id & 0xFFu;
+    identifier->source_id = (id >> 8) & 0x0Fu;
+    identifier->target_id = (id >> 12) & 0x0Fu;
+    identifier->priority = (id >> 20) & 0x0Fu;
+
+    return true;
+}
+
+/// @brief SocketCAN frame to an Evert frame, false if it is not one
+bool EVERT_CCU_PROTOCOL_Decode(const struct can_frame *can, EVERT_CCU_FrameTypeDef *frame)
+{
+    if ((can->can_id & CAN_EFF_FLAG) == 0 || (can->can_id & (CAN_RTR_FLAG | CAN_ERR_FLAG)) != 0 || can->len < 1)
+    {
+        return false;
+    }
+
+    if (!EVERT_CCU_PROTOCOL_IdentifierFromUint32(can->can_id & CAN_EFF_MASK, &frame->identifier))
+    {
+        return false;
+    }
+
+    // [0] length, never beyond what the frame carried
+    uint8_t length = can->data[0];
+
+    if (length > EVERT_CCU_PROTOCOL_DATA_MAX || length > can->len - 1)
+    {
+        return false;
+    }
+
+    frame->length = length;
+    memset(frame->data, 0, sizeof(frame->data));
+    memcpy(frame->data, &can->data[1], length);
+
+    return true;
+}
+
+void EVERT_CCU_PROTOCOL_Encode(const EVERT_CCU_FrameTypeDef *frame, struct can_frame *can)
+{
+    memset(can, 0, sizeof(*can));
+
+    can->can_id = EVERT_CCU_PROTOCOL_IdentifierToUint32(&frame->identifier) | CAN_EFF_FLAG;
+    can->len = 8; // The devices send FDCAN_DLC_BYTES_8
+    can->data[0] = frame->length;
+    memcpy(&can->data[1], frame->data, frame->length);
+}
+
+/// @brief Frame from the CCU to a device (or EVERT_CCU_PROTOCOL_BROADCAST)
+void EVERT_CCU_PROTOCOL_Create(EVERT_CCU_FrameTypeDef *frame, const uint8_t target_id, const EVERT_CCU_PriorityTypeDef priority, const uint8_t length, const uint8_t *data)
+{
+    memset(frame, 0, sizeof(*frame));
+
+    frame->identifier.source_id = EVERT_CONSTANT_CCU_DEVICE_ID;
+    frame->identifier.target_id = target_id;
+    frame->identifier.priority = priority;
+    frame->length = length > EVERT_CCU_PROTOCOL_DATA_MAX ? EVERT_CCU_PROTOCOL_DATA_MAX : length;
+    memcpy(frame->data, data, frame->length);
+}
@@ -0,0 +1,149 @@
+/**
+ ******************************************************************************
+ * @file    ccu_protocol.h
+ * @author  Evert Firmware Team
+ * @brief   Evert CAN protocol on the host side
+ *          * Identifier: 29 bit extended id, 24 bits used (libs/core/src/can_handler.h)
+ *            [0..7] message id, [8..11] source, [12..15] target, [16..19] 0xE, [20..23] priority
+ *          * Payload: classic CAN, 8 bytes, [0] length (0..7) followed by the data
+ *          * Data: [0] method, the rest per method (boost_converter_protocol.h)
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_CCU_PROTOCOL_H_
+#define EVERT_CCU_PROTOCOL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <linux/can.h>
+#include "evert_device_state.h"
+
+#define EVERT_CCU_PROTOCOL_FLAG (0xE)
+#define EVERT_CCU_PROTOCOL_DATA_MAX (7)
+#define EVERT_CCU_PROTOCOL_BROADCAST (0) // Target id every device accepts
+#define EVERT_CCU_PROTOCOL_TAIL_BITS (13) // CRC delimiter, ACK slot and delimiter, EOF 7, intermission 3
+#define EVERT_CCU_PROTOCOL_INTERMISSION_BITS (3)
+
+/// @brief Device ids, mirrors EVERT_CAN_DeviceIdentifierTypeDef (can_handler.h)
+typedef enum
+{
+    CDI_UNIDENTIFIED = 0,
+    CDI_BOOST_CONVERTER1 = 1,
+    CDI_BOOST_CONVERTER2 = 2,
+    CDI_INVERTER = 3,
+    CDI_CCU = 15
+} EVERT_CCU_DeviceIdTypeDef;
+
+/// @brief Mirrors EVERT_CAN_MessagePriorityTypeDef (can_handler.h)
+typedef enum
+{
+    CMP_CRITICAL = 0,
+    CMP_HIGH = 1,
+    CMP_NORMAL = 2,
+    CMP_LOW = 3
+} EVERT_CCU_PriorityTypeDef;
+
+/// @brief Boost converter methods, mirrors EVERT_BOOST_CONVERTER_CanMethodTypeDef (boost_converter_protocol.h)
+/// @details The device state methods are common to every device
+typedef enum
+{
+    BCCM_PING = 0, // Empty frame of the ping task
+    BCCM_SET_RUNNING = 1,
+    BCCM_INTERLEAVE_CONFIG = 2,
+    BCCM_CURRENT_SHARE = 3,
+    BCCM_PARAM_READ = 4,
+    BCCM_PARAM_WRITE = 5,
+    BCCM_PARAM_ERASE = 6,
+    BCCM_PARAM_VALUE = 7,
+    BCCM_VAR_READ = 8,
+    BCCM_VAR_WRITE = 9,
+    BCCM_VAR_SUBSCRIBE = 10,
+    BCCM_VAR_LIST = 11,
+    BCCM_VAR_VALUE = 12,
+    BCCM_VAR_STATUS = 13,
+    BCCM_VAR_ENTRY = 14,
+    BCCM_VAR_STREAM = 15,
+    BCCM_FAULT_READ = 16,
+    BCCM_FAULT_SUMMARY = 17,
+    BCCM_FAULT_CHUNK = 18,
+    BCCM_DEVICE_STATE = 19,
+    BCCM_DEVICE_ACK = 20,
+    BCCM_DEVICE_HEARTBEAT = 21,
+    BCCM_DEVICE_RESET = 22,
+    BCCM_POWER_LIMIT = 23,
+    BCCM_POWER_LIMIT_BATCH = 24, // Broadcast, message id = group of three devices (EVERT_CCU_BATCH_*)
+    BCCM_POWER_REPORT = 25,
+    BCCM_TIME_SYNC = 26,     // Broadcast, message id = sequence (ccu_timesync.h)
+    BCCM_TIME_FOLLOW_UP = 27, // Broadcast, message id = sequence of the SYNC
+    BCCM_TELEMETRY_LIST = 28,
+    BCCM_TELEMETRY_SIGNAL = 29, // Message id = index in the table (ccu_delta_telemetry.h)
+    BCCM_TELEMETRY_FRAME = 30,  // Message id = sequence
+    BCCM_UPDATE_BEGIN = 31,     // [1..4] application bytes (ccu_update.h)
+    BCCM_UPDATE_DATA = 32,      // Message id = block index bits 0-7, [1..6] stream bytes
+    BCCM_UPDATE_STATUS = 33,    // Message id 1: gap in the blocks, [1] state, [2] result, [3..6] stream bytes taken
+    BCCM_UPDATE_END = 34,
+    BCCM_UPDATE_ACTIVATE = 35
+} EVERT_CCU_MethodTypeDef;
+
+/// @brief BCCM_UPDATE_STATUS [1], mirrors EVERT_FIRMWARE_UPDATE_StateTypeDef (firmware_update.h)
+typedef enum
+{
+    CUS_IDLE = 0,
+    CUS_ERASING = 1,
+    CUS_RECEIVING = 2,
+    CUS_VERIFYING = 3,
+    CUS_READY = 4,
+    CUS_FAILED = 5
+} EVERT_CCU_UpdateStateTypeDef;
+
+/// @brief BCCM_UPDATE_STATUS [2], mirrors EVERT_FIRMWARE_UPDATE_ResultTypeDef (firmware_update.h)
+typedef enum
+{
+    CUR_OK = 0,
+    CUR_STATE = 1,
+    CUR_UNSUPPORTED = 2,
+    CUR_SIZE = 3,
+    CUR_HEADER = 4,
+    CUR_SEQUENCE = 5,
+    CUR_FLASH = 6,
+    CUR_CRC = 7,
+    CUR_REFUSED = 8
+} EVERT_CCU_UpdateResultTypeDef;
+
+// BCCM_TIME_FOLLOW_UP: [1..6] CCU time of the start of frame of the SYNC in us (48 bits, little endian)
+#define EVERT_CCU_TIME_FOLLOW_UP_LENGTH (7)
+
+// BCCM_POWER_LIMIT_BATCH: [1..6] limits in W (uint16) of the devices 3 * message id + 1..3
+#define EVERT_CCU_BATCH_GROUP_SIZE (3)
+#define EVERT_CCU_BATCH_UNLIMITED (0xFFFFu)
+#define EVERT_CCU_BATCH_UNCHANGED (0xFFFEu)
+#define EVERT_CCU_BATCH_LIMIT_MAX (0xFFFDu)
+
+// BCCM_UPDATE_STATUS: message id of a gap report, the bytes taken are where the stream goes on
+#define EVERT_CCU_UPDATE_STATUS_GAP (1)
+
+typedef struct
+{
+    uint8_t message_id;
+    uint8_t source_id;
+    uint8_t target_id;
+    uint8_t priority;
+} EVERT_CCU_IdentifierTypeDef;
+
+/// @brief Decoded frame, timestamped on reception (monotonic)
+typedef struct
+{
+    EVERT_CCU_IdentifierTypeDef identifier;
+    uint8_t length;
+    uint8_t data[EVERT_CCU_PROTOCOL_DATA_MAX];
+    uint64_t timestamp_us;
+} EVERT_CCU_FrameTypeDef;
+
+uint32_t EVERT_CCU_PROTOCOL_FrameBits(const struct can_frame *frame);
+uint32_t EVERT_CCU_PROTOCOL_IdentifierToUint32(const EVERT_CCU_IdentifierTypeDef *identifier);
+bool EVERT_CCU_PROTOCOL_IdentifierFromUint32(const uint32_t id, EVERT_CCU_IdentifierTypeDef *identifier);
+bool EVERT_CCU_PROTOCOL_Decode(const struct can_frame *can, EVERT_CCU_FrameTypeDef *frame);
+void EVERT_CCU_PROTOCOL_Encode(const EVERT_CCU_FrameTypeDef *frame, struct can_frame *can);
+void EVERT_CCU_PROTOCOL_Create(EVERT_CCU_FrameTypeDef *frame, const uint8_t target_id, const EVERT_CCU_PriorityTypeDef priority, const uint8_t length, const uint8_t *data);
+
+#endif // EVERT_CCU_PROTOCOL_H_
@@ -0,0 +1,92 @@
+/**
+ ******************************************************************************
+ * @file    ccu_queue.h
+ * @author  Evert Firmware Team
+ * @brief   Lock-free single producer/single consumer frame queue between the CCU threads
+ *          * Head written by the producer only, tail by the consumer only (C11 atomics, acquire/release)
+ *          * Power of 2 size, the indices run freely and wrap with the mask
+ *          * Full: the frame is dropped and counted, the producer never waits
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_CCU_QUEUE_H_
+#define EVERT_CCU_QUEUE_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "_conf_evert_ccu.h"
+#include "ccu_protocol.h"
+
+_Static_assert((EVERT_CONSTANT_CCU_QUEUE_SIZE & (EVERT_CONSTANT_CCU_QUEUE_SIZE - 1)) == 0, "EVERT_CONSTANT_CCU_QUEUE_SIZE must be a power of 2");
+
+typedef struct
+{
+    // Producer and consumer indices on their own cache lines
+    _Alignas(64) atomic_uint_fast32_t head;
+    _Alignas(64) atomic_uint_fast32_t tail;
+    _Alignas(64) atomic_uint_fast32_t drop_count;
+    EVERT_CCU_FrameTypeDef frames[EVERT_CONSTANT_CCU_QUEUE_SIZE];
+} EVERT_CCU_QueueTypeDef;
+
+static inline void EVERT_CCU_QUEUE_Init(EVERT_CCU_QueueTypeDef *queue)
+{
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    atomic_init(&queue->drop_count, 0);
+}
+
+/// @brief Producer side
+/// @return false if full (dropped)
+static inline bool EVERT_CCU_QUEUE_Push(EVERT_CCU_QueueTypeDef *queue, const EVERT_CCU_FrameTypeDef *frame)
+{
+    uint_fast32_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    uint_fast32_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+
+    if (head - tail >= EVERT_CONSTANT_CCU_QUEUE_SIZE)
+    {
+        atomic_fetch_add_explicit(&queue->drop_count, 1, memory_order_relaxed);
+        return false;
+    }
+
+    queue->frames[head & (EVERT_CONSTANT_CCU_QUEUE_SIZE - 1)] = *frame;
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+
+    return true;
+}
+
+/// @brief Consumer side
+/// @return false if empty
+static inline bool EVERT_CCU_QUEUE_Pop(EVERT_CCU_QueueTypeDef *queue, EVERT_CCU_FrameTypeDef *frame)
+{
+    uint_fast32_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    uint_fast32_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+
+    if (tail == head)
+    {
+        return false;
+    }
+
+    *frame = queue->frames[tail & (EVERT_CONSTANT_CCU_QUEUE_SIZE - 1)];
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+
+    return true;
+}
+
+/// @brief Consumer side, the frame at the tail without removing it
+static inline const EVERT_CCU_FrameTypeDef *EVERT_CCU_QUEUE_Peek(EVERT_CCU_QueueTypeDef *queue)
+{
+    uint_fast32_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    uint_fast32_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+
+    return tail == head ? NULL : &queue->frames[tail & (EVERT_CONSTANT_CCU_QUEUE_SIZE - 1)];
+}
+
+/// @brief Consumer side, drop the frame returned by EVERT_CCU_QUEUE_Peek
+static inline void EVERT_CCU_QUEUE_Consume(EVERT_CCU_QueueTypeDef *queue)
+{
+    atomic_fetch_add_explicit(&queue->tail, 1, memory_order_release);
+}
+
+#endif // EVERT_CCU_QUEUE_H_
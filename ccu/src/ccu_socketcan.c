@@ -0,0 +1,181 @@
+/**
+ ******************************************************************************
+ * @file    ccu_socketcan.c
+ * @author  Evert Firmware Team
+ * @brief   Raw SocketCAN socket for the CCU
+ *
+ ******************************************************************************
+ **/
+
+#include <errno.h>
+#include <net/if.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/can/raw.h>
+#include "ccu_socketcan.h"
+
+/// @brief Monotonic time in microseconds
+uint64_t EVERT_CCU_GetTimeUs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000u + (uint64_t)now.tv_nsec / 1000u;
+}
+
+bool EVERT_CCU_SOCKETCAN_Open(EVERT_CCU_SOCKETCAN_HandlerTypeDef *socketcan, const char *interface)
+{
+    memset(socketcan, 0, sizeof(*socketcan));
+
+    socketcan->fd = socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, CAN_RAW);
+
+    if (socketcan->fd < 0)
+    {
+        perror("CCU: socket");
+        return false;
+    }
+
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    snprintf(ifr.ifr_name, sizeof(ifr.ifr_name), "%s", interface);
+
+    if (ioctl(socketcan->fd, SIOCGIFINDEX, &ifr) < 0)
+    {
+        fprintf(stderr, "CCU: no CAN interface %s: %s\n", interface, strerror(errno));
+        EVERT_CCU_SOCKETCAN_Close(socketcan);
+        return false;
+    }
+
+    // Extended frames with the Evert flag, the kernel drops the rest
+    struct can_filter filter = {
+        .can_id = CAN_EFF_FLAG | ((uint32_t)EVERT_CCU_PROTOCOL_FLAG << 16),
+        .can_mask = CAN_EFF_FLAG | CAN_RTR_FLAG | (0xFFu << 24) | (0x0Fu << 16)};
+    setsockopt(socketcan->fd, SOL_CAN_RAW, CAN_RAW_FILTER, &filter, sizeof(filter));
+
+    // Own frames come back once they are through (MSG_CONFIRM), the time sync master needs the SYNC
+    int recv_own = 1;
+    setsockopt(socketcan->fd, SOL_CAN_RAW, CAN_RAW_RECV_OWN_MSGS, &recv_own, sizeof(recv_own));
+
+    // Kernel receive timestamps, not delayed by the I/O thread
+    int timestamp = 1;
+    setsockopt(socketcan->fd, SOL_SOCKET, SO_TIMESTAMPNS, &timestamp, sizeof(timestamp));
+
+    struct sockaddr_can address;
+    memset(&address, 0, sizeof(address));
+    address.can_family = AF_CAN;
+    address.can_ifindex = ifr.ifr_ifindex;
+
+    if (bind(socketcan->fd, (struct sockaddr *)&address, sizeof(address)) < 0)
+    {
+        perror("CCU: bind");
+        EVERT_CCU_SOCKETCAN_Close(socketcan);
+        return false;
+    }
+
+    return true;
+}
+
+void EVERT_CCU_SOCKETCAN_Close(EVERT_CCU_SOCKETCAN_HandlerTypeDef *socketcan)
+{
+    if (socketcan->fd >= 0)
+    {
+        close(socketcan->fd);
+    }
+
+    socketcan->fd = -1;
+}
+
+/// @brief Kernel timestamp (CLOCK_REALTIME) to monotonic time, by its age; now without one
+static uint64_t EVERT_CCU_SOCKETCAN_Timestamp(const struct msghdr *message)
+{
+    uint64_t now_us = EVERT_CCU_GetTimeUs();
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR((struct msghdr *)message); cmsg != NULL; cmsg = CMSG_NXTHDR((struct msghdr *)message, cmsg))
+    {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS)
+        {
+            struct timespec stamp, real;
+            memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+            clock_gettime(CLOCK_REALTIME, &real);
+
+            int64_t age_ns = (int64_t)(real.tv_sec - stamp.tv_sec) * 1000000000 + (real.tv_nsec - stamp.tv_nsec);
+
+            // A clock step between both reads leaves the age off, the read time is closer then
+            return age_ns >= 0 && (uint64_t)age_ns / 1000u < now_us ? now_us - (uint64_t)age_ns / 1000u : now_us;
+        }
+    }
+
+    return now_us;
+}
+
+EVERT_CCU_SOCKETCAN_StatusTypeDef EVERT_CCU_SOCKETCAN_Read(EVERT_CCU_SOCKETCAN_HandlerTypeDef *socketcan, EVERT_CCU_FrameTypeDef *frame)
+{
+    struct can_frame can;
+    struct iovec iov = {.iov_base = &can, .iov_len = sizeof(can)};
+    uint8_t control[CMSG_SPACE(sizeof(struct timespec))];
+    struct msghdr message = {.msg_iov = &iov, .msg_iovlen = 1, .msg_control = control, .msg_controllen = sizeof(control)};
+    ssize_t length = recvmsg(socketcan->fd, &message, 0);
+
+    if (length < 0)
+    {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+        {
+            return CSS_AGAIN;
+        }
+
+        socketcan->error_count++;
+        return CSS_ERROR;
+    }
+
+    if ((size_t)length < sizeof(can))
+    {
+        socketcan->error_count++;
+        return CSS_ERROR;
+    }
+
+    if (!EVERT_CCU_PROTOCOL_Decode(&can, frame))
+    {
+        return CSS_IGNORED;
+    }
+
+    frame->timestamp_us = EVERT_CCU_SOCKETCAN_Timestamp(&message);
+
+    if (message.msg_flags & MSG_CONFIRM)
+    {
+        // Own frame sent, only the SYNC echo is of use (ccu_timesync.h)
+        socketcan->echo_count++;
+        return frame->length > 0 && frame->data[0] == BCCM_TIME_SYNC ? CSS_OK : CSS_IGNORED;
+    }
+
+    socketcan->rx_count++;
+
+    return CSS_OK;
+}
+
+EVERT_CCU_SOCKETCAN_StatusTypeDef EVERT_CCU_SOCKETCAN_Write(EVERT_CCU_SOCKETCAN_HandlerTypeDef *socketcan, const EVERT_CCU_FrameTypeDef *frame)
+{
+    struct can_frame can;
+    EVERT_CCU_PROTOCOL_Encode(frame, &can);
+
+    ssize_t length = write(socketcan->fd, &can, sizeof(can));
+
+    if (length < 0)
+    {
+        // ENOBUFS: the interface queue is full, same as EAGAIN for us
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS || errno == EINTR)
+        {
+            return CSS_AGAIN;
+        }
+
+        socketcan->error_count++;
+        return CSS_ERROR;
+    }
+
+    socketcan->tx_count++;
+
+    return CSS_OK;
+}
@@ -0,0 +1,45 @@
+/**
+ ******************************************************************************
+ * @file    ccu_socketcan.h
+ * @author  Evert Firmware Team
+ * @brief   Raw SocketCAN socket for the CCU (can0, or vcan0 for tests)
+ *          * Non-blocking, the I/O thread waits on it with epoll
+ *          * Receive filter: extended ids with the Evert flag only
+ *          * Own frames are looped back once sent (MSG_CONFIRM), the SYNC echo is passed on for the time
+ *            sync master (ccu_timesync.h), the other echoes are dropped here
+ *          * Frames are timestamped by the kernel on reception (SO_TIMESTAMPNS), converted to monotonic time
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_CCU_SOCKETCAN_H_
+#define EVERT_CCU_SOCKETCAN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ccu_protocol.h"
+
+typedef enum
+{
+    CSS_OK = 0,
+    CSS_AGAIN = 1, // Nothing to read / no room in the socket buffer, retry when epoll says so
+    CSS_IGNORED = 2, // Not an Evert frame, or an own frame back
+    CSS_ERROR = 3
+} EVERT_CCU_SOCKETCAN_StatusTypeDef;
+
+typedef struct
+{
+    int fd;
+    uint64_t rx_count;
+    uint64_t tx_count;
+    uint64_t echo_count; // Own frames back from the bus
+    uint64_t error_count;
+} EVERT_CCU_SOCKETCAN_HandlerTypeDef;
+
+bool EVERT_CCU_SOCKETCAN_Open(EVERT_CCU_SOCKETCAN_HandlerTypeDef *socketcan, const char *interface);
+void EVERT_CCU_SOCKETCAN_Close(EVERT_CCU_SOCKETCAN_HandlerTypeDef *socketcan);
+EVERT_CCU_SOCKETCAN_StatusTypeDef EVERT_CCU_SOCKETCAN_Read(EVERT_CCU_SOCKETCAN_HandlerTypeDef *socketcan, EVERT_CCU_FrameTypeDef *frame);
+EVERT_CCU_SOCKETCAN_StatusTypeDef EVERT_CCU_SOCKETCAN_Write(EVERT_CCU_SOCKETCAN_HandlerTypeDef *socketcan, const EVERT_CCU_FrameTypeDef *frame);
+
+uint64_t EVERT_CCU_GetTimeUs(void);
+
+#endif // EVERT_CCU_SOCKETCAN_H_
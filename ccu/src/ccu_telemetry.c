@@ -0,0 +1,408 @@
+/**
+ ******************************************************************************
+ * @file    ccu_telemetry.c
+ * @author  Evert Firmware Team
+ * @brief   Telemetry ingestion of the CCU: device frames into the time-series store
+ *
+ ******************************************************************************
+ **/
+
+#include <inttypes.h>
+#include <string.h>
+#include "ccu.h"
+#include "ccu_telemetry.h"
+
+#define EVERT_CCU_TELEMETRY_ID_ALL (0xFFFF)
+#define EVERT_CCU_TELEMETRY_STATUS_OK (0)
+#define EVERT_CCU_TELEMETRY_STATUS_NOT_FOUND (1)
+
+static EVERT_CCU_TIMESERIES_StoreTypeDef *telemetry_store;
+static EVERT_CCU_TELEMETRY_DeviceTypeDef telemetry_devices[EVERT_CONSTANT_CCU_DEVICE_COUNT];
+
+static uint32_t EVERT_CCU_TELEMETRY_TypeSize(const uint8_t type)
+{
+    return (type == CRT_U8 || type == CRT_I8 || type == CRT_BOOL) ? 1 : (type == CRT_U16 || type == CRT_I16) ? 2 : 4;
+}
+
+/// @brief Raw registry bits (little endian, low bytes for narrow types) to a sample value
+static float EVERT_CCU_TELEMETRY_ToFloat(const uint8_t type, const uint32_t raw)
+{
+    switch (type)
+    {
+    case CRT_I8:
+        return (float)(int8_t)raw;
+
+    case CRT_U16:
+        return (float)(uint16_t)raw;
+
+    case CRT_I16:
+        return (float)(int16_t)raw;
+
+    case CRT_I32:
+        return (float)(int32_t)raw;
+
+    case CRT_F32:
+    {
+        float value;
+        memcpy(&value, &raw, sizeof(value));
+        return value;
+    }
+
+    case CRT_U8:
+    case CRT_BOOL:
+        return (float)(uint8_t)raw;
+
+    default:
+        return (float)raw;
+    }
+}
+
+static uint8_t EVERT_CCU_TELEMETRY_TypeOf(const EVERT_CCU_TELEMETRY_DeviceTypeDef *device, const uint16_t id)
+{
+    for (uint32_t i = 0; i < device->variable_count; i++)
+    {
+        if (device->variables[i].id == id)
+        {
+            return device->variables[i].type;
+        }
+    }
+
+    return EVERT_CCU_TELEMETRY_TYPE_UNKNOWN;
+}
+
+static void EVERT_CCU_TELEMETRY_Send(const uint8_t device_id, const uint8_t length, const uint8_t *data)
+{
+    EVERT_CCU_FrameTypeDef frame;
+    EVERT_CCU_PROTOCOL_Create(&frame, device_id, CMP_LOW, length, data);
+    EVERT_CCU_Transmit(&frame);
+}
+
+static void EVERT_CCU_TELEMETRY_RequestList(const uint8_t device_id, const uint16_t index)
+{
+    uint8_t data[3] = {BCCM_VAR_LIST};
+    memcpy(&data[1], &index, sizeof(index));
+
+    EVERT_CCU_TELEMETRY_Send(device_id, sizeof(data), data);
+}
+
+/// @brief Delta telemetry table from index on
+static void EVERT_CCU_TELEMETRY_RequestTable(const uint8_t device_id, const uint8_t index)
+{
+    uint8_t data[2] = {BCCM_TELEMETRY_LIST, index};
+
+    EVERT_CCU_TELEMETRY_Send(device_id, sizeof(data), data);
+}
+
+void EVERT_CCU_TELEMETRY_Init(EVERT_CCU_TIMESERIES_StoreTypeDef *store)
+{
+    telemetry_store = store;
+    memset(telemetry_devices, 0, sizeof(telemetry_devices));
+}
+
+void EVERT_CCU_TELEMETRY_Record(const uint8_t device_id, const EVERT_CCU_TIMESERIES_SourceTypeDef source, const uint16_t id, const uint64_t timestamp_us, const float value)
+{
+    EVERT_CCU_TIMESERIES_Append(telemetry_store, EVERT_CCU_TIMESERIES_KEY(device_id, source, id), timestamp_us, value);
+}
+
+/// @brief Start the listings of the next device waiting for them, unless one is still listing
+static void EVERT_CCU_TELEMETRY_DiscoverNext(void)
+{
+    for (uint32_t i = 0; i < EVERT_CONSTANT_CCU_DEVICE_COUNT; i++)
+    {
+        if (telemetry_devices[i].listing)
+        {
+            return;
+        }
+    }
+
+    for (uint8_t i = 0; i < EVERT_CONSTANT_CCU_DEVICE_COUNT; i++)
+    {
+        EVERT_CCU_TELEMETRY_DeviceTypeDef *device = &telemetry_devices[i];
+
+        if (!device->discover_pending)
+        {
+            continue;
+        }
+
+        device->discover_pending = false;
+        device->listing = true;
+        device->list_next = true;
+
+        // Both listings run side by side, the delta telemetry table comes in one go and index 0 gets a keyframe going
+        EVERT_CCU_TELEMETRY_RequestTable(i, 0);
+        return;
+    }
+}
+
+/// @brief List the registry of a device (types for the values it sends), after the handshake
+void EVERT_CCU_TELEMETRY_Discover(const uint8_t device_id)
+{
+    EVERT_CCU_TELEMETRY_DeviceTypeDef *device = &telemetry_devices[device_id];
+
+    device->variable_count = 0;
+    device->list_index = 0;
+    device->listing = false;
+    device->discover_pending = true;
+    memset(device->slots, 0, sizeof(device->slots));
+    memset(device->pending, 0, sizeof(device->pending));
+    EVERT_CCU_DELTA_TELEMETRY_Reset(&device->delta);
+
+    EVERT_CCU_TELEMETRY_DiscoverNext();
+}
+
+/// @brief Device gone offline, its listings will not finish
+void EVERT_CCU_TELEMETRY_Forget(const uint8_t device_id)
+{
+    EVERT_CCU_TELEMETRY_DeviceTypeDef *device = &telemetry_devices[device_id];
+
+    device->listing = false;
+    device->discover_pending = false;
+
+    EVERT_CCU_TELEMETRY_DiscoverNext();
+}
+
+/// @brief Registry listing, worker tick: the next entry or the timeout
+void EVERT_CCU_TELEMETRY_Process(const uint64_t now_us)
+{
+    for (uint8_t i = 0; i < EVERT_CONSTANT_CCU_DEVICE_COUNT; i++)
+    {
+        EVERT_CCU_TELEMETRY_DeviceTypeDef *device = &telemetry_devices[i];
+
+        if (!device->listing)
+        {
+            continue;
+        }
+
+        if (device->list_next)
+        {
+            device->list_next = false;
+            device->list_us = now_us;
+            EVERT_CCU_TELEMETRY_RequestList(i, device->list_index);
+        }
+        else if (now_us - device->list_us >= (uint64_t)EVERT_SETTING_CCU_TELEMETRY_LIST_TIMEOUT_MS * 1000u)
+        {
+            device->listing = false;
+            EVERT_CCU_TELEMETRY_DiscoverNext();
+        }
+    }
+}
+
+const EVERT_CCU_DELTA_TELEMETRY_DecoderTypeDef *EVERT_CCU_TELEMETRY_GetDelta(const uint8_t device_id)
+{
+    return device_id < EVERT_CONSTANT_CCU_DEVICE_COUNT ? &telemetry_devices[device_id].delta : NULL;
+}
+
+/// @brief Subscribe to a variable, 0 ms unsubscribes. The device answers with the slot the stream uses.
+void EVERT_CCU_TELEMETRY_Subscribe(const uint8_t device_id, const uint16_t variable_id, const uint16_t period_ms)
+{
+    EVERT_CCU_TELEMETRY_DeviceTypeDef *device = &telemetry_devices[device_id];
+
+    if (period_ms == 0)
+    {
+        for (uint32_t i = 0; i < EVERT_CCU_TELEMETRY_SLOT_COUNT; i++)
+        {
+            device->slots[i] = device->slots[i] == variable_id ? 0 : device->slots[i];
+        }
+    }
+
+    // The unsubscribe status carries no slot
+    for (uint32_t i = 0; i < EVERT_CCU_TELEMETRY_SLOT_COUNT && period_ms > 0; i++)
+    {
+        if (device->pending[i] == 0 || device->pending[i] == variable_id)
+        {
+            device->pending[i] = variable_id;
+            break;
+        }
+    }
+
+    uint8_t data[5] = {BCCM_VAR_SUBSCRIBE};
+    memcpy(&data[1], &variable_id, sizeof(variable_id));
+    memcpy(&data[3], &period_ms, sizeof(period_ms));
+
+    EVERT_CCU_TELEMETRY_Send(device_id, sizeof(data), data);
+}
+
+/// @brief Delta telemetry of the devices that sent any
+void EVERT_CCU_TELEMETRY_Print(FILE *file)
+{
+    for (uint32_t i = 0; i < EVERT_CONSTANT_CCU_DEVICE_COUNT; i++)
+    {
+        const EVERT_CCU_DELTA_TELEMETRY_DecoderTypeDef *delta = &telemetry_devices[i].delta;
+
+        if (delta->frame_count == 0)
+        {
+            continue;
+        }
+
+        fprintf(file, "CCU: telemetry %" PRIu32 ": %" PRIu32 " signals, %" PRIu64 " frames (%" PRIu64 " key), %" PRIu64 " values in %" PRIu64 " bytes, %" PRIu64 " lost, %" PRIu64 " malformed\n",
+                i, delta->signal_count, delta->frame_count, delta->keyframe_count, delta->value_count, delta->byte_count, delta->lost_count, delta->error_count);
+    }
+}
+
+void EVERT_CCU_TELEMETRY_OnFrame(const EVERT_CCU_FrameTypeDef *frame)
+{
+    uint8_t device_id = frame->identifier.source_id;
+
+    if (frame->length == 0 || device_id >= EVERT_CONSTANT_CCU_DEVICE_COUNT)
+    {
+        return;
+    }
+
+    EVERT_CCU_TELEMETRY_DeviceTypeDef *device = &telemetry_devices[device_id];
+    uint16_t id;
+    uint32_t raw;
+
+    switch (frame->data[0])
+    {
+    case BCCM_CURRENT_SHARE:
+        if (frame->length >= 5)
+        {
+            float current;
+            memcpy(&current, &frame->data[1], sizeof(current));
+            EVERT_CCU_TELEMETRY_Record(device_id, CTS_CURRENT_SHARE, 0, frame->timestamp_us, current);
+        }
+        break;
+
+    case BCCM_POWER_REPORT:
+        // [1..2] power W, [3..4] available power W, [5..6] bus voltage 0.1 V
+        if (frame->length >= 7)
+        {
+            uint16_t values[3];
+            memcpy(values, &frame->data[1], sizeof(values));
+            EVERT_CCU_TELEMETRY_Record(device_id, CTS_POWER_REPORT, EVERT_CCU_TIMESERIES_POWER_REPORT_POWER, frame->timestamp_us, (float)values[0]);
+            EVERT_CCU_TELEMETRY_Record(device_id, CTS_POWER_REPORT, EVERT_CCU_TIMESERIES_POWER_REPORT_AVAILABLE, frame->timestamp_us, (float)values[1]);
+            EVERT_CCU_TELEMETRY_Record(device_id, CTS_POWER_REPORT, EVERT_CCU_TIMESERIES_POWER_REPORT_BUS_VOLTAGE, frame->timestamp_us, values[2] * 0.1f);
+        }
+        break;
+
+    case BCCM_DEVICE_STATE:
+        if (frame->length >= 2)
+        {
+            EVERT_CCU_TELEMETRY_Record(device_id, CTS_DEVICE_STATE, 0, frame->timestamp_us, (float)frame->data[1]);
+        }
+        break;
+
+    case BCCM_VAR_ENTRY:
+        // [1..2] id, [3] type << 4 | access, [4..6] name hash bits 0-23
+        if (frame->length >= 7)
+        {
+            memcpy(&id, &frame->data[1], sizeof(id));
+
+            if (device->variable_count < EVERT_CCU_TELEMETRY_VARIABLE_COUNT && EVERT_CCU_TELEMETRY_TypeOf(device, id) == EVERT_CCU_TELEMETRY_TYPE_UNKNOWN)
+            {
+                EVERT_CCU_TELEMETRY_VariableTypeDef *variable = &device->variables[device->variable_count++];
+                variable->id = id;
+                variable->type = frame->data[3] >> 4;
+                variable->name_hash = 0;
+                memcpy(&variable->name_hash, &frame->data[4], 3);
+            }
+
+            if (device->listing)
+            {
+                device->list_index++;
+                device->list_next = true;
+            }
+        }
+        break;
+
+    case BCCM_VAR_STATUS:
+        // [1..2] id, [3] status, [4] slot
+        if (frame->length >= 5)
+        {
+            memcpy(&id, &frame->data[1], sizeof(id));
+
+            if (id == EVERT_CCU_TELEMETRY_ID_ALL && frame->data[3] == EVERT_CCU_TELEMETRY_STATUS_NOT_FOUND)
+            {
+                device->listing = false; // End of the table
+                EVERT_CCU_TELEMETRY_DiscoverNext();
+            }
+            else
+            {
+                for (uint32_t i = 0; i < EVERT_CCU_TELEMETRY_SLOT_COUNT; i++)
+                {
+                    if (device->pending[i] != id)
+                    {
+                        continue;
+                    }
+
+                    if (frame->data[3] == EVERT_CCU_TELEMETRY_STATUS_OK && frame->data[4] < EVERT_CCU_TELEMETRY_SLOT_COUNT)
+                    {
+                        device->slots[frame->data[4]] = id;
+                    }
+
+                    device->pending[i] = 0;
+                    break;
+                }
+            }
+        }
+        break;
+
+    case BCCM_VAR_VALUE:
+        // [1..2] id, [3..6] value
+        if (frame->length >= 7)
+        {
+            memcpy(&id, &frame->data[1], sizeof(id));
+            memcpy(&raw, &frame->data[3], sizeof(raw));
+            EVERT_CCU_TELEMETRY_Record(device_id, CTS_VARIABLE, id, frame->timestamp_us, EVERT_CCU_TELEMETRY_ToFloat(EVERT_CCU_TELEMETRY_TypeOf(device, id), raw));
+        }
+        break;
+
+    case BCCM_VAR_STREAM:
+        // [1..6] [slot][value]..., the value size follows from the type of the subscribed variable
+        for (uint32_t i = 1; i < frame->length;)
+        {
+            uint8_t slot = frame->data[i++];
+            uint8_t type = slot < EVERT_CCU_TELEMETRY_SLOT_COUNT && device->slots[slot] != 0 ? EVERT_CCU_TELEMETRY_TypeOf(device, device->slots[slot]) : EVERT_CCU_TELEMETRY_TYPE_UNKNOWN;
+
+            if (type == EVERT_CCU_TELEMETRY_TYPE_UNKNOWN)
+            {
+                break; // The rest of the frame cannot be parsed without the size
+            }
+
+            uint32_t size = EVERT_CCU_TELEMETRY_TypeSize(type);
+
+            if (i + size > frame->length)
+            {
+                break;
+            }
+
+            raw = 0;
+            memcpy(&raw, &frame->data[i], size);
+            i += size;
+
+            EVERT_CCU_TELEMETRY_Record(device_id, CTS_SUBSCRIPTION, device->slots[slot], frame->timestamp_us, EVERT_CCU_TELEMETRY_ToFloat(type, raw));
+        }
+        break;
+
+    case BCCM_TELEMETRY_SIGNAL:
+        // Message id = index, [1..2] id, [3..6] resolution
+        if (frame->length >= 7)
+        {
+            float resolution;
+            memcpy(&id, &frame->data[1], sizeof(id));
+            memcpy(&resolution, &frame->data[3], sizeof(resolution));
+
+            if (EVERT_CCU_DELTA_TELEMETRY_OnSignal(&device->delta, frame->identifier.message_id, id, resolution))
+            {
+                EVERT_CCU_TELEMETRY_RequestTable(device_id, (uint8_t)device->delta.signal_count);
+            }
+        }
+        break;
+
+    case BCCM_TELEMETRY_FRAME:
+    {
+        // Message id = sequence, [1..6] payload
+        uint8_t updated[EVERT_CCU_DELTA_TELEMETRY_SIGNAL_COUNT];
+        uint32_t count = EVERT_CCU_DELTA_TELEMETRY_Decode(&device->delta, frame->identifier.message_id, &frame->data[1], frame->length - 1u, updated, sizeof(updated));
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            EVERT_CCU_TELEMETRY_Record(device_id, CTS_TELEMETRY, device->delta.id[updated[i]], frame->timestamp_us, EVERT_CCU_DELTA_TELEMETRY_Value(&device->delta, updated[i]));
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+}
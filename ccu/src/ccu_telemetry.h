@@ -0,0 +1,77 @@
+/**
+ ******************************************************************************
+ * @file    ccu_telemetry.h
+ * @author  Evert Firmware Team
+ * @brief   Telemetry ingestion of the CCU: device frames into the time-series store
+ *          * Current share, device state, power report: fixed layout, stored as they come
+ *          * Registry (registry.h): the variable types are learned from the table listing (BCCM_VAR_LIST,
+ *            requested after the handshake), subscriptions made through EVERT_CCU_TELEMETRY_Subscribe
+ *            map the stream slots back to the variables
+ *          * Delta telemetry: the signal table is listed after the handshake as well (BCCM_TELEMETRY_LIST),
+ *            ccu_delta_telemetry.h decodes the frames
+ *          * One device lists at a time and the registry one entry per worker tick, the listings of devices
+ *            acknowledged together would otherwise take most of the bus. A device that does not answer
+ *            (no registry) holds up the others for EVERT_SETTING_CCU_TELEMETRY_LIST_TIMEOUT_MS
+ *          * Worker thread only
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_CCU_TELEMETRY_H_
+#define EVERT_CCU_TELEMETRY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "ccu_delta_telemetry.h"
+#include "ccu_protocol.h"
+#include "ccu_timeseries.h"
+
+#define EVERT_CCU_TELEMETRY_VARIABLE_COUNT (64) // Registry entries remembered per device
+#define EVERT_CCU_TELEMETRY_SLOT_COUNT (8)      // EVERT_HAL_CONF_REGISTRY_SUBSCRIPTION_COUNT of the devices
+#define EVERT_CCU_TELEMETRY_TYPE_UNKNOWN (0xFF)
+
+/// @brief Registry variable types, mirrors EVERT_REGISTRY_TypeTypeDef (registry.h)
+typedef enum
+{
+    CRT_U8 = 0,
+    CRT_I8 = 1,
+    CRT_U16 = 2,
+    CRT_I16 = 3,
+    CRT_U32 = 4,
+    CRT_I32 = 5,
+    CRT_F32 = 6,
+    CRT_BOOL = 7
+} EVERT_CCU_TELEMETRY_TypeTypeDef;
+
+typedef struct
+{
+    uint16_t id;
+    uint8_t type; // EVERT_CCU_TELEMETRY_TypeTypeDef
+    uint32_t name_hash;
+} EVERT_CCU_TELEMETRY_VariableTypeDef;
+
+typedef struct
+{
+    EVERT_CCU_TELEMETRY_VariableTypeDef variables[EVERT_CCU_TELEMETRY_VARIABLE_COUNT];
+    uint32_t variable_count;
+    uint16_t list_index; // Next registry index to request, listing runs until BCCM_VAR_STATUS not found
+    bool listing;
+    bool list_next;        // list_index is requested at the next worker tick, one entry per tick
+    bool discover_pending; // Acknowledged, listed once no other device is
+    uint64_t list_us;      // Last registry request
+    uint16_t slots[EVERT_CCU_TELEMETRY_SLOT_COUNT]; // Variable id per subscription slot, 0 = free
+    uint16_t pending[EVERT_CCU_TELEMETRY_SLOT_COUNT]; // Ids of subscribe requests not answered yet, the status carries the slot
+    EVERT_CCU_DELTA_TELEMETRY_DecoderTypeDef delta;
+} EVERT_CCU_TELEMETRY_DeviceTypeDef;
+
+void EVERT_CCU_TELEMETRY_Init(EVERT_CCU_TIMESERIES_StoreTypeDef *store);
+void EVERT_CCU_TELEMETRY_OnFrame(const EVERT_CCU_FrameTypeDef *frame);
+void EVERT_CCU_TELEMETRY_Discover(const uint8_t device_id);
+void EVERT_CCU_TELEMETRY_Forget(const uint8_t device_id);
+void EVERT_CCU_TELEMETRY_Process(const uint64_t now_us);
+void EVERT_CCU_TELEMETRY_Subscribe(const uint8_t device_id, const uint16_t variable_id, const uint16_t period_ms);
+const EVERT_CCU_DELTA_TELEMETRY_DecoderTypeDef *EVERT_CCU_TELEMETRY_GetDelta(const uint8_t device_id);
+void EVERT_CCU_TELEMETRY_Print(FILE *file);
+void EVERT_CCU_TELEMETRY_Record(const uint8_t device_id, const EVERT_CCU_TIMESERIES_SourceTypeDef source, const uint16_t id, const uint64_t timestamp_us, const float value);
+
+#endif // EVERT_CCU_TELEMETRY_H_
@@ -0,0 +1,122 @@
+/**
+ ******************************************************************************
+ * @file    ccu_timeseries.c
+ * @author  Evert Firmware Team
+ * @brief   Ring-buffered time-series store for the telemetry the devices send
+ *
+ ******************************************************************************
+ **/
+
+#include <inttypes.h>
+#include <string.h>
+#include "ccu_timeseries.h"
+
+#define EVERT_CCU_TIMESERIES_MASK (EVERT_CONSTANT_CCU_TIMESERIES_SAMPLES - 1)
+
+void EVERT_CCU_TIMESERIES_Init(EVERT_CCU_TIMESERIES_StoreTypeDef *store)
+{
+    memset(store, 0, sizeof(*store));
+}
+
+const EVERT_CCU_TIMESERIES_SeriesTypeDef *EVERT_CCU_TIMESERIES_Find(const EVERT_CCU_TIMESERIES_StoreTypeDef *store, const uint32_t key)
+{
+    for (uint32_t i = 0; i < store->series_count; i++)
+    {
+        if (store->series[i].key == key)
+        {
+            return &store->series[i];
+        }
+    }
+
+    return NULL;
+}
+
+/// @return false if the store has no series left for a new key (dropped)
+bool EVERT_CCU_TIMESERIES_Append(EVERT_CCU_TIMESERIES_StoreTypeDef *store, const uint32_t key, const uint64_t timestamp_us, const float value)
+{
+    EVERT_CCU_TIMESERIES_SeriesTypeDef *series = (EVERT_CCU_TIMESERIES_SeriesTypeDef *)EVERT_CCU_TIMESERIES_Find(store, key);
+
+    if (series == NULL)
+    {
+        if (store->series_count >= EVERT_CONSTANT_CCU_TIMESERIES_SERIES)
+        {
+            store->drop_count++;
+            return false;
+        }
+
+        series = &store->series[store->series_count++];
+        series->key = key;
+        series->count = 0;
+    }
+
+    EVERT_CCU_TIMESERIES_SampleTypeDef *sample = &series->samples[series->count & EVERT_CCU_TIMESERIES_MASK];
+    sample->timestamp_us = timestamp_us;
+    sample->value = value;
+    series->count++;
+
+    return true;
+}
+
+bool EVERT_CCU_TIMESERIES_Latest(const EVERT_CCU_TIMESERIES_StoreTypeDef *store, const uint32_t key, EVERT_CCU_TIMESERIES_SampleTypeDef *sample)
+{
+    const EVERT_CCU_TIMESERIES_SeriesTypeDef *series = EVERT_CCU_TIMESERIES_Find(store, key);
+
+    if (series == NULL || series->count == 0)
+    {
+        return false;
+    }
+
+    *sample = series->samples[(series->count - 1) & EVERT_CCU_TIMESERIES_MASK];
+
+    return true;
+}
+
+/// @brief Samples at or after since_us, oldest first
+/// @return Samples copied, at most max (the newest ones if there are more)
+uint32_t EVERT_CCU_TIMESERIES_Query(const EVERT_CCU_TIMESERIES_StoreTypeDef *store, const uint32_t key, const uint64_t since_us, EVERT_CCU_TIMESERIES_SampleTypeDef *samples, const uint32_t max)
+{
+    const EVERT_CCU_TIMESERIES_SeriesTypeDef *series = EVERT_CCU_TIMESERIES_Find(store, key);
+
+    if (series == NULL || max == 0)
+    {
+        return 0;
+    }
+
+    uint64_t available = series->count < EVERT_CONSTANT_CCU_TIMESERIES_SAMPLES ? series->count : EVERT_CONSTANT_CCU_TIMESERIES_SAMPLES;
+    uint64_t first = series->count - available;
+
+    // Walk back from the newest, the timestamps are monotonic
+    uint64_t start = series->count;
+
+    while (start > first && series->count - start < max && series->samples[(start - 1) & EVERT_CCU_TIMESERIES_MASK].timestamp_us >= since_us)
+    {
+        start--;
+    }
+
+    uint32_t length = (uint32_t)(series->count - start);
+
+    for (uint32_t i = 0; i < length; i++)
+    {
+        samples[i] = series->samples[(start + i) & EVERT_CCU_TIMESERIES_MASK];
+    }
+
+    return length;
+}
+
+/// @brief Every sample in the store as device, source, id, timestamp, value
+void EVERT_CCU_TIMESERIES_ExportCsv(const EVERT_CCU_TIMESERIES_StoreTypeDef *store, FILE *file)
+{
+    fprintf(file, "device,source,id,timestamp_us,value\n");
+
+    for (uint32_t i = 0; i < store->series_count; i++)
+    {
+        const EVERT_CCU_TIMESERIES_SeriesTypeDef *series = &store->series[i];
+        uint64_t available = series->count < EVERT_CONSTANT_CCU_TIMESERIES_SAMPLES ? series->count : EVERT_CONSTANT_CCU_TIMESERIES_SAMPLES;
+
+        for (uint64_t n = series->count - available; n < series->count; n++)
+        {
+            const EVERT_CCU_TIMESERIES_SampleTypeDef *sample = &series->samples[n & EVERT_CCU_TIMESERIES_MASK];
+            fprintf(file, "%u,%u,%u,%" PRIu64 ",%g\n", (unsigned)(series->key >> 24), (unsigned)((series->key >> 16) & 0xFFu), (unsigned)(series->key & 0xFFFFu), sample->timestamp_us, (double)sample->value);
+        }
+    }
+}
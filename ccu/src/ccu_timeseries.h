@@ -0,0 +1,67 @@
+/**
+ ******************************************************************************
+ * @file    ccu_timeseries.h
+ * @author  Evert Firmware Team
+ * @brief   Ring-buffered time-series store for the telemetry the devices send
+ *          * Series: one per (device, source, id) key, created on the first sample, fixed table
+ *          * Samples: (timestamp us, float value) in a ring per series, the oldest are overwritten
+ *          * Worker thread only, no locking
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_CCU_TIMESERIES_H_
+#define EVERT_CCU_TIMESERIES_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "_conf_evert_ccu.h"
+
+_Static_assert((EVERT_CONSTANT_CCU_TIMESERIES_SAMPLES & (EVERT_CONSTANT_CCU_TIMESERIES_SAMPLES - 1)) == 0, "EVERT_CONSTANT_CCU_TIMESERIES_SAMPLES must be a power of 2");
+
+/// @brief What a series holds, part of the key
+typedef enum
+{
+    CTS_CURRENT_SHARE = 1,  // Input current of a boost converter (BCCM_CURRENT_SHARE), id 0
+    CTS_DEVICE_STATE = 2,   // Result state (BCCM_DEVICE_STATE), id 0
+    CTS_VARIABLE = 3,       // Registry variable (BCCM_VAR_VALUE), id = variable id
+    CTS_SUBSCRIPTION = 4,   // Registry subscription (BCCM_VAR_STREAM), id = variable id
+    CTS_SETPOINT = 5,       // Power setpoint sent by the dispatcher, id 0
+    CTS_POWER_REPORT = 6,   // BCCM_POWER_REPORT, id EVERT_CCU_TIMESERIES_POWER_REPORT_*
+    CTS_TELEMETRY = 7       // Delta telemetry (BCCM_TELEMETRY_FRAME), id = signal id, recorded when it changes
+} EVERT_CCU_TIMESERIES_SourceTypeDef;
+
+#define EVERT_CCU_TIMESERIES_POWER_REPORT_POWER (0)       // W
+#define EVERT_CCU_TIMESERIES_POWER_REPORT_AVAILABLE (1)   // W
+#define EVERT_CCU_TIMESERIES_POWER_REPORT_BUS_VOLTAGE (2) // V
+
+#define EVERT_CCU_TIMESERIES_KEY(device, source, id) (((uint32_t)(device) << 24) | ((uint32_t)(source) << 16) | ((uint32_t)(id) & 0xFFFFu))
+
+typedef struct
+{
+    uint64_t timestamp_us;
+    float value;
+} EVERT_CCU_TIMESERIES_SampleTypeDef;
+
+typedef struct
+{
+    uint32_t key;
+    uint64_t count; // Samples ever written, the ring holds the last EVERT_CONSTANT_CCU_TIMESERIES_SAMPLES
+    EVERT_CCU_TIMESERIES_SampleTypeDef samples[EVERT_CONSTANT_CCU_TIMESERIES_SAMPLES];
+} EVERT_CCU_TIMESERIES_SeriesTypeDef;
+
+typedef struct
+{
+    EVERT_CCU_TIMESERIES_SeriesTypeDef series[EVERT_CONSTANT_CCU_TIMESERIES_SERIES];
+    uint32_t series_count;
+    uint64_t drop_count; // Samples without a free series
+} EVERT_CCU_TIMESERIES_StoreTypeDef;
+
+void EVERT_CCU_TIMESERIES_Init(EVERT_CCU_TIMESERIES_StoreTypeDef *store);
+bool EVERT_CCU_TIMESERIES_Append(EVERT_CCU_TIMESERIES_StoreTypeDef *store, const uint32_t key, const uint64_t timestamp_us, const float value);
+const EVERT_CCU_TIMESERIES_SeriesTypeDef *EVERT_CCU_TIMESERIES_Find(const EVERT_CCU_TIMESERIES_StoreTypeDef *store, const uint32_t key);
+bool EVERT_CCU_TIMESERIES_Latest(const EVERT_CCU_TIMESERIES_StoreTypeDef *store, const uint32_t key, EVERT_CCU_TIMESERIES_SampleTypeDef *sample);
+uint32_t EVERT_CCU_TIMESERIES_Query(const EVERT_CCU_TIMESERIES_StoreTypeDef *store, const uint32_t key, const uint64_t since_us, EVERT_CCU_TIMESERIES_SampleTypeDef *samples, const uint32_t max);
+void EVERT_CCU_TIMESERIES_ExportCsv(const EVERT_CCU_TIMESERIES_StoreTypeDef *store, FILE *file);
+
+#endif // EVERT_CCU_TIMESERIES_H_
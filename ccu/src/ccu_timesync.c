@@ -0,0 +1,102 @@
+/**
+ ******************************************************************************
+ * @file    ccu_timesync.c
+ * @author  Evert Firmware Team
+ * @brief   Time synchronization master
+ *
+ ******************************************************************************
+ **/
+
+#include <inttypes.h>
+#include <string.h>
+#include "ccu.h"
+#include "ccu_timesync.h"
+
+static EVERT_CCU_TIMESYNC_HandlerTypeDef timesync;
+
+void EVERT_CCU_TIMESYNC_Init(const uint32_t bitrate)
+{
+    memset(&timesync, 0, sizeof(timesync));
+    timesync.bitrate = bitrate;
+}
+
+/// @brief Send the next SYNC when it is due, worker tick
+void EVERT_CCU_TIMESYNC_Process(const uint64_t now_us)
+{
+    if (EVERT_SETTING_CCU_TIME_SYNC_INTERVAL_MS == 0 || timesync.bitrate == 0)
+    {
+        return;
+    }
+
+    if (timesync.pending)
+    {
+        if (now_us - timesync.sent_us < (uint64_t)EVERT_SETTING_CCU_TIME_SYNC_ECHO_TIMEOUT_MS * 1000u)
+        {
+            return;
+        }
+
+        // Never made it to the bus (bus off, TX queue full), the devices drop the SYNC on the next sequence
+        timesync.pending = false;
+        timesync.lost_count++;
+    }
+
+    if (timesync.sync_count > 0 && now_us - timesync.sent_us < (uint64_t)EVERT_SETTING_CCU_TIME_SYNC_INTERVAL_MS * 1000u)
+    {
+        return;
+    }
+
+    uint8_t data[1] = {BCCM_TIME_SYNC};
+    EVERT_CCU_FrameTypeDef frame;
+    EVERT_CCU_PROTOCOL_Create(&frame, EVERT_CCU_PROTOCOL_BROADCAST, CMP_HIGH, sizeof(data), data);
+    frame.identifier.message_id = ++timesync.sequence;
+
+    EVERT_CCU_Transmit(&frame);
+
+    timesync.pending = true;
+    timesync.sent_us = now_us;
+    timesync.sync_count++;
+}
+
+/// @brief Own frame back from the bus, timestamp_us = end of its EOF
+void EVERT_CCU_TIMESYNC_OnEcho(const EVERT_CCU_FrameTypeDef *frame)
+{
+    if (frame->length < 1 || frame->data[0] != BCCM_TIME_SYNC || !timesync.pending || frame->identifier.message_id != timesync.sequence)
+    {
+        return;
+    }
+
+    timesync.pending = false;
+
+    // Back to the start of frame, the same bits as on the wire
+    struct can_frame can;
+    EVERT_CCU_PROTOCOL_Encode(frame, &can);
+    uint64_t bits = EVERT_CCU_PROTOCOL_FrameBits(&can) - EVERT_CCU_PROTOCOL_INTERMISSION_BITS;
+    timesync.sof_us = frame->timestamp_us - (bits * 1000000u + timesync.bitrate / 2) / timesync.bitrate;
+
+    uint8_t data[EVERT_CCU_TIME_FOLLOW_UP_LENGTH] = {BCCM_TIME_FOLLOW_UP};
+    memcpy(&data[1], &timesync.sof_us, EVERT_CCU_TIME_FOLLOW_UP_LENGTH - 1); // Little endian, like the devices
+
+    EVERT_CCU_FrameTypeDef follow_up;
+    EVERT_CCU_PROTOCOL_Create(&follow_up, EVERT_CCU_PROTOCOL_BROADCAST, CMP_HIGH, sizeof(data), data);
+    follow_up.identifier.message_id = timesync.sequence;
+
+    EVERT_CCU_Transmit(&follow_up);
+    timesync.follow_up_count++;
+}
+
+void EVERT_CCU_TIMESYNC_Print(FILE *file)
+{
+    if (EVERT_SETTING_CCU_TIME_SYNC_INTERVAL_MS == 0)
+    {
+        fprintf(file, "CCU: time sync off\n");
+        return;
+    }
+
+    fprintf(file, "CCU: time sync %" PRIu64 " SYNC, %" PRIu64 " FOLLOW-UP, %" PRIu64 " lost, last at %" PRIu64 " us\n",
+            timesync.sync_count, timesync.follow_up_count, timesync.lost_count, timesync.sof_us);
+}
+
+const EVERT_CCU_TIMESYNC_HandlerTypeDef *EVERT_CCU_TIMESYNC_Get(void)
+{
+    return &timesync;
+}
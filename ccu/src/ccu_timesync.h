@@ -0,0 +1,44 @@
+/**
+ ******************************************************************************
+ * @file    ccu_timesync.h
+ * @author  Evert Firmware Team
+ * @brief   Time synchronization master: the CCU clock (monotonic us) to the devices (libs/core/src/time_sync.h)
+ *          * SYNC: broadcast every EVERT_SETTING_CCU_TIME_SYNC_INTERVAL_MS, message id = sequence; the devices
+ *            timestamp its start of frame with their FDCAN timestamp counter
+ *          * The socket loops the SYNC back once it is through (ccu_socketcan.h), the echo carries the kernel
+ *            timestamp of the TX completion: start of frame = echo - frame length up to the end of the EOF
+ *          * FOLLOW-UP: broadcast with the same sequence, [1..6] the start of frame in CCU time
+ *          * Whatever delays the SYNC before the bus (queues, arbitration) is out of the measurement, the error
+ *            left is the jitter of the echo (adapter TX-done interrupt to the kernel timestamp)
+ *          * Worker thread only
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_CCU_TIMESYNC_H_
+#define EVERT_CCU_TIMESYNC_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "_conf_evert_ccu.h"
+#include "ccu_protocol.h"
+
+typedef struct
+{
+    uint32_t bitrate;
+    uint8_t sequence;    // Of the last SYNC
+    bool pending;        // Last SYNC not back from the bus yet
+    uint64_t sent_us;    // Last SYNC queued
+    uint64_t sof_us;     // Start of frame of the last SYNC
+    uint64_t sync_count;
+    uint64_t follow_up_count;
+    uint64_t lost_count; // No echo within EVERT_SETTING_CCU_TIME_SYNC_ECHO_TIMEOUT_MS
+} EVERT_CCU_TIMESYNC_HandlerTypeDef;
+
+void EVERT_CCU_TIMESYNC_Init(const uint32_t bitrate);
+void EVERT_CCU_TIMESYNC_Process(const uint64_t now_us);
+void EVERT_CCU_TIMESYNC_OnEcho(const EVERT_CCU_FrameTypeDef *frame);
+void EVERT_CCU_TIMESYNC_Print(FILE *file);
+const EVERT_CCU_TIMESYNC_HandlerTypeDef *EVERT_CCU_TIMESYNC_Get(void);
+
+#endif // EVERT_CCU_TIMESYNC_H_
@@ -0,0 +1,464 @@
+/**
+ ******************************************************************************
+ * @file    ccu_update.c
+ * @author  Evert Firmware Team
+ * @brief   Firmware update of the devices over CAN
+ *
+ ******************************************************************************
+ **/
+
+#include <inttypes.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ccu.h"
+#include "ccu_devices.h"
+#include "ccu_dispatch.h"
+#include "ccu_update.h"
+
+#define EVERT_CCU_UPDATE_FRAME_BITS (160) // BCCM_UPDATE_DATA on the wire: extended id, 8 bytes, stuff bits, intermission
+
+_Static_assert(EVERT_SETTING_CCU_UPDATE_WINDOW < 256, "Blocks in flight must be told apart by bits 0-7 of the index");
+
+static const char *const phase_names[] = {"none", "pending", "erasing", "sending", "verifying", "activating", "rebooting", "done", "failed"};
+
+static struct
+{
+    EVERT_CCU_UPDATE_JobTypeDef jobs[EVERT_CONSTANT_CCU_DEVICE_COUNT];
+    uint8_t active;           // Device id of the running update, 0 = none
+    uint32_t frames_per_tick; // Blocks per worker tick
+} update;
+
+/// @brief CRC-32 (IEEE 802.3), the same as libs/core/src/crc.h
+static uint32_t EVERT_CCU_UPDATE_Crc32(const void *data, const size_t length)
+{
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+
+    const uint8_t *bytes = (const uint8_t *)data;
+    uint32_t crc = 0xFFFFFFFFu;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= bytes[i];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+
+    return crc ^ 0xFFFFFFFFu;
+}
+
+static void EVERT_CCU_UPDATE_Send(const EVERT_CCU_UPDATE_JobTypeDef *job, const EVERT_CCU_PriorityTypeDef priority, const uint8_t message_id, const uint8_t length, const uint8_t *data)
+{
+    EVERT_CCU_FrameTypeDef frame;
+    EVERT_CCU_PROTOCOL_Create(&frame, job->device_id, priority, length, data);
+    frame.identifier.message_id = message_id;
+
+    EVERT_CCU_Transmit(&frame);
+}
+
+/// @brief BEGIN ([1..4] application bytes), END or ACTIVATE, the answer is a status
+static void EVERT_CCU_UPDATE_SendCommand(EVERT_CCU_UPDATE_JobTypeDef *job, const EVERT_CCU_MethodTypeDef method, const uint64_t now_us)
+{
+    uint8_t data[5] = {method};
+    uint8_t length = 1;
+
+    if (method == BCCM_UPDATE_BEGIN)
+    {
+        memcpy(&data[1], &job->header.size, sizeof(job->header.size));
+        length = sizeof(data);
+    }
+
+    EVERT_CCU_UPDATE_Send(job, CMP_NORMAL, 0, length, data);
+
+    job->answered = false;
+    job->command_us = now_us;
+}
+
+static void EVERT_CCU_UPDATE_SetPhase(EVERT_CCU_UPDATE_JobTypeDef *job, const EVERT_CCU_UpdatePhaseTypeDef phase, const uint64_t now_us)
+{
+    job->phase = phase;
+    job->phase_us = now_us;
+    job->retry_count = 0;
+}
+
+/// @brief Done or failed: the setpoint back, the image released, the next update may start
+static void EVERT_CCU_UPDATE_Finish(EVERT_CCU_UPDATE_JobTypeDef *job, const EVERT_CCU_UpdatePhaseTypeDef phase, const char *error, const uint64_t now_us)
+{
+    EVERT_CCU_UPDATE_SetPhase(job, phase, now_us);
+    job->error = error;
+
+    if (job->stopped)
+    {
+        job->stopped = false;
+        EVERT_CCU_DISPATCH_SetPowerSetpoint(job->device_id, job->power);
+    }
+
+    free(job->stream);
+    job->stream = NULL;
+    update.active = 0;
+
+    if (phase == CUP_DONE)
+    {
+        fprintf(stderr, "CCU: device %u updated to %u.%u.%u\n", job->device_id, job->header.version[0], job->header.version[1], job->header.version[2]);
+    }
+    else
+    {
+        fprintf(stderr, "CCU: update of device %u failed: %s (result %u)\n", job->device_id, error, job->result);
+    }
+}
+
+/// @brief Retry of a command or of the blocks, false once they ran out (the update failed)
+static bool EVERT_CCU_UPDATE_Retry(EVERT_CCU_UPDATE_JobTypeDef *job, const char *error, const uint64_t now_us)
+{
+    if (++job->retry_count > EVERT_SETTING_CCU_UPDATE_RETRY_COUNT)
+    {
+        EVERT_CCU_UPDATE_Finish(job, CUP_FAILED, error, now_us);
+        return false;
+    }
+
+    return true;
+}
+
+/// @brief Blocks of the window, as many as the bus share of a tick allows
+static void EVERT_CCU_UPDATE_SendBlocks(EVERT_CCU_UPDATE_JobTypeDef *job, const uint64_t now_us)
+{
+    uint32_t block_total = (job->size + EVERT_CCU_UPDATE_BLOCK_SIZE - 1) / EVERT_CCU_UPDATE_BLOCK_SIZE;
+    uint32_t base = job->acked / EVERT_CCU_UPDATE_BLOCK_SIZE;
+
+    if (job->next > base && now_us - job->progress_us >= (uint64_t)EVERT_SETTING_CCU_UPDATE_ACK_TIMEOUT_MS * 1000u)
+    {
+        // Blocks or their acknowledgement lost, and no gap report: from what the device confirmed
+        job->timeout_count++;
+
+        if (!EVERT_CCU_UPDATE_Retry(job, "no acknowledgement", now_us))
+        {
+            return;
+        }
+
+        job->next = base;
+        job->progress_us = now_us;
+    }
+
+    for (uint32_t n = 0; n < update.frames_per_tick && job->next < block_total && job->next < base + EVERT_SETTING_CCU_UPDATE_WINDOW; n++)
+    {
+        uint32_t offset = job->next * EVERT_CCU_UPDATE_BLOCK_SIZE;
+        uint32_t length = job->size - offset < EVERT_CCU_UPDATE_BLOCK_SIZE ? job->size - offset : EVERT_CCU_UPDATE_BLOCK_SIZE;
+        uint8_t data[1 + EVERT_CCU_UPDATE_BLOCK_SIZE] = {BCCM_UPDATE_DATA};
+
+        memcpy(&data[1], &job->stream[offset], length);
+        EVERT_CCU_UPDATE_Send(job, CMP_LOW, (uint8_t)job->next, (uint8_t)(1 + length), data);
+
+        job->next++;
+        job->block_count++;
+    }
+}
+
+void EVERT_CCU_UPDATE_Init(const uint32_t bitrate)
+{
+    for (uint32_t i = 0; i < EVERT_CONSTANT_CCU_DEVICE_COUNT; i++)
+    {
+        free(update.jobs[i].stream);
+    }
+
+    memset(&update, 0, sizeof(update));
+
+    uint64_t bits = (uint64_t)((float)bitrate * EVERT_SETTING_CCU_UPDATE_BUS_SHARE) * EVERT_CONSTANT_CCU_TICK_MS / 1000u;
+    update.frames_per_tick = bits / EVERT_CCU_UPDATE_FRAME_BITS > 0 ? (uint32_t)(bits / EVERT_CCU_UPDATE_FRAME_BITS) : 1;
+}
+
+/// @brief Queue an update of a device with the application bytes (a copy is kept), before or while the CCU runs
+/// @param version Major, minor, patch the image reports in BCCM_DEVICE_STATE
+/// @return false: bad device id or size, or an update of the device is running
+bool EVERT_CCU_UPDATE_Add(const uint8_t device_id, const uint8_t *application, const uint32_t size, const uint8_t version[3])
+{
+    uint32_t padded = (size + 7u) & ~7u;
+
+    if (device_id == 0 || device_id >= EVERT_CONSTANT_CCU_DEVICE_COUNT || device_id == EVERT_CONSTANT_CCU_DEVICE_ID ||
+        size == 0 || padded > EVERT_CCU_UPDATE_APP_SIZE_MAX || update.active == device_id)
+    {
+        return false;
+    }
+
+    EVERT_CCU_UPDATE_JobTypeDef *job = &update.jobs[device_id];
+    uint8_t *stream = malloc(sizeof(EVERT_CCU_UPDATE_HeaderTypeDef) + padded);
+
+    if (stream == NULL)
+    {
+        return false;
+    }
+
+    free(job->stream);
+    memset(job, 0, sizeof(*job));
+
+    uint8_t *app = stream + sizeof(EVERT_CCU_UPDATE_HeaderTypeDef);
+    memcpy(app, application, size);
+    memset(app + size, 0xFF, padded - size); // Erased flash
+
+    job->header.magic = EVERT_CCU_UPDATE_MAGIC;
+    job->header.header_version = EVERT_CCU_UPDATE_HEADER_VERSION;
+    job->header.target = device_id == CDI_INVERTER ? CUT_INVERTER : CUT_BOOST_CONVERTER;
+    memcpy(job->header.version, version, sizeof(job->header.version));
+    job->header.size = padded;
+    job->header.crc = EVERT_CCU_UPDATE_Crc32(app, padded);
+    job->header.header_crc = EVERT_CCU_UPDATE_Crc32(&job->header, offsetof(EVERT_CCU_UPDATE_HeaderTypeDef, header_crc));
+    memcpy(stream, &job->header, sizeof(job->header));
+
+    job->phase = CUP_PENDING;
+    job->device_id = device_id;
+    job->stream = stream;
+    job->size = sizeof(EVERT_CCU_UPDATE_HeaderTypeDef) + padded;
+    job->power = NAN;
+
+    return true;
+}
+
+/// @brief EVERT_CCU_UPDATE_Add with the application binary of a file (objcopy -O binary)
+bool EVERT_CCU_UPDATE_Load(const uint8_t device_id, const char *path, const uint8_t version[3])
+{
+    FILE *file = fopen(path, "rb");
+
+    if (file == NULL)
+    {
+        perror("CCU: update image");
+        return false;
+    }
+
+    bool loaded = false;
+    long size = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+
+    if (size > 0 && size <= (long)EVERT_CCU_UPDATE_APP_SIZE_MAX && fseek(file, 0, SEEK_SET) == 0)
+    {
+        uint8_t *application = malloc((size_t)size);
+
+        if (application != NULL && fread(application, 1, (size_t)size, file) == (size_t)size)
+        {
+            loaded = EVERT_CCU_UPDATE_Add(device_id, application, (uint32_t)size, version);
+        }
+
+        free(application);
+    }
+    else
+    {
+        fprintf(stderr, "CCU: update image %s empty or larger than the slot (%u bytes)\n", path, EVERT_CCU_UPDATE_APP_SIZE_MAX);
+    }
+
+    fclose(file);
+
+    return loaded;
+}
+
+/// @brief BCCM_UPDATE_STATUS of the device being updated
+void EVERT_CCU_UPDATE_OnFrame(const EVERT_CCU_FrameTypeDef *frame)
+{
+    if (update.active == 0 || frame->identifier.source_id != update.active || frame->length < 7 || frame->data[0] != BCCM_UPDATE_STATUS)
+    {
+        return;
+    }
+
+    EVERT_CCU_UPDATE_JobTypeDef *job = &update.jobs[update.active];
+    uint64_t now_us = frame->timestamp_us;
+    uint32_t received;
+
+    memcpy(&received, &frame->data[3], sizeof(received));
+
+    job->state = (EVERT_CCU_UpdateStateTypeDef)frame->data[1];
+    job->result = (EVERT_CCU_UpdateResultTypeDef)frame->data[2];
+    job->answered = true;
+
+    if (job->state == CUS_FAILED && job->phase >= CUP_BEGIN && job->phase <= CUP_END)
+    {
+        EVERT_CCU_UPDATE_Finish(job, CUP_FAILED, "device failed", now_us);
+        return;
+    }
+
+    switch (job->phase)
+    {
+    case CUP_BEGIN:
+        if (job->result != CUR_OK)
+        {
+            EVERT_CCU_UPDATE_Finish(job, CUP_FAILED, "begin refused", now_us);
+        }
+        else if (job->state == CUS_RECEIVING)
+        {
+            EVERT_CCU_UPDATE_SetPhase(job, CUP_SENDING, now_us);
+            job->next = 0;
+            job->acked = 0;
+            job->start_us = now_us;
+            job->sent_us = now_us;
+            job->progress_us = now_us;
+        }
+        break;
+
+    case CUP_SENDING:
+        if (job->state != CUS_RECEIVING || received > job->size)
+        {
+            break;
+        }
+
+        if (received > job->acked)
+        {
+            job->acked = received;
+            job->sent_us = now_us;
+            job->progress_us = now_us;
+            job->retry_count = 0;
+        }
+
+        if (frame->identifier.message_id == EVERT_CCU_UPDATE_STATUS_GAP)
+        {
+            // The blocks in flight past the gap are dropped by the device, the stream goes on from its bytes
+            job->next = received / EVERT_CCU_UPDATE_BLOCK_SIZE;
+            job->progress_us = now_us;
+            job->rewind_count++;
+        }
+
+        if (job->acked == job->size)
+        {
+            EVERT_CCU_UPDATE_SetPhase(job, CUP_END, now_us);
+            EVERT_CCU_UPDATE_SendCommand(job, BCCM_UPDATE_END, now_us);
+        }
+        break;
+
+    case CUP_END:
+        if (job->state == CUS_READY)
+        {
+            // Stopped first, the device refuses to activate while the converter runs
+            const EVERT_CCU_DeviceTypeDef *device = EVERT_CCU_DEVICES_Get(job->device_id);
+
+            EVERT_CCU_UPDATE_SetPhase(job, CUP_ACTIVATE, now_us);
+            job->ack_count = device->ack_count;
+            job->power = EVERT_CCU_DISPATCH_GetPowerSetpoint(job->device_id);
+            job->stopped = true;
+            EVERT_CCU_DISPATCH_SetPowerSetpoint(job->device_id, 0.0f);
+            EVERT_CCU_UPDATE_SendCommand(job, BCCM_UPDATE_ACTIVATE, now_us);
+        }
+        break;
+
+    case CUP_ACTIVATE:
+        // An answer of the new image (an ACTIVATE crossed the reset) is no failure
+        if (job->state == CUS_READY && job->result != CUR_OK && job->result != CUR_REFUSED)
+        {
+            EVERT_CCU_UPDATE_Finish(job, CUP_FAILED, "activate refused", now_us);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+/// @brief Start the next update, send the blocks and the due commands, call from the worker tick
+void EVERT_CCU_UPDATE_Process(const uint64_t now_us)
+{
+    if (update.active == 0)
+    {
+        for (uint8_t id = 1; id < EVERT_CONSTANT_CCU_DEVICE_COUNT; id++)
+        {
+            if (update.jobs[id].phase == CUP_PENDING && EVERT_CCU_DEVICES_IsReady(id))
+            {
+                update.active = id;
+                EVERT_CCU_UPDATE_SetPhase(&update.jobs[id], CUP_BEGIN, now_us);
+                EVERT_CCU_UPDATE_SendCommand(&update.jobs[id], BCCM_UPDATE_BEGIN, now_us);
+                return;
+            }
+        }
+
+        return;
+    }
+
+    EVERT_CCU_UPDATE_JobTypeDef *job = &update.jobs[update.active];
+    const EVERT_CCU_DeviceTypeDef *device = EVERT_CCU_DEVICES_Get(job->device_id);
+    bool command_due = now_us - job->command_us >= (uint64_t)EVERT_SETTING_CCU_UPDATE_COMMAND_TIMEOUT_MS * 1000u;
+    bool boot_timeout = now_us - job->phase_us >= (uint64_t)EVERT_SETTING_CCU_UPDATE_BOOT_TIMEOUT_MS * 1000u;
+
+    switch (job->phase)
+    {
+    case CUP_BEGIN:
+        if (now_us - job->phase_us >= (uint64_t)EVERT_SETTING_CCU_UPDATE_ERASE_TIMEOUT_MS * 1000u)
+        {
+            EVERT_CCU_UPDATE_Finish(job, CUP_FAILED, "erase timeout", now_us);
+        }
+        else if (!job->answered && command_due && EVERT_CCU_UPDATE_Retry(job, "no answer to begin", now_us))
+        {
+            EVERT_CCU_UPDATE_SendCommand(job, BCCM_UPDATE_BEGIN, now_us); // Not again once answered, it would erase again
+        }
+        break;
+
+    case CUP_SENDING:
+        EVERT_CCU_UPDATE_SendBlocks(job, now_us);
+        break;
+
+    case CUP_END:
+        if (!job->answered && command_due && EVERT_CCU_UPDATE_Retry(job, "no answer to end", now_us))
+        {
+            EVERT_CCU_UPDATE_SendCommand(job, BCCM_UPDATE_END, now_us);
+        }
+        break;
+
+    case CUP_ACTIVATE:
+        if (device->ack_count != job->ack_count)
+        {
+            // Handshake again: reset into the new image (or back in the old one, the version tells)
+            job->phase = CUP_REBOOTING;
+        }
+        else if (boot_timeout)
+        {
+            EVERT_CCU_UPDATE_Finish(job, CUP_FAILED, "not activated", now_us);
+        }
+        else if (command_due && EVERT_CCU_DEVICES_IsReady(job->device_id))
+        {
+            EVERT_CCU_UPDATE_SendCommand(job, BCCM_UPDATE_ACTIVATE, now_us); // Refused until the converter is in standby
+        }
+        break;
+
+    case CUP_REBOOTING:
+        if (device->online && (device->internal == DS_OPERATIONAL || device->internal == DS_OPERATIONAL_WARNING))
+        {
+            bool updated = memcmp(device->version, job->header.version, sizeof(device->version)) == 0;
+            EVERT_CCU_UPDATE_Finish(job, updated ? CUP_DONE : CUP_FAILED, updated ? NULL : "old version running", now_us);
+        }
+        else if (boot_timeout)
+        {
+            EVERT_CCU_UPDATE_Finish(job, CUP_FAILED, "not back", now_us);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+void EVERT_CCU_UPDATE_Print(FILE *file)
+{
+    for (uint8_t id = 1; id < EVERT_CONSTANT_CCU_DEVICE_COUNT; id++)
+    {
+        const EVERT_CCU_UPDATE_JobTypeDef *job = &update.jobs[id];
+
+        if (job->phase == CUP_NONE)
+        {
+            continue;
+        }
+
+        uint64_t elapsed_us = job->sent_us - job->start_us;
+        double rate = elapsed_us > 0 ? (double)job->acked * 1000.0 / (double)elapsed_us : 0.0; // kB/s
+
+        fprintf(file, "CCU: update device %u to %u.%u.%u: %s%s%s, %u/%u bytes, %.2f kB/s, %" PRIu64 " blocks, %u rewinds, %u timeouts\n",
+                id, job->header.version[0], job->header.version[1], job->header.version[2], phase_names[job->phase],
+                job->error != NULL ? " - " : "", job->error != NULL ? job->error : "",
+                job->acked, job->size, rate, job->block_count, job->rewind_count, job->timeout_count);
+    }
+}
+
+/// @brief Update of a device, NULL if none was added
+const EVERT_CCU_UPDATE_JobTypeDef *EVERT_CCU_UPDATE_Get(const uint8_t device_id)
+{
+    if (device_id >= EVERT_CONSTANT_CCU_DEVICE_COUNT || update.jobs[device_id].phase == CUP_NONE)
+    {
+        return NULL;
+    }
+
+    return &update.jobs[device_id];
+}
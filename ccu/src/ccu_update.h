@@ -0,0 +1,119 @@
+/**
+ ******************************************************************************
+ * @file    ccu_update.h
+ * @author  Evert Firmware Team
+ * @brief   Firmware update of the devices over CAN (boost_converter_update.h, libs/core/src/firmware_update.h)
+ *          * Image: the application binary (.bin linked at 0x08004800), padded to a double word with 0xFF; the
+ *            stream is the image header (EVERT_CCU_UPDATE_HeaderTypeDef) followed by the application bytes
+ *          * One update at a time, the others wait in order of device id:
+ *              1. BCCM_UPDATE_BEGIN, the device erases its other bank and answers FUS_ERASING, then FUS_RECEIVING
+ *              2. BCCM_UPDATE_DATA, 6 stream bytes per block, message id = block index bits 0-7. Go-back-N: up to
+ *                 EVERT_SETTING_CCU_UPDATE_WINDOW blocks past the acknowledged bytes, EVERT_SETTING_CCU_UPDATE_BUS_SHARE
+ *                 of the bitrate at the lowest priority, so the control traffic always wins the arbitration.
+ *                 A gap report (message id EVERT_CCU_UPDATE_STATUS_GAP) goes back to the bytes the device took,
+ *                 no progress for EVERT_SETTING_CCU_UPDATE_ACK_TIMEOUT_MS goes back to the acknowledged bytes
+ *              3. BCCM_UPDATE_END, the device checks the image and answers FUS_READY
+ *              4. Setpoint 0 (ccu_dispatch.h), BCCM_UPDATE_ACTIVATE until the converter is in standby and resets
+ *              5. Done once the device is operational again with the new version (it confirms the image then),
+ *                 the setpoint it had is restored
+ *          * BEGIN, END and ACTIVATE go again after EVERT_SETTING_CCU_UPDATE_COMMAND_TIMEOUT_MS without an answer
+ *          * Worker thread only
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_CCU_UPDATE_H_
+#define EVERT_CCU_UPDATE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "_conf_evert_ccu.h"
+#include "ccu_protocol.h"
+
+#define EVERT_CCU_UPDATE_BLOCK_SIZE (6)         // Stream bytes per BCCM_UPDATE_DATA
+#define EVERT_CCU_UPDATE_MAGIC (0x57465645u)    // "EVFW"
+#define EVERT_CCU_UPDATE_HEADER_VERSION (1)
+#define EVERT_CCU_UPDATE_APP_SIZE_MAX (0x38800u) // Application slot (226 kB)
+
+/// @brief Mirrors EVERT_FIRMWARE_IMAGE_TargetTypeDef (firmware_image.h)
+typedef enum
+{
+    CUT_BOOST_CONVERTER = 1,
+    CUT_INVERTER = 2
+} EVERT_CCU_UpdateTargetTypeDef;
+
+/// @brief Mirrors EVERT_FIRMWARE_IMAGE_HeaderTypeDef (firmware_image.h)
+typedef struct
+{
+    uint32_t magic;
+    uint8_t header_version;
+    uint8_t target;
+    uint8_t version[3];
+    uint8_t reserved[3];
+    uint32_t size;       // Application bytes, a multiple of 8
+    uint32_t crc;        // CRC-32 (IEEE 802.3) of the application bytes
+    uint32_t header_crc; // CRC-32 of the fields above
+} EVERT_CCU_UPDATE_HeaderTypeDef;
+
+_Static_assert(sizeof(EVERT_CCU_UPDATE_HeaderTypeDef) == 24, "Header must match firmware_image.h");
+
+typedef enum
+{
+    CUP_NONE = 0,
+    CUP_PENDING = 1,    // Waiting for the device or for the update before it
+    CUP_BEGIN = 2,      // BCCM_UPDATE_BEGIN sent, the device erases
+    CUP_SENDING = 3,    // Blocks
+    CUP_END = 4,        // BCCM_UPDATE_END sent, the device checks the image
+    CUP_ACTIVATE = 5,   // Stopped, BCCM_UPDATE_ACTIVATE until the device resets
+    CUP_REBOOTING = 6,  // Waiting for the new version
+    CUP_DONE = 7,
+    CUP_FAILED = 8
+} EVERT_CCU_UpdatePhaseTypeDef;
+
+typedef struct
+{
+    EVERT_CCU_UpdatePhaseTypeDef phase;
+    uint8_t device_id;
+    uint8_t *stream; // Header, then the application
+    uint32_t size;   // Stream bytes
+    EVERT_CCU_UPDATE_HeaderTypeDef header;
+
+    // Device
+    EVERT_CCU_UpdateStateTypeDef state;   // Last BCCM_UPDATE_STATUS
+    EVERT_CCU_UpdateResultTypeDef result; // Of the last command
+    bool answered;                        // A status came since the last command
+    uint32_t ack_count;                   // Handshakes of the device before the activation
+
+    // Stream
+    uint32_t next;  // Next block to send
+    uint32_t acked; // Stream bytes the device took
+
+    // Timing
+    uint64_t phase_us;    // Phase entered
+    uint64_t command_us;  // Last BEGIN, END or ACTIVATE
+    uint64_t progress_us; // Last progress of acked (or rewind)
+    uint64_t start_us;    // First block
+    uint64_t sent_us;     // Last block acknowledged
+    uint32_t retry_count; // Timeouts in a row
+
+    // Setpoint to restore
+    float power;
+    bool stopped;
+
+    const char *error; // Why the update failed
+
+    // Statistics
+    uint64_t block_count;  // Blocks sent, repeats included
+    uint32_t rewind_count; // Gap reports
+    uint32_t timeout_count;
+} EVERT_CCU_UPDATE_JobTypeDef;
+
+void EVERT_CCU_UPDATE_Init(const uint32_t bitrate);
+bool EVERT_CCU_UPDATE_Add(const uint8_t device_id, const uint8_t *application, const uint32_t size, const uint8_t version[3]);
+bool EVERT_CCU_UPDATE_Load(const uint8_t device_id, const char *path, const uint8_t version[3]);
+void EVERT_CCU_UPDATE_OnFrame(const EVERT_CCU_FrameTypeDef *frame);
+void EVERT_CCU_UPDATE_Process(const uint64_t now_us);
+void EVERT_CCU_UPDATE_Print(FILE *file);
+const EVERT_CCU_UPDATE_JobTypeDef *EVERT_CCU_UPDATE_Get(const uint8_t device_id);
+
+#endif // EVERT_CCU_UPDATE_H_
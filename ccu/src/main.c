@@ -0,0 +1,221 @@
+/**
+ ******************************************************************************
+ * @file    main.c
+ * @author  Evert Firmware Team
+ * @brief   Entry point of the CCU service
+ *          evert_ccu [-i interface] [-c] [-o] [-x W] [-s device=W]... [-u device:variable:period]...
+ *                    [-f device=file.bin:major.minor.patch]... [-e file.csv]
+ *
+ ******************************************************************************
+ **/
+
+#include <getopt.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ccu.h"
+#include "ccu_dispatch.h"
+#include "ccu_update.h"
+
+static void EVERT_CCU_OnSignal(int signal)
+{
+    (void)signal;
+    EVERT_CCU_Stop();
+}
+
+static void EVERT_CCU_Usage(const char *program)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -i, --interface NAME       CAN interface (default " EVERT_SETTING_CCU_INTERFACE ")\n"
+            "  -c, --commands             Read commands from stdin (setpoint, optimize, limit, reset, state, subscribe, update, status, export, quit)\n"
+            "  -o, --optimize             Plant-level dispatch of the boost converters (ccu_optimizer.h)\n"
+            "  -x, --export-limit W       Export limit at the grid connection for the optimizer\n"
+            "  -s, --setpoint ID=W        Power setpoint of a device, 'off' releases it\n"
+            "  -u, --subscribe ID:VAR:MS  Subscribe to a registry variable on every handshake (ID 0: every device)\n"
+            "  -f, --update ID=FILE:VER   Firmware update of a device once it is online, FILE the application .bin,\n"
+            "                             VER the major.minor.patch it reports (ccu_update.h)\n"
+            "  -e, --export FILE          Write the time-series store as CSV on exit\n",
+            program);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option options[] = {
+        {"interface", required_argument, NULL, 'i'},
+        {"commands", no_argument, NULL, 'c'},
+        {"optimize", no_argument, NULL, 'o'},
+        {"export-limit", required_argument, NULL, 'x'},
+        {"setpoint", required_argument, NULL, 's'},
+        {"subscribe", required_argument, NULL, 'u'},
+        {"update", required_argument, NULL, 'f'},
+        {"export", required_argument, NULL, 'e'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}};
+
+    const char *interface = EVERT_SETTING_CCU_INTERFACE;
+    const char *export_path = NULL;
+    bool commands = false;
+    bool optimize = false;
+    float export_limit = NAN;
+
+    // Setpoints, subscriptions and updates are applied after the init
+    char *setpoints[EVERT_CONSTANT_CCU_DEVICE_COUNT];
+    char *subscriptions[EVERT_CCU_SUBSCRIPTION_COUNT];
+    char *updates[EVERT_CONSTANT_CCU_DEVICE_COUNT];
+    uint32_t setpoint_count = 0;
+    uint32_t subscription_count = 0;
+    uint32_t update_count = 0;
+    int option;
+
+    while ((option = getopt_long(argc, argv, "i:cox:s:u:f:e:h", options, NULL)) != -1)
+    {
+        switch (option)
+        {
+        case 'i':
+            interface = optarg;
+            break;
+
+        case 'c':
+            commands = true;
+            break;
+
+        case 'o':
+            optimize = true;
+            break;
+
+        case 'x':
+            export_limit = strtof(optarg, NULL);
+            break;
+
+        case 's':
+            if (setpoint_count < EVERT_CONSTANT_CCU_DEVICE_COUNT)
+            {
+                setpoints[setpoint_count++] = optarg;
+            }
+            break;
+
+        case 'u':
+            if (subscription_count < EVERT_CCU_SUBSCRIPTION_COUNT)
+            {
+                subscriptions[subscription_count++] = optarg;
+            }
+            break;
+
+        case 'f':
+            if (update_count < EVERT_CONSTANT_CCU_DEVICE_COUNT)
+            {
+                updates[update_count++] = optarg;
+            }
+            break;
+
+        case 'e':
+            export_path = optarg;
+            break;
+
+        default:
+            EVERT_CCU_Usage(argv[0]);
+            return option == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (!EVERT_CCU_Init(interface, commands))
+    {
+        EVERT_CCU_Deinit();
+        return EXIT_FAILURE;
+    }
+
+    EVERT_CCU_DISPATCH_SetOptimizer(optimize);
+
+    if (!isnan(export_limit))
+    {
+        EVERT_CCU_DISPATCH_SetExportLimit(export_limit);
+    }
+
+    for (uint32_t i = 0; i < setpoint_count; i++)
+    {
+        char *separator = strchr(setpoints[i], '=');
+
+        if (separator == NULL)
+        {
+            fprintf(stderr, "CCU: setpoint %s is not ID=W\n", setpoints[i]);
+            continue;
+        }
+
+        float power = strcmp(separator + 1, "off") == 0 ? NAN : strtof(separator + 1, NULL);
+        EVERT_CCU_DISPATCH_SetPowerSetpoint((uint8_t)strtoul(setpoints[i], NULL, 0), power);
+    }
+
+    for (uint32_t i = 0; i < subscription_count; i++)
+    {
+        unsigned device_id, period_ms;
+        int variable_id;
+
+        if (sscanf(subscriptions[i], "%u:%i:%u", &device_id, &variable_id, &period_ms) != 3)
+        {
+            fprintf(stderr, "CCU: subscription %s is not ID:VAR:MS\n", subscriptions[i]);
+            continue;
+        }
+
+        EVERT_CCU_AddSubscription((uint8_t)device_id, (uint16_t)variable_id, (uint16_t)period_ms);
+    }
+
+    for (uint32_t i = 0; i < update_count; i++)
+    {
+        char *separator = strchr(updates[i], '=');
+        char *version_separator = strrchr(updates[i], ':');
+        unsigned version[3];
+
+        if (separator == NULL || version_separator == NULL || version_separator < separator ||
+            sscanf(version_separator + 1, "%u.%u.%u", &version[0], &version[1], &version[2]) != 3)
+        {
+            fprintf(stderr, "CCU: update %s is not ID=FILE:MAJOR.MINOR.PATCH\n", updates[i]);
+            continue;
+        }
+
+        *version_separator = '\0';
+
+        if (!EVERT_CCU_UPDATE_Load((uint8_t)strtoul(updates[i], NULL, 0), separator + 1, (uint8_t[3]){version[0], version[1], version[2]}))
+        {
+            fprintf(stderr, "CCU: update of device %s not queued\n", updates[i]);
+        }
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = EVERT_CCU_OnSignal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    if (!EVERT_CCU_Start())
+    {
+        EVERT_CCU_Deinit();
+        return EXIT_FAILURE;
+    }
+
+    fprintf(stderr, "CCU: running on %s\n", interface);
+
+    EVERT_CCU_Join();
+    EVERT_CCU_PrintStatus(stderr);
+
+    if (export_path != NULL)
+    {
+        FILE *file = fopen(export_path, "w");
+
+        if (file != NULL)
+        {
+            EVERT_CCU_TIMESERIES_ExportCsv(&ccu.timeseries, file);
+            fclose(file);
+        }
+        else
+        {
+            perror("CCU: export");
+        }
+    }
+
+    EVERT_CCU_Deinit();
+
+    return EXIT_SUCCESS;
+}
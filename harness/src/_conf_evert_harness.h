@@ -0,0 +1,39 @@
+#ifndef EVERT_HARNESS_CONF_
+#define EVERT_HARNESS_CONF_
+
+// Constants (harness build specific)
+#define EVERT_CONSTANT_HARNESS_NODE_COUNT (3)          // Device firmware nodes: boost converter 1, 2, inverter
+#define EVERT_CONSTANT_HARNESS_STATION_COUNT (EVERT_CONSTANT_HARNESS_NODE_COUNT + 1) // Nodes and the CCU on the bus
+#define EVERT_CONSTANT_HARNESS_QUEUE_SIZE (64)         // Frames per station, transmit and delivered, power of 2
+#define EVERT_CONSTANT_HARNESS_CCU_TX_DEPTH (10)       // SocketCAN txqueuelen of the CCU interface
+#define EVERT_CONSTANT_HARNESS_CAN_BUFFER_SIZE (16)    // EVERT_CONSTRAINT_CAN_BUFFER_SIZE of the boost converter
+#define EVERT_CONSTANT_HARNESS_STEP_RX_MAX (32)        // Frames handed to a node per step, the rest waits a step
+#define EVERT_CONSTANT_HARNESS_STEP_EVENT_MAX (32)     // Node events per step
+#define EVERT_CONSTANT_HARNESS_LOOP_PASSES (64)        // Main loop passes of a node per step at most
+#define EVERT_CONSTANT_HARNESS_LOAD_WINDOW_MS (100)    // Bus load window
+#define EVERT_CONSTANT_HARNESS_LATENCY_SAMPLES (4096)  // Command latencies kept per run
+#define EVERT_CONSTANT_HARNESS_PENDING_COMMANDS (16)   // Commands in flight per node and method
+#define EVERT_CONSTANT_HARNESS_ACTION_MAX (16)          // Actions of a scenario
+
+// Settings (command line)
+#define EVERT_SETTING_HARNESS_BITRATE (500000)  // bit/s, fdcan.c: HSE 24 MHz / 3 / 16 tq
+#define EVERT_SETTING_HARNESS_LATENCY_US (0)    // End of frame to the receiving node (gateway, driver)
+#define EVERT_SETTING_HARNESS_LOSS (0.0)        // Probability a receiver misses a frame
+#define EVERT_SETTING_HARNESS_DURATION_S (30)   // Virtual time of a scenario
+#define EVERT_SETTING_HARNESS_SEED (1)
+
+// Constraints (checks of a run)
+#define EVERT_CONSTRAINT_HARNESS_BOOT_ADC_MAX_MS (20)          // DS_BOOTING_ADC, the readings settled (5.1 ms of samples)
+#define EVERT_CONSTRAINT_HARNESS_HANDSHAKE_MARGIN_MS (500)     // Power on to acknowledged: ADC boot max + this, the first announcement goes out at once
+#define EVERT_CONSTRAINT_HARNESS_LOAD_PEAK_MAX (0.5)           // Busiest load window
+#define EVERT_CONSTRAINT_HARNESS_LOAD_AVERAGE_MAX (0.2)
+#define EVERT_CONSTRAINT_HARNESS_COMMAND_LATENCY_MAX_MS (5.0)  // CCU queued the command to the device applied it, 99th percentile
+#define EVERT_CONSTRAINT_HARNESS_TIME_SYNC_LOCK_MS (5000)      // Power on to locked, the handshake comes first
+#define EVERT_CONSTRAINT_HARNESS_TIME_SYNC_ERROR_US (10)       // Synchronized time of a locked boost converter against the CCU
+#define EVERT_CONSTRAINT_HARNESS_SETTLE_MS (1500)              // Setpoint or export limit to the power held, sampled from then to the next change
+#define EVERT_CONSTRAINT_HARNESS_SETPOINT_TOLERANCE (0.05f)    // Of the setpoint, the power of the boost converter
+#define EVERT_CONSTRAINT_HARNESS_EXPORT_TOLERANCE (0.02f)      // Above the export limit, the plant power through the inverter efficiency
+#define EVERT_CONSTRAINT_HARNESS_EXPORT_FLOOR (0.85f)          // Of the export limit, the plant does not curtail further
+#define EVERT_CONSTRAINT_HARNESS_BATCH_TARGET_ERROR (1.0f)     // W, per-slot limits of a batch summed against the optimizer target, 0.5 W rounding a slot
+
+#endif // EVERT_HARNESS_CONF_
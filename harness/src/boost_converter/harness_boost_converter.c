@@ -0,0 +1,506 @@
+/**
+ ******************************************************************************
+ * @file    harness_boost_converter.c
+ * @author  Evert Firmware Team
+ * @brief   Boost converter node of the harness: the application (boost-converter/src) on the HAL stand-ins
+ *          * Executable of its own, started by the harness with the socket of the node (harness_node.c)
+ *          * Power on: bank 1 holds a confirmed 2.0.0 image as the production programmer leaves it, the
+ *            parameter store the end of line calibration of the ADC channels
+ *          * Before every boot the supervisor does what bootloader.c does with the boot state (bank switch,
+ *            trial boots, rollback), the application then runs from the bank it selected
+ *          * Interrupts as stm32g4xx_it.c and main.c dispatch them: FDCAN1_IT0 per frame, the HF ISR per ADC
+ *            sequence, the LF ISR every 10 ms, the main loop in between
+ *          * Plant: a PV string (single diode) on the input capacitor, the inductor current from the HRTIM
+ *            duty cycle against a bus held by the inverter, averaged over a switching period
+ *          * Commands applied (HNE_COMMAND): the dispatcher (EVERT_CAN_OnMessageReceived) is watched through
+ *            the functions it calls for the frame being processed (--wrap), not copied
+ *
+ ******************************************************************************
+ **/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include "boost_converter.h"
+#include "boost_converter_mppt.h"
+#include "boost_converter_parameters.h"
+#include "boost_converter_readings.h"
+#include "boost_converter_telemetry.h"
+#include "firmware_update.h"
+#include "param_store.h"
+#include "harness_fdcan.h"
+#include "harness_hal.h"
+#include "harness_node.h"
+
+#define EVERT_HARNESS_BC_VERSION_MAJOR (2) // Of the image programmed at the power on
+#define EVERT_HARNESS_BC_VERSION_MINOR (0)
+#define EVERT_HARNESS_BC_VERSION_PATCH (0)
+#define EVERT_HARNESS_BC_APP_SIZE (1024) // Bytes of that image, the vector table first
+
+// End of line calibration: full scale of the 12 bit channels
+#define EVERT_HARNESS_BC_CURRENT_IN_FULL_SCALE (20.0f)   // A
+#define EVERT_HARNESS_BC_VOLTAGE_IN_FULL_SCALE (300.0f)  // V
+#define EVERT_HARNESS_BC_VOLTAGE_OUT_FULL_SCALE (1000.0f) // V
+#define EVERT_HARNESS_BC_ADC_MCU_TEMPERATURE (955)        // ~35 °C
+#define EVERT_HARNESS_BC_ADC_MCU_VREF_INT (1504)          // 1.212 V at 3.3 V
+
+// Plant
+#define EVERT_HARNESS_BC_PV_OPEN_CIRCUIT (215.0f) // V, below the high warning of the input voltage
+#define EVERT_HARNESS_BC_PV_THERMAL (8.0f)        // V, diode ideality times the thermal voltage of the string
+#define EVERT_HARNESS_BC_INDUCTANCE (2.2e-3f)     // H
+#define EVERT_HARNESS_BC_CAPACITANCE_IN (470e-6f) // F
+#define EVERT_HARNESS_BC_BUS_VOLTAGE (750.0f)     // V, held by the inverter
+#define EVERT_HARNESS_BC_PLANT_SUBSTEPS (10)      // Per HF tick of 100 µs
+
+#define EVERT_HARNESS_BC_NO_METHOD (0xFFFFFFFFu)
+
+typedef struct
+{
+    EVERT_HARNESS_NODE_ConfigTypeDef config;
+    EVERT_DEVICE_StateTypeDef state; // Last reported with HNE_STATE
+    uint32_t noise;                  // xorshift32 state of the ADC noise
+
+    // Plant
+    float pv_saturation; // A, diode saturation current of the string
+    float pv_short_circuit;
+    float voltage_in; // V, input capacitor
+    float current_in; // A, inductor
+
+    // Frame in the dispatcher
+    uint32_t method;
+} EVERT_HARNESS_BC_TypeDef;
+
+static EVERT_HARNESS_BC_TypeDef harness_bc = {.method = EVERT_HARNESS_BC_NO_METHOD};
+
+extern EVERT_CAN_HandlerTypeDef can_handler;
+
+// The dispatcher of boost_converter.c calls these for the frame it handles
+EVERT_CAN_ProcessBufferStatusTypeDef __real_EVERT_CAN_Handler_ProcessRxBuffer(EVERT_CAN_HandlerTypeDef *handler);
+void __real_EVERT_BOOST_CONVERTER_MpptSetPowerLimit(const float32_t power_limit);
+void __real_EVERT_BOOST_CONVERTER_MpptDispatch(const float32_t power_limit);
+void __real_EVERT_DEVICE_PostEvent(const EVERT_DEVICE_EventTypeDef event);
+
+//
+// #region "Plant"
+//
+
+/// @brief PV string current at the terminal voltage
+static float EVERT_HARNESS_BC_PvCurrent(const float voltage)
+{
+    return harness_bc.pv_short_circuit - harness_bc.pv_saturation * (expf(voltage / EVERT_HARNESS_BC_PV_THERMAL) - 1.0f);
+}
+
+/// @brief String sized to give the available power of the node at its maximum power point, every boot starts open circuit
+static void EVERT_HARNESS_BC_PlantInit(const float available_power)
+{
+    harness_bc.pv_short_circuit = 1.0f;
+    harness_bc.pv_saturation = 1.0f / (expf(EVERT_HARNESS_BC_PV_OPEN_CIRCUIT / EVERT_HARNESS_BC_PV_THERMAL) - 1.0f);
+
+    float maximum_power = 0.0f;
+
+    for (float voltage = 0.0f; voltage < EVERT_HARNESS_BC_PV_OPEN_CIRCUIT; voltage += 0.1f)
+    {
+        maximum_power = fmaxf(maximum_power, voltage * EVERT_HARNESS_BC_PvCurrent(voltage));
+    }
+
+    harness_bc.pv_short_circuit = available_power / maximum_power;
+    harness_bc.pv_saturation *= harness_bc.pv_short_circuit;
+    harness_bc.voltage_in = EVERT_HARNESS_BC_PV_OPEN_CIRCUIT;
+    harness_bc.current_in = 0.0f;
+}
+
+/// @brief One HF period of the averaged boost stage, the diode blocks a negative inductor current
+static void EVERT_HARNESS_BC_PlantStep(void)
+{
+    const float dt = EVERT_CONSTANT_BC_ISR_HF_PERIOD / EVERT_HARNESS_BC_PLANT_SUBSTEPS;
+    float duty_cycle = EVERT_HARNESS_HAL_DutyCycle();
+
+    for (uint32_t i = 0; i < EVERT_HARNESS_BC_PLANT_SUBSTEPS; i++)
+    {
+        harness_bc.current_in += (harness_bc.voltage_in - (1.0f - duty_cycle) * EVERT_HARNESS_BC_BUS_VOLTAGE) * dt / EVERT_HARNESS_BC_INDUCTANCE;
+        harness_bc.current_in = fmaxf(harness_bc.current_in, 0.0f);
+
+        harness_bc.voltage_in += (EVERT_HARNESS_BC_PvCurrent(harness_bc.voltage_in) - harness_bc.current_in) * dt / EVERT_HARNESS_BC_CAPACITANCE_IN;
+        harness_bc.voltage_in = fmaxf(harness_bc.voltage_in, 0.0f);
+    }
+}
+
+/// @brief 12 bit conversion of a value over the channel's full scale, +-1 count of noise
+static uint16_t EVERT_HARNESS_BC_AdcCounts(const float value, const float full_scale)
+{
+    uint32_t x = harness_bc.noise;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    harness_bc.noise = x;
+
+    float counts = roundf(value * 4095.0f / full_scale) + (float)(x % 3u) - 1.0f;
+
+    return (uint16_t)fminf(fmaxf(counts, 0.0f), 4095.0f);
+}
+
+//
+// #endregion "Plant"
+//
+
+//
+// #region "Supervisor"
+//
+
+/// @brief Application image as the production programmer writes it to bank 1: bootloader, application, header, confirmed
+static bool EVERT_HARNESS_BC_ProgramImage(void)
+{
+    static const char bootloader[] = "EVERT BOOTLOADER";
+    uint8_t app[EVERT_HARNESS_BC_APP_SIZE];
+    uint32_t x = 0x9E3779B9u;
+
+    for (uint32_t i = 0; i < sizeof(app); i++)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        app[i] = (uint8_t)x;
+    }
+
+    // Vector table: top of the RAM, the reset handler in the application (Thumb)
+    const uint32_t vectors[2] = {EVERT_FIRMWARE_IMAGE_RAM_BASE + EVERT_FIRMWARE_IMAGE_RAM_SIZE, EVERT_FIRMWARE_IMAGE_ACTIVE_BASE + EVERT_FIRMWARE_IMAGE_APP_OFFSET + 1u};
+    memcpy(app, vectors, sizeof(vectors));
+
+    EVERT_FIRMWARE_IMAGE_HeaderTypeDef header = {
+        .magic = EVERT_FIRMWARE_IMAGE_MAGIC,
+        .header_version = EVERT_FIRMWARE_IMAGE_HEADER_VERSION,
+        .target = FIT_BOOST_CONVERTER,
+        .version = {EVERT_HARNESS_BC_VERSION_MAJOR, EVERT_HARNESS_BC_VERSION_MINOR, EVERT_HARNESS_BC_VERSION_PATCH},
+        .size = sizeof(app),
+        .crc = EVERT_CRC32(app, sizeof(app)),
+    };
+    header.header_crc = EVERT_FIRMWARE_IMAGE_HeaderCrc(&header);
+
+    const uint64_t mark = EVERT_FIRMWARE_IMAGE_MARK;
+
+    return EVERT_HARNESS_HAL_FlashWrite(EVERT_FIRMWARE_IMAGE_ACTIVE_BASE, bootloader, sizeof(bootloader)) &&
+           EVERT_HARNESS_HAL_FlashWrite(EVERT_FIRMWARE_IMAGE_ACTIVE_BASE + EVERT_FIRMWARE_IMAGE_APP_OFFSET, app, sizeof(app)) &&
+           EVERT_HARNESS_HAL_FlashWrite(EVERT_FIRMWARE_IMAGE_ACTIVE_BASE + EVERT_FIRMWARE_IMAGE_HEADER_OFFSET, &header, sizeof(header)) &&
+           EVERT_HARNESS_HAL_FlashWrite(EVERT_FIRMWARE_IMAGE_ACTIVE_BASE + EVERT_FIRMWARE_IMAGE_STATE_OFFSET + offsetof(EVERT_FIRMWARE_IMAGE_StateTypeDef, confirmed), &mark, sizeof(mark));
+}
+
+/// @brief End of line calibration into the parameter store, by the store itself in a process of its own
+/// @details The store keeps its state in globals the boots must not inherit
+static bool EVERT_HARNESS_BC_ProgramCalibration(void)
+{
+    fflush(stdout);
+    fflush(stderr);
+
+    pid_t pid = fork();
+    int status = 0;
+
+    if (pid < 0)
+    {
+        perror("HARNESS: fork");
+        return false;
+    }
+
+    if (pid == 0)
+    {
+        bool stored = EVERT_PARAM_STORE_Init() == PSS_OK &&
+                      EVERT_PARAM_STORE_SetFloat(BCPK_CURRENT_IN_SLOPE, EVERT_HARNESS_BC_CURRENT_IN_FULL_SCALE / 4095.0f) == PSS_OK &&
+                      EVERT_PARAM_STORE_SetFloat(BCPK_CURRENT_IN_INTERCEPT, 0.0f) == PSS_OK &&
+                      EVERT_PARAM_STORE_SetFloat(BCPK_VOLTAGE_IN_SLOPE, EVERT_HARNESS_BC_VOLTAGE_IN_FULL_SCALE / 4095.0f) == PSS_OK &&
+                      EVERT_PARAM_STORE_SetFloat(BCPK_VOLTAGE_IN_INTERCEPT, 0.0f) == PSS_OK &&
+                      EVERT_PARAM_STORE_SetFloat(BCPK_VOLTAGE_OUT_SLOPE, EVERT_HARNESS_BC_VOLTAGE_OUT_FULL_SCALE / 4095.0f) == PSS_OK &&
+                      EVERT_PARAM_STORE_SetFloat(BCPK_VOLTAGE_OUT_INTERCEPT, 0.0f) == PSS_OK;
+        _exit(stored ? 0 : 1);
+    }
+
+    return waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+bool EVERT_HARNESS_DEVICE_PowerOn(const EVERT_HARNESS_NODE_ConfigTypeDef *config)
+{
+    harness_bc.config = *config;
+    EVERT_HARNESS_BC_PlantInit(config->available_power);
+
+    if (!EVERT_HARNESS_HAL_PowerOn() || !EVERT_HARNESS_BC_ProgramImage() || !EVERT_HARNESS_BC_ProgramCalibration())
+    {
+        fprintf(stderr, "HARNESS: node %u not programmed\n", config->device_id);
+        return false;
+    }
+
+    return true;
+}
+
+/// @brief Boot state mark of the bank booted from, as the bootloader programs it
+static void EVERT_HARNESS_BC_Mark(const uint64_t *word)
+{
+    const uint64_t mark = EVERT_FIRMWARE_IMAGE_MARK;
+
+    if (!EVERT_FIRMWARE_IMAGE_IsMarked(word))
+    {
+        EVERT_HARNESS_HAL_FlashWrite((uint32_t)(uintptr_t)word, &mark, sizeof(mark));
+    }
+}
+
+/// @brief EVERT_BOOTLOADER_CheckImages of bootloader.c
+/// @return true if it switched the bank, the part resets into the other one
+static bool EVERT_HARNESS_BC_CheckImages(void)
+{
+    const EVERT_FIRMWARE_IMAGE_HeaderTypeDef *header = EVERT_FIRMWARE_IMAGE_Header(EVERT_FIRMWARE_IMAGE_ACTIVE_BASE);
+    const EVERT_FIRMWARE_IMAGE_StateTypeDef *state = EVERT_FIRMWARE_IMAGE_State(EVERT_FIRMWARE_IMAGE_ACTIVE_BASE);
+    const EVERT_FIRMWARE_IMAGE_StateTypeDef *other = EVERT_FIRMWARE_IMAGE_State(EVERT_FIRMWARE_IMAGE_OTHER_BASE);
+
+    if (EVERT_FIRMWARE_IMAGE_IsHeaderValid(EVERT_FIRMWARE_IMAGE_Header(EVERT_FIRMWARE_IMAGE_OTHER_BASE)) &&
+        EVERT_FIRMWARE_IMAGE_HasVectors(EVERT_FIRMWARE_IMAGE_OTHER_BASE) && EVERT_FIRMWARE_IMAGE_IsMarked(&other->activate) &&
+        EVERT_FIRMWARE_IMAGE_AttemptCount(other) == 0 && !EVERT_FIRMWARE_IMAGE_IsMarked(&other->rejected))
+    {
+        return true;
+    }
+
+    if (!EVERT_FIRMWARE_IMAGE_IsHeaderValid(header))
+    {
+        return false;
+    }
+
+    bool confirmed = EVERT_FIRMWARE_IMAGE_IsMarked(&state->confirmed);
+    uint32_t attempts = EVERT_FIRMWARE_IMAGE_AttemptCount(state);
+    bool crc_valid = EVERT_CRC32((const void *)(uintptr_t)(EVERT_FIRMWARE_IMAGE_ACTIVE_BASE + EVERT_FIRMWARE_IMAGE_APP_OFFSET), header->size) == header->crc;
+
+    if (EVERT_FIRMWARE_IMAGE_IsMarked(&state->rejected) || (!confirmed && attempts >= EVERT_FIRMWARE_IMAGE_ATTEMPT_COUNT) || !crc_valid)
+    {
+        EVERT_HARNESS_BC_Mark(&state->rejected);
+
+        return EVERT_FIRMWARE_IMAGE_IsFallback(EVERT_FIRMWARE_IMAGE_OTHER_BASE);
+    }
+
+    if (!confirmed)
+    {
+        EVERT_HARNESS_BC_Mark(&state->attempts[attempts]);
+    }
+
+    return false;
+}
+
+/// @brief The registers of the reset, then the bootloader until it jumps to an application
+/// @return false if no bank holds one
+bool EVERT_HARNESS_DEVICE_Boot(const bool power_on, const EVERT_HARNESS_NODE_ResetTypeDef cause)
+{
+    // Each bank switch is one more reset, bounded by the boot state: an image is activated once
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        if (!EVERT_HARNESS_HAL_Boot(power_on, cause))
+        {
+            return false;
+        }
+
+        if (!EVERT_HARNESS_BC_CheckImages())
+        {
+            if (EVERT_FIRMWARE_IMAGE_HasVectors(EVERT_FIRMWARE_IMAGE_ACTIVE_BASE))
+            {
+                return true;
+            }
+
+            if (!EVERT_FIRMWARE_IMAGE_IsFallback(EVERT_FIRMWARE_IMAGE_OTHER_BASE))
+            {
+                return false;
+            }
+        }
+
+        EVERT_HARNESS_HAL_SwitchBank();
+    }
+
+    return false;
+}
+
+//
+// #endregion "Supervisor"
+//
+
+//
+// #region "Boot"
+//
+
+/// @brief HNE_STATE on every change of the resultant state, the application has no hook of its own for it
+static void EVERT_HARNESS_BC_PollState(void)
+{
+    EVERT_DEVICE_StateTypeDef state = EVERT_DEVICE_State_Get(SS_RESULT);
+
+    if (state != harness_bc.state)
+    {
+        harness_bc.state = state;
+        EVERT_HARNESS_NODE_Event(HNE_STATE, (uint8_t)state);
+    }
+}
+
+/// @brief The peripherals of MX_*_Init, then main.c: EVERT_BOOST_CONVERTER_main
+void EVERT_HARNESS_DEVICE_Init(const EVERT_HARNESS_NODE_ConfigTypeDef *config)
+{
+    harness_bc.state = DS_UNKNOWN;
+    harness_bc.noise = 0x9E3779B9u * (config->device_id + 1u);
+    harness_bc.method = EVERT_HARNESS_BC_NO_METHOD;
+
+    EVERT_HARNESS_HAL_Init(config);
+    EVERT_BOOST_CONVERTER_main();
+    EVERT_HARNESS_BC_PollState();
+}
+
+/// @brief HAL_FDCAN_RxFifo0Callback of main.c
+void EVERT_HARNESS_DEVICE_OnRxFifo0(void)
+{
+    EVERT_INVERTER_FDCAN_RxFifo0Callback(&hfdcan1, FDCAN_IT_RX_FIFO0_NEW_MESSAGE);
+}
+
+/// @brief ADC1 sequence of the plant at this instant, its DMA interrupt, then TIM2 (HF ISR)
+void EVERT_HARNESS_DEVICE_OnHfTick(void)
+{
+    EVERT_HARNESS_BC_PlantStep();
+
+    uint16_t counts[EVERT_CONSTANT_BC_ADC1_CONVERSION_COUNT];
+    counts[EVERT_CONSTANT_BC_ADC1_RANK_MCU_TEMPERATURE] = EVERT_HARNESS_BC_ADC_MCU_TEMPERATURE;
+    counts[EVERT_CONSTANT_BC_ADC1_RANK_MCU_VREF_INT] = EVERT_HARNESS_BC_ADC_MCU_VREF_INT;
+    counts[EVERT_CONSTANT_BC_ADC1_RANK_VOLTAGE_IN] = EVERT_HARNESS_BC_AdcCounts(harness_bc.voltage_in, EVERT_HARNESS_BC_VOLTAGE_IN_FULL_SCALE);
+    counts[EVERT_CONSTANT_BC_ADC1_RANK_VOLTAGE_OUT] = EVERT_HARNESS_BC_AdcCounts(EVERT_HARNESS_BC_BUS_VOLTAGE, EVERT_HARNESS_BC_VOLTAGE_OUT_FULL_SCALE);
+    counts[EVERT_CONSTANT_BC_ADC1_RANK_CURRENT_IN] = EVERT_HARNESS_BC_AdcCounts(harness_bc.current_in, EVERT_HARNESS_BC_CURRENT_IN_FULL_SCALE);
+
+    EVERT_HARNESS_HAL_AdcConvert(counts, EVERT_CONSTANT_BC_ADC1_CONVERSION_COUNT);
+    EVERT_BOOST_CONVERTER_ISR_10KHZ_IRQHandler();
+}
+
+/// @brief TIM3 (LF ISR)
+void EVERT_HARNESS_DEVICE_OnLfTick(void)
+{
+    EVERT_BOOST_CONVERTER_ISR_100HZ_IRQHandler();
+    EVERT_HARNESS_BC_PollState();
+}
+
+/// @brief One pass of the main loop of main.c
+/// @return true while frames wait in the CAN handler buffers and the Tx FIFO takes them
+bool EVERT_HARNESS_DEVICE_Loop(void)
+{
+    EVERT_BOOST_CONVERTER_loop();
+    EVERT_HARNESS_BC_PollState();
+
+    return can_handler.rx_fifo_buffer.count > 0 || (can_handler.tx_fifo_buffer.count > 0 && HAL_FDCAN_GetTxFifoFreeLevel(&hfdcan1) > 0);
+}
+
+/// @brief The watchdogs count the ms down
+void EVERT_HARNESS_DEVICE_OnStepEnd(void)
+{
+    EVERT_HARNESS_HAL_OnStepEnd();
+}
+
+void EVERT_HARNESS_DEVICE_Report(EVERT_HARNESS_NODE_ReportTypeDef *report)
+{
+    const EVERT_FIRMWARE_IMAGE_HeaderTypeDef *header = EVERT_FIRMWARE_IMAGE_Header(EVERT_FIRMWARE_IMAGE_ACTIVE_BASE);
+
+    report->can = can_handler.statistics;
+    report->result_state = (uint8_t)EVERT_DEVICE_State_Get(SS_RESULT);
+    report->alarm_level = (uint8_t)EVERT_DEVICE_Alarm_Check();
+    report->power = fi_power_in;
+    report->power_limit = mppt_state.power_limit;
+    report->time_sync_us = EVERT_TIME_SYNC_Now();
+    report->time_sync_locked = EVERT_TIME_SYNC_IsLocked();
+    report->time_sync_rate_ppb = time_sync.rate_ppb;
+    report->time_sync_step_count = time_sync.step_count;
+    report->telemetry_signal_count = delta_telemetry.signal_count;
+    report->telemetry_sample_count = delta_telemetry.sample_count;
+    report->telemetry_frame_count = delta_telemetry.frame_count;
+    report->telemetry_keyframe_frame_count = delta_telemetry.keyframe_frame_count;
+    report->telemetry_byte_count = delta_telemetry.byte_count;
+    report->update_state = (uint8_t)firmware_update.state;
+    memcpy(report->version, header->version, sizeof(report->version));
+    report->boot = device_boot_timing;
+}
+
+//
+// #endregion "Boot"
+//
+
+//
+// #region "Commands applied"
+//
+
+/// @brief The frame the dispatcher gets next, BCCM_SET_RUNNING seen by the status it writes
+EVERT_CAN_ProcessBufferStatusTypeDef __wrap_EVERT_CAN_Handler_ProcessRxBuffer(EVERT_CAN_HandlerTypeDef *handler)
+{
+    const EVERT_CAN_FifoBufferTypeDef *buffer = &handler->rx_fifo_buffer;
+    const EVERT_CAN_FrameTypeDef *frame = &buffer->buffer[buffer->tail].frame;
+    EVERT_BOOST_CONVERTER_StatusTypeDef status = mppt_state.status;
+
+    harness_bc.method = buffer->count > 0 && frame->data.length > 0 ? frame->data.data[0] : EVERT_HARNESS_BC_NO_METHOD;
+
+    // No status has this value, the dispatcher overwrites it only for a BCCM_SET_RUNNING it applies
+    if (harness_bc.method == BCCM_SET_RUNNING)
+    {
+        mppt_state.status = (EVERT_BOOST_CONVERTER_StatusTypeDef)0xFF;
+    }
+
+    EVERT_CAN_ProcessBufferStatusTypeDef result = __real_EVERT_CAN_Handler_ProcessRxBuffer(handler);
+
+    if (harness_bc.method == BCCM_SET_RUNNING)
+    {
+        if (mppt_state.status == (EVERT_BOOST_CONVERTER_StatusTypeDef)0xFF)
+        {
+            mppt_state.status = status;
+        }
+        else
+        {
+            EVERT_HARNESS_NODE_Event(HNE_COMMAND, BCCM_SET_RUNNING);
+        }
+    }
+
+    harness_bc.method = EVERT_HARNESS_BC_NO_METHOD;
+
+    return result;
+}
+
+void __wrap_EVERT_BOOST_CONVERTER_MpptSetPowerLimit(const float32_t power_limit)
+{
+    __real_EVERT_BOOST_CONVERTER_MpptSetPowerLimit(power_limit);
+
+    if (harness_bc.method == BCCM_POWER_LIMIT)
+    {
+        EVERT_HARNESS_NODE_Event(HNE_COMMAND, BCCM_POWER_LIMIT);
+    }
+}
+
+void __wrap_EVERT_BOOST_CONVERTER_MpptDispatch(const float32_t power_limit)
+{
+    __real_EVERT_BOOST_CONVERTER_MpptDispatch(power_limit);
+
+    if (harness_bc.method == BCCM_POWER_LIMIT_BATCH)
+    {
+        EVERT_HARNESS_NODE_Event(HNE_COMMAND, BCCM_POWER_LIMIT_BATCH);
+    }
+}
+
+void __wrap_EVERT_DEVICE_PostEvent(const EVERT_DEVICE_EventTypeDef event)
+{
+    __real_EVERT_DEVICE_PostEvent(event);
+
+    if (event == DE_RESET && harness_bc.method == BCCM_DEVICE_RESET)
+    {
+        EVERT_HARNESS_NODE_Event(HNE_COMMAND, BCCM_DEVICE_RESET);
+    }
+}
+
+//
+// #endregion "Commands applied"
+//
+
+/// @brief Node executable: argv[1] is the socket of the node, the harness sends the configuration first
+int main(int argc, char **argv)
+{
+    EVERT_HARNESS_NODE_ConfigTypeDef config;
+    int fd = argc == 2 ? atoi(argv[1]) : -1;
+
+    if (fd < 0 || recv(fd, &config, sizeof(config), 0) != (ssize_t)sizeof(config))
+    {
+        fprintf(stderr, "HARNESS: %s <fd>, started by the harness\n", argv[0]);
+        return 2;
+    }
+
+    return EVERT_HARNESS_NODE_Main(fd, &config);
+}
@@ -0,0 +1,667 @@
+/**
+ ******************************************************************************
+ * @file    harness_hal.c
+ * @author  Evert Firmware Team
+ * @brief   Peripherals of a boost converter node behind the HAL stand-ins
+ *
+ ******************************************************************************
+ **/
+
+#define _GNU_SOURCE
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <stm32g4xx_hal.h>
+#include <stm32g4xx_hal_hrtim.h>
+#include <stm32g4xx_ll_iwdg.h>
+#include <stm32g4xx_ll_wwdg.h>
+#include "adc.h"
+#include "debugging.h"
+#include "dma.h"
+#include "fault_record.h"
+#include "fdcan.h"
+#include "hrtim.h"
+#include "tim.h"
+#include "watchdog.h"
+#include "harness_hal.h"
+
+/// @brief Kept over a reset, shared with the supervisor
+typedef struct
+{
+    bool bfb2; // Option byte
+    EVERT_FAULT_RECORD_RetainedTypeDef fault_record_retained;
+} EVERT_HARNESS_HAL_RetainedTypeDef;
+
+typedef struct
+{
+    int flash_fd;
+    uint8_t *banks; // Physical bank 1, then bank 2, writable
+    bool mapped;
+    EVERT_HARNESS_HAL_RetainedTypeDef *retained;
+
+    // Page erase started by FLASH_PageErase
+    bool erase_pending;
+    uint8_t *erase_page;
+    uint32_t erase_tick;
+    uint32_t erase_polls;
+
+    // Watchdogs
+    bool iwdg_enabled;
+    uint32_t iwdg_reload_tick;
+    uint64_t wwdg_elapsed_ns; // Since the last count
+
+    // ADC1 with DMA
+    uint16_t *adc_buffer;
+    uint32_t adc_length;
+} EVERT_HARNESS_HAL_TypeDef;
+
+static EVERT_HARNESS_HAL_TypeDef harness_hal = {.flash_fd = -1};
+
+// Registers
+RCC_TypeDef harness_rcc;
+SYSCFG_TypeDef harness_syscfg;
+DBGMCU_TypeDef harness_dbgmcu;
+IWDG_TypeDef harness_iwdg;
+WWDG_TypeDef harness_wwdg;
+GPIO_TypeDef harness_gpio[7];
+ADC_TypeDef harness_adc[5];
+HRTIM_TypeDef harness_hrtim1;
+SCB_Type harness_scb;
+CoreDebug_Type harness_core_debug;
+static FLASH_TypeDef harness_flash;
+static FDCAN_GlobalTypeDef harness_fdcan1;
+
+// CubeMX handles
+ADC_HandleTypeDef hadc1;
+DMA_HandleTypeDef hdma_adc1;
+FDCAN_HandleTypeDef hfdcan1;
+HRTIM_HandleTypeDef hhrtim1;
+TIM_HandleTypeDef htim2;
+TIM_HandleTypeDef htim3;
+
+//
+// #region "Supervisor"
+//
+
+/// @brief Flash file and the shared memory, erased flash, BFB2 clear
+bool EVERT_HARNESS_HAL_PowerOn(void)
+{
+    harness_hal.flash_fd = memfd_create("evert_flash", 0);
+
+    if (harness_hal.flash_fd < 0 || ftruncate(harness_hal.flash_fd, 2 * FLASH_BANK_SIZE) != 0)
+    {
+        perror("HARNESS: flash");
+        return false;
+    }
+
+    harness_hal.banks = mmap(NULL, 2 * FLASH_BANK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, harness_hal.flash_fd, 0);
+    harness_hal.retained = mmap(NULL, sizeof(*harness_hal.retained), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+    if (harness_hal.banks == MAP_FAILED || harness_hal.retained == MAP_FAILED)
+    {
+        perror("HARNESS: flash");
+        return false;
+    }
+
+    memset(harness_hal.banks, 0xFF, 2 * FLASH_BANK_SIZE);
+    memset(harness_hal.retained, 0, sizeof(*harness_hal.retained));
+
+    return EVERT_HARNESS_HAL_Boot(true, HNX_SOFTWARE);
+}
+
+/// @brief Banks mapped at FLASH_BASE, the registers of the cause, the retained RAM of the boot that ended
+/// @details Runs in the supervisor before the boot is forked: the boot starts with these registers and globals
+bool EVERT_HARNESS_HAL_Boot(const bool power_on, const EVERT_HARNESS_NODE_ResetTypeDef cause)
+{
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        uint32_t bank = i ^ (harness_hal.retained->bfb2 ? 1u : 0u);
+        void *address = (void *)(uintptr_t)(FLASH_BASE + i * FLASH_BANK_SIZE);
+        int flags = MAP_SHARED | (harness_hal.mapped ? MAP_FIXED : MAP_FIXED_NOREPLACE);
+
+        if (mmap(address, FLASH_BANK_SIZE, PROT_READ, flags, harness_hal.flash_fd, (off_t)bank * FLASH_BANK_SIZE) != address)
+        {
+            perror("HARNESS: flash mapping");
+            return false;
+        }
+    }
+
+    harness_hal.mapped = true;
+
+    memset(&harness_rcc, 0, sizeof(harness_rcc));
+    memset(&harness_syscfg, 0, sizeof(harness_syscfg));
+    memset(&harness_flash, 0, sizeof(harness_flash));
+
+    harness_rcc.CR = RCC_CR_HSEON | RCC_CR_HSERDY;
+    harness_syscfg.MEMRMP = harness_hal.retained->bfb2 ? SYSCFG_MEMRMP_FB_MODE : 0u;
+    harness_flash.OPTR = FLASH_OPTR_DBANK | (harness_hal.retained->bfb2 ? FLASH_OPTR_BFB2 : 0u);
+    harness_flash.CR = FLASH_CR_LOCK;
+    harness_flash.ACR = FLASH_ACR_ICEN | FLASH_ACR_DCEN;
+
+    // The reset pin follows every internal reset
+    static const uint32_t reset_flags[] = {
+        [HNX_SOFTWARE] = RCC_CSR_SFTRSTF | RCC_CSR_PINRSTF,
+        [HNX_IWDG] = RCC_CSR_IWDGRSTF | RCC_CSR_PINRSTF,
+        [HNX_WWDG] = RCC_CSR_WWDGRSTF | RCC_CSR_PINRSTF,
+    };
+
+    harness_rcc.CSR = power_on ? RCC_CSR_BORRSTF | RCC_CSR_PINRSTF : reset_flags[cause];
+
+    // SRAM holds garbage at the power on, the record checks reject it
+    if (power_on)
+    {
+        memset(&harness_hal.retained->fault_record_retained, 0xA5, sizeof(harness_hal.retained->fault_record_retained));
+    }
+
+    fault_record_retained = harness_hal.retained->fault_record_retained;
+
+    return true;
+}
+
+/// @brief BFB2 toggled, takes effect with the next EVERT_HARNESS_HAL_Boot (the option byte reload resets)
+void EVERT_HARNESS_HAL_SwitchBank(void)
+{
+    harness_hal.retained->bfb2 = !harness_hal.retained->bfb2;
+}
+
+/// @brief Physical flash behind an address of the current mapping, NULL outside the banks
+static uint8_t *EVERT_HARNESS_HAL_FlashPhysical(const uint32_t address, const uint32_t length)
+{
+    if (address < FLASH_BASE || address - FLASH_BASE + length > 2 * FLASH_BANK_SIZE)
+    {
+        return NULL;
+    }
+
+    uint32_t offset = address - FLASH_BASE;
+    uint32_t bank = (offset / FLASH_BANK_SIZE) ^ (READ_BIT(SYSCFG->MEMRMP, SYSCFG_MEMRMP_FB_MODE) != 0U ? 1u : 0u);
+
+    return harness_hal.banks + bank * FLASH_BANK_SIZE + offset % FLASH_BANK_SIZE;
+}
+
+/// @brief Bytes into the flash as the programmer (SWD) writes them, no erase needed
+bool EVERT_HARNESS_HAL_FlashWrite(const uint32_t address, const void *data, const uint32_t length)
+{
+    uint8_t *physical = EVERT_HARNESS_HAL_FlashPhysical(address, length);
+
+    if (physical == NULL)
+    {
+        return false;
+    }
+
+    memcpy(physical, data, length);
+
+    return true;
+}
+
+//
+// #endregion "Supervisor"
+//
+
+//
+// #region "Flash"
+//
+
+/// @brief The page erase running ends
+static void EVERT_HARNESS_HAL_FlashEraseEnd(void)
+{
+    memset(harness_hal.erase_page, 0xFF, FLASH_PAGE_SIZE);
+    harness_hal.erase_pending = false;
+
+    CLEAR_BIT(harness_flash.CR, FLASH_CR_STRT);
+    CLEAR_BIT(harness_flash.SR, FLASH_SR_BSY);
+    SET_BIT(harness_flash.SR, FLASH_SR_EOP);
+}
+
+FLASH_TypeDef *EVERT_HARNESS_HAL_Flash(void)
+{
+    if (harness_hal.erase_pending &&
+        (HAL_GetTick() - harness_hal.erase_tick >= EVERT_HARNESS_HAL_FLASH_ERASE_MS || ++harness_hal.erase_polls >= EVERT_HARNESS_HAL_FLASH_ERASE_POLLS))
+    {
+        EVERT_HARNESS_HAL_FlashEraseEnd();
+    }
+
+    return &harness_flash;
+}
+
+/// @brief FLASH_WaitForLastOperation of the HAL functions
+static void EVERT_HARNESS_HAL_FlashWait(void)
+{
+    if (harness_hal.erase_pending)
+    {
+        EVERT_HARNESS_HAL_FlashEraseEnd();
+    }
+}
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void)
+{
+    CLEAR_BIT(harness_flash.CR, FLASH_CR_LOCK);
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock(void)
+{
+    SET_BIT(harness_flash.CR, FLASH_CR_LOCK);
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data)
+{
+    EVERT_HARNESS_HAL_FlashWait();
+
+    uint8_t *physical = EVERT_HARNESS_HAL_FlashPhysical(Address, sizeof(Data));
+
+    if (TypeProgram != FLASH_TYPEPROGRAM_DOUBLEWORD || physical == NULL || READ_BIT(harness_flash.CR, FLASH_CR_LOCK) != 0U)
+    {
+        SET_BIT(harness_flash.SR, FLASH_SR_PGSERR);
+        return HAL_ERROR;
+    }
+
+    if (Address % sizeof(Data) != 0)
+    {
+        SET_BIT(harness_flash.SR, FLASH_SR_PGAERR);
+        return HAL_ERROR;
+    }
+
+    uint64_t current;
+    memcpy(&current, physical, sizeof(current));
+
+    // Only erased double words take data, zeros go anywhere
+    if (current != UINT64_MAX && Data != 0)
+    {
+        SET_BIT(harness_flash.SR, FLASH_SR_PROGERR);
+        return HAL_ERROR;
+    }
+
+    memcpy(physical, &Data, sizeof(Data));
+
+    return HAL_OK;
+}
+
+/// @brief Physical page of the bank, NULL if out of range
+static uint8_t *EVERT_HARNESS_HAL_FlashPage(const uint32_t page, const uint32_t banks)
+{
+    if (page >= FLASH_BANK_SIZE / FLASH_PAGE_SIZE || (banks != FLASH_BANK_1 && banks != FLASH_BANK_2))
+    {
+        return NULL;
+    }
+
+    return harness_hal.banks + (banks == FLASH_BANK_2 ? FLASH_BANK_SIZE : 0u) + page * FLASH_PAGE_SIZE;
+}
+
+/// @brief Blocking, the erase is immediate
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError)
+{
+    EVERT_HARNESS_HAL_FlashWait();
+    *PageError = 0xFFFFFFFFU;
+
+    if (READ_BIT(harness_flash.CR, FLASH_CR_LOCK) != 0U || pEraseInit->TypeErase != FLASH_TYPEERASE_PAGES)
+    {
+        SET_BIT(harness_flash.SR, FLASH_SR_WRPERR);
+        return HAL_ERROR;
+    }
+
+    for (uint32_t page = pEraseInit->Page; page < pEraseInit->Page + pEraseInit->NbPages; page++)
+    {
+        uint8_t *physical = EVERT_HARNESS_HAL_FlashPage(page, pEraseInit->Banks);
+
+        if (physical == NULL)
+        {
+            *PageError = page;
+            SET_BIT(harness_flash.SR, FLASH_SR_OPERR);
+            return HAL_ERROR;
+        }
+
+        memset(physical, 0xFF, FLASH_PAGE_SIZE);
+    }
+
+    return HAL_OK;
+}
+
+/// @brief Starts the erase and returns, BSY until it is done (EVERT_HARNESS_HAL_Flash)
+void FLASH_PageErase(uint32_t Page, uint32_t Banks)
+{
+    uint8_t *physical = EVERT_HARNESS_HAL_FlashPage(Page, Banks);
+
+    // A locked control register ignores the start
+    if (READ_BIT(harness_flash.CR, FLASH_CR_LOCK) != 0U)
+    {
+        return;
+    }
+
+    if (physical == NULL)
+    {
+        SET_BIT(harness_flash.SR, FLASH_SR_OPERR);
+        return;
+    }
+
+    MODIFY_REG(harness_flash.CR, FLASH_CR_PNB | FLASH_CR_BKER, (Page << FLASH_CR_PNB_Pos) | (Banks == FLASH_BANK_2 ? FLASH_CR_BKER : 0u));
+    SET_BIT(harness_flash.CR, FLASH_CR_PER | FLASH_CR_STRT);
+    SET_BIT(harness_flash.SR, FLASH_SR_BSY);
+
+    harness_hal.erase_pending = true;
+    harness_hal.erase_page = physical;
+    harness_hal.erase_tick = HAL_GetTick();
+    harness_hal.erase_polls = 0;
+}
+
+//
+// #endregion "Flash"
+//
+
+//
+// #region "Boot"
+//
+
+/// @brief MX_*_Init of the peripherals the application uses, the ID selection pin of the unit
+void EVERT_HARNESS_HAL_Init(const EVERT_HARNESS_NODE_ConfigTypeDef *config)
+{
+    // Bit timing of MX_FDCAN1_Init, 500 kbit/s from the HSE
+    hfdcan1.Instance = &harness_fdcan1;
+    hfdcan1.Init.ClockDivider = FDCAN_CLOCK_DIV1;
+    hfdcan1.Init.NominalPrescaler = 3;
+    hfdcan1.Init.NominalSyncJumpWidth = 1;
+    hfdcan1.Init.NominalTimeSeg1 = 13;
+    hfdcan1.Init.NominalTimeSeg2 = 2;
+
+    hadc1.Instance = ADC1;
+    hadc1.DMA_Handle = &hdma_adc1;
+    hadc1.State = HAL_ADC_STATE_READY;
+    hdma_adc1.State = HAL_DMA_STATE_READY;
+
+    // MX_HRTIM1_Init: master period 65503, timer A 4250 at 170 MHz (40 kHz)
+    hhrtim1.Instance = HRTIM1;
+    HRTIM1->sMasterRegs.MPER = 65503;
+    HRTIM1->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_A].PERxR = 4250;
+
+    // PB5 pulled low on boost converter 1, high on 2
+    GPIOB->IDR = config->device_id == CAN_DEVICE_IDENTIFIER_BOOST_CONVERTER1 ? 0u : GPIO_PIN_5;
+}
+
+/// @brief One conversion sequence of ADC1 into the DMA buffer, then its interrupt
+void EVERT_HARNESS_HAL_AdcConvert(const uint16_t *counts, const uint32_t count)
+{
+    if (harness_hal.adc_buffer == NULL)
+    {
+        return;
+    }
+
+    memcpy(harness_hal.adc_buffer, counts, (count < harness_hal.adc_length ? count : harness_hal.adc_length) * sizeof(uint16_t));
+    HAL_ADC_ConvCpltCallback(&hadc1);
+}
+
+/// @brief Duty cycle of timer A as the output stage sees it, 0 while the output is off
+float EVERT_HARNESS_HAL_DutyCycle(void)
+{
+    const HRTIM_Timerx_TypeDef *timer_a = &HRTIM1->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_A];
+
+    if ((HRTIM1->sCommonRegs.OENR & HRTIM_OUTPUT_TA1) == 0U || (HRTIM1->sCommonRegs.ODISR & HRTIM_OUTPUT_TA1) != 0U ||
+        (HRTIM1->sMasterRegs.MCR & HRTIM_TIMERID_TIMER_A) == 0U || timer_a->PERxR == 0U)
+    {
+        return 0.0f;
+    }
+
+    return timer_a->CMP1xR >= timer_a->PERxR ? 1.0f : (float)timer_a->CMP1xR / (float)timer_a->PERxR;
+}
+
+/// @brief WWDG_IRQHandler of stm32g4xx_it.c
+static void EVERT_HARNESS_HAL_WwdgIrqHandler(void)
+{
+    EVERT_WATCHDOG_OnEarlyWakeup();
+}
+
+/// @brief Retained RAM to the supervisor, then the boot ends
+static __attribute__((noreturn)) void EVERT_HARNESS_HAL_Reset(const EVERT_HARNESS_NODE_ResetTypeDef cause)
+{
+    harness_hal.retained->fault_record_retained = fault_record_retained;
+    EVERT_HARNESS_NODE_Reset(cause);
+}
+
+/// @brief The watchdogs over the ms of the step
+void EVERT_HARNESS_HAL_OnStepEnd(void)
+{
+    // IWDG: LSI 32 kHz, (RLR + 1) counts of the prescaler
+    if (harness_hal.iwdg_enabled)
+    {
+        uint32_t timeout_ms = (harness_iwdg.RLR + 1u) * (4u << harness_iwdg.PR) / 32u;
+
+        if (HAL_GetTick() - harness_hal.iwdg_reload_tick > timeout_ms)
+        {
+            EVERT_HARNESS_HAL_Reset(HNX_IWDG);
+        }
+    }
+
+    // WWDG: PCLK1 / 4096 / 2^WDGTB per count
+    if ((harness_wwdg.CR & WWDG_CR_WDGA) == 0U)
+    {
+        return;
+    }
+
+    uint64_t count_ns = 4096ull * (1u << ((harness_wwdg.CFR & WWDG_CFR_WDGTB) >> 11)) * 1000000000ull / EVERT_HARNESS_HAL_PCLK1;
+    harness_hal.wwdg_elapsed_ns += 1000000u;
+
+    uint32_t counts = (uint32_t)(harness_hal.wwdg_elapsed_ns / count_ns);
+    uint32_t counter = harness_wwdg.CR & WWDG_CR_T;
+    harness_hal.wwdg_elapsed_ns %= count_ns;
+
+    if (counter >= 0x40u + counts)
+    {
+        harness_wwdg.CR = (harness_wwdg.CR & ~WWDG_CR_T) | (counter - counts);
+
+        if (counter > 0x40u && counter - counts == 0x40u && (harness_wwdg.CFR & WWDG_CFR_EWI) != 0U)
+        {
+            harness_wwdg.SR |= WWDG_SR_EWIF;
+            EVERT_HARNESS_HAL_WwdgIrqHandler();
+        }
+
+        return;
+    }
+
+    // Through 0x40 within this ms: the early wakeup, then the reset at 0x3F
+    if (counter > 0x40u && (harness_wwdg.CFR & WWDG_CFR_EWI) != 0U)
+    {
+        harness_wwdg.SR |= WWDG_SR_EWIF;
+        EVERT_HARNESS_HAL_WwdgIrqHandler();
+    }
+
+    EVERT_HARNESS_HAL_Reset(HNX_WWDG);
+}
+
+//
+// #endregion "Boot"
+//
+
+//
+// #region "HAL"
+//
+
+void NVIC_SystemReset(void)
+{
+    EVERT_HARNESS_HAL_Reset(HNX_SOFTWARE);
+}
+
+uint32_t HAL_RCC_GetSysClockFreq(void)
+{
+    return SystemCoreClock;
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority)
+{
+    UNUSED(IRQn);
+    UNUSED(PreemptPriority);
+    UNUSED(SubPriority);
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+    UNUSED(IRQn);
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    return (GPIOx->IDR & GPIO_Pin) != 0U ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    GPIOx->ODR = PinState == GPIO_PIN_SET ? GPIOx->ODR | GPIO_Pin : GPIOx->ODR & ~(uint32_t)GPIO_Pin;
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    GPIOx->ODR ^= GPIO_Pin;
+}
+
+HAL_StatusTypeDef HAL_DMA_RegisterCallback(DMA_HandleTypeDef *hdma, HAL_DMA_CallbackIDTypeDef CallbackID, void (*pCallback)(DMA_HandleTypeDef *_hdma))
+{
+    if (CallbackID != HAL_DMA_XFER_ERROR_CB_ID)
+    {
+        return HAL_ERROR;
+    }
+
+    hdma->XferErrorCallback = pCallback;
+
+    return HAL_OK;
+}
+
+HAL_DMA_StateTypeDef HAL_DMA_GetState(const DMA_HandleTypeDef *hdma)
+{
+    return hdma->State;
+}
+
+uint32_t HAL_DMA_GetError(const DMA_HandleTypeDef *hdma)
+{
+    return hdma->ErrorCode;
+}
+
+HAL_StatusTypeDef ADC_Disable(ADC_HandleTypeDef *hadc)
+{
+    UNUSED(hadc);
+
+    return HAL_OK;
+}
+
+/// @brief The calibration is done at once, the node time stands still within a step
+void LL_ADC_StartCalibration(ADC_TypeDef *ADCx, uint32_t SingleDiff)
+{
+    UNUSED(ADCx);
+    UNUSED(SingleDiff);
+}
+
+uint32_t LL_ADC_IsCalibrationOnGoing(const ADC_TypeDef *ADCx)
+{
+    UNUSED(ADCx);
+
+    return 0;
+}
+
+HAL_StatusTypeDef HAL_ADCEx_Calibration_Start(ADC_HandleTypeDef *hadc, uint32_t SingleDiff)
+{
+    if (ADC_Disable(hadc) != HAL_OK)
+    {
+        return HAL_ERROR;
+    }
+
+    LL_ADC_StartCalibration(hadc->Instance, SingleDiff);
+    ADC_STATE_CLR_SET(hadc->State, HAL_ADC_STATE_REG_BUSY | HAL_ADC_STATE_INJ_BUSY, HAL_ADC_STATE_READY);
+
+    return HAL_OK;
+}
+
+/// @brief Circular DMA into the buffer, every HF tick of the node from now on
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef *hadc, uint32_t *pData, uint32_t Length)
+{
+    if (hadc != &hadc1)
+    {
+        return HAL_ERROR;
+    }
+
+    harness_hal.adc_buffer = (uint16_t *)pData;
+    harness_hal.adc_length = Length;
+    ADC_STATE_CLR_SET(hadc->State, HAL_ADC_STATE_READY, HAL_ADC_STATE_REG_BUSY);
+    hadc->DMA_Handle->State = HAL_DMA_STATE_BUSY;
+
+    return HAL_OK;
+}
+
+uint32_t HAL_ADC_GetError(const ADC_HandleTypeDef *hadc)
+{
+    return hadc->ErrorCode;
+}
+
+/// @brief The node calls the timer ISRs itself
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim)
+{
+    UNUSED(htim);
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_HRTIM_WaveformOutputStart(HRTIM_HandleTypeDef *hhrtim, uint32_t OutputsToStart)
+{
+    hhrtim->Instance->sCommonRegs.OENR |= OutputsToStart;
+    hhrtim->Instance->sCommonRegs.ODISR &= ~OutputsToStart;
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_HRTIM_WaveformCounterStart(HRTIM_HandleTypeDef *hhrtim, uint32_t Timers)
+{
+    hhrtim->Instance->sMasterRegs.MCR |= Timers;
+
+    return HAL_OK;
+}
+
+void LL_IWDG_Enable(IWDG_TypeDef *IWDGx)
+{
+    IWDGx->KR = 0x0000CCCCU;
+    harness_hal.iwdg_enabled = true;
+    harness_hal.iwdg_reload_tick = HAL_GetTick();
+}
+
+void LL_IWDG_ReloadCounter(IWDG_TypeDef *IWDGx)
+{
+    IWDGx->KR = 0x0000AAAAU;
+    harness_hal.iwdg_reload_tick = HAL_GetTick();
+}
+
+void LL_IWDG_EnableWriteAccess(IWDG_TypeDef *IWDGx)
+{
+    IWDGx->KR = 0x00005555U;
+}
+
+void LL_IWDG_SetPrescaler(IWDG_TypeDef *IWDGx, uint32_t Prescaler)
+{
+    IWDGx->PR = Prescaler;
+}
+
+void LL_IWDG_SetReloadCounter(IWDG_TypeDef *IWDGx, uint32_t Counter)
+{
+    IWDGx->RLR = Counter;
+}
+
+uint32_t LL_IWDG_IsReady(const IWDG_TypeDef *IWDGx)
+{
+    return IWDGx->SR == 0U;
+}
+
+// Breakpoints print, the node goes on as the part does once the debugger resumes it
+volatile int break_points = 0;
+
+void EVERT_HAL_BreakPoint(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "HARNESS: breakpoint: ");
+    vfprintf(stderr, format, args);
+    va_end(args);
+
+    break_points++;
+}
+
+//
+// #endregion "HAL"
+//
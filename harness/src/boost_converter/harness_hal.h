@@ -0,0 +1,47 @@
+/**
+ ******************************************************************************
+ * @file    harness_hal.h
+ * @author  Evert Firmware Team
+ * @brief   Peripherals of a boost converter node behind the HAL stand-ins (src/hal/)
+ *          * Flash: the two banks are a memory file, mapped read only at FLASH_BASE in the order the BFB2 option
+ *            bit selects, like the part maps them (SYSCFG_MEMRMP_FB_MODE). Program and erase write through a
+ *            second mapping of the physical banks and fail like the part: locked, unaligned, target not erased
+ *            (zeros excepted). A page erase started with FLASH_PageErase keeps BSY set for
+ *            EVERT_HARNESS_HAL_FLASH_ERASE_MS of node time, or until a busy loop polled it
+ *            EVERT_HARNESS_HAL_FLASH_ERASE_POLLS times (the node time stands still within a step)
+ *          * Kept over a reset in memory shared with the supervisor: the flash, the BFB2 option bit and the
+ *            retained RAM (fault_record_retained, .noinit)
+ *          * Reset flags: RCC->CSR as the part sets them for the cause of the boot
+ *          * IWDG: expires when not reloaded within its timeout of node time, checked at the end of a step
+ *          * WWDG: counts down by the node time at the end of a step, the early wakeup interrupt at 0x40, the reset
+ *            below it. A refresh before the window is not modelled
+ *          * ADC: the node writes the DMA buffer and raises the conversion complete callback each HF tick
+ *          * HRTIM: the registers only, the node reads the duty cycle from them
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_HARNESS_HAL_H_
+#define EVERT_HARNESS_HAL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32g4xx_hal.h>
+#include "harness_node.h"
+
+#define EVERT_HARNESS_HAL_FLASH_ERASE_MS (22)        // Page erase, typical of the datasheet
+#define EVERT_HARNESS_HAL_FLASH_ERASE_POLLS (100000) // FLASH->SR reads of a busy loop that stand for it
+#define EVERT_HARNESS_HAL_PCLK1 (170000000u)
+
+// Supervisor
+bool EVERT_HARNESS_HAL_PowerOn(void);
+bool EVERT_HARNESS_HAL_Boot(const bool power_on, const EVERT_HARNESS_NODE_ResetTypeDef cause);
+void EVERT_HARNESS_HAL_SwitchBank(void);
+bool EVERT_HARNESS_HAL_FlashWrite(const uint32_t address, const void *data, const uint32_t length);
+
+// Boot
+void EVERT_HARNESS_HAL_Init(const EVERT_HARNESS_NODE_ConfigTypeDef *config);
+void EVERT_HARNESS_HAL_AdcConvert(const uint16_t *counts, const uint32_t count);
+float EVERT_HARNESS_HAL_DutyCycle(void);
+void EVERT_HARNESS_HAL_OnStepEnd(void);
+
+#endif // EVERT_HARNESS_HAL_H_
@@ -0,0 +1,10 @@
+/**
+ ******************************************************************************
+ * @file    _conf_evert_device.h
+ * @author  Evert Firmware Team
+ * @brief   Device layer configuration of the harness nodes: the one of the boost converter, so the handshake
+ *          and task timing under test are the ones in the field
+ *
+ ******************************************************************************
+ **/
+#include "../../../boost-converter/src/_conf_evert_device.h"
@@ -0,0 +1,25 @@
+/**
+ ******************************************************************************
+ * @file    _conf_evert_hal.h
+ * @author  Evert Firmware Team
+ * @brief   HAL library configuration of the harness nodes: no flash, RCC or watchdog behind them
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_HAL_CONF_
+#define EVERT_HAL_CONF_
+
+#define __overrides __noopt
+#define __noopt __attribute__((used))
+
+#define EVERT_HAL_CONF_DEBUGGING (0)
+#define EVERT_HAL_CONF_FAULT_RECORD_ENABLE (false)
+#define EVERT_HAL_CONF_REGISTRY_ENABLE (false)
+#define EVERT_HAL_CONF_WATCHDOG_ENABLE (false)
+#define EVERT_HAL_CONF_PARAM_STORE_ENABLE (false)
+#define EVERT_HAL_CONF_FIRMWARE_UPDATE_ENABLE (false)
+#define EVERT_HAL_CONF_TIME_SYNC_ENABLE (true)
+#define EVERT_HAL_CONF_DELTA_TELEMETRY_ENABLE (true)
+#define EVERT_HAL_CONF_DELTA_TELEMETRY_SIGNAL_COUNT (48)
+
+#endif // EVERT_HAL_CONF_
@@ -0,0 +1,16 @@
+/**
+ ******************************************************************************
+ * @file    adc.h
+ * @author  Evert Firmware Team
+ * @brief   Host stand-in for the CubeMX ADC module, the boost converter node fills the DMA buffer of hadc1
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_HARNESS_ADC_H_
+#define EVERT_HARNESS_ADC_H_
+
+#include "stm32g4xx_hal.h"
+
+extern ADC_HandleTypeDef hadc1;
+
+#endif // EVERT_HARNESS_ADC_H_
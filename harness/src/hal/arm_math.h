@@ -0,0 +1,94 @@
+/**
+ ******************************************************************************
+ * @file    arm_math.h
+ * @author  Evert Firmware Team
+ * @brief   Host stand-in for CMSIS-DSP: the float type, the FIR filter the boost converter readings use and the
+ *          biquad of the inverter bus voltage loop
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_HARNESS_ARM_MATH_H_
+#define EVERT_HARNESS_ARM_MATH_H_
+
+#include <math.h>
+#include <stdint.h>
+
+typedef float float32_t;
+
+#define PI (3.14159265358979f)
+
+typedef struct
+{
+    uint16_t numTaps;
+    float32_t *pState;
+    const float32_t *pCoeffs;
+} arm_fir_instance_f32;
+
+/// @brief Same layout as CMSIS-DSP: numTaps + blockSize - 1 state words, coefficients in time reversed order
+static inline void arm_fir_init_f32(arm_fir_instance_f32 *S, uint16_t numTaps, const float32_t *pCoeffs, float32_t *pState, uint32_t blockSize)
+{
+    S->numTaps = numTaps;
+    S->pCoeffs = pCoeffs;
+    S->pState = pState;
+
+    for (uint32_t i = 0; i < (uint32_t)numTaps + blockSize - 1U; i++)
+    {
+        pState[i] = 0.0f;
+    }
+}
+
+static inline void arm_fir_f32(const arm_fir_instance_f32 *S, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+    float32_t *state = S->pState;
+    const uint32_t taps = S->numTaps;
+
+    for (uint32_t n = 0; n < blockSize; n++)
+    {
+        state[taps - 1U + n] = pSrc[n];
+
+        float32_t acc = 0.0f;
+
+        for (uint32_t k = 0; k < taps; k++)
+        {
+            acc += state[n + k] * S->pCoeffs[taps - 1U - k];
+        }
+
+        pDst[n] = acc;
+    }
+
+    for (uint32_t i = 0; i < taps - 1U; i++)
+    {
+        state[i] = state[blockSize + i];
+    }
+}
+
+typedef struct
+{
+    uint8_t numStages;
+    float32_t *pState;
+    const float32_t *pCoeffs;
+} arm_biquad_cascade_df2T_instance_f32;
+
+/// @brief Same as CMSIS-DSP: 2 state words and {b0, b1, b2, a1, a2} per stage, a1 and a2 with the sign of the feedback
+static inline void arm_biquad_cascade_df2T_f32(const arm_biquad_cascade_df2T_instance_f32 *S, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+    for (uint32_t n = 0; n < blockSize; n++)
+    {
+        float32_t sample = pSrc[n];
+
+        for (uint32_t stage = 0; stage < S->numStages; stage++)
+        {
+            const float32_t *b = &S->pCoeffs[5U * stage];
+            float32_t *d = &S->pState[2U * stage];
+            float32_t output = b[0] * sample + d[0];
+
+            d[0] = b[1] * sample + b[3] * output + d[1];
+            d[1] = b[2] * sample + b[4] * output;
+            sample = output;
+        }
+
+        pDst[n] = sample;
+    }
+}
+
+#endif // EVERT_HARNESS_ARM_MATH_H_
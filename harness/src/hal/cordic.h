@@ -0,0 +1,14 @@
+/**
+ ******************************************************************************
+ * @file    cordic.h
+ * @author  Evert Firmware Team
+ * @brief   Host stand-in for the CubeMX CORDIC module, the boost converter uses no CORDIC
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_HARNESS_CORDIC_H_
+#define EVERT_HARNESS_CORDIC_H_
+
+#include "stm32g4xx_hal.h"
+
+#endif // EVERT_HARNESS_CORDIC_H_
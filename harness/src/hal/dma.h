@@ -0,0 +1,16 @@
+/**
+ ******************************************************************************
+ * @file    dma.h
+ * @author  Evert Firmware Team
+ * @brief   Host stand-in for the CubeMX DMA module
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_HARNESS_DMA_H_
+#define EVERT_HARNESS_DMA_H_
+
+#include "stm32g4xx_hal.h"
+
+extern DMA_HandleTypeDef hdma_adc1;
+
+#endif // EVERT_HARNESS_DMA_H_
@@ -0,0 +1,16 @@
+/**
+ ******************************************************************************
+ * @file    fdcan.h
+ * @author  Evert Firmware Team
+ * @brief   Host stand-in for the CubeMX FDCAN module, the handle is the fake peripheral of the node
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_HARNESS_FDCAN_MODULE_H_
+#define EVERT_HARNESS_FDCAN_MODULE_H_
+
+#include "stm32g4xx_hal.h"
+
+extern FDCAN_HandleTypeDef hfdcan1;
+
+#endif // EVERT_HARNESS_FDCAN_MODULE_H_
@@ -0,0 +1,14 @@
+/**
+ ******************************************************************************
+ * @file    gpio.h
+ * @author  Evert Firmware Team
+ * @brief   Host stand-in for the CubeMX GPIO module
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_HARNESS_GPIO_H_
+#define EVERT_HARNESS_GPIO_H_
+
+#include "stm32g4xx_hal.h"
+
+#endif // EVERT_HARNESS_GPIO_H_
@@ -0,0 +1,16 @@
+/**
+ ******************************************************************************
+ * @file    hrtim.h
+ * @author  Evert Firmware Team
+ * @brief   Host stand-in for the CubeMX HRTIM module
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_HARNESS_HRTIM_H_
+#define EVERT_HARNESS_HRTIM_H_
+
+#include "stm32g4xx_hal_hrtim.h"
+
+extern HRTIM_HandleTypeDef hhrtim1;
+
+#endif // EVERT_HARNESS_HRTIM_H_
@@ -0,0 +1,16 @@
+/**
+ ******************************************************************************
+ * @file    i2c.h
+ * @author  Evert Firmware Team
+ * @brief   Host stand-in for the CubeMX I2C module, no I2C device is fitted to a node
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_HARNESS_I2C_H_
+#define EVERT_HARNESS_I2C_H_
+
+#include "stm32g4xx_hal.h"
+
+extern I2C_HandleTypeDef hi2c1;
+
+#endif // EVERT_HARNESS_I2C_H_
@@ -0,0 +1,534 @@
+/**
+ ******************************************************************************
+ * @file    stm32g4xx_hal.h
+ * @author  Evert Firmware Team
+ * @brief   Host stand-in for the STM32G4 HAL: the subset the CAN handler, the device layer and the boost
+ *          converter application use
+ *          * FDCAN: types and constants with the values of stm32g4xx_hal_fdcan.h, the functions are the
+ *            fake peripheral of the harness (harness_fdcan.c)
+ *          * Tick: HAL_GetTick and the DWT cycle counter are the virtual time of the node (harness_fdcan.c)
+ *          * Flash, RCC, ADC, DMA, GPIO, TIM, NVIC: register blocks and functions of the boost converter
+ *            node (boost_converter/harness_hal.c), the bit values are the ones of the CMSIS device header
+ *          * CMSIS: the interrupt mask intrinsics do nothing, a node runs its ISRs between main loop passes
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_HARNESS_STM32G4XX_HAL_H_
+#define EVERT_HARNESS_STM32G4XX_HAL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define __weak __attribute__((weak))
+#define UNUSED(X) (void)(X)
+#define RESET (0U)
+
+#define READ_BIT(REG, BIT) ((REG) & (BIT))
+#define SET_BIT(REG, BIT) ((REG) |= (BIT))
+#define CLEAR_BIT(REG, BIT) ((REG) &= ~(BIT))
+#define MODIFY_REG(REG, CLEARMASK, SETMASK) ((REG) = (((REG) & (~(CLEARMASK))) | (SETMASK)))
+
+typedef enum
+{
+    HAL_OK = 0x00U,
+    HAL_ERROR = 0x01U,
+    HAL_BUSY = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+// FDCAN, values of stm32g4xx_hal_fdcan.h
+#define FDCAN_STANDARD_ID ((uint32_t)0x00000000U)
+#define FDCAN_EXTENDED_ID ((uint32_t)0x40000000U)
+#define FDCAN_DATA_FRAME ((uint32_t)0x00000000U)
+#define FDCAN_REMOTE_FRAME ((uint32_t)0x20000000U)
+#define FDCAN_DLC_BYTES_8 ((uint32_t)0x00000008U)
+#define FDCAN_ESI_ACTIVE ((uint32_t)0x00000000U)
+#define FDCAN_BRS_OFF ((uint32_t)0x00000000U)
+#define FDCAN_CLASSIC_CAN ((uint32_t)0x00000000U)
+#define FDCAN_NO_TX_EVENTS ((uint32_t)0x00000000U)
+#define FDCAN_FILTER_MASK ((uint32_t)0x00000002U)
+#define FDCAN_FILTER_TO_RXFIFO0 ((uint32_t)0x00000001U)
+#define FDCAN_RX_FIFO0 ((uint32_t)0x00000040U)
+#define FDCAN_ACCEPT_IN_RX_FIFO0 ((uint32_t)0x00000000U)
+#define FDCAN_FILTER_REMOTE ((uint32_t)0x00000000U)
+#define FDCAN_IT_RX_FIFO0_NEW_MESSAGE ((uint32_t)0x00000001U)
+#define FDCAN_IT_RX_FIFO0_MESSAGE_LOST ((uint32_t)0x00000004U)
+#define FDCAN_CLOCK_DIV1 ((uint32_t)0x00000000U)
+#define FDCAN_PSR_BO ((uint32_t)0x00000080U)
+#define FDCAN_TIMESTAMP_PRESC_1 ((uint32_t)0x00000000U)
+#define FDCAN_TIMESTAMP_INTERNAL ((uint32_t)0x00000001U)
+
+// Message RAM element, first word (RM0440 44.3.8)
+#define FDCAN_ELEMENT_MASK_STDID ((uint32_t)0x1FFC0000U)
+#define FDCAN_ELEMENT_MASK_EXTID ((uint32_t)0x1FFFFFFFU)
+#define FDCAN_ELEMENT_MASK_RTR ((uint32_t)0x20000000U)
+#define FDCAN_ELEMENT_MASK_XTD ((uint32_t)0x40000000U)
+
+#define FDCAN_TX_FIFO_SIZE (3) // Tx FIFO/queue elements of the G4 message RAM
+#define FDCAN_RX_FIFO_SIZE (3) // Rx FIFO 0 elements of the G4 message RAM
+
+typedef struct
+{
+    volatile uint32_t PSR; // Error active, the virtual bus has no errors
+} FDCAN_GlobalTypeDef;
+
+typedef struct
+{
+    uint32_t ClockDivider;
+    uint32_t NominalPrescaler;
+    uint32_t NominalSyncJumpWidth;
+    uint32_t NominalTimeSeg1;
+    uint32_t NominalTimeSeg2;
+} FDCAN_InitTypeDef;
+
+typedef struct
+{
+    FDCAN_GlobalTypeDef *Instance;
+    FDCAN_InitTypeDef Init;
+    uint32_t ErrorCode;
+} FDCAN_HandleTypeDef;
+
+typedef struct
+{
+    uint32_t TxErrorCnt;
+    uint32_t RxErrorCnt;
+    uint32_t RxErrorPassive;
+    uint32_t ErrorLogging;
+} FDCAN_ErrorCountersTypeDef;
+
+typedef struct
+{
+    uint32_t IdType;
+    uint32_t FilterIndex;
+    uint32_t FilterType;
+    uint32_t FilterConfig;
+    uint32_t FilterID1;
+    uint32_t FilterID2;
+} FDCAN_FilterTypeDef;
+
+typedef struct
+{
+    uint32_t Identifier;
+    uint32_t IdType;
+    uint32_t TxFrameType;
+    uint32_t DataLength;
+    uint32_t ErrorStateIndicator;
+    uint32_t BitRateSwitch;
+    uint32_t FDFormat;
+    uint32_t TxEventFifoControl;
+    uint32_t MessageMarker;
+} FDCAN_TxHeaderTypeDef;
+
+typedef struct
+{
+    uint32_t Identifier;
+    uint32_t IdType;
+    uint32_t RxFrameType;
+    uint32_t DataLength;
+    uint32_t ErrorStateIndicator;
+    uint32_t BitRateSwitch;
+    uint32_t FDFormat;
+    uint32_t RxTimestamp;
+    uint32_t FilterIndex;
+    uint32_t IsFilterMatchingFrame;
+} FDCAN_RxHeaderTypeDef;
+
+HAL_StatusTypeDef HAL_FDCAN_ConfigFilter(FDCAN_HandleTypeDef *hfdcan, FDCAN_FilterTypeDef *sFilterConfig);
+HAL_StatusTypeDef HAL_FDCAN_ConfigGlobalFilter(FDCAN_HandleTypeDef *hfdcan, uint32_t NonMatchingStd, uint32_t NonMatchingExt, uint32_t RejectRemoteStd, uint32_t RejectRemoteExt);
+HAL_StatusTypeDef HAL_FDCAN_Start(FDCAN_HandleTypeDef *hfdcan);
+HAL_StatusTypeDef HAL_FDCAN_ActivateNotification(FDCAN_HandleTypeDef *hfdcan, uint32_t ActiveITs, uint32_t BufferIndexes);
+HAL_StatusTypeDef HAL_FDCAN_GetRxMessage(FDCAN_HandleTypeDef *hfdcan, uint32_t RxLocation, FDCAN_RxHeaderTypeDef *pRxHeader, uint8_t *pRxData);
+HAL_StatusTypeDef HAL_FDCAN_AddMessageToTxFifoQ(FDCAN_HandleTypeDef *hfdcan, const FDCAN_TxHeaderTypeDef *pTxHeader, const uint8_t *pTxData);
+uint32_t HAL_FDCAN_GetTxFifoFreeLevel(const FDCAN_HandleTypeDef *hfdcan);
+uint32_t HAL_FDCAN_GetRxFifoFillLevel(const FDCAN_HandleTypeDef *hfdcan, uint32_t RxFifo);
+HAL_StatusTypeDef HAL_FDCAN_GetErrorCounters(const FDCAN_HandleTypeDef *hfdcan, FDCAN_ErrorCountersTypeDef *ErrorCounters);
+uint32_t HAL_FDCAN_GetError(const FDCAN_HandleTypeDef *hfdcan);
+HAL_StatusTypeDef HAL_FDCAN_ConfigTimestampCounter(FDCAN_HandleTypeDef *hfdcan, uint32_t TimestampPrescaler);
+HAL_StatusTypeDef HAL_FDCAN_EnableTimestampCounter(FDCAN_HandleTypeDef *hfdcan, uint32_t TimestampOperation);
+uint16_t HAL_FDCAN_GetTimestampCounter(const FDCAN_HandleTypeDef *hfdcan);
+
+// RCC, the FDCAN kernel clock is the 24 MHz HSE of the boards
+#define RCC_PERIPHCLK_FDCAN (0x00001000U)
+#define HSE_VALUE (24000000U)
+
+uint32_t HAL_RCCEx_GetPeriphCLKFreq(uint32_t PeriphClk);
+
+uint32_t HAL_GetTick(void);
+uint32_t HAL_RCC_GetSysClockFreq(void);
+
+// RCC, the reset flags are set by the node supervisor before each boot
+#define RCC_CR_HSEON (0x00010000U)
+#define RCC_CR_HSERDY (0x00020000U)
+#define RCC_CSR_RMVF (0x00800000U)
+#define RCC_CSR_OBLRSTF (0x02000000U)
+#define RCC_CSR_PINRSTF (0x04000000U)
+#define RCC_CSR_BORRSTF (0x08000000U)
+#define RCC_CSR_SFTRSTF (0x10000000U)
+#define RCC_CSR_IWDGRSTF (0x20000000U)
+#define RCC_CSR_WWDGRSTF (0x40000000U)
+#define RCC_CSR_LPWRRSTF (0x80000000U)
+#define RCC_APB1ENR1_WWDGEN (0x00000800U)
+#define RCC_FLAG_HSERDY (RCC_CR_HSERDY) // Only the flags of RCC->CR, unlike the HAL's register index encoding
+
+typedef struct
+{
+    volatile uint32_t CR;
+    volatile uint32_t APB1ENR1;
+    volatile uint32_t CSR;
+} RCC_TypeDef;
+
+extern RCC_TypeDef harness_rcc;
+#define RCC (&harness_rcc)
+
+#define __HAL_RCC_GET_FLAG(__FLAG__) (READ_BIT(RCC->CR, (__FLAG__)) != 0U)
+#define __HAL_RCC_CLEAR_RESET_FLAGS() (RCC->CSR &= ~(RCC_CSR_OBLRSTF | RCC_CSR_PINRSTF | RCC_CSR_BORRSTF | RCC_CSR_SFTRSTF | RCC_CSR_IWDGRSTF | RCC_CSR_WWDGRSTF | RCC_CSR_LPWRRSTF))
+#define __HAL_RCC_WWDG_CLK_ENABLE() SET_BIT(RCC->APB1ENR1, RCC_APB1ENR1_WWDGEN)
+
+// Flash: dual bank, 256 kB per bank at FLASH_BASE, the banks swap with SYSCFG_MEMRMP_FB_MODE
+#define FLASH_BASE (0x08000000UL)
+#define FLASH_BANK_SIZE (0x00040000UL)
+#define FLASH_PAGE_SIZE (0x00000800U)
+#define FLASH_PAGE_SIZE_128_BITS (0x00001000U)
+#define FLASH_BANK_1 (0x00000001U)
+#define FLASH_BANK_2 (0x00000002U)
+#define FLASH_TYPEERASE_PAGES (0x00U)
+#define FLASH_TYPEPROGRAM_DOUBLEWORD (0x00U)
+
+#define FLASH_ACR_ICEN (0x00000200U)
+#define FLASH_ACR_DCEN (0x00000400U)
+#define FLASH_ACR_ICRST (0x00000800U)
+#define FLASH_ACR_DCRST (0x00001000U)
+#define FLASH_SR_EOP (0x00000001U)
+#define FLASH_SR_OPERR (0x00000002U)
+#define FLASH_SR_PROGERR (0x00000008U)
+#define FLASH_SR_WRPERR (0x00000010U)
+#define FLASH_SR_PGAERR (0x00000020U)
+#define FLASH_SR_SIZERR (0x00000040U)
+#define FLASH_SR_PGSERR (0x00000080U)
+#define FLASH_SR_MISERR (0x00000100U)
+#define FLASH_SR_FASTERR (0x00000200U)
+#define FLASH_SR_RDERR (0x00004000U)
+#define FLASH_SR_OPTVERR (0x00008000U)
+#define FLASH_SR_BSY (0x00010000U)
+#define FLASH_CR_PG (0x00000001U)
+#define FLASH_CR_PER (0x00000002U)
+#define FLASH_CR_PNB (0x000003F8U)
+#define FLASH_CR_PNB_Pos (3U)
+#define FLASH_CR_BKER (0x00000800U)
+#define FLASH_CR_STRT (0x00010000U)
+#define FLASH_CR_LOCK (0x80000000U)
+#define FLASH_OPTR_BFB2 (0x00100000U)
+#define FLASH_OPTR_DBANK (0x00400000U)
+
+#define FLASH_FLAG_SR_ERRORS (FLASH_SR_OPERR | FLASH_SR_PROGERR | FLASH_SR_WRPERR | FLASH_SR_PGAERR | FLASH_SR_SIZERR | FLASH_SR_PGSERR | FLASH_SR_MISERR | FLASH_SR_FASTERR | FLASH_SR_RDERR | FLASH_SR_OPTVERR)
+#define FLASH_FLAG_ALL_ERRORS (FLASH_FLAG_SR_ERRORS)
+
+typedef struct
+{
+    volatile uint32_t ACR;
+    volatile uint32_t SR;
+    volatile uint32_t CR;
+    volatile uint32_t OPTR;
+} FLASH_TypeDef;
+
+typedef struct
+{
+    uint32_t TypeErase;
+    uint32_t Banks;
+    uint32_t Page;
+    uint32_t NbPages;
+} FLASH_EraseInitTypeDef;
+
+/// @brief Every access to FLASH goes through the node, a page erase started with FLASH_PageErase ends here
+FLASH_TypeDef *EVERT_HARNESS_HAL_Flash(void);
+#define FLASH (EVERT_HARNESS_HAL_Flash())
+
+#define __HAL_FLASH_CLEAR_FLAG(__FLAG__) (FLASH->SR &= ~(__FLAG__)) // Write 1 to clear on the part
+#define __HAL_FLASH_DATA_CACHE_DISABLE() CLEAR_BIT(FLASH->ACR, FLASH_ACR_DCEN)
+#define __HAL_FLASH_DATA_CACHE_ENABLE() SET_BIT(FLASH->ACR, FLASH_ACR_DCEN)
+#define __HAL_FLASH_DATA_CACHE_RESET() \
+    do                                  \
+    {                                   \
+        SET_BIT(FLASH->ACR, FLASH_ACR_DCRST); \
+        CLEAR_BIT(FLASH->ACR, FLASH_ACR_DCRST); \
+    } while (0)
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void);
+HAL_StatusTypeDef HAL_FLASH_Lock(void);
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data);
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError);
+void FLASH_PageErase(uint32_t Page, uint32_t Banks);
+
+// SYSCFG, FB_MODE mirrors the BFB2 option bit the node booted with
+#define SYSCFG_MEMRMP_FB_MODE (0x00000100U)
+
+typedef struct
+{
+    volatile uint32_t MEMRMP;
+} SYSCFG_TypeDef;
+
+extern SYSCFG_TypeDef harness_syscfg;
+#define SYSCFG (&harness_syscfg)
+
+// DBGMCU
+#define DBGMCU_APB1FZR1_DBG_WWDG_STOP (0x00000800U)
+#define DBGMCU_APB1FZR1_DBG_IWDG_STOP (0x00001000U)
+
+typedef struct
+{
+    volatile uint32_t APB1FZR1;
+} DBGMCU_TypeDef;
+
+extern DBGMCU_TypeDef harness_dbgmcu;
+#define DBGMCU (&harness_dbgmcu)
+
+// IWDG, WWDG: the register blocks, the LL headers have the functions
+typedef struct
+{
+    volatile uint32_t KR;
+    volatile uint32_t PR;
+    volatile uint32_t RLR;
+    volatile uint32_t SR;
+} IWDG_TypeDef;
+
+extern IWDG_TypeDef harness_iwdg;
+#define IWDG (&harness_iwdg)
+
+#define WWDG_CR_T (0x0000007FU)
+#define WWDG_CR_WDGA (0x00000080U)
+#define WWDG_CFR_W (0x0000007FU)
+#define WWDG_CFR_EWI (0x00000200U)
+#define WWDG_CFR_WDGTB (0x00003800U)
+#define WWDG_SR_EWIF (0x00000001U)
+
+typedef struct
+{
+    volatile uint32_t CR;
+    volatile uint32_t CFR;
+    volatile uint32_t SR;
+} WWDG_TypeDef;
+
+extern WWDG_TypeDef harness_wwdg;
+#define WWDG (&harness_wwdg)
+
+// GPIO
+typedef enum
+{
+    GPIO_PIN_RESET = 0U,
+    GPIO_PIN_SET
+} GPIO_PinState;
+
+#define GPIO_PIN_0 ((uint16_t)0x0001)
+#define GPIO_PIN_1 ((uint16_t)0x0002)
+#define GPIO_PIN_2 ((uint16_t)0x0004)
+#define GPIO_PIN_3 ((uint16_t)0x0008)
+#define GPIO_PIN_4 ((uint16_t)0x0010)
+#define GPIO_PIN_5 ((uint16_t)0x0020)
+#define GPIO_PIN_6 ((uint16_t)0x0040)
+#define GPIO_PIN_7 ((uint16_t)0x0080)
+#define GPIO_PIN_8 ((uint16_t)0x0100)
+#define GPIO_PIN_9 ((uint16_t)0x0200)
+#define GPIO_PIN_10 ((uint16_t)0x0400)
+#define GPIO_PIN_11 ((uint16_t)0x0800)
+#define GPIO_PIN_12 ((uint16_t)0x1000)
+#define GPIO_PIN_13 ((uint16_t)0x2000)
+#define GPIO_PIN_14 ((uint16_t)0x4000)
+#define GPIO_PIN_15 ((uint16_t)0x8000)
+
+typedef struct
+{
+    volatile uint32_t IDR;
+    volatile uint32_t ODR;
+} GPIO_TypeDef;
+
+extern GPIO_TypeDef harness_gpio[7];
+#define GPIOA (&harness_gpio[0])
+#define GPIOB (&harness_gpio[1])
+#define GPIOC (&harness_gpio[2])
+#define GPIOD (&harness_gpio[3])
+#define GPIOE (&harness_gpio[4])
+#define GPIOF (&harness_gpio[5])
+#define GPIOG (&harness_gpio[6])
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+
+// DMA
+typedef enum
+{
+    HAL_DMA_STATE_RESET = 0x00U,
+    HAL_DMA_STATE_READY = 0x01U,
+    HAL_DMA_STATE_BUSY = 0x02U,
+    HAL_DMA_STATE_TIMEOUT = 0x03U
+} HAL_DMA_StateTypeDef;
+
+typedef enum
+{
+    HAL_DMA_XFER_CPLT_CB_ID = 0x00U,
+    HAL_DMA_XFER_HALFCPLT_CB_ID = 0x01U,
+    HAL_DMA_XFER_ERROR_CB_ID = 0x02U,
+    HAL_DMA_XFER_ABORT_CB_ID = 0x03U,
+    HAL_DMA_XFER_ALL_CB_ID = 0x04U
+} HAL_DMA_CallbackIDTypeDef;
+
+typedef struct __DMA_HandleTypeDef
+{
+    HAL_DMA_StateTypeDef State;
+    uint32_t ErrorCode;
+    void (*XferErrorCallback)(struct __DMA_HandleTypeDef *hdma);
+} DMA_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_DMA_RegisterCallback(DMA_HandleTypeDef *hdma, HAL_DMA_CallbackIDTypeDef CallbackID, void (*pCallback)(DMA_HandleTypeDef *_hdma));
+HAL_DMA_StateTypeDef HAL_DMA_GetState(const DMA_HandleTypeDef *hdma);
+uint32_t HAL_DMA_GetError(const DMA_HandleTypeDef *hdma);
+
+// ADC: the node fills the DMA buffer and calls the conversion complete callback every HF tick
+#define ADC_SINGLE_ENDED (0x0000007FU)
+#define ADC_RESOLUTION_12B (0x00000000U)
+#define HAL_ADC_ERROR_NONE (0x00U)
+#define HAL_ADC_STATE_RESET (0x00000000UL)
+#define HAL_ADC_STATE_READY (0x00000001UL)
+#define HAL_ADC_STATE_BUSY_INTERNAL (0x00000002UL)
+#define HAL_ADC_STATE_TIMEOUT (0x00000004UL)
+#define HAL_ADC_STATE_ERROR_INTERNAL (0x00000010UL)
+#define HAL_ADC_STATE_ERROR_CONFIG (0x00000020UL)
+#define HAL_ADC_STATE_ERROR_DMA (0x00000040UL)
+#define HAL_ADC_STATE_REG_BUSY (0x00000100UL)
+#define HAL_ADC_STATE_INJ_BUSY (0x00001000UL)
+
+#define ADC_STATE_CLR_SET(__REG__, __CLEAR_MASK__, __SET_MASK__) ((__REG__) = (((__REG__) & ~(__CLEAR_MASK__)) | (__SET_MASK__)))
+
+typedef struct
+{
+    volatile uint32_t CR;
+} ADC_TypeDef;
+
+extern ADC_TypeDef harness_adc[5];
+#define ADC1 (&harness_adc[0])
+#define ADC2 (&harness_adc[1])
+#define ADC3 (&harness_adc[2])
+#define ADC4 (&harness_adc[3])
+#define ADC5 (&harness_adc[4])
+
+typedef struct
+{
+    ADC_TypeDef *Instance;
+    DMA_HandleTypeDef *DMA_Handle;
+    volatile uint32_t State;
+    volatile uint32_t ErrorCode;
+} ADC_HandleTypeDef;
+
+// Factory calibration of the temperature sensor, typical values of the G474 datasheet (3.0 V reference)
+#define TEMPSENSOR_CAL1_VALUE (1034)
+#define TEMPSENSOR_CAL2_VALUE (1376)
+#define TEMPSENSOR_CAL1_TEMP (30)
+#define TEMPSENSOR_CAL2_TEMP (130)
+#define TEMPSENSOR_CAL_VREFANALOG (3000UL)
+
+#define __HAL_ADC_CALC_DATA_TO_VOLTAGE(__VREFANALOG_VOLTAGE__, __ADC_DATA__, __ADC_RESOLUTION__) \
+    ((__ADC_DATA__) * (__VREFANALOG_VOLTAGE__) / 4095UL)
+#define __HAL_ADC_CALC_TEMPERATURE(__VREFANALOG_VOLTAGE__, __TEMPSENSOR_ADC_DATA__, __ADC_RESOLUTION__)                           \
+    ((((int32_t)(((__TEMPSENSOR_ADC_DATA__) * (__VREFANALOG_VOLTAGE__)) / TEMPSENSOR_CAL_VREFANALOG) - TEMPSENSOR_CAL1_VALUE) * \
+      (TEMPSENSOR_CAL2_TEMP - TEMPSENSOR_CAL1_TEMP)) /                                                                          \
+         (TEMPSENSOR_CAL2_VALUE - TEMPSENSOR_CAL1_VALUE) +                                                                      \
+     TEMPSENSOR_CAL1_TEMP)
+
+HAL_StatusTypeDef HAL_ADCEx_Calibration_Start(ADC_HandleTypeDef *hadc, uint32_t SingleDiff);
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef *hadc, uint32_t *pData, uint32_t Length);
+uint32_t HAL_ADC_GetError(const ADC_HandleTypeDef *hadc);
+HAL_StatusTypeDef ADC_Disable(ADC_HandleTypeDef *hadc);
+void LL_ADC_StartCalibration(ADC_TypeDef *ADCx, uint32_t SingleDiff);
+uint32_t LL_ADC_IsCalibrationOnGoing(const ADC_TypeDef *ADCx);
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc);
+void HAL_ADC_ErrorCallback(ADC_HandleTypeDef *hadc);
+
+// TIM, I2C: handles only, the node calls the ISRs of the timers itself
+typedef struct
+{
+    void *Instance;
+} TIM_HandleTypeDef;
+
+typedef struct
+{
+    void *Instance;
+    DMA_HandleTypeDef *hdmatx;
+    DMA_HandleTypeDef *hdmarx;
+    volatile uint32_t ErrorCode;
+} I2C_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim);
+
+// UART: the handle and the calls of telemetry.c, a test gives them
+typedef enum
+{
+    HAL_UART_STATE_RESET = 0x00U,
+    HAL_UART_STATE_READY = 0x20U,
+    HAL_UART_STATE_BUSY_TX = 0x21U,
+    HAL_UART_STATE_BUSY_RX = 0x22U
+} HAL_UART_StateTypeDef;
+
+typedef struct
+{
+    void *Instance;
+    DMA_HandleTypeDef *hdmatx;
+    DMA_HandleTypeDef *hdmarx;
+    volatile HAL_UART_StateTypeDef gState;
+    volatile HAL_UART_StateTypeDef RxState;
+} UART_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_AbortTransmit(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+
+// NVIC
+typedef enum
+{
+    WWDG_IRQn = 0,
+    FDCAN1_IT0_IRQn = 21,
+    TIM2_IRQn = 28,
+    TIM3_IRQn = 29
+} IRQn_Type;
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority);
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn);
+
+/// @brief Ends the boot of the node, the supervisor starts the next one (boost_converter/harness_hal.c)
+void NVIC_SystemReset(void) __attribute__((noreturn));
+
+// CMSIS system, DWT: the cycle counter runs with the virtual time on the node crystal (harness_fdcan.c)
+extern uint32_t SystemCoreClock;
+
+// CMSIS core registers, a debugger is never attached to a node
+#define CoreDebug_DHCSR_C_DEBUGEN_Msk (0x00000001UL)
+#define CoreDebug_DEMCR_TRCENA_Msk (0x01000000UL)
+
+typedef struct
+{
+    volatile uint32_t CFSR;
+    volatile uint32_t HFSR;
+    volatile uint32_t MMFAR;
+    volatile uint32_t BFAR;
+} SCB_Type;
+
+typedef struct
+{
+    volatile uint32_t DHCSR;
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+extern SCB_Type harness_scb;
+extern CoreDebug_Type harness_core_debug;
+#define SCB (&harness_scb)
+#define CoreDebug (&harness_core_debug)
+
+// CMSIS
+static inline uint32_t __get_PRIMASK(void) { return 0; }
+static inline void __set_PRIMASK(uint32_t primask) { (void)primask; }
+static inline void __disable_irq(void) {}
+static inline void __enable_irq(void) {}
+static inline uint32_t __get_xPSR(void) { return 0x01000000U; } // Thread mode, Thumb
+static inline uint32_t __get_MSP(void) { return 0x20020000U; }  // Top of SRAM, the stack of a node is a host stack
+
+#endif // EVERT_HARNESS_STM32G4XX_HAL_H_
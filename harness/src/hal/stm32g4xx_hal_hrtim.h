@@ -0,0 +1,81 @@
+/**
+ ******************************************************************************
+ * @file    stm32g4xx_hal_hrtim.h
+ * @author  Evert Firmware Team
+ * @brief   Host stand-in for the HRTIM HAL driver: the register block of the boost converter PWM, the node
+ *          reads the duty cycle of TIMER_A from it (boost_converter/harness_hal.c)
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_HARNESS_STM32G4XX_HAL_HRTIM_H_
+#define EVERT_HARNESS_STM32G4XX_HAL_HRTIM_H_
+
+#include "stm32g4xx_hal.h"
+
+#define HRTIM_TIMERINDEX_TIMER_A (0x0U)
+#define HRTIM_TIMERINDEX_MASTER (0x6U)
+#define HRTIM_COMPAREUNIT_1 (0x00000001U)
+#define HRTIM_OUTPUT_TA1 (0x00000001U)
+#define HRTIM_OUTPUT_TA2 (0x00000002U)
+#define HRTIM_TIMERID_MASTER (0x00010000U)
+#define HRTIM_TIMERID_TIMER_A (0x00020000U)
+
+#define HRTIM_MCR_CK_PSC (0x00000007U)
+#define HRTIM_MCR_SYNC_IN (0x00000300U)
+#define HRTIM_MCR_SYNCRSTM (0x00000400U)
+#define HRTIM_MCR_SYNCSTRTM (0x00000800U)
+#define HRTIM_MCR_SYNC_OUT (0x00003000U)
+#define HRTIM_MCR_SYNC_SRC (0x0000C000U)
+#define HRTIM_TIMCR_CK_PSC (0x00000007U)
+#define HRTIM_TIMCR_TRSTU (0x00040000U)
+#define HRTIM_TIMCR_PREEN (0x08000000U)
+#define HRTIM_RSTR_MSTPER (0x00000010U)
+#define HRTIM_RSTR_MSTCMP1 (0x00000020U)
+
+#define HRTIM_SYNCINPUTSOURCE_EXTERNALEVENT (0x00000300U)
+#define HRTIM_SYNCOUTPUTSOURCE_MASTER_START (0x00000000U)
+#define HRTIM_SYNCOUTPUTPOLARITY_POSITIVE (0x00002000U)
+
+typedef struct
+{
+    volatile uint32_t MCR;
+    volatile uint32_t MPER;
+    volatile uint32_t MCMP1R;
+} HRTIM_Master_TypeDef;
+
+typedef struct
+{
+    volatile uint32_t TIMxCR;
+    volatile uint32_t PERxR;
+    volatile uint32_t CMP1xR;
+    volatile uint32_t RSTxR;
+} HRTIM_Timerx_TypeDef;
+
+typedef struct
+{
+    volatile uint32_t OENR;
+    volatile uint32_t ODISR;
+} HRTIM_Common_TypeDef;
+
+typedef struct
+{
+    HRTIM_Master_TypeDef sMasterRegs;
+    HRTIM_Timerx_TypeDef sTimerxRegs[6];
+    HRTIM_Common_TypeDef sCommonRegs;
+} HRTIM_TypeDef;
+
+typedef struct
+{
+    HRTIM_TypeDef *Instance;
+} HRTIM_HandleTypeDef;
+
+extern HRTIM_TypeDef harness_hrtim1;
+#define HRTIM1 (&harness_hrtim1)
+
+#define __HAL_HRTIM_SETCOMPARE(__HANDLE__, __TIMER__, __COMPAREUNIT__, __COMPARE__) \
+    ((__COMPAREUNIT__) == HRTIM_COMPAREUNIT_1 ? ((__HANDLE__)->Instance->sTimerxRegs[(__TIMER__)].CMP1xR = (__COMPARE__)) : 0U)
+
+HAL_StatusTypeDef HAL_HRTIM_WaveformOutputStart(HRTIM_HandleTypeDef *hhrtim, uint32_t OutputsToStart);
+HAL_StatusTypeDef HAL_HRTIM_WaveformCounterStart(HRTIM_HandleTypeDef *hhrtim, uint32_t Timers);
+
+#endif // EVERT_HARNESS_STM32G4XX_HAL_HRTIM_H_
@@ -0,0 +1,14 @@
+/**
+ ******************************************************************************
+ * @file    stm32g4xx_ll_cordic.h
+ * @author  Evert Firmware Team
+ * @brief   Host stand-in for the CORDIC LL driver, the boost converter uses no CORDIC
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_HARNESS_STM32G4XX_LL_CORDIC_H_
+#define EVERT_HARNESS_STM32G4XX_LL_CORDIC_H_
+
+#include "stm32g4xx_hal.h"
+
+#endif // EVERT_HARNESS_STM32G4XX_LL_CORDIC_H_
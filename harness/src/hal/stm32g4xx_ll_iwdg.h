@@ -0,0 +1,29 @@
+/**
+ ******************************************************************************
+ * @file    stm32g4xx_ll_iwdg.h
+ * @author  Evert Firmware Team
+ * @brief   Host stand-in for the IWDG LL driver: functions of the node, which counts the timeout in virtual time (boost_converter/harness_hal.c)
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_HARNESS_STM32G4XX_LL_IWDG_H_
+#define EVERT_HARNESS_STM32G4XX_LL_IWDG_H_
+
+#include "stm32g4xx_hal.h"
+
+#define LL_IWDG_PRESCALER_4 (0x00000000U)
+#define LL_IWDG_PRESCALER_8 (0x00000001U)
+#define LL_IWDG_PRESCALER_16 (0x00000002U)
+#define LL_IWDG_PRESCALER_32 (0x00000003U)
+#define LL_IWDG_PRESCALER_64 (0x00000004U)
+#define LL_IWDG_PRESCALER_128 (0x00000005U)
+#define LL_IWDG_PRESCALER_256 (0x00000006U)
+
+void LL_IWDG_Enable(IWDG_TypeDef *IWDGx);
+void LL_IWDG_ReloadCounter(IWDG_TypeDef *IWDGx);
+void LL_IWDG_EnableWriteAccess(IWDG_TypeDef *IWDGx);
+void LL_IWDG_SetPrescaler(IWDG_TypeDef *IWDGx, uint32_t Prescaler);
+void LL_IWDG_SetReloadCounter(IWDG_TypeDef *IWDGx, uint32_t Counter);
+uint32_t LL_IWDG_IsReady(const IWDG_TypeDef *IWDGx);
+
+#endif // EVERT_HARNESS_STM32G4XX_LL_IWDG_H_
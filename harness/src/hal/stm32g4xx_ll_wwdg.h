@@ -0,0 +1,44 @@
+/**
+ ******************************************************************************
+ * @file    stm32g4xx_ll_wwdg.h
+ * @author  Evert Firmware Team
+ * @brief   Host stand-in for the WWDG LL driver, the register accesses of stm32g4xx_ll_wwdg.h, the node counts WWDG->CR down
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_HARNESS_STM32G4XX_LL_WWDG_H_
+#define EVERT_HARNESS_STM32G4XX_LL_WWDG_H_
+
+#include "stm32g4xx_hal.h"
+
+#define LL_WWDG_PRESCALER_1 (0x00000000U)
+#define LL_WWDG_PRESCALER_2 (0x00000800U)
+#define LL_WWDG_PRESCALER_4 (0x00001000U)
+#define LL_WWDG_PRESCALER_8 (0x00001800U)
+
+static inline void LL_WWDG_SetPrescaler(WWDG_TypeDef *WWDGx, uint32_t Prescaler)
+{
+    WWDGx->CFR = (WWDGx->CFR & ~WWDG_CFR_WDGTB) | Prescaler;
+}
+
+static inline void LL_WWDG_SetWindow(WWDG_TypeDef *WWDGx, uint32_t Window)
+{
+    WWDGx->CFR = (WWDGx->CFR & ~WWDG_CFR_W) | Window;
+}
+
+static inline uint32_t LL_WWDG_GetCounter(const WWDG_TypeDef *WWDGx)
+{
+    return WWDGx->CR & WWDG_CR_T;
+}
+
+static inline void LL_WWDG_EnableIT_EWKUP(WWDG_TypeDef *WWDGx)
+{
+    WWDGx->CFR |= WWDG_CFR_EWI;
+}
+
+static inline void LL_WWDG_ClearFlag_EWKUP(WWDG_TypeDef *WWDGx)
+{
+    WWDGx->SR = 0U;
+}
+
+#endif // EVERT_HARNESS_STM32G4XX_LL_WWDG_H_
@@ -0,0 +1,17 @@
+/**
+ ******************************************************************************
+ * @file    tim.h
+ * @author  Evert Firmware Team
+ * @brief   Host stand-in for the CubeMX TIM module, the node calls the ISRs of the timers itself
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_HARNESS_TIM_H_
+#define EVERT_HARNESS_TIM_H_
+
+#include "stm32g4xx_hal.h"
+
+extern TIM_HandleTypeDef htim2;
+extern TIM_HandleTypeDef htim3;
+
+#endif // EVERT_HARNESS_TIM_H_
@@ -0,0 +1,14 @@
+/**
+ ******************************************************************************
+ * @file    usart.h
+ * @author  Evert Firmware Team
+ * @brief   Host stand-in for the CubeMX USART module, the boost converter uses no UART
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_HARNESS_USART_H_
+#define EVERT_HARNESS_USART_H_
+
+#include "stm32g4xx_hal.h"
+
+#endif // EVERT_HARNESS_USART_H_
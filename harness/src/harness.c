@@ -0,0 +1,1112 @@
+/**
+ ******************************************************************************
+ * @file    harness.c
+ * @author  Evert Firmware Team
+ * @brief   Virtual CAN bus integration harness: device firmware nodes and the CCU on one simulated bus
+ *          evert_harness [-S scenario] [-t s] [-b bit/s] [-l us] [-p loss] [-r seed] [-v]
+ *          * Nodes: boost converter 1 and 2, inverter (harness_node.h), CCU in this process (harness_ccu.h)
+ *          * Lockstep in 1 ms steps of virtual time, as fast as the host runs them
+ *          * Checks: handshake time, handshakes kept, bus load, command latency, commands applied, frames
+ *            dropped by the firmware, time synchronization and delta telemetry of the boost converters, firmware
+ *            updates, the boost converters kept operational, the power settled to the setpoints and under the
+ *            export limits, the batch limits summed to the optimizer target; exit status 1 if one fails
+ *
+ ******************************************************************************
+ **/
+
+#include <getopt.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "_conf_evert_device.h"
+#include "_conf_evert_harness.h"
+#include "ccu_devices.h"
+#include "ccu_dispatch.h"
+#include "ccu_protocol.h"
+#include "ccu_telemetry.h"
+#include "ccu_timesync.h"
+#include "ccu_update.h"
+#include "evert_device_state.h"
+#include "firmware_image.h"
+#include "harness_bus.h"
+#include "harness_ccu.h"
+#include "harness_node.h"
+
+#define EVERT_HARNESS_METHOD_COUNT (BCCM_POWER_REPORT + 1)
+#define EVERT_HARNESS_UNAPPLIED_AGE_US (100000u) // Commands still in flight at the end are not counted as lost
+#define EVERT_HARNESS_UPDATE_VERSION {2, 1, 0}    // Of the synthetic image, the nodes run 2.0.0
+
+typedef enum
+{
+    HAK_SETPOINT = 0,     // EVERT_CCU_DISPATCH_SetPowerSetpoint, value W or NAN
+    HAK_OPTIMIZE = 1,     // EVERT_CCU_DISPATCH_SetOptimizer, value != 0
+    HAK_EXPORT_LIMIT = 2, // EVERT_CCU_DISPATCH_SetExportLimit, value W AC or < 0
+    HAK_UPDATE = 3,       // EVERT_CCU_UPDATE_Add of a synthetic image, value its size in bytes
+} EVERT_HARNESS_ActionKindTypeDef;
+
+typedef struct
+{
+    uint32_t time_ms;
+    EVERT_HARNESS_ActionKindTypeDef kind;
+    uint8_t device_id;
+    float value;
+} EVERT_HARNESS_ActionTypeDef;
+
+typedef struct
+{
+    const char *name;
+    const char *description;
+    uint32_t duration_s;
+    const EVERT_HARNESS_ActionTypeDef *actions;
+    uint32_t action_count;
+} EVERT_HARNESS_ScenarioTypeDef;
+
+typedef struct
+{
+    uint64_t queued_us[EVERT_CONSTANT_HARNESS_PENDING_COMMANDS];
+    uint32_t head;
+    uint32_t count;
+} EVERT_HARNESS_PendingTypeDef;
+
+typedef struct
+{
+    EVERT_HARNESS_NODE_TypeDef node;
+    int64_t acknowledged_ms; // Power on to the first DS_HANDSHAKE_ACKNOWLEDGED, -1 = never
+    bool acknowledged;
+    uint32_t handshake_lost_count; // Back to announcing after acknowledged
+    uint32_t reset_count;          // Application resets (firmware update)
+    uint32_t reset_ms;             // Node time of the last one
+    EVERT_HARNESS_PendingTypeDef pending[EVERT_HARNESS_METHOD_COUNT];
+    uint32_t command_count;
+
+    // Time synchronization: EVERT_TIME_SYNC_Now of the node against the CCU time at every step
+    int64_t time_sync_locked_ms; // Power on (or the last reset) to the first lock, -1 = never
+    uint32_t time_sync_unlock_count;
+    int64_t time_sync_error_max_us; // While locked
+    int64_t time_sync_error_us;     // Last step
+
+    // Boost converter from its first DS_OPERATIONAL on (since the last reset)
+    bool operational;
+    uint32_t operational_ms;      // Bus time it got there
+    uint32_t operational_lost_ms; // At DS_NON_OPERATIONAL or worse after it
+    uint8_t alarm_level_max;      // EVERT_DEVICE_Alarm_Check while operational
+} EVERT_HARNESS_NodeStateTypeDef;
+
+/// @brief A setpoint or an export limit of a scenario, sampled from its settle time to the next change of the same
+typedef struct
+{
+    uint32_t end_ms;
+    float power_min; // W DC, the boost converter or the sum of them
+    float power_max;
+    uint32_t sample_count;
+    uint32_t batch_count;  // BCCM_POWER_LIMIT_BATCH sent by the CCU from the action to the end
+    uint32_t batch_summed; // From the settle time on, the per-slot limits summed against the optimizer target
+    float batch_error_max; // W, largest difference of those sums to the target
+} EVERT_HARNESS_SettleTypeDef;
+
+typedef struct
+{
+    EVERT_HARNESS_BUS_TypeDef bus;
+    EVERT_HARNESS_NodeStateTypeDef nodes[EVERT_CONSTANT_HARNESS_NODE_COUNT];
+    uint32_t ccu_station;
+    uint64_t now_us;
+    bool trace;
+
+    uint32_t latencies_us[EVERT_CONSTANT_HARNESS_LATENCY_SAMPLES];
+    uint32_t latency_count;
+    uint64_t latency_total_count;
+    uint32_t unmatched_count; // Applied without a command handed to the node
+    uint32_t failed_count;
+
+    EVERT_HARNESS_SettleTypeDef settle[EVERT_CONSTANT_HARNESS_ACTION_MAX];
+    uint16_t batch_limits[EVERT_CONSTANT_CCU_DEVICE_COUNT]; // W, last slot limit put on the bus per device
+} EVERT_HARNESS_TypeDef;
+
+static EVERT_HARNESS_TypeDef harness;
+
+static const EVERT_HARNESS_NODE_ConfigTypeDef harness_nodes[EVERT_CONSTANT_HARNESS_NODE_COUNT] = {
+    {CDI_BOOST_CONVERTER1, HNR_BOOST_CONVERTER, 0, 1200.0f, 40},
+    {CDI_BOOST_CONVERTER2, HNR_BOOST_CONVERTER, 40, 900.0f, -25},
+    {CDI_INVERTER, HNR_INVERTER, 150, 0.0f, 10},
+};
+
+static const EVERT_HARNESS_ActionTypeDef harness_plant_actions[] = {
+    {5000, HAK_SETPOINT, CDI_BOOST_CONVERTER1, 600.0f},
+    {7000, HAK_SETPOINT, CDI_BOOST_CONVERTER2, 500.0f},
+    {9000, HAK_SETPOINT, CDI_BOOST_CONVERTER1, 800.0f},
+    {11000, HAK_SETPOINT, CDI_BOOST_CONVERTER1, NAN},
+    {11000, HAK_SETPOINT, CDI_BOOST_CONVERTER2, NAN},
+    {14000, HAK_EXPORT_LIMIT, 0, 1500.0f},
+    {14000, HAK_OPTIMIZE, 0, 1.0f},
+    {20000, HAK_EXPORT_LIMIT, 0, 1000.0f},
+    {24000, HAK_EXPORT_LIMIT, 0, -1.0f},
+};
+
+static const EVERT_HARNESS_ActionTypeDef harness_update_actions[] = {
+    {3000, HAK_SETPOINT, CDI_BOOST_CONVERTER1, 600.0f},
+    {4000, HAK_UPDATE, CDI_BOOST_CONVERTER1, 32768.0f},
+    {6000, HAK_SETPOINT, CDI_BOOST_CONVERTER2, 500.0f},
+};
+
+_Static_assert(sizeof(harness_plant_actions) / sizeof(harness_plant_actions[0]) <= EVERT_CONSTANT_HARNESS_ACTION_MAX, "Actions of a scenario");
+_Static_assert(sizeof(harness_update_actions) / sizeof(harness_update_actions[0]) <= EVERT_CONSTANT_HARNESS_ACTION_MAX, "Actions of a scenario");
+
+static const EVERT_HARNESS_ScenarioTypeDef harness_scenarios[] = {
+    {"boot", "power on, handshake and telemetry, no commands", 10, NULL, 0},
+    {"plant", "setpoints, then the optimizer with export limit steps", 30, harness_plant_actions, sizeof(harness_plant_actions) / sizeof(harness_plant_actions[0])},
+    {"update", "firmware update of boost converter 1 while boost converter 2 runs", 30, harness_update_actions, sizeof(harness_update_actions) / sizeof(harness_update_actions[0])},
+};
+
+static const char *EVERT_HARNESS_StationName(const uint32_t station)
+{
+    static const char *names[] = {"BC1", "BC2", "INV", "CCU"};
+
+    return station < sizeof(names) / sizeof(names[0]) ? names[station] : "?";
+}
+
+//
+// #region "Commands"
+//
+
+/// @brief Commands the node applies from a CCU frame, the latency runs from the CCU queueing it to the node applying it
+static void EVERT_HARNESS_OnHandOff(EVERT_HARNESS_NodeStateTypeDef *state, const EVERT_HARNESS_BUS_ItemTypeDef *item)
+{
+    EVERT_CCU_FrameTypeDef frame;
+
+    if (!EVERT_CCU_PROTOCOL_Decode(&item->frame, &frame) || frame.identifier.source_id != EVERT_CONSTANT_CCU_DEVICE_ID || frame.length == 0)
+    {
+        return;
+    }
+
+    uint8_t id = state->node.config.device_id;
+    uint8_t method = frame.data[0];
+    bool addressed = frame.identifier.target_id == id;
+    bool applies = false;
+
+    switch (method)
+    {
+    case BCCM_DEVICE_RESET:
+        applies = addressed;
+        break;
+
+    case BCCM_SET_RUNNING:
+        applies = addressed && state->node.config.role == HNR_BOOST_CONVERTER;
+        break;
+
+    case BCCM_POWER_LIMIT:
+        applies = addressed && frame.length >= 5 && state->node.config.role == HNR_BOOST_CONVERTER;
+        break;
+
+    case BCCM_POWER_LIMIT_BATCH:
+    {
+        int32_t slot = (int32_t)id - 1 - EVERT_CCU_BATCH_GROUP_SIZE * (int32_t)frame.identifier.message_id;
+        uint16_t power_limit = EVERT_CCU_BATCH_UNCHANGED;
+
+        if (frame.identifier.target_id == EVERT_CCU_PROTOCOL_BROADCAST && frame.length >= 7 && slot >= 0 && slot < EVERT_CCU_BATCH_GROUP_SIZE)
+        {
+            memcpy(&power_limit, &frame.data[1 + 2 * slot], sizeof(power_limit));
+        }
+
+        applies = power_limit != EVERT_CCU_BATCH_UNCHANGED && state->node.config.role == HNR_BOOST_CONVERTER;
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    if (!applies)
+    {
+        return;
+    }
+
+    EVERT_HARNESS_PendingTypeDef *pending = &state->pending[method];
+
+    if (pending->count == EVERT_CONSTANT_HARNESS_PENDING_COMMANDS)
+    {
+        // The node is this far behind, the oldest counts as lost
+        pending->head = (pending->head + 1) % EVERT_CONSTANT_HARNESS_PENDING_COMMANDS;
+        pending->count--;
+    }
+
+    pending->queued_us[(pending->head + pending->count) % EVERT_CONSTANT_HARNESS_PENDING_COMMANDS] = item->queued_us;
+    pending->count++;
+}
+
+static void EVERT_HARNESS_OnApplied(EVERT_HARNESS_NodeStateTypeDef *state, const uint8_t method, const uint64_t applied_us)
+{
+    EVERT_HARNESS_PendingTypeDef *pending = method < EVERT_HARNESS_METHOD_COUNT ? &state->pending[method] : NULL;
+
+    if (pending == NULL || pending->count == 0)
+    {
+        harness.unmatched_count++;
+        return;
+    }
+
+    uint64_t queued_us = pending->queued_us[pending->head];
+    pending->head = (pending->head + 1) % EVERT_CONSTANT_HARNESS_PENDING_COMMANDS;
+    pending->count--;
+
+    state->command_count++;
+    harness.latency_total_count++;
+
+    if (harness.latency_count < EVERT_CONSTANT_HARNESS_LATENCY_SAMPLES)
+    {
+        harness.latencies_us[harness.latency_count++] = (uint32_t)(applied_us - queued_us);
+    }
+}
+
+static uint32_t EVERT_HARNESS_Unapplied(void)
+{
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < EVERT_CONSTANT_HARNESS_NODE_COUNT; i++)
+    {
+        for (uint32_t method = 0; method < EVERT_HARNESS_METHOD_COUNT; method++)
+        {
+            const EVERT_HARNESS_PendingTypeDef *pending = &harness.nodes[i].pending[method];
+
+            for (uint32_t j = 0; j < pending->count; j++)
+            {
+                count += pending->queued_us[(pending->head + j) % EVERT_CONSTANT_HARNESS_PENDING_COMMANDS] + EVERT_HARNESS_UNAPPLIED_AGE_US < harness.now_us;
+            }
+        }
+    }
+
+    return count;
+}
+
+//
+// #endregion "Commands"
+//
+
+//
+// #region "Run"
+//
+
+static void EVERT_HARNESS_OnFrame(const uint32_t station, const EVERT_HARNESS_BUS_ItemTypeDef *item, const uint64_t start_us)
+{
+    if (!harness.trace)
+    {
+        return;
+    }
+
+    printf("%10.6f  %s  %08" PRIX32 " %s [%u]", (double)start_us / 1e6, EVERT_HARNESS_StationName(station),
+           (uint32_t)(item->frame.can_id & CAN_EFF_MASK), (item->frame.can_id & CAN_EFF_FLAG) ? "ext" : "std", item->frame.len);
+
+    for (uint32_t i = 0; i < item->frame.len; i++)
+    {
+        printf(" %02X", item->frame.data[i]);
+    }
+
+    printf("  queued %.3f ms\n", (double)(start_us - item->queued_us) / 1e3);
+}
+
+/// @brief Image of size bytes that is the same on every run
+static void EVERT_HARNESS_AddUpdate(const uint8_t device_id, const uint32_t size)
+{
+    static uint8_t image[EVERT_CCU_UPDATE_APP_SIZE_MAX];
+    static const uint8_t version[3] = EVERT_HARNESS_UPDATE_VERSION;
+    uint32_t x = 0x2545F491u;
+
+    for (uint32_t i = 0; i < size && i < sizeof(image); i++)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        image[i] = (uint8_t)x;
+    }
+
+    // Stack pointer and reset vector the bootloader boots into
+    const uint32_t vectors[2] = {EVERT_FIRMWARE_IMAGE_RAM_BASE + EVERT_FIRMWARE_IMAGE_RAM_SIZE, EVERT_FIRMWARE_IMAGE_ACTIVE_BASE + EVERT_FIRMWARE_IMAGE_APP_OFFSET + 1u};
+    memcpy(image, vectors, size < sizeof(vectors) ? size : sizeof(vectors));
+
+    if (!EVERT_CCU_UPDATE_Add(device_id, image, size, version))
+    {
+        fprintf(stderr, "HARNESS: update of device %u not queued\n", device_id);
+    }
+}
+
+static void EVERT_HARNESS_Apply(const EVERT_HARNESS_ActionTypeDef *action)
+{
+    switch (action->kind)
+    {
+    case HAK_UPDATE:
+        EVERT_HARNESS_AddUpdate(action->device_id, (uint32_t)action->value);
+        break;
+
+    case HAK_SETPOINT:
+        EVERT_CCU_DISPATCH_SetPowerSetpoint(action->device_id, action->value);
+        break;
+
+    case HAK_OPTIMIZE:
+        EVERT_CCU_DISPATCH_SetOptimizer(action->value != 0.0f);
+        break;
+
+    case HAK_EXPORT_LIMIT:
+        EVERT_CCU_DISPATCH_SetExportLimit(action->value);
+        break;
+    }
+}
+
+/// @brief Setpoints and export limits settle to a power, releases and the export limit off do not
+static bool EVERT_HARNESS_Settles(const EVERT_HARNESS_ActionTypeDef *action)
+{
+    return (action->kind == HAK_SETPOINT && !isnan(action->value)) || (action->kind == HAK_EXPORT_LIMIT && action->value >= 0.0f);
+}
+
+/// @brief Power the action settles: its boost converter, the sum of them for the export limit
+/// @param start_ms Set to the action or the boost converters getting operational after it (a reset), the later
+/// @return false while one of them is not operational
+static bool EVERT_HARNESS_SettlePower(const EVERT_HARNESS_ActionTypeDef *action, float *power, uint32_t *start_ms)
+{
+    *power = 0.0f;
+    *start_ms = action->time_ms;
+
+    for (uint32_t i = 0; i < EVERT_CONSTANT_HARNESS_NODE_COUNT; i++)
+    {
+        const EVERT_HARNESS_NodeStateTypeDef *state = &harness.nodes[i];
+
+        if (state->node.config.role != HNR_BOOST_CONVERTER || (action->kind == HAK_SETPOINT && state->node.config.device_id != action->device_id))
+        {
+            continue;
+        }
+
+        // An update activated stops the power stage for the reset
+        if (!state->operational || state->node.report.update_state == CUS_READY)
+        {
+            return false;
+        }
+
+        *power += state->node.report.power;
+        *start_ms = state->operational_ms > *start_ms ? state->operational_ms : *start_ms;
+    }
+
+    return true;
+}
+
+/// @brief Each action holds until the next one of its kind (and device), or the end of the run
+static void EVERT_HARNESS_SettleInit(const EVERT_HARNESS_ScenarioTypeDef *scenario, const uint32_t duration_s)
+{
+    for (uint32_t i = 0; i < scenario->action_count; i++)
+    {
+        const EVERT_HARNESS_ActionTypeDef *action = &scenario->actions[i];
+        EVERT_HARNESS_SettleTypeDef *settle = &harness.settle[i];
+
+        settle->end_ms = duration_s * 1000u;
+        settle->power_min = INFINITY;
+        settle->power_max = -INFINITY;
+        settle->batch_error_max = 0.0f;
+
+        for (uint32_t j = 0; j < scenario->action_count; j++)
+        {
+            const EVERT_HARNESS_ActionTypeDef *next = &scenario->actions[j];
+
+            if (next->time_ms > action->time_ms && next->time_ms < settle->end_ms && next->kind == action->kind && next->device_id == action->device_id)
+            {
+                settle->end_ms = next->time_ms;
+            }
+        }
+    }
+}
+
+/// @brief The power of the actions past their settle time, after the nodes stepped
+static void EVERT_HARNESS_SettleSample(const EVERT_HARNESS_ScenarioTypeDef *scenario, const uint32_t time_ms)
+{
+    for (uint32_t i = 0; i < scenario->action_count; i++)
+    {
+        const EVERT_HARNESS_ActionTypeDef *action = &scenario->actions[i];
+        EVERT_HARNESS_SettleTypeDef *settle = &harness.settle[i];
+
+        float power;
+        uint32_t start_ms;
+
+        if (!EVERT_HARNESS_Settles(action) || time_ms < action->time_ms || time_ms >= settle->end_ms || !EVERT_HARNESS_SettlePower(action, &power, &start_ms) ||
+            time_ms < start_ms + EVERT_CONSTRAINT_HARNESS_SETTLE_MS)
+        {
+            continue;
+        }
+
+        settle->power_min = power < settle->power_min ? power : settle->power_min;
+        settle->power_max = power > settle->power_max ? power : settle->power_max;
+        settle->sample_count++;
+    }
+}
+
+/// @brief Batches of the optimizer the CCU puts on the bus, counted to the export limit in force and, from its
+///        settle time on, the last limit of every device summed against the target of the run the batch comes from
+static void EVERT_HARNESS_OnCcuTransmit(const EVERT_HARNESS_ScenarioTypeDef *scenario, const struct can_frame *can_frame, const uint32_t time_ms)
+{
+    EVERT_CCU_FrameTypeDef frame;
+
+    if (!EVERT_CCU_PROTOCOL_Decode(can_frame, &frame) || frame.length < 1 + 2 * EVERT_CCU_BATCH_GROUP_SIZE || frame.data[0] != BCCM_POWER_LIMIT_BATCH)
+    {
+        return;
+    }
+
+    for (uint8_t slot = 0; slot < EVERT_CCU_BATCH_GROUP_SIZE; slot++)
+    {
+        uint32_t id = 1u + frame.identifier.message_id * EVERT_CCU_BATCH_GROUP_SIZE + slot;
+        uint16_t limit;
+
+        memcpy(&limit, &frame.data[1 + 2 * slot], sizeof(limit));
+
+        if (id < EVERT_CONSTANT_CCU_DEVICE_COUNT && limit != EVERT_CCU_BATCH_UNCHANGED)
+        {
+            harness.batch_limits[id] = limit;
+        }
+    }
+
+    const EVERT_CCU_OPTIMIZER_StateTypeDef *state = EVERT_CCU_DISPATCH_GetOptimizer();
+    float sum = 0.0f;
+
+    for (uint32_t id = 1; id < EVERT_CONSTANT_CCU_DEVICE_COUNT; id++)
+    {
+        // Released slots do not add up to a target, the check fails on them
+        sum += harness.batch_limits[id] == EVERT_CCU_BATCH_UNLIMITED ? INFINITY : (float)harness.batch_limits[id];
+    }
+
+    for (uint32_t i = 0; i < scenario->action_count; i++)
+    {
+        const EVERT_HARNESS_ActionTypeDef *action = &scenario->actions[i];
+        EVERT_HARNESS_SettleTypeDef *settle = &harness.settle[i];
+
+        if (action->kind != HAK_EXPORT_LIMIT || time_ms < action->time_ms || time_ms >= settle->end_ms)
+        {
+            continue;
+        }
+
+        settle->batch_count++;
+
+        if (time_ms >= action->time_ms + EVERT_CONSTRAINT_HARNESS_SETTLE_MS)
+        {
+            float error = state != NULL ? fabsf(sum - state->target) : INFINITY;
+
+            settle->batch_error_max = error > settle->batch_error_max ? error : settle->batch_error_max;
+            settle->batch_summed++;
+        }
+    }
+}
+
+/// @brief Node crystal at a bus time, since the power on of the node
+static uint64_t EVERT_HARNESS_NodeClock(const EVERT_HARNESS_NODE_ConfigTypeDef *config, const uint64_t bus_us)
+{
+    uint64_t power_on_us = (uint64_t)config->power_on_ms * 1000u;
+    int64_t elapsed = bus_us > power_on_us ? (int64_t)(bus_us - power_on_us) : 0;
+
+    return (uint64_t)(elapsed + elapsed * config->clock_ppm / 1000000);
+}
+
+/// @brief Synchronized time of a boost converter against the CCU time of the step
+static void EVERT_HARNESS_OnTimeSync(EVERT_HARNESS_NodeStateTypeDef *state, const uint32_t time_ms)
+{
+    const EVERT_HARNESS_NODE_ReportTypeDef *report = &state->node.report;
+
+    if (state->node.config.role != HNR_BOOST_CONVERTER || report->time_sync_us == 0)
+    {
+        return;
+    }
+
+    state->time_sync_error_us = (int64_t)(report->time_sync_us - (EVERT_HARNESS_CCU_EPOCH_US + harness.now_us));
+
+    if (!report->time_sync_locked)
+    {
+        state->time_sync_unlock_count += state->time_sync_locked_ms >= 0;
+        return;
+    }
+
+    if (state->time_sync_locked_ms < 0)
+    {
+        state->time_sync_locked_ms = time_ms - state->node.config.power_on_ms - state->reset_ms;
+    }
+
+    int64_t error = state->time_sync_error_us < 0 ? -state->time_sync_error_us : state->time_sync_error_us;
+    state->time_sync_error_max_us = error > state->time_sync_error_max_us ? error : state->time_sync_error_max_us;
+}
+
+/// @brief A boost converter once operational stays so, a reset starts over
+static void EVERT_HARNESS_OnOperational(EVERT_HARNESS_NodeStateTypeDef *state)
+{
+    const EVERT_HARNESS_NODE_ReportTypeDef *report = &state->node.report;
+
+    if (state->node.config.role != HNR_BOOST_CONVERTER)
+    {
+        return;
+    }
+
+    if (!state->operational && (report->result_state == DS_OPERATIONAL || report->result_state == DS_OPERATIONAL_WARNING))
+    {
+        state->operational = true;
+        state->operational_ms = (uint32_t)(harness.now_us / 1000u);
+    }
+
+    if (state->operational)
+    {
+        state->operational_lost_ms += report->result_state >= DS_NON_OPERATIONAL;
+        state->alarm_level_max = report->alarm_level > state->alarm_level_max ? report->alarm_level : state->alarm_level_max;
+    }
+}
+
+/// @brief One ms of one node: the frames it received, its step, its frames into the controller
+static bool EVERT_HARNESS_StepNode(EVERT_HARNESS_NodeStateTypeDef *state, const uint32_t time_ms)
+{
+    EVERT_HARNESS_NODE_TypeDef *node = &state->node;
+    EVERT_HARNESS_BUS_ItemTypeDef item;
+
+    if (time_ms < node->config.power_on_ms)
+    {
+        // Powered off, the frames go nowhere
+        while (EVERT_HARNESS_BUS_Receive(&harness.bus, node->station, harness.now_us, &item))
+        {
+        }
+
+        return true;
+    }
+
+    static EVERT_HARNESS_NODE_StepTypeDef step;
+    step.tick = time_ms - node->config.power_on_ms;
+    step.local_us = EVERT_HARNESS_NodeClock(&node->config, harness.now_us);
+    step.tx_pending = EVERT_HARNESS_BUS_TxPending(&harness.bus, node->station);
+    step.rx_count = 0;
+    step.stop = false;
+
+    while (step.rx_count < EVERT_CONSTANT_HARNESS_STEP_RX_MAX && EVERT_HARNESS_BUS_Receive(&harness.bus, node->station, harness.now_us, &item))
+    {
+        step.rx_start_us[step.rx_count] = EVERT_HARNESS_NodeClock(&node->config, item.start_us);
+        step.rx[step.rx_count++] = item.frame;
+        EVERT_HARNESS_OnHandOff(state, &item);
+    }
+
+    if (!EVERT_HARNESS_NODE_Step(node, &step))
+    {
+        return false;
+    }
+
+    EVERT_HARNESS_OnTimeSync(state, time_ms);
+    EVERT_HARNESS_OnOperational(state);
+
+    for (uint32_t i = 0; i < node->report.tx_count; i++)
+    {
+        // The node saw the Tx FIFO level, the bus cannot be full
+        EVERT_HARNESS_BUS_Transmit(&harness.bus, node->station, &node->report.tx[i], harness.now_us);
+    }
+
+    for (uint32_t i = 0; i < node->report.event_count; i++)
+    {
+        const EVERT_HARNESS_NODE_EventTypeDef *event = &node->report.events[i];
+
+        if (event->kind == HNE_COMMAND)
+        {
+            EVERT_HARNESS_OnApplied(state, event->value, ((uint64_t)node->config.power_on_ms + event->tick) * 1000u);
+        }
+        // The state is sampled, a node can pass the acknowledged state within a sample
+        else if (event->kind == HNE_STATE && event->value >= DS_HANDSHAKE_ACKNOWLEDGED && !state->acknowledged)
+        {
+            state->acknowledged = true;
+            state->acknowledged_ms = state->acknowledged_ms < 0 ? (int64_t)event->tick : state->acknowledged_ms;
+        }
+        else if (event->kind == HNE_STATE && event->value == DS_HANDSHAKE_ANNOUNCING && state->acknowledged)
+        {
+            state->acknowledged = false;
+            state->handshake_lost_count++;
+        }
+        else if (event->kind == HNE_RESET)
+        {
+            // A handshake and a time sync lock again, from the reset on
+            state->acknowledged = false;
+            state->reset_count++;
+            state->reset_ms = event->tick;
+            state->time_sync_locked_ms = -1;
+            state->operational = false;
+        }
+    }
+
+    return true;
+}
+
+/// @brief The CCU for one ms: received frames, the worker tick and the actions due, the TX queue to the bus
+static void EVERT_HARNESS_StepCcu(const EVERT_HARNESS_ScenarioTypeDef *scenario, const uint32_t time_ms)
+{
+    EVERT_HARNESS_BUS_ItemTypeDef item;
+
+    while (EVERT_HARNESS_BUS_Receive(&harness.bus, harness.ccu_station, harness.now_us, &item))
+    {
+        EVERT_HARNESS_CCU_OnFrame(&item.frame, item.received_us);
+    }
+
+    if (time_ms % EVERT_CONSTANT_CCU_TICK_MS == 0)
+    {
+        for (uint32_t i = 0; i < scenario->action_count; i++)
+        {
+            if (scenario->actions[i].time_ms == time_ms)
+            {
+                EVERT_HARNESS_Apply(&scenario->actions[i]);
+            }
+        }
+
+        EVERT_HARNESS_CCU_OnTick(harness.now_us);
+    }
+
+    const struct can_frame *frame;
+
+    while (EVERT_HARNESS_BUS_TxFree(&harness.bus, harness.ccu_station) > 0 && (frame = EVERT_HARNESS_CCU_Peek()) != NULL)
+    {
+        EVERT_HARNESS_OnCcuTransmit(scenario, frame, time_ms);
+        EVERT_HARNESS_BUS_Transmit(&harness.bus, harness.ccu_station, frame, harness.now_us);
+        EVERT_HARNESS_CCU_Consume();
+    }
+}
+
+static bool EVERT_HARNESS_Run(const EVERT_HARNESS_ScenarioTypeDef *scenario, const uint32_t duration_s)
+{
+    EVERT_HARNESS_SettleInit(scenario, duration_s);
+
+    for (uint32_t time_ms = 0; time_ms < duration_s * 1000u; time_ms++)
+    {
+        harness.now_us = (uint64_t)time_ms * 1000u;
+
+        for (uint32_t i = 0; i < EVERT_CONSTANT_HARNESS_NODE_COUNT; i++)
+        {
+            if (!EVERT_HARNESS_StepNode(&harness.nodes[i], time_ms))
+            {
+                return false;
+            }
+        }
+
+        EVERT_HARNESS_SettleSample(scenario, time_ms);
+        EVERT_HARNESS_StepCcu(scenario, time_ms);
+        EVERT_HARNESS_BUS_Run(&harness.bus, harness.now_us + 1000u);
+    }
+
+    harness.now_us = (uint64_t)duration_s * 1000000u;
+
+    return true;
+}
+
+//
+// #endregion "Run"
+//
+
+//
+// #region "Report"
+//
+
+static int EVERT_HARNESS_CompareUint32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void EVERT_HARNESS_Check(const bool passed, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+static void EVERT_HARNESS_Check(const bool passed, const char *format, ...)
+{
+    va_list arguments;
+    va_start(arguments, format);
+    printf("  %s  ", passed ? "PASS" : "FAIL");
+    vprintf(format, arguments);
+    printf("\n");
+    va_end(arguments);
+
+    harness.failed_count += !passed;
+}
+
+static void EVERT_HARNESS_Report(const EVERT_HARNESS_ScenarioTypeDef *scenario, const double wall_s)
+{
+    const EVERT_HARNESS_BUS_TypeDef *bus = &harness.bus;
+    double duration_s = (double)harness.now_us / 1e6;
+
+    printf("\nScenario %s: %s\n", scenario->name, scenario->description);
+    printf("  %.1f s virtual in %.2f s (%.0fx), %" PRIu32 " bit/s, latency %" PRIu32 " us, loss %.4f\n",
+           duration_s, wall_s, wall_s > 0.0 ? duration_s / wall_s : 0.0, bus->bitrate, bus->latency_us, bus->loss);
+
+    printf("\nNode  id  power on  acknowledged  tx      rx      lost  arb lost  commands\n");
+
+    for (uint32_t i = 0; i < harness.bus.station_count; i++)
+    {
+        const EVERT_HARNESS_BUS_StationTypeDef *station = &bus->stations[i];
+        bool is_node = i < EVERT_CONSTANT_HARNESS_NODE_COUNT;
+        const EVERT_HARNESS_NodeStateTypeDef *state = is_node ? &harness.nodes[i] : NULL;
+
+        printf("%-4s  %2u  %5" PRIu32 " ms  ", EVERT_HARNESS_StationName(i), is_node ? state->node.config.device_id : EVERT_CONSTANT_CCU_DEVICE_ID, is_node ? state->node.config.power_on_ms : 0);
+
+        if (is_node && state->acknowledged_ms >= 0)
+        {
+            printf("%7" PRId64 " ms  ", state->acknowledged_ms);
+        }
+        else
+        {
+            printf("%10s  ", "-");
+        }
+
+        printf("%-6" PRIu64 "  %-6" PRIu64 "  %-4" PRIu64 "  %-8" PRIu64 "  ", station->tx_count, station->rx_count, station->lost_count, station->arbitration_lost_count);
+
+        if (is_node)
+        {
+            printf("%" PRIu32 "\n", state->command_count);
+        }
+        else
+        {
+            printf("-\n");
+        }
+    }
+
+    // CAN handler statistics of the nodes: peaks against the buffer sizes, waits in the Tx buffer
+    printf("\nNode  load est  rx buffer  tx buffer  rx FIFO  tx FIFO  tx wait avg/max  rx wait max  bytes/frame\n");
+
+    for (uint32_t i = 0; i < EVERT_CONSTANT_HARNESS_NODE_COUNT; i++)
+    {
+        const EVERT_CAN_StatisticsTypeDef *can = &harness.nodes[i].node.report.can;
+        uint32_t frame_count = can->rx_frame_count + can->tx_frame_count;
+
+        printf("%-4s  %5.1f %%   %2u/%-2u      %2u/%-2u      %u/%u      %u/%u      %5" PRIu32 "/%-5" PRIu32 " us  %5" PRIu32 " us     %.2f\n",
+               EVERT_HARNESS_StationName(i), can->load_permille / 10.0,
+               can->rx_buffer_high_water, EVERT_CONSTANT_HARNESS_CAN_BUFFER_SIZE, can->tx_buffer_high_water, EVERT_CONSTANT_HARNESS_CAN_BUFFER_SIZE,
+               can->rx_fifo_high_water, FDCAN_RX_FIFO_SIZE, can->tx_fifo_high_water, FDCAN_TX_FIFO_SIZE,
+               can->tx_wait_average_us, can->tx_wait_max_us, can->rx_wait_max_us,
+               frame_count > 0 ? (double)(can->rx_byte_count + can->tx_byte_count) / frame_count : 0.0);
+    }
+
+    // Load, the last window counts once complete
+    double load_peak = bus->load_peak;
+
+    if (harness.now_us >= bus->window_start_us + EVERT_CONSTANT_HARNESS_LOAD_WINDOW_MS * 1000u)
+    {
+        double load = (double)bus->window_busy_us / (EVERT_CONSTANT_HARNESS_LOAD_WINDOW_MS * 1000.0);
+        load_peak = load > load_peak ? load : load_peak;
+    }
+
+    double load_average = EVERT_HARNESS_BUS_LoadAverage(bus);
+
+    printf("\nBus: %" PRIu64 " frames, %.1f bits/frame, %.1f frames/s, load %.2f %% average, %.2f %% peak (%u ms window)\n",
+           bus->frame_count, bus->frame_count > 0 ? (double)bus->bit_count / (double)bus->frame_count : 0.0,
+           (double)bus->frame_count / duration_s, load_average * 100.0, load_peak * 100.0, EVERT_CONSTANT_HARNESS_LOAD_WINDOW_MS);
+
+    // Command latency
+    double p50_ms = 0.0, p99_ms = 0.0, max_ms = 0.0;
+
+    if (harness.latency_count > 0)
+    {
+        qsort(harness.latencies_us, harness.latency_count, sizeof(harness.latencies_us[0]), EVERT_HARNESS_CompareUint32);
+        p50_ms = harness.latencies_us[harness.latency_count / 2] / 1e3;
+        p99_ms = harness.latencies_us[(harness.latency_count * 99) / 100] / 1e3;
+        max_ms = harness.latencies_us[harness.latency_count - 1] / 1e3;
+    }
+
+    printf("Commands: %" PRIu64 " applied, latency %.3f ms median, %.3f ms p99, %.3f ms max\n", harness.latency_total_count, p50_ms, p99_ms, max_ms);
+
+    // Boot phases of the last power on (EVERT_DEVICE_BootTimingTypeDef), node time
+    printf("\nNode  powered on  adc      comms  handshake  operational\n");
+
+    for (uint32_t i = 0; i < EVERT_CONSTANT_HARNESS_NODE_COUNT; i++)
+    {
+        const EVERT_DEVICE_BootTimingTypeDef *boot = &harness.nodes[i].node.report.boot;
+
+        printf("%-4s  %7" PRIu32 " ms  %3" PRIu32 " ms%s  %2" PRIu32 " ms  %6" PRIu32 " ms  %8" PRIu32 " ms\n",
+               EVERT_HARNESS_StationName(i), boot->InitMs, boot->AdcMs, boot->AdcTimeout ? "*" : " ", boot->CommsMs, boot->HandshakeMs, boot->OperationalMs);
+    }
+
+    // Time synchronization: the rate the node learned against its crystal
+    printf("\nNode  crystal   rate learned  locked after  error max  error last  steps\n");
+
+    for (uint32_t i = 0; i < EVERT_CONSTANT_HARNESS_NODE_COUNT; i++)
+    {
+        const EVERT_HARNESS_NodeStateTypeDef *state = &harness.nodes[i];
+
+        if (state->node.config.role != HNR_BOOST_CONVERTER)
+        {
+            continue;
+        }
+
+        printf("%-4s  %+4" PRId32 " ppm  %+9.3f ppm  ", EVERT_HARNESS_StationName(i), state->node.config.clock_ppm, state->node.report.time_sync_rate_ppb / 1e3);
+
+        if (state->time_sync_locked_ms >= 0)
+        {
+            printf("%7" PRId64 " ms", state->time_sync_locked_ms);
+        }
+        else
+        {
+            printf("%10s", "-");
+        }
+
+        printf("  %6" PRId64 " us  %+7" PRId64 " us  %" PRIu32 "\n", state->time_sync_error_max_us, state->time_sync_error_us, state->node.report.time_sync_step_count);
+    }
+
+    // Delta telemetry against the registry stream of the same signals, one [slot][float32] per frame
+    printf("\nNode  signals  samples  frames  keyframe  frames/sample  bytes/sample  stream frames/sample  reduction\n");
+
+    for (uint32_t i = 0; i < EVERT_CONSTANT_HARNESS_NODE_COUNT; i++)
+    {
+        const EVERT_HARNESS_NODE_ReportTypeDef *report = &harness.nodes[i].node.report;
+
+        if (harness.nodes[i].node.config.role != HNR_BOOST_CONVERTER || report->telemetry_sample_count == 0)
+        {
+            continue;
+        }
+
+        double frames = (double)report->telemetry_frame_count / report->telemetry_sample_count;
+
+        printf("%-4s  %7" PRIu32 "  %7" PRIu32 "  %6" PRIu32 "  %8" PRIu32 "  %13.2f  %12.2f  %20" PRIu32 "  %8.1fx\n",
+               EVERT_HARNESS_StationName(i), report->telemetry_signal_count, report->telemetry_sample_count, report->telemetry_frame_count,
+               report->telemetry_keyframe_frame_count, frames, (double)report->telemetry_byte_count / report->telemetry_sample_count,
+               report->telemetry_signal_count, frames > 0.0 ? report->telemetry_signal_count / frames : 0.0);
+    }
+
+    printf("\nCCU:\n");
+    EVERT_CCU_DEVICES_Print(stdout, EVERT_HARNESS_CCU_EPOCH_US + harness.now_us);
+    EVERT_CCU_DISPATCH_Print(stdout);
+    EVERT_CCU_TIMESYNC_Print(stdout);
+    EVERT_CCU_TELEMETRY_Print(stdout);
+    EVERT_CCU_UPDATE_Print(stdout);
+
+    // Checks
+    const uint32_t handshake_max_ms = EVERT_CONSTRAINT_HARNESS_BOOT_ADC_MAX_MS + EVERT_CONSTRAINT_HARNESS_HANDSHAKE_MARGIN_MS;
+    printf("\nChecks:\n");
+
+    for (uint32_t i = 0; i < EVERT_CONSTANT_HARNESS_NODE_COUNT; i++)
+    {
+        const EVERT_HARNESS_NodeStateTypeDef *state = &harness.nodes[i];
+        const EVERT_HARNESS_NODE_ReportTypeDef *report = &state->node.report;
+        const EVERT_CCU_DeviceTypeDef *device = EVERT_CCU_DEVICES_Get(state->node.config.device_id);
+        const char *name = EVERT_HARNESS_StationName(i);
+
+        if (state->acknowledged_ms >= 0)
+        {
+            EVERT_HARNESS_Check(state->acknowledged_ms <= handshake_max_ms, "%s handshake %" PRId64 " ms after power on (<= %" PRIu32 " ms)", name, state->acknowledged_ms, handshake_max_ms);
+        }
+        else
+        {
+            EVERT_HARNESS_Check(false, "%s handshake never acknowledged", name);
+        }
+        EVERT_HARNESS_Check(!report->boot.AdcTimeout && report->boot.AdcMs <= EVERT_CONSTRAINT_HARNESS_BOOT_ADC_MAX_MS && report->boot.OperationalMs > 0,
+                            "%s boot: readings settled after %" PRIu32 " ms (<= %u ms, %s), operational after %" PRIu32 " ms",
+                            name, report->boot.AdcMs, EVERT_CONSTRAINT_HARNESS_BOOT_ADC_MAX_MS, report->boot.AdcTimeout ? "timed out" : "by sample count",
+                            report->boot.OperationalMs);
+        EVERT_HARNESS_Check(state->handshake_lost_count == 0 && device != NULL && device->online && device->offline_count <= state->reset_count,
+                            "%s handshake kept (lost %" PRIu32 ", offline at the CCU %" PRIu32 ", resets %" PRIu32 ")",
+                            name, state->handshake_lost_count, device != NULL ? device->offline_count : 0, state->reset_count);
+        EVERT_HARNESS_Check(report->rx_lost_count == 0 && report->can.rx_buffer_full_count == 0 && report->can.tx_buffer_full_count == 0 && report->event_overflow_count == 0,
+                            "%s no frames dropped by the firmware (rx FIFO %" PRIu32 ", rx buffer %" PRIu32 ", tx buffer %" PRIu32 ")",
+                            name, report->rx_lost_count, report->can.rx_buffer_full_count, report->can.tx_buffer_full_count);
+
+        if (state->node.config.role == HNR_BOOST_CONVERTER)
+        {
+            EVERT_HARNESS_Check(state->time_sync_locked_ms >= 0 && state->time_sync_locked_ms <= EVERT_CONSTRAINT_HARNESS_TIME_SYNC_LOCK_MS && state->time_sync_unlock_count == 0 &&
+                                    state->time_sync_error_max_us <= EVERT_CONSTRAINT_HARNESS_TIME_SYNC_ERROR_US,
+                                "%s time sync locked after %" PRId64 " ms (<= %u ms), kept (lost %" PRIu32 "), error %" PRId64 " us (<= %u us)",
+                                name, state->time_sync_locked_ms, EVERT_CONSTRAINT_HARNESS_TIME_SYNC_LOCK_MS, state->time_sync_unlock_count,
+                                state->time_sync_error_max_us, EVERT_CONSTRAINT_HARNESS_TIME_SYNC_ERROR_US);
+
+            const EVERT_CCU_DELTA_TELEMETRY_DecoderTypeDef *delta = EVERT_CCU_TELEMETRY_GetDelta(state->node.config.device_id);
+            EVERT_HARNESS_Check(state->operational && state->operational_lost_ms == 0 && state->alarm_level_max < DS_NON_OPERATIONAL &&
+                                    (report->result_state == DS_OPERATIONAL || report->result_state == DS_OPERATIONAL_WARNING),
+                                "%s operational, kept (%" PRIu32 " ms non-operational after), alarm level %u at worst (< %u), state %u at the end",
+                                name, state->operational_lost_ms, state->alarm_level_max, DS_NON_OPERATIONAL, report->result_state);
+
+            EVERT_HARNESS_Check(delta != NULL && delta->complete && delta->signal_count == report->telemetry_signal_count && delta->value_count > 0 && delta->error_count == 0,
+                                "%s telemetry decoded (%" PRIu32 "/%" PRIu32 " signals listed, %" PRIu64 " values, %" PRIu64 " malformed)",
+                                name, delta != NULL ? delta->signal_count : 0, report->telemetry_signal_count, delta != NULL ? delta->value_count : 0, delta != NULL ? delta->error_count : 0);
+        }
+
+        const EVERT_CCU_UPDATE_JobTypeDef *job = EVERT_CCU_UPDATE_Get(state->node.config.device_id);
+
+        if (job != NULL)
+        {
+            EVERT_HARNESS_Check(job->phase == CUP_DONE && state->reset_count == 1 && memcmp(report->version, job->header.version, sizeof(report->version)) == 0,
+                                "%s updated to %u.%u.%u (running %u.%u.%u, %" PRIu32 " reset(s), %" PRIu32 " rewinds, %" PRIu32 " timeouts)",
+                                name, job->header.version[0], job->header.version[1], job->header.version[2],
+                                report->version[0], report->version[1], report->version[2], state->reset_count, job->rewind_count, job->timeout_count);
+        }
+    }
+
+    EVERT_HARNESS_Check(load_peak <= EVERT_CONSTRAINT_HARNESS_LOAD_PEAK_MAX, "bus load peak %.2f %% (<= %.0f %%)", load_peak * 100.0, EVERT_CONSTRAINT_HARNESS_LOAD_PEAK_MAX * 100.0);
+    EVERT_HARNESS_Check(load_average <= EVERT_CONSTRAINT_HARNESS_LOAD_AVERAGE_MAX, "bus load average %.2f %% (<= %.0f %%)", load_average * 100.0, EVERT_CONSTRAINT_HARNESS_LOAD_AVERAGE_MAX * 100.0);
+
+    if (scenario->action_count > 0)
+    {
+        EVERT_HARNESS_Check(harness.latency_count > 0 && p99_ms <= EVERT_CONSTRAINT_HARNESS_COMMAND_LATENCY_MAX_MS,
+                            "command latency p99 %.3f ms over %" PRIu32 " commands (<= %.1f ms)", p99_ms, harness.latency_count, EVERT_CONSTRAINT_HARNESS_COMMAND_LATENCY_MAX_MS);
+    }
+
+    // Setpoints and export limits: the power from the settle time on to the next change
+    for (uint32_t i = 0; i < scenario->action_count; i++)
+    {
+        const EVERT_HARNESS_ActionTypeDef *action = &scenario->actions[i];
+        const EVERT_HARNESS_SettleTypeDef *settle = &harness.settle[i];
+
+        if (!EVERT_HARNESS_Settles(action) || settle->end_ms <= action->time_ms + EVERT_CONSTRAINT_HARNESS_SETTLE_MS)
+        {
+            continue;
+        }
+
+        if (action->kind == HAK_SETPOINT)
+        {
+            float tolerance = action->value * EVERT_CONSTRAINT_HARNESS_SETPOINT_TOLERANCE;
+
+            EVERT_HARNESS_Check(settle->sample_count > 0 && settle->power_min >= action->value - tolerance && settle->power_max <= action->value + tolerance,
+                                "device %u setpoint %.0f W at %" PRIu32 " ms: %.0f to %.0f W from %u ms on (+-%.0f W)",
+                                action->device_id, action->value, action->time_ms, settle->power_min, settle->power_max, EVERT_CONSTRAINT_HARNESS_SETTLE_MS, tolerance);
+        }
+        else
+        {
+            // AC through the inverter efficiency the optimizer assumes
+            float efficiency = EVERT_SETTING_CCU_OPTIMIZER_INVERTER_EFFICIENCY;
+            float high = action->value * (1.0f + EVERT_CONSTRAINT_HARNESS_EXPORT_TOLERANCE);
+            float low = action->value * EVERT_CONSTRAINT_HARNESS_EXPORT_FLOOR;
+
+            EVERT_HARNESS_Check(settle->sample_count > 0 && settle->power_min * efficiency >= low && settle->power_max * efficiency <= high && settle->batch_count > 0,
+                                "export limit %.0f W at %" PRIu32 " ms: %.0f to %.0f W AC from %u ms on (%.0f to %.0f W), %" PRIu32 " batches",
+                                action->value, action->time_ms, settle->power_min * efficiency, settle->power_max * efficiency, EVERT_CONSTRAINT_HARNESS_SETTLE_MS,
+                                low, high, settle->batch_count);
+            EVERT_HARNESS_Check(settle->batch_summed > 0 && settle->batch_error_max <= EVERT_CONSTRAINT_HARNESS_BATCH_TARGET_ERROR,
+                                "export limit %.0f W at %" PRIu32 " ms: per-slot limits of %" PRIu32 " batches sum to the optimizer target within %.1f W (<= %.1f W)",
+                                action->value, action->time_ms, settle->batch_summed, settle->batch_error_max, EVERT_CONSTRAINT_HARNESS_BATCH_TARGET_ERROR);
+        }
+    }
+
+    uint32_t unapplied = EVERT_HARNESS_Unapplied();
+    EVERT_HARNESS_Check(unapplied == 0 && harness.unmatched_count == 0, "commands received and not applied %" PRIu32 ", applied without a command %" PRIu32, unapplied, harness.unmatched_count);
+
+    printf("\n%s: %" PRIu32 " check(s) failed\n", harness.failed_count == 0 ? "PASSED" : "FAILED", harness.failed_count);
+}
+
+//
+// #endregion "Report"
+//
+
+static void EVERT_HARNESS_Usage(const char *program)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -S, --scenario NAME   boot, plant (default), update\n"
+            "  -t, --duration S      Virtual time, default per scenario\n"
+            "  -b, --bitrate BIT/S   Default %u\n"
+            "  -l, --latency US      End of frame to the receiver, default %u\n"
+            "  -p, --loss P          Probability a receiver misses a frame, default %.2f\n"
+            "  -r, --seed N          Loss pattern\n"
+            "  -v, --trace           Every frame on the wire on stdout\n",
+            program, EVERT_SETTING_HARNESS_BITRATE, EVERT_SETTING_HARNESS_LATENCY_US, EVERT_SETTING_HARNESS_LOSS);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option options[] = {
+        {"scenario", required_argument, NULL, 'S'},
+        {"duration", required_argument, NULL, 't'},
+        {"bitrate", required_argument, NULL, 'b'},
+        {"latency", required_argument, NULL, 'l'},
+        {"loss", required_argument, NULL, 'p'},
+        {"seed", required_argument, NULL, 'r'},
+        {"trace", no_argument, NULL, 'v'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}};
+
+    const EVERT_HARNESS_ScenarioTypeDef *scenario = &harness_scenarios[1];
+    uint32_t duration_s = 0;
+    uint32_t bitrate = EVERT_SETTING_HARNESS_BITRATE;
+    uint32_t latency_us = EVERT_SETTING_HARNESS_LATENCY_US;
+    double loss = EVERT_SETTING_HARNESS_LOSS;
+    uint64_t seed = EVERT_SETTING_HARNESS_SEED;
+    int option;
+
+    while ((option = getopt_long(argc, argv, "S:t:b:l:p:r:vh", options, NULL)) != -1)
+    {
+        switch (option)
+        {
+        case 'S':
+            scenario = NULL;
+
+            for (uint32_t i = 0; i < sizeof(harness_scenarios) / sizeof(harness_scenarios[0]); i++)
+            {
+                scenario = strcmp(optarg, harness_scenarios[i].name) == 0 ? &harness_scenarios[i] : scenario;
+            }
+
+            if (scenario == NULL)
+            {
+                fprintf(stderr, "HARNESS: no scenario %s\n", optarg);
+                return 2;
+            }
+            break;
+
+        case 't':
+            duration_s = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+
+        case 'b':
+            bitrate = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+
+        case 'l':
+            latency_us = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+
+        case 'p':
+            loss = strtod(optarg, NULL);
+            break;
+
+        case 'r':
+            seed = strtoull(optarg, NULL, 0);
+            break;
+
+        case 'v':
+            harness.trace = true;
+            break;
+
+        default:
+            EVERT_HARNESS_Usage(argv[0]);
+            return option == 'h' ? EXIT_SUCCESS : 2;
+        }
+    }
+
+    if (bitrate == 0 || loss < 0.0 || loss > 1.0)
+    {
+        EVERT_HARNESS_Usage(argv[0]);
+        return 2;
+    }
+
+    duration_s = duration_s > 0 ? duration_s : scenario->duration_s;
+
+    EVERT_HARNESS_BUS_Init(&harness.bus, bitrate, latency_us, loss, seed);
+    harness.bus.OnFrame = EVERT_HARNESS_OnFrame;
+
+    // Nodes first, the children do not need the CCU state
+    bool spawned = true;
+
+    for (uint32_t i = 0; i < EVERT_CONSTANT_HARNESS_NODE_COUNT; i++)
+    {
+        uint32_t station = EVERT_HARNESS_BUS_AddStation(&harness.bus, FDCAN_TX_FIFO_SIZE, false);
+        harness.nodes[i].acknowledged_ms = -1;
+        harness.nodes[i].time_sync_locked_ms = -1;
+        spawned = spawned && EVERT_HARNESS_NODE_Spawn(&harness.nodes[i].node, &harness_nodes[i], station);
+    }
+
+    harness.ccu_station = EVERT_HARNESS_BUS_AddStation(&harness.bus, EVERT_CONSTANT_HARNESS_CCU_TX_DEPTH, true);
+    EVERT_HARNESS_CCU_Init(bitrate);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    bool completed = spawned && EVERT_HARNESS_Run(scenario, duration_s);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    for (uint32_t i = 0; i < EVERT_CONSTANT_HARNESS_NODE_COUNT; i++)
+    {
+        EVERT_HARNESS_NODE_Stop(&harness.nodes[i].node);
+    }
+
+    if (!completed)
+    {
+        return 2;
+    }
+
+    EVERT_HARNESS_Report(scenario, (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9);
+
+    return harness.failed_count == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,258 @@
+/**
+ ******************************************************************************
+ * @file    harness_bus.c
+ * @author  Evert Firmware Team
+ * @brief   Virtual CAN bus of the harness
+ *
+ ******************************************************************************
+ **/
+
+#include <string.h>
+#include "harness_bus.h"
+#include "ccu_protocol.h"
+
+#define EVERT_HARNESS_BUS_MASK (EVERT_CONSTANT_HARNESS_QUEUE_SIZE - 1)
+
+_Static_assert((EVERT_CONSTANT_HARNESS_QUEUE_SIZE & EVERT_HARNESS_BUS_MASK) == 0, "EVERT_CONSTANT_HARNESS_QUEUE_SIZE must be a power of 2");
+
+static bool EVERT_HARNESS_BUS_Push(EVERT_HARNESS_BUS_QueueTypeDef *queue, const EVERT_HARNESS_BUS_ItemTypeDef *item)
+{
+    if (queue->count == EVERT_CONSTANT_HARNESS_QUEUE_SIZE)
+    {
+        return false;
+    }
+
+    queue->items[(queue->head + queue->count) & EVERT_HARNESS_BUS_MASK] = *item;
+    queue->count++;
+
+    return true;
+}
+
+static const EVERT_HARNESS_BUS_ItemTypeDef *EVERT_HARNESS_BUS_Peek(const EVERT_HARNESS_BUS_QueueTypeDef *queue)
+{
+    return queue->count > 0 ? &queue->items[queue->head & EVERT_HARNESS_BUS_MASK] : NULL;
+}
+
+static void EVERT_HARNESS_BUS_Consume(EVERT_HARNESS_BUS_QueueTypeDef *queue)
+{
+    queue->head++;
+    queue->count--;
+}
+
+/// @brief Uniform in [0, 1), xorshift64*
+static double EVERT_HARNESS_BUS_Random(EVERT_HARNESS_BUS_TypeDef *bus)
+{
+    bus->seed ^= bus->seed >> 12;
+    bus->seed ^= bus->seed << 25;
+    bus->seed ^= bus->seed >> 27;
+
+    return (double)((bus->seed * 0x2545F4914F6CDD1Dull) >> 11) / (double)(1ull << 53);
+}
+
+void EVERT_HARNESS_BUS_Init(EVERT_HARNESS_BUS_TypeDef *bus, const uint32_t bitrate, const uint32_t latency_us, const double loss, const uint64_t seed)
+{
+    memset(bus, 0, sizeof(*bus));
+
+    bus->bitrate = bitrate;
+    bus->latency_us = latency_us;
+    bus->loss = loss;
+    bus->seed = seed != 0 ? seed : 1;
+}
+
+/// @return Index of the station
+uint32_t EVERT_HARNESS_BUS_AddStation(EVERT_HARNESS_BUS_TypeDef *bus, const uint32_t tx_depth, const bool loopback)
+{
+    EVERT_HARNESS_BUS_StationTypeDef *station = &bus->stations[bus->station_count];
+    station->tx_depth = tx_depth < EVERT_CONSTANT_HARNESS_QUEUE_SIZE ? tx_depth : EVERT_CONSTANT_HARNESS_QUEUE_SIZE;
+    station->loopback = loopback;
+
+    return bus->station_count++;
+}
+
+uint32_t EVERT_HARNESS_BUS_TxFree(const EVERT_HARNESS_BUS_TypeDef *bus, const uint32_t station)
+{
+    return bus->stations[station].tx_depth - bus->stations[station].tx.count;
+}
+
+uint32_t EVERT_HARNESS_BUS_TxPending(const EVERT_HARNESS_BUS_TypeDef *bus, const uint32_t station)
+{
+    return bus->stations[station].tx.count;
+}
+
+/// @brief Queue a frame in the controller of the station
+/// @param queued_us When the station queued it, it competes for the bus from then on
+/// @return false with the controller full
+bool EVERT_HARNESS_BUS_Transmit(EVERT_HARNESS_BUS_TypeDef *bus, const uint32_t station, const struct can_frame *frame, const uint64_t queued_us)
+{
+    if (EVERT_HARNESS_BUS_TxFree(bus, station) == 0)
+    {
+        return false;
+    }
+
+    EVERT_HARNESS_BUS_ItemTypeDef item = {.frame = *frame, .queued_us = queued_us, .received_us = 0};
+
+    return EVERT_HARNESS_BUS_Push(&bus->stations[station].tx, &item);
+}
+
+/// @brief Next frame the station received by until_us
+bool EVERT_HARNESS_BUS_Receive(EVERT_HARNESS_BUS_TypeDef *bus, const uint32_t station, const uint64_t until_us, EVERT_HARNESS_BUS_ItemTypeDef *item)
+{
+    EVERT_HARNESS_BUS_QueueTypeDef *queue = &bus->stations[station].rx;
+    const EVERT_HARNESS_BUS_ItemTypeDef *head = EVERT_HARNESS_BUS_Peek(queue);
+
+    if (head == NULL || head->received_us > until_us)
+    {
+        return false;
+    }
+
+    *item = *head;
+    EVERT_HARNESS_BUS_Consume(queue);
+
+    return true;
+}
+
+/// @brief Arbitration field as sent, most significant bit first, lower wins
+///        Standard: id 11, RTR, IDE = 0. Extended: id 28..18, SRR = 1, IDE = 1, id 17..0, RTR
+static uint32_t EVERT_HARNESS_BUS_ArbitrationKey(const struct can_frame *frame)
+{
+    uint32_t rtr = (frame->can_id & CAN_RTR_FLAG) != 0;
+
+    if (frame->can_id & CAN_EFF_FLAG)
+    {
+        uint32_t id = frame->can_id & CAN_EFF_MASK;
+        return ((id >> 18) << 21) | (1u << 20) | (1u << 19) | ((id & 0x3FFFFu) << 1) | rtr;
+    }
+
+    return ((frame->can_id & CAN_SFF_MASK) << 21) | (rtr << 20);
+}
+
+static void EVERT_HARNESS_BUS_AddBusy(EVERT_HARNESS_BUS_TypeDef *bus, const uint64_t start_us, const uint64_t duration_us)
+{
+    const uint64_t window_us = EVERT_CONSTANT_HARNESS_LOAD_WINDOW_MS * 1000u;
+
+    while (start_us >= bus->window_start_us + window_us)
+    {
+        double load = (double)bus->window_busy_us / (double)window_us;
+        bus->load_peak = load > bus->load_peak ? load : bus->load_peak;
+        bus->window_start_us += window_us;
+        bus->window_busy_us = 0;
+    }
+
+    bus->window_busy_us += duration_us;
+    bus->busy_us += duration_us;
+}
+
+/// @brief Run the bus up to until_us: arbitration on the idle bus, transmission, reception
+void EVERT_HARNESS_BUS_Run(EVERT_HARNESS_BUS_TypeDef *bus, const uint64_t until_us)
+{
+    uint64_t now_us = bus->idle_from_us > bus->now_us ? bus->idle_from_us : bus->now_us;
+
+    while (now_us < until_us)
+    {
+        // Controllers with a frame pending at the start of the arbitration
+        int32_t winner = -1;
+        uint32_t winner_key = 0;
+        uint32_t contenders = 0;
+        uint64_t next_us = UINT64_MAX;
+
+        for (uint32_t i = 0; i < bus->station_count; i++)
+        {
+            const EVERT_HARNESS_BUS_ItemTypeDef *head = EVERT_HARNESS_BUS_Peek(&bus->stations[i].tx);
+
+            if (head == NULL)
+            {
+                continue;
+            }
+
+            if (head->queued_us > now_us)
+            {
+                next_us = head->queued_us < next_us ? head->queued_us : next_us;
+                continue;
+            }
+
+            uint32_t key = EVERT_HARNESS_BUS_ArbitrationKey(&head->frame);
+            contenders++;
+
+            if (winner < 0 || key < winner_key)
+            {
+                winner = (int32_t)i;
+                winner_key = key;
+            }
+        }
+
+        if (winner < 0)
+        {
+            // Idle until the next frame is queued
+            now_us = next_us;
+            continue;
+        }
+
+        EVERT_HARNESS_BUS_StationTypeDef *sender = &bus->stations[winner];
+        EVERT_HARNESS_BUS_ItemTypeDef item = *EVERT_HARNESS_BUS_Peek(&sender->tx);
+        EVERT_HARNESS_BUS_Consume(&sender->tx);
+
+        for (uint32_t i = 0; i < bus->station_count && contenders > 1; i++)
+        {
+            const EVERT_HARNESS_BUS_ItemTypeDef *head = EVERT_HARNESS_BUS_Peek(&bus->stations[i].tx);
+            bus->stations[i].arbitration_lost_count += head != NULL && head->queued_us <= now_us;
+        }
+
+        uint32_t bits = EVERT_CCU_PROTOCOL_FrameBits(&item.frame);
+        uint64_t duration_us = ((uint64_t)bits * 1000000u + bus->bitrate - 1) / bus->bitrate;
+        uint64_t end_us = now_us + duration_us;
+        item.start_us = now_us;
+        item.received_us = end_us + bus->latency_us;
+
+        EVERT_HARNESS_BUS_AddBusy(bus, now_us, duration_us);
+        bus->frame_count++;
+        bus->bit_count += bits;
+        sender->tx_count++;
+
+        if (bus->OnFrame != NULL)
+        {
+            bus->OnFrame((uint32_t)winner, &item, now_us);
+        }
+
+        for (uint32_t i = 0; i < bus->station_count; i++)
+        {
+            EVERT_HARNESS_BUS_StationTypeDef *receiver = &bus->stations[i];
+
+            if (i == (uint32_t)winner)
+            {
+                // Echo once the frame is through, the intermission does not belong to it
+                EVERT_HARNESS_BUS_ItemTypeDef echo = item;
+                echo.received_us = now_us + ((uint64_t)(bits - EVERT_CCU_PROTOCOL_INTERMISSION_BITS) * 1000000u + bus->bitrate - 1) / bus->bitrate;
+
+                if (receiver->loopback && EVERT_HARNESS_BUS_Push(&receiver->rx, &echo))
+                {
+                    receiver->echo_count++;
+                }
+
+                continue;
+            }
+
+            if (bus->loss > 0.0 && EVERT_HARNESS_BUS_Random(bus) < bus->loss)
+            {
+                receiver->lost_count++;
+            }
+            else if (EVERT_HARNESS_BUS_Push(&receiver->rx, &item))
+            {
+                receiver->rx_count++;
+            }
+            else
+            {
+                receiver->overrun_count++;
+            }
+        }
+
+        now_us = end_us;
+        bus->idle_from_us = end_us;
+    }
+
+    bus->now_us = until_us;
+}
+
+double EVERT_HARNESS_BUS_LoadAverage(const EVERT_HARNESS_BUS_TypeDef *bus)
+{
+    return bus->now_us > 0 ? (double)bus->busy_us / (double)bus->now_us : 0.0;
+}
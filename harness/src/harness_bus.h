@@ -0,0 +1,87 @@
+/**
+ ******************************************************************************
+ * @file    harness_bus.h
+ * @author  Evert Firmware Team
+ * @brief   Virtual CAN bus of the harness: one shared medium between the stations (nodes, CCU)
+ *          * Frames: SocketCAN struct can_frame, as the CCU sees them (CAN_EFF_FLAG for extended ids)
+ *          * Arbitration: the lowest identifier among the queued frames wins the idle bus, bit-wise like
+ *            the controllers (a standard id beats an extended one with the same base id)
+ *          * Timing: frame bits with the stuff bits, CRC, ACK, EOF and intermission at the bit rate,
+ *            received at the end of the frame plus the latency
+ *          * Loss: each receiver misses a frame with the configured probability
+ *          * Load: busy time per EVERT_CONSTANT_HARNESS_LOAD_WINDOW_MS window, peak and average
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_HARNESS_BUS_H_
+#define EVERT_HARNESS_BUS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <linux/can.h>
+#include "_conf_evert_harness.h"
+
+typedef struct
+{
+    struct can_frame frame;
+    uint64_t queued_us;   // The sender queued it
+    uint64_t start_us;    // Start of frame, once on the wire
+    uint64_t received_us; // End of the frame plus the latency, once on the wire (echo: end of the EOF)
+} EVERT_HARNESS_BUS_ItemTypeDef;
+
+typedef struct
+{
+    EVERT_HARNESS_BUS_ItemTypeDef items[EVERT_CONSTANT_HARNESS_QUEUE_SIZE];
+    uint32_t head;
+    uint32_t count;
+} EVERT_HARNESS_BUS_QueueTypeDef;
+
+typedef struct
+{
+    uint32_t tx_depth;                      // Controller FIFO (FDCAN_TX_FIFO_SIZE, txqueuelen)
+    bool loopback;                          // Own frames come back once sent (SocketCAN echo)
+    EVERT_HARNESS_BUS_QueueTypeDef tx;      // Waiting for the bus, in FIFO order like FDCAN_TX_FIFO_OPERATION
+    EVERT_HARNESS_BUS_QueueTypeDef rx;      // Received, waiting for the station to take them
+    uint64_t tx_count;
+    uint64_t rx_count;
+    uint64_t lost_count;    // Missed (loss)
+    uint64_t overrun_count; // Received with rx full
+    uint64_t echo_count;
+    uint64_t arbitration_lost_count;
+} EVERT_HARNESS_BUS_StationTypeDef;
+
+typedef struct
+{
+    uint32_t bitrate;
+    uint32_t latency_us;
+    double loss;
+
+    EVERT_HARNESS_BUS_StationTypeDef stations[EVERT_CONSTANT_HARNESS_STATION_COUNT];
+    uint32_t station_count;
+    uint64_t seed;
+
+    uint64_t now_us;       // Bus simulated up to here
+    uint64_t idle_from_us; // End of the last frame
+
+    // Load
+    uint64_t busy_us;
+    uint64_t window_busy_us;
+    uint64_t window_start_us;
+    double load_peak;
+    uint64_t frame_count;
+    uint64_t bit_count;
+
+    /// @brief Frame on the wire, sent by station from start_us to item->received_us less the latency (NULL = none)
+    void (*OnFrame)(const uint32_t station, const EVERT_HARNESS_BUS_ItemTypeDef *item, const uint64_t start_us);
+} EVERT_HARNESS_BUS_TypeDef;
+
+void EVERT_HARNESS_BUS_Init(EVERT_HARNESS_BUS_TypeDef *bus, const uint32_t bitrate, const uint32_t latency_us, const double loss, const uint64_t seed);
+uint32_t EVERT_HARNESS_BUS_AddStation(EVERT_HARNESS_BUS_TypeDef *bus, const uint32_t tx_depth, const bool loopback);
+uint32_t EVERT_HARNESS_BUS_TxFree(const EVERT_HARNESS_BUS_TypeDef *bus, const uint32_t station);
+uint32_t EVERT_HARNESS_BUS_TxPending(const EVERT_HARNESS_BUS_TypeDef *bus, const uint32_t station);
+bool EVERT_HARNESS_BUS_Transmit(EVERT_HARNESS_BUS_TypeDef *bus, const uint32_t station, const struct can_frame *frame, const uint64_t queued_us);
+bool EVERT_HARNESS_BUS_Receive(EVERT_HARNESS_BUS_TypeDef *bus, const uint32_t station, const uint64_t until_us, EVERT_HARNESS_BUS_ItemTypeDef *item);
+void EVERT_HARNESS_BUS_Run(EVERT_HARNESS_BUS_TypeDef *bus, const uint64_t until_us);
+double EVERT_HARNESS_BUS_LoadAverage(const EVERT_HARNESS_BUS_TypeDef *bus);
+
+#endif // EVERT_HARNESS_BUS_H_
@@ -0,0 +1,109 @@
+/**
+ ******************************************************************************
+ * @file    harness_ccu.c
+ * @author  Evert Firmware Team
+ * @brief   CCU of the harness
+ *
+ ******************************************************************************
+ **/
+
+#include <string.h>
+#include "ccu.h"
+#include "ccu_devices.h"
+#include "ccu_dispatch.h"
+#include "ccu_telemetry.h"
+#include "ccu_timesync.h"
+#include "ccu_update.h"
+#include "harness_ccu.h"
+
+static struct can_frame harness_ccu_tx;
+
+/// @brief EVERT_CCU_Init without the socket and the eventfds
+/// @param bitrate Of the bus, the time sync master takes the SYNC length from it, the update its share
+void EVERT_HARNESS_CCU_Init(const uint32_t bitrate)
+{
+    memset(&ccu, 0, sizeof(ccu));
+    ccu.rx_event_fd = -1;
+    ccu.tx_event_fd = -1;
+    ccu.stop_fd = -1;
+    ccu.socketcan.fd = -1;
+
+    EVERT_CCU_QUEUE_Init(&ccu.rx_queue);
+    EVERT_CCU_QUEUE_Init(&ccu.tx_queue);
+    atomic_init(&ccu.running, true);
+    atomic_init(&ccu.tx_error_count, 0);
+
+    EVERT_CCU_TIMESERIES_Init(&ccu.timeseries);
+    EVERT_CCU_TELEMETRY_Init(&ccu.timeseries);
+    EVERT_CCU_DEVICES_Init();
+    EVERT_CCU_DISPATCH_Init();
+    EVERT_CCU_TIMESYNC_Init(bitrate);
+    EVERT_CCU_UPDATE_Init(bitrate);
+
+    ccu.start_us = EVERT_HARNESS_CCU_EPOCH_US;
+}
+
+/// @brief Frame from the bus, as the worker takes it from the RX queue (EVERT_CCU_OnFrame)
+/// @param received_us Bus time of the socket timestamp, the end of the EOF for an own frame
+void EVERT_HARNESS_CCU_OnFrame(const struct can_frame *can, const uint64_t received_us)
+{
+    EVERT_CCU_FrameTypeDef frame;
+
+    if (!EVERT_CCU_PROTOCOL_Decode(can, &frame))
+    {
+        return;
+    }
+
+    frame.timestamp_us = EVERT_HARNESS_CCU_EPOCH_US + received_us;
+
+    // Own frame back from the bus (EVERT_CCU_SOCKETCAN_Read), only the SYNC is of use
+    if (frame.identifier.source_id == EVERT_CONSTANT_CCU_DEVICE_ID)
+    {
+        ccu.socketcan.echo_count++;
+        EVERT_CCU_TIMESYNC_OnEcho(&frame);
+        return;
+    }
+
+    ccu.socketcan.rx_count++;
+
+    // Frames addressed to another node
+    if (frame.identifier.target_id != EVERT_CCU_PROTOCOL_BROADCAST && frame.identifier.target_id != EVERT_CONSTANT_CCU_DEVICE_ID)
+    {
+        return;
+    }
+
+    EVERT_CCU_DEVICES_OnFrame(&frame);
+    EVERT_CCU_TELEMETRY_OnFrame(&frame);
+    EVERT_CCU_UPDATE_OnFrame(&frame);
+}
+
+/// @brief Worker tick (EVERT_CCU_OnTick without the status print)
+void EVERT_HARNESS_CCU_OnTick(const uint64_t now_us)
+{
+    EVERT_CCU_DEVICES_Process(EVERT_HARNESS_CCU_EPOCH_US + now_us);
+    EVERT_CCU_DISPATCH_Process(EVERT_HARNESS_CCU_EPOCH_US + now_us);
+    EVERT_CCU_TIMESYNC_Process(EVERT_HARNESS_CCU_EPOCH_US + now_us);
+    EVERT_CCU_TELEMETRY_Process(EVERT_HARNESS_CCU_EPOCH_US + now_us);
+    EVERT_CCU_UPDATE_Process(EVERT_HARNESS_CCU_EPOCH_US + now_us);
+}
+
+/// @brief Next frame of the TX queue for the bus, NULL if none
+const struct can_frame *EVERT_HARNESS_CCU_Peek(void)
+{
+    const EVERT_CCU_FrameTypeDef *frame = EVERT_CCU_QUEUE_Peek(&ccu.tx_queue);
+
+    if (frame == NULL)
+    {
+        return NULL;
+    }
+
+    EVERT_CCU_PROTOCOL_Encode(frame, &harness_ccu_tx);
+
+    return &harness_ccu_tx;
+}
+
+void EVERT_HARNESS_CCU_Consume(void)
+{
+    EVERT_CCU_QUEUE_Consume(&ccu.tx_queue);
+    ccu.socketcan.tx_count++;
+}
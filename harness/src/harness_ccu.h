@@ -0,0 +1,29 @@
+/**
+ ******************************************************************************
+ * @file    harness_ccu.h
+ * @author  Evert Firmware Team
+ * @brief   CCU of the harness: the modules of the CCU service on the virtual bus and the virtual clock
+ *          * ccu_devices, ccu_telemetry, ccu_dispatch, ccu_optimizer and ccu_update as in the service, without the socket and
+ *            the threads: frames in as the worker takes them from the RX queue, the tick every
+ *            EVERT_CONSTANT_CCU_TICK_MS, the TX queue out to the bus like the I/O thread writes the socket
+ *          * The bus loops the frames of the CCU back like the socket does, the time sync master sees its SYNC
+ *          * CCU time: bus time + EVERT_HARNESS_CCU_EPOCH_US, a host that has been up for a while
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_HARNESS_CCU_H_
+#define EVERT_HARNESS_CCU_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <linux/can.h>
+
+#define EVERT_HARNESS_CCU_EPOCH_US (3600000000ull)
+
+void EVERT_HARNESS_CCU_Init(const uint32_t bitrate);
+void EVERT_HARNESS_CCU_OnFrame(const struct can_frame *can, const uint64_t received_us);
+void EVERT_HARNESS_CCU_OnTick(const uint64_t now_us);
+const struct can_frame *EVERT_HARNESS_CCU_Peek(void);
+void EVERT_HARNESS_CCU_Consume(void);
+
+#endif // EVERT_HARNESS_CCU_H_
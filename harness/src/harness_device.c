@@ -0,0 +1,222 @@
+/**
+ ******************************************************************************
+ * @file    harness_device.c
+ * @author  Evert Firmware Team
+ * @brief   Application of the inverter node on top of the device layer and the CAN handler
+ *          * The inverter firmware has no CAN link yet: the node runs the device layer the way every device
+ *            does (setup, the FDCAN and LF interrupts, the main loop pass, the __weak overrides) and answers
+ *            the handshake, the heartbeat and the reset
+ *          * Boot: the HF ISR counts the ADC samples, DS_BOOTING_ADC ends once the filters would be filled
+ *            (EVERT_CONSTANT_BC_READINGS_SETTLE_SAMPLES)
+ *          * The boost converter nodes run their application instead, boost_converter/
+ *
+ ******************************************************************************
+ **/
+
+#include <string.h>
+#include "_conf_evert_hal.h"
+#include "can_handler.h"
+#include "ccu_protocol.h"
+#include "evert_device.h"
+#include "harness_fdcan.h"
+#include "harness_node.h"
+
+#define EVERT_HARNESS_DEVICE_VERSION_MAJOR (2)
+#define EVERT_HARNESS_DEVICE_VERSION_MINOR (0)
+#define EVERT_HARNESS_DEVICE_VERSION_PATCH (0)
+#define EVERT_HARNESS_DEVICE_READINGS_SETTLE_SAMPLES (51) // EVERT_CONSTANT_BC_READINGS_SETTLE_SAMPLES
+
+typedef struct
+{
+    EVERT_HARNESS_NODE_ConfigTypeDef config;
+    uint32_t start_time;
+    uint32_t last_time;
+    uint32_t readings_sample_count; // HF ISR passes since the power on
+} EVERT_HARNESS_DEVICE_TypeDef;
+
+static EVERT_HARNESS_DEVICE_TypeDef harness_device;
+
+static FDCAN_GlobalTypeDef fdcan1;
+static FDCAN_HandleTypeDef hfdcan1;
+static EVERT_CAN_HandlerTypeDef can_handler;
+static EVERT_CAN_FifoBufferItemTypeDef rx_fifo_items[EVERT_CONSTANT_HARNESS_CAN_BUFFER_SIZE];
+static EVERT_CAN_FifoBufferItemTypeDef tx_fifo_items[EVERT_CONSTANT_HARNESS_CAN_BUFFER_SIZE];
+
+/// @brief Nothing kept over a reset
+bool EVERT_HARNESS_DEVICE_PowerOn(const EVERT_HARNESS_NODE_ConfigTypeDef *config)
+{
+    UNUSED(config);
+
+    return true;
+}
+
+bool EVERT_HARNESS_DEVICE_Boot(const bool power_on, const EVERT_HARNESS_NODE_ResetTypeDef cause)
+{
+    UNUSED(power_on);
+    UNUSED(cause);
+
+    return true;
+}
+
+/// @brief Setup, as the application setup after the peripherals
+void EVERT_HARNESS_DEVICE_Init(const EVERT_HARNESS_NODE_ConfigTypeDef *config)
+{
+    memset(&harness_device, 0, sizeof(harness_device));
+    harness_device.config = *config;
+
+    // Bit timing of MX_FDCAN1_Init, 500 kbit/s from the HSE
+    hfdcan1.Instance = &fdcan1;
+    hfdcan1.Init.ClockDivider = FDCAN_CLOCK_DIV1;
+    hfdcan1.Init.NominalPrescaler = 3;
+    hfdcan1.Init.NominalSyncJumpWidth = 1;
+    hfdcan1.Init.NominalTimeSeg1 = 13;
+    hfdcan1.Init.NominalTimeSeg2 = 2;
+
+    EVERT_DEVICE_Init();
+    EVERT_DEVICE_SetVersionInfo(EVERT_HARNESS_DEVICE_VERSION_MAJOR, EVERT_HARNESS_DEVICE_VERSION_MINOR, EVERT_HARNESS_DEVICE_VERSION_PATCH);
+    EVERT_CAN_Handler_Init(&hfdcan1, &can_handler, (EVERT_CAN_DeviceIdentifierTypeDef)config->device_id, rx_fifo_items, tx_fifo_items, EVERT_CONSTANT_HARNESS_CAN_BUFFER_SIZE);
+
+    harness_device.start_time = HAL_GetTick();
+    harness_device.last_time = harness_device.start_time;
+}
+
+/// @brief HAL_FDCAN_RxFifo0Callback
+void EVERT_HARNESS_DEVICE_OnRxFifo0(void)
+{
+    EVERT_CAN_Handler_Receive(&can_handler, FDCAN_IT_RX_FIFO0_NEW_MESSAGE);
+}
+
+/// @brief HF ISR: one set of readings
+void EVERT_HARNESS_DEVICE_OnHfTick(void)
+{
+    if (harness_device.readings_sample_count < UINT32_MAX)
+    {
+        harness_device.readings_sample_count++;
+    }
+}
+
+/// @brief Main loop pass
+/// @return true while frames wait in the CAN handler buffers and the Tx FIFO takes them
+bool EVERT_HARNESS_DEVICE_Loop(void)
+{
+    uint32_t current_time = HAL_GetTick();
+
+    EVERT_DEVICE_Update(current_time - harness_device.start_time, current_time - harness_device.last_time);
+    EVERT_CAN_ProcessBufferStatusTypeDef rx_status = EVERT_CAN_Handler_ProcessRxBuffer(&can_handler);
+    EVERT_CAN_ProcessBufferStatusTypeDef tx_status = EVERT_CAN_Handler_ProcessTxBuffer(&can_handler);
+    EVERT_CAN_Handler_UpdateStatistics(&can_handler, current_time - harness_device.last_time);
+
+    harness_device.last_time = current_time;
+
+    return rx_status == CAN_PBS_PROCESSING_RECEIVED_DATA || (tx_status == CAN_PBS_OK && can_handler.tx_fifo_buffer.count > 0);
+}
+
+/// @brief LF ISR: device alarm check
+void EVERT_HARNESS_DEVICE_OnLfTick(void)
+{
+    EVERT_DEVICE_OnLfTick();
+}
+
+/// @brief No watchdog on the inverter node
+void EVERT_HARNESS_DEVICE_OnStepEnd(void)
+{
+}
+
+void EVERT_HARNESS_DEVICE_Report(EVERT_HARNESS_NODE_ReportTypeDef *report)
+{
+    report->can = can_handler.statistics;
+    report->result_state = (uint8_t)EVERT_DEVICE_State_Get(SS_RESULT);
+    report->version[0] = EVERT_HARNESS_DEVICE_VERSION_MAJOR;
+    report->version[1] = EVERT_HARNESS_DEVICE_VERSION_MINOR;
+    report->version[2] = EVERT_HARNESS_DEVICE_VERSION_PATCH;
+    report->boot = device_boot_timing;
+}
+
+/// @brief [1] result, [2] internal, [3] propagated, [4..6] version
+static void EVERT_HARNESS_DEVICE_SendDeviceState(void)
+{
+    uint8_t data[7] = {
+        BCCM_DEVICE_STATE,
+        EVERT_DEVICE_State_Get(SS_RESULT),
+        EVERT_DEVICE_State_Get(SS_INTERNAL),
+        EVERT_DEVICE_State_Get(SS_PROPAGATED),
+        EVERT_HARNESS_DEVICE_VERSION_MAJOR,
+        EVERT_HARNESS_DEVICE_VERSION_MINOR,
+        EVERT_HARNESS_DEVICE_VERSION_PATCH};
+
+    EVERT_CAN_Handler_Transmit(&can_handler, sizeof(data), data);
+}
+
+// __weak Callbacks - CAN
+void __overrides EVERT_CAN_OnMessageReceived(EVERT_CAN_HandlerTypeDef *handler, const EVERT_CAN_FrameTypeDef frame)
+{
+    // Addressed to another node, broadcasts (target 0) go to everyone
+    if (frame.identifier.target_id != CAN_DEVICE_IDENTIFIER_UNIDENTIFIED && frame.identifier.target_id != handler->identifier.source_id)
+    {
+        return;
+    }
+
+    if (frame.data.length == 0)
+    {
+        return;
+    }
+
+    uint8_t method = frame.data.data[0];
+    uint8_t param1 = frame.data.data[1];
+
+    // Device state methods, every device
+    if (method == BCCM_DEVICE_ACK)
+    {
+        EVERT_DEVICE_PostEvent(DE_HANDSHAKE_ACK);
+    }
+    else if (method == BCCM_DEVICE_HEARTBEAT && frame.data.length >= 2)
+    {
+        EVERT_DEVICE_Heartbeat(param1 <= DS_EMERGENCY_SHUTDOWN ? (EVERT_DEVICE_StateTypeDef)param1 : DS_UNKNOWN);
+    }
+    else if (method == BCCM_DEVICE_RESET)
+    {
+        EVERT_DEVICE_PostEvent(DE_RESET);
+        EVERT_HARNESS_NODE_Event(HNE_COMMAND, method);
+    }
+}
+
+// __weak Callbacks - State
+void __overrides EVERT_DEVICE_Derived_OnDeviceStateChange(const EVERT_DEVICE_StateTypeDef new_state, const EVERT_DEVICE_StateTypeDef old_state)
+{
+    UNUSED(old_state);
+
+    EVERT_HARNESS_NODE_Event(HNE_STATE, (uint8_t)new_state);
+}
+
+bool __overrides EVERT_DEVICE_Derived_IsAdcSettled()
+{
+    return harness_device.readings_sample_count >= EVERT_HARNESS_DEVICE_READINGS_SETTLE_SAMPLES;
+}
+
+void __overrides EVERT_DEVICE_Derived_OnEnterState_BootingComms()
+{
+    // The CAN handler is up since init, announce to the CCU
+    EVERT_DEVICE_PostEvent(DE_BOOT_COMMS_DONE);
+}
+
+EVERT_DEVICE_StateTypeDef __overrides EVERT_DEVICE_Derived_Alarm_Check()
+{
+    return DS_OPERATIONAL;
+}
+
+// __weak Callbacks - Task Scheduler
+void __overrides EVERT_TASK_SCHEDULER_OnTaskSendAnnouncement(void)
+{
+    EVERT_HARNESS_DEVICE_SendDeviceState();
+}
+
+void __overrides EVERT_TASK_SCHEDULER_OnTaskSendDeviceStatus(void)
+{
+    EVERT_HARNESS_DEVICE_SendDeviceState();
+}
+
+void __overrides EVERT_TASK_SCHEDULER_OnTaskSendPing(void)
+{
+    uint8_t data[7] = {0};
+    EVERT_CAN_Handler_Transmit(&can_handler, sizeof(data), data);
+}
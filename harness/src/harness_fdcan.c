@@ -0,0 +1,242 @@
+/**
+ ******************************************************************************
+ * @file    harness_fdcan.c
+ * @author  Evert Firmware Team
+ * @brief   Fake FDCAN peripheral of a node
+ *
+ ******************************************************************************
+ **/
+
+#include <string.h>
+#include "evert_hal_dwt.h"
+#include "harness_fdcan.h"
+
+EVERT_HARNESS_FDCAN_TypeDef harness_fdcan;
+uint32_t SystemCoreClock = 170000000u;
+uint32_t DwtCycleCounterResult = 0;
+
+void EVERT_HARNESS_FDCAN_Init(void)
+{
+    memset(&harness_fdcan, 0, sizeof(harness_fdcan));
+}
+
+/// @brief Timestamp counter at a time of the node crystal, FDCAN_TIMESTAMP_PRESC_1
+static uint16_t EVERT_HARNESS_FDCAN_Timestamp(const uint64_t local_us)
+{
+    return (uint16_t)(local_us * harness_fdcan.bitrate / 1000000u);
+}
+
+/// @brief Start of a node step
+/// @param tick Node time (HAL_GetTick)
+/// @param local_us Node crystal (cycle counter, timestamp counter)
+/// @param tx_pending Elements of the Tx FIFO the bus has not sent yet
+void EVERT_HARNESS_FDCAN_BeginStep(const uint32_t tick, const uint64_t local_us, const uint32_t tx_pending)
+{
+    harness_fdcan.tick = tick;
+    harness_fdcan.local_us = local_us;
+    harness_fdcan.tx_pending = tx_pending;
+    harness_fdcan.tx_count = 0;
+}
+
+/// @brief Frame from the bus into Rx FIFO 0
+/// @param start_us Its start of frame on the node crystal
+/// @return false if the FIFO is full, the message is lost like on the peripheral
+bool EVERT_HARNESS_FDCAN_Receive(const struct can_frame *frame, const uint64_t start_us)
+{
+    if (!harness_fdcan.started || (frame->can_id & CAN_ERR_FLAG) != 0)
+    {
+        return false;
+    }
+
+    if (harness_fdcan.rx_count == FDCAN_RX_FIFO_SIZE)
+    {
+        harness_fdcan.rx_lost_count++;
+        return false;
+    }
+
+    harness_fdcan.rx[(harness_fdcan.rx_head + harness_fdcan.rx_count) % FDCAN_RX_FIFO_SIZE] = *frame;
+    harness_fdcan.rx_timestamp[(harness_fdcan.rx_head + harness_fdcan.rx_count) % FDCAN_RX_FIFO_SIZE] = EVERT_HARNESS_FDCAN_Timestamp(start_us);
+    harness_fdcan.rx_count++;
+
+    return true;
+}
+
+uint32_t HAL_GetTick(void)
+{
+    return harness_fdcan.tick;
+}
+
+uint32_t HAL_RCCEx_GetPeriphCLKFreq(uint32_t PeriphClk)
+{
+    return PeriphClk == RCC_PERIPHCLK_FDCAN ? HSE_VALUE : 0;
+}
+
+void EVERT_HAL_DWT_EnableCycleCounter(void)
+{
+}
+
+/// @brief Cycle counter at the start of the current ms, everything in a node step takes no time
+uint32_t EVERT_HAL_DWT_GetCycles(void)
+{
+    return (uint32_t)(harness_fdcan.local_us * (SystemCoreClock / 1000000u));
+}
+
+HAL_StatusTypeDef HAL_FDCAN_ConfigFilter(FDCAN_HandleTypeDef *hfdcan, FDCAN_FilterTypeDef *sFilterConfig)
+{
+    UNUSED(hfdcan);
+    UNUSED(sFilterConfig);
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_ConfigGlobalFilter(FDCAN_HandleTypeDef *hfdcan, uint32_t NonMatchingStd, uint32_t NonMatchingExt, uint32_t RejectRemoteStd, uint32_t RejectRemoteExt)
+{
+    UNUSED(hfdcan);
+    UNUSED(NonMatchingStd);
+    UNUSED(NonMatchingExt);
+    UNUSED(RejectRemoteStd);
+    UNUSED(RejectRemoteExt);
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_Start(FDCAN_HandleTypeDef *hfdcan)
+{
+    UNUSED(hfdcan);
+    harness_fdcan.started = true;
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_ActivateNotification(FDCAN_HandleTypeDef *hfdcan, uint32_t ActiveITs, uint32_t BufferIndexes)
+{
+    UNUSED(hfdcan);
+    UNUSED(ActiveITs);
+    UNUSED(BufferIndexes);
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_GetRxMessage(FDCAN_HandleTypeDef *hfdcan, uint32_t RxLocation, FDCAN_RxHeaderTypeDef *pRxHeader, uint8_t *pRxData)
+{
+    if (RxLocation != FDCAN_RX_FIFO0 || harness_fdcan.rx_count == 0)
+    {
+        hfdcan->ErrorCode |= 1u; // HAL_FDCAN_ERROR_FIFO_EMPTY
+        return HAL_ERROR;
+    }
+
+    const struct can_frame *frame = &harness_fdcan.rx[harness_fdcan.rx_head];
+    uint16_t timestamp = harness_fdcan.rx_timestamp[harness_fdcan.rx_head];
+    harness_fdcan.rx_head = (harness_fdcan.rx_head + 1) % FDCAN_RX_FIFO_SIZE;
+    harness_fdcan.rx_count--;
+
+    memset(pRxHeader, 0, sizeof(*pRxHeader));
+    pRxHeader->IdType = (frame->can_id & CAN_EFF_FLAG) ? FDCAN_EXTENDED_ID : FDCAN_STANDARD_ID;
+    pRxHeader->Identifier = (frame->can_id & CAN_EFF_FLAG) ? (frame->can_id & CAN_EFF_MASK) : (frame->can_id & CAN_SFF_MASK);
+    pRxHeader->RxFrameType = (frame->can_id & CAN_RTR_FLAG) ? FDCAN_REMOTE_FRAME : FDCAN_DATA_FRAME;
+    pRxHeader->DataLength = frame->len;
+    pRxHeader->RxTimestamp = timestamp;
+
+    memcpy(pRxData, frame->data, frame->len);
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_AddMessageToTxFifoQ(FDCAN_HandleTypeDef *hfdcan, const FDCAN_TxHeaderTypeDef *pTxHeader, const uint8_t *pTxData)
+{
+    if (HAL_FDCAN_GetTxFifoFreeLevel(hfdcan) == 0)
+    {
+        harness_fdcan.tx_full_count++;
+        hfdcan->ErrorCode |= 2u; // HAL_FDCAN_ERROR_FIFO_FULL
+        return HAL_ERROR;
+    }
+
+    // First element word as the HAL writes it (FDCAN_CopyMessageToRAM)
+    uint32_t element;
+
+    if (pTxHeader->IdType == FDCAN_STANDARD_ID)
+    {
+        element = pTxHeader->ErrorStateIndicator | FDCAN_STANDARD_ID | pTxHeader->TxFrameType | (pTxHeader->Identifier << 18U);
+    }
+    else
+    {
+        element = pTxHeader->ErrorStateIndicator | FDCAN_EXTENDED_ID | pTxHeader->TxFrameType | pTxHeader->Identifier;
+    }
+
+    // What the controller puts on the wire from it
+    struct can_frame *frame = &harness_fdcan.tx[harness_fdcan.tx_count++];
+    memset(frame, 0, sizeof(*frame));
+
+    if (element & FDCAN_ELEMENT_MASK_XTD)
+    {
+        frame->can_id = (element & FDCAN_ELEMENT_MASK_EXTID) | CAN_EFF_FLAG;
+    }
+    else
+    {
+        frame->can_id = (element & FDCAN_ELEMENT_MASK_STDID) >> 18U;
+    }
+
+    if (element & FDCAN_ELEMENT_MASK_RTR)
+    {
+        frame->can_id |= CAN_RTR_FLAG;
+    }
+
+    frame->len = pTxHeader->DataLength <= CAN_MAX_DLEN ? (uint8_t)pTxHeader->DataLength : CAN_MAX_DLEN;
+
+    if ((frame->can_id & CAN_RTR_FLAG) == 0)
+    {
+        memcpy(frame->data, pTxData, frame->len);
+    }
+
+    return HAL_OK;
+}
+
+uint32_t HAL_FDCAN_GetTxFifoFreeLevel(const FDCAN_HandleTypeDef *hfdcan)
+{
+    UNUSED(hfdcan);
+
+    return FDCAN_TX_FIFO_SIZE - harness_fdcan.tx_pending - harness_fdcan.tx_count;
+}
+
+uint32_t HAL_FDCAN_GetRxFifoFillLevel(const FDCAN_HandleTypeDef *hfdcan, uint32_t RxFifo)
+{
+    UNUSED(hfdcan);
+
+    return RxFifo == FDCAN_RX_FIFO0 ? harness_fdcan.rx_count : 0;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_GetErrorCounters(const FDCAN_HandleTypeDef *hfdcan, FDCAN_ErrorCountersTypeDef *ErrorCounters)
+{
+    UNUSED(hfdcan);
+    memset(ErrorCounters, 0, sizeof(*ErrorCounters));
+
+    return HAL_OK;
+}
+
+uint32_t HAL_FDCAN_GetError(const FDCAN_HandleTypeDef *hfdcan)
+{
+    return hfdcan->ErrorCode;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_ConfigTimestampCounter(FDCAN_HandleTypeDef *hfdcan, uint32_t TimestampPrescaler)
+{
+    // Bit time of the nominal bit timing, the prescaler divides it further
+    uint32_t quanta = hfdcan->Init.NominalPrescaler * (1u + hfdcan->Init.NominalTimeSeg1 + hfdcan->Init.NominalTimeSeg2);
+    harness_fdcan.bitrate = quanta > 0 ? HSE_VALUE / quanta / ((TimestampPrescaler >> 16) + 1u) : 0;
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_EnableTimestampCounter(FDCAN_HandleTypeDef *hfdcan, uint32_t TimestampOperation)
+{
+    UNUSED(hfdcan);
+
+    return TimestampOperation == FDCAN_TIMESTAMP_INTERNAL ? HAL_OK : HAL_ERROR;
+}
+
+uint16_t HAL_FDCAN_GetTimestampCounter(const FDCAN_HandleTypeDef *hfdcan)
+{
+    UNUSED(hfdcan);
+
+    return EVERT_HARNESS_FDCAN_Timestamp(harness_fdcan.local_us);
+}
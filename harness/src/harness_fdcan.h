@@ -0,0 +1,52 @@
+/**
+ ******************************************************************************
+ * @file    harness_fdcan.h
+ * @author  Evert Firmware Team
+ * @brief   Fake FDCAN peripheral of a node: the HAL functions the CAN handler calls, backed by the harness bus
+ *          * Tx: HAL_FDCAN_AddMessageToTxFifoQ writes the first element word like the HAL does (identifier,
+ *            XTD, RTR, ESI) and the wire frame is read back from it, a wrong IdType shows on the bus
+ *          * Tx FIFO: FDCAN_TX_FIFO_SIZE elements, shared with the frames the bus has not sent yet
+ *          * Rx FIFO 0: FDCAN_RX_FIFO_SIZE elements, message lost when full, filled by the node step
+ *            before it raises the interrupt
+ *          * Tick: HAL_GetTick, the node time since its power on
+ *          * Clock: the DWT cycle counter and the timestamp counter (bit times) run on the node crystal, off the
+ *            bus time by the clock_ppm of the node; the Rx elements carry the timestamp of their start of frame
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_HARNESS_FDCAN_H_
+#define EVERT_HARNESS_FDCAN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <linux/can.h>
+#include <stm32g4xx_hal.h>
+
+typedef struct
+{
+    uint32_t tick;     // ms since the power on of the node
+    uint64_t local_us; // Node crystal since the power on
+    uint32_t bitrate;  // Of the bit timing, the timestamp counter counts these
+    bool started;
+
+    // Rx FIFO 0
+    struct can_frame rx[FDCAN_RX_FIFO_SIZE];
+    uint16_t rx_timestamp[FDCAN_RX_FIFO_SIZE];
+    uint32_t rx_head;
+    uint32_t rx_count;
+    uint32_t rx_lost_count;
+
+    // Tx FIFO: elements held by the bus, frames added this step
+    uint32_t tx_pending;
+    struct can_frame tx[FDCAN_TX_FIFO_SIZE];
+    uint32_t tx_count;
+    uint32_t tx_full_count;
+} EVERT_HARNESS_FDCAN_TypeDef;
+
+extern EVERT_HARNESS_FDCAN_TypeDef harness_fdcan;
+
+void EVERT_HARNESS_FDCAN_Init(void);
+void EVERT_HARNESS_FDCAN_BeginStep(const uint32_t tick, const uint64_t local_us, const uint32_t tx_pending);
+bool EVERT_HARNESS_FDCAN_Receive(const struct can_frame *frame, const uint64_t start_us);
+
+#endif // EVERT_HARNESS_FDCAN_H_
@@ -0,0 +1,279 @@
+/**
+ ******************************************************************************
+ * @file    harness_node.c
+ * @author  Evert Firmware Team
+ * @brief   Device firmware node of the harness: process, boots, lockstep and the node side step
+ *
+ ******************************************************************************
+ **/
+
+#include <fcntl.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include "harness_fdcan.h"
+#include "harness_node.h"
+
+#define EVERT_HARNESS_NODE_LF_PERIOD_MS (10) // EVERT_CONSTANT_BC_ISR_LF_PERIOD_MS
+#define EVERT_HARNESS_NODE_HF_PER_MS (10)    // EVERT_CONSTANT_BC_ISR_HF_PERIOD, 10 kHz
+
+static EVERT_HARNESS_NODE_ReportTypeDef node_report;
+static EVERT_HARNESS_NODE_StepTypeDef node_step;
+static jmp_buf node_reset_jump;
+static EVERT_HARNESS_NODE_ResetTypeDef node_reset_cause;
+static bool node_powered;
+
+/// @brief Event of the node for the harness, node side
+void EVERT_HARNESS_NODE_Event(const EVERT_HARNESS_NODE_EventKindTypeDef kind, const uint8_t value)
+{
+    if (node_report.event_count == EVERT_CONSTANT_HARNESS_STEP_EVENT_MAX)
+    {
+        node_report.event_overflow_count++;
+        return;
+    }
+
+    node_report.events[node_report.event_count++] = (EVERT_HARNESS_NODE_EventTypeDef){(uint8_t)kind, value, harness_fdcan.tick};
+}
+
+/// @brief End the boot from anywhere within the step (NVIC_SystemReset, watchdog), its report still goes out
+void EVERT_HARNESS_NODE_Reset(const EVERT_HARNESS_NODE_ResetTypeDef cause)
+{
+    node_reset_cause = cause;
+    longjmp(node_reset_jump, 1);
+}
+
+/// @brief One step of the boot: the power on at the first, the interrupts, the main loop
+static void EVERT_HARNESS_NODE_Execute(const EVERT_HARNESS_NODE_ConfigTypeDef *config)
+{
+    // Power on (or reset): reset of the peripheral, the application setup at this tick
+    if (!node_powered)
+    {
+        EVERT_HARNESS_FDCAN_Init();
+        EVERT_HARNESS_FDCAN_BeginStep(node_step.tick, node_step.local_us, node_step.tx_pending);
+        node_powered = true;
+        EVERT_HARNESS_DEVICE_Init(config);
+    }
+
+    EVERT_HARNESS_FDCAN_BeginStep(node_step.tick, node_step.local_us, node_step.tx_pending);
+
+    // FDCAN1_IT0: one interrupt per frame, the ISR empties the FIFO before the next one arrives
+    for (uint32_t i = 0; i < node_step.rx_count && i < EVERT_CONSTANT_HARNESS_STEP_RX_MAX; i++)
+    {
+        if (EVERT_HARNESS_FDCAN_Receive(&node_step.rx[i], node_step.rx_start_us[i]))
+        {
+            EVERT_HARNESS_DEVICE_OnRxFifo0();
+        }
+    }
+
+    for (uint32_t i = 0; i < EVERT_HARNESS_NODE_HF_PER_MS; i++)
+    {
+        EVERT_HARNESS_DEVICE_OnHfTick();
+    }
+
+    if (node_step.tick % EVERT_HARNESS_NODE_LF_PERIOD_MS == 0)
+    {
+        EVERT_HARNESS_DEVICE_OnLfTick();
+    }
+
+    // Main loop until it has nothing left to do this ms
+    for (uint32_t pass = 0; pass < EVERT_CONSTANT_HARNESS_LOOP_PASSES && EVERT_HARNESS_DEVICE_Loop(); pass++)
+    {
+    }
+
+    EVERT_HARNESS_DEVICE_OnStepEnd();
+}
+
+/// @brief A boot: one step per datagram until stopped, a reset or the harness is gone
+/// @return true on a reset, node_reset_cause holds the cause
+static bool EVERT_HARNESS_NODE_Run(const int fd, const EVERT_HARNESS_NODE_ConfigTypeDef *config)
+{
+    while (recv(fd, &node_step, sizeof(node_step), 0) == (ssize_t)sizeof(node_step) && !node_step.stop)
+    {
+        node_report.tx_count = 0;
+        node_report.event_count = 0;
+
+        bool reset = false;
+
+        if (setjmp(node_reset_jump) == 0)
+        {
+            EVERT_HARNESS_NODE_Execute(config);
+        }
+        else
+        {
+            reset = true;
+            EVERT_HARNESS_NODE_Event(HNE_RESET, (uint8_t)node_reset_cause);
+        }
+
+        node_report.tx_count = harness_fdcan.tx_count;
+        memcpy(node_report.tx, harness_fdcan.tx, sizeof(node_report.tx));
+        node_report.rx_lost_count = harness_fdcan.rx_lost_count;
+        EVERT_HARNESS_DEVICE_Report(&node_report);
+
+        if (send(fd, &node_report, sizeof(node_report), 0) != (ssize_t)sizeof(node_report))
+        {
+            break;
+        }
+
+        if (reset)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/// @brief Node process: the supervisor of the boots, each in a child process of its own
+/// @return Exit status, 0 once stopped
+int EVERT_HARNESS_NODE_Main(const int fd, const EVERT_HARNESS_NODE_ConfigTypeDef *config)
+{
+    // Reset cause of the boot that ended, set by the child
+    EVERT_HARNESS_NODE_ResetTypeDef *reset_cause = mmap(NULL, sizeof(*reset_cause), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+    if (reset_cause == MAP_FAILED || !EVERT_HARNESS_DEVICE_PowerOn(config))
+    {
+        fprintf(stderr, "HARNESS: node %u did not power on\n", config->device_id);
+        return 2;
+    }
+
+    bool power_on = true;
+
+    while (EVERT_HARNESS_DEVICE_Boot(power_on, *reset_cause))
+    {
+        fflush(stdout);
+        fflush(stderr);
+
+        pid_t pid = fork();
+        int status = 0;
+
+        if (pid < 0)
+        {
+            perror("HARNESS: fork");
+            return 2;
+        }
+
+        if (pid == 0)
+        {
+            bool reset = EVERT_HARNESS_NODE_Run(fd, config);
+            *reset_cause = node_reset_cause;
+            _exit(reset ? 1 : 0);
+        }
+
+        if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) > 1)
+        {
+            fprintf(stderr, "HARNESS: node %u crashed\n", config->device_id);
+            return 2;
+        }
+
+        if (WEXITSTATUS(status) == 0)
+        {
+            return 0;
+        }
+
+        power_on = false;
+    }
+
+    fprintf(stderr, "HARNESS: node %u has nothing to boot\n", config->device_id);
+    return 2;
+}
+
+bool EVERT_HARNESS_NODE_Spawn(EVERT_HARNESS_NODE_TypeDef *node, const EVERT_HARNESS_NODE_ConfigTypeDef *config, const uint32_t station)
+{
+    int fds[2];
+
+    memset(node, 0, sizeof(*node));
+    node->config = *config;
+    node->station = station;
+    node->fd = -1;
+
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) != 0)
+    {
+        perror("HARNESS: socketpair");
+        return false;
+    }
+
+    // Nothing buffered may be written twice
+    fflush(stdout);
+    fflush(stderr);
+
+    node->pid = fork();
+
+    if (node->pid < 0)
+    {
+        perror("HARNESS: fork");
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+
+    if (node->pid == 0)
+    {
+        close(fds[0]);
+
+        if (config->role != HNR_BOOST_CONVERTER)
+        {
+            _exit(EVERT_HARNESS_NODE_Main(fds[1], config));
+        }
+
+        // The boost converter application is an executable of its own, the socket stays open across the exec
+        char fd[16];
+        snprintf(fd, sizeof(fd), "%d", fds[1]);
+        fcntl(fds[1], F_SETFD, 0);
+        execl(EVERT_HARNESS_BOOST_CONVERTER_NODE, EVERT_HARNESS_BOOST_CONVERTER_NODE, fd, (char *)NULL);
+        perror("HARNESS: " EVERT_HARNESS_BOOST_CONVERTER_NODE);
+        _exit(2);
+    }
+
+    close(fds[1]);
+    node->fd = fds[0];
+
+    // The executable takes its configuration first
+    if (config->role == HNR_BOOST_CONVERTER && send(node->fd, config, sizeof(*config), 0) != (ssize_t)sizeof(*config))
+    {
+        perror("HARNESS: node config");
+        return false;
+    }
+
+    return true;
+}
+
+/// @brief One ms of the node, the report lands in node->report
+/// @return false if the node is gone
+bool EVERT_HARNESS_NODE_Step(EVERT_HARNESS_NODE_TypeDef *node, const EVERT_HARNESS_NODE_StepTypeDef *step)
+{
+    if (send(node->fd, step, sizeof(*step), 0) != (ssize_t)sizeof(*step))
+    {
+        perror("HARNESS: node step");
+        return false;
+    }
+
+    if (recv(node->fd, &node->report, sizeof(node->report), 0) != (ssize_t)sizeof(node->report))
+    {
+        fprintf(stderr, "HARNESS: node %u did not answer\n", node->config.device_id);
+        return false;
+    }
+
+    return true;
+}
+
+void EVERT_HARNESS_NODE_Stop(EVERT_HARNESS_NODE_TypeDef *node)
+{
+    if (node->fd >= 0)
+    {
+        EVERT_HARNESS_NODE_StepTypeDef step = {.stop = true};
+        send(node->fd, &step, sizeof(step), 0);
+        close(node->fd);
+        node->fd = -1;
+    }
+
+    if (node->pid > 0)
+    {
+        waitpid(node->pid, NULL, 0);
+        node->pid = 0;
+    }
+}
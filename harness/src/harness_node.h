@@ -0,0 +1,150 @@
+/**
+ ******************************************************************************
+ * @file    harness_node.h
+ * @author  Evert Firmware Team
+ * @brief   Device firmware node of the harness: one process per device
+ *          * The firmware keeps its state in globals, one process each keeps the devices apart with the
+ *            firmware sources unchanged. The boost converters run their application in their own executable
+ *            (EVERT_HARNESS_BOOST_CONVERTER_NODE), the node process execs it
+ *          * Boots: the node process supervises, each boot runs in a child forked from it, so the globals of the
+ *            firmware start over like RAM after a reset. What survives a reset (flash, option bytes, retained
+ *            RAM) is shared with the supervisor by the node side
+ *          * Lockstep: the harness sends a step per ms (node time, frames received, Tx FIFO level), the node
+ *            runs its ISRs and main loop passes for it and answers with the frames it queued and its events
+ *          * A reset (NVIC_SystemReset, a watchdog) ends the boot within its step, the next boot powers on at
+ *            the next step, the node time goes on
+ *          * Step and report are datagrams over a socketpair (SOCK_SEQPACKET)
+ *          * Node side: harness_device.c (inverter), boost_converter/ (the boost converter application)
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_HARNESS_NODE_H_
+#define EVERT_HARNESS_NODE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <linux/can.h>
+#include <stm32g4xx_hal.h>
+#include "_conf_evert_harness.h"
+#include "can_handler.h"
+#include "evert_device.h"
+
+typedef enum
+{
+    HNR_BOOST_CONVERTER = 0,
+    HNR_INVERTER = 1
+} EVERT_HARNESS_NODE_RoleTypeDef;
+
+typedef struct
+{
+    uint8_t device_id;
+    EVERT_HARNESS_NODE_RoleTypeDef role;
+    uint32_t power_on_ms;  // Virtual time the node powers on
+    float available_power; // W, boost converter: string power without a limit
+    int32_t clock_ppm;     // Crystal of the node against the bus time
+} EVERT_HARNESS_NODE_ConfigTypeDef;
+
+typedef enum
+{
+    HNE_STATE = 0,   // Resultant device state changed, value = state
+    HNE_COMMAND = 1, // CCU command applied, value = method
+    HNE_RESET = 2    // Reset by the application or a watchdog, value = EVERT_HARNESS_NODE_ResetTypeDef, the node boots again at the next step
+} EVERT_HARNESS_NODE_EventKindTypeDef;
+
+typedef enum
+{
+    HNX_SOFTWARE = 0, // NVIC_SystemReset
+    HNX_IWDG = 1,
+    HNX_WWDG = 2
+} EVERT_HARNESS_NODE_ResetTypeDef;
+
+typedef struct
+{
+    uint8_t kind;
+    uint8_t value;
+    uint32_t tick; // Node time
+} EVERT_HARNESS_NODE_EventTypeDef;
+
+/// @brief Harness -> node
+typedef struct
+{
+    uint32_t tick;       // Node time (ms since the power on)
+    uint64_t local_us;   // Node crystal since the power on (cycle counter)
+    uint32_t tx_pending; // Tx FIFO elements the bus has not sent yet
+    uint32_t rx_count;
+    bool stop;
+    struct can_frame rx[EVERT_CONSTANT_HARNESS_STEP_RX_MAX];
+    uint64_t rx_start_us[EVERT_CONSTANT_HARNESS_STEP_RX_MAX]; // Start of frame on the node crystal
+} EVERT_HARNESS_NODE_StepTypeDef;
+
+/// @brief Node -> harness
+typedef struct
+{
+    uint32_t tx_count;
+    struct can_frame tx[FDCAN_TX_FIFO_SIZE];
+    uint32_t event_count;
+    EVERT_HARNESS_NODE_EventTypeDef events[EVERT_CONSTANT_HARNESS_STEP_EVENT_MAX];
+
+    // Totals
+    uint32_t event_overflow_count;
+    uint32_t rx_lost_count; // Rx FIFO 0 full
+    EVERT_CAN_StatisticsTypeDef can;
+    uint8_t result_state;
+    uint8_t alarm_level; // EVERT_DEVICE_Alarm_Check, boost converter
+    float power;       // W, boost converter
+    float power_limit; // W, < 0 = unlimited
+
+    // Time synchronization (time_sync.h), boost converter
+    uint64_t time_sync_us; // EVERT_TIME_SYNC_Now at the step, 0 = never synchronized
+    bool time_sync_locked;
+    int32_t time_sync_rate_ppb;
+    uint32_t time_sync_step_count;
+
+    // Delta telemetry (delta_telemetry.h), boost converter
+    uint32_t telemetry_signal_count;
+    uint32_t telemetry_sample_count;
+    uint32_t telemetry_frame_count;
+    uint32_t telemetry_keyframe_frame_count;
+    uint32_t telemetry_byte_count;
+
+    // Firmware update, boost converter
+    uint8_t update_state; // EVERT_CCU_UpdateStateTypeDef
+    uint8_t version[3];   // Of the running image
+
+    // Boot phases of the last power on (or reset)
+    EVERT_DEVICE_BootTimingTypeDef boot;
+} EVERT_HARNESS_NODE_ReportTypeDef;
+
+typedef struct
+{
+    EVERT_HARNESS_NODE_ConfigTypeDef config;
+    pid_t pid;
+    int fd;
+    uint32_t station; // On the bus
+    EVERT_HARNESS_NODE_ReportTypeDef report;
+} EVERT_HARNESS_NODE_TypeDef;
+
+bool EVERT_HARNESS_NODE_Spawn(EVERT_HARNESS_NODE_TypeDef *node, const EVERT_HARNESS_NODE_ConfigTypeDef *config, const uint32_t station);
+bool EVERT_HARNESS_NODE_Step(EVERT_HARNESS_NODE_TypeDef *node, const EVERT_HARNESS_NODE_StepTypeDef *step);
+void EVERT_HARNESS_NODE_Stop(EVERT_HARNESS_NODE_TypeDef *node);
+
+// Node process
+int EVERT_HARNESS_NODE_Main(const int fd, const EVERT_HARNESS_NODE_ConfigTypeDef *config);
+void EVERT_HARNESS_NODE_Event(const EVERT_HARNESS_NODE_EventKindTypeDef kind, const uint8_t value);
+void EVERT_HARNESS_NODE_Reset(const EVERT_HARNESS_NODE_ResetTypeDef cause) __attribute__((noreturn));
+
+// Node side, supervisor: the power on once, then before every boot
+bool EVERT_HARNESS_DEVICE_PowerOn(const EVERT_HARNESS_NODE_ConfigTypeDef *config);
+bool EVERT_HARNESS_DEVICE_Boot(const bool power_on, const EVERT_HARNESS_NODE_ResetTypeDef cause);
+
+// Node side, a boot
+void EVERT_HARNESS_DEVICE_Init(const EVERT_HARNESS_NODE_ConfigTypeDef *config);
+void EVERT_HARNESS_DEVICE_OnRxFifo0(void);
+void EVERT_HARNESS_DEVICE_OnHfTick(void);
+void EVERT_HARNESS_DEVICE_OnLfTick(void);
+bool EVERT_HARNESS_DEVICE_Loop(void);
+void EVERT_HARNESS_DEVICE_OnStepEnd(void);
+void EVERT_HARNESS_DEVICE_Report(EVERT_HARNESS_NODE_ReportTypeDef *report);
+
+#endif // EVERT_HARNESS_NODE_H_
@@ -0,0 +1,43 @@
+/**
+ ******************************************************************************
+ * @file    harness_test.h
+ * @author  Evert Firmware Team
+ * @brief   Checks of the host unit tests (harness/test), printed like the checks of the harness
+ *          * EVERT_HARNESS_TEST_Check: one line per check, PASS or FAIL
+ *          * EVERT_HARNESS_TEST_Result: the summary, the exit status for ctest (1 if a check failed)
+ *
+ ******************************************************************************
+ **/
+#ifndef EVERT_HARNESS_TEST_H_
+#define EVERT_HARNESS_TEST_H_
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+static uint32_t harness_test_failed_count;
+
+static inline void EVERT_HARNESS_TEST_Check(const bool passed, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+static inline void EVERT_HARNESS_TEST_Check(const bool passed, const char *format, ...)
+{
+    va_list arguments;
+    va_start(arguments, format);
+    printf("  %s  ", passed ? "PASS" : "FAIL");
+    vprintf(format, arguments);
+    printf("\n");
+    va_end(arguments);
+
+    harness_test_failed_count += !passed;
+}
+
+static inline int EVERT_HARNESS_TEST_Result(void)
+{
+    printf("\n%s: %" PRIu32 " check(s) failed\n", harness_test_failed_count == 0 ? "PASSED" : "FAILED", harness_test_failed_count);
+
+    return harness_test_failed_count == 0 ? 0 : 1;
+}
+
+#endif // EVERT_HARNESS_TEST_H_
@@ -0,0 +1,170 @@
+/**
+ ******************************************************************************
+ * @file    test_midpoint_balancing.c
+ * @author  Evert Firmware Team
+ * @brief   Midpoint balancing of the inverter (EVERT_INVERTER_GridFormingMidpointBalancing) on a plant model
+ *          * Bridge: three-level, averaged over the PWM period, each phase clamped to the midpoint for (1 - |d|)
+ *          * Bus: held by the boost converters, split by two equal capacitors, the midpoint drifts with i_0
+ *          * Load: sinusoidal phase currents at a power factor, the modulation of the open-loop test duties
+ *          * EVERT_INVERTER_GridFormingMidpointBalancing at the 25 kHz of the HF ISR
+ *
+ ******************************************************************************
+ **/
+
+#include <math.h>
+#include "harness_test.h"
+#include "inverter_grid.h"
+
+#define TEST_MIDPOINT_BUS_VOLTAGE (800.0f)      // V
+#define TEST_MIDPOINT_CAPACITANCE (500e-6f)     // F, each half of the bus
+#define TEST_MIDPOINT_MODULATION (0.8f)         // Peak duty
+#define TEST_MIDPOINT_CURRENT (20.0f)           // A peak
+#define TEST_MIDPOINT_FREQUENCY (50.0f)         // Hz
+#define TEST_MIDPOINT_IMBALANCE (40.0f)         // V, the midpoint off at the start
+#define TEST_MIDPOINT_LEAKAGE (0.5f)            // A, out of the midpoint: unequal capacitor leakage
+#define TEST_MIDPOINT_BALANCED (2.0f)           // V
+
+// Readings and state of the inverter the balancing uses
+volatile float32_t uf_bus_voltage;
+volatile float32_t uf_bus_voltage_mid;
+volatile float32_t uf_current_u;
+volatile float32_t uf_current_v;
+volatile float32_t uf_current_w;
+EVERT_PID_StateTypeDef gf_pi_state_midpoint;
+float32_t gf_duty_cycle_0_pu;
+
+typedef struct
+{
+    float32_t angle;       // rad, of the modulation
+    float32_t phase;       // rad, current behind the voltage
+    float32_t current;     // A peak
+    float32_t voltage_mid; // V, of the bottom capacitor
+    float32_t offset_max;  // Largest zero-sequence offset applied
+    bool balancing;
+} TEST_MIDPOINT_PlantTypeDef;
+
+static void TEST_MIDPOINT_Init(TEST_MIDPOINT_PlantTypeDef *plant, const float32_t phase, const float32_t current, const bool balancing)
+{
+    // As EVERT_INVERTER_GridFormingInit
+    EVERT_PID_Init(&gf_pi_state_midpoint, EVERT_SETTING_INVERTER_MIDPOINT_KP, EVERT_SETTING_INVERTER_MIDPOINT_KI, 0.0f, EVERT_CONSTANT_INVERTER_ISR_HF_PERIOD,
+                   -EVERT_SETTING_INVERTER_MIDPOINT_DUTY_MAX, EVERT_SETTING_INVERTER_MIDPOINT_DUTY_MAX);
+    gf_duty_cycle_0_pu = 0.0f;
+
+    *plant = (TEST_MIDPOINT_PlantTypeDef){
+        .phase = phase,
+        .current = current,
+        .voltage_mid = 0.5f * TEST_MIDPOINT_BUS_VOLTAGE + TEST_MIDPOINT_IMBALANCE,
+        .balancing = balancing,
+    };
+}
+
+/// @brief Run the plant for the time, one ISR per step
+/// @return Midpoint error averaged over the last grid period, without the ripple at 3x the grid frequency i_0 carries
+static float32_t TEST_MIDPOINT_Run(TEST_MIDPOINT_PlantTypeDef *plant, const float32_t duration)
+{
+    const uint32_t steps = (uint32_t)(duration / EVERT_CONSTANT_INVERTER_ISR_HF_PERIOD);
+    const uint32_t period = (uint32_t)(1.0f / (TEST_MIDPOINT_FREQUENCY * EVERT_CONSTANT_INVERTER_ISR_HF_PERIOD));
+    const float32_t shift[3] = {0.0f, -2.0f * PI / 3.0f, 2.0f * PI / 3.0f};
+    float32_t error_sum = 0.0f;
+
+    for (uint32_t step = 0; step < steps; step++)
+    {
+        float32_t duty[3];
+        float32_t current[3];
+
+        for (uint32_t x = 0; x < 3; x++)
+        {
+            duty[x] = TEST_MIDPOINT_MODULATION * sinf(plant->angle + shift[x]);
+            current[x] = plant->current * sinf(plant->angle + shift[x] - plant->phase);
+        }
+
+        uf_bus_voltage = TEST_MIDPOINT_BUS_VOLTAGE;
+        uf_bus_voltage_mid = plant->voltage_mid;
+        uf_current_u = current[0];
+        uf_current_v = current[1];
+        uf_current_w = current[2];
+
+        if (plant->balancing)
+        {
+            EVERT_INVERTER_GridFormingMidpointBalancing(&duty[0], &duty[1], &duty[2]);
+            plant->offset_max = fmaxf(plant->offset_max, fabsf(gf_duty_cycle_0_pu));
+        }
+
+        // Midpoint current out of the node, the bus is held so both capacitors share it
+        float32_t current_mid = TEST_MIDPOINT_LEAKAGE;
+
+        for (uint32_t x = 0; x < 3; x++)
+        {
+            current_mid += (1.0f - fabsf(duty[x])) * current[x];
+        }
+
+        plant->voltage_mid -= current_mid / (2.0f * TEST_MIDPOINT_CAPACITANCE) * EVERT_CONSTANT_INVERTER_ISR_HF_PERIOD;
+        EVERT_INVERTER_MATH_CLAMP(plant->voltage_mid, 0.0f, TEST_MIDPOINT_BUS_VOLTAGE);
+
+        plant->angle += 2.0f * PI * TEST_MIDPOINT_FREQUENCY * EVERT_CONSTANT_INVERTER_ISR_HF_PERIOD;
+        plant->angle -= (plant->angle > 2.0f * PI) ? 2.0f * PI : 0.0f;
+
+        if (step + period >= steps)
+        {
+            error_sum += plant->voltage_mid - 0.5f * TEST_MIDPOINT_BUS_VOLTAGE;
+        }
+    }
+
+    return fabsf(error_sum) / (float32_t)period;
+}
+
+/// @brief From the imbalance at the start, at a power factor, with the leakage pulling the midpoint down
+static void TEST_MIDPOINT_Balance(const float32_t phase_degrees)
+{
+    TEST_MIDPOINT_PlantTypeDef plant;
+
+    TEST_MIDPOINT_Init(&plant, phase_degrees * PI / 180.0f, TEST_MIDPOINT_CURRENT, true);
+    float32_t error = TEST_MIDPOINT_Run(&plant, 1.0f);
+
+    EVERT_HARNESS_TEST_Check(error < TEST_MIDPOINT_BALANCED && plant.offset_max <= EVERT_SETTING_INVERTER_MIDPOINT_DUTY_MAX,
+                             "current %.0f deg behind: %.0f V off balanced to within %.2f V after 1 s (offset at most %.3f)",
+                             (double)phase_degrees, (double)TEST_MIDPOINT_IMBALANCE, (double)error, (double)plant.offset_max);
+}
+
+/// @brief The plant without the balancing: the leakage drifts the midpoint away
+static void TEST_MIDPOINT_Drift(void)
+{
+    TEST_MIDPOINT_PlantTypeDef plant;
+
+    TEST_MIDPOINT_Init(&plant, 0.0f, TEST_MIDPOINT_CURRENT, false);
+    float32_t error = TEST_MIDPOINT_Run(&plant, 1.0f);
+
+    EVERT_HARNESS_TEST_Check(error > 10.0f * TEST_MIDPOINT_BALANCED, "without the balancing: %.0f V off after 1 s", (double)error);
+}
+
+/// @brief No current: no direction to inject in, the offset stays where it was and nothing winds up
+static void TEST_MIDPOINT_NoCurrent(void)
+{
+    TEST_MIDPOINT_PlantTypeDef plant;
+
+    TEST_MIDPOINT_Init(&plant, 0.0f, 0.0f, true);
+    TEST_MIDPOINT_Run(&plant, 0.1f);
+    float32_t integral = gf_pi_state_midpoint.Integral;
+
+    EVERT_HARNESS_TEST_Check(plant.offset_max == 0.0f && integral == 0.0f, "no current: offset %.3f, integrator %.3f", (double)plant.offset_max, (double)integral);
+
+    // Loaded again: balances from there
+    plant.current = TEST_MIDPOINT_CURRENT;
+    float32_t error = TEST_MIDPOINT_Run(&plant, 1.0f);
+
+    EVERT_HARNESS_TEST_Check(error < TEST_MIDPOINT_BALANCED, "loaded after no current: balanced to within %.2f V", (double)error);
+}
+
+int main(void)
+{
+    printf("Midpoint balancing, %.0f V bus, 2 x %.0f uF, %.0f A peak at %.0f Hz\n", (double)TEST_MIDPOINT_BUS_VOLTAGE, (double)(TEST_MIDPOINT_CAPACITANCE * 1e6f),
+           (double)TEST_MIDPOINT_CURRENT, (double)TEST_MIDPOINT_FREQUENCY);
+
+    TEST_MIDPOINT_Drift();
+    TEST_MIDPOINT_Balance(0.0f);
+    TEST_MIDPOINT_Balance(30.0f);
+    TEST_MIDPOINT_Balance(-30.0f);
+    TEST_MIDPOINT_NoCurrent();
+
+    return EVERT_HARNESS_TEST_Result();
+}
@@ -0,0 +1,252 @@
+/**
+ ******************************************************************************
+ * @file    test_mppt.c
+ * @author  Evert Firmware Team
+ * @brief   MPPT of the boost converter (boost_converter_mppt.c) on a simulated PV string
+ *          * String: modules in series, single diode each with an ideal bypass diode, irradiance per module
+ *          * Control loops taken as ideal: the PV voltage follows the operating point up to open circuit
+ *          * EVERT_BOOST_CONVERTER_MpptRun at the 100 Hz of the LF ISR
+ *          * The operating point stays between the input voltage warnings throughout
+ *
+ ******************************************************************************
+ **/
+
+#include <math.h>
+#include "boost_converter_mppt.h"
+#include "harness_test.h"
+
+#define TEST_MPPT_MODULE_COUNT_MAX (16)
+#define TEST_MPPT_MODULE_SHORT_CIRCUIT (10.0f)   // A at full irradiance
+#define TEST_MPPT_TRACKED (0.98f)                // Of the maximum power, on the maximum
+#define TEST_MPPT_TRACK_MS (30000u)
+
+volatile EVERT_BOOST_CONVERTER_MpptStateTypeDef mppt_state;
+volatile float32_t fi_voltage_in;
+volatile float32_t fi_voltage_out;
+volatile float32_t fi_current_in;
+volatile float32_t fi_power_in;
+
+typedef struct
+{
+    uint32_t module_count;
+    float open_circuit; // V, per module
+    float thermal;      // V, diode ideality times the thermal voltage of the cells of a module
+} TEST_MPPT_StringTypeDef;
+
+// Open circuit within the range: curtailed to 0 W at its top
+static const TEST_MPPT_StringTypeDef test_mppt_string = {.module_count = 6, .open_circuit = 35.0f, .thermal = 1.5f};
+// Short modules: one bypassed moves the maximum by less than the range, both maxima are in it
+static const TEST_MPPT_StringTypeDef test_mppt_string_short = {.module_count = 16, .open_circuit = 14.0f, .thermal = 0.55f};
+
+static const TEST_MPPT_StringTypeDef *test_mppt_string_active;
+static float test_mppt_irradiance[TEST_MPPT_MODULE_COUNT_MAX];
+static float test_mppt_voltage_reference;
+static float test_mppt_operating_point_min;
+static float test_mppt_operating_point_max;
+
+void EVERT_BOOST_CONVERTER_SetDutyCycle(float32_t duty_cycle)
+{
+    (void)duty_cycle;
+}
+
+void EVERT_BOOST_CONVERTER_ControlSetVoltageReference(const float32_t voltage_reference)
+{
+    test_mppt_voltage_reference = voltage_reference;
+}
+
+/// @brief String voltage at the current, the modules that cannot carry it are bypassed
+static float TEST_MPPT_StringVoltage(const float current)
+{
+    const TEST_MPPT_StringTypeDef *string = test_mppt_string_active;
+    const float saturation = TEST_MPPT_MODULE_SHORT_CIRCUIT / (expf(string->open_circuit / string->thermal) - 1.0f);
+    float voltage = 0.0f;
+
+    for (uint32_t i = 0; i < string->module_count; i++)
+    {
+        float short_circuit = TEST_MPPT_MODULE_SHORT_CIRCUIT * test_mppt_irradiance[i];
+
+        if (current < short_circuit)
+        {
+            voltage += string->thermal * logf((short_circuit - current) / saturation + 1.0f);
+        }
+    }
+
+    return voltage;
+}
+
+/// @brief String current at the voltage, the voltage falls with the current
+static float TEST_MPPT_StringCurrent(const float voltage)
+{
+    float low = 0.0f;
+    float high = TEST_MPPT_MODULE_SHORT_CIRCUIT;
+
+    if (voltage >= TEST_MPPT_StringVoltage(0.0f))
+    {
+        return 0.0f;
+    }
+
+    for (uint32_t i = 0; i < 40; i++)
+    {
+        float current = 0.5f * (low + high);
+
+        if (TEST_MPPT_StringVoltage(current) > voltage)
+        {
+            low = current;
+        }
+        else
+        {
+            high = current;
+        }
+    }
+
+    return 0.5f * (low + high);
+}
+
+static float TEST_MPPT_MaximumPower(void)
+{
+    float maximum = 0.0f;
+
+    for (float voltage = 0.0f; voltage < TEST_MPPT_StringVoltage(0.0f); voltage += 0.1f)
+    {
+        maximum = fmaxf(maximum, voltage * TEST_MPPT_StringCurrent(voltage));
+    }
+
+    return maximum;
+}
+
+static void TEST_MPPT_Irradiance(const float shaded)
+{
+    for (uint32_t i = 0; i < test_mppt_string_active->module_count; i++)
+    {
+        test_mppt_irradiance[i] = (i == 0) ? shaded : 1.0f;
+    }
+}
+
+/// @brief Run the tracker for the time on the string, the readings of the operating point it applied
+/// @return Power at the end
+static float TEST_MPPT_Run(const uint32_t duration_ms)
+{
+    for (uint32_t t = 0; t < duration_ms; t += EVERT_CONSTANT_BC_ISR_LF_PERIOD_MS)
+    {
+        float voltage = fminf(test_mppt_voltage_reference, TEST_MPPT_StringVoltage(0.0f));
+        float current = TEST_MPPT_StringCurrent(voltage);
+
+        fi_voltage_in = voltage;
+        fi_current_in = current;
+        fi_power_in = voltage * current;
+
+        EVERT_BOOST_CONVERTER_MpptRun();
+
+        test_mppt_operating_point_min = fminf(test_mppt_operating_point_min, test_mppt_voltage_reference);
+        test_mppt_operating_point_max = fmaxf(test_mppt_operating_point_max, test_mppt_voltage_reference);
+    }
+
+    return fi_power_in;
+}
+
+static void TEST_MPPT_Start(const TEST_MPPT_StringTypeDef *string, const EVERT_BOOST_CONVERTER_MpptAlgorithmTypeDef algorithm, const float shaded)
+{
+    test_mppt_string_active = string;
+    TEST_MPPT_Irradiance(shaded);
+
+    // As EVERT_BOOST_CONVERTER_ControlInit, the loops start on the top of the range
+    test_mppt_voltage_reference = EVERT_SETTING_BC_MPPT_OPERATING_POINT_MAX;
+    EVERT_BOOST_CONVERTER_MpptInit();
+    EVERT_BOOST_CONVERTER_MpptSetAlgorithm(algorithm);
+    mppt_state.status = BCS_RUNNING;
+}
+
+/// @brief On the maximum after the start, then curtailed to 0 W and released, then throttled down and running again
+static void TEST_MPPT_Release(const EVERT_BOOST_CONVERTER_MpptAlgorithmTypeDef algorithm, const char *name)
+{
+    TEST_MPPT_Start(&test_mppt_string, algorithm, 1.0f);
+    float maximum = TEST_MPPT_MaximumPower();
+    float power = TEST_MPPT_Run(TEST_MPPT_TRACK_MS);
+
+    EVERT_HARNESS_TEST_Check(power >= TEST_MPPT_TRACKED * maximum, "%s on the maximum after the start: %.0f W of %.0f W", name, (double)power, (double)maximum);
+
+    // Curtailed: no power at all once there, not even between the perturbations
+    float curtailed_power = 0.0f;
+    EVERT_BOOST_CONVERTER_MpptSetPowerLimit(0.0f);
+    TEST_MPPT_Run(5000u);
+
+    for (uint32_t i = 0; i < 50; i++)
+    {
+        curtailed_power = fmaxf(curtailed_power, TEST_MPPT_Run(100u));
+    }
+
+    float curtailed_point = mppt_state.operating_point;
+
+    EVERT_HARNESS_TEST_Check(curtailed_power == 0.0f, "%s curtailed to 0 W: at most %.0f W", name, (double)curtailed_power);
+
+    EVERT_BOOST_CONVERTER_MpptSetPowerLimit(-1.0f);
+    power = TEST_MPPT_Run(TEST_MPPT_TRACK_MS);
+
+    EVERT_HARNESS_TEST_Check(power >= TEST_MPPT_TRACKED * maximum, "%s back on the maximum after a curtailment to 0 W (at %.1f V): %.0f W of %.0f W",
+                             name, (double)curtailed_point, (double)power, (double)maximum);
+
+    // Throttled down (warning): backs off into the top of the range, clamped there
+    mppt_state.status = BCS_THROTTLE_DOWN;
+    TEST_MPPT_Run(5000u);
+    float throttled_point = mppt_state.operating_point;
+
+    mppt_state.status = BCS_RUNNING;
+    power = TEST_MPPT_Run(TEST_MPPT_TRACK_MS);
+
+    EVERT_HARNESS_TEST_Check(power >= TEST_MPPT_TRACKED * maximum, "%s back on the maximum from the top of the range (at %.1f V): %.0f W of %.0f W",
+                             name, (double)throttled_point, (double)power, (double)maximum);
+}
+
+/// @brief One module shaded: the tracker from the top of the range finds the maximum at the higher voltage, the first
+/// sweep, one interval after the start, the global one
+static void TEST_MPPT_Shading(void)
+{
+    TEST_MPPT_Start(&test_mppt_string_short, BCMA_PERTURB_AND_OBSERVE, 0.7f);
+    float maximum = TEST_MPPT_MaximumPower();
+    float local = TEST_MPPT_Run(TEST_MPPT_TRACK_MS);
+    float local_point = mppt_state.operating_point;
+
+    EVERT_HARNESS_TEST_Check(mppt_state.phase == BCMP_TRACKING && local < TEST_MPPT_TRACKED * maximum,
+                             "partial shading: no sweep at the start, tracking the local maximum at %.1f V, %.0f W", (double)local_point, (double)local);
+
+    float power = TEST_MPPT_Run((uint32_t)EVERT_SETTING_BC_MPPT_SWEEP_INTERVAL_MS);
+
+    EVERT_HARNESS_TEST_Check(power >= TEST_MPPT_TRACKED * maximum, "partial shading: on the global maximum after the first sweep, %.0f W of %.0f W at %.1f V",
+                             (double)power, (double)maximum, (double)mppt_state.operating_point);
+}
+
+/// @brief Curtailed: held just below the limit
+static void TEST_MPPT_Limit(void)
+{
+    const float limit = 1000.0f;
+
+    TEST_MPPT_Start(&test_mppt_string, BCMA_PERTURB_AND_OBSERVE, 1.0f);
+    TEST_MPPT_Run(TEST_MPPT_TRACK_MS);
+    EVERT_BOOST_CONVERTER_MpptSetPowerLimit(limit);
+    float power = TEST_MPPT_Run(TEST_MPPT_TRACK_MS);
+
+    EVERT_HARNESS_TEST_Check(power <= limit && power >= limit * (1.0f - 2.0f * EVERT_SETTING_BC_MPPT_POWER_LIMIT_BAND), "power limit %.0f W: held at %.0f W",
+                             (double)limit, (double)power);
+}
+
+int main(void)
+{
+    printf("MPPT on a simulated PV string (%" PRIu32 " modules, %.0f V open circuit), range %.0f to %.0f V\n", test_mppt_string.module_count,
+           (double)(test_mppt_string.module_count * test_mppt_string.open_circuit), (double)EVERT_SETTING_BC_MPPT_OPERATING_POINT_MIN,
+           (double)EVERT_SETTING_BC_MPPT_OPERATING_POINT_MAX);
+
+    test_mppt_operating_point_min = INFINITY;
+    test_mppt_operating_point_max = -INFINITY;
+
+    TEST_MPPT_Release(BCMA_PERTURB_AND_OBSERVE, "perturb and observe");
+    TEST_MPPT_Release(BCMA_INCREMENTAL_CONDUCTANCE, "incremental conductance");
+    TEST_MPPT_Shading();
+    TEST_MPPT_Limit();
+
+    // No input voltage alarm from the tracker itself: the sweep and the back-offs stay inside the warnings
+    EVERT_HARNESS_TEST_Check(test_mppt_operating_point_min > EVERT_CONSTRAINT_BC_VOLTAGE_IN_LOW_WARNING && test_mppt_operating_point_max < EVERT_CONSTRAINT_BC_VOLTAGE_IN_HIGH_WARNING,
+                             "operating point %.1f to %.1f V, inside the input voltage warnings %.0f and %.0f V", (double)test_mppt_operating_point_min,
+                             (double)test_mppt_operating_point_max, (double)EVERT_CONSTRAINT_BC_VOLTAGE_IN_LOW_WARNING, (double)EVERT_CONSTRAINT_BC_VOLTAGE_IN_HIGH_WARNING);
+
+    return EVERT_HARNESS_TEST_Result();
+}
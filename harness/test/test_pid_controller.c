@@ -0,0 +1,189 @@
+/**
+ ******************************************************************************
+ * @file    test_pid_controller.c
+ * @author  Evert Firmware Team
+ * @brief   PI/PID controller of the control loops (libs/core/src/pid_controller.h)
+ *          * Plant: first order lag, the loops of the converters sampled at 10 kHz
+ *          * Anti-windup, bumpless transfer, the rate limit, the dq pair against two single controllers
+ *
+ ******************************************************************************
+ **/
+
+#include <math.h>
+#include "harness_test.h"
+#include "pid_controller.h"
+
+#define TEST_PID_SAMPLE_TIME (1e-4f) // 10 kHz
+#define TEST_PID_PLANT_TAU (5e-3f)   // s
+#define TEST_PID_KP (0.5f)
+#define TEST_PID_KI (200.0f) // 1/s
+
+typedef struct
+{
+    float32_t output; // Of the plant, the feedback
+} TEST_PID_PlantTypeDef;
+
+static float32_t TEST_PID_PlantStep(TEST_PID_PlantTypeDef *plant, const float32_t input)
+{
+    plant->output += (input - plant->output) * TEST_PID_SAMPLE_TIME / TEST_PID_PLANT_TAU;
+
+    return plant->output;
+}
+
+static void TEST_PID_Init(EVERT_PID_StateTypeDef *pid)
+{
+    EVERT_PID_Init(pid, TEST_PID_KP, TEST_PID_KI, 0.0f, TEST_PID_SAMPLE_TIME, 0.0f, 1.0f);
+}
+
+/// @brief Closed loop for the samples, the plant and the controller carry over
+static float32_t TEST_PID_Run(EVERT_PID_StateTypeDef *pid, TEST_PID_PlantTypeDef *plant, const float32_t setpoint, const uint32_t samples)
+{
+    for (uint32_t i = 0; i < samples; i++)
+    {
+        TEST_PID_PlantStep(plant, EVERT_PID_Update(pid, setpoint, plant->output, 0.0f));
+    }
+
+    return plant->output;
+}
+
+/// @brief Samples until the output comes off its upper limit after the setpoint dropped to a reachable one
+static uint32_t TEST_PID_Recovery(EVERT_PID_StateTypeDef *pid)
+{
+    TEST_PID_PlantTypeDef plant = {0};
+
+    // Unreachable: the plant gain is 1 and the output is limited to 1
+    TEST_PID_Run(pid, &plant, 2.0f, 1000);
+
+    for (uint32_t i = 0; i < 10000; i++)
+    {
+        if (EVERT_PID_Update(pid, 0.5f, plant.output, 0.0f) < pid->OutputMax)
+        {
+            return i;
+        }
+
+        TEST_PID_PlantStep(&plant, pid->Output);
+    }
+
+    return UINT32_MAX;
+}
+
+static void TEST_PID_Step(void)
+{
+    EVERT_PID_StateTypeDef pid;
+    TEST_PID_PlantTypeDef plant = {0};
+
+    TEST_PID_Init(&pid);
+    float32_t output = TEST_PID_Run(&pid, &plant, 0.6f, 2000);
+
+    EVERT_HARNESS_TEST_Check(fabsf(output - 0.6f) < 1e-3f, "step to 0.6: %.4f after 200 ms, no steady state error", (double)output);
+}
+
+static void TEST_PID_AntiWindup(void)
+{
+    EVERT_PID_StateTypeDef pid;
+    EVERT_PID_StateTypeDef windup;
+
+    TEST_PID_Init(&pid);
+    TEST_PID_Init(&windup);
+    EVERT_PID_SetBackCalculationGain(&windup, 0.0f);
+
+    uint32_t recovery = TEST_PID_Recovery(&pid);
+    float32_t integral = pid.Integral;
+    uint32_t windup_recovery = TEST_PID_Recovery(&windup);
+
+    EVERT_HARNESS_TEST_Check(integral <= pid.OutputMax + 0.1f, "anti-windup: integrator %.3f held at the limit %.1f after 100 ms saturated",
+                             (double)integral, (double)pid.OutputMax);
+    EVERT_HARNESS_TEST_Check(recovery < 20 && windup_recovery > 10 * recovery, "anti-windup: off the limit %u samples after the setpoint dropped (%u without)",
+                             recovery, windup_recovery);
+}
+
+static void TEST_PID_BumplessTransfer(void)
+{
+    EVERT_PID_StateTypeDef pid;
+
+    // Taking over an open-loop output: the first update gives it back, with feed forward and a derivative term
+    EVERT_PID_Init(&pid, TEST_PID_KP, TEST_PID_KI, 1e-4f, TEST_PID_SAMPLE_TIME, 0.0f, 1.0f);
+    EVERT_PID_Bumpless(&pid, 0.42f, 0.8f, 0.5f, 0.1f);
+    float32_t output = EVERT_PID_Update(&pid, 0.8f, 0.5f, 0.1f);
+
+    EVERT_HARNESS_TEST_Check(fabsf(output - 0.42f) < 1e-6f, "bumpless: first update %.6f continues the output 0.420000", (double)output);
+
+    // Out of the limits: preloaded to the limit, not past it
+    EVERT_PID_Bumpless(&pid, 1.5f, 0.8f, 0.5f, 0.0f);
+    output = EVERT_PID_Update(&pid, 0.8f, 0.5f, 0.0f);
+
+    EVERT_HARNESS_TEST_Check(output == pid.OutputMax && pid.Integral <= pid.OutputMax, "bumpless: output 1.5 taken over at the limit, %.3f", (double)output);
+}
+
+static void TEST_PID_RateLimit(void)
+{
+    EVERT_PID_StateTypeDef pid;
+    TEST_PID_PlantTypeDef plant = {0};
+    const float32_t rate = 100.0f; // 1/s, 0.01 per sample
+    float32_t step_max = 0.0f;
+
+    TEST_PID_Init(&pid);
+    EVERT_PID_SetRateLimit(&pid, rate);
+
+    for (uint32_t i = 0; i < 5000; i++)
+    {
+        float32_t previous = pid.Output;
+        TEST_PID_PlantStep(&plant, EVERT_PID_Update(&pid, 0.9f, plant.output, 0.0f));
+        step_max = fmaxf(step_max, fabsf(pid.Output - previous));
+    }
+
+    EVERT_HARNESS_TEST_Check(step_max <= rate * TEST_PID_SAMPLE_TIME * 1.0001f, "rate limit %.0f/s: largest change %.5f per sample (limit %.5f)",
+                             (double)rate, (double)step_max, (double)(rate * TEST_PID_SAMPLE_TIME));
+    EVERT_HARNESS_TEST_Check(fabsf(plant.output - 0.9f) < 1e-3f, "rate limit: still settles to 0.9, %.4f", (double)plant.output);
+}
+
+/// @brief The pair against two single controllers on the same inputs, limits hit on the way
+static void TEST_PID_Dq(void)
+{
+    EVERT_PID_DqStateTypeDef dq;
+    EVERT_PID_StateTypeDef d;
+    EVERT_PID_StateTypeDef q;
+    float32_t difference = 0.0f;
+    uint32_t limited = 0;
+    uint32_t x = 0x12345678u;
+
+    EVERT_PID_DqInit(&dq, TEST_PID_KP, TEST_PID_KI, TEST_PID_SAMPLE_TIME, -0.5f, 0.5f);
+    EVERT_PID_Init(&d, TEST_PID_KP, TEST_PID_KI, 0.0f, TEST_PID_SAMPLE_TIME, -0.5f, 0.5f);
+    EVERT_PID_Init(&q, TEST_PID_KP, TEST_PID_KI, 0.0f, TEST_PID_SAMPLE_TIME, -0.5f, 0.5f);
+
+    for (uint32_t i = 0; i < 10000; i++)
+    {
+        float32_t inputs[6];
+
+        for (uint32_t j = 0; j < 6; j++)
+        {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            inputs[j] = (float32_t)(x % 2001u) / 1000.0f - 1.0f;
+        }
+
+        EVERT_PID_DqUpdate(&dq, inputs[0], inputs[1], inputs[2], inputs[3], inputs[4], inputs[5]);
+        float32_t output_d = EVERT_PID_Update(&d, inputs[0], inputs[2], inputs[4]);
+        float32_t output_q = EVERT_PID_Update(&q, inputs[1], inputs[3], inputs[5]);
+
+        difference = fmaxf(difference, fmaxf(fabsf(dq.d.Output - output_d), fabsf(dq.q.Output - output_q)));
+        limited += (fabsf(output_d) == 0.5f) + (fabsf(output_q) == 0.5f);
+    }
+
+    EVERT_HARNESS_TEST_Check(difference < 1e-6f && limited > 0, "dq: both axes as single controllers, largest difference %.2e over 10000 updates (%u at a limit)",
+                             (double)difference, limited);
+}
+
+int main(void)
+{
+    printf("PID controller, %.0f kHz, first order plant\n", (double)(1e-3f / TEST_PID_SAMPLE_TIME));
+
+    TEST_PID_Step();
+    TEST_PID_AntiWindup();
+    TEST_PID_BumplessTransfer();
+    TEST_PID_RateLimit();
+    TEST_PID_Dq();
+
+    return EVERT_HARNESS_TEST_Result();
+}
@@ -0,0 +1,206 @@
+/**
+ ******************************************************************************
+ * @file    test_telemetry.c
+ * @author  Evert Firmware Team
+ * @brief   Binary UART telemetry (libs/core/src/telemetry.c) with the configuration of the inverter
+ *          * COBS: encode/decode round trip, frames cut short rejected without a read past their end
+ *          * UART: a transmit loops back into the receive chunks, 32 bytes per RX event
+ *          * Records through EVERT_TELEMETRY_Send and EVERT_TELEMETRY_Process to the receive callback
+ *
+ ******************************************************************************
+ **/
+
+#include <string.h>
+#include "harness_test.h"
+#include "telemetry.h"
+
+#define TEST_TELEMETRY_COBS_LENGTH (600) // Blocks of 254 bytes and one shorter
+#define TEST_TELEMETRY_WIRE_SIZE (4096)
+
+static uint8_t test_telemetry_wire[TEST_TELEMETRY_WIRE_SIZE];
+static uint32_t test_telemetry_wire_length;
+static uint8_t test_telemetry_received[EVERT_TELEMETRY_PAYLOAD_MAX];
+static uint32_t test_telemetry_received_length;
+static uint32_t test_telemetry_received_count;
+
+uint32_t HAL_GetTick(void)
+{
+    return 1000;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    (void)huart;
+    (void)Timeout;
+
+    memcpy(&test_telemetry_wire[test_telemetry_wire_length], pData, Size);
+    test_telemetry_wire_length += Size;
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size)
+{
+    return HAL_UART_Transmit(huart, pData, Size, 0);
+}
+
+HAL_StatusTypeDef HAL_UART_AbortTransmit(UART_HandleTypeDef *huart)
+{
+    (void)huart;
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    (void)huart;
+    (void)pData;
+    (void)Size;
+
+    return HAL_OK;
+}
+
+static void TEST_TELEMETRY_OnReceive(const uint8_t schema, const uint8_t *payload, const uint32_t length)
+{
+    (void)schema;
+
+    memcpy(test_telemetry_received, payload, length);
+    test_telemetry_received_length = length;
+    test_telemetry_received_count++;
+}
+
+/// @brief Bytes from the host in RX events of at most a chunk, then the main loop
+static void TEST_TELEMETRY_Receive(EVERT_TELEMETRY_HandlerTypeDef *telemetry, const uint8_t *bytes, const uint32_t length)
+{
+    for (uint32_t i = 0; i < length; i += EVERT_TELEMETRY_RX_CHUNK_SIZE)
+    {
+        uint32_t size = (length - i < EVERT_TELEMETRY_RX_CHUNK_SIZE) ? length - i : EVERT_TELEMETRY_RX_CHUNK_SIZE;
+
+        memcpy(telemetry->rx_chunk, &bytes[i], size);
+        EVERT_TELEMETRY_OnRxEvent(telemetry, telemetry->huart, (uint16_t)size);
+        EVERT_TELEMETRY_Process(telemetry);
+    }
+}
+
+/// @brief Encoded and decoded back, with zeros and runs longer than a block
+static void TEST_TELEMETRY_CobsRoundTrip(void)
+{
+    static uint8_t source[TEST_TELEMETRY_COBS_LENGTH];
+    static uint8_t encoded[TEST_TELEMETRY_COBS_LENGTH + TEST_TELEMETRY_COBS_LENGTH / 254 + 1];
+    static uint8_t decoded[TEST_TELEMETRY_COBS_LENGTH + 1];
+    const size_t lengths[] = {0, 1, 2, 253, 254, 255, 508, TEST_TELEMETRY_COBS_LENGTH};
+    uint32_t failed = 0;
+
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+    {
+        for (uint32_t pattern = 0; pattern < 3; pattern++)
+        {
+            // No zeros, every 7th byte zero, all zeros
+            for (size_t j = 0; j < lengths[i]; j++)
+            {
+                source[j] = (pattern == 0) ? (uint8_t)(j % 255 + 1) : (pattern == 1 && j % 7 != 0) ? (uint8_t)j : 0;
+            }
+
+            size_t encoded_length = EVERT_TELEMETRY_CobsEncode(source, lengths[i], encoded);
+            size_t decoded_length = EVERT_TELEMETRY_CobsDecode(encoded, encoded_length, decoded);
+
+            failed += (memchr(encoded, 0, encoded_length) != NULL) || (encoded_length > lengths[i] + lengths[i] / 254 + 1);
+            failed += (lengths[i] > 0) && (decoded_length != lengths[i] || memcmp(source, decoded, lengths[i]) != 0);
+        }
+    }
+
+    EVERT_HARNESS_TEST_Check(failed == 0, "COBS round trip: %zu lengths up to %u bytes, 3 patterns, %u failed", sizeof(lengths) / sizeof(lengths[0]),
+                             TEST_TELEMETRY_COBS_LENGTH, failed);
+}
+
+/// @brief Every cut of an encoded frame: rejected, or decoded from the bytes it has only
+static void TEST_TELEMETRY_CobsTruncated(void)
+{
+    static uint8_t source[TEST_TELEMETRY_COBS_LENGTH];
+    static uint8_t encoded[TEST_TELEMETRY_COBS_LENGTH + TEST_TELEMETRY_COBS_LENGTH / 254 + 1];
+    static uint8_t decoded[TEST_TELEMETRY_COBS_LENGTH + 1];
+    uint32_t past_end = 0;
+
+    for (size_t j = 0; j < sizeof(source); j++)
+    {
+        source[j] = (j % 100 == 99) ? 0 : (uint8_t)(j % 251 + 1);
+    }
+
+    size_t encoded_length = EVERT_TELEMETRY_CobsEncode(source, sizeof(source), encoded);
+
+    // The rest of the frame stays in the buffer behind the cut, a decoder reading past it takes it in
+    for (size_t cut = 1; cut < encoded_length; cut++)
+    {
+        size_t decoded_length = EVERT_TELEMETRY_CobsDecode(encoded, cut, decoded);
+        past_end += (decoded_length >= cut);
+    }
+
+    // Last block cut short by its final byte: [03 'a' 'b'] received as [03 'a']
+    const uint8_t frame[] = {0x03, 'a', 'b'};
+    size_t short_length = EVERT_TELEMETRY_CobsDecode(frame, 2, decoded);
+
+    EVERT_HARNESS_TEST_Check(past_end == 0, "COBS truncated: %zu cuts of a %zu byte frame, %u decoded past their end", encoded_length - 1, encoded_length, past_end);
+    EVERT_HARNESS_TEST_Check(short_length == 0, "COBS truncated: last block one byte short rejected (%zu bytes decoded)", short_length);
+}
+
+/// @brief Records sent go out on the wire and come back through the receive path
+static void TEST_TELEMETRY_Records(void)
+{
+    static EVERT_TELEMETRY_HandlerTypeDef telemetry;
+    UART_HandleTypeDef huart = {.gState = HAL_UART_STATE_READY, .RxState = HAL_UART_STATE_READY};
+    uint8_t payload[EVERT_TELEMETRY_PAYLOAD_MAX];
+    uint32_t failed = 0;
+
+    EVERT_TELEMETRY_Init(&telemetry, &huart);
+    EVERT_TELEMETRY_StartReceive(&telemetry, TEST_TELEMETRY_OnReceive);
+
+    for (uint32_t length = 0; length <= EVERT_TELEMETRY_PAYLOAD_MAX; length++)
+    {
+        for (uint32_t i = 0; i < length; i++)
+        {
+            payload[i] = (uint8_t)(i * 37 + length);
+        }
+
+        test_telemetry_wire_length = 0;
+        uint32_t count = test_telemetry_received_count;
+
+        EVERT_TELEMETRY_Send(&telemetry, 1, payload, length);
+        EVERT_TELEMETRY_Process(&telemetry);
+        EVERT_TELEMETRY_OnTxComplete(&telemetry, &huart);
+        TEST_TELEMETRY_Receive(&telemetry, test_telemetry_wire, test_telemetry_wire_length);
+
+        failed += (test_telemetry_received_count != count + 1) || (test_telemetry_received_length != length) || (memcmp(test_telemetry_received, payload, length) != 0);
+    }
+
+    EVERT_HARNESS_TEST_Check(failed == 0 && telemetry.rx_error_count == 0, "records: payloads of 0 to %u bytes sent and received back, %u failed, %" PRIu32 " receive errors",
+                             EVERT_TELEMETRY_PAYLOAD_MAX, failed, telemetry.rx_error_count);
+
+    // A frame cut short on the wire, the delimiter still seen: counted, not handed over, the next frame gets through
+    test_telemetry_wire_length = 0;
+    EVERT_TELEMETRY_SendBlocking(&telemetry, 1, payload, 16, 10);
+    uint32_t frame_length = test_telemetry_wire_length;
+    uint32_t count = test_telemetry_received_count;
+
+    uint8_t truncated[EVERT_TELEMETRY_FRAME_MAX];
+    memcpy(truncated, test_telemetry_wire, frame_length - 2);
+    truncated[frame_length - 2] = 0x00;
+
+    TEST_TELEMETRY_Receive(&telemetry, truncated, frame_length - 1);
+    bool rejected = (test_telemetry_received_count == count) && (telemetry.rx_error_count == 1);
+
+    TEST_TELEMETRY_Receive(&telemetry, test_telemetry_wire, frame_length);
+
+    EVERT_HARNESS_TEST_Check(rejected, "records: frame one byte short rejected, %" PRIu32 " receive error(s)", telemetry.rx_error_count);
+    EVERT_HARNESS_TEST_Check(test_telemetry_received_count == count + 1 && test_telemetry_received_length == 16, "records: next frame received after the truncated one");
+}
+
+int main(void)
+{
+    printf("Telemetry, %u byte payloads, %u byte buffers\n", EVERT_TELEMETRY_PAYLOAD_MAX, EVERT_TELEMETRY_BUFFER_SIZE);
+
+    TEST_TELEMETRY_CobsRoundTrip();
+    TEST_TELEMETRY_CobsTruncated();
+    TEST_TELEMETRY_Records();
+
+    return EVERT_HARNESS_TEST_Result();
+}
@@ -61,7 +61,10 @@ extern DMA_HandleTypeDef hdma_adc2;
 extern DMA_HandleTypeDef hdma_adc3;
 extern FDCAN_HandleTypeDef hfdcan1;
 extern HRTIM_HandleTypeDef hhrtim1;
+extern DMA_HandleTypeDef hdma_i2c1_rx;
+extern DMA_HandleTypeDef hdma_i2c1_tx;
 extern I2C_HandleTypeDef hi2c1;
+extern DMA_HandleTypeDef hdma_lpuart1_tx;
 extern UART_HandleTypeDef hlpuart1;
 extern DMA_HandleTypeDef hdma_tim2_ch1;
 extern TIM_HandleTypeDef htim2;
@@ -95,6 +98,7 @@ void NMI_Handler(void)
 void HardFault_Handler(void)
 {
   /* USER CODE BEGIN HardFault_IRQn 0 */
+  EVERT_FAULT_RECORD_CAPTURE_FAULT(FRT_HARD_FAULT);
   EVERT_INVERTER_hal_error("HardFault_Handler");
   /* USER CODE END HardFault_IRQn 0 */
   while (1)
@@ -110,7 +114,8 @@ void HardFault_Handler(void)
 void MemManage_Handler(void)
 {
   /* USER CODE BEGIN MemoryManagement_IRQn 0 */
-
+  EVERT_FAULT_RECORD_CAPTURE_FAULT(FRT_MEM_MANAGE);
+  EVERT_INVERTER_hal_error("MemManage_Handler");
   /* USER CODE END MemoryManagement_IRQn 0 */
   while (1)
   {
@@ -125,6 +130,7 @@ void MemManage_Handler(void)
 void BusFault_Handler(void)
 {
   /* USER CODE BEGIN BusFault_IRQn 0 */
+  EVERT_FAULT_RECORD_CAPTURE_FAULT(FRT_BUS_FAULT);
   EVERT_INVERTER_hal_error("BusFault_Handler");
   /* USER CODE END BusFault_IRQn 0 */
   while (1)
@@ -140,6 +146,7 @@ void BusFault_Handler(void)
 void UsageFault_Handler(void)
 {
   /* USER CODE BEGIN UsageFault_IRQn 0 */
+  EVERT_FAULT_RECORD_CAPTURE_FAULT(FRT_USAGE_FAULT);
   EVERT_INVERTER_hal_error("UsageFault_Handler");
   /* USER CODE END UsageFault_IRQn 0 */
   while (1)
@@ -209,6 +216,34 @@ void SysTick_Handler(void)
 /* please refer to the startup file (startup_stm32g4xx.s).                    */
 /******************************************************************************/
 
+/**
+  * @brief This function handles DMA1 channel1 global interrupt.
+  */
+void DMA1_Channel1_IRQHandler(void)
+{
+  /* USER CODE BEGIN DMA1_Channel1_IRQn 0 */
+
+  /* USER CODE END DMA1_Channel1_IRQn 0 */
+  HAL_DMA_IRQHandler(&hdma_i2c1_rx);
+  /* USER CODE BEGIN DMA1_Channel1_IRQn 1 */
+
+  /* USER CODE END DMA1_Channel1_IRQn 1 */
+}
+
+/**
+  * @brief This function handles DMA1 channel2 global interrupt.
+  */
+void DMA1_Channel2_IRQHandler(void)
+{
+  /* USER CODE BEGIN DMA1_Channel2_IRQn 0 */
+
+  /* USER CODE END DMA1_Channel2_IRQn 0 */
+  HAL_DMA_IRQHandler(&hdma_i2c1_tx);
+  /* USER CODE BEGIN DMA1_Channel2_IRQn 1 */
+
+  /* USER CODE END DMA1_Channel2_IRQn 1 */
+}
+
 /**
   * @brief This function handles DMA1 channel5 global interrupt.
   */
@@ -223,6 +258,20 @@ void DMA1_Channel5_IRQHandler(void)
   /* USER CODE END DMA1_Channel5_IRQn 1 */
 }
 
+/**
+  * @brief This function handles DMA1 channel6 global interrupt.
+  */
+void DMA1_Channel6_IRQHandler(void)
+{
+  /* USER CODE BEGIN DMA1_Channel6_IRQn 0 */
+
+  /* USER CODE END DMA1_Channel6_IRQn 0 */
+  HAL_DMA_IRQHandler(&hdma_lpuart1_tx);
+  /* USER CODE BEGIN DMA1_Channel6_IRQn 1 */
+
+  /* USER CODE END DMA1_Channel6_IRQn 1 */
+}
+
 /**
   * @brief This function handles FDCAN1 interrupt 0.
   */
@@ -379,4 +428,12 @@ void LPUART1_IRQHandler(void)
 
 /* USER CODE BEGIN 1 */
 
+/**
+  * @brief This function handles the window watchdog early wakeup interrupt (one count before the reset).
+  */
+void WWDG_IRQHandler(void)
+{
+  EVERT_WATCHDOG_OnEarlyWakeup();
+}
+
 /* USER CODE END 1 */
@@ -16,4 +16,49 @@
 #define EVERT_HAL_CONF_FZ2812_ENABLE (true)
 #define EVERT_HAL_CONF_FZ2812_COUNT (2)
 
+// Scope (waveform capture)
+#define EVERT_HAL_CONF_SCOPE_ENABLE (true)
+#define EVERT_HAL_CONF_SCOPE_CHANNEL_COUNT (10)
+
+// Telemetry (binary records over UART TX DMA, two buffers of BUFFER_SIZE bytes)
+#define EVERT_HAL_CONF_TELEMETRY_ENABLE (true)
+#define EVERT_HAL_CONF_TELEMETRY_BUFFER_SIZE (1024)
+#define EVERT_HAL_CONF_TELEMETRY_PAYLOAD_MAX (64)
+
+// Delta telemetry (signals quantized and delta encoded over CAN)
+#define EVERT_HAL_CONF_DELTA_TELEMETRY_ENABLE (false) // No CAN link yet, the UART telemetry carries the signals
+#define EVERT_HAL_CONF_DELTA_TELEMETRY_SIGNAL_COUNT (0)
+
+// Variable registry (remote read/write/subscribe, .evert_registry section in the linker script)
+#define EVERT_HAL_CONF_REGISTRY_ENABLE (true)
+#define EVERT_HAL_CONF_REGISTRY_SUBSCRIPTION_COUNT (16)
+
+// Fault record (.noinit RAM, fault log in the 4 kB below the parameter store, see FAULTS in the linker script)
+#define EVERT_HAL_CONF_FAULT_RECORD_ENABLE (true)
+#define EVERT_HAL_CONF_FAULT_RECORD_ADDRESS (0x0807D000)
+#define EVERT_HAL_CONF_FAULT_RECORD_REGION_SIZE (0x1000)
+#define EVERT_HAL_CONF_FAULT_RECORD_EVENT_COUNT (16)
+#define EVERT_HAL_CONF_FAULT_RECORD_RESET (true) // Reset after a capture unless a debugger is attached
+
+// Watchdog supervisor (IWDG on the task checkpoints, WWDG on the HF ISR timing window)
+#define EVERT_HAL_CONF_WATCHDOG_ENABLE (true)
+#define EVERT_HAL_CONF_WATCHDOG_CHECKPOINT_COUNT (8)
+#define EVERT_HAL_CONF_WATCHDOG_IWDG_TIMEOUT_MS (100)
+#define EVERT_HAL_CONF_WATCHDOG_WWDG_ENABLE (true)
+#define EVERT_HAL_CONF_WATCHDOG_WWDG_DIVIDER (25) // HF ISR calls per refresh, 1 ms at 25 kHz
+#define EVERT_HAL_CONF_WATCHDOG_WWDG_PRESCALER (LL_WWDG_PRESCALER_4) // 4096 * 4 / 170 MHz = 96 us per count, reset after 6.2 ms
+#define EVERT_HAL_CONF_WATCHDOG_WWDG_WINDOW (0x7A) // No refresh within 5 counts (0.48 ms) of the last
+
+// Time synchronization (SYNC/FOLLOW-UP from the CCU over CAN)
+#define EVERT_HAL_CONF_TIME_SYNC_ENABLE (false) // No CAN link yet, nothing to synchronize to
+
+// Parameter store (last 8 kB of flash, bank 2 in dual bank mode, see PARAMS in the linker script)
+#define EVERT_HAL_CONF_PARAM_STORE_ENABLE (true)
+#define EVERT_HAL_CONF_PARAM_STORE_ADDRESS (0x0807E000)
+#define EVERT_HAL_CONF_PARAM_STORE_REGION_SIZE (0x1000)
+#define EVERT_HAL_CONF_PARAM_STORE_KEY_COUNT (64)
+
+// Firmware update (A/B bank slots behind the bootloader, firmware_image.h)
+#define EVERT_HAL_CONF_FIRMWARE_UPDATE_ENABLE (false) // No CAN link yet, the image links at the flash start
+
 #endif // EVERT_HAL_CONF_
\ No newline at end of file
@@ -5,6 +5,12 @@
 
 #define EVERT_CONSTANT_INVERTER_PWM_PERIOD (27200) // - 1 - 96 // Period - 1 - min
 
+// ISR timing
+#define EVERT_CONSTANT_INVERTER_ISR_HF_FREQUENCY (25000.0f) // htim6
+#define EVERT_CONSTANT_INVERTER_ISR_HF_PERIOD (1.0f / EVERT_CONSTANT_INVERTER_ISR_HF_FREQUENCY)
+#define EVERT_CONSTANT_INVERTER_ISR_LF_FREQUENCY (100.0f) // htim3
+#define EVERT_CONSTANT_INVERTER_ISR_LF_PERIOD (1.0f / EVERT_CONSTANT_INVERTER_ISR_LF_FREQUENCY)
+
 // ADC 1
 #define EVERT_CONSTANT_INVERTER_ADC1_CONVERSION_COUNT 9
 #define EVERT_CONSTANT_INVERTER_ADC1_RANK_MCU_TEMPERATURE 0 //
@@ -115,8 +121,86 @@
 
 // Grid Forming
 #define EVERT_CONSTANT_INVERTER_L_INDUCTOR_VALUE ((float32_t)(0.000340f))
+
+// DC Bus Voltage Loop (outer loop, generates the d-axis current reference)
+#define EVERT_SETTING_INVERTER_BUS_LOOP_DECIMATION (10) // 25 kHz / 10 = 2.5 kHz
+#define EVERT_SETTING_INVERTER_BUS_LOOP_PERIOD ((float32_t)(EVERT_CONSTANT_INVERTER_ISR_HF_PERIOD * EVERT_SETTING_INVERTER_BUS_LOOP_DECIMATION))
+#define EVERT_SETTING_INVERTER_BUS_LOOP_KP ((float32_t)(0.05f))   // A/V
+#define EVERT_SETTING_INVERTER_BUS_LOOP_KI ((float32_t)(2.0f))    // A/(V*s)
+#define EVERT_SETTING_INVERTER_BUS_LOOP_NOTCH_Q ((float32_t)(1.0f)) // 2x grid frequency ripple rejection
+#define EVERT_SETTING_INVERTER_BUS_LOOP_GRID_VD_MIN ((float32_t)(100.0f)) // Below this the feed-forward falls back to nominal grid voltage
+
+// Bus Midpoint Balancing (zero-sequence duty injection)
+#define EVERT_SETTING_INVERTER_MIDPOINT_KP ((float32_t)(0.002f))          // 1/V
+#define EVERT_SETTING_INVERTER_MIDPOINT_KI ((float32_t)(0.5f))            // 1/(V*s)
+#define EVERT_SETTING_INVERTER_MIDPOINT_DUTY_MAX ((float32_t)(0.1f))      // Zero-sequence offset limit (pu)
+#define EVERT_SETTING_INVERTER_MIDPOINT_CURRENT_MIN ((float32_t)(0.5f))   // Below this the current direction is unknown, hold the offset
+
+// Thermal Management (fans and current derating, run from the LF ISR)
+#define EVERT_SETTING_INVERTER_THERMAL_DECIMATION (10) // 100 Hz / 10 = 10 Hz
+#define EVERT_SETTING_INVERTER_THERMAL_PERIOD ((float32_t)(EVERT_CONSTANT_INVERTER_ISR_LF_PERIOD * EVERT_SETTING_INVERTER_THERMAL_DECIMATION))
+#define EVERT_SETTING_INVERTER_THERMAL_TEMPERATURE_EMA ((float32_t)(0.8f))         // Weight of the previous value, ~0.5 s at 10 Hz
+#define EVERT_SETTING_INVERTER_THERMAL_RATE_EMA ((float32_t)(0.95f))               // Weight of the previous value, ~2 s at 10 Hz
+#define EVERT_SETTING_INVERTER_THERMAL_FAN_HEATSINK_START ((float32_t)(40.0f))    // Fan curve, minimum demand below
+#define EVERT_SETTING_INVERTER_THERMAL_FAN_HEATSINK_FULL ((float32_t)(75.0f))     // Fan curve, full demand above
+#define EVERT_SETTING_INVERTER_THERMAL_FAN_COIL_START ((float32_t)(50.0f))
+#define EVERT_SETTING_INVERTER_THERMAL_FAN_COIL_FULL ((float32_t)(85.0f))
+#define EVERT_SETTING_INVERTER_THERMAL_FAN_DEMAND_MIN ((float32_t)(0.2f))         // Idle airflow
+#define EVERT_SETTING_INVERTER_THERMAL_FAN_TARGET ((float32_t)(65.0f))            // Heatsink temperature the PI holds on top of the curve
+#define EVERT_SETTING_INVERTER_THERMAL_FAN_KP ((float32_t)(0.05f))                // 1/K
+#define EVERT_SETTING_INVERTER_THERMAL_FAN_KI ((float32_t)(0.005f))               // 1/(K*s)
+#define EVERT_SETTING_INVERTER_THERMAL_FAN_RPM_MAX ((float32_t)(6000.0f))         // RPM at full demand
+#define EVERT_SETTING_INVERTER_THERMAL_FAN_RPM_KP ((float32_t)(0.01f))            // Setting per RPM
+#define EVERT_SETTING_INVERTER_THERMAL_FAN_RPM_KI ((float32_t)(0.02f))            // Setting per RPM*s
+#define EVERT_SETTING_INVERTER_THERMAL_FAN_FAIL_SETTING_MIN ((float32_t)(80.0f))  // Fan setting (0-255) above which it must spin
+#define EVERT_SETTING_INVERTER_THERMAL_FAN_FAIL_RPM_MIN ((float32_t)(500.0f))
+#define EVERT_SETTING_INVERTER_THERMAL_FAN_FAIL_TIME ((float32_t)(3.0f))          // s
+#define EVERT_SETTING_INVERTER_THERMAL_DERATE_HORIZON ((float32_t)(30.0f))        // s, temperature is extrapolated this far ahead
+#define EVERT_SETTING_INVERTER_THERMAL_DERATE_MARGIN ((float32_t)(15.0f))         // K below the warning the derating starts
+#define EVERT_SETTING_INVERTER_THERMAL_DERATE_FAN_FAIL_OFFSET ((float32_t)(10.0f)) // K earlier derating with a failed fan
+#define EVERT_SETTING_INVERTER_THERMAL_DERATE_MIN ((float32_t)(0.3f))             // Lowest current fraction before the alarms take over
+#define EVERT_SETTING_INVERTER_THERMAL_DERATE_RECOVERY_RATE ((float32_t)(0.02f))  // Current fraction per second
+
+// Junction Temperature Estimator (loss model + Foster network per device, run from the HF ISR)
+#define EVERT_CONSTANT_INVERTER_PWM_FREQUENCY ((float32_t)(100000.0f))             // HRTIM x32, up-down, period 27200
+#define EVERT_CONSTANT_INVERTER_JUNCTION_SWITCH_V0 ((float32_t)(0.8f))              // V, on-state threshold
+#define EVERT_CONSTANT_INVERTER_JUNCTION_SWITCH_R ((float32_t)(0.025f))             // Ohm, on-state slope
+#define EVERT_CONSTANT_INVERTER_JUNCTION_SWITCH_E_REF ((float32_t)(120.0e-6f))      // J, Eon + Eoff at the reference point
+#define EVERT_CONSTANT_INVERTER_JUNCTION_DIODE_V0 ((float32_t)(0.9f))               // V
+#define EVERT_CONSTANT_INVERTER_JUNCTION_DIODE_R ((float32_t)(0.02f))               // Ohm
+#define EVERT_CONSTANT_INVERTER_JUNCTION_DIODE_E_REF ((float32_t)(30.0e-6f))        // J, Err at the reference point
+#define EVERT_CONSTANT_INVERTER_JUNCTION_E_REF_VOLTAGE ((float32_t)(400.0f))        // V, switched voltage of the datasheet point
+#define EVERT_CONSTANT_INVERTER_JUNCTION_E_REF_CURRENT ((float32_t)(10.0f))         // A, switched current of the datasheet point
+#define EVERT_CONSTANT_INVERTER_JUNCTION_FOSTER_ORDER (4)
+#define EVERT_CONSTANT_INVERTER_JUNCTION_FOSTER_R {0.08f, 0.22f, 0.35f, 0.15f}      // K/W, junction to heatsink
+#define EVERT_CONSTANT_INVERTER_JUNCTION_FOSTER_TAU {0.0004f, 0.004f, 0.04f, 0.4f} // s
+#define EVERT_SETTING_INVERTER_JUNCTION_DECIMATION (25) // 25 kHz / 25 = 1 kHz
+#define EVERT_SETTING_INVERTER_JUNCTION_PERIOD ((float32_t)(EVERT_CONSTANT_INVERTER_ISR_HF_PERIOD * EVERT_SETTING_INVERTER_JUNCTION_DECIMATION))
+#define EVERT_SETTING_INVERTER_JUNCTION_HORIZON ((float32_t)(0.5f))           // s, junction temperature is predicted this far ahead at the present losses
+#define EVERT_SETTING_INVERTER_JUNCTION_DERATE_START ((float32_t)(125.0f))    // °C
+#define EVERT_SETTING_INVERTER_JUNCTION_MAX ((float32_t)(150.0f))             // °C
+#define EVERT_SETTING_INVERTER_JUNCTION_OVERLOAD ((float32_t)(1.05f))         // Current fraction allowed with a cold junction, below the overcurrent critical constraint
+#define EVERT_SETTING_INVERTER_JUNCTION_DERATE_MIN ((float32_t)(0.3f))        // Current fraction at EVERT_SETTING_INVERTER_JUNCTION_MAX
+
+// Waveform capture (scope.h, recorded from the HF ISR, dumped over the telemetry link)
+#define EVERT_SETTING_INVERTER_SCOPE_DEPTH (320)       // Samples, 12.8 kB
+#define EVERT_SETTING_INVERTER_SCOPE_DECIMATION (2)    // 25 kHz / 2 = 12.5 kHz, 25.6 ms window (> 1 grid period)
+#define EVERT_SETTING_INVERTER_SCOPE_PRE_TRIGGER (240) // Samples kept before the trigger
+#define EVERT_SETTING_INVERTER_SCOPE_UART_TIMEOUT_MS (100)
+
+// Telemetry (telemetry.h over LPUART1, 921600 baud = 92 kB/s)
+#define EVERT_SETTING_INVERTER_TELEMETRY_FAST_DECIMATION (25) // 25 kHz / 25 = 1 kHz, 64 B frames = 64 kB/s
+#define EVERT_SETTING_INVERTER_TELEMETRY_QUEUE_SIZE (16)      // Fast records between the HF ISR and the main loop
+#define EVERT_SETTING_INVERTER_TELEMETRY_SLOW_PERIOD_MS (100)
+
+// Watchdog supervisor (watchdog.h, IWDG timeout and WWDG window in _conf_evert_hal.h)
+#define EVERT_SETTING_INVERTER_WATCHDOG_LOOP_DEADLINE_MS (20)
+#define EVERT_SETTING_INVERTER_WATCHDOG_ISR_HF_DEADLINE_MS (5) // 25 kHz, the WWDG holds the exact window
+#define EVERT_SETTING_INVERTER_WATCHDOG_ISR_LF_DEADLINE_MS (50) // 100 Hz
+
 #define EVERT_SETTING_INVERTER_CURRENT_RMS_MAX ((float32_t)(10.0f))
 #define EVERT_SETTING_INVERTER_CURRENT_INSTANTANEOUS_MAX ((float32_t)(EVERT_SETTING_INVERTER_CURRENT_RMS_MAX * M_SQRT2))
+#define EVERT_SETTING_INVERTER_CURRENT_OVERLOAD_MAX ((float32_t)(EVERT_SETTING_INVERTER_CURRENT_INSTANTANEOUS_MAX * EVERT_SETTING_INVERTER_JUNCTION_OVERLOAD))
 #define EVERT_SETTING_INVERTER_VOLTAGE_BUS_NOMINAL ((float32_t)(800.0f))
 #define EVERT_SETTING_INVERTER_VOLTAGE_BUS_MID_NOMINAL ((float32_t)(EVERT_SETTING_INVERTER_VOLTAGE_BUS_NOMINAL / 2.0f))
 #define EVERT_SETTING_INVERTER_VOLTAGE_BUS_MAX ((float32_t)(950.0f))
@@ -128,6 +212,7 @@
 #define EVERT_SETTING_INVERTER_VOLTAGE_RMS_MIN ((float32_t)(EVERT_SETTING_INVERTER_VOLTAGE_RMS_NOMINAL - (EVERT_SETTING_INVERTER_VOLTAGE_RMS_NOMINAL * 1.1f)))
 #define EVERT_SETTING_INVERTER_VOLTAGE_INSTANTANEOUS_MAX ((float32_t)(EVERT_SETTING_INVERTER_VOLTAGE_RMS_MAX * M_SQRT2))
 #define EVERT_SETTING_INVERTER_VOLTAGE_INSTANTANEOUS_MIN ((float32_t)(-EVERT_SETTING_INVERTER_VOLTAGE_INSTANTANEOUS_MAX))
+#define EVERT_SETTING_INVERTER_CURRENT_LOOP_OUTPUT_MAX ((float32_t)(EVERT_SETTING_INVERTER_VOLTAGE_BUS_MAX * 0.5f)) // Current PI output, volts before bus normalization
 #define EVERT_SETTING_INVERTER_PLL_DECOUPLING_FACTOR ((float32_t)(2.0f * M_PI * EVERT_CONSTANT_INVERTER_L_INDUCTOR_VALUE * EVERT_SETTING_INVERTER_CURRENT_INSTANTANEOUS_MAX / EVERT_SETTING_INVERTER_VOLTAGE_BUS_MAX))
 
 #endif // EVERT_INVERTER_CONF_
\ No newline at end of file
@@ -27,6 +27,7 @@ extern DMA_HandleTypeDef hdma_adc1;
 extern DMA_HandleTypeDef hdma_adc2;
 extern DMA_HandleTypeDef hdma_adc3;
 extern HRTIM_HandleTypeDef hhrtim1;
+extern I2C_HandleTypeDef hi2c1;
 extern TIM_HandleTypeDef htim2;
 extern TIM_HandleTypeDef htim3;
 extern TIM_HandleTypeDef htim6;
@@ -43,6 +44,13 @@ EVERT_HAL_GpioDefinitionTypeDef EVERT_INVERTER_GPIO_DEF_PWM_FAULT = {GPIOA, GPIO
 EVERT_HAL_GpioDefinitionTypeDef EVERT_INVERTER_GPIO_DEF_PWM_FAN_FAULT = {GPIOE, GPIO_PIN_0};
 EVERT_HAL_GpioDefinitionTypeDef EVERT_INVERTER_GPIO_DEF_PWM_FDCAN_FAULT = {GPIOE, GPIO_PIN_1};
 
+// I2C Transaction Queue (shared by the I2C peripherals on hi2c1)
+#define EVERT_CONSTRAINT_I2C_QUEUE_SIZE 16
+#define EVERT_CONSTRAINT_I2C_QUEUE_TIMEOUT_MS 10
+#define EVERT_CONSTRAINT_I2C_QUEUE_ATTEMPTS 3
+EVERT_I2C_QUEUE_HandlerTypeDef i2c_queue;
+EVERT_I2C_QUEUE_TransactionTypeDef i2c_queue_items[EVERT_CONSTRAINT_I2C_QUEUE_SIZE];
+
 static volatile bool adc_completed[3] = {false, false, false};
 
 //
@@ -64,11 +72,15 @@ static volatile bool adc_completed[3] = {false, false, false};
 
 int EVERT_INVERTER_main()
 {
+    // Move a fault record left by the last reset to flash before anything can fault again
+    EVERT_FAULT_RECORD_Init();
+
     HAL_DMA_RegisterCallback(&hdma_adc1, HAL_DMA_XFER_ERROR_CB_ID, HAL_DMA_ErrorCallback);
     HAL_DMA_RegisterCallback(&hdma_adc2, HAL_DMA_XFER_ERROR_CB_ID, HAL_DMA_ErrorCallback);
     HAL_DMA_RegisterCallback(&hdma_adc3, HAL_DMA_XFER_ERROR_CB_ID, HAL_DMA_ErrorCallback);
 
     EVERT_INVERTER_InitCalibrations();
+    EVERT_INVERTER_ParametersInit();
     EVERT_INVERTER_InitConstraints();
     EVERT_DEVICE_SetVersionInfo(DEVICE_VERSION_MAJOR, DEVICE_VERSION_MINOR, DEVICE_VERSION_PATCH);
 
@@ -91,10 +103,11 @@ int EVERT_INVERTER_main()
     // Initialize the device
     EVERT_DEVICE_Init();
 
-    // Start the ADCs
-    EVERT_HAL_ADC_Start(&hadc1, (uint16_t *)adc1_buffer, EVERT_CONSTANT_INVERTER_ADC1_CONVERSION_COUNT);
-    EVERT_HAL_ADC_Start(&hadc2, (uint16_t *)adc2_buffer, EVERT_CONSTANT_INVERTER_ADC2_CONVERSION_COUNT);
-    EVERT_HAL_ADC_Start(&hadc3, (uint16_t *)adc3_buffer, EVERT_CONSTANT_INVERTER_ADC3_CONVERSION_COUNT);
+    // Start the ADCs, calibrated together
+    ADC_HandleTypeDef *const adcs[] = {&hadc1, &hadc2, &hadc3};
+    uint16_t *const adc_buffers[] = {(uint16_t *)adc1_buffer, (uint16_t *)adc2_buffer, (uint16_t *)adc3_buffer};
+    const uint32_t adc_conversion_counts[] = {EVERT_CONSTANT_INVERTER_ADC1_CONVERSION_COUNT, EVERT_CONSTANT_INVERTER_ADC2_CONVERSION_COUNT, EVERT_CONSTANT_INVERTER_ADC3_CONVERSION_COUNT};
+    EVERT_HAL_ADC_StartAll(adcs, adc_buffers, adc_conversion_counts, sizeof(adcs) / sizeof(adcs[0]));
 
     // Start the timers
     HAL_TIM_Base_Start_IT(&htim3); // 100 Hz (LF ISR)
@@ -111,10 +124,11 @@ int EVERT_INVERTER_main()
     // EVERT_INVERTER_SetDutyCycle(0.5f, 0.25f, -0.25f);
 
     // Setup fans
-    // EVERT_EMC230X_Init();
-    // EVERT_EMC230X_SetAllFanSpeeds_IT(0);
-    // HAL_Delay(10);
-    // EVERT_EMC230X_ReadTachs_IT();
+    EVERT_I2C_QUEUE_Init(&i2c_queue, &hi2c1, i2c_queue_items, EVERT_CONSTRAINT_I2C_QUEUE_SIZE, EVERT_CONSTRAINT_I2C_QUEUE_TIMEOUT_MS, EVERT_CONSTRAINT_I2C_QUEUE_ATTEMPTS);
+    EVERT_I2C_QUEUE_SetBusClear(&i2c_queue, GPIOA, GPIO_PIN_15, GPIOB, GPIO_PIN_7); // I2C1_SCL, I2C1_SDA
+    EVERT_EMC230X_Init(&i2c_queue);
+    EVERT_EMC230X_SetAllFanSpeeds_IT(0);
+    EVERT_INVERTER_ThermalInit();
 
     // LEDS RGB
     EVERT_FZ2812_Init(&htim2);
@@ -125,7 +139,21 @@ int EVERT_INVERTER_main()
     static const float32_t ki = 11447;
     static const float32_t coeff_b0 = 150.0155528;
     static const float32_t coeff_b1 = -149.5576746;
-    // EVERT_INVERTER_GridFormingInit(kp, ki, coeff_b0, coeff_b1);
+    EVERT_INVERTER_GridFormingInit(kp, ki, coeff_b0, coeff_b1);
+    EVERT_INVERTER_JunctionInit();
+
+    // Telemetry and waveform capture, armed from boot
+    EVERT_INVERTER_TelemetryInit();
+    EVERT_INVERTER_ScopeInit();
+    EVERT_INVERTER_RegistryInit();
+    EVERT_INVERTER_FaultInit();
+
+    // Supervisor last, the deadlines run from here
+    EVERT_WATCHDOG_Init();
+    EVERT_WATCHDOG_Register(IWC_LOOP, "Loop", EVERT_SETTING_INVERTER_WATCHDOG_LOOP_DEADLINE_MS);
+    EVERT_WATCHDOG_Register(IWC_ISR_HF, "HF ISR", EVERT_SETTING_INVERTER_WATCHDOG_ISR_HF_DEADLINE_MS);
+    EVERT_WATCHDOG_Register(IWC_ISR_LF, "LF ISR", EVERT_SETTING_INVERTER_WATCHDOG_ISR_LF_DEADLINE_MS);
+    EVERT_WATCHDOG_Start();
 
     return 0;
 }
@@ -136,8 +164,15 @@ void EVERT_INVERTER_loop()
     time.elapsed_time = time.current_time - time.start_time;
     time.delta_time = time.current_time - time.last_time;
 
+    EVERT_WATCHDOG_Checkin(IWC_LOOP);
+    EVERT_WATCHDOG_Process();
+
     EVERT_DEVICE_Update(time.elapsed_time, time.delta_time);
     EVERT_FZ2812_Update();
+    EVERT_I2C_QUEUE_Process(&i2c_queue);
+    EVERT_INVERTER_RegistryProcess(time.delta_time);
+    EVERT_INVERTER_TelemetryProcess();
+    EVERT_PARAM_STORE_Process();
 
     time.last_time = time.current_time;
 }
@@ -569,9 +604,14 @@ void __overrides EVERT_DEVICE_Derived_OnDeviceStateChange(const EVERT_DEVICE_Sta
     }
 }
 
+bool __overrides EVERT_DEVICE_Derived_IsAdcSettled()
+{
+    return EVERT_INVERTER_ReadingsSettled();
+}
+
 void __overrides EVERT_DEVICE_Derived_OnEnterState_BootingComms()
 {
-    EVERT_DEVICE_State_Set(SS_INTERNAL, DS_BOOTING_DONE);
+    EVERT_DEVICE_PostEvent(DE_BOOT_COMMS_DONE);
 }
 
 // __weak Callbacks - Task Scheduler
@@ -611,6 +651,11 @@ void EVERT_INVERTER_ISR_25KHZ_IRQHandler()
 
     EVERT_INVERTER_ISR_HF_Readings();
 
+    // Junction temperature estimate and current limit (decimated internally)
+    EVERT_INVERTER_JunctionRun();
+
+    // The DC bus voltage loop runs with the closed current loop below, its d-axis reference has no other consumer
+
     // TODO: Testing
     static float32_t dutyU, dutyV, dutyW;
 
@@ -619,8 +664,16 @@ void EVERT_INVERTER_ISR_25KHZ_IRQHandler()
     // float32_t duty_cycle_u = GetDutyCycle(0);
     // float32_t duty_cycle_v = GetDutyCycle(+120);
     // float32_t duty_cycle_w = GetDutyCycle(+240);
+
+    // The midpoint balancing goes on whatever duties are applied: these open-loop test duties for now, the duties
+    // of the closed current loop below once it runs (the offset is a zero-sequence term, the line voltages stay)
+    EVERT_INVERTER_GridFormingMidpointBalancing(&dutyU, &dutyV, &dutyW);
     EVERT_INVERTER_SetDutyCycle(dutyU, dutyV, dutyW);
 
+    // Waveform capture and telemetry (decimated internally)
+    EVERT_INVERTER_ScopeRecord();
+    EVERT_INVERTER_TelemetryRecord();
+
     // // Summary of Steps for Bi-Directional PFC Implementation:
     // // 1. Ensure DQ frame alignment for both power-sourcing and power-sinking modes.
     // // 2. Modify current control logic to handle bi-directional current flow and adjust the idRef and iqRef values dynamically.
@@ -644,6 +697,9 @@ void EVERT_INVERTER_ISR_25KHZ_IRQHandler()
     //     EVERT_INVERTER_SetPwmEnabled(true);
     // }
 
+    // // DC bus voltage outer loop, generates gf_id_ref (decimated internally), bumpless until the current loop closes
+    // EVERT_INVERTER_GridFormingBusVoltageLoop();
+
     // // Closed-loop current control
     // if (gf_closed_current_loop)
     // {
@@ -655,15 +711,16 @@ void EVERT_INVERTER_ISR_25KHZ_IRQHandler()
 
     // // TODO: Skip for now
     // // [] TINV_Third_Harmonic_Injection [TINV_duty_THI_pu]
-    // // [] TINV_MIDDLE_POINT_CONTROL_STATUS - middle point control [TINV_duty_0_pu]
+    // // [x] TINV_MIDDLE_POINT_CONTROL_STATUS - middle point control [TINV_duty_0_pu], see EVERT_INVERTER_GridFormingMidpointBalancing
 
     // // Update PWM duty cycles
     // if (gf_closed_current_loop)
     // {
     //     // Update PWM duty cycles
-    //     gf_duty_cycle_a_pu = gf_inverter_voltage_abc.a; // + spll_duty_cycle_thi + spll_duty_cycle_0;
-    //     gf_duty_cycle_b_pu = gf_inverter_voltage_abc.b; // + spll_duty_cycle_thi + spll_duty_cycle_0;
-    //     gf_duty_cycle_c_pu = gf_inverter_voltage_abc.c; // + spll_duty_cycle_thi + spll_duty_cycle_0;
+    //     gf_duty_cycle_a_pu = gf_inverter_voltage_abc.a; // + spll_duty_cycle_thi;
+    //     gf_duty_cycle_b_pu = gf_inverter_voltage_abc.b; // + spll_duty_cycle_thi;
+    //     gf_duty_cycle_c_pu = gf_inverter_voltage_abc.c; // + spll_duty_cycle_thi;
+    //     EVERT_INVERTER_GridFormingMidpointBalancing(&gf_duty_cycle_a_pu, &gf_duty_cycle_b_pu, &gf_duty_cycle_c_pu);
 
     //     // Calculate the duty cycle percentage and pwm signals
     //     float32_t a = ((EVERT_SETTING_INVERTER_VOLTAGE_INSTANTANEOUS_MAX * gf_duty_cycle_a_pu) + EVERT_SETTING_INVERTER_VOLTAGE_INSTANTANEOUS_MAX) / (EVERT_SETTING_INVERTER_VOLTAGE_INSTANTANEOUS_MAX * 2.0f);
@@ -704,6 +761,9 @@ void EVERT_INVERTER_ISR_25KHZ_IRQHandler()
 
     // // TODO: Constraints checking
 
+    EVERT_WATCHDOG_Checkin(IWC_ISR_HF);
+    EVERT_WATCHDOG_WindowCheckin();
+
     // Set ADC conversion flag
     adc_completed[0] = false;
     adc_completed[1] = false;
@@ -715,10 +775,32 @@ void EVERT_INVERTER_ISR_100HZ_IRQHandler()
     {
         EVERT_INVERTER_ISR_LF_Readings();
 
+        // Fan control and current derating (decimated internally)
+        EVERT_INVERTER_ThermalRun();
+
+        // Scope trigger on alarms
+        EVERT_INVERTER_ScopeCheckAlarms();
+
+        // Re-evaluate the device state against the alarms
+        EVERT_DEVICE_OnLfTick();
+
+        EVERT_WATCHDOG_Checkin(IWC_ISR_LF);
+
         adc_completed[2] = false;
     }
 }
 
+/// @brief Gate drivers and outputs off, any context (watchdog expiry, fatal errors)
+void __overrides EVERT_WATCHDOG_OnSafeState(void)
+{
+    HAL_GPIO_WritePin(EVERT_INVERTER_GPIO_DEF_PWM_ENABLE.port, EVERT_INVERTER_GPIO_DEF_PWM_ENABLE.pin, GPIO_PIN_RESET);
+    HAL_GPIO_WritePin(EVERT_INVERTER_GPIO_DEF_PWM_RESET.port, EVERT_INVERTER_GPIO_DEF_PWM_RESET.pin, GPIO_PIN_RESET);
+
+    HRTIM1->sCommonRegs.ODISR = HRTIM_OUTPUT_TA1 | HRTIM_OUTPUT_TA2 | HRTIM_OUTPUT_TB1 | HRTIM_OUTPUT_TB2 |
+                                HRTIM_OUTPUT_TC1 | HRTIM_OUTPUT_TC2 | HRTIM_OUTPUT_TD1 | HRTIM_OUTPUT_TD2 |
+                                HRTIM_OUTPUT_TE1 | HRTIM_OUTPUT_TE2 | HRTIM_OUTPUT_TF1 | HRTIM_OUTPUT_TF2;
+}
+
 void __overrides HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
 {
     if (hadc == &hadc1)
@@ -735,57 +817,88 @@ void __overrides HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
     }
 }
 
+void __overrides HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    EVERT_I2C_QUEUE_OnTransferComplete(&i2c_queue, hi2c);
+}
+
+void __overrides HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    EVERT_I2C_QUEUE_OnTransferComplete(&i2c_queue, hi2c);
+}
+
+void __overrides HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    EVERT_TELEMETRY_OnTxComplete(&tm_telemetry, huart);
+}
+
+void __overrides HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+    EVERT_TELEMETRY_OnRxEvent(&tm_telemetry, huart, Size);
+}
+
 // Error Callbacks
 void EVERT_INVERTER_hal_error(char *error_message)
 {
-    EVERT_INVERTER_CommonErrorCallback(error_message);
+    EVERT_INVERTER_CommonErrorCallback(error_message, 0);
 }
 
 void HAL_ADC_ErrorCallback(ADC_HandleTypeDef *hadc)
 {
     UNUSED(hadc);
-    EVERT_INVERTER_CommonErrorCallback("ADC Error\n");
+    EVERT_INVERTER_CommonErrorCallback("ADC Error\n", EVERT_FAULT_RECORD_CALLER());
 }
 
 void HAL_DMA_ErrorCallback(DMA_HandleTypeDef *hdma)
 {
     UNUSED(hdma);
-    EVERT_INVERTER_CommonErrorCallback("DMA Error\n");
+    EVERT_INVERTER_CommonErrorCallback("DMA Error\n", EVERT_FAULT_RECORD_CALLER());
 }
 
 void HAL_FDCAN_ErrorCallback(FDCAN_HandleTypeDef *hfdcan)
 {
     UNUSED(hfdcan);
-    EVERT_INVERTER_CommonErrorCallback("FDCAN Error\n");
+    EVERT_INVERTER_CommonErrorCallback("FDCAN Error\n", EVERT_FAULT_RECORD_CALLER());
 }
 
 void HAL_FLASH_OperationErrorCallback(uint32_t ReturnValue)
 {
     UNUSED(ReturnValue);
-    EVERT_INVERTER_CommonErrorCallback("FLASH Error\n");
+    EVERT_INVERTER_CommonErrorCallback("FLASH Error\n", EVERT_FAULT_RECORD_CALLER());
 }
 
 void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
 {
-    UNUSED(hi2c);
-    EVERT_INVERTER_CommonErrorCallback("I2C Error\n");
+    // Bus errors (NACK, arbitration loss) are retried by the queue, not fatal
+    EVERT_I2C_QUEUE_OnError(&i2c_queue, hi2c);
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    // Telemetry only, a lost buffer shows up in the sequence numbers, reception is restarted
+    EVERT_TELEMETRY_OnError(&tm_telemetry, huart);
 }
 
 void HAL_TIM_ErrorCallback(TIM_HandleTypeDef *htim)
 {
     UNUSED(htim);
-    EVERT_INVERTER_CommonErrorCallback("TIM Error\n");
+    EVERT_INVERTER_CommonErrorCallback("TIM Error\n", EVERT_FAULT_RECORD_CALLER());
 }
 
-void EVERT_INVERTER_CommonErrorCallback(char *error_message)
+void EVERT_INVERTER_CommonErrorCallback(char *error_message, const uint32_t pc)
 {
+    EVERT_WATCHDOG_EnterSafeState();
     EVERT_HAL_BreakPoint(error_message);
+
+    // Kept across the reset, reported on the next boot
+    EVERT_FAULT_RECORD_CaptureError(error_message, pc);
+
+    // Post-mortem: stop the capture at the fault and dump it before halting
+    EVERT_SCOPE_Freeze(&sc_scope, ISCT_ERROR);
+    EVERT_INVERTER_ScopeDumpBlocking();
+
     EVERT_INVERTER_SetStatusLed(0, EVERT_CONSTANT_INVERTER_STATUS_LED0_COLOR_ERROR, EVERT_CONSTANT_INVERTER_STATUS_LED0_TIME_ERROR_ON, EVERT_CONSTANT_INVERTER_STATUS_LED0_TIME_ERROR_OFF);
     EVERT_INVERTER_SetStatusLed(1, EVERT_CONSTANT_INVERTER_STATUS_LED1_COLOR_ERROR, EVERT_CONSTANT_INVERTER_STATUS_LED1_TIME_ERROR_ON, EVERT_CONSTANT_INVERTER_STATUS_LED1_TIME_ERROR_OFF);
 
-    __disable_irq();
-
-    while (1)
-    {
-    }
+    EVERT_FAULT_RECORD_Halt();
 }
\ No newline at end of file
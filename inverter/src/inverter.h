@@ -20,9 +20,16 @@
 #include "inverter_alarm_index.h"
 #include "inverter_calibration.h"
 #include "inverter_constraints.h"
+#include "inverter_fault.h"
 #include "inverter_grid.h"
+#include "inverter_junction.h"
 #include "inverter_math.h"
+#include "inverter_parameters.h"
 #include "inverter_readings.h"
+#include "inverter_registry.h"
+#include "inverter_scope.h"
+#include "inverter_telemetry.h"
+#include "inverter_thermal.h"
 #include "inverter_transforms.h"
 #include "stm32g4xx_hal.h"
 #include "stm32g4xx_hal_hrtim.h"
@@ -55,6 +62,14 @@ typedef struct
     GPIO_PinState pwm_fdcan_fault;
 } EVERT_INVERTER_IoStateTypeDef;
 
+// Watchdog checkpoints (watchdog.h), each checks in at least once per EVERT_SETTING_INVERTER_WATCHDOG_*_DEADLINE_MS
+typedef enum
+{
+    IWC_LOOP = 0,
+    IWC_ISR_HF = 1,
+    IWC_ISR_LF = 2
+} EVERT_INVERTER_WatchdogCheckpointTypeDef;
+
 extern EVERT_INVERTER_TimeTypeDef time;
 extern EVERT_INVERTER_IoStateTypeDef io_state;
 extern EVERT_HAL_GpioDefinitionTypeDef EVERT_INVERTER_GPIO_DEF_PWM_ENABLE;
@@ -91,10 +106,15 @@ void __overrides EVERT_TASK_SCHEDULER_OnTaskSendData();
 void __overrides EVERT_TASK_SCHEDULER_OnTaskSendDeviceStatus();
 void __overrides EVERT_TASK_SCHEDULER_OnTaskSendPing();
 
+// __weak Callbacks - Watchdog
+void __overrides EVERT_WATCHDOG_OnSafeState(void);
+
 // Peripheral Callbacks
 void EVERT_INVERTER_ISR_25KHZ_IRQHandler();
 void EVERT_INVERTER_ISR_100HZ_IRQHandler();
 void __overrides HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc);
+void __overrides HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c);
+void __overrides HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c);
 
 // Error Callbacks
 void EVERT_INVERTER_hal_error(char *error_message);
@@ -104,6 +124,6 @@ void HAL_FDCAN_ErrorCallback(FDCAN_HandleTypeDef *hfdcan);
 void HAL_FLASH_OperationErrorCallback(uint32_t ReturnValue);
 void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c);
 void HAL_TIM_ErrorCallback(TIM_HandleTypeDef *htim);
-void EVERT_INVERTER_CommonErrorCallback(char *error_message);
+void EVERT_INVERTER_CommonErrorCallback(char *error_message, const uint32_t pc);
 
 #endif // EVERT_INVERTER_MAIN_H_
\ No newline at end of file
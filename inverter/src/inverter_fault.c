@@ -0,0 +1,82 @@
+#include <string.h>
+
+#include "inverter_fault.h"
+#include "evert_device.h"
+#include "inverter_telemetry.h"
+
+_Static_assert(sizeof(EVERT_INVERTER_FaultChunkTypeDef) <= EVERT_TELEMETRY_PAYLOAD_MAX, "EVERT_HAL_CONF_TELEMETRY_PAYLOAD_MAX too small");
+
+EVERT_INVERTER_FaultStateTypeDef ft_state;
+
+static void EVERT_INVERTER_FaultSelect(const uint8_t index, const EVERT_FAULT_RECORD_TypeDef *record)
+{
+    ft_state.record = record;
+    ft_state.index = index;
+    ft_state.offset = 0;
+    ft_state.pending = true;
+}
+
+void EVERT_INVERTER_FaultInit(void)
+{
+    // Reset cause after every boot, the record only when this reset left one
+    EVERT_INVERTER_FaultSelect(0, fault_record.new_record ? EVERT_FAULT_RECORD_GetLatest() : NULL);
+}
+
+void EVERT_INVERTER_FaultOnRequest(const uint8_t *payload, const uint32_t length)
+{
+    uint8_t index = length > 0 ? payload[0] : 0;
+
+    EVERT_INVERTER_FaultSelect(index, EVERT_FAULT_RECORD_Get(index));
+}
+
+/// @brief Send the next chunk, call from the main loop
+void EVERT_INVERTER_FaultProcess(void)
+{
+    if (!ft_state.pending || EVERT_TELEMETRY_GetFree(&tm_telemetry) < EVERT_TELEMETRY_BUFFER_SIZE / 2)
+    {
+        return;
+    }
+
+    EVERT_INVERTER_FaultChunkTypeDef chunk;
+    memset(&chunk, 0, sizeof(chunk));
+    chunk.index = ft_state.index;
+    chunk.offset = ft_state.offset;
+    chunk.size = sizeof(EVERT_FAULT_RECORD_TypeDef);
+    chunk.reset_cause = fault_record.reset_cause;
+
+    if (ft_state.record != NULL)
+    {
+        uint32_t length = sizeof(EVERT_FAULT_RECORD_TypeDef) - ft_state.offset;
+
+        if (length > EVERT_INVERTER_FAULT_CHUNK_SIZE)
+        {
+            length = EVERT_INVERTER_FAULT_CHUNK_SIZE;
+        }
+
+        chunk.type = ft_state.record->type;
+        chunk.reset_cause = ft_state.record->reset_cause;
+        chunk.length = (uint16_t)length;
+        memcpy(chunk.data, (const uint8_t *)ft_state.record + ft_state.offset, length);
+
+        ft_state.offset += length;
+    }
+
+    if (EVERT_TELEMETRY_Send(&tm_telemetry, ITS_FAULT_CHUNK, &chunk, sizeof(chunk)) != TMS_OK)
+    {
+        ft_state.offset = chunk.offset; // Again next time
+        return;
+    }
+
+    if (ft_state.record == NULL || ft_state.offset >= sizeof(EVERT_FAULT_RECORD_TypeDef))
+    {
+        ft_state.record = NULL;
+        ft_state.pending = false;
+    }
+}
+
+/// @brief Device state at the capture (the inverter has no alarm register of its own yet)
+void __overrides EVERT_FAULT_RECORD_OnCapture(EVERT_FAULT_RECORD_TypeDef *record)
+{
+    record->state_internal = (uint8_t)EVERT_DEVICE_State_Get(SS_INTERNAL);
+    record->state_propagated = (uint8_t)EVERT_DEVICE_State_Get(SS_PROPAGATED);
+}
@@ -0,0 +1,42 @@
+#ifndef EVERT_INVERTER_FAULT_H_
+#define EVERT_INVERTER_FAULT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "_conf_evert_hal.h"
+#include "fault_record.h"
+
+// Fault record reporting over the telemetry link (fault_record.h for the capture, the inverter has no CAN)
+// * After boot: the reset cause, with the record the last reset left (if any)
+// * ITS_FAULT_REQUEST [index u8] (0 = newest): that record
+// Records go out as ITS_FAULT_CHUNK records, one per EVERT_INVERTER_FaultProcess while the buffer has room
+
+#define EVERT_INVERTER_FAULT_CHUNK_SIZE (48)
+
+typedef struct
+{
+    uint8_t index; // Record index, 0 = newest
+    uint8_t type;  // EVERT_FAULT_RECORD_TypeTypeDef, FRT_NONE: no record (reset cause only)
+    uint16_t offset;
+    uint16_t size;   // Record size
+    uint16_t length; // Bytes in data
+    uint32_t reset_cause;
+    uint8_t data[EVERT_INVERTER_FAULT_CHUNK_SIZE];
+} EVERT_INVERTER_FaultChunkTypeDef;
+
+typedef struct
+{
+    const EVERT_FAULT_RECORD_TypeDef *record; // Being sent, NULL: idle
+    uint8_t index;
+    uint16_t offset;
+    bool pending; // Send even without a record (reset cause)
+} EVERT_INVERTER_FaultStateTypeDef;
+
+extern EVERT_INVERTER_FaultStateTypeDef ft_state;
+
+void EVERT_INVERTER_FaultInit(void);
+void EVERT_INVERTER_FaultOnRequest(const uint8_t *payload, const uint32_t length);
+void EVERT_INVERTER_FaultProcess(void);
+
+#endif // EVERT_INVERTER_FAULT_H_
@@ -6,8 +6,20 @@ EVERT_INVERTER_AbcDq0TypeDef gf_inverter_current_dq0; // Current
 EVERT_INVERTER_AbcDq0TypeDef gf_grid_voltage_dq0;     // Grid Voltage Reference
 EVERT_INVERTER_Dq0AbcTypeDef gf_inverter_voltage_abc; // Inverter Voltage
 
-EVERT_INVERTER_SpllPiStateTypeDef gf_pi_state_d;
-EVERT_INVERTER_SpllPiStateTypeDef gf_pi_state_q;
+EVERT_PID_DqStateTypeDef gf_pi_state_dq;
+EVERT_PID_StateTypeDef gf_pi_state_bus;
+
+// DC Bus Voltage Loop
+arm_biquad_cascade_df2T_instance_f32 gf_bus_notch;
+float32_t gf_bus_notch_coeffs[5];
+float32_t gf_bus_notch_state[2];
+float32_t gf_bus_voltage_notched;
+float32_t gf_bus_power_feed_forward;
+uint32_t gf_bus_loop_decimation;
+
+// Bus Midpoint Balancing
+EVERT_PID_StateTypeDef gf_pi_state_midpoint;
+float32_t gf_duty_cycle_0_pu;
 
 // Control flags
 bool gf_start_pwm_output;    //
@@ -17,8 +29,9 @@ bool gf_closed_current_loop; // Closed current loop flag
 float32_t gf_voltage_grid_a_previous;
 
 // Current control
-float32_t gf_id_ref_pu;      // D-axis reference current
-float32_t gf_iq_ref_pu;      // Q-axis reference current
+float32_t gf_id_ref;         // D-axis reference current (A)
+float32_t gf_iq_ref;         // Q-axis reference current (A)
+float32_t gf_current_limit;  // Current reference limit (A)
 float32_t gf_id_out;         // D-axis output current from PI controller
 float32_t gf_iq_out;         // Q-axis output current from PI controller
 float32_t gf_vd_inverter_pu; // D-axis output voltage from PI controller
@@ -44,7 +57,7 @@ float32_t gf_srf_delta_t;               // ISR time step
 float32_t gf_srf_filter_coeff_b0;       // Filter coefficient
 float32_t gf_srf_filter_coeff_b1;       // Filter coefficient
 
-void EVERT_INVERTER_GridFormingInit(const float32_t ki, const float32_t kp, const float32_t coeff_b0, const float32_t coeff_b1)
+void EVERT_INVERTER_GridFormingInit(const float32_t kp, const float32_t ki, const float32_t coeff_b0, const float32_t coeff_b1)
 {
     // Initialize the grid forming transforms
     EVERT_INVERTER_InitAbcDq0(&gf_inverter_current_dq0);
@@ -52,8 +65,18 @@ void EVERT_INVERTER_GridFormingInit(const float32_t ki, const float32_t kp, cons
     EVERT_INVERTER_InitDq0Abc(&gf_inverter_voltage_abc);
 
     // Initialize PI States
-    EVERT_INVERTER_GridFormingPiStateInit(&gf_pi_state_d, ki, kp);
-    EVERT_INVERTER_GridFormingPiStateInit(&gf_pi_state_q, ki, kp);
+    EVERT_PID_DqInit(&gf_pi_state_dq, kp, ki, EVERT_CONSTANT_INVERTER_ISR_HF_PERIOD, -EVERT_SETTING_INVERTER_CURRENT_LOOP_OUTPUT_MAX, EVERT_SETTING_INVERTER_CURRENT_LOOP_OUTPUT_MAX);
+    EVERT_PID_Init(&gf_pi_state_bus, EVERT_SETTING_INVERTER_BUS_LOOP_KP, EVERT_SETTING_INVERTER_BUS_LOOP_KI, 0.0f, EVERT_SETTING_INVERTER_BUS_LOOP_PERIOD, -EVERT_SETTING_INVERTER_CURRENT_INSTANTANEOUS_MAX, EVERT_SETTING_INVERTER_CURRENT_INSTANTANEOUS_MAX);
+
+    // DC Bus Voltage Loop
+    EVERT_INVERTER_GridFormingBusNotchInit(EVERT_SETTING_INVERTER_GRID_NOMINAL_FREQUENCY);
+    gf_bus_voltage_notched = EVERT_SETTING_INVERTER_VOLTAGE_BUS_NOMINAL;
+    gf_bus_power_feed_forward = 0;
+    gf_bus_loop_decimation = 0;
+
+    // Bus Midpoint Balancing
+    EVERT_PID_Init(&gf_pi_state_midpoint, EVERT_SETTING_INVERTER_MIDPOINT_KP, EVERT_SETTING_INVERTER_MIDPOINT_KI, 0.0f, EVERT_CONSTANT_INVERTER_ISR_HF_PERIOD, -EVERT_SETTING_INVERTER_MIDPOINT_DUTY_MAX, EVERT_SETTING_INVERTER_MIDPOINT_DUTY_MAX);
+    gf_duty_cycle_0_pu = 0;
 
     // Control flags
     gf_start_pwm_output = false;
@@ -63,8 +86,9 @@ void EVERT_INVERTER_GridFormingInit(const float32_t ki, const float32_t kp, cons
     gf_voltage_grid_a_previous = 0;
 
     // Current control
-    gf_id_ref_pu = 0.005f; // D-axis reference current
-    gf_iq_ref_pu = 0;      // Q-axis reference current
+    gf_id_ref = 0;         // D-axis reference current (driven by the bus voltage loop)
+    gf_iq_ref = 0;         // Q-axis reference current
+    gf_current_limit = EVERT_SETTING_INVERTER_CURRENT_INSTANTANEOUS_MAX;
     gf_id_out = 0;         // D-axis output current from PI controller
     gf_iq_out = 0;         // Q-axis output current from PI controller
     gf_vd_inverter_pu = 0; // D-axis output voltage from PI controller
@@ -93,3 +117,39 @@ void EVERT_INVERTER_GridFormingInit(const float32_t ki, const float32_t kp, cons
     gf_srf_filter_coeff_b0 = coeff_b0; // Filter coefficient
     gf_srf_filter_coeff_b1 = coeff_b1; // Filter coefficient
 }
+
+void EVERT_INVERTER_GridFormingBusNotchInit(const float32_t grid_frequency)
+{
+    // Second order notch at 2x grid frequency, sampled at the bus loop rate
+    float32_t omega = 2.0f * PI * (2.0f * grid_frequency) * EVERT_SETTING_INVERTER_BUS_LOOP_PERIOD;
+    float32_t cosine = arm_cos_f32(omega);
+    float32_t alpha = arm_sin_f32(omega) / (2.0f * EVERT_SETTING_INVERTER_BUS_LOOP_NOTCH_Q);
+    float32_t a0 = 1.0f + alpha;
+
+    // CMSIS order: b0, b1, b2, -a1, -a2 (normalized by a0)
+    gf_bus_notch_coeffs[0] = 1.0f / a0;
+    gf_bus_notch_coeffs[1] = (-2.0f * cosine) / a0;
+    gf_bus_notch_coeffs[2] = 1.0f / a0;
+    gf_bus_notch_coeffs[3] = (2.0f * cosine) / a0;
+    gf_bus_notch_coeffs[4] = -(1.0f - alpha) / a0;
+
+    gf_bus_notch_state[0] = 0;
+    gf_bus_notch_state[1] = 0;
+    arm_biquad_cascade_df2T_init_f32(&gf_bus_notch, 1, gf_bus_notch_coeffs, gf_bus_notch_state);
+}
+
+void EVERT_INVERTER_GridFormingSetPowerFeedForward(const float32_t power)
+{
+    gf_bus_power_feed_forward = power;
+}
+
+/// @brief Limit the current references, from the junction temperature estimator and the thermal derating
+/// @details The bus voltage loop output saturates at the limit (its integrator stops winding up against it)
+/// @param current_limit Peak current limit (A), capped at EVERT_SETTING_INVERTER_CURRENT_OVERLOAD_MAX
+void EVERT_INVERTER_GridFormingSetCurrentLimit(const float32_t current_limit)
+{
+    gf_current_limit = current_limit;
+    EVERT_INVERTER_MATH_CLAMP(gf_current_limit, 0.0f, EVERT_SETTING_INVERTER_CURRENT_OVERLOAD_MAX);
+
+    EVERT_PID_SetLimits(&gf_pi_state_bus, -gf_current_limit, gf_current_limit);
+}
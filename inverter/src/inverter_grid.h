@@ -4,47 +4,33 @@
 #include <arm_math.h>
 #include <stdbool.h>
 
+#include "pid_controller.h"
 #include "inverter_readings.h"
 #include "inverter_transforms.h"
 
 #define VD_VQ_SCALING_FACTOR (EVERT_SETTING_INVERTER_VOLTAGE_INSTANTANEOUS_MAX / EVERT_SETTING_INVERTER_VOLTAGE_BUS_MAX)
 #define VD_DQ_FACTOR2 (EVERT_SETTING_INVERTER_PLL_DECOUPLING_FACTOR * EVERT_SETTING_INVERTER_GRID_NOMINAL_FREQUENCY)
 
-typedef struct __attribute__((aligned(4)))
-{
-    // Proportional Gain
-    // Determines the controller's response to the error term (difference between reference and feedback).
-    // Higher Kp leads to faster response but might cause instability.
-    float32_t Kp;
-
-    // Integral Gain
-    // Accumulates the error over time and helps eliminate steady-state error.
-    // Higher Ki provides better steady-state accuracy but can introduce sluggishness.
-    float32_t Ki;
-
-    // Integral Storage
-    // Holds the accumulated error term from previous calculations. It's updated within the PI control function.
-    float32_t Integral;
-
-    // Saturation Limits
-    // Prevents the controller from outputting values that are too high or too low.
-    float32_t SaturationHigh;
-    float32_t SaturationLow;
-
-    // Saturation Storage
-    // Flag (floating-point) that might be set to 1.0f when saturation occurs (control effort reaches the limit) and 0.0f otherwise.
-    // This helps prevent the integrator from accumulating error excessively when saturation is active.
-    float32_t Saturation;
-} EVERT_INVERTER_SpllPiStateTypeDef;
-
 // Transforms
 extern EVERT_INVERTER_AbcDq0TypeDef gf_inverter_current_dq0; // Current
 extern EVERT_INVERTER_AbcDq0TypeDef gf_grid_voltage_dq0;     // Grid Voltage Reference
 extern EVERT_INVERTER_Dq0AbcTypeDef gf_inverter_voltage_abc; // Inverter Voltage
 
 // PI States
-extern EVERT_INVERTER_SpllPiStateTypeDef gf_pi_state_d;
-extern EVERT_INVERTER_SpllPiStateTypeDef gf_pi_state_q;
+extern EVERT_PID_DqStateTypeDef gf_pi_state_dq;
+extern EVERT_PID_StateTypeDef gf_pi_state_bus;
+
+// DC Bus Voltage Loop
+extern arm_biquad_cascade_df2T_instance_f32 gf_bus_notch;
+extern float32_t gf_bus_notch_coeffs[5];
+extern float32_t gf_bus_notch_state[2];
+extern float32_t gf_bus_voltage_notched;    // Bus voltage with the 2x grid frequency ripple removed
+extern float32_t gf_bus_power_feed_forward; // Input power reported by the boost converters (W)
+extern uint32_t gf_bus_loop_decimation;     // HF ISR ticks since the last bus loop update
+
+// Bus Midpoint Balancing
+extern EVERT_PID_StateTypeDef gf_pi_state_midpoint;
+extern float32_t gf_duty_cycle_0_pu; // Zero-sequence duty offset
 
 // Control flags
 extern bool gf_start_pwm_output;    //
@@ -54,8 +40,9 @@ extern bool gf_closed_current_loop; // Closed current loop flag
 extern float32_t gf_voltage_grid_a_previous;
 
 // Current control
-extern float32_t gf_id_ref_pu;      // D-axis reference current
-extern float32_t gf_iq_ref_pu;      // Q-axis reference current
+extern float32_t gf_id_ref;         // D-axis reference current (A)
+extern float32_t gf_iq_ref;         // Q-axis reference current (A)
+extern float32_t gf_current_limit;  // Current reference limit (A), lowered by the thermal derating
 extern float32_t gf_id_out;         // D-axis output current from PI controller
 extern float32_t gf_iq_out;         // Q-axis output current from PI controller
 extern float32_t gf_vd_inverter_pu; // D-axis output voltage from PI controller
@@ -82,47 +69,47 @@ extern float32_t gf_srf_filter_coeff_b0;       // Filter coefficient
 extern float32_t gf_srf_filter_coeff_b1;       // Filter coefficient
 
 void EVERT_INVERTER_GridFormingInit(const float32_t kp, const float32_t ki, const float32_t coeff_b0, const float32_t coeff_b1);
+void EVERT_INVERTER_GridFormingBusNotchInit(const float32_t grid_frequency);
+void EVERT_INVERTER_GridFormingSetPowerFeedForward(const float32_t power);
+void EVERT_INVERTER_GridFormingSetCurrentLimit(const float32_t current_limit);
 
-static inline void EVERT_INVERTER_GridFormingPiStateInit(EVERT_INVERTER_SpllPiStateTypeDef *pi_state, const float32_t kp, const float32_t ki)
+static inline void EVERT_INVERTER_GridFormingBusVoltageLoop()
 {
-    pi_state->Kp = kp;
-    pi_state->Ki = ki;
-    pi_state->Integral = 0;
-    pi_state->SaturationHigh = 0;
-    pi_state->SaturationLow = 0;
-    pi_state->Saturation = 0;
-}
+    // Runs from the HF ISR, decimated to EVERT_SETTING_INVERTER_BUS_LOOP_PERIOD
+    if (++gf_bus_loop_decimation < EVERT_SETTING_INVERTER_BUS_LOOP_DECIMATION)
+    {
+        return;
+    }
 
-static inline float32_t EVERT_INVERTER_GridFormingPiControl(EVERT_INVERTER_SpllPiStateTypeDef *pi_state, float32_t setpoint_reference, float32_t feedback_value)
-{
-    // TIDA1606 reference
-    // float32_t v2, v4, v5, v9;
-    // v2 = p->Kp * (rk - yk);
-    // v4 = p->i10 + (p->Ki * p->i6 * v2);
-    // v5 = v2 + v4;
-    // v9 = (v5 > p->Umax) ? p->Umax : v5;
-    // v9 = (v9 < p->Umin) ? p->Umin : v9;
-    // p->i10 = v4;
-    // p->i6 = (v5 == v9) ? 1.0f : 0.0f;
-
-    float32_t error = setpoint_reference - feedback_value;
-    float32_t proportional_term = pi_state->Kp * error;
-    float32_t integral_term = pi_state->Integral + (pi_state->Ki * pi_state->Saturation * proportional_term);
-    float32_t control_effort = proportional_term + integral_term;
-    float32_t control_effort_final = (control_effort > pi_state->SaturationHigh) ? pi_state->SaturationHigh : control_effort;
-    EVERT_INVERTER_MATH_CLAMP(control_effort_final, pi_state->SaturationLow, pi_state->SaturationHigh);
-
-    pi_state->Integral = integral_term;
-    pi_state->Saturation = (control_effort == control_effort_final) ? 1.0f : 0.0f;
-
-    return control_effort_final;
+    gf_bus_loop_decimation = 0;
+
+    // Remove the 2x grid frequency ripple, otherwise it is fed straight into the current reference
+    float32_t bus_voltage = uf_bus_voltage;
+    arm_biquad_cascade_df2T_f32(&gf_bus_notch, &bus_voltage, &gf_bus_voltage_notched, 1);
+
+    // Power feed-forward, P = 3/2 * Vd * Id
+    float32_t grid_vd = (gf_grid_voltage_dq0.d > EVERT_SETTING_INVERTER_BUS_LOOP_GRID_VD_MIN) ? gf_grid_voltage_dq0.d : (EVERT_SETTING_INVERTER_VOLTAGE_RMS_NOMINAL * M_SQRT2);
+    float32_t id_feed_forward = gf_bus_power_feed_forward / (1.5f * grid_vd);
+
+    // A bus above nominal means more energy comes in than goes out, so the error is inverted (Vbus - Vnom)
+    if (gf_closed_current_loop)
+    {
+        gf_id_ref = EVERT_PID_Update(&gf_pi_state_bus, gf_bus_voltage_notched, EVERT_SETTING_INVERTER_VOLTAGE_BUS_NOMINAL, id_feed_forward);
+    }
+    else
+    {
+        EVERT_PID_Bumpless(&gf_pi_state_bus, id_feed_forward, gf_bus_voltage_notched, EVERT_SETTING_INVERTER_VOLTAGE_BUS_NOMINAL, id_feed_forward);
+    }
+
+    EVERT_INVERTER_MATH_CLAMP(gf_iq_ref, -gf_current_limit, gf_current_limit);
 }
 
 static inline void EVERT_INVERTER_GridFormingClosedCurrentLoop()
 {
     // Run PI controller on the d and q axis currents
-    gf_id_out = EVERT_INVERTER_GridFormingPiControl(&gf_pi_state_d, gf_id_ref_pu, gf_inverter_current_dq0.d);
-    gf_iq_out = EVERT_INVERTER_GridFormingPiControl(&gf_pi_state_q, gf_iq_ref_pu, gf_inverter_current_dq0.q);
+    EVERT_PID_DqUpdate(&gf_pi_state_dq, gf_id_ref, gf_iq_ref, gf_inverter_current_dq0.d, gf_inverter_current_dq0.q, 0.0f, 0.0f);
+    gf_id_out = gf_pi_state_dq.d.Output;
+    gf_iq_out = gf_pi_state_dq.q.Output;
 
     // TIDA1606 reference
     // * TINV_gi_id_out: The output of the d axis current controller.
@@ -152,6 +139,33 @@ static inline void EVERT_INVERTER_GridFormingClosedCurrentLoop()
     EVERT_INVERTER_MATH_CLAMP(gf_vq_inverter_pu, -1.0f, 1.0f);
 }
 
+static inline void EVERT_INVERTER_GridFormingMidpointBalancing(float32_t *duty_a, float32_t *duty_b, float32_t *duty_c)
+{
+    // TIDA1606 reference [TINV_duty_0_pu]
+    // In the three-level bridge each phase is clamped to the midpoint for (1 - |d|) of the period, so the
+    // midpoint current is i_0 = sum((1 - |d_x|) * i_x). A common offset d_0 changes it by -d_0 * sum(sign(d_x) * i_x),
+    // so the correcting offset is the PI output on the midpoint error times the sign of that sum.
+    float32_t direction = 0.0f;
+    direction += (*duty_a >= 0.0f) ? uf_current_u : -uf_current_u;
+    direction += (*duty_b >= 0.0f) ? uf_current_v : -uf_current_v;
+    direction += (*duty_c >= 0.0f) ? uf_current_w : -uf_current_w;
+
+    // Without a clear current direction the injection has no effect (or the wrong one), hold the last offset
+    if (direction > EVERT_SETTING_INVERTER_MIDPOINT_CURRENT_MIN || direction < -EVERT_SETTING_INVERTER_MIDPOINT_CURRENT_MIN)
+    {
+        float32_t correction = EVERT_PID_Update(&gf_pi_state_midpoint, uf_bus_voltage * 0.5f, uf_bus_voltage_mid, 0.0f);
+        gf_duty_cycle_0_pu = (direction > 0.0f) ? correction : -correction;
+    }
+
+    *duty_a += gf_duty_cycle_0_pu;
+    *duty_b += gf_duty_cycle_0_pu;
+    *duty_c += gf_duty_cycle_0_pu;
+
+    EVERT_INVERTER_MATH_CLAMP(*duty_a, -1.0f, 1.0f);
+    EVERT_INVERTER_MATH_CLAMP(*duty_b, -1.0f, 1.0f);
+    EVERT_INVERTER_MATH_CLAMP(*duty_c, -1.0f, 1.0f);
+}
+
 static inline void EVERT_INVERTER_GridFormingSpllSrfControl()
 {
     // Update the srf_state->voltage_q[0] with the grid value
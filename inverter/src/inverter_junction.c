@@ -0,0 +1,113 @@
+#include "inverter_junction.h"
+#include "inverter_thermal.h"
+
+// Foster network
+float32_t tj_foster_a[EVERT_CONSTANT_INVERTER_JUNCTION_FOSTER_ORDER];
+float32_t tj_foster_b[EVERT_CONSTANT_INVERTER_JUNCTION_FOSTER_ORDER];
+float32_t tj_foster_r[EVERT_CONSTANT_INVERTER_JUNCTION_FOSTER_ORDER];
+float32_t tj_foster_horizon[EVERT_CONSTANT_INVERTER_JUNCTION_FOSTER_ORDER];
+float32_t tj_foster_state[EVERT_INVERTER_JUNCTION_LEG_COUNT][IJD_COUNT][EVERT_CONSTANT_INVERTER_JUNCTION_FOSTER_ORDER];
+
+// Losses
+float32_t tj_loss_sum[EVERT_INVERTER_JUNCTION_LEG_COUNT][IJD_COUNT];
+float32_t tj_loss[EVERT_INVERTER_JUNCTION_LEG_COUNT][IJD_COUNT];
+uint32_t tj_decimation;
+
+// Estimates
+float32_t tj_temperature[EVERT_INVERTER_JUNCTION_LEG_COUNT][IJD_COUNT];
+float32_t tj_temperature_max;
+float32_t tj_temperature_predicted_max;
+float32_t tj_current_limit;
+
+void EVERT_INVERTER_JunctionInit(void)
+{
+    static const float32_t foster_r[EVERT_CONSTANT_INVERTER_JUNCTION_FOSTER_ORDER] = EVERT_CONSTANT_INVERTER_JUNCTION_FOSTER_R;
+    static const float32_t foster_tau[EVERT_CONSTANT_INVERTER_JUNCTION_FOSTER_ORDER] = EVERT_CONSTANT_INVERTER_JUNCTION_FOSTER_TAU;
+
+    // Exact discretization of each RC element, the exponentials are only evaluated here
+    for (uint32_t i = 0; i < EVERT_CONSTANT_INVERTER_JUNCTION_FOSTER_ORDER; i++)
+    {
+        tj_foster_a[i] = expf(-EVERT_SETTING_INVERTER_JUNCTION_PERIOD / foster_tau[i]);
+        tj_foster_b[i] = foster_r[i] * (1.0f - tj_foster_a[i]);
+        tj_foster_r[i] = foster_r[i];
+        tj_foster_horizon[i] = 1.0f - expf(-EVERT_SETTING_INVERTER_JUNCTION_HORIZON / foster_tau[i]);
+    }
+
+    for (uint32_t leg = 0; leg < EVERT_INVERTER_JUNCTION_LEG_COUNT; leg++)
+    {
+        for (uint32_t device = 0; device < IJD_COUNT; device++)
+        {
+            for (uint32_t i = 0; i < EVERT_CONSTANT_INVERTER_JUNCTION_FOSTER_ORDER; i++)
+            {
+                tj_foster_state[leg][device][i] = 0;
+            }
+
+            tj_loss_sum[leg][device] = 0;
+            tj_loss[leg][device] = 0;
+            tj_temperature[leg][device] = 0;
+        }
+    }
+
+    tj_decimation = 0;
+    tj_temperature_max = 0;
+    tj_temperature_predicted_max = 0;
+    tj_current_limit = EVERT_SETTING_INVERTER_CURRENT_INSTANTANEOUS_MAX;
+}
+
+/// @brief Advance the Foster networks by one window and update the current limit
+/// @details Called from EVERT_INVERTER_JunctionRun every EVERT_SETTING_INVERTER_JUNCTION_DECIMATION HF ticks
+void EVERT_INVERTER_JunctionUpdate(void)
+{
+    const float32_t heatsink[EVERT_INVERTER_JUNCTION_LEG_COUNT] = {uf_temperature_heatsink_u, uf_temperature_heatsink_v, uf_temperature_heatsink_w};
+
+    float32_t temperature_max = -273.15f;
+    float32_t temperature_predicted_max = -273.15f;
+
+    for (uint32_t leg = 0; leg < EVERT_INVERTER_JUNCTION_LEG_COUNT; leg++)
+    {
+        for (uint32_t device = 0; device < IJD_COUNT; device++)
+        {
+            float32_t loss = tj_loss_sum[leg][device] * (1.0f / EVERT_SETTING_INVERTER_JUNCTION_DECIMATION);
+            float32_t *state = tj_foster_state[leg][device];
+            float32_t rise = 0.0f;
+            float32_t rise_predicted = 0.0f;
+
+            tj_loss_sum[leg][device] = 0;
+            tj_loss[leg][device] = loss;
+
+            for (uint32_t i = 0; i < EVERT_CONSTANT_INVERTER_JUNCTION_FOSTER_ORDER; i++)
+            {
+                state[i] = (tj_foster_a[i] * state[i]) + (tj_foster_b[i] * loss);
+                rise += state[i];
+
+                // Step response of each element towards R * P, evaluated at the horizon
+                rise_predicted += state[i] + (((tj_foster_r[i] * loss) - state[i]) * tj_foster_horizon[i]);
+            }
+
+            tj_temperature[leg][device] = heatsink[leg] + rise;
+
+            if (tj_temperature[leg][device] > temperature_max)
+            {
+                temperature_max = tj_temperature[leg][device];
+            }
+
+            if (heatsink[leg] + rise_predicted > temperature_predicted_max)
+            {
+                temperature_predicted_max = heatsink[leg] + rise_predicted;
+            }
+        }
+    }
+
+    tj_temperature_max = temperature_max;
+    tj_temperature_predicted_max = temperature_predicted_max;
+
+    // Up to the overload with a cold junction, down to DERATE_MIN when the predicted junction reaches its maximum
+    float32_t ramp = (tj_temperature_predicted_max - EVERT_SETTING_INVERTER_JUNCTION_DERATE_START) / (EVERT_SETTING_INVERTER_JUNCTION_MAX - EVERT_SETTING_INVERTER_JUNCTION_DERATE_START);
+    EVERT_INVERTER_MATH_CLAMP(ramp, 0.0f, 1.0f);
+
+    float32_t fraction = EVERT_SETTING_INVERTER_JUNCTION_OVERLOAD - (ramp * (EVERT_SETTING_INVERTER_JUNCTION_OVERLOAD - EVERT_SETTING_INVERTER_JUNCTION_DERATE_MIN));
+    tj_current_limit = fraction * EVERT_SETTING_INVERTER_CURRENT_INSTANTANEOUS_MAX;
+
+    // The slow heatsink derating scales the fast junction limit
+    EVERT_INVERTER_GridFormingSetCurrentLimit(th_derating * tj_current_limit);
+}
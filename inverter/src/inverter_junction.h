@@ -0,0 +1,82 @@
+#ifndef EVERT_INVERTER_JUNCTION_H_
+#define EVERT_INVERTER_JUNCTION_H_
+
+#include <arm_math.h>
+#include <stdbool.h>
+
+#include "_conf_evert_inverter.h"
+#include "inverter_grid.h"
+#include "inverter_math.h"
+#include "inverter_readings.h"
+
+// Junction temperature estimator, run from the HF ISR
+// * Losses per leg from the phase current, duty and bus voltage, averaged over the decimation window
+//   * Switch: conduction |d| * (V0 * |i| + R * i^2) + switching fsw * Eref * |i|/Iref * Vsw/Vref
+//   * Diode: conduction (1 - |d|) * (V0 * |i| + R * i^2) + recovery fsw * Erref * |i|/Iref * Vsw/Vref
+// * Foster network per device on top of the leg's heatsink temperature, Tj = Ths + sum(Ti)
+// * Current limit from the junction temperature predicted EVERT_SETTING_INVERTER_JUNCTION_HORIZON ahead
+
+#define EVERT_INVERTER_JUNCTION_LEG_COUNT (3)
+
+typedef enum
+{
+    IJD_SWITCH = 0,
+    IJD_DIODE = 1,
+    IJD_COUNT = 2
+} EVERT_INVERTER_JunctionDeviceTypeDef;
+
+// Foster network
+extern float32_t tj_foster_a[EVERT_CONSTANT_INVERTER_JUNCTION_FOSTER_ORDER];       // exp(-Ts/tau)
+extern float32_t tj_foster_b[EVERT_CONSTANT_INVERTER_JUNCTION_FOSTER_ORDER];       // R * (1 - exp(-Ts/tau))
+extern float32_t tj_foster_r[EVERT_CONSTANT_INVERTER_JUNCTION_FOSTER_ORDER];       // R
+extern float32_t tj_foster_horizon[EVERT_CONSTANT_INVERTER_JUNCTION_FOSTER_ORDER]; // 1 - exp(-H/tau)
+extern float32_t tj_foster_state[EVERT_INVERTER_JUNCTION_LEG_COUNT][IJD_COUNT][EVERT_CONSTANT_INVERTER_JUNCTION_FOSTER_ORDER];
+
+// Losses
+extern float32_t tj_loss_sum[EVERT_INVERTER_JUNCTION_LEG_COUNT][IJD_COUNT];
+extern float32_t tj_loss[EVERT_INVERTER_JUNCTION_LEG_COUNT][IJD_COUNT]; // W, averaged over the last window
+extern uint32_t tj_decimation;
+
+// Estimates
+extern float32_t tj_temperature[EVERT_INVERTER_JUNCTION_LEG_COUNT][IJD_COUNT]; // °C
+extern float32_t tj_temperature_max;                                            // Hottest junction (°C)
+extern float32_t tj_temperature_predicted_max;                                  // Hottest junction at the horizon (°C)
+extern float32_t tj_current_limit;                                              // A
+
+void EVERT_INVERTER_JunctionInit(void);
+void EVERT_INVERTER_JunctionUpdate(void);
+
+static inline void EVERT_INVERTER_JunctionAccumulateLeg(const uint32_t leg, const float32_t current, const float32_t duty, const float32_t switching_factor)
+{
+    float32_t current_abs = fabsf(current);
+    float32_t current_sq = current * current;
+    float32_t duty_abs = fabsf(duty);
+    EVERT_INVERTER_MATH_CLAMP(duty_abs, 0.0f, 1.0f);
+
+    float32_t switch_conduction = duty_abs * ((EVERT_CONSTANT_INVERTER_JUNCTION_SWITCH_V0 * current_abs) + (EVERT_CONSTANT_INVERTER_JUNCTION_SWITCH_R * current_sq));
+    float32_t diode_conduction = (1.0f - duty_abs) * ((EVERT_CONSTANT_INVERTER_JUNCTION_DIODE_V0 * current_abs) + (EVERT_CONSTANT_INVERTER_JUNCTION_DIODE_R * current_sq));
+
+    tj_loss_sum[leg][IJD_SWITCH] += switch_conduction + (EVERT_CONSTANT_INVERTER_JUNCTION_SWITCH_E_REF * switching_factor * current_abs);
+    tj_loss_sum[leg][IJD_DIODE] += diode_conduction + (EVERT_CONSTANT_INVERTER_JUNCTION_DIODE_E_REF * switching_factor * current_abs);
+}
+
+static inline void EVERT_INVERTER_JunctionRun()
+{
+    // Each switch blocks half the bus, energies scale linearly with the switched voltage and current
+    float32_t switching_factor = EVERT_CONSTANT_INVERTER_PWM_FREQUENCY * (uf_bus_voltage * 0.5f) / (EVERT_CONSTANT_INVERTER_JUNCTION_E_REF_VOLTAGE * EVERT_CONSTANT_INVERTER_JUNCTION_E_REF_CURRENT);
+
+    EVERT_INVERTER_JunctionAccumulateLeg(0, uf_current_u, gf_duty_cycle_a_pu, switching_factor);
+    EVERT_INVERTER_JunctionAccumulateLeg(1, uf_current_v, gf_duty_cycle_b_pu, switching_factor);
+    EVERT_INVERTER_JunctionAccumulateLeg(2, uf_current_w, gf_duty_cycle_c_pu, switching_factor);
+
+    // Runs from the HF ISR, the network is updated at EVERT_SETTING_INVERTER_JUNCTION_PERIOD
+    if (++tj_decimation < EVERT_SETTING_INVERTER_JUNCTION_DECIMATION)
+    {
+        return;
+    }
+
+    tj_decimation = 0;
+    EVERT_INVERTER_JunctionUpdate();
+}
+
+#endif // EVERT_INVERTER_JUNCTION_H_
@@ -0,0 +1,117 @@
+#include "_conf_evert_inverter.h"
+#include "inverter_calibration.h"
+#include "inverter_parameters.h"
+#include "debugging.h"
+
+_Static_assert(IPK_COUNT <= EVERT_PARAM_STORE_KEY_COUNT, "EVERT_HAL_CONF_PARAM_STORE_KEY_COUNT too small");
+
+// RAM copy each key lives in
+static float32_t *const parameters[IPK_COUNT] = {
+    [IPK_CURRENT_U_SLOPE] = &calibration_current.current_u_slope,
+    [IPK_CURRENT_U_INTERCEPT] = &calibration_current.current_u_intercept,
+    [IPK_CURRENT_V_SLOPE] = &calibration_current.current_v_slope,
+    [IPK_CURRENT_V_INTERCEPT] = &calibration_current.current_v_intercept,
+    [IPK_CURRENT_W_SLOPE] = &calibration_current.current_w_slope,
+    [IPK_CURRENT_W_INTERCEPT] = &calibration_current.current_w_intercept,
+    [IPK_TEMPERATURE_HEATSINK_U_SLOPE] = &calibration_temperature.temperature_heatsink_u_slope,
+    [IPK_TEMPERATURE_HEATSINK_U_INTERCEPT] = &calibration_temperature.temperature_heatsink_u_intercept,
+    [IPK_TEMPERATURE_HEATSINK_V_SLOPE] = &calibration_temperature.temperature_heatsink_v_slope,
+    [IPK_TEMPERATURE_HEATSINK_V_INTERCEPT] = &calibration_temperature.temperature_heatsink_v_intercept,
+    [IPK_TEMPERATURE_HEATSINK_W_SLOPE] = &calibration_temperature.temperature_heatsink_w_slope,
+    [IPK_TEMPERATURE_HEATSINK_W_INTERCEPT] = &calibration_temperature.temperature_heatsink_w_intercept,
+    [IPK_TEMPERATURE_FILTER_COIL_U_SLOPE] = &calibration_temperature.temperature_filter_coil_u_slope,
+    [IPK_TEMPERATURE_FILTER_COIL_U_INTERCEPT] = &calibration_temperature.temperature_filter_coil_u_intercept,
+    [IPK_TEMPERATURE_FILTER_COIL_V_SLOPE] = &calibration_temperature.temperature_filter_coil_v_slope,
+    [IPK_TEMPERATURE_FILTER_COIL_V_INTERCEPT] = &calibration_temperature.temperature_filter_coil_v_intercept,
+    [IPK_TEMPERATURE_FILTER_COIL_W_SLOPE] = &calibration_temperature.temperature_filter_coil_w_slope,
+    [IPK_TEMPERATURE_FILTER_COIL_W_INTERCEPT] = &calibration_temperature.temperature_filter_coil_w_intercept,
+    [IPK_TEMPERATURE_AMBIENT_SLOPE] = &calibration_temperature.temperature_ambient_slope,
+    [IPK_TEMPERATURE_AMBIENT_INTERCEPT] = &calibration_temperature.temperature_ambient_intercept,
+    [IPK_VOLTAGE_BUS_SLOPE] = &calibration_voltage_bus.voltage_bus_slope,
+    [IPK_VOLTAGE_BUS_INTERCEPT] = &calibration_voltage_bus.voltage_bus_intercept,
+    [IPK_VOLTAGE_BUS_MIDDLE_SLOPE] = &calibration_voltage_bus.voltage_bus_middle_slope,
+    [IPK_VOLTAGE_BUS_MIDDLE_INTERCEPT] = &calibration_voltage_bus.voltage_bus_middle_intercept,
+    [IPK_VOLTAGE_GRID_U_SLOPE] = &calibration_voltage_grid.voltage_grid_u_slope,
+    [IPK_VOLTAGE_GRID_U_INTERCEPT] = &calibration_voltage_grid.voltage_grid_u_intercept,
+    [IPK_VOLTAGE_GRID_V_SLOPE] = &calibration_voltage_grid.voltage_grid_v_slope,
+    [IPK_VOLTAGE_GRID_V_INTERCEPT] = &calibration_voltage_grid.voltage_grid_v_intercept,
+    [IPK_VOLTAGE_GRID_W_SLOPE] = &calibration_voltage_grid.voltage_grid_w_slope,
+    [IPK_VOLTAGE_GRID_W_INTERCEPT] = &calibration_voltage_grid.voltage_grid_w_intercept,
+    [IPK_VOLTAGE_U_SLOPE] = &calibration_voltage.voltage_u_slope,
+    [IPK_VOLTAGE_U_INTERCEPT] = &calibration_voltage.voltage_u_intercept,
+    [IPK_VOLTAGE_V_SLOPE] = &calibration_voltage.voltage_v_slope,
+    [IPK_VOLTAGE_V_INTERCEPT] = &calibration_voltage.voltage_v_intercept,
+    [IPK_VOLTAGE_W_SLOPE] = &calibration_voltage.voltage_w_slope,
+    [IPK_VOLTAGE_W_INTERCEPT] = &calibration_voltage.voltage_w_intercept,
+};
+
+// Compiled-in values, restored by an erase
+static float32_t parameter_defaults[IPK_COUNT];
+
+void EVERT_INVERTER_ParametersInit(void)
+{
+    // Called after EVERT_INVERTER_InitCalibrations, the RAM copies hold the defaults
+    for (uint32_t key = 0; key < IPK_COUNT; key++)
+    {
+        parameter_defaults[key] = *parameters[key];
+    }
+
+    if (EVERT_PARAM_STORE_Init() != PSS_OK)
+    {
+        // Keep running on the defaults
+        EVERT_HAL_BreakPoint("Parameter store init failed\n");
+        return;
+    }
+
+    for (uint32_t key = 0; key < IPK_COUNT; key++)
+    {
+        EVERT_PARAM_STORE_GetFloat(key, parameters[key]);
+    }
+}
+
+/// @brief Value in use, PSS_NOT_FOUND when it is the compiled-in default
+EVERT_PARAM_STORE_StatusTypeDef EVERT_INVERTER_ParametersGet(const uint16_t key, float32_t *value)
+{
+    if (key >= IPK_COUNT)
+    {
+        return PSS_INVALID_KEY;
+    }
+
+    uint32_t stored;
+    *value = *parameters[key];
+    return EVERT_PARAM_STORE_Get(key, &stored);
+}
+
+EVERT_PARAM_STORE_StatusTypeDef EVERT_INVERTER_ParametersSet(const uint16_t key, const float32_t value)
+{
+    if (key >= IPK_COUNT)
+    {
+        return PSS_INVALID_KEY;
+    }
+
+    EVERT_PARAM_STORE_StatusTypeDef status = EVERT_PARAM_STORE_SetFloat(key, value);
+
+    if (status == PSS_OK)
+    {
+        *parameters[key] = value;
+    }
+
+    return status;
+}
+
+EVERT_PARAM_STORE_StatusTypeDef EVERT_INVERTER_ParametersErase(const uint16_t key)
+{
+    if (key >= IPK_COUNT)
+    {
+        return PSS_INVALID_KEY;
+    }
+
+    EVERT_PARAM_STORE_StatusTypeDef status = EVERT_PARAM_STORE_Erase(key);
+
+    if (status == PSS_OK)
+    {
+        *parameters[key] = parameter_defaults[key];
+    }
+
+    return status;
+}
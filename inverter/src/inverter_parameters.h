@@ -0,0 +1,62 @@
+#ifndef EVERT_INVERTER_PARAMETERS_H_
+#define EVERT_INVERTER_PARAMETERS_H_
+
+#include <arm_math.h>
+#include <stdint.h>
+
+#include "_conf_evert_hal.h"
+#include "param_store.h"
+
+// Persistent calibrations (param_store.h)
+// * Defaults: EVERT_CALIBRATION_INV_* in _conf_evert_inverter.h, loaded by EVERT_INVERTER_InitCalibrations
+// * A stored value overrides the default at boot, EVERT_INVERTER_ParametersSet/Erase apply right away
+// Keys are persisted in flash, never renumber them (new keys go before IPK_COUNT)
+
+typedef enum
+{
+    IPK_CURRENT_U_SLOPE = 0,
+    IPK_CURRENT_U_INTERCEPT = 1,
+    IPK_CURRENT_V_SLOPE = 2,
+    IPK_CURRENT_V_INTERCEPT = 3,
+    IPK_CURRENT_W_SLOPE = 4,
+    IPK_CURRENT_W_INTERCEPT = 5,
+    IPK_TEMPERATURE_HEATSINK_U_SLOPE = 6,
+    IPK_TEMPERATURE_HEATSINK_U_INTERCEPT = 7,
+    IPK_TEMPERATURE_HEATSINK_V_SLOPE = 8,
+    IPK_TEMPERATURE_HEATSINK_V_INTERCEPT = 9,
+    IPK_TEMPERATURE_HEATSINK_W_SLOPE = 10,
+    IPK_TEMPERATURE_HEATSINK_W_INTERCEPT = 11,
+    IPK_TEMPERATURE_FILTER_COIL_U_SLOPE = 12,
+    IPK_TEMPERATURE_FILTER_COIL_U_INTERCEPT = 13,
+    IPK_TEMPERATURE_FILTER_COIL_V_SLOPE = 14,
+    IPK_TEMPERATURE_FILTER_COIL_V_INTERCEPT = 15,
+    IPK_TEMPERATURE_FILTER_COIL_W_SLOPE = 16,
+    IPK_TEMPERATURE_FILTER_COIL_W_INTERCEPT = 17,
+    IPK_TEMPERATURE_AMBIENT_SLOPE = 18,
+    IPK_TEMPERATURE_AMBIENT_INTERCEPT = 19,
+    IPK_VOLTAGE_BUS_SLOPE = 20,
+    IPK_VOLTAGE_BUS_INTERCEPT = 21,
+    IPK_VOLTAGE_BUS_MIDDLE_SLOPE = 22,
+    IPK_VOLTAGE_BUS_MIDDLE_INTERCEPT = 23,
+    IPK_VOLTAGE_GRID_U_SLOPE = 24,
+    IPK_VOLTAGE_GRID_U_INTERCEPT = 25,
+    IPK_VOLTAGE_GRID_V_SLOPE = 26,
+    IPK_VOLTAGE_GRID_V_INTERCEPT = 27,
+    IPK_VOLTAGE_GRID_W_SLOPE = 28,
+    IPK_VOLTAGE_GRID_W_INTERCEPT = 29,
+    IPK_VOLTAGE_U_SLOPE = 30,
+    IPK_VOLTAGE_U_INTERCEPT = 31,
+    IPK_VOLTAGE_V_SLOPE = 32,
+    IPK_VOLTAGE_V_INTERCEPT = 33,
+    IPK_VOLTAGE_W_SLOPE = 34,
+    IPK_VOLTAGE_W_INTERCEPT = 35,
+
+    IPK_COUNT
+} EVERT_INVERTER_ParameterKeyTypeDef;
+
+void EVERT_INVERTER_ParametersInit(void);
+EVERT_PARAM_STORE_StatusTypeDef EVERT_INVERTER_ParametersGet(const uint16_t key, float32_t *value);
+EVERT_PARAM_STORE_StatusTypeDef EVERT_INVERTER_ParametersSet(const uint16_t key, const float32_t value);
+EVERT_PARAM_STORE_StatusTypeDef EVERT_INVERTER_ParametersErase(const uint16_t key);
+
+#endif // EVERT_INVERTER_PARAMETERS_H_
@@ -107,6 +107,9 @@ volatile bool gpio_pwm_ready_bot1 = false;
 volatile bool gpio_pwm_ready_bot2 = false;
 volatile bool gpio_pwm_ready_bot3 = false;
 
+volatile uint32_t readings_hf_sample_count = 0;
+volatile uint32_t readings_lf_sample_count = 0;
+
 void EVERT_INVERTER_InitFilters(void)
 {
     arm_fir_init_f32(&filter_current_u, FILTER_TAP_NUM, fir_coeffs_32_100hz_cutoff, filter_current_u_state, SAMPLE_BLOCK_SIZE);
@@ -153,6 +156,11 @@ void EVERT_INVERTER_ISR_HF_Readings(void)
     uf_voltage_grid_v = EVERT_HAL_ADC_Lerp(adc_voltage_grid_v, calibration_voltage_grid.voltage_grid_v_slope, calibration_voltage_grid.voltage_grid_v_intercept);
     uf_voltage_grid_w = EVERT_HAL_ADC_Lerp(adc_voltage_grid_w, calibration_voltage_grid.voltage_grid_w_slope, calibration_voltage_grid.voltage_grid_w_intercept);
     uf_temperature_heatsink_u = EVERT_HAL_ADC_Lerp(adc_temperature_heatsink_u, calibration_temperature.temperature_heatsink_u_slope, calibration_temperature.temperature_heatsink_u_intercept);
+
+    if (readings_hf_sample_count < UINT32_MAX)
+    {
+        readings_hf_sample_count++;
+    }
 }
 
 void EVERT_INVERTER_ISR_LF_Readings(void)
@@ -187,4 +195,16 @@ void EVERT_INVERTER_ISR_LF_Readings(void)
     gpio_pwm_ready_bot1 = HAL_GPIO_ReadPin(GPIOD, GPIO_PIN_7) == GPIO_PIN_SET;
     gpio_pwm_ready_bot2 = HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_3) == GPIO_PIN_SET;
     gpio_pwm_ready_bot3 = HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_4) == GPIO_PIN_SET;
+
+    if (readings_lf_sample_count < UINT32_MAX)
+    {
+        readings_lf_sample_count++;
+    }
+}
+
+/// @brief Readings valid on both ISRs, ends DS_BOOTING_ADC
+bool EVERT_INVERTER_ReadingsSettled(void)
+{
+    return readings_hf_sample_count >= EVERT_CONSTANT_INVERTER_READINGS_SETTLE_HF_SAMPLES &&
+           readings_lf_sample_count >= EVERT_CONSTANT_INVERTER_READINGS_SETTLE_LF_SAMPLES;
 }
\ No newline at end of file
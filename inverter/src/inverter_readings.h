@@ -9,6 +9,10 @@
 #define FILTER_TAP_NUM 32
 #define SAMPLE_BLOCK_SIZE 10
 
+// Readings settled: the HF readings are unfiltered, the LF FIR takes SAMPLE_BLOCK_SIZE samples per pass (40 ms at 100 Hz)
+#define EVERT_CONSTANT_INVERTER_READINGS_SETTLE_HF_SAMPLES (1)
+#define EVERT_CONSTANT_INVERTER_READINGS_SETTLE_LF_SAMPLES ((FILTER_TAP_NUM + SAMPLE_BLOCK_SIZE - 1) / SAMPLE_BLOCK_SIZE)
+
 // ADC Buffers
 extern volatile uint16_t adc1_buffer[EVERT_CONSTANT_INVERTER_ADC1_CONVERSION_COUNT];
 extern volatile uint16_t adc2_buffer[EVERT_CONSTANT_INVERTER_ADC2_CONVERSION_COUNT];
@@ -112,10 +116,16 @@ extern volatile bool gpio_pwm_ready_bot1;
 extern volatile bool gpio_pwm_ready_bot2;
 extern volatile bool gpio_pwm_ready_bot3;
 
+// Readings since the ADCs started, saturate
+extern volatile uint32_t readings_hf_sample_count;
+extern volatile uint32_t readings_lf_sample_count;
+
 void EVERT_INVERTER_InitFilters(void);
 
 void EVERT_INVERTER_ISR_HF_Readings(void);
 
 void EVERT_INVERTER_ISR_LF_Readings(void);
 
+bool EVERT_INVERTER_ReadingsSettled(void);
+
 #endif // EVERT_INVERTER_READINGS_H_
\ No newline at end of file
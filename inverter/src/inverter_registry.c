@@ -0,0 +1,151 @@
+#include <string.h>
+
+#include "evert_device.h"
+#include "inverter_registry.h"
+#include "inverter_grid.h"
+#include "inverter_junction.h"
+#include "inverter_readings.h"
+#include "inverter_telemetry.h"
+#include "inverter_thermal.h"
+
+#define EVERT_INVERTER_REGISTRY_STREAM_SIZE (48)
+
+_Static_assert(sizeof(EVERT_INVERTER_RegistryReplyTypeDef) <= EVERT_TELEMETRY_PAYLOAD_MAX, "EVERT_HAL_CONF_TELEMETRY_PAYLOAD_MAX too small");
+_Static_assert(EVERT_INVERTER_REGISTRY_STREAM_SIZE <= EVERT_TELEMETRY_PAYLOAD_MAX, "EVERT_HAL_CONF_TELEMETRY_PAYLOAD_MAX too small");
+
+// Readings
+EVERT_REGISTRY_VARIABLE(IRV_BUS_VOLTAGE, fi_bus_voltage, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_BUS_VOLTAGE_MID, fi_bus_voltage_mid, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_CURRENT_U, fi_current_u, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_CURRENT_V, fi_current_v, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_CURRENT_W, fi_current_w, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_VOLTAGE_GRID_U, fi_voltage_grid_u, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_VOLTAGE_GRID_V, fi_voltage_grid_v, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_VOLTAGE_GRID_W, fi_voltage_grid_w, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_TEMPERATURE_AMBIENT, fi_temperature_ambient, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_MCU_TEMPERATURE, fi_mcu_temperature, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_BUS_VOLTAGE_RAW, uf_bus_voltage, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_CURRENT_U_RAW, uf_current_u, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_CURRENT_V_RAW, uf_current_v, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_CURRENT_W_RAW, uf_current_w, RGT_F32, RGA_READ);
+
+// Grid forming
+EVERT_REGISTRY_VARIABLE(IRV_DUTY_CYCLE_A, gf_duty_cycle_a_pu, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_DUTY_CYCLE_B, gf_duty_cycle_b_pu, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_DUTY_CYCLE_C, gf_duty_cycle_c_pu, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_ANGLE, gf_angle_radians, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_ID_REF, gf_id_ref, RGT_F32, RGA_READ_WRITE);
+EVERT_REGISTRY_VARIABLE(IRV_IQ_REF, gf_iq_ref, RGT_F32, RGA_READ_WRITE);
+EVERT_REGISTRY_VARIABLE(IRV_CURRENT_LIMIT, gf_current_limit, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_BUS_VOLTAGE_NOTCHED, gf_bus_voltage_notched, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_BUS_POWER_FEED_FORWARD, gf_bus_power_feed_forward, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_SRF_OUTPUT_FREQUENCY, gf_srf_output_frequency, RGT_F32, RGA_READ);
+
+// Thermal
+EVERT_REGISTRY_VARIABLE(IRV_TEMPERATURE_HEATSINK, th_temperature_heatsink, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_TEMPERATURE_COIL, th_temperature_coil, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_FAN_DEMAND, th_fan_demand, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_DERATING, th_derating, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_CURRENT_LIMIT_THERMAL, th_current_limit, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_FAN_FAILED_COUNT, th_fan_failed_count, RGT_U32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_TEMPERATURE_JUNCTION_MAX, tj_temperature_max, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_TEMPERATURE_JUNCTION_PREDICTED_MAX, tj_temperature_predicted_max, RGT_F32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_CURRENT_LIMIT_JUNCTION, tj_current_limit, RGT_F32, RGA_READ);
+
+// Boot phases in ms, time to operational after a reset
+EVERT_REGISTRY_VARIABLE(IRV_BOOT_INIT, device_boot_timing.InitMs, RGT_U32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_BOOT_ADC, device_boot_timing.AdcMs, RGT_U32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_BOOT_COMMS, device_boot_timing.CommsMs, RGT_U32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_BOOT_HANDSHAKE, device_boot_timing.HandshakeMs, RGT_U32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_BOOT_OPERATIONAL, device_boot_timing.OperationalMs, RGT_U32, RGA_READ);
+EVERT_REGISTRY_VARIABLE(IRV_BOOT_ADC_TIMEOUT, device_boot_timing.AdcTimeout, RGT_BOOL, RGA_READ);
+
+static void EVERT_INVERTER_RegistryDescribe(EVERT_INVERTER_RegistryReplyTypeDef *reply, const EVERT_REGISTRY_EntryTypeDef *entry)
+{
+    reply->id = entry->id;
+    reply->type = entry->type;
+    reply->access = entry->access;
+    reply->name_hash = entry->name_hash;
+}
+
+/// @brief ITS_REGISTRY_REQUEST from the host (main loop), one reply per request
+void EVERT_INVERTER_RegistryOnRequest(const uint8_t *payload, const uint32_t length)
+{
+    EVERT_INVERTER_RegistryRequestTypeDef request;
+
+    if (length < sizeof(request))
+    {
+        return;
+    }
+
+    memcpy(&request, payload, sizeof(request));
+
+    EVERT_INVERTER_RegistryReplyTypeDef reply;
+    memset(&reply, 0, sizeof(reply));
+    reply.operation = request.operation;
+    reply.id = request.id;
+
+    switch (request.operation)
+    {
+    case IRO_READ:
+        reply.status = EVERT_REGISTRY_Read(request.id, &reply.value);
+        break;
+    case IRO_WRITE:
+        reply.status = EVERT_REGISTRY_Write(request.id, request.value);
+
+        if (reply.status == RGS_OK)
+        {
+            // Read back, the host sees what the device holds now
+            EVERT_REGISTRY_Read(request.id, &reply.value);
+        }
+        break;
+    case IRO_SUBSCRIBE:
+        reply.value = request.value;
+        reply.status = (request.value == 0) ? EVERT_REGISTRY_Unsubscribe(request.id) : EVERT_REGISTRY_Subscribe(request.id, (uint16_t)(request.value > UINT16_MAX ? UINT16_MAX : request.value), &reply.slot);
+        break;
+    case IRO_LIST:
+    {
+        const EVERT_REGISTRY_EntryTypeDef *entry = EVERT_REGISTRY_GetEntry(request.id);
+
+        reply.status = (entry != NULL) ? RGS_OK : RGS_NOT_FOUND;
+        reply.value = EVERT_REGISTRY_GetCount();
+
+        if (entry != NULL)
+        {
+            EVERT_INVERTER_RegistryDescribe(&reply, entry);
+        }
+        break;
+    }
+    default:
+        reply.status = RGS_INVALID;
+        break;
+    }
+
+    const EVERT_REGISTRY_EntryTypeDef *entry = EVERT_REGISTRY_Find(request.id);
+
+    if (request.operation != IRO_LIST && entry != NULL)
+    {
+        EVERT_INVERTER_RegistryDescribe(&reply, entry);
+    }
+
+    EVERT_TELEMETRY_Send(&tm_telemetry, ITS_REGISTRY_REPLY, &reply, sizeof(reply));
+}
+
+void EVERT_INVERTER_RegistryInit(void)
+{
+    EVERT_REGISTRY_Init();
+}
+
+/// @brief Send the due subscriptions, call from the main loop before the telemetry is processed
+void EVERT_INVERTER_RegistryProcess(const uint32_t delta_ms)
+{
+    EVERT_REGISTRY_Update(delta_ms);
+
+    uint8_t buffer[EVERT_INVERTER_REGISTRY_STREAM_SIZE];
+    uint32_t length;
+
+    while ((length = EVERT_REGISTRY_Pack(buffer, sizeof(buffer))) > 0)
+    {
+        EVERT_TELEMETRY_Send(&tm_telemetry, ITS_REGISTRY_STREAM, buffer, length);
+    }
+}
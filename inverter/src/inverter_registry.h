@@ -0,0 +1,97 @@
+#ifndef EVERT_INVERTER_REGISTRY_H_
+#define EVERT_INVERTER_REGISTRY_H_
+
+#include <stdint.h>
+
+#include "_conf_evert_hal.h"
+#include "registry.h"
+
+// Remote variable access over the telemetry link (the inverter has no CAN, registry.h for the table)
+// * Host -> inverter: ITS_REGISTRY_REQUEST, answered with one ITS_REGISTRY_REPLY
+// * Subscriptions: ITS_REGISTRY_STREAM records, [slot][value]... packed (EVERT_REGISTRY_Pack)
+// Variable ids are used by the host, never renumber them (new ids go at the end of a group)
+
+typedef enum
+{
+    // Readings
+    IRV_BUS_VOLTAGE = 0x0001,
+    IRV_BUS_VOLTAGE_MID = 0x0002,
+    IRV_CURRENT_U = 0x0003,
+    IRV_CURRENT_V = 0x0004,
+    IRV_CURRENT_W = 0x0005,
+    IRV_VOLTAGE_GRID_U = 0x0006,
+    IRV_VOLTAGE_GRID_V = 0x0007,
+    IRV_VOLTAGE_GRID_W = 0x0008,
+    IRV_TEMPERATURE_AMBIENT = 0x0009,
+    IRV_MCU_TEMPERATURE = 0x000A,
+    IRV_BUS_VOLTAGE_RAW = 0x0010,
+    IRV_CURRENT_U_RAW = 0x0011,
+    IRV_CURRENT_V_RAW = 0x0012,
+    IRV_CURRENT_W_RAW = 0x0013,
+
+    // Grid forming
+    IRV_DUTY_CYCLE_A = 0x0100,
+    IRV_DUTY_CYCLE_B = 0x0101,
+    IRV_DUTY_CYCLE_C = 0x0102,
+    IRV_ANGLE = 0x0103,
+    IRV_ID_REF = 0x0104,
+    IRV_IQ_REF = 0x0105,
+    IRV_CURRENT_LIMIT = 0x0106,
+    IRV_BUS_VOLTAGE_NOTCHED = 0x0107,
+    IRV_BUS_POWER_FEED_FORWARD = 0x0108,
+    IRV_SRF_OUTPUT_FREQUENCY = 0x0109,
+
+    // Thermal
+    IRV_TEMPERATURE_HEATSINK = 0x0200,
+    IRV_TEMPERATURE_COIL = 0x0201,
+    IRV_FAN_DEMAND = 0x0202,
+    IRV_DERATING = 0x0203,
+    IRV_CURRENT_LIMIT_THERMAL = 0x0204,
+    IRV_FAN_FAILED_COUNT = 0x0205,
+    IRV_TEMPERATURE_JUNCTION_MAX = 0x0206,
+    IRV_TEMPERATURE_JUNCTION_PREDICTED_MAX = 0x0207,
+    IRV_CURRENT_LIMIT_JUNCTION = 0x0208,
+
+    // Boot (EVERT_DEVICE_BootTimingTypeDef)
+    IRV_BOOT_INIT = 0x0300,
+    IRV_BOOT_ADC = 0x0301,
+    IRV_BOOT_COMMS = 0x0302,
+    IRV_BOOT_HANDSHAKE = 0x0303,
+    IRV_BOOT_OPERATIONAL = 0x0304,
+    IRV_BOOT_ADC_TIMEOUT = 0x0305,
+} EVERT_INVERTER_RegistryIdTypeDef;
+
+typedef enum
+{
+    IRO_READ = 1,
+    IRO_WRITE = 2,
+    IRO_SUBSCRIBE = 3, // value = period (ms), 0 = unsubscribe (id 0xFFFF: all)
+    IRO_LIST = 4       // id = index in the table
+} EVERT_INVERTER_RegistryOperationTypeDef;
+
+typedef struct
+{
+    uint8_t operation; // EVERT_INVERTER_RegistryOperationTypeDef
+    uint8_t reserved;
+    uint16_t id;
+    uint32_t value;
+} EVERT_INVERTER_RegistryRequestTypeDef;
+
+typedef struct
+{
+    uint8_t operation;
+    uint8_t status; // EVERT_REGISTRY_StatusTypeDef
+    uint16_t id;
+    uint32_t value;
+    uint8_t type;   // EVERT_REGISTRY_TypeTypeDef
+    uint8_t access; // EVERT_REGISTRY_AccessTypeDef
+    uint8_t slot;   // Subscription slot the stream uses
+    uint8_t reserved;
+    uint32_t name_hash;
+} EVERT_INVERTER_RegistryReplyTypeDef;
+
+void EVERT_INVERTER_RegistryInit(void);
+void EVERT_INVERTER_RegistryOnRequest(const uint8_t *payload, const uint32_t length);
+void EVERT_INVERTER_RegistryProcess(const uint32_t delta_ms);
+
+#endif // EVERT_INVERTER_REGISTRY_H_
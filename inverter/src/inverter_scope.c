@@ -0,0 +1,135 @@
+#include "evert_device.h"
+#include "inverter_scope.h"
+#include "inverter_telemetry.h"
+#include "watchdog.h"
+
+_Static_assert(ISC_COUNT == EVERT_SCOPE_CHANNEL_COUNT, "EVERT_HAL_CONF_SCOPE_CHANNEL_COUNT must match ISC_COUNT");
+_Static_assert(sizeof(EVERT_INVERTER_ScopeSampleRecordTypeDef) <= EVERT_TELEMETRY_PAYLOAD_MAX, "EVERT_HAL_CONF_TELEMETRY_PAYLOAD_MAX too small for a scope sample");
+
+// Capture
+EVERT_SCOPE_HandlerTypeDef sc_scope;
+EVERT_SCOPE_SampleTypeDef sc_sample;
+static EVERT_SCOPE_SampleTypeDef sc_buffer[EVERT_SETTING_INVERTER_SCOPE_DEPTH];
+bool sc_pwm_fault_previous;
+uint32_t sc_alarms_previous;
+
+// Dump
+uint32_t sc_dump_index;
+bool sc_dump_active;
+
+void EVERT_INVERTER_ScopeInit(void)
+{
+    EVERT_SCOPE_Init(&sc_scope, sc_buffer, EVERT_SETTING_INVERTER_SCOPE_DEPTH, EVERT_SETTING_INVERTER_SCOPE_DECIMATION, EVERT_SETTING_INVERTER_SCOPE_PRE_TRIGGER);
+    sc_pwm_fault_previous = false;
+    sc_alarms_previous = 0;
+    sc_dump_active = false;
+    EVERT_SCOPE_Arm(&sc_scope);
+}
+
+void EVERT_INVERTER_ScopeSetThreshold(const EVERT_INVERTER_ScopeChannelTypeDef channel, const float32_t level, const EVERT_SCOPE_EdgeTypeDef edge)
+{
+    EVERT_SCOPE_SetThreshold(&sc_scope, channel, level, edge);
+}
+
+/// @brief Trigger on alarms, call from the LF ISR after the readings
+void EVERT_INVERTER_ScopeCheckAlarms(void)
+{
+    bool pwm_fault = gpio_pwm_fault;
+    uint32_t alarms = EVERT_DEVICE_Alarm_Get();
+
+    // The gate driver fault pin first, it is the more specific source when both come up together
+    if (pwm_fault && !sc_pwm_fault_previous)
+    {
+        EVERT_SCOPE_Trigger(&sc_scope, ISCT_PWM_FAULT);
+    }
+
+    // A bit newly set in the device alarm register, the alarms already standing do not trigger again
+    else if ((alarms & ~sc_alarms_previous) != 0)
+    {
+        EVERT_SCOPE_Trigger(&sc_scope, ISCT_ALARM);
+    }
+
+    sc_pwm_fault_previous = pwm_fault;
+    sc_alarms_previous = alarms;
+}
+
+static void EVERT_INVERTER_ScopeBuildHeader(EVERT_INVERTER_ScopeHeaderTypeDef *header)
+{
+    header->count = (uint16_t)sc_scope.count;
+    header->trigger_offset = (uint16_t)EVERT_SCOPE_GetTriggerOffset(&sc_scope);
+    header->decimation = (uint16_t)sc_scope.decimation;
+    header->channel_count = ISC_COUNT;
+    header->trigger_source = (uint8_t)sc_scope.trigger_source;
+    header->trigger_tick = sc_scope.trigger_tick;
+    header->sample_period = EVERT_CONSTANT_INVERTER_ISR_HF_PERIOD * sc_scope.decimation;
+}
+
+/// @brief Stream a frozen capture as the telemetry buffer drains, then re-arm
+/// @details Called from EVERT_INVERTER_TelemetryProcess, never blocks. Leaves room for the fast records.
+void EVERT_INVERTER_ScopeProcess(void)
+{
+    if (!EVERT_SCOPE_IsFrozen(&sc_scope))
+    {
+        return;
+    }
+
+    if (EVERT_TELEMETRY_GetFree(&tm_telemetry) < EVERT_TELEMETRY_BUFFER_SIZE / 2)
+    {
+        return;
+    }
+
+    if (!sc_dump_active)
+    {
+        EVERT_INVERTER_ScopeHeaderTypeDef header;
+        EVERT_INVERTER_ScopeBuildHeader(&header);
+
+        if (EVERT_TELEMETRY_Send(&tm_telemetry, ITS_SCOPE_HEADER, &header, sizeof(header)) == TMS_OK)
+        {
+            sc_dump_active = true;
+            sc_dump_index = 0;
+        }
+        return;
+    }
+
+    EVERT_INVERTER_ScopeSampleRecordTypeDef record = {.index = (uint16_t)sc_dump_index};
+
+    if (!EVERT_SCOPE_ReadSample(&sc_scope, sc_dump_index, &record.sample))
+    {
+        // All samples sent
+        sc_dump_active = false;
+        EVERT_SCOPE_Arm(&sc_scope);
+        return;
+    }
+
+    if (EVERT_TELEMETRY_Send(&tm_telemetry, ITS_SCOPE_SAMPLE, &record, sizeof(record)) == TMS_OK)
+    {
+        sc_dump_index++;
+    }
+}
+
+/// @brief Send the whole capture with polling, for the fatal error path (interrupts may be off)
+void EVERT_INVERTER_ScopeDumpBlocking(void)
+{
+    EVERT_INVERTER_ScopeHeaderTypeDef header;
+    EVERT_INVERTER_ScopeBuildHeader(&header);
+
+    if (EVERT_TELEMETRY_SendBlocking(&tm_telemetry, ITS_SCOPE_HEADER, &header, sizeof(header), EVERT_SETTING_INVERTER_SCOPE_UART_TIMEOUT_MS) != TMS_OK)
+    {
+        return;
+    }
+
+    EVERT_INVERTER_ScopeSampleRecordTypeDef record = {0};
+
+    for (uint32_t index = 0; EVERT_SCOPE_ReadSample(&sc_scope, index, &record.sample); index++)
+    {
+        record.index = (uint16_t)index;
+
+        // Outputs are off by now (EVERT_INVERTER_CommonErrorCallback), keep the watchdogs off the dump
+        EVERT_WATCHDOG_Feed();
+
+        if (EVERT_TELEMETRY_SendBlocking(&tm_telemetry, ITS_SCOPE_SAMPLE, &record, sizeof(record), EVERT_SETTING_INVERTER_SCOPE_UART_TIMEOUT_MS) != TMS_OK)
+        {
+            return;
+        }
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef EVERT_INVERTER_SCOPE_H_
+#define EVERT_INVERTER_SCOPE_H_
+
+#include <arm_math.h>
+#include <stdbool.h>
+
+#include "_conf_evert_hal.h"
+#include "_conf_evert_inverter.h"
+#include "inverter_grid.h"
+#include "inverter_readings.h"
+#include "scope.h"
+
+// Waveform capture of the HF signals (scope.h)
+// * Recorded at the end of the HF ISR, decimated by EVERT_SETTING_INVERTER_SCOPE_DECIMATION
+// * Triggers: PWM fault (LF ISR), optional threshold (EVERT_INVERTER_ScopeSetThreshold), fatal errors freeze it
+// * Dump over the telemetry link (inverter_telemetry.h)
+//   * ITS_SCOPE_HEADER: EVERT_INVERTER_ScopeHeaderTypeDef
+//   * ITS_SCOPE_SAMPLE: EVERT_INVERTER_ScopeSampleRecordTypeDef, index 0..count-1 oldest first, float32 per ISC_* channel
+// * Non-fatal triggers are dumped from the main loop and re-armed, fatal errors dump blocking before halting
+
+typedef enum
+{
+    ISC_CURRENT_U = 0,
+    ISC_CURRENT_V = 1,
+    ISC_CURRENT_W = 2,
+    ISC_VOLTAGE_GRID_U = 3,
+    ISC_VOLTAGE_GRID_V = 4,
+    ISC_VOLTAGE_GRID_W = 5,
+    ISC_DUTY_A = 6,
+    ISC_DUTY_B = 7,
+    ISC_DUTY_C = 8,
+    ISC_THETA = 9,
+    ISC_COUNT = 10
+} EVERT_INVERTER_ScopeChannelTypeDef;
+
+typedef enum
+{
+    ISCT_THRESHOLD = EVERT_SCOPE_TRIGGER_SOURCE_THRESHOLD,
+    ISCT_PWM_FAULT = 1,
+    ISCT_ERROR = 2,
+    ISCT_MANUAL = 3,
+    ISCT_ALARM = 4
+} EVERT_INVERTER_ScopeTriggerTypeDef;
+
+typedef struct
+{
+    uint16_t count;
+    uint16_t trigger_offset;
+    uint16_t decimation;
+    uint8_t channel_count;
+    uint8_t trigger_source;
+    uint32_t trigger_tick;
+    float32_t sample_period; // s
+} EVERT_INVERTER_ScopeHeaderTypeDef;
+
+typedef struct
+{
+    uint16_t index;
+    uint16_t reserved;
+    EVERT_SCOPE_SampleTypeDef sample;
+} EVERT_INVERTER_ScopeSampleRecordTypeDef;
+
+extern EVERT_SCOPE_HandlerTypeDef sc_scope;
+extern EVERT_SCOPE_SampleTypeDef sc_sample; // Staging sample, filled in the HF ISR
+extern bool sc_pwm_fault_previous;
+extern uint32_t sc_alarms_previous;
+extern uint32_t sc_dump_index; // Next sample to send, the header goes first
+extern bool sc_dump_active;
+
+void EVERT_INVERTER_ScopeInit(void);
+void EVERT_INVERTER_ScopeSetThreshold(const EVERT_INVERTER_ScopeChannelTypeDef channel, const float32_t level, const EVERT_SCOPE_EdgeTypeDef edge);
+void EVERT_INVERTER_ScopeCheckAlarms(void);
+void EVERT_INVERTER_ScopeProcess(void);
+void EVERT_INVERTER_ScopeDumpBlocking(void);
+
+static inline void EVERT_INVERTER_ScopeRecord(void)
+{
+    sc_sample.channel[ISC_CURRENT_U] = uf_current_u;
+    sc_sample.channel[ISC_CURRENT_V] = uf_current_v;
+    sc_sample.channel[ISC_CURRENT_W] = uf_current_w;
+    sc_sample.channel[ISC_VOLTAGE_GRID_U] = uf_voltage_grid_u;
+    sc_sample.channel[ISC_VOLTAGE_GRID_V] = uf_voltage_grid_v;
+    sc_sample.channel[ISC_VOLTAGE_GRID_W] = uf_voltage_grid_w;
+    sc_sample.channel[ISC_DUTY_A] = gf_duty_cycle_a_pu;
+    sc_sample.channel[ISC_DUTY_B] = gf_duty_cycle_b_pu;
+    sc_sample.channel[ISC_DUTY_C] = gf_duty_cycle_c_pu;
+    sc_sample.channel[ISC_THETA] = gf_angle_radians;
+
+    EVERT_SCOPE_Record(&sc_scope, &sc_sample);
+}
+
+#endif // EVERT_INVERTER_SCOPE_H_
@@ -0,0 +1,101 @@
+#include "inverter_telemetry.h"
+#include "inverter_fault.h"
+#include "inverter_junction.h"
+#include "inverter_registry.h"
+#include "inverter_scope.h"
+#include "inverter_thermal.h"
+#include "usart.h"
+
+_Static_assert(sizeof(EVERT_INVERTER_TelemetryFastTypeDef) <= EVERT_TELEMETRY_PAYLOAD_MAX, "EVERT_HAL_CONF_TELEMETRY_PAYLOAD_MAX too small");
+_Static_assert(sizeof(EVERT_INVERTER_TelemetrySlowTypeDef) <= EVERT_TELEMETRY_PAYLOAD_MAX, "EVERT_HAL_CONF_TELEMETRY_PAYLOAD_MAX too small");
+
+// Link
+EVERT_TELEMETRY_HandlerTypeDef tm_telemetry;
+
+// Fast record queue (HF ISR -> main loop)
+EVERT_INVERTER_TelemetryFastTypeDef tm_queue[EVERT_SETTING_INVERTER_TELEMETRY_QUEUE_SIZE];
+volatile uint32_t tm_queue_head;
+volatile uint32_t tm_queue_tail;
+uint32_t tm_queue_drop_count;
+uint32_t tm_sample;
+uint32_t tm_decimation;
+
+// Slow records
+uint32_t tm_slow_tick;
+
+/// @brief Host requests, called from EVERT_TELEMETRY_Process (main loop)
+static void EVERT_INVERTER_TelemetryOnReceive(const uint8_t schema, const uint8_t *payload, const uint32_t length)
+{
+    switch (schema)
+    {
+    case ITS_REGISTRY_REQUEST:
+        EVERT_INVERTER_RegistryOnRequest(payload, length);
+        break;
+    case ITS_FAULT_REQUEST:
+        EVERT_INVERTER_FaultOnRequest(payload, length);
+        break;
+    default:
+        break;
+    }
+}
+
+void EVERT_INVERTER_TelemetryInit(void)
+{
+    EVERT_TELEMETRY_Init(&tm_telemetry, &hlpuart1);
+    EVERT_TELEMETRY_StartReceive(&tm_telemetry, EVERT_INVERTER_TelemetryOnReceive);
+
+    tm_queue_head = 0;
+    tm_queue_tail = 0;
+    tm_queue_drop_count = 0;
+    tm_sample = 0;
+    tm_decimation = 0;
+    tm_slow_tick = HAL_GetTick();
+}
+
+static void EVERT_INVERTER_TelemetrySendSlow(void)
+{
+    EVERT_INVERTER_TelemetrySlowTypeDef record;
+
+    record.temperature_heatsink = th_temperature_heatsink;
+    record.temperature_coil = th_temperature_coil;
+    record.temperature_ambient = fi_temperature_ambient;
+    record.temperature_junction_max = tj_temperature_max;
+    record.fan_demand = th_fan_demand;
+    record.derating = th_derating;
+    record.current_limit_thermal = th_current_limit;
+    record.current_limit_junction = tj_current_limit;
+    record.fan_failed_count = th_fan_failed_count;
+    record.drop_count = tm_queue_drop_count + tm_telemetry.drop_count;
+    record.error_count = tm_telemetry.error_count;
+
+    EVERT_TELEMETRY_Send(&tm_telemetry, ITS_SLOW, &record, sizeof(record));
+}
+
+/// @brief Encode the queued records and keep the UART busy, call from the main loop
+void EVERT_INVERTER_TelemetryProcess(void)
+{
+    uint32_t tail = tm_queue_tail;
+
+    while (tail != tm_queue_head)
+    {
+        // A full UART buffer drops the record (counted), the queue never backs up into the ISR
+        EVERT_TELEMETRY_Send(&tm_telemetry, ITS_FAST, &tm_queue[tail], sizeof(EVERT_INVERTER_TelemetryFastTypeDef));
+
+        tail = (tail + 1 < EVERT_SETTING_INVERTER_TELEMETRY_QUEUE_SIZE) ? tail + 1 : 0;
+        tm_queue_tail = tail;
+    }
+
+    uint32_t tick = HAL_GetTick();
+
+    if (tick - tm_slow_tick >= EVERT_SETTING_INVERTER_TELEMETRY_SLOW_PERIOD_MS)
+    {
+        tm_slow_tick = tick;
+        EVERT_INVERTER_TelemetrySendSlow();
+    }
+
+    // Scope captures and fault records share the link, sent as the buffer drains
+    EVERT_INVERTER_ScopeProcess();
+    EVERT_INVERTER_FaultProcess();
+
+    EVERT_TELEMETRY_Process(&tm_telemetry);
+}
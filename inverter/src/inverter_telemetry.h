@@ -0,0 +1,117 @@
+#ifndef EVERT_INVERTER_TELEMETRY_H_
+#define EVERT_INVERTER_TELEMETRY_H_
+
+#include <arm_math.h>
+#include <stdbool.h>
+
+#include "_conf_evert_hal.h"
+#include "_conf_evert_inverter.h"
+#include "inverter_grid.h"
+#include "inverter_readings.h"
+#include "telemetry.h"
+
+// Binary telemetry over LPUART1 (telemetry.h: COBS frames, CRC-32, TX DMA double buffer)
+// * ITS_FAST: HF signals at 1 kHz, snapshotted in the HF ISR into a queue, encoded in the main loop
+// * ITS_SLOW: temperatures, fans, derating and link statistics every EVERT_SETTING_INVERTER_TELEMETRY_SLOW_PERIOD_MS
+// * ITS_SCOPE_*: captures (inverter_scope.h)
+// * ITS_REGISTRY_*: remote variable access, requests come in on the same UART (inverter_registry.h)
+// * ITS_FAULT_*: fault records (inverter_fault.h)
+// Decoder: utils/telemetry_decoder.py, keep its schema table in sync with the structs below
+
+typedef enum
+{
+    ITS_FAST = 1,
+    ITS_SLOW = 2,
+    ITS_SCOPE_HEADER = 3,
+    ITS_SCOPE_SAMPLE = 4,
+    ITS_REGISTRY_REQUEST = 5, // Host -> inverter (inverter_registry.h)
+    ITS_REGISTRY_REPLY = 6,
+    ITS_REGISTRY_STREAM = 7,
+    ITS_FAULT_REQUEST = 8, // Host -> inverter (inverter_fault.h)
+    ITS_FAULT_CHUNK = 9
+} EVERT_INVERTER_TelemetrySchemaTypeDef;
+
+typedef struct
+{
+    uint32_t sample; // HF ISR count
+    float32_t current_u;
+    float32_t current_v;
+    float32_t current_w;
+    float32_t voltage_grid_u;
+    float32_t voltage_grid_v;
+    float32_t voltage_grid_w;
+    float32_t bus_voltage;
+    float32_t bus_voltage_mid;
+    float32_t duty_a;
+    float32_t duty_b;
+    float32_t duty_c;
+    float32_t theta;
+} EVERT_INVERTER_TelemetryFastTypeDef;
+
+typedef struct
+{
+    float32_t temperature_heatsink;
+    float32_t temperature_coil;
+    float32_t temperature_ambient;
+    float32_t temperature_junction_max;
+    float32_t fan_demand;
+    float32_t derating;
+    float32_t current_limit_thermal;
+    float32_t current_limit_junction;
+    uint32_t fan_failed_count;
+    uint32_t drop_count; // Telemetry records dropped (queue or UART buffer full)
+    uint32_t error_count;
+} EVERT_INVERTER_TelemetrySlowTypeDef;
+
+extern EVERT_TELEMETRY_HandlerTypeDef tm_telemetry;
+extern EVERT_INVERTER_TelemetryFastTypeDef tm_queue[EVERT_SETTING_INVERTER_TELEMETRY_QUEUE_SIZE];
+extern volatile uint32_t tm_queue_head; // Written by the HF ISR
+extern volatile uint32_t tm_queue_tail; // Written by the main loop
+extern uint32_t tm_queue_drop_count;
+extern uint32_t tm_sample;
+extern uint32_t tm_decimation;
+extern uint32_t tm_slow_tick;
+
+void EVERT_INVERTER_TelemetryInit(void);
+void EVERT_INVERTER_TelemetryProcess(void);
+
+/// @brief Snapshot the HF signals, call at the end of the HF ISR
+static inline void EVERT_INVERTER_TelemetryRecord(void)
+{
+    tm_sample++;
+
+    if (++tm_decimation < EVERT_SETTING_INVERTER_TELEMETRY_FAST_DECIMATION)
+    {
+        return;
+    }
+
+    tm_decimation = 0;
+
+    uint32_t head = tm_queue_head;
+    uint32_t next = (head + 1 < EVERT_SETTING_INVERTER_TELEMETRY_QUEUE_SIZE) ? head + 1 : 0;
+
+    if (next == tm_queue_tail)
+    {
+        tm_queue_drop_count++;
+        return;
+    }
+
+    EVERT_INVERTER_TelemetryFastTypeDef *record = &tm_queue[head];
+    record->sample = tm_sample;
+    record->current_u = uf_current_u;
+    record->current_v = uf_current_v;
+    record->current_w = uf_current_w;
+    record->voltage_grid_u = uf_voltage_grid_u;
+    record->voltage_grid_v = uf_voltage_grid_v;
+    record->voltage_grid_w = uf_voltage_grid_w;
+    record->bus_voltage = uf_bus_voltage;
+    record->bus_voltage_mid = uf_bus_voltage_mid;
+    record->duty_a = gf_duty_cycle_a_pu;
+    record->duty_b = gf_duty_cycle_b_pu;
+    record->duty_c = gf_duty_cycle_c_pu;
+    record->theta = gf_angle_radians;
+
+    tm_queue_head = next;
+}
+
+#endif // EVERT_INVERTER_TELEMETRY_H_
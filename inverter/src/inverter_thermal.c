@@ -0,0 +1,192 @@
+#include "inverter_thermal.h"
+#include "inverter_constraints.h"
+#include "inverter_math.h"
+#include "inverter_readings.h"
+
+// Temperatures
+float32_t th_temperature_heatsink;
+float32_t th_temperature_coil;
+float32_t th_temperature_heatsink_rate;
+float32_t th_temperature_coil_rate;
+float32_t th_temperature_heatsink_predicted;
+float32_t th_temperature_coil_predicted;
+
+// Fans
+EVERT_PID_StateTypeDef th_pi_state_fan;
+EVERT_PID_StateTypeDef th_pi_state_fan_rpm[EMC230X_FAN_COUNT];
+float32_t th_fan_demand;
+float32_t th_fan_rpm_target;
+float32_t th_fan_setting[EMC230X_FAN_COUNT];
+float32_t th_fan_stall_time[EMC230X_FAN_COUNT];
+bool th_fan_failed[EMC230X_FAN_COUNT];
+uint32_t th_fan_failed_count;
+
+// Derating
+float32_t th_derating;
+float32_t th_current_limit;
+uint32_t th_decimation;
+
+static inline float32_t EVERT_INVERTER_ThermalMax3(const float32_t a, const float32_t b, const float32_t c)
+{
+    float32_t max = (a > b) ? a : b;
+    return (max > c) ? max : c;
+}
+
+static inline float32_t EVERT_INVERTER_ThermalMin3(const float32_t a, const float32_t b, const float32_t c)
+{
+    float32_t min = (a < b) ? a : b;
+    return (min < c) ? min : c;
+}
+
+/// @brief Linear ramp from 0 at start to 1 at full
+static inline float32_t EVERT_INVERTER_ThermalRamp(const float32_t value, const float32_t start, const float32_t full)
+{
+    float32_t ramp = (value - start) / (full - start);
+    return EVERT_INVERTER_MATH_CLAMP(ramp, 0.0f, 1.0f);
+}
+
+/// @brief Current fraction allowed for a predicted temperature, 1 up to (warning - margin), DERATE_MIN at the warning
+static inline float32_t EVERT_INVERTER_ThermalDerating(const float32_t predicted, const float32_t warning, const float32_t margin)
+{
+    float32_t ramp = EVERT_INVERTER_ThermalRamp(predicted, warning - margin, warning);
+    return 1.0f - (ramp * (1.0f - EVERT_SETTING_INVERTER_THERMAL_DERATE_MIN));
+}
+
+void EVERT_INVERTER_ThermalInit(void)
+{
+    th_temperature_heatsink = EVERT_INVERTER_ThermalMax3(uf_temperature_heatsink_u, uf_temperature_heatsink_v, uf_temperature_heatsink_w);
+    th_temperature_coil = EVERT_INVERTER_ThermalMax3(uf_temperature_filter_coil_u, uf_temperature_filter_coil_v, uf_temperature_filter_coil_w);
+    th_temperature_heatsink_rate = 0;
+    th_temperature_coil_rate = 0;
+    th_temperature_heatsink_predicted = th_temperature_heatsink;
+    th_temperature_coil_predicted = th_temperature_coil;
+
+    EVERT_PID_Init(&th_pi_state_fan, EVERT_SETTING_INVERTER_THERMAL_FAN_KP, EVERT_SETTING_INVERTER_THERMAL_FAN_KI, 0.0f, EVERT_SETTING_INVERTER_THERMAL_PERIOD, 0.0f, 1.0f);
+
+    for (uint32_t i = 0; i < EMC230X_FAN_COUNT; i++)
+    {
+        EVERT_PID_Init(&th_pi_state_fan_rpm[i], EVERT_SETTING_INVERTER_THERMAL_FAN_RPM_KP, EVERT_SETTING_INVERTER_THERMAL_FAN_RPM_KI, 0.0f, EVERT_SETTING_INVERTER_THERMAL_PERIOD, 0.0f, 255.0f);
+        th_fan_setting[i] = 0;
+        th_fan_stall_time[i] = 0;
+        th_fan_failed[i] = false;
+    }
+
+    th_fan_demand = EVERT_SETTING_INVERTER_THERMAL_FAN_DEMAND_MIN;
+    th_fan_rpm_target = 0;
+    th_fan_failed_count = 0;
+
+    th_derating = 1.0f;
+    th_current_limit = EVERT_SETTING_INVERTER_CURRENT_INSTANTANEOUS_MAX;
+    th_decimation = 0;
+}
+
+static inline void EVERT_INVERTER_ThermalUpdateTemperatures(void)
+{
+    float32_t heatsink = EVERT_INVERTER_ThermalMax3(uf_temperature_heatsink_u, uf_temperature_heatsink_v, uf_temperature_heatsink_w);
+    float32_t coil = EVERT_INVERTER_ThermalMax3(uf_temperature_filter_coil_u, uf_temperature_filter_coil_v, uf_temperature_filter_coil_w);
+
+    float32_t heatsink_previous = th_temperature_heatsink;
+    float32_t coil_previous = th_temperature_coil;
+
+    EVERT_INVERTER_MATH_EMA(heatsink, th_temperature_heatsink, EVERT_SETTING_INVERTER_THERMAL_TEMPERATURE_EMA);
+    EVERT_INVERTER_MATH_EMA(coil, th_temperature_coil, EVERT_SETTING_INVERTER_THERMAL_TEMPERATURE_EMA);
+
+    float32_t heatsink_rate = (th_temperature_heatsink - heatsink_previous) / EVERT_SETTING_INVERTER_THERMAL_PERIOD;
+    float32_t coil_rate = (th_temperature_coil - coil_previous) / EVERT_SETTING_INVERTER_THERMAL_PERIOD;
+
+    EVERT_INVERTER_MATH_EMA(heatsink_rate, th_temperature_heatsink_rate, EVERT_SETTING_INVERTER_THERMAL_RATE_EMA);
+    EVERT_INVERTER_MATH_EMA(coil_rate, th_temperature_coil_rate, EVERT_SETTING_INVERTER_THERMAL_RATE_EMA);
+
+    // Only a rising temperature pulls the prediction forward, cooling down is left to the recovery rate
+    th_temperature_heatsink_predicted = th_temperature_heatsink + ((th_temperature_heatsink_rate > 0.0f) ? th_temperature_heatsink_rate * EVERT_SETTING_INVERTER_THERMAL_DERATE_HORIZON : 0.0f);
+    th_temperature_coil_predicted = th_temperature_coil + ((th_temperature_coil_rate > 0.0f) ? th_temperature_coil_rate * EVERT_SETTING_INVERTER_THERMAL_DERATE_HORIZON : 0.0f);
+}
+
+static inline void EVERT_INVERTER_ThermalUpdateFans(void)
+{
+    // Curve on both sensors, the PI pushes harder when the heatsink sits above the target anyway
+    float32_t curve_heatsink = EVERT_INVERTER_ThermalRamp(th_temperature_heatsink, EVERT_SETTING_INVERTER_THERMAL_FAN_HEATSINK_START, EVERT_SETTING_INVERTER_THERMAL_FAN_HEATSINK_FULL);
+    float32_t curve_coil = EVERT_INVERTER_ThermalRamp(th_temperature_coil, EVERT_SETTING_INVERTER_THERMAL_FAN_COIL_START, EVERT_SETTING_INVERTER_THERMAL_FAN_COIL_FULL);
+    float32_t curve = (curve_heatsink > curve_coil) ? curve_heatsink : curve_coil;
+
+    // Temperature above the target is a positive error (T - Ttarget)
+    float32_t trim = EVERT_PID_Update(&th_pi_state_fan, th_temperature_heatsink, EVERT_SETTING_INVERTER_THERMAL_FAN_TARGET, 0.0f);
+
+    th_fan_demand = curve + trim;
+    EVERT_INVERTER_MATH_CLAMP(th_fan_demand, EVERT_SETTING_INVERTER_THERMAL_FAN_DEMAND_MIN, 1.0f);
+
+    // Remaining fans make up for a failed one
+    if (th_fan_failed_count > 0 || gpio_fan_fault)
+    {
+        th_fan_demand = 1.0f;
+    }
+
+    th_fan_rpm_target = th_fan_demand * EVERT_SETTING_INVERTER_THERMAL_FAN_RPM_MAX;
+    th_fan_failed_count = 0;
+
+    for (uint32_t i = 0; i < EMC230X_FAN_COUNT; i++)
+    {
+        EVERT_EMC230X_Fan fan = (EVERT_EMC230X_Fan)(EVERT_EMC230X_FAN1 + i);
+        float32_t rpm = (float32_t)EVERT_EMC230X_GetRpm(fan);
+
+        // RPM loop with the open loop setting as feed-forward, fan curves differ between batches
+        th_fan_setting[i] = EVERT_PID_Update(&th_pi_state_fan_rpm[i], th_fan_rpm_target, rpm, th_fan_demand * 255.0f);
+
+        // Stall detection, a driven fan without tach pulses
+        if (th_fan_setting[i] >= EVERT_SETTING_INVERTER_THERMAL_FAN_FAIL_SETTING_MIN && rpm < EVERT_SETTING_INVERTER_THERMAL_FAN_FAIL_RPM_MIN)
+        {
+            th_fan_stall_time[i] += EVERT_SETTING_INVERTER_THERMAL_PERIOD;
+        }
+        else
+        {
+            th_fan_stall_time[i] = 0;
+        }
+
+        th_fan_failed[i] = th_fan_stall_time[i] >= EVERT_SETTING_INVERTER_THERMAL_FAN_FAIL_TIME;
+        th_fan_failed_count += th_fan_failed[i] ? 1 : 0;
+
+        EVERT_EMC230X_SetFanSpeed_IT(fan, (uint8_t)th_fan_setting[i]);
+    }
+
+    // Results land in the next run
+    EVERT_EMC230X_ReadTachs_IT();
+}
+
+static inline void EVERT_INVERTER_ThermalUpdateDerating(void)
+{
+    float32_t margin = EVERT_SETTING_INVERTER_THERMAL_DERATE_MARGIN;
+
+    if (th_fan_failed_count > 0 || gpio_fan_fault)
+    {
+        margin += EVERT_SETTING_INVERTER_THERMAL_DERATE_FAN_FAIL_OFFSET;
+    }
+
+    float32_t heatsink_warning = EVERT_INVERTER_ThermalMin3(constraints_temperature_heatsink.heatsink_u_warning, constraints_temperature_heatsink.heatsink_v_warning, constraints_temperature_heatsink.heatsink_w_warning);
+    float32_t coil_warning = EVERT_INVERTER_ThermalMin3(constraints_temperature_filter.filter_coil_u_warning, constraints_temperature_filter.filter_coil_v_warning, constraints_temperature_filter.filter_coil_w_warning);
+
+    float32_t derating_heatsink = EVERT_INVERTER_ThermalDerating(th_temperature_heatsink_predicted, heatsink_warning, margin);
+    float32_t derating_coil = EVERT_INVERTER_ThermalDerating(th_temperature_coil_predicted, coil_warning, margin);
+    float32_t derating = (derating_heatsink < derating_coil) ? derating_heatsink : derating_coil;
+
+    // Derate immediately, recover slowly so the limit does not hunt with the heatsink time constant
+    float32_t recovery = EVERT_SETTING_INVERTER_THERMAL_DERATE_RECOVERY_RATE * EVERT_SETTING_INVERTER_THERMAL_PERIOD;
+    th_derating = (derating < th_derating) ? derating : ((derating > th_derating + recovery) ? th_derating + recovery : derating);
+
+    // Applied together with the junction limit (inverter_junction.c), which runs much faster
+    th_current_limit = th_derating * EVERT_SETTING_INVERTER_CURRENT_INSTANTANEOUS_MAX;
+}
+
+void EVERT_INVERTER_ThermalRun(void)
+{
+    // Runs from the LF ISR, decimated to EVERT_SETTING_INVERTER_THERMAL_PERIOD
+    if (++th_decimation < EVERT_SETTING_INVERTER_THERMAL_DECIMATION)
+    {
+        return;
+    }
+
+    th_decimation = 0;
+
+    EVERT_INVERTER_ThermalUpdateTemperatures();
+    EVERT_INVERTER_ThermalUpdateFans();
+    EVERT_INVERTER_ThermalUpdateDerating();
+}
@@ -0,0 +1,45 @@
+#ifndef EVERT_INVERTER_THERMAL_H_
+#define EVERT_INVERTER_THERMAL_H_
+
+#include <arm_math.h>
+#include <stdbool.h>
+
+#include "_conf_evert_hal.h"
+#include "_conf_evert_inverter.h"
+#include "emc230x.h"
+#include "pid_controller.h"
+
+// Thermal management, run from the LF ISR (decimated to EVERT_SETTING_INVERTER_THERMAL_PERIOD)
+// * Fan demand: curve on the hottest heatsink/filter coil + PI on the heatsink temperature
+// * Fan speed: RPM closed loop per fan on the EMC230X tach readings
+// * Fan failure: no tach while driven, the other fans go to full demand and the derating starts earlier
+// * Derating: heatsink/coil temperature extrapolated over a horizon limits the current reference before the warnings trip
+//   (th_derating scales the junction limit, see inverter_junction.h)
+
+// Temperatures
+extern float32_t th_temperature_heatsink;           // Hottest heatsink (°C), smoothed
+extern float32_t th_temperature_coil;               // Hottest filter coil (°C), smoothed
+extern float32_t th_temperature_heatsink_rate;      // K/s
+extern float32_t th_temperature_coil_rate;          // K/s
+extern float32_t th_temperature_heatsink_predicted; // Extrapolated over EVERT_SETTING_INVERTER_THERMAL_DERATE_HORIZON
+extern float32_t th_temperature_coil_predicted;
+
+// Fans
+extern EVERT_PID_StateTypeDef th_pi_state_fan;
+extern EVERT_PID_StateTypeDef th_pi_state_fan_rpm[EMC230X_FAN_COUNT];
+extern float32_t th_fan_demand;                     // 0 - 1
+extern float32_t th_fan_rpm_target;
+extern float32_t th_fan_setting[EMC230X_FAN_COUNT]; // EMC230X fan setting (0 - 255)
+extern float32_t th_fan_stall_time[EMC230X_FAN_COUNT];
+extern bool th_fan_failed[EMC230X_FAN_COUNT];
+extern uint32_t th_fan_failed_count;
+
+// Derating
+extern float32_t th_derating;      // Current fraction, 1 = no derating
+extern float32_t th_current_limit; // A
+extern uint32_t th_decimation;
+
+void EVERT_INVERTER_ThermalInit(void);
+void EVERT_INVERTER_ThermalRun(void);
+
+#endif // EVERT_INVERTER_THERMAL_H_
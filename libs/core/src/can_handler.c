@@ -1,6 +1,8 @@
 #include <string.h>
 #include <stm32g4xx_hal.h>
 #include "can_handler.h"
+#include "evert_hal_dwt.h"
+#include "fault_record.h"
 
 void EVERT_CAN_Identifier_CreateNew(EVERT_CAN_IdentifierTypeDef *identifier)
 {
@@ -127,6 +129,8 @@ EVERT_CAN_FifoStatusTypeDef EVERT_CAN_FifoBuffer_Push(EVERT_CAN_FifoBufferTypeDe
     }
 
     buffer->buffer[buffer->head].frame = frame;
+    buffer->buffer[buffer->head].timestamp = EVERT_HAL_DWT_GetCycles();
+    buffer->buffer[buffer->head].start_of_frame = buffer->buffer[buffer->head].timestamp;
     buffer->head = (buffer->head + 1) % buffer->size;
     buffer->count++;
 
@@ -147,6 +151,118 @@ EVERT_CAN_FifoStatusTypeDef EVERT_CAN_FifoBuffer_Pop(EVERT_CAN_FifoBufferTypeDef
     return CAN_FS_OK;
 }
 
+//
+// #region "Statistics"
+//
+
+static uint32_t EVERT_CAN_Statistics_CyclesToUs(const uint32_t cycles)
+{
+    uint32_t cycles_per_us = SystemCoreClock / 1000000u;
+    return cycles / (cycles_per_us > 0 ? cycles_per_us : 1);
+}
+
+/// @brief Nominal bit rate from the bit timing of the handle and the FDCAN kernel clock
+static uint32_t EVERT_CAN_Statistics_Bitrate(const FDCAN_HandleTypeDef *hfdcan)
+{
+    uint32_t divider = hfdcan->Init.ClockDivider == FDCAN_CLOCK_DIV1 ? 1 : 2 * hfdcan->Init.ClockDivider;
+    uint32_t bit_time = hfdcan->Init.NominalPrescaler * (1 + hfdcan->Init.NominalTimeSeg1 + hfdcan->Init.NominalTimeSeg2);
+
+    return bit_time > 0 ? HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_FDCAN) / divider / bit_time : 0;
+}
+
+/// @brief Frame through the Rx or the Tx buffer, main loop
+static void EVERT_CAN_Statistics_CountFrame(EVERT_CAN_StatisticsTypeDef *statistics, const bool is_tx, const EVERT_CAN_FrameTypeDef *frame, const uint32_t timestamp)
+{
+    uint8_t method = frame->data.length > 0 ? frame->data.data[0] : 0;
+    uint32_t slot = method < EVERT_CAN_STATISTICS_METHOD_COUNT ? method : EVERT_CAN_STATISTICS_METHOD_COUNT - 1;
+    uint32_t wait_us = EVERT_CAN_Statistics_CyclesToUs(EVERT_HAL_DWT_GetCycles() - timestamp);
+
+    if (is_tx)
+    {
+        statistics->tx_frame_count++;
+        statistics->tx_byte_count += frame->data.length;
+        statistics->tx_method_count[slot]++;
+        statistics->tx_wait_max_us = wait_us > statistics->tx_wait_max_us ? wait_us : statistics->tx_wait_max_us;
+        statistics->window_tx_wait_us += wait_us;
+        statistics->window_tx_wait_count++;
+    }
+    else
+    {
+        statistics->rx_frame_count++;
+        statistics->rx_byte_count += frame->data.length;
+        statistics->rx_method_count[slot]++;
+        statistics->rx_wait_max_us = wait_us > statistics->rx_wait_max_us ? wait_us : statistics->rx_wait_max_us;
+        statistics->window_rx_wait_us += wait_us;
+        statistics->window_rx_wait_count++;
+    }
+
+    statistics->window_frame_count++;
+}
+
+/// @brief Count a push into the Rx or the Tx buffer
+static void EVERT_CAN_Statistics_CountPush(const EVERT_CAN_FifoBufferTypeDef *buffer, const EVERT_CAN_FifoStatusTypeDef status, uint16_t *high_water, uint32_t *full_count)
+{
+    if (status == CAN_FS_FULL)
+    {
+        (*full_count)++;
+    }
+    else if (buffer->count > *high_water)
+    {
+        *high_water = (uint16_t)buffer->count;
+    }
+}
+
+/// @brief Close the statistics window every EVERT_CAN_STATISTICS_WINDOW_MS: bus load, averages, error counters
+/// @param delta_ms Time since the last call, main loop
+/// @return true if a window closed, the statistics are fresh
+bool EVERT_CAN_Handler_UpdateStatistics(EVERT_CAN_HandlerTypeDef *handler, const uint32_t delta_ms)
+{
+    EVERT_CAN_StatisticsTypeDef *statistics = &handler->statistics;
+    statistics->window_ms += delta_ms;
+
+    if (statistics->window_ms < EVERT_CAN_STATISTICS_WINDOW_MS)
+    {
+        return false;
+    }
+
+    // Every frame on the bus passes the filter, received and sent are the whole bus
+    uint64_t bits = (uint64_t)statistics->window_frame_count * EVERT_CAN_STATISTICS_FRAME_BITS * 1000u;
+    uint64_t capacity = (uint64_t)statistics->bitrate * statistics->window_ms / 1000u;
+    uint64_t load = capacity > 0 ? bits / capacity : 0;
+    statistics->load_permille = load < UINT16_MAX ? (uint16_t)load : UINT16_MAX;
+    statistics->load_peak_permille = statistics->load_permille > statistics->load_peak_permille ? statistics->load_permille : statistics->load_peak_permille;
+
+    statistics->tx_wait_average_us = statistics->window_tx_wait_count > 0 ? statistics->window_tx_wait_us / statistics->window_tx_wait_count : 0;
+    statistics->rx_wait_average_us = statistics->window_rx_wait_count > 0 ? statistics->window_rx_wait_us / statistics->window_rx_wait_count : 0;
+
+    // Error counters and the protocol state
+    FDCAN_ErrorCountersTypeDef counters;
+
+    if (HAL_FDCAN_GetErrorCounters(handler->hfdcan, &counters) == HAL_OK)
+    {
+        statistics->rec = (uint8_t)counters.RxErrorCnt;
+        statistics->tec = (uint8_t)counters.TxErrorCnt;
+    }
+
+    bool was_bus_off = (statistics->psr & FDCAN_PSR_BO) != 0;
+    statistics->psr = handler->hfdcan->Instance->PSR;
+    statistics->error_code = HAL_FDCAN_GetError(handler->hfdcan);
+    statistics->bus_off_count += !was_bus_off && (statistics->psr & FDCAN_PSR_BO) != 0;
+
+    statistics->window_ms = 0;
+    statistics->window_frame_count = 0;
+    statistics->window_tx_wait_us = 0;
+    statistics->window_tx_wait_count = 0;
+    statistics->window_rx_wait_us = 0;
+    statistics->window_rx_wait_count = 0;
+
+    return true;
+}
+
+//
+// #endregion "Statistics"
+//
+
 HAL_StatusTypeDef EVERT_CAN_Handler_Init(FDCAN_HandleTypeDef *hfdcan, EVERT_CAN_HandlerTypeDef *handler, EVERT_CAN_DeviceIdentifierTypeDef device_id, EVERT_CAN_FifoBufferItemTypeDef *rx_fifo_items, EVERT_CAN_FifoBufferItemTypeDef *tx_fifo_items, uint32_t size)
 {
     handler->hfdcan = hfdcan;
@@ -159,6 +275,13 @@ HAL_StatusTypeDef EVERT_CAN_Handler_Init(FDCAN_HandleTypeDef *hfdcan, EVERT_CAN_
     EVERT_CAN_FifoBuffer_Init(&handler->rx_fifo_buffer, rx_fifo_items, size);
     EVERT_CAN_FifoBuffer_Init(&handler->tx_fifo_buffer, tx_fifo_items, size);
 
+    // Statistics, the queue waits are timed with the cycle counter
+    memset(&handler->statistics, 0, sizeof(handler->statistics));
+    handler->statistics.bitrate = EVERT_CAN_Statistics_Bitrate(hfdcan);
+    handler->cycles_per_bit = handler->statistics.bitrate > 0 ? SystemCoreClock / handler->statistics.bitrate : 0;
+    handler->rx_timestamp = 0;
+    EVERT_HAL_DWT_EnableCycleCounter();
+
     HAL_StatusTypeDef status = HAL_OK;
     FDCAN_FilterTypeDef sFilterConfig;
 
@@ -185,6 +308,19 @@ HAL_StatusTypeDef EVERT_CAN_Handler_Init(FDCAN_HandleTypeDef *hfdcan, EVERT_CAN_
         return status;
     }
 
+    // Timestamp counter in bit times, the Rx elements carry its value at the start of frame
+    status = HAL_FDCAN_ConfigTimestampCounter(hfdcan, FDCAN_TIMESTAMP_PRESC_1);
+
+    if (status == HAL_OK)
+    {
+        status = HAL_FDCAN_EnableTimestampCounter(hfdcan, FDCAN_TIMESTAMP_INTERNAL);
+    }
+
+    if (status != HAL_OK)
+    {
+        return status;
+    }
+
     /* Start the FDCAN module */
     status = HAL_FDCAN_Start(hfdcan);
 
@@ -193,7 +329,7 @@ HAL_StatusTypeDef EVERT_CAN_Handler_Init(FDCAN_HandleTypeDef *hfdcan, EVERT_CAN_
         return status;
     }
 
-    status = HAL_FDCAN_ActivateNotification(hfdcan, FDCAN_IT_RX_FIFO0_NEW_MESSAGE, 0);
+    status = HAL_FDCAN_ActivateNotification(hfdcan, FDCAN_IT_RX_FIFO0_NEW_MESSAGE | FDCAN_IT_RX_FIFO0_MESSAGE_LOST, 0);
 
     if (status != HAL_OK)
     {
@@ -202,7 +338,7 @@ HAL_StatusTypeDef EVERT_CAN_Handler_Init(FDCAN_HandleTypeDef *hfdcan, EVERT_CAN_
 
     // Default Tx Header
     handler->tx_header.TxFrameType = FDCAN_DATA_FRAME;
-    handler->tx_header.IdType = FDCAN_STANDARD_ID;
+    handler->tx_header.IdType = FDCAN_EXTENDED_ID; // 24 bit identifier, a standard id keeps 11 bits of it
     handler->tx_header.DataLength = FDCAN_DLC_BYTES_8;
     handler->tx_header.ErrorStateIndicator = FDCAN_ESI_ACTIVE;
     handler->tx_header.BitRateSwitch = FDCAN_BRS_OFF;
@@ -219,15 +355,29 @@ EVERT_CAN_FifoStatusTypeDef EVERT_CAN_Handler_Receive(EVERT_CAN_HandlerTypeDef *
 
     EVERT_CAN_FifoStatusTypeDef status = CAN_FS_OK;
 
+    if ((RxFifo0ITs & FDCAN_IT_RX_FIFO0_MESSAGE_LOST) != RESET)
+    {
+        handler->statistics.rx_fifo_lost_count++;
+    }
+
     if ((RxFifo0ITs & FDCAN_IT_RX_FIFO0_NEW_MESSAGE) != RESET)
     {
+        uint32_t fill_level = HAL_FDCAN_GetRxFifoFillLevel(handler->hfdcan, FDCAN_RX_FIFO0);
+        handler->statistics.rx_fifo_high_water = fill_level > handler->statistics.rx_fifo_high_water ? (uint8_t)fill_level : handler->statistics.rx_fifo_high_water;
+
         // EVERT_HAL_DWT_Start();
         if (HAL_FDCAN_GetRxMessage(handler->hfdcan, FDCAN_RX_FIFO0, &handler->rx_header, handler->rx_data) != HAL_OK)
         {
+            handler->statistics.rx_error_count++;
             EVERT_CAN_OnErrorReceived(handler);
             return CAN_FS_ERROR;
         }
 
+        // Start of frame on the cycle counter: the timestamp counter has counted the bit times since (16 bit, 131 ms at 500 kbit/s)
+        uint32_t now = EVERT_HAL_DWT_GetCycles();
+        uint16_t age = (uint16_t)(HAL_FDCAN_GetTimestampCounter(handler->hfdcan) - (uint16_t)handler->rx_header.RxTimestamp);
+        uint32_t start_of_frame = now - (uint32_t)age * handler->cycles_per_bit;
+
         EVERT_CAN_IdentifierTypeDef identifier;
         EVERT_CAN_Identifier_FromUint32(handler->rx_header.Identifier, &identifier);
 
@@ -244,6 +394,13 @@ EVERT_CAN_FifoStatusTypeDef EVERT_CAN_Handler_Receive(EVERT_CAN_HandlerTypeDef *
         frame.identifier = identifier;
 
         status = EVERT_CAN_FifoBuffer_Push(&handler->rx_fifo_buffer, frame);
+
+        if (status == CAN_FS_OK)
+        {
+            handler->rx_fifo_buffer.buffer[(handler->rx_fifo_buffer.head + handler->rx_fifo_buffer.size - 1) % handler->rx_fifo_buffer.size].start_of_frame = start_of_frame;
+        }
+
+        EVERT_CAN_Statistics_CountPush(&handler->rx_fifo_buffer, status, &handler->statistics.rx_buffer_high_water, &handler->statistics.rx_buffer_full_count);
     }
 
     return status;
@@ -258,16 +415,25 @@ EVERT_CAN_FifoStatusTypeDef EVERT_CAN_Handler_Transmit(EVERT_CAN_HandlerTypeDef
     EVERT_CAN_Frame_SetData(&frame, length, message);
 
     EVERT_CAN_FifoStatusTypeDef status = EVERT_CAN_FifoBuffer_Push(&handler->tx_fifo_buffer, frame);
+    EVERT_CAN_Statistics_CountPush(&handler->tx_fifo_buffer, status, &handler->statistics.tx_buffer_high_water, &handler->statistics.tx_buffer_full_count);
     return 0;
 }
 
 EVERT_CAN_ProcessBufferStatusTypeDef EVERT_CAN_Handler_ProcessRxBuffer(EVERT_CAN_HandlerTypeDef *handler)
 {
     EVERT_CAN_FrameTypeDef frame;
+    uint32_t timestamp = handler->rx_fifo_buffer.buffer[handler->rx_fifo_buffer.tail].timestamp;
+    uint32_t start_of_frame = handler->rx_fifo_buffer.buffer[handler->rx_fifo_buffer.tail].start_of_frame;
 
     if (EVERT_CAN_FifoBuffer_Pop(&handler->rx_fifo_buffer, &frame) == CAN_FS_OK)
     {
         handler->rx_status = CAN_PBS_PROCESSING_RECEIVED_DATA;
+        handler->rx_timestamp = start_of_frame;
+        EVERT_CAN_Statistics_CountFrame(&handler->statistics, false, &frame, timestamp);
+
+#if EVERT_HAL_CONF_FAULT_RECORD_ENABLE
+        EVERT_FAULT_RECORD_LogEvent(FRE_CAN_RX, frame.identifier.message_id, frame.identifier.source_id, frame.data.length > 0 ? frame.data.data[0] : 0);
+#endif
 
         EVERT_CAN_OnMessageReceived(handler, frame);
 
@@ -283,6 +449,15 @@ EVERT_CAN_ProcessBufferStatusTypeDef EVERT_CAN_Handler_ProcessTxBuffer(EVERT_CAN
     EVERT_CAN_FrameTypeDef frame;
     EVERT_CAN_Frame_CreateNew(&frame);
 
+    // Keep the frame buffered until the Tx FIFO has room, a failed add would drop it
+    if (handler->tx_fifo_buffer.count > 0 && HAL_FDCAN_GetTxFifoFreeLevel(handler->hfdcan) == 0)
+    {
+        handler->tx_status = CAN_PBS_WAITING_FOR_INTERNAL_BUFFER;
+        return CAN_PBS_WAITING_FOR_INTERNAL_BUFFER;
+    }
+
+    uint32_t timestamp = handler->tx_fifo_buffer.buffer[handler->tx_fifo_buffer.tail].timestamp;
+
     if (EVERT_CAN_FifoBuffer_Pop(&handler->tx_fifo_buffer, &frame) == CAN_FS_OK)
     {
         // Set identifier
@@ -300,11 +475,21 @@ EVERT_CAN_ProcessBufferStatusTypeDef EVERT_CAN_Handler_ProcessTxBuffer(EVERT_CAN
         // Add message to queue
         if (HAL_FDCAN_AddMessageToTxFifoQ(handler->hfdcan, &handler->tx_header, handler->tx_data) != HAL_OK)
         {
+            handler->statistics.tx_error_count++;
             handler->tx_status = CAN_PBS_WAITING_FOR_INTERNAL_BUFFER;
             return CAN_PBS_WAITING_FOR_INTERNAL_BUFFER;
         }
 
         handler->tx_status = CAN_PBS_OK;
+
+        uint32_t fifo_level = EVERT_CAN_TX_FIFO_ELEMENTS - HAL_FDCAN_GetTxFifoFreeLevel(handler->hfdcan);
+        handler->statistics.tx_fifo_high_water = fifo_level > handler->statistics.tx_fifo_high_water ? (uint8_t)fifo_level : handler->statistics.tx_fifo_high_water;
+        EVERT_CAN_Statistics_CountFrame(&handler->statistics, true, &frame, timestamp);
+
+#if EVERT_HAL_CONF_FAULT_RECORD_ENABLE
+        EVERT_FAULT_RECORD_LogEvent(FRE_CAN_TX, frame.identifier.message_id, frame.identifier.target_id, frame.data.length > 0 ? frame.data.data[0] : 0);
+#endif
+
         EVERT_CAN_OnMessageTransmitted(handler, frame);
         return CAN_PBS_OK;
     }
@@ -1,6 +1,7 @@
 #ifndef EVERT_CAN_HANDLER_H_
 #define EVERT_CAN_HANDLER_H_
 
+#include <stdbool.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <stm32g4xx_hal.h>
@@ -18,7 +19,9 @@ typedef enum
     CAN_DEVICE_IDENTIFIER_UNIDENTIFIED = 0,
     CAN_DEVICE_IDENTIFIER_BOOST_CONVERTER1 = 1,
     CAN_DEVICE_IDENTIFIER_BOOST_CONVERTER2 = 2,
-    CAN_DEVICE_IDENTIFIER_MAX = 127
+    CAN_DEVICE_IDENTIFIER_INVERTER = 3,
+    CAN_DEVICE_IDENTIFIER_CCU = 15, // Highest 4 bit id (source/target are 4 bits on the wire)
+    CAN_DEVICE_IDENTIFIER_MAX = 15
 } EVERT_CAN_DeviceIdentifierTypeDef;
 
 typedef enum
@@ -27,7 +30,7 @@ typedef enum
     CAN_MESSAGE_PRIORITY_HIGH = 1,
     CAN_MESSAGE_PRIORITY_NORMAL = 2,
     CAN_MESSAGE_PRIORITY_LOW = 3,
-    CAN_MESSAGE_PRIORITY_MAX = 127
+    CAN_MESSAGE_PRIORITY_MAX = 15
 } EVERT_CAN_MessagePriorityTypeDef;
 
 typedef struct
@@ -95,6 +98,8 @@ typedef enum
 typedef struct
 {
     EVERT_CAN_FrameTypeDef frame;
+    uint32_t timestamp;      // DWT cycles at the push, queue wait statistics
+    uint32_t start_of_frame; // Rx: DWT cycles at the start of frame on the bus (FDCAN timestamp counter)
 } EVERT_CAN_FifoBufferItemTypeDef;
 
 typedef struct
@@ -125,6 +130,59 @@ typedef enum
     CAN_PBS_WAITING_FOR_INTERNAL_BUFFER = 3
 } EVERT_CAN_ProcessBufferStatusTypeDef;
 
+#define EVERT_CAN_TX_FIFO_ELEMENTS (3)              // Tx FIFO of the G4 message RAM
+#define EVERT_CAN_RX_FIFO_ELEMENTS (3)              // Rx FIFO 0 of the G4 message RAM
+#define EVERT_CAN_STATISTICS_METHOD_COUNT (32)      // Methods counted one by one, the last slot counts the rest
+#define EVERT_CAN_STATISTICS_WINDOW_MS (1000)       // Bus load, averages and the error counters
+#define EVERT_CAN_STATISTICS_FRAME_BITS (144)       // 29 bit id, 8 data bytes, stuff bits and the interframe space, on average
+
+/// @brief Counters since the init, the bus load and the averages over the last EVERT_CAN_STATISTICS_WINDOW_MS
+typedef struct
+{
+    // Traffic
+    uint32_t rx_frame_count;
+    uint32_t tx_frame_count;
+    uint32_t rx_byte_count; // Payload bytes used, out of 7 per frame
+    uint32_t tx_byte_count;
+    uint32_t rx_method_count[EVERT_CAN_STATISTICS_METHOD_COUNT]; // By method (data[0])
+    uint32_t tx_method_count[EVERT_CAN_STATISTICS_METHOD_COUNT];
+
+    // Buffers and FIFOs, the high-water marks are frames in use at the peak
+    uint16_t rx_buffer_high_water;
+    uint16_t tx_buffer_high_water;
+    uint8_t rx_fifo_high_water;
+    uint8_t tx_fifo_high_water;
+    uint32_t rx_buffer_full_count; // Frame dropped, the main loop is behind
+    uint32_t tx_buffer_full_count; // Frame dropped, the bus is behind
+    uint32_t rx_fifo_lost_count;   // Rx FIFO 0 message lost, the ISR is behind
+    uint32_t rx_error_count;       // HAL_FDCAN_GetRxMessage failed
+    uint32_t tx_error_count;       // HAL_FDCAN_AddMessageToTxFifoQ failed
+
+    // Queue wait: EVERT_CAN_Handler_Transmit to the Tx FIFO, the Rx ISR to the main loop
+    uint32_t tx_wait_max_us;
+    uint32_t rx_wait_max_us;
+    uint32_t tx_wait_average_us;
+    uint32_t rx_wait_average_us;
+
+    // Sampled once per window
+    uint8_t rec;             // Receive error counter
+    uint8_t tec;             // Transmit error counter
+    uint32_t psr;            // Protocol status register
+    uint32_t error_code;     // HAL error code of the handle
+    uint32_t bus_off_count;  // Windows that found the node newly bus-off
+    uint16_t load_permille;  // Frames received and sent, in 1/1000 of the bit rate
+    uint16_t load_peak_permille;
+
+    // Window
+    uint32_t bitrate;
+    uint32_t window_ms;
+    uint32_t window_frame_count;
+    uint32_t window_tx_wait_us;
+    uint32_t window_tx_wait_count;
+    uint32_t window_rx_wait_us;
+    uint32_t window_rx_wait_count;
+} EVERT_CAN_StatisticsTypeDef;
+
 typedef struct
 {
     void (*OnErrorReceived)(void);
@@ -141,6 +199,9 @@ typedef struct
     uint8_t tx_data[8];
     EVERT_CAN_ProcessBufferStatusTypeDef rx_status;
     EVERT_CAN_ProcessBufferStatusTypeDef tx_status;
+    EVERT_CAN_StatisticsTypeDef statistics;
+    uint32_t cycles_per_bit; // DWT cycles per nominal bit time, the timestamp counter unit
+    uint32_t rx_timestamp;   // DWT cycles at the start of frame of the frame in EVERT_CAN_OnMessageReceived (time sync)
 
 } EVERT_CAN_HandlerTypeDef;
 
@@ -149,6 +210,7 @@ EVERT_CAN_FifoStatusTypeDef EVERT_CAN_Handler_Receive(EVERT_CAN_HandlerTypeDef *
 EVERT_CAN_FifoStatusTypeDef EVERT_CAN_Handler_Transmit(EVERT_CAN_HandlerTypeDef *handler, const uint8_t length, const uint8_t *message);
 EVERT_CAN_ProcessBufferStatusTypeDef EVERT_CAN_Handler_ProcessRxBuffer(EVERT_CAN_HandlerTypeDef *handler);
 EVERT_CAN_ProcessBufferStatusTypeDef EVERT_CAN_Handler_ProcessTxBuffer(EVERT_CAN_HandlerTypeDef *handler);
+bool EVERT_CAN_Handler_UpdateStatistics(EVERT_CAN_HandlerTypeDef *handler, const uint32_t delta_ms);
 
 void EVERT_CAN_OnErrorReceived(EVERT_CAN_HandlerTypeDef *handler);
 void EVERT_CAN_OnMessageReceived(EVERT_CAN_HandlerTypeDef *handler, const EVERT_CAN_FrameTypeDef frame);
@@ -0,0 +1,37 @@
+#ifndef EVERT_CRC_H_
+#define EVERT_CRC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// CRC-32 (IEEE 802.3, reflected, poly 0xEDB88320), nibble table so it fits in 64 bytes of flash.
+// Usage: crc = EVERT_CRC32_Update(EVERT_CRC32_INIT, data, length) ^ EVERT_CRC32_XOR_OUT
+
+#define EVERT_CRC32_INIT (0xFFFFFFFFu)
+#define EVERT_CRC32_XOR_OUT (0xFFFFFFFFu)
+
+static inline uint32_t EVERT_CRC32_Update(uint32_t crc, const void *data, const size_t length)
+{
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+
+    const uint8_t *bytes = (const uint8_t *)data;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= bytes[i];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+
+    return crc;
+}
+
+static inline uint32_t EVERT_CRC32(const void *data, const size_t length)
+{
+    return EVERT_CRC32_Update(EVERT_CRC32_INIT, data, length) ^ EVERT_CRC32_XOR_OUT;
+}
+
+#endif // EVERT_CRC_H_
@@ -0,0 +1,188 @@
+#include <string.h>
+#include "delta_telemetry.h"
+
+#if EVERT_HAL_CONF_DELTA_TELEMETRY_ENABLE
+
+#define EVERT_DELTA_TELEMETRY_GROUP_SIZE (8) // Signals per delta mask
+
+static int32_t EVERT_DELTA_TELEMETRY_Quantize(const float value, const float inverse, const int32_t previous)
+{
+    float steps = value * inverse;
+
+    if (steps != steps)
+    {
+        return previous; // NaN, hold
+    }
+
+    if (steps >= (float)EVERT_DELTA_TELEMETRY_VALUE_LIMIT)
+    {
+        return EVERT_DELTA_TELEMETRY_VALUE_LIMIT;
+    }
+
+    if (steps <= -(float)EVERT_DELTA_TELEMETRY_VALUE_LIMIT)
+    {
+        return -EVERT_DELTA_TELEMETRY_VALUE_LIMIT;
+    }
+
+    return (int32_t)(steps < 0.0f ? steps - 0.5f : steps + 0.5f);
+}
+
+/// @brief Varint of a zig-zag value below 2^28
+/// @return Bytes written, up to EVERT_DELTA_TELEMETRY_VARINT_MAX
+static uint32_t EVERT_DELTA_TELEMETRY_Varint(uint8_t *buffer, uint32_t value)
+{
+    uint32_t length = 0;
+
+    while (value >= 0x80)
+    {
+        buffer[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+
+    buffer[length++] = (uint8_t)value;
+
+    return length;
+}
+
+void EVERT_DELTA_TELEMETRY_Init(EVERT_DELTA_TELEMETRY_HandlerTypeDef *handler, const EVERT_DELTA_TELEMETRY_SignalTypeDef *signals, const uint32_t signal_count, const uint32_t keyframe_interval)
+{
+    memset(handler, 0, sizeof(*handler));
+
+    handler->signals = signals;
+    handler->signal_count = signal_count < EVERT_DELTA_TELEMETRY_SIGNAL_COUNT ? signal_count : EVERT_DELTA_TELEMETRY_SIGNAL_COUNT;
+    handler->keyframe_interval = keyframe_interval > 0 ? keyframe_interval : 1;
+    handler->cursor = handler->signal_count;
+
+    for (uint32_t i = 0; i < handler->signal_count; i++)
+    {
+        handler->inverse[i] = signals[i].resolution > 0.0f ? 1.0f / signals[i].resolution : 1.0f;
+    }
+}
+
+/// @brief Send the next sample whole, e.g. when the host (re)starts listening
+void EVERT_DELTA_TELEMETRY_RequestKeyframe(EVERT_DELTA_TELEMETRY_HandlerTypeDef *handler)
+{
+    handler->keyframe_countdown = 0;
+}
+
+/// @brief Take a sample, values in table order. What is left of the previous sample is dropped, the
+/// differences of the next one are against what went out.
+void EVERT_DELTA_TELEMETRY_Sample(EVERT_DELTA_TELEMETRY_HandlerTypeDef *handler, const float *values)
+{
+    for (uint32_t i = 0; i < handler->signal_count; i++)
+    {
+        handler->value[i] = EVERT_DELTA_TELEMETRY_Quantize(values[i], handler->inverse[i], handler->value[i]);
+    }
+
+    handler->keyframe = handler->keyframe_countdown == 0;
+    handler->keyframe_countdown = handler->keyframe ? handler->keyframe_interval - 1 : handler->keyframe_countdown - 1;
+    handler->cursor = 0;
+    handler->sample_count++;
+}
+
+/// @brief Next frame payload of the current sample
+/// @param capacity At least EVERT_DELTA_TELEMETRY_PAYLOAD_MIN
+/// @param sequence Sequence number of the frame, to be sent along
+/// @return Payload length, 0 once the sample is out
+uint32_t EVERT_DELTA_TELEMETRY_Pack(EVERT_DELTA_TELEMETRY_HandlerTypeDef *handler, uint8_t *buffer, const uint32_t capacity, uint8_t *sequence)
+{
+    uint8_t varint[EVERT_DELTA_TELEMETRY_VARINT_MAX];
+    uint32_t length = 1;
+    uint32_t n;
+
+    if (capacity < EVERT_DELTA_TELEMETRY_PAYLOAD_MIN)
+    {
+        return 0;
+    }
+
+    if (handler->keyframe)
+    {
+        if (handler->cursor >= handler->signal_count)
+        {
+            return 0;
+        }
+
+        buffer[0] = EVERT_DELTA_TELEMETRY_KEYFRAME | (uint8_t)handler->cursor;
+
+        while (handler->cursor < handler->signal_count)
+        {
+            n = EVERT_DELTA_TELEMETRY_Varint(varint, EVERT_DELTA_TELEMETRY_ZigZag(handler->value[handler->cursor]));
+
+            if (length + n > capacity)
+            {
+                break;
+            }
+
+            memcpy(&buffer[length], varint, n);
+            length += n;
+            handler->sent[handler->cursor] = handler->value[handler->cursor];
+            handler->cursor++;
+        }
+
+        handler->keyframe_frame_count++;
+    }
+    else
+    {
+        // Nothing to send up to the first change
+        while (handler->cursor < handler->signal_count && handler->value[handler->cursor] == handler->sent[handler->cursor])
+        {
+            handler->cursor++;
+        }
+
+        if (handler->cursor >= handler->signal_count)
+        {
+            return 0;
+        }
+
+        buffer[0] = (uint8_t)handler->cursor;
+        uint32_t used = length; // Up to the last group with a change, trailing empty masks are cut
+
+        while (handler->cursor < handler->signal_count && length < capacity)
+        {
+            uint32_t first = handler->cursor;
+            uint32_t end = first + EVERT_DELTA_TELEMETRY_GROUP_SIZE < handler->signal_count ? first + EVERT_DELTA_TELEMETRY_GROUP_SIZE : handler->signal_count;
+            uint32_t mask_index = length++;
+            uint8_t mask = 0;
+
+            for (; handler->cursor < end; handler->cursor++)
+            {
+                uint32_t i = handler->cursor;
+
+                if (handler->value[i] == handler->sent[i])
+                {
+                    continue;
+                }
+
+                n = EVERT_DELTA_TELEMETRY_Varint(varint, EVERT_DELTA_TELEMETRY_ZigZag(handler->value[i] - handler->sent[i]));
+
+                if (length + n > capacity)
+                {
+                    break; // The next frame starts here
+                }
+
+                memcpy(&buffer[length], varint, n);
+                length += n;
+                mask |= (uint8_t)(1u << (i - first));
+                handler->sent[i] = handler->value[i];
+            }
+
+            buffer[mask_index] = mask;
+            used = mask != 0 ? length : used;
+
+            if (handler->cursor < end)
+            {
+                break;
+            }
+        }
+
+        length = used;
+    }
+
+    *sequence = ++handler->sequence;
+    handler->frame_count++;
+    handler->byte_count += length;
+
+    return length;
+}
+
+#endif // EVERT_HAL_CONF_DELTA_TELEMETRY_ENABLE
@@ -0,0 +1,79 @@
+#ifndef EVERT_DELTA_TELEMETRY_H_
+#define EVERT_DELTA_TELEMETRY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32g4xx_hal.h>
+#include "_conf_evert_hal.h"
+
+// Delta telemetry: a fixed table of signals sampled together, sent in as few frames as the values allow.
+// * Each signal is quantized to its resolution (value / resolution rounded, saturated to
+//   +-EVERT_DELTA_TELEMETRY_VALUE_LIMIT steps), the host scales it back with the same resolution
+// * Keyframe (every keyframe_interval samples, or on request): the quantized values themselves
+// * Otherwise only what changed since the last sent value, as the difference. Unchanged signals cost one
+//   bit, a change of a few steps one byte.
+// * Payload of a frame (up to the capacity given to EVERT_DELTA_TELEMETRY_Pack, at least 6 bytes):
+//   [0] first signal index | EVERT_DELTA_TELEMETRY_KEYFRAME, then from that signal on
+//   - keyframe: [zig-zag varint of the value]... in table order
+//   - delta: [mask][zig-zag varint of the difference]... per group of 8 signals, bit n of the mask set for
+//     signal n of the group changed, one varint per set bit. A group that does not fit ends the frame, the
+//     next frame starts at the first signal that did not go out.
+//   Varints are 7 bits per byte, low first, bit 7 set on all but the last. Every value and difference fits
+//   in 4 bytes.
+// * Sequence: incremented per frame, the transport sends it along (CAN message id). A gap means a lost
+//   frame, the receiver holds its values as invalid until the next keyframe has covered them.
+// The application fills a staging array in table order and calls EVERT_DELTA_TELEMETRY_Sample, then drains
+// EVERT_DELTA_TELEMETRY_Pack into frames. The table itself (ids and resolutions) is application defined
+// and sent to the host on request, see the application's listing method.
+
+#if EVERT_HAL_CONF_DELTA_TELEMETRY_ENABLE
+
+#define EVERT_DELTA_TELEMETRY_SIGNAL_COUNT (EVERT_HAL_CONF_DELTA_TELEMETRY_SIGNAL_COUNT)
+#define EVERT_DELTA_TELEMETRY_KEYFRAME (0x80)            // Flag in the first payload byte
+#define EVERT_DELTA_TELEMETRY_INDEX_MASK (0x7F)
+#define EVERT_DELTA_TELEMETRY_VALUE_LIMIT (0x03FFFFFF)   // 2^26 - 1: zig-zag differences within 28 bits, 4 varint bytes
+#define EVERT_DELTA_TELEMETRY_VARINT_MAX (4)
+#define EVERT_DELTA_TELEMETRY_PAYLOAD_MIN (2 + EVERT_DELTA_TELEMETRY_VARINT_MAX)
+
+_Static_assert(EVERT_DELTA_TELEMETRY_SIGNAL_COUNT <= EVERT_DELTA_TELEMETRY_INDEX_MASK + 1, "EVERT_HAL_CONF_DELTA_TELEMETRY_SIGNAL_COUNT above 128");
+
+typedef struct
+{
+    uint16_t id;      // Host side name of the signal (registry id for the devices that have one)
+    float resolution; // Units per step, > 0
+} EVERT_DELTA_TELEMETRY_SignalTypeDef;
+
+typedef struct
+{
+    const EVERT_DELTA_TELEMETRY_SignalTypeDef *signals;
+    uint32_t signal_count;
+    uint32_t keyframe_interval; // Samples, 1 = keyframes only
+    float inverse[EVERT_DELTA_TELEMETRY_SIGNAL_COUNT];
+
+    int32_t value[EVERT_DELTA_TELEMETRY_SIGNAL_COUNT]; // Quantized sample being sent
+    int32_t sent[EVERT_DELTA_TELEMETRY_SIGNAL_COUNT];  // Last value sent per signal, what the host holds
+    uint32_t cursor;                                   // Next signal to pack, signal_count: sample sent
+    bool keyframe;                                     // The sample being sent is a keyframe
+    uint32_t keyframe_countdown;                       // Samples to the next keyframe, 0: the next one is
+    uint8_t sequence;                                  // Of the last frame packed
+
+    // Statistics
+    uint32_t sample_count;
+    uint32_t frame_count;
+    uint32_t keyframe_frame_count;
+    uint32_t byte_count; // Payload bytes packed
+} EVERT_DELTA_TELEMETRY_HandlerTypeDef;
+
+void EVERT_DELTA_TELEMETRY_Init(EVERT_DELTA_TELEMETRY_HandlerTypeDef *handler, const EVERT_DELTA_TELEMETRY_SignalTypeDef *signals, const uint32_t signal_count, const uint32_t keyframe_interval);
+void EVERT_DELTA_TELEMETRY_RequestKeyframe(EVERT_DELTA_TELEMETRY_HandlerTypeDef *handler);
+void EVERT_DELTA_TELEMETRY_Sample(EVERT_DELTA_TELEMETRY_HandlerTypeDef *handler, const float *values);
+uint32_t EVERT_DELTA_TELEMETRY_Pack(EVERT_DELTA_TELEMETRY_HandlerTypeDef *handler, uint8_t *buffer, const uint32_t capacity, uint8_t *sequence);
+
+/// @brief Signed to unsigned, small magnitudes stay small: 0, -1, 1, -2 -> 0, 1, 2, 3
+static inline uint32_t EVERT_DELTA_TELEMETRY_ZigZag(const int32_t value)
+{
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+#endif // EVERT_HAL_CONF_DELTA_TELEMETRY_ENABLE
+#endif // EVERT_DELTA_TELEMETRY_H_
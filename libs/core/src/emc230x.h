@@ -89,6 +89,17 @@
 #endif
 
 #include <stm32g4xx_hal.h>
+#include "i2c_queue.h"
+
+#ifdef EMC230X_TYPE_2305
+#define EMC230X_FAN_COUNT (5)
+#else
+#define EMC230X_FAN_COUNT (3)
+#endif
+
+// TACH_HIGH holds count bits 12:5, TACH_LOW bits 4:0 in its upper five bits
+#define EMC230X_TACH_COUNT(high, low) ((uint16_t)(((high) << 5) | ((low) >> 3)))
+#define EMC230X_TACH_COUNT_STALLED (0x1FFF)
 
 typedef enum
 {
@@ -102,56 +113,19 @@ typedef enum
 #endif
 } EVERT_EMC230X_Fan;
 
-typedef enum
-{
-    EVERT_EMC230X_RX_ACTION_NONE = 0,
-    EVERT_EMC230X_RX_ACTION_READ_TACHS_FAN1_HIGH = 1,
-    EVERT_EMC230X_RX_ACTION_READ_TACHS_FAN1_LOW = 2,
-    EVERT_EMC230X_RX_ACTION_READ_TACHS_FAN2_HIGH = 3,
-    EVERT_EMC230X_RX_ACTION_READ_TACHS_FAN2_LOW = 4,
-    EVERT_EMC230X_RX_ACTION_READ_TACHS_FAN3_HIGH = 5,
-    EVERT_EMC230X_RX_ACTION_READ_TACHS_FAN3_LOW = 6
-#ifdef EMC230X_TYPE_2305
-    ,
-    EVERT_EMC230X_RX_ACTION_READ_TACHS_FAN4_HIGH = 7,
-    EVERT_EMC230X_RX_ACTION_READ_TACHS_FAN4_LOW = 8,
-    EVERT_EMC230X_RX_ACTION_READ_TACHS_FAN5_HIGH = 9,
-    EVERT_EMC230X_RX_ACTION_READ_TACHS_FAN5_LOW = 10
-#endif
-} EVERT_EMC230X_RxAction;
-
-typedef enum
-{
-    EVERT_EMC230X_TX_ACTION_NONE = 0,
-    EVERT_EMC230X_TX_ACTION_SET_SINGLE_FAN_SPEED = 1,
-    EVERT_EMC230X_TX_ACTION_SET_ALL_FAN1_SPEED = 2,
-    EVERT_EMC230X_TX_ACTION_SET_ALL_FAN2_SPEED = 3,
-    EVERT_EMC230X_TX_ACTION_SET_ALL_FAN3_SPEED = 4
-#ifdef EMC230X_TYPE_2305
-    ,
-    EVERT_EMC230X_TX_ACTION_SET_ALL_FAN4_SPEED = 5,
-    EVERT_EMC230X_TX_ACTION_SET_ALL_FAN5_SPEED = 6
-#endif
-} EVERT_EMC230X_TxAction;
-
 typedef struct
 {
-    uint8_t tach_high;
-    uint8_t tach_low;
     uint16_t tach;
     uint16_t rpm;
     uint8_t speed;
 } EVERT_EMC230X_DataTypeDef;
 
-extern I2C_HandleTypeDef hi2c1;
-
-void EVERT_EMC230X_Init();
+void EVERT_EMC230X_Init(EVERT_I2C_QUEUE_HandlerTypeDef *queue);
 void EVERT_EMC230X_SetAllFanSpeeds_IT(uint8_t speed);
 void EVERT_EMC230X_SetFanSpeed_IT(const EVERT_EMC230X_Fan fan, uint8_t speed);
 void EVERT_EMC230X_SetRangeRegister_IT(const uint8_t range);
-void EVERT_EMC230X_SetRxAction(const EVERT_EMC230X_RxAction action);
-void EVERT_EMC230X_SetTxAction(const EVERT_EMC230X_TxAction action);
 void EVERT_EMC230X_ReadTachs_IT();
+uint16_t EVERT_EMC230X_GetRpm(const EVERT_EMC230X_Fan fan);
 void EVERT_EMC230X_OnErrorReceived();
 
-#endif // EVERT_CORE_EMC230X_H_
\ No newline at end of file
+#endif // EVERT_CORE_EMC230X_H_
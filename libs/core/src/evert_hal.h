@@ -12,6 +12,9 @@
 #include "_conf_evert_hal.h"
 #include "evert_hal_adc.h"
 #include "evert_hal_dwt.h"
+#include "i2c_queue.h"
+#include "oscillation_detector.h"
+#include "pid_controller.h"
 #include "debugging.h"
 #include "task_scheduler.h"
 
@@ -23,4 +26,36 @@
 #include "fz2812.h"
 #endif
 
+#if EVERT_HAL_CONF_SCOPE_ENABLE
+#include "scope.h"
+#endif
+
+#if EVERT_HAL_CONF_TELEMETRY_ENABLE
+#include "telemetry.h"
+#endif
+
+#if EVERT_HAL_CONF_REGISTRY_ENABLE
+#include "registry.h"
+#endif
+
+#if EVERT_HAL_CONF_DELTA_TELEMETRY_ENABLE
+#include "delta_telemetry.h"
+#endif
+
+#if EVERT_HAL_CONF_FAULT_RECORD_ENABLE
+#include "fault_record.h"
+#endif
+
+#if EVERT_HAL_CONF_WATCHDOG_ENABLE
+#include "watchdog.h"
+#endif
+
+#if EVERT_HAL_CONF_PARAM_STORE_ENABLE
+#include "param_store.h"
+#endif
+
+#if EVERT_HAL_CONF_FIRMWARE_UPDATE_ENABLE
+#include "firmware_update.h"
+#endif
+
 #endif // EVERT_HAL_H_
\ No newline at end of file
@@ -17,6 +17,50 @@ HAL_StatusTypeDef EVERT_HAL_ADC_Start(ADC_HandleTypeDef *hadc, uint16_t *buffer,
     return HAL_OK;
 }
 
+// Calibration of all instances at once instead of HAL_ADCEx_Calibration_Start one after the other: each ADC has its
+// own ADCAL, they are started together and waited for together. Then the conversions with DMA, in order.
+HAL_StatusTypeDef EVERT_HAL_ADC_StartAll(ADC_HandleTypeDef *const hadcs[], uint16_t *const buffers[], const uint32_t conversion_counts[], const uint32_t count)
+{
+    // Calibration prerequisite: ADC disabled
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (ADC_Disable(hadcs[i]) != HAL_OK)
+        {
+            SET_BIT(hadcs[i]->State, HAL_ADC_STATE_ERROR_INTERNAL);
+            return HAL_ERROR;
+        }
+
+        ADC_STATE_CLR_SET(hadcs[i]->State, HAL_ADC_STATE_REG_BUSY | HAL_ADC_STATE_INJ_BUSY, HAL_ADC_STATE_BUSY_INTERNAL);
+        LL_ADC_StartCalibration(hadcs[i]->Instance, ADC_SINGLE_ENDED);
+    }
+
+    uint32_t start = HAL_GetTick();
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        while (LL_ADC_IsCalibrationOnGoing(hadcs[i]->Instance) != 0UL)
+        {
+            if (HAL_GetTick() - start > EVERT_HAL_ADC_CALIBRATION_TIMEOUT_MS)
+            {
+                ADC_STATE_CLR_SET(hadcs[i]->State, HAL_ADC_STATE_BUSY_INTERNAL, HAL_ADC_STATE_ERROR_INTERNAL);
+                return HAL_ERROR;
+            }
+        }
+
+        ADC_STATE_CLR_SET(hadcs[i]->State, HAL_ADC_STATE_BUSY_INTERNAL, HAL_ADC_STATE_READY);
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (HAL_ADC_Start_DMA(hadcs[i], (uint32_t *)buffers[i], conversion_counts[i]) != HAL_OK)
+        {
+            return HAL_ERROR;
+        }
+    }
+
+    return HAL_OK;
+}
+
 float32_t EVERT_HAL_ADC_Lerp(float adc, float slope, float y_intercept)
 {
     return slope * adc + y_intercept;
@@ -4,8 +4,11 @@
 #include <arm_math.h>
 #include <stm32g4xx_hal.h>
 
+#define EVERT_HAL_ADC_CALIBRATION_TIMEOUT_MS (2) // All instances together, one takes ~120 ADC clock cycles
+
 HAL_StatusTypeDef EVERT_HAL_ADC_Start(ADC_HandleTypeDef *hadc, uint16_t *buffer, uint32_t conversion_count);
+HAL_StatusTypeDef EVERT_HAL_ADC_StartAll(ADC_HandleTypeDef *const hadcs[], uint16_t *const buffers[], const uint32_t conversion_counts[], const uint32_t count);
 
 float32_t EVERT_HAL_ADC_Lerp(float adc, float slope, float y_intercept);
 
-#endif // EVERT_HAL_ADC_H_
\ No newline at end of file
+#endif // EVERT_HAL_ADC_H_
@@ -6,6 +6,12 @@ static uint32_t _dwt_start = 0;
 
 void EVERT_HAL_DWT_EnableCycleCounter(void)
 {
+    // Already running for another user, keep its count
+    if ((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) != 0)
+    {
+        return;
+    }
+
     // Enable the DWT cycle counter
     CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // Enable the TRCENA bit in the DEMCR register (Trace Control Register)
     DWT->CYCCNT = 0;                                // Reset the cycle counter
@@ -17,6 +23,11 @@ void EVERT_HAL_DWT_Start(void)
     _dwt_start = DWT->CYCCNT;
 }
 
+uint32_t EVERT_HAL_DWT_GetCycles(void)
+{
+    return DWT->CYCCNT;
+}
+
 uint32_t EVERT_HAL_DWT_Stop(void)
 {
     DwtCycleCounterResult = DWT->CYCCNT - _dwt_start;
@@ -0,0 +1,321 @@
+#include "fault_record.h"
+#include <stddef.h>
+#include <string.h>
+#include "crc.h"
+#include "time_sync.h"
+
+#if EVERT_HAL_CONF_FAULT_RECORD_ENABLE
+
+_Static_assert((EVERT_FAULT_RECORD_EVENT_COUNT & (EVERT_FAULT_RECORD_EVENT_COUNT - 1)) == 0, "EVERT_HAL_CONF_FAULT_RECORD_EVENT_COUNT must be a power of 2");
+_Static_assert(sizeof(EVERT_FAULT_RECORD_TypeDef) % sizeof(uint64_t) == 0, "Fault record must be whole double words");
+_Static_assert(EVERT_FAULT_RECORD_SLOT_COUNT >= 2, "Fault record region too small");
+
+#define EVERT_FAULT_RECORD_RESET_FLAGS (RCC_CSR_OBLRSTF | RCC_CSR_PINRSTF | RCC_CSR_BORRSTF | RCC_CSR_SFTRSTF | RCC_CSR_IWDGRSTF | RCC_CSR_WWDGRSTF | RCC_CSR_LPWRRSTF)
+
+EVERT_FAULT_RECORD_RetainedTypeDef fault_record_retained __attribute__((section(".noinit")));
+EVERT_FAULT_RECORD_HandlerTypeDef fault_record = {0};
+
+static inline const EVERT_FAULT_RECORD_TypeDef *EVERT_FAULT_RECORD_Slot(const uint32_t slot)
+{
+    return (const EVERT_FAULT_RECORD_TypeDef *)(EVERT_FAULT_RECORD_ADDRESS + (slot * sizeof(EVERT_FAULT_RECORD_TypeDef)));
+}
+
+static inline uint32_t EVERT_FAULT_RECORD_Crc(const EVERT_FAULT_RECORD_TypeDef *record)
+{
+    return EVERT_CRC32(record, offsetof(EVERT_FAULT_RECORD_TypeDef, crc));
+}
+
+static inline bool EVERT_FAULT_RECORD_IsValid(const EVERT_FAULT_RECORD_TypeDef *record)
+{
+    return record->magic == EVERT_FAULT_RECORD_MAGIC && record->version == EVERT_FAULT_RECORD_VERSION && record->crc == EVERT_FAULT_RECORD_Crc(record);
+}
+
+static inline bool EVERT_FAULT_RECORD_IsErased(const EVERT_FAULT_RECORD_TypeDef *record)
+{
+    const uint32_t *words = (const uint32_t *)record;
+
+    for (uint32_t i = 0; i < sizeof(EVERT_FAULT_RECORD_TypeDef) / sizeof(uint32_t); i++)
+    {
+        if (words[i] != 0xFFFFFFFFu)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/// @brief Erase the fault log, 2 kB pages in dual bank mode (DBANK = 1, default) and 4 kB pages otherwise
+static HAL_StatusTypeDef EVERT_FAULT_RECORD_EraseRegion(void)
+{
+    uint32_t address = EVERT_FAULT_RECORD_ADDRESS;
+    FLASH_EraseInitTypeDef erase = {0};
+    uint32_t page_error = 0;
+
+    erase.TypeErase = FLASH_TYPEERASE_PAGES;
+
+    if (READ_BIT(FLASH->OPTR, FLASH_OPTR_DBANK) != 0U)
+    {
+        // The erase takes the physical bank, swapped with the mapping when booted from bank 2 (FB_MODE)
+        bool upper = address >= (FLASH_BASE + FLASH_BANK_SIZE);
+        bool bank2 = upper != (READ_BIT(SYSCFG->MEMRMP, SYSCFG_MEMRMP_FB_MODE) != 0U);
+        erase.Banks = bank2 ? FLASH_BANK_2 : FLASH_BANK_1;
+        erase.Page = (address - (upper ? FLASH_BASE + FLASH_BANK_SIZE : FLASH_BASE)) / FLASH_PAGE_SIZE;
+        erase.NbPages = EVERT_FAULT_RECORD_REGION_SIZE / FLASH_PAGE_SIZE;
+    }
+    else
+    {
+        erase.Banks = FLASH_BANK_1;
+        erase.Page = (address - FLASH_BASE) / FLASH_PAGE_SIZE_128_BITS;
+        erase.NbPages = EVERT_FAULT_RECORD_REGION_SIZE / FLASH_PAGE_SIZE_128_BITS;
+    }
+
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_ALL_ERRORS);
+    HAL_StatusTypeDef status = HAL_FLASHEx_Erase(&erase, &page_error);
+    HAL_FLASH_Lock();
+
+    return status;
+}
+
+/// @brief Program a record, the double word holding the CRC goes last
+static HAL_StatusTypeDef EVERT_FAULT_RECORD_Program(const uint32_t address, const EVERT_FAULT_RECORD_TypeDef *record)
+{
+    const uint32_t count = sizeof(EVERT_FAULT_RECORD_TypeDef) / sizeof(uint64_t);
+    HAL_StatusTypeDef status = HAL_OK;
+
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_ALL_ERRORS);
+
+    for (uint32_t i = 0; i < count && status == HAL_OK; i++)
+    {
+        uint64_t double_word;
+        memcpy(&double_word, (const uint8_t *)record + (i * sizeof(uint64_t)), sizeof(double_word));
+        status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, address + (i * sizeof(uint64_t)), double_word);
+    }
+
+    HAL_FLASH_Lock();
+
+    return status;
+}
+
+/// @brief Find the newest record and the next free slot
+/// @return Next free slot, EVERT_FAULT_RECORD_SLOT_COUNT when the log is full
+static uint32_t EVERT_FAULT_RECORD_Scan(void)
+{
+    uint32_t free_slot = EVERT_FAULT_RECORD_SLOT_COUNT;
+
+    fault_record.latest = NULL;
+    fault_record.count = 0;
+
+    // Append-only: records fill the region from the start, the first erased slot ends the log
+    for (uint32_t slot = 0; slot < EVERT_FAULT_RECORD_SLOT_COUNT; slot++)
+    {
+        const EVERT_FAULT_RECORD_TypeDef *record = EVERT_FAULT_RECORD_Slot(slot);
+
+        if (EVERT_FAULT_RECORD_IsErased(record))
+        {
+            free_slot = slot;
+            break;
+        }
+
+        if (EVERT_FAULT_RECORD_IsValid(record))
+        {
+            fault_record.latest = record;
+            fault_record.count++;
+        }
+    }
+
+    return free_slot;
+}
+
+static void EVERT_FAULT_RECORD_Persist(const EVERT_FAULT_RECORD_TypeDef *record)
+{
+    uint32_t slot = EVERT_FAULT_RECORD_Scan();
+
+    if (slot == EVERT_FAULT_RECORD_SLOT_COUNT)
+    {
+        // Full, start over: the newest record is the one being written
+        if (EVERT_FAULT_RECORD_EraseRegion() != HAL_OK)
+        {
+            return;
+        }
+
+        slot = 0;
+    }
+
+    EVERT_FAULT_RECORD_Program(EVERT_FAULT_RECORD_ADDRESS + (slot * sizeof(EVERT_FAULT_RECORD_TypeDef)), record);
+    EVERT_FAULT_RECORD_Scan();
+}
+
+static void EVERT_FAULT_RECORD_Seal(EVERT_FAULT_RECORD_TypeDef *record, const uint8_t type)
+{
+    record->magic = EVERT_FAULT_RECORD_MAGIC;
+    record->version = EVERT_FAULT_RECORD_VERSION;
+    record->type = type;
+    record->boot_count = fault_record_retained.boot_count;
+    record->tick = HAL_GetTick();
+#if EVERT_HAL_CONF_TIME_SYNC_ENABLE
+    record->sync_time_us = EVERT_TIME_SYNC_Now();
+#else
+    record->sync_time_us = 0;
+#endif
+    record->cfsr = SCB->CFSR;
+    record->hfsr = SCB->HFSR;
+    record->mmfar = SCB->MMFAR;
+    record->bfar = SCB->BFAR;
+    record->padding = 0;
+
+    EVERT_FAULT_RECORD_OnCapture(record);
+
+    record->crc = EVERT_FAULT_RECORD_Crc(record);
+}
+
+/// @brief Read the reset cause and move a record left by the last reset to flash, call first thing after HAL_Init
+void EVERT_FAULT_RECORD_Init(void)
+{
+    EVERT_FAULT_RECORD_TypeDef *record = &fault_record_retained.record;
+
+    fault_record.reset_cause = RCC->CSR & EVERT_FAULT_RECORD_RESET_FLAGS;
+    __HAL_RCC_CLEAR_RESET_FLAGS();
+
+    bool retained = fault_record_retained.events_magic == EVERT_FAULT_RECORD_MAGIC;
+    fault_record.new_record = false;
+
+    if (retained && EVERT_FAULT_RECORD_IsValid(record))
+    {
+        fault_record.new_record = true;
+    }
+    else if (retained && (fault_record.reset_cause & (RCC_CSR_IWDGRSTF | RCC_CSR_WWDGRSTF)) != 0)
+    {
+        // Watchdog: nothing was captured, the events show where the loop stopped
+        memset(record, 0, offsetof(EVERT_FAULT_RECORD_TypeDef, event_head));
+        EVERT_FAULT_RECORD_Seal(record, FRT_WATCHDOG);
+        fault_record.new_record = true;
+    }
+
+    if (fault_record.new_record)
+    {
+        record->reset_cause = fault_record.reset_cause;
+        record->crc = EVERT_FAULT_RECORD_Crc(record);
+        EVERT_FAULT_RECORD_Persist(record);
+    }
+    else
+    {
+        EVERT_FAULT_RECORD_Scan();
+    }
+
+    // Start this boot with an empty record and event ring
+    fault_record_retained.boot_count = retained ? fault_record_retained.boot_count + 1 : 0;
+    memset(record, 0, sizeof(*record));
+    fault_record_retained.events_magic = EVERT_FAULT_RECORD_MAGIC;
+}
+
+/// @brief Record in flash, 0 = newest
+const EVERT_FAULT_RECORD_TypeDef *EVERT_FAULT_RECORD_Get(const uint32_t index)
+{
+    uint32_t remaining = index;
+
+    for (int32_t slot = EVERT_FAULT_RECORD_SLOT_COUNT - 1; slot >= 0; slot--)
+    {
+        const EVERT_FAULT_RECORD_TypeDef *record = EVERT_FAULT_RECORD_Slot(slot);
+
+        if (!EVERT_FAULT_RECORD_IsValid(record))
+        {
+            continue;
+        }
+
+        if (remaining-- == 0)
+        {
+            return record;
+        }
+    }
+
+    return NULL;
+}
+
+/// @brief Called by EVERT_FAULT_RECORD_CAPTURE_FAULT
+/// @param sp Stack pointer selected by EXC_RETURN
+void EVERT_FAULT_RECORD_OnFault(uint32_t *sp, const uint32_t exc_return, const uint32_t type)
+{
+    EVERT_FAULT_RECORD_TypeDef *record = &fault_record_retained.record;
+
+    if (record->type != FRT_NONE)
+    {
+        return;
+    }
+
+    // On the main stack the handler's prologue may have pushed registers before the capture ran.
+    // When it saved LR (EXC_RETURN) the exception frame starts right above it.
+    uint32_t *frame = sp;
+
+    if ((exc_return & 0x4u) == 0)
+    {
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            if (sp[i] == exc_return)
+            {
+                frame = &sp[i + 1];
+                break;
+            }
+        }
+    }
+
+    memcpy(&record->frame, frame, sizeof(record->frame));
+    record->exc_return = exc_return;
+    record->sp = (uint32_t)(uintptr_t)frame;
+
+    static const char *const messages[] = {"", "HardFault", "MemManage", "BusFault", "UsageFault"};
+    strncpy(record->message, type < sizeof(messages) / sizeof(messages[0]) ? messages[type] : "Fault", EVERT_FAULT_RECORD_MESSAGE_SIZE - 1);
+
+    EVERT_FAULT_RECORD_Seal(record, (uint8_t)type);
+}
+
+/// @brief Capture a fatal error
+/// @param pc Address of the code that reported it (EVERT_FAULT_RECORD_CALLER in a HAL error callback), 0 if unknown
+void EVERT_FAULT_RECORD_CaptureError(const char *message, const uint32_t pc)
+{
+    EVERT_FAULT_RECORD_TypeDef *record = &fault_record_retained.record;
+
+    if (record->type != FRT_NONE)
+    {
+        return; // A fault handler got here first
+    }
+
+    memset(&record->frame, 0, sizeof(record->frame));
+    record->frame.pc = pc;
+    record->frame.xpsr = __get_xPSR();
+    record->sp = __get_MSP();
+
+    if (message != NULL)
+    {
+        strncpy(record->message, message, EVERT_FAULT_RECORD_MESSAGE_SIZE - 1);
+    }
+
+    EVERT_FAULT_RECORD_Seal(record, FRT_ERROR);
+}
+
+/// @brief Stop after a capture: halt for the debugger when one is attached, reset otherwise
+void EVERT_FAULT_RECORD_Halt(void)
+{
+    __disable_irq();
+
+#if EVERT_HAL_CONF_FAULT_RECORD_RESET
+    if ((CoreDebug->DHCSR & CoreDebug_DHCSR_C_DEBUGEN_Msk) == 0)
+    {
+        NVIC_SystemReset();
+    }
+#endif
+
+    while (1)
+    {
+    }
+}
+
+/// @brief Application context for the record (alarms, device state), runs in the fault context
+__weak void EVERT_FAULT_RECORD_OnCapture(EVERT_FAULT_RECORD_TypeDef *record)
+{
+    UNUSED(record);
+}
+
+#endif // EVERT_HAL_CONF_FAULT_RECORD_ENABLE
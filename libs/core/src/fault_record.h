@@ -0,0 +1,173 @@
+#ifndef EVERT_FAULT_RECORD_H_
+#define EVERT_FAULT_RECORD_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32g4xx_hal.h>
+#include "_conf_evert_hal.h"
+
+// Fault record: what the device was doing when it stopped, kept across the reset that follows.
+// * Capture: the fault handlers (stacked registers, CFSR/HFSR/MMFAR/BFAR) and the fatal error callbacks fill
+//   the record in .noinit RAM, which the startup code leaves alone. The first capture wins, it is the cause.
+// * Events: the last EVERT_FAULT_RECORD_EVENT_COUNT scheduler, CAN and state events, logged all the time
+// * Next boot: EVERT_FAULT_RECORD_Init reads the reset cause (RCC->CSR), validates the RAM record (magic, CRC)
+//   and appends it to the fault log in flash (FAULTS in the linker script, erased and restarted when full).
+//   A watchdog reset without a capture still gets a record, with the events that led up to it.
+// The application fills its own context (alarms, state) in EVERT_FAULT_RECORD_OnCapture and reports
+// EVERT_FAULT_RECORD_GetLatest over its link.
+
+#if EVERT_HAL_CONF_FAULT_RECORD_ENABLE
+
+#define EVERT_FAULT_RECORD_ADDRESS (EVERT_HAL_CONF_FAULT_RECORD_ADDRESS)
+#define EVERT_FAULT_RECORD_REGION_SIZE (EVERT_HAL_CONF_FAULT_RECORD_REGION_SIZE) // Multiple of 4 kB
+#define EVERT_FAULT_RECORD_EVENT_COUNT (EVERT_HAL_CONF_FAULT_RECORD_EVENT_COUNT)   // Power of 2
+
+#define EVERT_FAULT_RECORD_MAGIC (0x46525645u) // "EVRF"
+#define EVERT_FAULT_RECORD_VERSION (2) // 2: sync_time_us
+#define EVERT_FAULT_RECORD_MESSAGE_SIZE (32)
+#define EVERT_FAULT_RECORD_SLOT_COUNT (EVERT_FAULT_RECORD_REGION_SIZE / sizeof(EVERT_FAULT_RECORD_TypeDef))
+
+// Return address of the function it is used in: in a HAL error callback, the driver code that reported the error
+#define EVERT_FAULT_RECORD_CALLER() ((uint32_t)(uintptr_t)__builtin_return_address(0))
+
+typedef enum
+{
+    FRT_NONE = 0,
+    FRT_HARD_FAULT = 1,
+    FRT_MEM_MANAGE = 2,
+    FRT_BUS_FAULT = 3,
+    FRT_USAGE_FAULT = 4,
+    FRT_ERROR = 5,   // Fatal error callback (HAL error, failed check)
+    FRT_WATCHDOG = 6 // Watchdog reset without a capture
+} EVERT_FAULT_RECORD_TypeTypeDef;
+
+typedef enum
+{
+    FRE_NONE = 0,
+    FRE_TASK = 1,   // [0] task
+    FRE_CAN_RX = 2, // [0] message id, [1] source id, [2] data[0]
+    FRE_CAN_TX = 3, // [0] message id, [1] target id, [2] data[0]
+    FRE_STATE = 4,  // [0] new state, [1] old state
+    FRE_USER = 5    // Application defined
+} EVERT_FAULT_RECORD_EventTypeTypeDef;
+
+typedef struct
+{
+    uint32_t tick;
+    uint8_t type; // EVERT_FAULT_RECORD_EventTypeTypeDef
+    uint8_t data[3];
+} EVERT_FAULT_RECORD_EventTypeDef;
+
+/// @brief Registers stacked by the exception entry
+typedef struct
+{
+    uint32_t r0;
+    uint32_t r1;
+    uint32_t r2;
+    uint32_t r3;
+    uint32_t r12;
+    uint32_t lr;
+    uint32_t pc;
+    uint32_t xpsr;
+} EVERT_FAULT_RECORD_StackFrameTypeDef;
+
+typedef struct
+{
+    uint32_t magic;
+    uint8_t version;
+    uint8_t type; // EVERT_FAULT_RECORD_TypeTypeDef
+    uint16_t boot_count;
+    uint32_t tick;         // HAL tick at the capture
+    uint32_t reset_cause;  // RCC->CSR reset flags of the boot that followed
+    uint64_t sync_time_us; // Synchronized time at the capture (time_sync.h), 0 without a synchronized clock
+
+    EVERT_FAULT_RECORD_StackFrameTypeDef frame; // Faults: stacked registers, errors: pc of the code that reported it, 0 if unknown
+    uint32_t exc_return;
+    uint32_t sp; // Stack pointer at the fault (exception frame address)
+    uint32_t cfsr;
+    uint32_t hfsr;
+    uint32_t mmfar;
+    uint32_t bfar;
+
+    // Application context (EVERT_FAULT_RECORD_OnCapture)
+    uint32_t alarms[2];
+    uint8_t state_internal;
+    uint8_t state_propagated;
+    uint16_t reserved;
+
+    char message[EVERT_FAULT_RECORD_MESSAGE_SIZE];
+
+    uint32_t event_head; // Next event slot, the oldest when the ring has wrapped
+    EVERT_FAULT_RECORD_EventTypeDef events[EVERT_FAULT_RECORD_EVENT_COUNT];
+
+    uint32_t padding;
+    uint32_t crc; // Over everything before it, last double word in flash so a torn write is ignored
+} EVERT_FAULT_RECORD_TypeDef;
+
+/// @brief Survives resets (.noinit), only valid with the magic and CRC set
+typedef struct
+{
+    EVERT_FAULT_RECORD_TypeDef record;
+    uint32_t events_magic; // The event ring holds events of this power cycle
+    uint16_t boot_count;
+} EVERT_FAULT_RECORD_RetainedTypeDef;
+
+typedef struct
+{
+    uint32_t reset_cause;                     // RCC->CSR reset flags of this boot
+    const EVERT_FAULT_RECORD_TypeDef *latest; // Newest record in flash, NULL if none
+    uint32_t count;                           // Records in flash
+    bool new_record;                          // The last reset left a record, report it
+} EVERT_FAULT_RECORD_HandlerTypeDef;
+
+extern EVERT_FAULT_RECORD_RetainedTypeDef fault_record_retained;
+extern EVERT_FAULT_RECORD_HandlerTypeDef fault_record;
+
+void EVERT_FAULT_RECORD_Init(void);
+const EVERT_FAULT_RECORD_TypeDef *EVERT_FAULT_RECORD_Get(const uint32_t index);
+void EVERT_FAULT_RECORD_OnFault(uint32_t *sp, const uint32_t exc_return, const uint32_t type);
+void EVERT_FAULT_RECORD_CaptureError(const char *message, const uint32_t pc);
+void EVERT_FAULT_RECORD_Halt(void) __attribute__((noreturn));
+
+void EVERT_FAULT_RECORD_OnCapture(EVERT_FAULT_RECORD_TypeDef *record);
+
+/// @brief Newest record in flash (index 0), NULL if none
+static inline const EVERT_FAULT_RECORD_TypeDef *EVERT_FAULT_RECORD_GetLatest(void)
+{
+    return fault_record.latest;
+}
+
+/// @brief Append to the event ring, any context (a racing ISR may overwrite a slot, never corrupt the ring)
+static inline void EVERT_FAULT_RECORD_LogEvent(const uint8_t type, const uint8_t data0, const uint8_t data1, const uint8_t data2)
+{
+    EVERT_FAULT_RECORD_TypeDef *record = &fault_record_retained.record;
+
+    if (record->type != FRT_NONE)
+    {
+        return; // Captured, keep the events that led up to it
+    }
+
+    EVERT_FAULT_RECORD_EventTypeDef *event = &record->events[record->event_head++ & (EVERT_FAULT_RECORD_EVENT_COUNT - 1)];
+    event->tick = HAL_GetTick();
+    event->type = type;
+    event->data[0] = data0;
+    event->data[1] = data1;
+    event->data[2] = data2;
+}
+
+/// @brief Capture a fault, first statement of a fault handler (before any call changes LR)
+/// @details LR still holds EXC_RETURN, which tells the stack the exception frame was pushed on
+#define EVERT_FAULT_RECORD_CAPTURE_FAULT(type_)      \
+    __asm volatile("tst lr, #4\n\t"                  \
+                   "ite eq\n\t"                      \
+                   "mrseq r0, msp\n\t"               \
+                   "mrsne r0, psp\n\t"               \
+                   "mov r1, lr\n\t"                  \
+                   "movs r2, %0\n\t"                 \
+                   "bl EVERT_FAULT_RECORD_OnFault\n\t" \
+                   :                                 \
+                   : "i"(type_)                      \
+                   : "r0", "r1", "r2", "r3", "r12", "lr", "cc", "memory")
+
+#endif // EVERT_HAL_CONF_FAULT_RECORD_ENABLE
+#endif // EVERT_FAULT_RECORD_H_
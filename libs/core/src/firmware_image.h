@@ -0,0 +1,142 @@
+#ifndef EVERT_FIRMWARE_IMAGE_H_
+#define EVERT_FIRMWARE_IMAGE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "crc.h"
+
+// Firmware image slots of the A/B update (firmware_update.h) and the bootloader (bootloader/).
+// * Dual bank mode (DBANK = 1, default): two banks of 256 kB, the one the device booted from is at 0x08000000,
+//   the other at 0x08040000. BFB2 (option byte) selects the bank to boot from, SYSCFG->MEMRMP FB_MODE tells
+//   which physical bank is mapped first. An update goes into the other bank while the application runs (read
+//   while write), switching the bank is the bootloader's job.
+// * Layout of each bank:
+//   0x00000  16 kB  bootloader, the updater copies its own to the other bank
+//   0x04000   2 kB  header page: the image header, then the boot state at EVERT_FIRMWARE_IMAGE_STATE_OFFSET
+//   0x04800 226 kB  application, linked at 0x08004800 (vector table first)
+//   0x3D000  12 kB  fault log and parameter store (FAULTS, PARAMS in the linker script), used in the bank at
+//                   0x08040000 only; the new image takes them over from the old bank on its first boot
+// * Header: written last by the updater, once the application bytes check out against it. No valid header: an
+//   image flashed over SWD, booted as it is.
+// * Boot state: double words programmed once from erased (to 0), so an image records its progress without an
+//   erase. Erased confirmed: the image is on trial, the bootloader counts its boots and rolls back once they
+//   run out, the application confirms it when the device got operational.
+
+#define EVERT_FIRMWARE_IMAGE_BANK_SIZE (0x40000u)
+#define EVERT_FIRMWARE_IMAGE_ACTIVE_BASE (0x08000000u) // Bank booted from
+#define EVERT_FIRMWARE_IMAGE_OTHER_BASE (0x08040000u)  // Bank the update goes to
+#define EVERT_FIRMWARE_IMAGE_BOOT_SIZE (0x4000u)
+#define EVERT_FIRMWARE_IMAGE_HEADER_OFFSET (0x4000u)
+#define EVERT_FIRMWARE_IMAGE_STATE_OFFSET (0x4400u)
+#define EVERT_FIRMWARE_IMAGE_APP_OFFSET (0x4800u)
+#define EVERT_FIRMWARE_IMAGE_APP_SIZE_MAX (0x38800u)
+#define EVERT_FIRMWARE_IMAGE_DATA_OFFSET (0x3D000u)
+#define EVERT_FIRMWARE_IMAGE_DATA_SIZE (0x3000u)
+#define EVERT_FIRMWARE_IMAGE_RAM_BASE (0x20000000u)
+#define EVERT_FIRMWARE_IMAGE_RAM_SIZE (0x20000u)
+
+#define EVERT_FIRMWARE_IMAGE_MAGIC (0x57465645u) // "EVFW"
+#define EVERT_FIRMWARE_IMAGE_HEADER_VERSION (1)
+#define EVERT_FIRMWARE_IMAGE_ATTEMPT_COUNT (3) // Boots of an image on trial before the bootloader rolls it back
+#define EVERT_FIRMWARE_IMAGE_MARK (0x0000000000000000ull)
+#define EVERT_FIRMWARE_IMAGE_ERASED (0xFFFFFFFFFFFFFFFFull)
+
+typedef enum
+{
+    FIT_BOOST_CONVERTER = 1,
+    FIT_INVERTER = 2
+} EVERT_FIRMWARE_IMAGE_TargetTypeDef;
+
+/// @brief First bytes of the update stream, programmed at EVERT_FIRMWARE_IMAGE_HEADER_OFFSET
+typedef struct
+{
+    uint32_t magic;
+    uint8_t header_version;
+    uint8_t target;     // EVERT_FIRMWARE_IMAGE_TargetTypeDef
+    uint8_t version[3]; // Major, minor, patch as BCCM_DEVICE_STATE reports them
+    uint8_t reserved[3];
+    uint32_t size;       // Application bytes, a multiple of 8 (padded with 0xFF)
+    uint32_t crc;        // CRC-32 of the application bytes (crc.h)
+    uint32_t header_crc; // CRC-32 of the fields above
+} EVERT_FIRMWARE_IMAGE_HeaderTypeDef;
+
+/// @brief At EVERT_FIRMWARE_IMAGE_STATE_OFFSET, each double word erased or EVERT_FIRMWARE_IMAGE_MARK
+typedef struct
+{
+    uint64_t activate;                                     // Updater: boot this image, the bootloader switches the bank once
+    uint64_t attempts[EVERT_FIRMWARE_IMAGE_ATTEMPT_COUNT]; // Bootloader: one per boot on trial
+    uint64_t confirmed;                                    // Application: the device got operational
+    uint64_t migrated;                                     // Application: fault log and parameters taken over
+    uint64_t rejected;                                     // Out of boots, CRC mismatch or trial timeout: roll back
+} EVERT_FIRMWARE_IMAGE_StateTypeDef;
+
+_Static_assert(sizeof(EVERT_FIRMWARE_IMAGE_HeaderTypeDef) % 8 == 0, "Header must be whole double words");
+_Static_assert(EVERT_FIRMWARE_IMAGE_APP_OFFSET + EVERT_FIRMWARE_IMAGE_APP_SIZE_MAX == EVERT_FIRMWARE_IMAGE_DATA_OFFSET, "Application must end at the data region");
+
+static inline const EVERT_FIRMWARE_IMAGE_HeaderTypeDef *EVERT_FIRMWARE_IMAGE_Header(const uintptr_t base)
+{
+    return (const EVERT_FIRMWARE_IMAGE_HeaderTypeDef *)(base + EVERT_FIRMWARE_IMAGE_HEADER_OFFSET);
+}
+
+static inline const EVERT_FIRMWARE_IMAGE_StateTypeDef *EVERT_FIRMWARE_IMAGE_State(const uintptr_t base)
+{
+    return (const EVERT_FIRMWARE_IMAGE_StateTypeDef *)(base + EVERT_FIRMWARE_IMAGE_STATE_OFFSET);
+}
+
+static inline bool EVERT_FIRMWARE_IMAGE_IsMarked(const volatile uint64_t *word)
+{
+    return *word != EVERT_FIRMWARE_IMAGE_ERASED;
+}
+
+static inline uint32_t EVERT_FIRMWARE_IMAGE_HeaderCrc(const EVERT_FIRMWARE_IMAGE_HeaderTypeDef *header)
+{
+    return EVERT_CRC32(header, offsetof(EVERT_FIRMWARE_IMAGE_HeaderTypeDef, header_crc));
+}
+
+/// @brief Header itself, not the application bytes
+static inline bool EVERT_FIRMWARE_IMAGE_IsHeaderValid(const EVERT_FIRMWARE_IMAGE_HeaderTypeDef *header)
+{
+    return header->magic == EVERT_FIRMWARE_IMAGE_MAGIC && header->header_version == EVERT_FIRMWARE_IMAGE_HEADER_VERSION &&
+           header->size > 0 && header->size <= EVERT_FIRMWARE_IMAGE_APP_SIZE_MAX && header->size % 8 == 0 &&
+           header->header_crc == EVERT_FIRMWARE_IMAGE_HeaderCrc(header);
+}
+
+/// @brief Vector table of the application in the bank at base: stack in RAM, reset handler in the application
+static inline bool EVERT_FIRMWARE_IMAGE_HasVectors(const uintptr_t base)
+{
+    const uint32_t *vectors = (const uint32_t *)(base + EVERT_FIRMWARE_IMAGE_APP_OFFSET);
+    uint32_t stack = vectors[0];
+    uint32_t reset = vectors[1] & ~1u;
+
+    return stack > EVERT_FIRMWARE_IMAGE_RAM_BASE && stack <= EVERT_FIRMWARE_IMAGE_RAM_BASE + EVERT_FIRMWARE_IMAGE_RAM_SIZE &&
+           reset >= EVERT_FIRMWARE_IMAGE_ACTIVE_BASE + EVERT_FIRMWARE_IMAGE_APP_OFFSET && reset < EVERT_FIRMWARE_IMAGE_ACTIVE_BASE + EVERT_FIRMWARE_IMAGE_DATA_OFFSET;
+}
+
+/// @brief Image the bootloader may roll back to: not rejected, confirmed or flashed over SWD (no header)
+static inline bool EVERT_FIRMWARE_IMAGE_IsFallback(const uintptr_t base)
+{
+    const EVERT_FIRMWARE_IMAGE_StateTypeDef *state = EVERT_FIRMWARE_IMAGE_State(base);
+
+    if (!EVERT_FIRMWARE_IMAGE_HasVectors(base) || EVERT_FIRMWARE_IMAGE_IsMarked(&state->rejected))
+    {
+        return false;
+    }
+
+    return !EVERT_FIRMWARE_IMAGE_IsHeaderValid(EVERT_FIRMWARE_IMAGE_Header(base)) || EVERT_FIRMWARE_IMAGE_IsMarked(&state->confirmed);
+}
+
+/// @brief Boots on trial so far
+static inline uint32_t EVERT_FIRMWARE_IMAGE_AttemptCount(const EVERT_FIRMWARE_IMAGE_StateTypeDef *state)
+{
+    uint32_t count = 0;
+
+    while (count < EVERT_FIRMWARE_IMAGE_ATTEMPT_COUNT && EVERT_FIRMWARE_IMAGE_IsMarked(&state->attempts[count]))
+    {
+        count++;
+    }
+
+    return count;
+}
+
+#endif // EVERT_FIRMWARE_IMAGE_H_
@@ -0,0 +1,408 @@
+#include "firmware_update.h"
+#include <string.h>
+#include "param_store.h"
+
+#if EVERT_HAL_CONF_FIRMWARE_UPDATE_ENABLE
+
+_Static_assert(EVERT_FIRMWARE_UPDATE_COPY_CHUNK % 8 == 0 && EVERT_FIRMWARE_IMAGE_BOOT_SIZE % EVERT_FIRMWARE_UPDATE_COPY_CHUNK == 0, "Bootloader copy must be whole chunks of double words");
+
+EVERT_FIRMWARE_UPDATE_HandlerTypeDef firmware_update = {0};
+
+/// @brief Physical bank mapped at EVERT_FIRMWARE_IMAGE_OTHER_BASE, the erase takes physical banks
+static inline uint32_t EVERT_FIRMWARE_UPDATE_OtherBank(void)
+{
+    return READ_BIT(SYSCFG->MEMRMP, SYSCFG_MEMRMP_FB_MODE) != 0U ? FLASH_BANK_1 : FLASH_BANK_2;
+}
+
+static inline const EVERT_FIRMWARE_IMAGE_StateTypeDef *EVERT_FIRMWARE_UPDATE_ActiveState(void)
+{
+    return EVERT_FIRMWARE_IMAGE_State(EVERT_FIRMWARE_IMAGE_ACTIVE_BASE);
+}
+
+static inline const EVERT_FIRMWARE_IMAGE_StateTypeDef *EVERT_FIRMWARE_UPDATE_OtherState(void)
+{
+    return EVERT_FIRMWARE_IMAGE_State(EVERT_FIRMWARE_IMAGE_OTHER_BASE);
+}
+
+/// @brief The data cache may hold what the other bank read before its pages were erased
+static void EVERT_FIRMWARE_UPDATE_FlushDataCache(void)
+{
+    if (READ_BIT(FLASH->ACR, FLASH_ACR_DCEN) != 0U)
+    {
+        __HAL_FLASH_DATA_CACHE_DISABLE();
+        __HAL_FLASH_DATA_CACHE_RESET();
+        __HAL_FLASH_DATA_CACHE_ENABLE();
+    }
+}
+
+/// @brief Page erase picked up: flags checked, the erase bits cleared for the next flash operation
+static void EVERT_FIRMWARE_UPDATE_EraseCollect(void)
+{
+    firmware_update.erasing = false;
+    firmware_update.erase_error |= READ_BIT(FLASH->SR, FLASH_FLAG_SR_ERRORS) != 0U;
+
+    CLEAR_BIT(FLASH->CR, FLASH_CR_PER | FLASH_CR_PNB);
+    HAL_FLASH_Lock();
+}
+
+/// @brief Start the erase of a page of the other bank and return, the flash stays unlocked until it is collected
+static void EVERT_FIRMWARE_UPDATE_EraseStart(const uint32_t page)
+{
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_ALL_ERRORS);
+
+    firmware_update.erasing = true;
+    FLASH_PageErase(page, EVERT_FIRMWARE_UPDATE_OtherBank());
+}
+
+/// @brief Program one double word, read back
+static bool EVERT_FIRMWARE_UPDATE_Program(const uint32_t address, const void *data)
+{
+    uint64_t double_word;
+    memcpy(&double_word, data, sizeof(double_word));
+
+    EVERT_FIRMWARE_UPDATE_WaitForFlash();
+
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_ALL_ERRORS);
+    HAL_StatusTypeDef status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, address, double_word);
+    HAL_FLASH_Lock();
+
+    return status == HAL_OK && *(const volatile uint64_t *)(uintptr_t)address == double_word;
+}
+
+/// @brief Boot state double word, programmed once
+static bool EVERT_FIRMWARE_UPDATE_Mark(const uint64_t *word)
+{
+    const uint64_t mark = EVERT_FIRMWARE_IMAGE_MARK;
+
+    return EVERT_FIRMWARE_IMAGE_IsMarked(word) || EVERT_FIRMWARE_UPDATE_Program((uint32_t)(uintptr_t)word, &mark);
+}
+
+static EVERT_FIRMWARE_UPDATE_ResultTypeDef EVERT_FIRMWARE_UPDATE_Fail(const EVERT_FIRMWARE_UPDATE_ResultTypeDef result)
+{
+    firmware_update.state = FUS_FAILED;
+    firmware_update.result = result;
+
+    return result;
+}
+
+/// @brief Fault log and parameter store from the top of the old bank (now at 0x08000000) to the addresses of the
+/// linker script (top of the bank at 0x08040000). Blocking (6 page erases), before the watchdogs start.
+static bool EVERT_FIRMWARE_UPDATE_Migrate(void)
+{
+    FLASH_EraseInitTypeDef erase = {0};
+    uint32_t page_error = 0;
+
+    erase.TypeErase = FLASH_TYPEERASE_PAGES;
+    erase.Banks = EVERT_FIRMWARE_UPDATE_OtherBank();
+    erase.Page = EVERT_FIRMWARE_IMAGE_DATA_OFFSET / FLASH_PAGE_SIZE;
+    erase.NbPages = EVERT_FIRMWARE_IMAGE_DATA_SIZE / FLASH_PAGE_SIZE;
+
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_ALL_ERRORS);
+    HAL_StatusTypeDef status = HAL_FLASHEx_Erase(&erase, &page_error);
+    HAL_FLASH_Lock();
+
+    for (uint32_t offset = 0; status == HAL_OK && offset < EVERT_FIRMWARE_IMAGE_DATA_SIZE; offset += sizeof(uint64_t))
+    {
+        const uint64_t *word = (const uint64_t *)(uintptr_t)(EVERT_FIRMWARE_IMAGE_ACTIVE_BASE + EVERT_FIRMWARE_IMAGE_DATA_OFFSET + offset);
+
+        if (*word != EVERT_FIRMWARE_IMAGE_ERASED && !EVERT_FIRMWARE_UPDATE_Program(EVERT_FIRMWARE_IMAGE_OTHER_BASE + EVERT_FIRMWARE_IMAGE_DATA_OFFSET + offset, word))
+        {
+            status = HAL_ERROR;
+        }
+    }
+
+    return status == HAL_OK;
+}
+
+/// @brief Reject the running image, reset into the old one if there is one to go back to
+static void EVERT_FIRMWARE_UPDATE_Reject(void)
+{
+    firmware_update.trial = false;
+
+    if (EVERT_FIRMWARE_UPDATE_Mark(&EVERT_FIRMWARE_UPDATE_ActiveState()->rejected) && EVERT_FIRMWARE_IMAGE_IsFallback(EVERT_FIRMWARE_IMAGE_OTHER_BASE))
+    {
+        NVIC_SystemReset();
+    }
+}
+
+/// @brief First thing at boot, before the fault log and the parameter store are read
+/// @param target EVERT_FIRMWARE_IMAGE_TargetTypeDef of this firmware, images for another one are refused
+void EVERT_FIRMWARE_UPDATE_Init(const uint8_t target)
+{
+    memset(&firmware_update, 0, sizeof(firmware_update));
+    firmware_update.target = target;
+    firmware_update.trial_start_ms = HAL_GetTick();
+
+    const EVERT_FIRMWARE_IMAGE_StateTypeDef *state = EVERT_FIRMWARE_UPDATE_ActiveState();
+
+    if (READ_BIT(FLASH->OPTR, FLASH_OPTR_DBANK) == 0U || !EVERT_FIRMWARE_IMAGE_IsHeaderValid(EVERT_FIRMWARE_IMAGE_Header(EVERT_FIRMWARE_IMAGE_ACTIVE_BASE)))
+    {
+        return; // Flashed over SWD: not on trial, nothing to take over
+    }
+
+    firmware_update.trial = !EVERT_FIRMWARE_IMAGE_IsMarked(&state->confirmed) && !EVERT_FIRMWARE_IMAGE_IsMarked(&state->rejected);
+
+    if (firmware_update.trial && !EVERT_FIRMWARE_IMAGE_IsMarked(&state->migrated) && EVERT_FIRMWARE_UPDATE_Migrate())
+    {
+        EVERT_FIRMWARE_UPDATE_Mark(&state->migrated);
+    }
+}
+
+/// @brief Start an update, the other slot is erased from the next EVERT_FIRMWARE_UPDATE_Process on
+/// @param size Application bytes that follow the header
+EVERT_FIRMWARE_UPDATE_ResultTypeDef EVERT_FIRMWARE_UPDATE_Begin(const uint32_t size)
+{
+    if (READ_BIT(FLASH->OPTR, FLASH_OPTR_DBANK) == 0U)
+    {
+        return FUR_UNSUPPORTED;
+    }
+
+    if (firmware_update.trial)
+    {
+        return FUR_STATE; // The other bank holds the image to go back to
+    }
+
+    if (size == 0 || size > EVERT_FIRMWARE_IMAGE_APP_SIZE_MAX || size % 8 != 0)
+    {
+        return FUR_SIZE;
+    }
+
+    EVERT_FIRMWARE_UPDATE_WaitForFlash();
+
+    firmware_update.state = FUS_ERASING;
+    firmware_update.result = FUR_OK;
+    firmware_update.size = EVERT_FIRMWARE_UPDATE_HEADER_SIZE + size;
+    firmware_update.received = 0;
+    firmware_update.page = 0;
+    firmware_update.page_count = (EVERT_FIRMWARE_IMAGE_APP_OFFSET + size + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE;
+    firmware_update.erase_error = false;
+
+    return FUR_OK;
+}
+
+/// @brief Stream bytes from offset on (the header first), offset must be the count taken so far
+EVERT_FIRMWARE_UPDATE_ResultTypeDef EVERT_FIRMWARE_UPDATE_Write(const uint32_t offset, const uint8_t *data, const uint32_t length)
+{
+    if (firmware_update.state != FUS_RECEIVING)
+    {
+        return FUR_STATE;
+    }
+
+    if (offset != firmware_update.received)
+    {
+        return FUR_SEQUENCE;
+    }
+
+    for (uint32_t i = 0; i < length && firmware_update.received < firmware_update.size; i++, firmware_update.received++)
+    {
+        if (firmware_update.received < EVERT_FIRMWARE_UPDATE_HEADER_SIZE)
+        {
+            ((uint8_t *)&firmware_update.header)[firmware_update.received] = data[i];
+
+            if (firmware_update.received + 1 == EVERT_FIRMWARE_UPDATE_HEADER_SIZE)
+            {
+                const EVERT_FIRMWARE_IMAGE_HeaderTypeDef *header = &firmware_update.header;
+
+                if (!EVERT_FIRMWARE_IMAGE_IsHeaderValid(header) || header->target != firmware_update.target)
+                {
+                    return EVERT_FIRMWARE_UPDATE_Fail(FUR_HEADER);
+                }
+
+                if (EVERT_FIRMWARE_UPDATE_HEADER_SIZE + header->size != firmware_update.size)
+                {
+                    return EVERT_FIRMWARE_UPDATE_Fail(FUR_SIZE);
+                }
+            }
+
+            continue;
+        }
+
+        uint32_t position = firmware_update.received - EVERT_FIRMWARE_UPDATE_HEADER_SIZE;
+        firmware_update.double_word[position % 8] = data[i];
+
+        if (position % 8 == 7 && !EVERT_FIRMWARE_UPDATE_Program(EVERT_FIRMWARE_IMAGE_OTHER_BASE + EVERT_FIRMWARE_IMAGE_APP_OFFSET + position - 7, firmware_update.double_word))
+        {
+            return EVERT_FIRMWARE_UPDATE_Fail(FUR_FLASH);
+        }
+    }
+
+    return FUR_OK;
+}
+
+/// @brief Whole stream received, the check and the rest run from EVERT_FIRMWARE_UPDATE_Process up to FUS_READY
+EVERT_FIRMWARE_UPDATE_ResultTypeDef EVERT_FIRMWARE_UPDATE_Finish(void)
+{
+    if (firmware_update.state != FUS_RECEIVING)
+    {
+        return firmware_update.state == FUS_VERIFYING || firmware_update.state == FUS_READY ? FUR_OK : FUR_STATE;
+    }
+
+    if (firmware_update.received != firmware_update.size)
+    {
+        return FUR_SIZE;
+    }
+
+    EVERT_FIRMWARE_UPDATE_FlushDataCache();
+
+    firmware_update.state = FUS_VERIFYING;
+    firmware_update.offset = 0;
+    firmware_update.crc = EVERT_CRC32_INIT;
+
+    return FUR_OK;
+}
+
+/// @brief Boot the new image: marked for the bootloader, then a reset. Returns only if it cannot.
+EVERT_FIRMWARE_UPDATE_ResultTypeDef EVERT_FIRMWARE_UPDATE_Activate(void)
+{
+    if (firmware_update.state != FUS_READY)
+    {
+        return FUR_STATE;
+    }
+
+    if (!EVERT_FIRMWARE_UPDATE_Mark(&EVERT_FIRMWARE_UPDATE_OtherState()->activate))
+    {
+        return EVERT_FIRMWARE_UPDATE_Fail(FUR_FLASH);
+    }
+
+    NVIC_SystemReset();
+
+    return FUR_OK;
+}
+
+/// @brief The device is operational, keep the image (call on every entry, only a trial does something)
+void EVERT_FIRMWARE_UPDATE_Confirm(void)
+{
+    if (firmware_update.trial && EVERT_FIRMWARE_UPDATE_Mark(&EVERT_FIRMWARE_UPDATE_ActiveState()->confirmed))
+    {
+        firmware_update.trial = false;
+    }
+}
+
+/// @brief Finish a page erase still running, e.g. before another flash operation
+void EVERT_FIRMWARE_UPDATE_WaitForFlash(void)
+{
+    if (!firmware_update.erasing)
+    {
+        return;
+    }
+
+    while (READ_BIT(FLASH->SR, FLASH_SR_BSY) != 0U)
+    {
+    }
+
+    EVERT_FIRMWARE_UPDATE_EraseCollect();
+}
+
+/// @brief Erase: the running page collected, the next one started
+static void EVERT_FIRMWARE_UPDATE_ProcessErase(void)
+{
+    if (firmware_update.erasing)
+    {
+        if (READ_BIT(FLASH->SR, FLASH_SR_BSY) != 0U)
+        {
+            return;
+        }
+
+        EVERT_FIRMWARE_UPDATE_EraseCollect();
+
+        if (firmware_update.erase_error)
+        {
+            EVERT_FIRMWARE_UPDATE_Fail(FUR_FLASH);
+            return;
+        }
+
+        firmware_update.page++;
+    }
+
+#if EVERT_HAL_CONF_PARAM_STORE_ENABLE
+    // A page erase of the parameter store started before the update finishes first, none starts during it
+    if (param_store.erasing)
+    {
+        return;
+    }
+#endif
+
+    if (firmware_update.page < firmware_update.page_count)
+    {
+        EVERT_FIRMWARE_UPDATE_EraseStart(firmware_update.page);
+        return;
+    }
+
+    EVERT_FIRMWARE_UPDATE_FlushDataCache();
+    firmware_update.state = FUS_RECEIVING;
+}
+
+/// @brief Verify: a chunk of the CRC, then a chunk of the bootloader copy, then the header
+static void EVERT_FIRMWARE_UPDATE_ProcessVerify(void)
+{
+    const uint32_t size = firmware_update.header.size;
+
+    if (firmware_update.offset < size)
+    {
+        uint32_t length = size - firmware_update.offset < EVERT_FIRMWARE_UPDATE_VERIFY_CHUNK ? size - firmware_update.offset : EVERT_FIRMWARE_UPDATE_VERIFY_CHUNK;
+
+        firmware_update.crc = EVERT_CRC32_Update(firmware_update.crc, (const void *)(uintptr_t)(EVERT_FIRMWARE_IMAGE_OTHER_BASE + EVERT_FIRMWARE_IMAGE_APP_OFFSET + firmware_update.offset), length);
+        firmware_update.offset += length;
+
+        if (firmware_update.offset == size && (firmware_update.crc ^ EVERT_CRC32_XOR_OUT) != firmware_update.header.crc)
+        {
+            EVERT_FIRMWARE_UPDATE_Fail(FUR_CRC);
+        }
+
+        return;
+    }
+
+    uint32_t copied = firmware_update.offset - size;
+
+    if (copied < EVERT_FIRMWARE_IMAGE_BOOT_SIZE)
+    {
+        for (uint32_t i = 0; i < EVERT_FIRMWARE_UPDATE_COPY_CHUNK; i += sizeof(uint64_t))
+        {
+            const uint64_t *word = (const uint64_t *)(uintptr_t)(EVERT_FIRMWARE_IMAGE_ACTIVE_BASE + copied + i);
+
+            if (*word != EVERT_FIRMWARE_IMAGE_ERASED && !EVERT_FIRMWARE_UPDATE_Program(EVERT_FIRMWARE_IMAGE_OTHER_BASE + copied + i, word))
+            {
+                EVERT_FIRMWARE_UPDATE_Fail(FUR_FLASH);
+                return;
+            }
+        }
+
+        firmware_update.offset += EVERT_FIRMWARE_UPDATE_COPY_CHUNK;
+        return;
+    }
+
+    // Header last, it makes the image valid
+    for (uint32_t i = 0; i < EVERT_FIRMWARE_UPDATE_HEADER_SIZE; i += sizeof(uint64_t))
+    {
+        if (!EVERT_FIRMWARE_UPDATE_Program(EVERT_FIRMWARE_IMAGE_OTHER_BASE + EVERT_FIRMWARE_IMAGE_HEADER_OFFSET + i, (const uint8_t *)&firmware_update.header + i))
+        {
+            EVERT_FIRMWARE_UPDATE_Fail(FUR_FLASH);
+            return;
+        }
+    }
+
+    firmware_update.state = FUS_READY;
+}
+
+/// @brief Main loop: trial timeout, one step of the erase or the verification
+void EVERT_FIRMWARE_UPDATE_Process(void)
+{
+    if (firmware_update.trial && HAL_GetTick() - firmware_update.trial_start_ms >= EVERT_FIRMWARE_UPDATE_TRIAL_TIMEOUT_MS)
+    {
+        EVERT_FIRMWARE_UPDATE_Reject();
+    }
+
+    if (firmware_update.state == FUS_ERASING)
+    {
+        EVERT_FIRMWARE_UPDATE_ProcessErase();
+    }
+    else if (firmware_update.state == FUS_VERIFYING)
+    {
+        EVERT_FIRMWARE_UPDATE_ProcessVerify();
+    }
+}
+
+#endif // EVERT_HAL_CONF_FIRMWARE_UPDATE_ENABLE
@@ -0,0 +1,92 @@
+#ifndef EVERT_FIRMWARE_UPDATE_H_
+#define EVERT_FIRMWARE_UPDATE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32g4xx_hal.h>
+#include "_conf_evert_hal.h"
+#include "firmware_image.h"
+
+// Firmware update into the other bank (A/B slots, firmware_image.h), the transport is the application's.
+// * Begin: the pages of the other slot (bootloader, header page, application) are erased one per
+//   EVERT_FIRMWARE_UPDATE_Process pass without waiting for the flash, a page takes ~22 ms and the main loop
+//   keeps running. The fault log and the parameter store at the top of the other bank are left alone.
+// * Stream: the image header (EVERT_FIRMWARE_IMAGE_HeaderTypeDef), then the application bytes, in order.
+//   The header is checked and held in RAM, the application is programmed a double word at a time (~85 us,
+//   the other bank reads while it writes).
+// * Finish: the application bytes are checked against the header CRC, this bootloader is copied to the other
+//   bank and the header goes last, in chunks per pass. A reset before that leaves no valid image behind.
+// * Activate: marks the image to boot and resets, the bootloader switches the bank (option bytes) with the
+//   watchdogs still off and boots the new image on trial
+// * Trial: Init takes the fault log and the parameters over from the old bank on the first boot, Confirm keeps
+//   the image once the device is operational. Not confirmed within EVERT_FIRMWARE_UPDATE_TRIAL_TIMEOUT_MS (or
+//   out of boots, bootloader) the image is rejected and the old one boots again; what was stored during the
+//   trial stays with the rejected image.
+// Dual bank mode only (DBANK = 1, the default), Begin refuses otherwise.
+
+#if EVERT_HAL_CONF_FIRMWARE_UPDATE_ENABLE
+
+#define EVERT_FIRMWARE_UPDATE_TRIAL_TIMEOUT_MS (EVERT_HAL_CONF_FIRMWARE_UPDATE_TRIAL_TIMEOUT_MS)
+#define EVERT_FIRMWARE_UPDATE_HEADER_SIZE (sizeof(EVERT_FIRMWARE_IMAGE_HeaderTypeDef))
+#define EVERT_FIRMWARE_UPDATE_VERIFY_CHUNK (0x1000u) // Application bytes checked per pass
+#define EVERT_FIRMWARE_UPDATE_COPY_CHUNK (0x100u)    // Bootloader bytes copied per pass (32 double words, ~2.7 ms)
+
+typedef enum
+{
+    FUS_IDLE = 0,
+    FUS_ERASING = 1,   // Pages of the other slot
+    FUS_RECEIVING = 2, // Stream: header, then the application
+    FUS_VERIFYING = 3, // CRC of the application, bootloader copy, header
+    FUS_READY = 4,     // Valid image in the other bank, EVERT_FIRMWARE_UPDATE_Activate boots it
+    FUS_FAILED = 5     // result says why, Begin starts over
+} EVERT_FIRMWARE_UPDATE_StateTypeDef;
+
+typedef enum
+{
+    FUR_OK = 0,
+    FUR_STATE = 1,       // Not in this state
+    FUR_UNSUPPORTED = 2, // Single bank mode
+    FUR_SIZE = 3,        // Application larger than the slot, or not what Begin announced
+    FUR_HEADER = 4,      // Magic, format, target or CRC of the header
+    FUR_SEQUENCE = 5,    // Stream bytes not at the next offset
+    FUR_FLASH = 6,       // Erase or program error
+    FUR_CRC = 7,         // Application bytes against the header
+    FUR_REFUSED = 8      // By the application, e.g. while the converter runs
+} EVERT_FIRMWARE_UPDATE_ResultTypeDef;
+
+typedef struct
+{
+    EVERT_FIRMWARE_UPDATE_StateTypeDef state;
+    EVERT_FIRMWARE_UPDATE_ResultTypeDef result; // Of the failure
+    uint8_t target;                             // EVERT_FIRMWARE_IMAGE_TargetTypeDef of this firmware
+
+    // Running image
+    bool trial; // Booted on trial, not confirmed yet
+    uint32_t trial_start_ms;
+
+    // Update
+    EVERT_FIRMWARE_IMAGE_HeaderTypeDef header;
+    uint32_t size;       // Stream bytes, header and application
+    uint32_t received;   // Stream bytes taken
+    uint32_t page;       // ERASING: next page
+    uint32_t page_count; // Pages of the slot the image needs
+    bool erasing;        // A page erase is running
+    bool erase_error;
+    uint32_t offset; // VERIFYING: application bytes checked, then bootloader bytes copied
+    uint32_t crc;
+    uint8_t double_word[8]; // Application bytes of the double word being filled
+} EVERT_FIRMWARE_UPDATE_HandlerTypeDef;
+
+extern EVERT_FIRMWARE_UPDATE_HandlerTypeDef firmware_update;
+
+void EVERT_FIRMWARE_UPDATE_Init(const uint8_t target);
+EVERT_FIRMWARE_UPDATE_ResultTypeDef EVERT_FIRMWARE_UPDATE_Begin(const uint32_t size);
+EVERT_FIRMWARE_UPDATE_ResultTypeDef EVERT_FIRMWARE_UPDATE_Write(const uint32_t offset, const uint8_t *data, const uint32_t length);
+EVERT_FIRMWARE_UPDATE_ResultTypeDef EVERT_FIRMWARE_UPDATE_Finish(void);
+EVERT_FIRMWARE_UPDATE_ResultTypeDef EVERT_FIRMWARE_UPDATE_Activate(void);
+void EVERT_FIRMWARE_UPDATE_Confirm(void);
+void EVERT_FIRMWARE_UPDATE_Process(void);
+void EVERT_FIRMWARE_UPDATE_WaitForFlash(void);
+
+#endif // EVERT_HAL_CONF_FIRMWARE_UPDATE_ENABLE
+#endif // EVERT_FIRMWARE_UPDATE_H_
@@ -1,15 +1,33 @@
 #include <stdbool.h>
+#include <string.h>
 #include "fz2812.h"
 
 #if EVERT_FZ2812_LED_COUNT > 0
 
-#define EVERT_FZ2812_RGB_BUFFER_LENGTH (EVERT_FZ2812_RGB_DATA_LENGTH_BITS_TOTAL)
-#define TIM2_CCR1_ADDRESS ((uint32_t) & TIM2->CCR1)
+#define EVERT_FZ2812_BIT(nibble, bit) (((nibble) & (1 << (bit))) ? EVERT_FZ2812_PWM_CCR_1BIT : EVERT_FZ2812_PWM_CCR_0BIT)
+#define EVERT_FZ2812_NIBBLE(nibble) {EVERT_FZ2812_BIT(nibble, 3), EVERT_FZ2812_BIT(nibble, 2), EVERT_FZ2812_BIT(nibble, 1), EVERT_FZ2812_BIT(nibble, 0)}
+
+// CCR values for the 4 bits of a nibble, MSB first
+static const uint16_t fz2812_nibble_lut[16][4] = {
+    EVERT_FZ2812_NIBBLE(0x0), EVERT_FZ2812_NIBBLE(0x1), EVERT_FZ2812_NIBBLE(0x2), EVERT_FZ2812_NIBBLE(0x3),
+    EVERT_FZ2812_NIBBLE(0x4), EVERT_FZ2812_NIBBLE(0x5), EVERT_FZ2812_NIBBLE(0x6), EVERT_FZ2812_NIBBLE(0x7),
+    EVERT_FZ2812_NIBBLE(0x8), EVERT_FZ2812_NIBBLE(0x9), EVERT_FZ2812_NIBBLE(0xA), EVERT_FZ2812_NIBBLE(0xB),
+    EVERT_FZ2812_NIBBLE(0xC), EVERT_FZ2812_NIBBLE(0xD), EVERT_FZ2812_NIBBLE(0xE), EVERT_FZ2812_NIBBLE(0xF),
+};
 
 static TIM_HandleTypeDef *fz2812_htim;
-static uint32_t fz2812_buffer[EVERT_FZ2812_RGB_BUFFER_LENGTH] = {0};
+static uint16_t fz2812_buffer[EVERT_FZ2812_DMA_BUFFER_LENGTH] = {0};
 static EVERT_FZ2812_LedDataTypeDef led_data[EVERT_FZ2812_LED_COUNT] = {0};
-static bool dma_ready = false;
+
+// Colors being sent, only written while the DMA is idle
+static uint32_t fz2812_frame[EVERT_FZ2812_LED_COUNT] = {0};
+static bool fz2812_dirty = false;
+
+// Transfer state, owned by the DMA interrupts while busy
+static volatile bool dma_busy = false;
+static uint32_t fz2812_next_led = 0;
+static uint32_t fz2812_zero_bits = 0;
+static uint32_t fz2812_half_trailing_zero_bits[2] = {0};
 
 void EVERT_FZ2812_Init(TIM_HandleTypeDef *htim)
 {
@@ -22,9 +40,13 @@ void EVERT_FZ2812_Init(TIM_HandleTypeDef *htim)
         led_data[i].on = false;
         led_data[i].on_time = 0;
         led_data[i].off_time = 0;
-        led_data[i].on_counter = 0;
-        led_data[i].off_counter = 0;
+        led_data[i].toggle_tick = 0;
+        fz2812_frame[i] = 0;
     }
+
+    // Send the all-off frame once so the chain starts in a known state
+    fz2812_dirty = true;
+    dma_busy = false;
 }
 
 void EVERT_FZ2812_SetBlink(uint8_t led_index, uint32_t on_time, uint32_t off_time)
@@ -58,77 +80,145 @@ void EVERT_FZ2812_SetColorRgb(uint8_t led_index, uint8_t r, uint8_t g, uint8_t b
     led_data[led_index].color = (g << 16) | (r << 8) | b;
 }
 
+bool EVERT_FZ2812_IsBusy(void)
+{
+    return dma_busy;
+}
+
+/// @brief Encode one GRB color as 24 CCR values, MSB first
+static inline void EVERT_FZ2812_EncodeLed(uint16_t *out, const uint32_t grb)
+{
+    for (int32_t shift = 20; shift >= 0; shift -= 4)
+    {
+        memcpy(out, fz2812_nibble_lut[(grb >> shift) & 0xF], sizeof(fz2812_nibble_lut[0]));
+        out += 4;
+    }
+}
+
+/// @brief Fill one half of the DMA ring with the next LEDs, zeros (line low) once the frame is out
+static void EVERT_FZ2812_FillHalf(const uint32_t half)
+{
+    uint16_t *out = &fz2812_buffer[half * EVERT_FZ2812_DMA_HALF_LENGTH];
+    uint32_t trailing_zero_bits = 0;
+
+    for (uint32_t i = 0; i < EVERT_FZ2812_DMA_LEDS; i++)
+    {
+        if (fz2812_next_led < EVERT_FZ2812_LED_COUNT)
+        {
+            EVERT_FZ2812_EncodeLed(out, fz2812_frame[fz2812_next_led++]);
+            trailing_zero_bits = 0;
+        }
+        else
+        {
+            memset(out, 0, EVERT_FZ2812_RGB_DATA_LENGTH_BITS * sizeof(uint16_t));
+            trailing_zero_bits += EVERT_FZ2812_RGB_DATA_LENGTH_BITS;
+        }
+
+        out += EVERT_FZ2812_RGB_DATA_LENGTH_BITS;
+    }
+
+    fz2812_half_trailing_zero_bits[half] = trailing_zero_bits;
+}
+
+/// @brief A half of the ring has been moved to the CCR, stop after the reset or refill it
+static void EVERT_FZ2812_OnHalfSent(const uint32_t half)
+{
+    if (fz2812_half_trailing_zero_bits[half] == EVERT_FZ2812_DMA_HALF_LENGTH)
+    {
+        fz2812_zero_bits += EVERT_FZ2812_DMA_HALF_LENGTH;
+    }
+    else
+    {
+        fz2812_zero_bits = fz2812_half_trailing_zero_bits[half];
+    }
+
+    // The last CCR value written is 0, so the line stays low after the stop
+    if (fz2812_zero_bits >= EVERT_FZ2812_RGB_DATA_LENGTH_BITS_RESET)
+    {
+        HAL_TIM_PWM_Stop_DMA(fz2812_htim, TIM_CHANNEL_1);
+        dma_busy = false;
+        return;
+    }
+
+    EVERT_FZ2812_FillHalf(half);
+}
+
+static inline uint32_t EVERT_FZ2812_GetColor(EVERT_FZ2812_LedDataTypeDef *led, const uint32_t tick)
+{
+    // If the led should be blinking
+    if (led->on_time == 0 || led->off_time == 0)
+    {
+        return led->color;
+    }
+
+    uint32_t elapsed = tick - led->toggle_tick;
+
+    if (elapsed >= (led->on ? led->on_time : led->off_time))
+    {
+        led->on = !led->on;
+        led->toggle_tick = tick;
+    }
+
+    return led->on ? led->color : 0;
+}
+
 void EVERT_FZ2812_Update(void)
 {
-    if (!dma_ready)
+    // The frame is read by the DMA interrupts while busy, changes are picked up on a later call
+    if (dma_busy)
     {
         return;
     }
 
-    uint32_t buffer_index = 0;
+    uint32_t tick = HAL_GetTick();
 
     for (size_t i = 0; i < EVERT_FZ2812_LED_COUNT; i++)
     {
-        uint32_t color = led_data[i].color;
+        uint32_t color = EVERT_FZ2812_GetColor(&led_data[i], tick);
 
-        // If the led should be blinking
-        if (led_data[i].on_time > 0 && led_data[i].off_time > 0)
+        if (color != fz2812_frame[i])
         {
-            if (led_data[i].on)
-            {
-                if (led_data[i].on_counter < led_data[i].on_time)
-                {
-                    led_data[i].on_counter++;
-                }
-                else
-                {
-                    led_data[i].on = false;
-                    led_data[i].on_counter = 0;
-                }
-            }
-            else
-            {
-                color = 0;
-
-                if (led_data[i].off_counter < led_data[i].off_time)
-                {
-                    led_data[i].off_counter++;
-                }
-                else
-                {
-                    led_data[i].on = true;
-                    led_data[i].off_counter = 0;
-                }
-            }
+            fz2812_frame[i] = color;
+            fz2812_dirty = true;
         }
+    }
 
-        // Set the color data to the buffer
-        for (int j = 23; j >= 0; j--)
-        {
-            if (color & (1 << j))
-            {
-                fz2812_buffer[buffer_index] = EVERT_FZ2812_PWM_CCR_1BIT;
-            }
-            else
-            {
-                fz2812_buffer[buffer_index] = EVERT_FZ2812_PWM_CCR_0BIT;
-            }
-
-            buffer_index++;
-        }
+    // Only re-encode and send when something changed
+    if (!fz2812_dirty)
+    {
+        return;
     }
 
-    HAL_TIM_PWM_Start_DMA(fz2812_htim, TIM_CHANNEL_1, fz2812_buffer, EVERT_FZ2812_RGB_DATA_LENGTH_BITS_TOTAL);
-    dma_ready = false;
+    fz2812_dirty = false;
+    fz2812_next_led = 0;
+    fz2812_zero_bits = 0;
+
+    EVERT_FZ2812_FillHalf(0);
+    EVERT_FZ2812_FillHalf(1);
+
+    dma_busy = true;
+
+    if (HAL_TIM_PWM_Start_DMA(fz2812_htim, TIM_CHANNEL_1, (const uint32_t *)fz2812_buffer, EVERT_FZ2812_DMA_BUFFER_LENGTH) != HAL_OK)
+    {
+        dma_busy = false;
+        fz2812_dirty = true;
+    }
+}
+
+void HAL_TIM_PWM_PulseFinishedHalfCpltCallback(TIM_HandleTypeDef *htim)
+{
+    if (htim == fz2812_htim)
+    {
+        EVERT_FZ2812_OnHalfSent(0);
+    }
 }
 
 void HAL_TIM_PWM_PulseFinishedCallback(TIM_HandleTypeDef *htim)
 {
     if (htim == fz2812_htim)
     {
-        HAL_TIM_PWM_Stop_DMA(htim, TIM_CHANNEL_1);
-        dma_ready = true;
+        EVERT_FZ2812_OnHalfSent(1);
     }
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -9,6 +9,7 @@
 #ifndef EVERT_CORE_FZ2812_H_
 #define EVERT_CORE_FZ2812_H_
 
+#include <stdbool.h>
 #include <stm32g4xx_hal.h>
 #include "_conf_evert_hal.h"
 
@@ -20,6 +21,17 @@
 #define EVERT_FZ2812_RGB_DATA_LENGTH_BITS (24)       // 24-bits of data per LED
 #define EVERT_FZ2812_RGB_DATA_LENGTH_BITS_TOTAL ((EVERT_FZ2812_RGB_DATA_LENGTH_BITS * EVERT_HAL_CONF_FZ2812_COUNT) + EVERT_FZ2812_RGB_DATA_LENGTH_BITS_RESET)
 #define EVERT_FZ2812_RGB_DATA_LENGTH_BYTES ((EVERT_FZ2812_RGB_DATA_LENGTH_BITS * EVERT_HAL_CONF_FZ2812_COUNT) / 8)
+
+// DMA ring: two halves of EVERT_FZ2812_DMA_LEDS LEDs each, refilled from the half/full transfer interrupts.
+// Requires the TIM channel DMA in circular mode, half-word memory and word peripheral alignment.
+#ifdef EVERT_HAL_CONF_FZ2812_DMA_LEDS
+#define EVERT_FZ2812_DMA_LEDS (EVERT_HAL_CONF_FZ2812_DMA_LEDS)
+#else
+#define EVERT_FZ2812_DMA_LEDS ((EVERT_FZ2812_LED_COUNT < 4) ? EVERT_FZ2812_LED_COUNT : 4)
+#endif
+#define EVERT_FZ2812_DMA_HALF_LENGTH (EVERT_FZ2812_DMA_LEDS * EVERT_FZ2812_RGB_DATA_LENGTH_BITS)
+#define EVERT_FZ2812_DMA_BUFFER_LENGTH (2 * EVERT_FZ2812_DMA_HALF_LENGTH)
+
 #define EVERT_FZ2812_PWM_FREQUENCY (800000f)                                                                                          // 800kHz
 #define EVERT_FZ2812_PWM_PERIOD_TICKS (212)                                                                                           //
 #define EVERT_FZ2812_PWM_PERIOD (1.25f)                                                                                               // 1.25us
@@ -34,10 +46,9 @@ typedef struct
 {
     uint32_t color;
     bool on;
-    uint32_t on_time;
-    uint32_t off_time;
-    uint32_t on_counter;
-    uint32_t off_counter;
+    uint32_t on_time;     // ms
+    uint32_t off_time;    // ms
+    uint32_t toggle_tick; // HAL tick of the last blink toggle
 } EVERT_FZ2812_LedDataTypeDef;
 
 void EVERT_FZ2812_Init(TIM_HandleTypeDef *htim);
@@ -45,6 +56,7 @@ void EVERT_FZ2812_SetBlink(uint8_t led_index, uint32_t on_time, uint32_t off_tim
 void EVERT_FZ2812_SetColor(uint8_t led_index, uint32_t grb);
 void EVERT_FZ2812_SetColorRgb(uint8_t led_index, uint8_t r, uint8_t g, uint8_t b);
 void EVERT_FZ2812_Update(void);
+bool EVERT_FZ2812_IsBusy(void);
 
 #endif // EVERT_FZ2812_LED_COUNT > 0
 #endif // EVERT_CORE_FZ2812_H_
\ No newline at end of file
@@ -0,0 +1,332 @@
+#include <string.h>
+#include "i2c_queue.h"
+
+static void EVERT_I2C_QUEUE_StartNext(EVERT_I2C_QUEUE_HandlerTypeDef *queue);
+
+static inline uint32_t EVERT_I2C_QUEUE_EnterCritical(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    return primask;
+}
+
+static inline void EVERT_I2C_QUEUE_ExitCritical(const uint32_t primask)
+{
+    __set_PRIMASK(primask);
+}
+
+void EVERT_I2C_QUEUE_Init(EVERT_I2C_QUEUE_HandlerTypeDef *queue, I2C_HandleTypeDef *hi2c, EVERT_I2C_QUEUE_TransactionTypeDef *items, const uint32_t size, const uint32_t timeout_ms, const uint8_t max_attempts)
+{
+    queue->hi2c = hi2c;
+    queue->buffer = items;
+    queue->head = 0;
+    queue->tail = 0;
+    queue->count = 0;
+    queue->size = size;
+    queue->busy = false;
+    queue->stalled = false;
+    queue->start_tick = 0;
+    queue->timeout_ms = timeout_ms;
+    queue->max_attempts = max_attempts > 0 ? max_attempts : 1;
+    queue->error_count = 0;
+    queue->recovery_count = 0;
+    queue->scl_port = NULL;
+    queue->sda_port = NULL;
+}
+
+/// @brief Pins of the bus for the bus clear of the timeout recovery, the AF pins of the handle
+void EVERT_I2C_QUEUE_SetBusClear(EVERT_I2C_QUEUE_HandlerTypeDef *queue, GPIO_TypeDef *scl_port, const uint16_t scl_pin, GPIO_TypeDef *sda_port, const uint16_t sda_pin)
+{
+    queue->scl_port = scl_port;
+    queue->scl_pin = scl_pin;
+    queue->sda_port = sda_port;
+    queue->sda_pin = sda_pin;
+}
+
+static EVERT_I2C_QUEUE_StatusTypeDef EVERT_I2C_QUEUE_Push(EVERT_I2C_QUEUE_HandlerTypeDef *queue, const EVERT_I2C_QUEUE_TransactionTypeDef *transaction)
+{
+    uint32_t primask = EVERT_I2C_QUEUE_EnterCritical();
+
+    if (queue->count == queue->size)
+    {
+        EVERT_I2C_QUEUE_ExitCritical(primask);
+        return I2C_QS_FULL;
+    }
+
+    queue->buffer[queue->tail] = *transaction;
+    queue->tail = (queue->tail + 1) % queue->size;
+    queue->count++;
+
+    // Kick the bus if it was idle, otherwise the completion interrupt picks it up
+    if (!queue->busy)
+    {
+        EVERT_I2C_QUEUE_StartNext(queue);
+    }
+
+    EVERT_I2C_QUEUE_ExitCritical(primask);
+    return I2C_QS_OK;
+}
+
+EVERT_I2C_QUEUE_StatusTypeDef EVERT_I2C_QUEUE_Write(EVERT_I2C_QUEUE_HandlerTypeDef *queue, const uint16_t device_address, const uint16_t register_address, const uint8_t *data, const uint8_t length, EVERT_I2C_QUEUE_CallbackTypeDef callback, void *context)
+{
+    if (length == 0 || length > EVERT_I2C_QUEUE_DATA_SIZE)
+    {
+        return I2C_QS_INVALID;
+    }
+
+    EVERT_I2C_QUEUE_TransactionTypeDef transaction = {
+        .device_address = device_address,
+        .register_address = register_address,
+        .direction = I2C_QD_WRITE,
+        .length = length,
+        .attempts = 0,
+        .callback = callback,
+        .context = context,
+    };
+    memcpy(transaction.data, data, length);
+
+    return EVERT_I2C_QUEUE_Push(queue, &transaction);
+}
+
+EVERT_I2C_QUEUE_StatusTypeDef EVERT_I2C_QUEUE_Read(EVERT_I2C_QUEUE_HandlerTypeDef *queue, const uint16_t device_address, const uint16_t register_address, const uint8_t length, EVERT_I2C_QUEUE_CallbackTypeDef callback, void *context)
+{
+    if (length == 0 || length > EVERT_I2C_QUEUE_DATA_SIZE)
+    {
+        return I2C_QS_INVALID;
+    }
+
+    EVERT_I2C_QUEUE_TransactionTypeDef transaction = {
+        .device_address = device_address,
+        .register_address = register_address,
+        .direction = I2C_QD_READ,
+        .length = length,
+        .attempts = 0,
+        .callback = callback,
+        .context = context,
+    };
+
+    return EVERT_I2C_QUEUE_Push(queue, &transaction);
+}
+
+bool EVERT_I2C_QUEUE_IsIdle(const EVERT_I2C_QUEUE_HandlerTypeDef *queue)
+{
+    return !queue->busy && queue->count == 0;
+}
+
+/// @brief Start the transaction at the head of the queue
+/// @details Called with interrupts masked or from the I2C interrupt itself
+static void EVERT_I2C_QUEUE_StartNext(EVERT_I2C_QUEUE_HandlerTypeDef *queue)
+{
+    while (queue->count > 0)
+    {
+        EVERT_I2C_QUEUE_TransactionTypeDef *transaction = &queue->buffer[queue->head];
+        uint16_t address = transaction->device_address << 1;
+        HAL_StatusTypeDef status;
+
+        transaction->attempts++;
+
+        if (transaction->direction == I2C_QD_READ)
+        {
+            status = queue->hi2c->hdmarx != NULL
+                         ? HAL_I2C_Mem_Read_DMA(queue->hi2c, address, transaction->register_address, I2C_MEMADD_SIZE_8BIT, transaction->data, transaction->length)
+                         : HAL_I2C_Mem_Read_IT(queue->hi2c, address, transaction->register_address, I2C_MEMADD_SIZE_8BIT, transaction->data, transaction->length);
+        }
+        else
+        {
+            status = queue->hi2c->hdmatx != NULL
+                         ? HAL_I2C_Mem_Write_DMA(queue->hi2c, address, transaction->register_address, I2C_MEMADD_SIZE_8BIT, transaction->data, transaction->length)
+                         : HAL_I2C_Mem_Write_IT(queue->hi2c, address, transaction->register_address, I2C_MEMADD_SIZE_8BIT, transaction->data, transaction->length);
+        }
+
+        if (status == HAL_OK)
+        {
+            queue->busy = true;
+            queue->stalled = false;
+            queue->start_tick = HAL_GetTick();
+            return;
+        }
+
+        // Bus still busy (e.g. a previous transfer being torn down, or a slave holding SDA), retry from Process.
+        // The timeout runs from the first attempt that did not start, so a bus that stays busy gets recovered
+        if (status == HAL_BUSY)
+        {
+            transaction->attempts--;
+            queue->busy = false;
+
+            if (!queue->stalled)
+            {
+                queue->stalled = true;
+                queue->start_tick = HAL_GetTick();
+            }
+
+            return;
+        }
+
+        queue->stalled = false;
+
+        if (transaction->attempts < queue->max_attempts)
+        {
+            continue;
+        }
+
+        // Give up on this one and move to the next
+        EVERT_I2C_QUEUE_TransactionTypeDef failed = *transaction;
+        queue->head = (queue->head + 1) % queue->size;
+        queue->count--;
+        queue->error_count++;
+
+        if (failed.callback != NULL)
+        {
+            failed.callback(&failed, I2C_QS_ERROR);
+        }
+    }
+
+    queue->busy = false;
+    queue->stalled = false;
+}
+
+/// @brief Finish the active transaction and start the next one
+static void EVERT_I2C_QUEUE_Complete(EVERT_I2C_QUEUE_HandlerTypeDef *queue, const EVERT_I2C_QUEUE_StatusTypeDef status)
+{
+    if (!queue->busy || queue->count == 0)
+    {
+        return;
+    }
+
+    EVERT_I2C_QUEUE_TransactionTypeDef *transaction = &queue->buffer[queue->head];
+
+    // Retry in place, the transaction stays at the head of the queue
+    if (status != I2C_QS_OK && transaction->attempts < queue->max_attempts)
+    {
+        queue->busy = false;
+        EVERT_I2C_QUEUE_StartNext(queue);
+        return;
+    }
+
+    // Copy out before freeing the slot, the callback may queue new transactions
+    EVERT_I2C_QUEUE_TransactionTypeDef done = *transaction;
+    queue->head = (queue->head + 1) % queue->size;
+    queue->count--;
+    queue->busy = false;
+
+    if (status != I2C_QS_OK)
+    {
+        queue->error_count++;
+    }
+
+    if (done.callback != NULL)
+    {
+        done.callback(&done, status);
+    }
+
+    if (!queue->busy)
+    {
+        EVERT_I2C_QUEUE_StartNext(queue);
+    }
+}
+
+/// @brief Half a period of SCL at 100 kHz, busy wait
+static void EVERT_I2C_QUEUE_BusClearDelay(void)
+{
+    for (volatile uint32_t i = SystemCoreClock / 1000000u; i > 0; i--)
+    {
+    }
+}
+
+/// @brief Clock a slave holding SDA low out of its byte (up to 9 SCL pulses), then a STOP
+/// @details The peripheral is deinitialized, HAL_I2C_Init gives the pins back to it
+static void EVERT_I2C_QUEUE_BusClear(EVERT_I2C_QUEUE_HandlerTypeDef *queue)
+{
+    GPIO_InitTypeDef gpio = {.Mode = GPIO_MODE_OUTPUT_OD, .Pull = GPIO_NOPULL, .Speed = GPIO_SPEED_FREQ_LOW};
+
+    if (queue->scl_port == NULL || queue->sda_port == NULL)
+    {
+        return;
+    }
+
+    HAL_GPIO_WritePin(queue->scl_port, queue->scl_pin, GPIO_PIN_SET);
+    HAL_GPIO_WritePin(queue->sda_port, queue->sda_pin, GPIO_PIN_SET);
+    gpio.Pin = queue->scl_pin;
+    HAL_GPIO_Init(queue->scl_port, &gpio);
+    gpio.Pin = queue->sda_pin;
+    HAL_GPIO_Init(queue->sda_port, &gpio);
+    EVERT_I2C_QUEUE_BusClearDelay();
+
+    for (uint32_t i = 0; i < 9 && HAL_GPIO_ReadPin(queue->sda_port, queue->sda_pin) == GPIO_PIN_RESET; i++)
+    {
+        HAL_GPIO_WritePin(queue->scl_port, queue->scl_pin, GPIO_PIN_RESET);
+        EVERT_I2C_QUEUE_BusClearDelay();
+        HAL_GPIO_WritePin(queue->scl_port, queue->scl_pin, GPIO_PIN_SET);
+        EVERT_I2C_QUEUE_BusClearDelay();
+    }
+
+    // STOP: SDA rising while SCL is high
+    HAL_GPIO_WritePin(queue->scl_port, queue->scl_pin, GPIO_PIN_RESET);
+    EVERT_I2C_QUEUE_BusClearDelay();
+    HAL_GPIO_WritePin(queue->sda_port, queue->sda_pin, GPIO_PIN_RESET);
+    EVERT_I2C_QUEUE_BusClearDelay();
+    HAL_GPIO_WritePin(queue->scl_port, queue->scl_pin, GPIO_PIN_SET);
+    EVERT_I2C_QUEUE_BusClearDelay();
+    HAL_GPIO_WritePin(queue->sda_port, queue->sda_pin, GPIO_PIN_SET);
+    EVERT_I2C_QUEUE_BusClearDelay();
+}
+
+/// @brief Handle timeouts and restart a stalled queue
+/// @details Call from the main loop
+void EVERT_I2C_QUEUE_Process(EVERT_I2C_QUEUE_HandlerTypeDef *queue)
+{
+    uint32_t primask = EVERT_I2C_QUEUE_EnterCritical();
+    bool expired = (queue->busy || queue->stalled) && (HAL_GetTick() - queue->start_tick) > queue->timeout_ms;
+    EVERT_I2C_QUEUE_ExitCritical(primask);
+
+    // Reset the peripheral to release a hung transfer or a busy bus (e.g. slave holding SDA), with interrupts
+    // enabled: the bus clear takes about 100 us, the I2C interrupts are off while the peripheral is down
+    if (expired)
+    {
+        HAL_I2C_DeInit(queue->hi2c);
+        EVERT_I2C_QUEUE_BusClear(queue);
+        HAL_I2C_Init(queue->hi2c);
+        queue->recovery_count++;
+    }
+
+    primask = EVERT_I2C_QUEUE_EnterCritical();
+
+    if (expired && queue->count > 0)
+    {
+        // A start that never happened counts as an attempt, so a bus that cannot be recovered fails the transaction
+        if (!queue->busy)
+        {
+            queue->buffer[queue->head].attempts++;
+            queue->busy = true;
+        }
+
+        queue->stalled = false;
+        EVERT_I2C_QUEUE_Complete(queue, I2C_QS_TIMEOUT);
+    }
+    else if (!queue->busy && queue->count > 0)
+    {
+        EVERT_I2C_QUEUE_StartNext(queue);
+    }
+
+    EVERT_I2C_QUEUE_ExitCritical(primask);
+}
+
+void EVERT_I2C_QUEUE_OnTransferComplete(EVERT_I2C_QUEUE_HandlerTypeDef *queue, I2C_HandleTypeDef *hi2c)
+{
+    if (hi2c != queue->hi2c)
+    {
+        return;
+    }
+
+    EVERT_I2C_QUEUE_Complete(queue, I2C_QS_OK);
+}
+
+void EVERT_I2C_QUEUE_OnError(EVERT_I2C_QUEUE_HandlerTypeDef *queue, I2C_HandleTypeDef *hi2c)
+{
+    if (hi2c != queue->hi2c)
+    {
+        return;
+    }
+
+    EVERT_I2C_QUEUE_Complete(queue, I2C_QS_ERROR);
+}
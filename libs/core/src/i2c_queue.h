@@ -0,0 +1,86 @@
+#ifndef EVERT_I2C_QUEUE_H_
+#define EVERT_I2C_QUEUE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stm32g4xx_hal.h>
+#include "_conf_evert_hal.h"
+
+// Register (memory) transaction queue for a shared I2C bus. Transactions are started back to back from the
+// completion interrupt, with DMA when the handle has DMA channels linked and interrupt transfers otherwise.
+// Each transaction carries its own completion callback, so several drivers can share one bus.
+// The application forwards the HAL I2C callbacks to EVERT_I2C_QUEUE_OnTransferComplete/OnError and calls
+// EVERT_I2C_QUEUE_Process from the main loop for the timeouts.
+// A transaction that does not complete, or cannot start because the bus stays busy, times out: the peripheral is reset
+// and, with the pins set by EVERT_I2C_QUEUE_SetBusClear, a slave holding SDA low is clocked free (9 SCL pulses and a STOP).
+
+#ifdef EVERT_HAL_CONF_I2C_QUEUE_DATA_SIZE
+#define EVERT_I2C_QUEUE_DATA_SIZE EVERT_HAL_CONF_I2C_QUEUE_DATA_SIZE
+#else
+#define EVERT_I2C_QUEUE_DATA_SIZE (8)
+#endif
+
+typedef enum
+{
+    I2C_QS_OK = 0,
+    I2C_QS_FULL = 1,
+    I2C_QS_INVALID = 2,
+    I2C_QS_ERROR = 3,
+    I2C_QS_TIMEOUT = 4
+} EVERT_I2C_QUEUE_StatusTypeDef;
+
+typedef enum
+{
+    I2C_QD_WRITE = 0,
+    I2C_QD_READ = 1
+} EVERT_I2C_QUEUE_DirectionTypeDef;
+
+typedef struct EVERT_I2C_QUEUE_Transaction EVERT_I2C_QUEUE_TransactionTypeDef;
+
+/// @brief Completion callback, called from interrupt context (or the main loop on timeout)
+typedef void (*EVERT_I2C_QUEUE_CallbackTypeDef)(const EVERT_I2C_QUEUE_TransactionTypeDef *transaction, const EVERT_I2C_QUEUE_StatusTypeDef status);
+
+struct EVERT_I2C_QUEUE_Transaction
+{
+    uint16_t device_address; // 7-bit address
+    uint16_t register_address;
+    EVERT_I2C_QUEUE_DirectionTypeDef direction;
+    uint8_t data[EVERT_I2C_QUEUE_DATA_SIZE]; // Write payload, or the read result
+    uint8_t length;
+    uint8_t attempts;
+    EVERT_I2C_QUEUE_CallbackTypeDef callback;
+    void *context;
+};
+
+typedef struct
+{
+    I2C_HandleTypeDef *hi2c;
+    EVERT_I2C_QUEUE_TransactionTypeDef *buffer;
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t count;
+    uint32_t size;
+    volatile bool busy;
+    volatile bool stalled; // Not started, the bus was busy, retried from Process
+    volatile uint32_t start_tick;
+    uint32_t timeout_ms;
+    uint8_t max_attempts;
+    uint32_t error_count;
+    uint32_t recovery_count;
+    GPIO_TypeDef *scl_port;
+    uint16_t scl_pin;
+    GPIO_TypeDef *sda_port;
+    uint16_t sda_pin;
+} EVERT_I2C_QUEUE_HandlerTypeDef;
+
+void EVERT_I2C_QUEUE_Init(EVERT_I2C_QUEUE_HandlerTypeDef *queue, I2C_HandleTypeDef *hi2c, EVERT_I2C_QUEUE_TransactionTypeDef *items, const uint32_t size, const uint32_t timeout_ms, const uint8_t max_attempts);
+void EVERT_I2C_QUEUE_SetBusClear(EVERT_I2C_QUEUE_HandlerTypeDef *queue, GPIO_TypeDef *scl_port, const uint16_t scl_pin, GPIO_TypeDef *sda_port, const uint16_t sda_pin);
+EVERT_I2C_QUEUE_StatusTypeDef EVERT_I2C_QUEUE_Write(EVERT_I2C_QUEUE_HandlerTypeDef *queue, const uint16_t device_address, const uint16_t register_address, const uint8_t *data, const uint8_t length, EVERT_I2C_QUEUE_CallbackTypeDef callback, void *context);
+EVERT_I2C_QUEUE_StatusTypeDef EVERT_I2C_QUEUE_Read(EVERT_I2C_QUEUE_HandlerTypeDef *queue, const uint16_t device_address, const uint16_t register_address, const uint8_t length, EVERT_I2C_QUEUE_CallbackTypeDef callback, void *context);
+void EVERT_I2C_QUEUE_Process(EVERT_I2C_QUEUE_HandlerTypeDef *queue);
+bool EVERT_I2C_QUEUE_IsIdle(const EVERT_I2C_QUEUE_HandlerTypeDef *queue);
+
+void EVERT_I2C_QUEUE_OnTransferComplete(EVERT_I2C_QUEUE_HandlerTypeDef *queue, I2C_HandleTypeDef *hi2c);
+void EVERT_I2C_QUEUE_OnError(EVERT_I2C_QUEUE_HandlerTypeDef *queue, I2C_HandleTypeDef *hi2c);
+
+#endif // EVERT_I2C_QUEUE_H_
@@ -0,0 +1,56 @@
+#include "oscillation_detector.h"
+
+void EVERT_OSCILLATION_DETECTOR_Init(EVERT_OSCILLATION_DETECTOR_StateTypeDef *detector, int8_t *buffer, const uint16_t size, const float32_t normalized_threshold)
+{
+    detector->buffer = buffer;
+    detector->size = size;
+    detector->normalized_threshold = normalized_threshold;
+
+    EVERT_OSCILLATION_DETECTOR_Reset(detector);
+}
+
+void EVERT_OSCILLATION_DETECTOR_Reset(EVERT_OSCILLATION_DETECTOR_StateTypeDef *detector)
+{
+    detector->index = 0;
+    detector->count = 0;
+    detector->positive_count = 0;
+
+    for (uint16_t i = 0; i < detector->size; i++)
+    {
+        detector->buffer[i] = 0;
+    }
+}
+
+void EVERT_OSCILLATION_DETECTOR_InjectData(EVERT_OSCILLATION_DETECTOR_StateTypeDef *detector, const float32_t data)
+{
+    int8_t sign = (data >= 0.0f) ? 1 : -1;
+
+    // Drop the oldest sample once the buffer is full
+    if (detector->count == detector->size)
+    {
+        detector->positive_count -= (detector->buffer[detector->index] > 0) ? 1 : 0;
+    }
+    else
+    {
+        detector->count++;
+    }
+
+    detector->buffer[detector->index] = sign;
+    detector->positive_count += (sign > 0) ? 1 : 0;
+    detector->index = (detector->index + 1) % detector->size;
+}
+
+bool EVERT_OSCILLATION_DETECTOR_IsOscillating(const EVERT_OSCILLATION_DETECTOR_StateTypeDef *detector)
+{
+    // Not enough history yet
+    if (detector->count < detector->size)
+    {
+        return false;
+    }
+
+    // Oscillating when both signs hold more than the threshold share of the window
+    float32_t threshold = detector->normalized_threshold * detector->size;
+    uint16_t negative_count = detector->count - detector->positive_count;
+
+    return detector->positive_count > threshold && negative_count > threshold;
+}
@@ -0,0 +1,26 @@
+#ifndef EVERT_OSCILLATION_DETECTOR_H_
+#define EVERT_OSCILLATION_DETECTOR_H_
+
+#include <arm_math.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Detects a signal that keeps flipping sign (e.g. a tracker hunting around its optimum) by keeping the
+// sign of the last N deltas in a ring buffer. Port of the old C++ evert::OscillationDetector, with the
+// buffer supplied by the caller and the positive count kept incrementally.
+typedef struct
+{
+    int8_t *buffer;
+    uint16_t size;
+    uint16_t index;
+    uint16_t count;
+    uint16_t positive_count;
+    float32_t normalized_threshold; // 0.0f - 0.5f, share of samples required on each side
+} EVERT_OSCILLATION_DETECTOR_StateTypeDef;
+
+void EVERT_OSCILLATION_DETECTOR_Init(EVERT_OSCILLATION_DETECTOR_StateTypeDef *detector, int8_t *buffer, const uint16_t size, const float32_t normalized_threshold);
+void EVERT_OSCILLATION_DETECTOR_Reset(EVERT_OSCILLATION_DETECTOR_StateTypeDef *detector);
+void EVERT_OSCILLATION_DETECTOR_InjectData(EVERT_OSCILLATION_DETECTOR_StateTypeDef *detector, const float32_t data);
+bool EVERT_OSCILLATION_DETECTOR_IsOscillating(const EVERT_OSCILLATION_DETECTOR_StateTypeDef *detector);
+
+#endif // EVERT_OSCILLATION_DETECTOR_H_
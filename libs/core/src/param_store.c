@@ -0,0 +1,452 @@
+#include "param_store.h"
+#include <stddef.h>
+#include "crc.h"
+#include "firmware_update.h"
+
+#if EVERT_HAL_CONF_PARAM_STORE_ENABLE
+
+_Static_assert(EVERT_PARAM_STORE_KEY_COUNT < EVERT_PARAM_STORE_RECORD_COUNT, "Parameter store region too small for a compaction");
+_Static_assert(sizeof(EVERT_PARAM_STORE_HeaderTypeDef) == EVERT_PARAM_STORE_RECORD_SIZE, "Header must be one record slot");
+_Static_assert(sizeof(EVERT_PARAM_STORE_RecordTypeDef) == EVERT_PARAM_STORE_RECORD_SIZE, "Record must be two double words");
+
+EVERT_PARAM_STORE_HandlerTypeDef param_store = {0};
+
+static inline uint32_t EVERT_PARAM_STORE_RegionAddress(const uint32_t region)
+{
+    return EVERT_PARAM_STORE_ADDRESS + (region * EVERT_PARAM_STORE_REGION_SIZE);
+}
+
+static inline const EVERT_PARAM_STORE_HeaderTypeDef *EVERT_PARAM_STORE_Header(const uint32_t region)
+{
+    return (const EVERT_PARAM_STORE_HeaderTypeDef *)(uintptr_t)EVERT_PARAM_STORE_RegionAddress(region);
+}
+
+static inline uint32_t EVERT_PARAM_STORE_HeaderCrc(const EVERT_PARAM_STORE_HeaderTypeDef *header)
+{
+    return EVERT_CRC32(header, offsetof(EVERT_PARAM_STORE_HeaderTypeDef, crc));
+}
+
+static inline uint32_t EVERT_PARAM_STORE_RecordCrc(const EVERT_PARAM_STORE_RecordTypeDef *record)
+{
+    return EVERT_CRC32(record, offsetof(EVERT_PARAM_STORE_RecordTypeDef, crc));
+}
+
+static inline bool EVERT_PARAM_STORE_IsHeaderValid(const EVERT_PARAM_STORE_HeaderTypeDef *header)
+{
+    return header->magic == EVERT_PARAM_STORE_MAGIC && header->version == EVERT_PARAM_STORE_VERSION && header->crc == EVERT_PARAM_STORE_HeaderCrc(header);
+}
+
+static inline bool EVERT_PARAM_STORE_IsErased(const uint32_t address)
+{
+    const uint32_t *words = (const uint32_t *)(uintptr_t)address;
+    return (words[0] & words[1] & words[2] & words[3]) == 0xFFFFFFFFu;
+}
+
+/// @brief Pages of a region from the first one on, 2 kB pages in dual bank mode (DBANK = 1, default) and 4 kB
+///        pages otherwise
+static void EVERT_PARAM_STORE_RegionPages(const uint32_t region, const uint32_t first, FLASH_EraseInitTypeDef *erase)
+{
+    uint32_t address = EVERT_PARAM_STORE_RegionAddress(region);
+
+    erase->TypeErase = FLASH_TYPEERASE_PAGES;
+
+    if (READ_BIT(FLASH->OPTR, FLASH_OPTR_DBANK) != 0U)
+    {
+        // The erase takes the physical bank, swapped with the mapping when booted from bank 2 (FB_MODE)
+        bool upper = address >= (FLASH_BASE + FLASH_BANK_SIZE);
+        bool bank2 = upper != (READ_BIT(SYSCFG->MEMRMP, SYSCFG_MEMRMP_FB_MODE) != 0U);
+        erase->Banks = bank2 ? FLASH_BANK_2 : FLASH_BANK_1;
+        erase->Page = (address - (upper ? FLASH_BASE + FLASH_BANK_SIZE : FLASH_BASE)) / FLASH_PAGE_SIZE;
+        erase->NbPages = EVERT_PARAM_STORE_REGION_SIZE / FLASH_PAGE_SIZE;
+    }
+    else
+    {
+        erase->Banks = FLASH_BANK_1;
+        erase->Page = (address - FLASH_BASE) / FLASH_PAGE_SIZE_128_BITS;
+        erase->NbPages = EVERT_PARAM_STORE_REGION_SIZE / FLASH_PAGE_SIZE_128_BITS;
+    }
+
+    erase->Page += first;
+    erase->NbPages -= first;
+}
+
+/// @brief Erase one region, blocking (Init, before the watchdogs start)
+static HAL_StatusTypeDef EVERT_PARAM_STORE_EraseRegion(const uint32_t region)
+{
+    FLASH_EraseInitTypeDef erase = {0};
+    uint32_t page_error = 0;
+
+    EVERT_PARAM_STORE_RegionPages(region, 0, &erase);
+
+#if EVERT_HAL_CONF_FIRMWARE_UPDATE_ENABLE
+    EVERT_FIRMWARE_UPDATE_WaitForFlash(); // A slot page erase of an update leaves its bits in FLASH->CR until collected
+#endif
+
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_ALL_ERRORS);
+    HAL_StatusTypeDef status = HAL_FLASHEx_Erase(&erase, &page_error);
+    HAL_FLASH_Lock();
+
+    return status;
+}
+
+/// @brief Page erase of the other region picked up: flags checked, the erase bits cleared for the next flash operation
+static void EVERT_PARAM_STORE_EraseCollect(void)
+{
+    param_store.erasing = false;
+    param_store.erase_error |= READ_BIT(FLASH->SR, FLASH_FLAG_SR_ERRORS) != 0U;
+
+    CLEAR_BIT(FLASH->CR, FLASH_CR_PER | FLASH_CR_PNB);
+    HAL_FLASH_Lock();
+}
+
+/// @brief Start the erase of the next page of the other region and return, the flash stays unlocked until it is collected
+static void EVERT_PARAM_STORE_EraseStart(void)
+{
+    FLASH_EraseInitTypeDef erase = {0};
+
+    EVERT_PARAM_STORE_RegionPages(param_store.region ^ 1U, param_store.erased_pages, &erase);
+
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_ALL_ERRORS);
+
+    param_store.erasing = true;
+    FLASH_PageErase(erase.Page, erase.Banks);
+}
+
+/// @brief The other region is erased and takes the next compaction
+static bool EVERT_PARAM_STORE_IsOtherErased(void)
+{
+    FLASH_EraseInitTypeDef erase = {0};
+
+    EVERT_PARAM_STORE_RegionPages(param_store.region ^ 1U, 0, &erase);
+
+    return !param_store.erasing && param_store.erased_pages >= erase.NbPages;
+}
+
+/// @brief Program one 16 byte slot, the double word holding the CRC goes last
+static HAL_StatusTypeDef EVERT_PARAM_STORE_ProgramSlot(const uint32_t address, const void *slot)
+{
+    uint64_t double_words[2];
+    memcpy(double_words, slot, sizeof(double_words));
+
+#if EVERT_HAL_CONF_FIRMWARE_UPDATE_ENABLE
+    EVERT_FIRMWARE_UPDATE_WaitForFlash();
+#endif
+
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_ALL_ERRORS);
+    HAL_StatusTypeDef status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, address, double_words[0]);
+
+    if (status == HAL_OK)
+    {
+        status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, address + sizeof(uint64_t), double_words[1]);
+    }
+
+    HAL_FLASH_Lock();
+
+    if (status == HAL_OK && memcmp((const void *)(uintptr_t)address, slot, EVERT_PARAM_STORE_RECORD_SIZE) != 0)
+    {
+        status = HAL_ERROR;
+    }
+
+    return status;
+}
+
+static HAL_StatusTypeDef EVERT_PARAM_STORE_ProgramRecord(const uint32_t region, const uint32_t offset, const uint16_t key, const uint8_t flags, const uint32_t value)
+{
+    EVERT_PARAM_STORE_RecordTypeDef record = {
+        .key = key,
+        .version = EVERT_PARAM_STORE_VERSION,
+        .flags = flags,
+        .value = value,
+        .sequence = param_store.sequence++,
+    };
+    record.crc = EVERT_PARAM_STORE_RecordCrc(&record);
+
+    return EVERT_PARAM_STORE_ProgramSlot(EVERT_PARAM_STORE_RegionAddress(region) + offset, &record);
+}
+
+/// @brief Header of an erased region, writing it makes the region a valid (and the newest) log
+static HAL_StatusTypeDef EVERT_PARAM_STORE_WriteHeader(const uint32_t region, const uint32_t generation)
+{
+    EVERT_PARAM_STORE_HeaderTypeDef header = {
+        .magic = EVERT_PARAM_STORE_MAGIC,
+        .version = EVERT_PARAM_STORE_VERSION,
+        .generation = generation,
+    };
+    header.crc = EVERT_PARAM_STORE_HeaderCrc(&header);
+
+    return EVERT_PARAM_STORE_ProgramSlot(EVERT_PARAM_STORE_RegionAddress(region), &header);
+}
+
+/// @brief Replay the active log into the RAM index
+static void EVERT_PARAM_STORE_Scan(void)
+{
+    uint32_t base = EVERT_PARAM_STORE_RegionAddress(param_store.region);
+    uint32_t offset = EVERT_PARAM_STORE_RECORD_SIZE;
+
+    for (uint32_t key = 0; key < EVERT_PARAM_STORE_KEY_COUNT; key++)
+    {
+        param_store.index[key].valid = false;
+        param_store.index[key].value = 0;
+    }
+
+    param_store.sequence = 0;
+    param_store.discarded = 0;
+
+    for (; offset < EVERT_PARAM_STORE_REGION_SIZE; offset += EVERT_PARAM_STORE_RECORD_SIZE)
+    {
+        if (EVERT_PARAM_STORE_IsErased(base + offset))
+        {
+            break;
+        }
+
+        const EVERT_PARAM_STORE_RecordTypeDef *record = (const EVERT_PARAM_STORE_RecordTypeDef *)(uintptr_t)(base + offset);
+
+        // Torn writes, records of another format version and keys this firmware no longer knows
+        if (record->crc != EVERT_PARAM_STORE_RecordCrc(record) || record->version != EVERT_PARAM_STORE_VERSION || record->key >= EVERT_PARAM_STORE_KEY_COUNT)
+        {
+            param_store.discarded++;
+            continue;
+        }
+
+        // Later records override earlier ones
+        param_store.index[record->key].valid = (record->flags & EVERT_PARAM_STORE_FLAG_ERASED) == 0;
+        param_store.index[record->key].value = record->value;
+
+        if (record->sequence >= param_store.sequence)
+        {
+            param_store.sequence = record->sequence + 1;
+        }
+    }
+
+    param_store.write_offset = offset;
+}
+
+EVERT_PARAM_STORE_StatusTypeDef EVERT_PARAM_STORE_Init(void)
+{
+    const EVERT_PARAM_STORE_HeaderTypeDef *header0 = EVERT_PARAM_STORE_Header(0);
+    const EVERT_PARAM_STORE_HeaderTypeDef *header1 = EVERT_PARAM_STORE_Header(1);
+    bool valid0 = EVERT_PARAM_STORE_IsHeaderValid(header0);
+    bool valid1 = EVERT_PARAM_STORE_IsHeaderValid(header1);
+
+    param_store.initialized = false;
+    param_store.compactions = 0;
+    param_store.erased_pages = 0; // The other region is erased again from the first EVERT_PARAM_STORE_Process on
+    param_store.erase_error = false;
+
+    if (valid0 || valid1)
+    {
+        // Both valid: a compaction finished but the old region was not reused yet
+        param_store.region = (valid1 && (!valid0 || (int32_t)(header1->generation - header0->generation) > 0)) ? 1 : 0;
+        param_store.generation = EVERT_PARAM_STORE_Header(param_store.region)->generation;
+    }
+    else
+    {
+        // Blank (or foreign) flash, start an empty log
+        param_store.region = 0;
+        param_store.generation = 1;
+
+        if (EVERT_PARAM_STORE_EraseRegion(0) != HAL_OK || EVERT_PARAM_STORE_WriteHeader(0, param_store.generation) != HAL_OK)
+        {
+            return PSS_ERROR;
+        }
+    }
+
+    EVERT_PARAM_STORE_Scan();
+    param_store.initialized = true;
+
+    return PSS_OK;
+}
+
+EVERT_PARAM_STORE_StatusTypeDef EVERT_PARAM_STORE_Get(const uint16_t key, uint32_t *value)
+{
+    if (!param_store.initialized)
+    {
+        return PSS_NOT_INITIALIZED;
+    }
+
+    if (key >= EVERT_PARAM_STORE_KEY_COUNT)
+    {
+        return PSS_INVALID_KEY;
+    }
+
+    if (!param_store.index[key].valid)
+    {
+        return PSS_NOT_FOUND;
+    }
+
+    *value = param_store.index[key].value;
+    return PSS_OK;
+}
+
+/// @brief Copy the latest value of each key to the other region, erased beforehand by EVERT_PARAM_STORE_Process
+/// @return PSS_BUSY while that erase is not done
+EVERT_PARAM_STORE_StatusTypeDef EVERT_PARAM_STORE_Compact(void)
+{
+    if (!param_store.initialized)
+    {
+        return PSS_NOT_INITIALIZED;
+    }
+
+    if (param_store.erase_error)
+    {
+        return PSS_ERROR;
+    }
+
+    if (!EVERT_PARAM_STORE_IsOtherErased())
+    {
+        return PSS_BUSY;
+    }
+
+    uint32_t target = param_store.region ^ 1U;
+    uint32_t offset = EVERT_PARAM_STORE_RECORD_SIZE;
+
+    // Programmed from here on, erased again before the next attempt
+    param_store.erased_pages = 0;
+
+    for (uint16_t key = 0; key < EVERT_PARAM_STORE_KEY_COUNT; key++)
+    {
+        if (!param_store.index[key].valid)
+        {
+            continue;
+        }
+
+        if (EVERT_PARAM_STORE_ProgramRecord(target, offset, key, 0, param_store.index[key].value) != HAL_OK)
+        {
+            return PSS_ERROR;
+        }
+
+        offset += EVERT_PARAM_STORE_RECORD_SIZE;
+    }
+
+    // Commit point, until the header is written the old region stays active
+    if (EVERT_PARAM_STORE_WriteHeader(target, param_store.generation + 1) != HAL_OK)
+    {
+        return PSS_ERROR;
+    }
+
+    param_store.region = target;
+    param_store.generation++;
+    param_store.write_offset = offset;
+    param_store.compactions++;
+
+    return PSS_OK;
+}
+
+static EVERT_PARAM_STORE_StatusTypeDef EVERT_PARAM_STORE_Append(const uint16_t key, const uint8_t flags, const uint32_t value)
+{
+    // Both regions share the bank, nothing is programmed while a page of it erases
+    if (param_store.erasing)
+    {
+        return PSS_BUSY;
+    }
+
+    if (param_store.write_offset + EVERT_PARAM_STORE_RECORD_SIZE > EVERT_PARAM_STORE_REGION_SIZE)
+    {
+        EVERT_PARAM_STORE_StatusTypeDef status = EVERT_PARAM_STORE_Compact();
+
+        if (status != PSS_OK)
+        {
+            return status;
+        }
+    }
+
+    if (EVERT_PARAM_STORE_ProgramRecord(param_store.region, param_store.write_offset, key, flags, value) != HAL_OK)
+    {
+        // Skip the slot, it is no longer erased
+        param_store.write_offset += EVERT_PARAM_STORE_RECORD_SIZE;
+        return PSS_ERROR;
+    }
+
+    param_store.write_offset += EVERT_PARAM_STORE_RECORD_SIZE;
+    param_store.index[key].valid = (flags & EVERT_PARAM_STORE_FLAG_ERASED) == 0;
+    param_store.index[key].value = value;
+
+    return PSS_OK;
+}
+
+EVERT_PARAM_STORE_StatusTypeDef EVERT_PARAM_STORE_Set(const uint16_t key, const uint32_t value)
+{
+    if (!param_store.initialized)
+    {
+        return PSS_NOT_INITIALIZED;
+    }
+
+    if (key >= EVERT_PARAM_STORE_KEY_COUNT)
+    {
+        return PSS_INVALID_KEY;
+    }
+
+    // Unchanged values cost no flash
+    if (param_store.index[key].valid && param_store.index[key].value == value)
+    {
+        return PSS_OK;
+    }
+
+    return EVERT_PARAM_STORE_Append(key, 0, value);
+}
+
+EVERT_PARAM_STORE_StatusTypeDef EVERT_PARAM_STORE_Erase(const uint16_t key)
+{
+    if (!param_store.initialized)
+    {
+        return PSS_NOT_INITIALIZED;
+    }
+
+    if (key >= EVERT_PARAM_STORE_KEY_COUNT)
+    {
+        return PSS_INVALID_KEY;
+    }
+
+    if (!param_store.index[key].valid)
+    {
+        return PSS_OK;
+    }
+
+    return EVERT_PARAM_STORE_Append(key, EVERT_PARAM_STORE_FLAG_ERASED, 0xFFFFFFFFu);
+}
+
+/// @brief Main loop: the other region erased a page per pass without waiting for the flash (~22 ms a page)
+void EVERT_PARAM_STORE_Process(void)
+{
+    if (!param_store.initialized)
+    {
+        return;
+    }
+
+    if (param_store.erasing)
+    {
+        if (READ_BIT(FLASH->SR, FLASH_SR_BSY) != 0U)
+        {
+            return;
+        }
+
+        EVERT_PARAM_STORE_EraseCollect();
+
+        if (param_store.erase_error)
+        {
+            return;
+        }
+
+        param_store.erased_pages++;
+    }
+
+    if (param_store.erase_error || EVERT_PARAM_STORE_IsOtherErased())
+    {
+        return;
+    }
+
+#if EVERT_HAL_CONF_FIRMWARE_UPDATE_ENABLE
+    // An update has the flash to itself from its first slot page erase to the verified image
+    if (firmware_update.erasing || firmware_update.state == FUS_ERASING || firmware_update.state == FUS_RECEIVING || firmware_update.state == FUS_VERIFYING)
+    {
+        return;
+    }
+#endif
+
+    EVERT_PARAM_STORE_EraseStart();
+}
+
+#endif // EVERT_HAL_CONF_PARAM_STORE_ENABLE
@@ -0,0 +1,120 @@
+#ifndef EVERT_PARAM_STORE_H_
+#define EVERT_PARAM_STORE_H_
+
+#include <arm_math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <stm32g4xx_hal.h>
+#include "_conf_evert_hal.h"
+
+// Persistent key-value parameter store in the last flash pages (reserved as PARAMS in the linker script).
+// * Two regions used alternately: one active append-only log, the other the target of the next compaction
+// * Region: 16 byte header (magic, format version, generation, CRC), then 16 byte records up to the end
+// * Record: key, format version, flags, 32-bit value, sequence, CRC-32; programmed as two double words so a
+//   torn write leaves the CRC word erased and the record is ignored
+// * Compaction copies the latest value of each key to the other region and writes its header last,
+//   a reset in the middle of it leaves the old region active
+// * The other region is erased ahead of the compaction, a page per EVERT_PARAM_STORE_Process pass without
+//   waiting for the flash, so the main loop keeps running; Set/Erase answer PSS_BUSY while a page erases or a
+//   full region waits for it. Both regions are in the other bank of the code in dual bank mode, in single bank
+//   mode the erase stalls the fetches all the same.
+// * Init scans the active log once into a RAM index, Get is a table lookup after that
+// Values are raw 32-bit words, floats go through EVERT_PARAM_STORE_GetFloat/SetFloat.
+// Keys are persisted, never renumber them (add new keys at the end, below EVERT_PARAM_STORE_KEY_COUNT).
+
+#if EVERT_HAL_CONF_PARAM_STORE_ENABLE
+
+#define EVERT_PARAM_STORE_ADDRESS (EVERT_HAL_CONF_PARAM_STORE_ADDRESS)       // Start of the 2 regions
+#define EVERT_PARAM_STORE_REGION_SIZE (EVERT_HAL_CONF_PARAM_STORE_REGION_SIZE) // Multiple of 4 kB (one page in single bank mode)
+#define EVERT_PARAM_STORE_KEY_COUNT (EVERT_HAL_CONF_PARAM_STORE_KEY_COUNT)
+
+#define EVERT_PARAM_STORE_MAGIC (0x50525645u) // "EVRP"
+#define EVERT_PARAM_STORE_VERSION (1)
+#define EVERT_PARAM_STORE_RECORD_SIZE (16)
+#define EVERT_PARAM_STORE_RECORD_COUNT ((EVERT_PARAM_STORE_REGION_SIZE / EVERT_PARAM_STORE_RECORD_SIZE) - 1)
+
+#define EVERT_PARAM_STORE_FLAG_ERASED (0x01) // Key reset to its default
+
+typedef enum
+{
+    PSS_OK = 0,
+    PSS_NOT_FOUND = 1,
+    PSS_INVALID_KEY = 2,
+    PSS_FULL = 3,
+    PSS_ERROR = 4,
+    PSS_NOT_INITIALIZED = 5,
+    PSS_OUT_OF_RANGE = 6, // Value rejected by the device before the store: not finite or outside the range of the key
+    PSS_BUSY = 7          // Write not taken now: the other region still erasing, or the device not in a state to accept it
+} EVERT_PARAM_STORE_StatusTypeDef;
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t generation; // Incremented on every compaction, the valid region with the highest one is active
+    uint32_t crc;
+} EVERT_PARAM_STORE_HeaderTypeDef;
+
+typedef struct
+{
+    uint16_t key;
+    uint8_t version;
+    uint8_t flags;
+    uint32_t value;
+    uint32_t sequence;
+    uint32_t crc; // Over the first 12 bytes
+} EVERT_PARAM_STORE_RecordTypeDef;
+
+typedef struct
+{
+    uint32_t value;
+    bool valid;
+} EVERT_PARAM_STORE_IndexItemTypeDef;
+
+typedef struct
+{
+    bool initialized;
+    uint32_t region;       // Active region (0, 1)
+    uint32_t generation;   // Generation of the active region
+    uint32_t write_offset; // Next free record in the active region
+    uint32_t sequence;     // Next record sequence
+    uint32_t compactions;  // Since boot
+    uint32_t discarded;    // Records with a bad CRC or an unknown key/version seen by the last scan
+    uint32_t erased_pages; // Of the other region, erased since it was last used
+    bool erasing;          // A page erase of the other region is running
+    bool erase_error;      // Of that erase, no compaction until the next Init
+    EVERT_PARAM_STORE_IndexItemTypeDef index[EVERT_PARAM_STORE_KEY_COUNT];
+} EVERT_PARAM_STORE_HandlerTypeDef;
+
+extern EVERT_PARAM_STORE_HandlerTypeDef param_store;
+
+EVERT_PARAM_STORE_StatusTypeDef EVERT_PARAM_STORE_Init(void);
+EVERT_PARAM_STORE_StatusTypeDef EVERT_PARAM_STORE_Get(const uint16_t key, uint32_t *value);
+EVERT_PARAM_STORE_StatusTypeDef EVERT_PARAM_STORE_Set(const uint16_t key, const uint32_t value);
+EVERT_PARAM_STORE_StatusTypeDef EVERT_PARAM_STORE_Erase(const uint16_t key);
+EVERT_PARAM_STORE_StatusTypeDef EVERT_PARAM_STORE_Compact(void);
+void EVERT_PARAM_STORE_Process(void);
+
+static inline EVERT_PARAM_STORE_StatusTypeDef EVERT_PARAM_STORE_GetFloat(const uint16_t key, float32_t *value)
+{
+    uint32_t raw;
+    EVERT_PARAM_STORE_StatusTypeDef status = EVERT_PARAM_STORE_Get(key, &raw);
+
+    if (status == PSS_OK)
+    {
+        memcpy(value, &raw, sizeof(*value));
+    }
+
+    return status;
+}
+
+static inline EVERT_PARAM_STORE_StatusTypeDef EVERT_PARAM_STORE_SetFloat(const uint16_t key, const float32_t value)
+{
+    uint32_t raw;
+    memcpy(&raw, &value, sizeof(raw));
+    return EVERT_PARAM_STORE_Set(key, raw);
+}
+
+#endif // EVERT_HAL_CONF_PARAM_STORE_ENABLE
+#endif // EVERT_PARAM_STORE_H_
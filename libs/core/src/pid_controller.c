@@ -0,0 +1,89 @@
+#include "pid_controller.h"
+
+static float32_t EVERT_PID_DefaultBackCalculationGain(const EVERT_PID_StateTypeDef *pid)
+{
+    // Tracking time constant equal to the integral time (Tt = Ti = Kp / Ki), which is
+    // the common choice for a PI. Capped at 1.0f so the integrator never overshoots the limit.
+    if (pid->Kp <= 0.0f)
+    {
+        return 1.0f;
+    }
+
+    float32_t kb = pid->Ki / pid->Kp;
+    return (kb > 1.0f) ? 1.0f : kb;
+}
+
+void EVERT_PID_Init(EVERT_PID_StateTypeDef *pid, const float32_t kp, const float32_t ki, const float32_t kd, const float32_t sample_time, const float32_t output_min, const float32_t output_max)
+{
+    pid->SampleTime = sample_time;
+    pid->OutputMin = output_min;
+    pid->OutputMax = output_max;
+    pid->RateLimit = 0.0f;
+    pid->DerivativeAlpha = 1.0f;
+
+    EVERT_PID_SetGains(pid, kp, ki, kd);
+    EVERT_PID_Reset(pid);
+}
+
+void EVERT_PID_SetGains(EVERT_PID_StateTypeDef *pid, const float32_t kp, const float32_t ki, const float32_t kd)
+{
+    pid->Kp = kp;
+    pid->Ki = ki * pid->SampleTime;
+    pid->Kd = (pid->SampleTime > 0.0f) ? (kd / pid->SampleTime) : 0.0f;
+    pid->Kb = EVERT_PID_DefaultBackCalculationGain(pid);
+}
+
+void EVERT_PID_SetLimits(EVERT_PID_StateTypeDef *pid, const float32_t output_min, const float32_t output_max)
+{
+    pid->OutputMin = output_min;
+    pid->OutputMax = output_max;
+}
+
+void EVERT_PID_SetBackCalculationGain(EVERT_PID_StateTypeDef *pid, const float32_t kb)
+{
+    pid->Kb = kb * pid->SampleTime;
+    EVERT_PID_CLAMP(pid->Kb, 0.0f, 1.0f);
+}
+
+void EVERT_PID_SetRateLimit(EVERT_PID_StateTypeDef *pid, const float32_t rate_per_second)
+{
+    pid->RateLimit = rate_per_second * pid->SampleTime;
+}
+
+void EVERT_PID_SetDerivativeFilter(EVERT_PID_StateTypeDef *pid, const float32_t time_constant)
+{
+    pid->DerivativeAlpha = pid->SampleTime / (time_constant + pid->SampleTime);
+}
+
+void EVERT_PID_Reset(EVERT_PID_StateTypeDef *pid)
+{
+    pid->Integral = 0.0f;
+    pid->Derivative = 0.0f;
+    pid->PreviousFeedback = 0.0f;
+    pid->Output = 0.0f;
+}
+
+void EVERT_PID_Bumpless(EVERT_PID_StateTypeDef *pid, const float32_t output, const float32_t setpoint, const float32_t feedback, const float32_t feed_forward)
+{
+    // Preload the integrator so the next update reproduces the given output (e.g. open-loop duty
+    // or the output of the previous controller) instead of stepping from zero.
+    float32_t limited = output;
+    EVERT_PID_CLAMP(limited, pid->OutputMin, pid->OutputMax);
+
+    pid->Integral = limited - (pid->Kp * (setpoint - feedback)) - feed_forward;
+    pid->Derivative = 0.0f;
+    pid->PreviousFeedback = feedback;
+    pid->Output = limited;
+}
+
+void EVERT_PID_DqInit(EVERT_PID_DqStateTypeDef *pid, const float32_t kp, const float32_t ki, const float32_t sample_time, const float32_t output_min, const float32_t output_max)
+{
+    EVERT_PID_Init(&pid->d, kp, ki, 0.0f, sample_time, output_min, output_max);
+    EVERT_PID_Init(&pid->q, kp, ki, 0.0f, sample_time, output_min, output_max);
+}
+
+void EVERT_PID_DqReset(EVERT_PID_DqStateTypeDef *pid)
+{
+    EVERT_PID_Reset(&pid->d);
+    EVERT_PID_Reset(&pid->q);
+}
@@ -0,0 +1,109 @@
+#ifndef EVERT_PID_CONTROLLER_H_
+#define EVERT_PID_CONTROLLER_H_
+
+#include <arm_math.h>
+#include <stdbool.h>
+
+#define EVERT_PID_CLAMP(value, min, max) ((value) = (((value) > (max)) ? (max) : (((value) < (min)) ? (min) : (value))))
+
+// Discrete PI/PID controller (parallel form) with back-calculation anti-windup.
+// Gains are given in continuous time and pre-scaled by the sample time at init, so the
+// update itself is only a handful of multiply-accumulates and safe to run from the HF ISRs.
+typedef struct __attribute__((aligned(4)))
+{
+    // Gains (Ki and Kd are pre-scaled by the sample time)
+    float32_t Kp;
+    float32_t Ki;
+    float32_t Kd;
+
+    // Back-calculation gain (per sample)
+    // Feeds the difference between the limited and the unlimited output back into the integrator,
+    // so the integrator stops winding up as soon as the output hits a limit (or the rate limit).
+    float32_t Kb;
+
+    // Derivative low-pass filter coefficient, 1.0f = unfiltered
+    float32_t DerivativeAlpha;
+
+    // Output limits
+    float32_t OutputMin;
+    float32_t OutputMax;
+
+    // Maximum output change per sample, 0.0f = disabled
+    float32_t RateLimit;
+
+    // Sample time in seconds
+    float32_t SampleTime;
+
+    // State
+    float32_t Integral;
+    float32_t Derivative;
+    float32_t PreviousFeedback;
+    float32_t Output;
+} EVERT_PID_StateTypeDef;
+
+// Two controllers that are run together, typically for the d and q axis of a rotating reference frame.
+typedef struct __attribute__((aligned(4)))
+{
+    EVERT_PID_StateTypeDef d;
+    EVERT_PID_StateTypeDef q;
+} EVERT_PID_DqStateTypeDef;
+
+void EVERT_PID_Init(EVERT_PID_StateTypeDef *pid, const float32_t kp, const float32_t ki, const float32_t kd, const float32_t sample_time, const float32_t output_min, const float32_t output_max);
+void EVERT_PID_SetGains(EVERT_PID_StateTypeDef *pid, const float32_t kp, const float32_t ki, const float32_t kd);
+void EVERT_PID_SetLimits(EVERT_PID_StateTypeDef *pid, const float32_t output_min, const float32_t output_max);
+void EVERT_PID_SetBackCalculationGain(EVERT_PID_StateTypeDef *pid, const float32_t kb);
+void EVERT_PID_SetRateLimit(EVERT_PID_StateTypeDef *pid, const float32_t rate_per_second);
+void EVERT_PID_SetDerivativeFilter(EVERT_PID_StateTypeDef *pid, const float32_t time_constant);
+void EVERT_PID_Reset(EVERT_PID_StateTypeDef *pid);
+void EVERT_PID_Bumpless(EVERT_PID_StateTypeDef *pid, const float32_t output, const float32_t setpoint, const float32_t feedback, const float32_t feed_forward);
+
+void EVERT_PID_DqInit(EVERT_PID_DqStateTypeDef *pid, const float32_t kp, const float32_t ki, const float32_t sample_time, const float32_t output_min, const float32_t output_max);
+void EVERT_PID_DqReset(EVERT_PID_DqStateTypeDef *pid);
+
+static inline float32_t EVERT_PID_Update(EVERT_PID_StateTypeDef *pid, const float32_t setpoint, const float32_t feedback, const float32_t feed_forward)
+{
+    float32_t error = setpoint - feedback;
+
+    // Derivative on measurement (no kick on setpoint steps), first order filtered
+    pid->Derivative += pid->DerivativeAlpha * ((pid->Kd * (pid->PreviousFeedback - feedback)) - pid->Derivative);
+    pid->PreviousFeedback = feedback;
+
+    float32_t unlimited = (pid->Kp * error) + pid->Integral + pid->Derivative + feed_forward;
+    float32_t output = unlimited;
+
+    if (pid->RateLimit > 0.0f)
+    {
+        EVERT_PID_CLAMP(output, pid->Output - pid->RateLimit, pid->Output + pid->RateLimit);
+    }
+
+    EVERT_PID_CLAMP(output, pid->OutputMin, pid->OutputMax);
+
+    // Integrate and unwind by the amount the output was limited
+    pid->Integral += (pid->Ki * error) + (pid->Kb * (output - unlimited));
+    pid->Output = output;
+
+    return output;
+}
+
+static inline void EVERT_PID_DqUpdate(EVERT_PID_DqStateTypeDef *pid, const float32_t setpoint_d, const float32_t setpoint_q, const float32_t feedback_d, const float32_t feedback_q, const float32_t feed_forward_d, const float32_t feed_forward_q)
+{
+    // PI only, the dq current loops never use the derivative term nor the rate limit
+    float32_t error_d = setpoint_d - feedback_d;
+    float32_t error_q = setpoint_q - feedback_q;
+
+    float32_t unlimited_d = (pid->d.Kp * error_d) + pid->d.Integral + feed_forward_d;
+    float32_t unlimited_q = (pid->q.Kp * error_q) + pid->q.Integral + feed_forward_q;
+
+    float32_t output_d = unlimited_d;
+    float32_t output_q = unlimited_q;
+    EVERT_PID_CLAMP(output_d, pid->d.OutputMin, pid->d.OutputMax);
+    EVERT_PID_CLAMP(output_q, pid->q.OutputMin, pid->q.OutputMax);
+
+    pid->d.Integral += (pid->d.Ki * error_d) + (pid->d.Kb * (output_d - unlimited_d));
+    pid->q.Integral += (pid->q.Ki * error_q) + (pid->q.Kb * (output_q - unlimited_q));
+
+    pid->d.Output = output_d;
+    pid->q.Output = output_q;
+}
+
+#endif // EVERT_PID_CONTROLLER_H_
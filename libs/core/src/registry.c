@@ -0,0 +1,242 @@
+#include <string.h>
+#include "registry.h"
+
+#if EVERT_HAL_CONF_REGISTRY_ENABLE
+
+// Bounds of the .evert_registry section (linker script)
+extern const EVERT_REGISTRY_EntryTypeDef __evert_registry_start[];
+extern const EVERT_REGISTRY_EntryTypeDef __evert_registry_end[];
+
+EVERT_REGISTRY_SubscriptionTypeDef registry_subscriptions[EVERT_REGISTRY_SUBSCRIPTION_COUNT];
+
+uint32_t EVERT_REGISTRY_GetCount(void)
+{
+    return (uint32_t)(__evert_registry_end - __evert_registry_start);
+}
+
+/// @brief Entry by position in the table (link order), for listing
+const EVERT_REGISTRY_EntryTypeDef *EVERT_REGISTRY_GetEntry(const uint32_t index)
+{
+    return index < EVERT_REGISTRY_GetCount() ? &__evert_registry_start[index] : NULL;
+}
+
+const EVERT_REGISTRY_EntryTypeDef *EVERT_REGISTRY_Find(const uint16_t id)
+{
+    for (const EVERT_REGISTRY_EntryTypeDef *entry = __evert_registry_start; entry < __evert_registry_end; entry++)
+    {
+        if (entry->id == id)
+        {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+/// @brief Current value, zero extended (signed types are sign extended, floats as their bits)
+static uint32_t EVERT_REGISTRY_Load(const EVERT_REGISTRY_EntryTypeDef *entry)
+{
+    switch (entry->type)
+    {
+    case RGT_U8:
+    case RGT_BOOL:
+        return *(volatile uint8_t *)entry->address;
+    case RGT_I8:
+        return (uint32_t)(int32_t)*(volatile int8_t *)entry->address;
+    case RGT_U16:
+        return *(volatile uint16_t *)entry->address;
+    case RGT_I16:
+        return (uint32_t)(int32_t)*(volatile int16_t *)entry->address;
+    default:
+        return *(volatile uint32_t *)entry->address;
+    }
+}
+
+EVERT_REGISTRY_StatusTypeDef EVERT_REGISTRY_Read(const uint16_t id, uint32_t *value)
+{
+    const EVERT_REGISTRY_EntryTypeDef *entry = EVERT_REGISTRY_Find(id);
+
+    if (entry == NULL)
+    {
+        return RGS_NOT_FOUND;
+    }
+
+    if (!(entry->access & RGA_READ))
+    {
+        return RGS_ACCESS_DENIED;
+    }
+
+    *value = EVERT_REGISTRY_Load(entry);
+    return RGS_OK;
+}
+
+/// @brief Store a value (low bytes for the narrow types), single store so an ISR never sees a torn value
+EVERT_REGISTRY_StatusTypeDef EVERT_REGISTRY_Write(const uint16_t id, const uint32_t value)
+{
+    const EVERT_REGISTRY_EntryTypeDef *entry = EVERT_REGISTRY_Find(id);
+
+    if (entry == NULL)
+    {
+        return RGS_NOT_FOUND;
+    }
+
+    if (!(entry->access & RGA_WRITE))
+    {
+        return RGS_ACCESS_DENIED;
+    }
+
+    switch (entry->type)
+    {
+    case RGT_U8:
+    case RGT_I8:
+        *(volatile uint8_t *)entry->address = (uint8_t)value;
+        break;
+    case RGT_BOOL:
+        *(volatile uint8_t *)entry->address = value != 0;
+        break;
+    case RGT_U16:
+    case RGT_I16:
+        *(volatile uint16_t *)entry->address = (uint16_t)value;
+        break;
+    default:
+        *(volatile uint32_t *)entry->address = value;
+        break;
+    }
+
+    return RGS_OK;
+}
+
+void EVERT_REGISTRY_Init(void)
+{
+    memset(registry_subscriptions, 0, sizeof(registry_subscriptions));
+}
+
+/// @brief Send (id) every (period_ms), a second call changes the period
+/// @param slot Slot the values are packed under
+EVERT_REGISTRY_StatusTypeDef EVERT_REGISTRY_Subscribe(const uint16_t id, const uint16_t period_ms, uint8_t *slot)
+{
+    const EVERT_REGISTRY_EntryTypeDef *entry = EVERT_REGISTRY_Find(id);
+
+    if (entry == NULL)
+    {
+        return RGS_NOT_FOUND;
+    }
+
+    if (!(entry->access & RGA_READ))
+    {
+        return RGS_ACCESS_DENIED;
+    }
+
+    if (period_ms == 0)
+    {
+        return RGS_INVALID;
+    }
+
+    uint32_t free_slot = EVERT_REGISTRY_SUBSCRIPTION_COUNT;
+
+    for (uint32_t i = 0; i < EVERT_REGISTRY_SUBSCRIPTION_COUNT; i++)
+    {
+        if (registry_subscriptions[i].entry == entry)
+        {
+            free_slot = i;
+            break;
+        }
+
+        if (registry_subscriptions[i].entry == NULL && free_slot == EVERT_REGISTRY_SUBSCRIPTION_COUNT)
+        {
+            free_slot = i;
+        }
+    }
+
+    if (free_slot == EVERT_REGISTRY_SUBSCRIPTION_COUNT)
+    {
+        return RGS_FULL;
+    }
+
+    registry_subscriptions[free_slot].entry = entry;
+    registry_subscriptions[free_slot].period_ms = period_ms;
+    registry_subscriptions[free_slot].elapsed_ms = 0;
+    registry_subscriptions[free_slot].due = true; // First value right away
+
+    *slot = (uint8_t)free_slot;
+    return RGS_OK;
+}
+
+/// @brief Stop sending (id), EVERT_REGISTRY_ID_ALL clears every subscription
+EVERT_REGISTRY_StatusTypeDef EVERT_REGISTRY_Unsubscribe(const uint16_t id)
+{
+    EVERT_REGISTRY_StatusTypeDef status = (id == EVERT_REGISTRY_ID_ALL) ? RGS_OK : RGS_NOT_FOUND;
+
+    for (uint32_t i = 0; i < EVERT_REGISTRY_SUBSCRIPTION_COUNT; i++)
+    {
+        if (registry_subscriptions[i].entry != NULL && (id == EVERT_REGISTRY_ID_ALL || registry_subscriptions[i].entry->id == id))
+        {
+            registry_subscriptions[i].entry = NULL;
+            registry_subscriptions[i].due = false;
+            status = RGS_OK;
+        }
+    }
+
+    return status;
+}
+
+/// @brief Advance the subscription timers, call from the main loop
+void EVERT_REGISTRY_Update(const uint32_t delta_ms)
+{
+    for (uint32_t i = 0; i < EVERT_REGISTRY_SUBSCRIPTION_COUNT; i++)
+    {
+        EVERT_REGISTRY_SubscriptionTypeDef *subscription = &registry_subscriptions[i];
+
+        if (subscription->entry == NULL)
+        {
+            continue;
+        }
+
+        uint32_t elapsed = subscription->elapsed_ms + delta_ms;
+
+        if (elapsed >= subscription->period_ms)
+        {
+            // A late loop sends once, it does not catch up
+            subscription->due = true;
+            elapsed = 0;
+        }
+
+        subscription->elapsed_ms = (uint16_t)elapsed;
+    }
+}
+
+/// @brief Pack the due values as [slot][value]... into (buffer), clears them
+/// @return Bytes written, 0 when nothing is due (call until 0, one transport frame per call)
+uint32_t EVERT_REGISTRY_Pack(uint8_t *buffer, const uint32_t capacity)
+{
+    uint32_t length = 0;
+
+    for (uint32_t i = 0; i < EVERT_REGISTRY_SUBSCRIPTION_COUNT; i++)
+    {
+        EVERT_REGISTRY_SubscriptionTypeDef *subscription = &registry_subscriptions[i];
+
+        if (!subscription->due || subscription->entry == NULL)
+        {
+            continue;
+        }
+
+        uint32_t size = EVERT_REGISTRY_TYPE_SIZE(subscription->entry->type);
+
+        if (length + 1 + size > capacity)
+        {
+            continue; // Next frame, a smaller value may still fit
+        }
+
+        uint32_t value = EVERT_REGISTRY_Load(subscription->entry);
+
+        buffer[length++] = (uint8_t)i;
+        memcpy(&buffer[length], &value, size); // Little endian, low bytes first
+        length += size;
+
+        subscription->due = false;
+    }
+
+    return length;
+}
+
+#endif // EVERT_HAL_CONF_REGISTRY_ENABLE
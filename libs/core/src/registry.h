@@ -0,0 +1,107 @@
+#ifndef EVERT_REGISTRY_H_
+#define EVERT_REGISTRY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32g4xx_hal.h>
+#include "_conf_evert_hal.h"
+
+// Variable registry: a table of {id, name hash, type, access, address} in the .evert_registry flash section,
+// built by the linker from EVERT_REGISTRY_VARIABLE anywhere in the application (see the linker script).
+// * Remote read/write by id, the host maps ids to names with the FNV-1a hash of the variable name
+// * Subscriptions: up to EVERT_HAL_CONF_REGISTRY_SUBSCRIPTION_COUNT variables sent at their own period,
+//   packed as [slot u8][value, 1/2/4 bytes by type]... into whatever frame the transport has
+// * Nothing runs for a variable that is not subscribed, the table itself is const
+// The transport (CAN, telemetry) is up to the application: it calls the functions below from its
+// request handlers and drains EVERT_REGISTRY_Pack after EVERT_REGISTRY_Update.
+
+#if EVERT_HAL_CONF_REGISTRY_ENABLE
+
+#define EVERT_REGISTRY_SUBSCRIPTION_COUNT (EVERT_HAL_CONF_REGISTRY_SUBSCRIPTION_COUNT)
+#define EVERT_REGISTRY_ID_ALL (0xFFFF)
+
+typedef enum
+{
+    RGT_U8 = 0,
+    RGT_I8 = 1,
+    RGT_U16 = 2,
+    RGT_I16 = 3,
+    RGT_U32 = 4,
+    RGT_I32 = 5,
+    RGT_F32 = 6,
+    RGT_BOOL = 7
+} EVERT_REGISTRY_TypeTypeDef;
+
+typedef enum
+{
+    RGA_READ = 1,
+    RGA_WRITE = 2,
+    RGA_READ_WRITE = 3
+} EVERT_REGISTRY_AccessTypeDef;
+
+typedef enum
+{
+    RGS_OK = 0,
+    RGS_NOT_FOUND = 1,
+    RGS_ACCESS_DENIED = 2,
+    RGS_FULL = 3, // No free subscription slot
+    RGS_INVALID = 4
+} EVERT_REGISTRY_StatusTypeDef;
+
+typedef struct
+{
+    uint16_t id;
+    uint8_t type;   // EVERT_REGISTRY_TypeTypeDef
+    uint8_t access; // EVERT_REGISTRY_AccessTypeDef
+    uint32_t name_hash;
+    void *address;
+} EVERT_REGISTRY_EntryTypeDef;
+
+typedef struct
+{
+    const EVERT_REGISTRY_EntryTypeDef *entry; // NULL: free
+    uint16_t period_ms;
+    uint16_t elapsed_ms;
+    bool due;
+} EVERT_REGISTRY_SubscriptionTypeDef;
+
+extern EVERT_REGISTRY_SubscriptionTypeDef registry_subscriptions[EVERT_REGISTRY_SUBSCRIPTION_COUNT];
+
+#define EVERT_REGISTRY_TYPE_SIZE(type) \
+    (((type) == RGT_U8 || (type) == RGT_I8 || (type) == RGT_BOOL) ? 1 : ((type) == RGT_U16 || (type) == RGT_I16) ? 2 : 4)
+
+/// @brief Unsigned type matching the size of (variable), for enums (short on arm-none-eabi, int on the host)
+#define EVERT_REGISTRY_TYPE_OF_ENUM(variable) (sizeof(variable) == 1 ? RGT_U8 : sizeof(variable) == 2 ? RGT_U16 : RGT_U32)
+
+// FNV-1a over the first 48 characters of a string literal, folded at compile time
+#define EVERT_REGISTRY_HASH_STEP(hash, string, i) (((hash) ^ ((i) < sizeof(string) - 1 ? (uint8_t)(string)[(i) < sizeof(string) ? (i) : 0] : 0u)) * ((i) < sizeof(string) - 1 ? 16777619u : 1u))
+#define EVERT_REGISTRY_HASH_4(hash, string, i) EVERT_REGISTRY_HASH_STEP(EVERT_REGISTRY_HASH_STEP(EVERT_REGISTRY_HASH_STEP(EVERT_REGISTRY_HASH_STEP(hash, string, i), string, i + 1), string, i + 2), string, i + 3)
+#define EVERT_REGISTRY_HASH_16(hash, string, i) EVERT_REGISTRY_HASH_4(EVERT_REGISTRY_HASH_4(EVERT_REGISTRY_HASH_4(EVERT_REGISTRY_HASH_4(hash, string, i), string, i + 4), string, i + 8), string, i + 12)
+#define EVERT_REGISTRY_HASH(string) ((uint32_t)EVERT_REGISTRY_HASH_16(EVERT_REGISTRY_HASH_16(EVERT_REGISTRY_HASH_16(2166136261u, string, 0), string, 16), string, 32))
+
+/// @brief Register a variable, at file scope. The id must be unique per device, the type must match the variable's size.
+#define EVERT_REGISTRY_VARIABLE(id_, variable_, type_, access_)                                                                 \
+    _Static_assert(sizeof(variable_) == EVERT_REGISTRY_TYPE_SIZE(type_), #variable_ " does not match " #type_);                 \
+    static const EVERT_REGISTRY_EntryTypeDef evert_registry_entry_##id_ __attribute__((used, section(".evert_registry"))) = { \
+        .id = (id_),                                                                                                              \
+        .type = (type_),                                                                                                          \
+        .access = (access_),                                                                                                      \
+        .name_hash = EVERT_REGISTRY_HASH(#variable_),                                                                            \
+        .address = (void *)&(variable_),                                                                                          \
+    }
+
+uint32_t EVERT_REGISTRY_GetCount(void);
+const EVERT_REGISTRY_EntryTypeDef *EVERT_REGISTRY_GetEntry(const uint32_t index);
+const EVERT_REGISTRY_EntryTypeDef *EVERT_REGISTRY_Find(const uint16_t id);
+
+EVERT_REGISTRY_StatusTypeDef EVERT_REGISTRY_Read(const uint16_t id, uint32_t *value);
+EVERT_REGISTRY_StatusTypeDef EVERT_REGISTRY_Write(const uint16_t id, const uint32_t value);
+
+void EVERT_REGISTRY_Init(void);
+EVERT_REGISTRY_StatusTypeDef EVERT_REGISTRY_Subscribe(const uint16_t id, const uint16_t period_ms, uint8_t *slot);
+EVERT_REGISTRY_StatusTypeDef EVERT_REGISTRY_Unsubscribe(const uint16_t id);
+void EVERT_REGISTRY_Update(const uint32_t delta_ms);
+uint32_t EVERT_REGISTRY_Pack(uint8_t *buffer, const uint32_t capacity);
+
+#endif // EVERT_HAL_CONF_REGISTRY_ENABLE
+#endif // EVERT_REGISTRY_H_
@@ -0,0 +1,116 @@
+#include "scope.h"
+
+#if EVERT_HAL_CONF_SCOPE_ENABLE
+
+void EVERT_SCOPE_Init(EVERT_SCOPE_HandlerTypeDef *scope, EVERT_SCOPE_SampleTypeDef *buffer, const uint32_t depth, const uint32_t decimation, const uint32_t pre_trigger)
+{
+    scope->buffer = buffer;
+    scope->depth = depth;
+    scope->decimation = decimation > 0 ? decimation : 1;
+    scope->pre_trigger = pre_trigger < depth ? pre_trigger : depth - 1;
+    scope->state = SCS_IDLE;
+
+    scope->trigger_channel = 0;
+    scope->trigger_level = 0;
+    scope->trigger_edge = SCE_NONE;
+
+    scope->trigger_index = 0;
+    scope->trigger_source = 0;
+    scope->trigger_tick = 0;
+    scope->trigger_time_us = 0;
+}
+
+void EVERT_SCOPE_SetThreshold(EVERT_SCOPE_HandlerTypeDef *scope, const uint32_t channel, const float32_t level, const EVERT_SCOPE_EdgeTypeDef edge)
+{
+    if (channel >= EVERT_SCOPE_CHANNEL_COUNT)
+    {
+        return;
+    }
+
+    // Disable first, the ISR must not see a half-written configuration
+    scope->trigger_edge = SCE_NONE;
+    scope->trigger_channel = channel;
+    scope->trigger_level = level;
+    scope->trigger_previous = (edge == SCE_FALLING) ? -INFINITY : INFINITY; // No crossing on the first sample
+    scope->trigger_edge = edge;
+}
+
+void EVERT_SCOPE_Arm(EVERT_SCOPE_HandlerTypeDef *scope)
+{
+    scope->state = SCS_IDLE;
+
+    scope->write_index = 0;
+    scope->count = 0;
+    scope->decimation_counter = 0;
+    scope->post_remaining = 0;
+    scope->trigger_previous = (scope->trigger_edge == SCE_FALLING) ? -INFINITY : INFINITY;
+
+    scope->state = SCS_ARMED;
+}
+
+/// @brief Trigger from outside the ISR (alarm set), keeps recording the post-trigger samples
+void EVERT_SCOPE_Trigger(EVERT_SCOPE_HandlerTypeDef *scope, const uint32_t source)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (scope->state == SCS_ARMED)
+    {
+        scope->trigger_index = (scope->write_index + scope->depth - 1) % scope->depth;
+        scope->trigger_source = source;
+        scope->trigger_tick = HAL_GetTick();
+        scope->trigger_time_us = EVERT_SCOPE_TriggerTime();
+        scope->post_remaining = scope->depth - scope->pre_trigger;
+        scope->state = SCS_TRIGGERED;
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/// @brief Stop recording now, the last sample is the trigger (fatal faults)
+void EVERT_SCOPE_Freeze(EVERT_SCOPE_HandlerTypeDef *scope, const uint32_t source)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (scope->state == SCS_ARMED)
+    {
+        scope->trigger_index = (scope->write_index + scope->depth - 1) % scope->depth;
+        scope->trigger_source = source;
+        scope->trigger_tick = HAL_GetTick();
+        scope->trigger_time_us = EVERT_SCOPE_TriggerTime();
+    }
+
+    // A running post-trigger keeps its trigger
+    if (scope->state != SCS_IDLE)
+    {
+        scope->state = SCS_FROZEN;
+    }
+
+    __set_PRIMASK(primask);
+}
+
+static inline uint32_t EVERT_SCOPE_OldestIndex(const EVERT_SCOPE_HandlerTypeDef *scope)
+{
+    return scope->count < scope->depth ? 0 : scope->write_index;
+}
+
+/// @brief Position of the trigger sample, counted from the oldest sample
+uint32_t EVERT_SCOPE_GetTriggerOffset(const EVERT_SCOPE_HandlerTypeDef *scope)
+{
+    return (scope->trigger_index + scope->depth - EVERT_SCOPE_OldestIndex(scope)) % scope->depth;
+}
+
+/// @brief Read the n-th oldest sample of a frozen capture
+bool EVERT_SCOPE_ReadSample(const EVERT_SCOPE_HandlerTypeDef *scope, const uint32_t n, EVERT_SCOPE_SampleTypeDef *sample)
+{
+    if (scope->state != SCS_FROZEN || n >= scope->count)
+    {
+        return false;
+    }
+
+    *sample = scope->buffer[(EVERT_SCOPE_OldestIndex(scope) + n) % scope->depth];
+    return true;
+}
+
+#endif // EVERT_HAL_CONF_SCOPE_ENABLE
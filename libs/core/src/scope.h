@@ -0,0 +1,159 @@
+#ifndef EVERT_SCOPE_H_
+#define EVERT_SCOPE_H_
+
+#include <arm_math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32g4xx_hal.h>
+#include "_conf_evert_hal.h"
+#include "time_sync.h"
+
+// Waveform capture ("scope") into a circular RAM buffer, recorded from an ISR.
+// * Armed: every (decimation)th sample is written, the buffer keeps the latest depth samples
+// * Trigger: threshold crossing on one channel (checked per recorded sample) or EVERT_SCOPE_Trigger
+//   (alarms), then depth - pre_trigger more samples are recorded and the buffer freezes
+// * EVERT_SCOPE_Freeze stops at once (fatal faults, no post-trigger samples)
+// * Frozen buffers are read oldest first with EVERT_SCOPE_ReadSample, EVERT_SCOPE_Arm restarts
+// The application fills a staging sample and calls EVERT_SCOPE_Record, a struct copy and a compare.
+// With time synchronization (time_sync.h) the trigger also gets the synchronized time, captures of several
+// devices line up on it.
+
+#if EVERT_HAL_CONF_SCOPE_ENABLE
+
+#define EVERT_SCOPE_CHANNEL_COUNT (EVERT_HAL_CONF_SCOPE_CHANNEL_COUNT)
+
+#define EVERT_SCOPE_TRIGGER_SOURCE_THRESHOLD (0) // Alarm sources passed to EVERT_SCOPE_Trigger/Freeze are application defined, non-zero
+
+typedef enum
+{
+    SCS_IDLE = 0,
+    SCS_ARMED = 1,
+    SCS_TRIGGERED = 2,
+    SCS_FROZEN = 3
+} EVERT_SCOPE_StateTypeDef;
+
+typedef enum
+{
+    SCE_NONE = 0,
+    SCE_RISING = 1,
+    SCE_FALLING = 2,
+    SCE_MAGNITUDE = 3 // |value| rising above the level
+} EVERT_SCOPE_EdgeTypeDef;
+
+typedef struct
+{
+    float32_t channel[EVERT_SCOPE_CHANNEL_COUNT];
+} EVERT_SCOPE_SampleTypeDef;
+
+typedef struct
+{
+    EVERT_SCOPE_SampleTypeDef *buffer;
+    uint32_t depth;
+    uint32_t write_index;
+    uint32_t count; // Recorded samples, up to depth
+    uint32_t decimation;
+    uint32_t decimation_counter;
+    uint32_t pre_trigger;
+    uint32_t post_remaining;
+    volatile EVERT_SCOPE_StateTypeDef state;
+
+    // Threshold trigger
+    uint32_t trigger_channel;
+    float32_t trigger_level;
+    EVERT_SCOPE_EdgeTypeDef trigger_edge;
+    float32_t trigger_previous;
+
+    // Last trigger
+    uint32_t trigger_index; // Buffer index of the trigger sample
+    uint32_t trigger_source;
+    uint32_t trigger_tick;
+    uint64_t trigger_time_us; // Synchronized time, 0 without a synchronized clock
+} EVERT_SCOPE_HandlerTypeDef;
+
+void EVERT_SCOPE_Init(EVERT_SCOPE_HandlerTypeDef *scope, EVERT_SCOPE_SampleTypeDef *buffer, const uint32_t depth, const uint32_t decimation, const uint32_t pre_trigger);
+void EVERT_SCOPE_SetThreshold(EVERT_SCOPE_HandlerTypeDef *scope, const uint32_t channel, const float32_t level, const EVERT_SCOPE_EdgeTypeDef edge);
+void EVERT_SCOPE_Arm(EVERT_SCOPE_HandlerTypeDef *scope);
+void EVERT_SCOPE_Trigger(EVERT_SCOPE_HandlerTypeDef *scope, const uint32_t source);
+void EVERT_SCOPE_Freeze(EVERT_SCOPE_HandlerTypeDef *scope, const uint32_t source);
+uint32_t EVERT_SCOPE_GetTriggerOffset(const EVERT_SCOPE_HandlerTypeDef *scope);
+bool EVERT_SCOPE_ReadSample(const EVERT_SCOPE_HandlerTypeDef *scope, const uint32_t n, EVERT_SCOPE_SampleTypeDef *sample);
+
+/// @brief Synchronized time of a trigger, 0 without a synchronized clock
+static inline uint64_t EVERT_SCOPE_TriggerTime(void)
+{
+#if EVERT_HAL_CONF_TIME_SYNC_ENABLE
+    return EVERT_TIME_SYNC_Now();
+#else
+    return 0;
+#endif
+}
+
+static inline bool EVERT_SCOPE_IsFrozen(const EVERT_SCOPE_HandlerTypeDef *scope)
+{
+    return scope->state == SCS_FROZEN;
+}
+
+static inline bool EVERT_SCOPE_CheckThreshold(EVERT_SCOPE_HandlerTypeDef *scope, float32_t value)
+{
+    float32_t previous = scope->trigger_previous;
+    scope->trigger_previous = value;
+
+    switch (scope->trigger_edge)
+    {
+    case SCE_RISING:
+        return previous < scope->trigger_level && value >= scope->trigger_level;
+    case SCE_FALLING:
+        return previous > scope->trigger_level && value <= scope->trigger_level;
+    case SCE_MAGNITUDE:
+        return fabsf(previous) < scope->trigger_level && fabsf(value) >= scope->trigger_level;
+    default:
+        return false;
+    }
+}
+
+/// @brief Record one sample, call from the ISR the signals are sampled in
+static inline void EVERT_SCOPE_Record(EVERT_SCOPE_HandlerTypeDef *scope, const EVERT_SCOPE_SampleTypeDef *sample)
+{
+    EVERT_SCOPE_StateTypeDef state = scope->state;
+
+    if (state != SCS_ARMED && state != SCS_TRIGGERED)
+    {
+        return;
+    }
+
+    if (++scope->decimation_counter < scope->decimation)
+    {
+        return;
+    }
+
+    scope->decimation_counter = 0;
+
+    uint32_t index = scope->write_index;
+    scope->buffer[index] = *sample;
+    scope->write_index = (index + 1 < scope->depth) ? index + 1 : 0;
+
+    if (scope->count < scope->depth)
+    {
+        scope->count++;
+    }
+
+    if (state == SCS_ARMED)
+    {
+        if (EVERT_SCOPE_CheckThreshold(scope, sample->channel[scope->trigger_channel]))
+        {
+            scope->trigger_index = index;
+            scope->trigger_source = EVERT_SCOPE_TRIGGER_SOURCE_THRESHOLD;
+            scope->trigger_tick = HAL_GetTick();
+            scope->trigger_time_us = EVERT_SCOPE_TriggerTime();
+            scope->post_remaining = scope->depth - scope->pre_trigger;
+            scope->state = SCS_TRIGGERED;
+        }
+    }
+    else if (--scope->post_remaining == 0)
+    {
+        scope->state = SCS_FROZEN;
+    }
+}
+
+#endif // EVERT_HAL_CONF_SCOPE_ENABLE
+#endif // EVERT_SCOPE_H_
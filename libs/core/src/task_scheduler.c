@@ -1,6 +1,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include "task_scheduler.h"
+#include "fault_record.h"
 
 static EVERT_TASK_SCHEDULER_HandlerTypeDef task_scheduler;
 
@@ -30,6 +31,11 @@ void EVERT_TASK_SCHEDULER_Update(const uint32_t delta_ms)
             if (task_scheduler.TaskCounterMs[i] >= task_scheduler.TaskIntervalMs[i])
             {
                 task_scheduler.TaskCounterMs[i] = 0;
+
+#if EVERT_HAL_CONF_FAULT_RECORD_ENABLE
+                EVERT_FAULT_RECORD_LogEvent(FRE_TASK, (uint8_t)i, 0, 0);
+#endif
+
                 task_scheduler.OnTaskCallback[i]();
             }
         }
@@ -46,6 +52,12 @@ void EVERT_TASK_SCHEDULER_ResumeTask(const EVERT_TASK_SCHEDULER_TaskTypeDef task
     task_scheduler.TaskEnabled[task] = true;
 }
 
+// Due at the next update instead of a full interval from now, the interval runs on from there
+void EVERT_TASK_SCHEDULER_TriggerTask(const EVERT_TASK_SCHEDULER_TaskTypeDef task)
+{
+    task_scheduler.TaskCounterMs[task] = task_scheduler.TaskIntervalMs[task];
+}
+
 void EVERT_TASK_SCHEDULER_SetTaskSendAnnouncementInterval(const uint32_t interval_ms)
 {
     task_scheduler.TaskIntervalMs[EVERT_TASK_SEND_ANNOUNCEMENT] = interval_ms;
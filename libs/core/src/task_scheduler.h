@@ -26,6 +26,7 @@ void EVERT_TASK_SCHEDULER_Init();
 void EVERT_TASK_SCHEDULER_Update(const uint32_t delta_ms);
 void EVERT_TASK_SCHEDULER_PauseTask(const EVERT_TASK_SCHEDULER_TaskTypeDef task);
 void EVERT_TASK_SCHEDULER_ResumeTask(const EVERT_TASK_SCHEDULER_TaskTypeDef task);
+void EVERT_TASK_SCHEDULER_TriggerTask(const EVERT_TASK_SCHEDULER_TaskTypeDef task);
 
 void EVERT_TASK_SCHEDULER_SetTaskSendAnnouncementInterval(const uint32_t interval_ms);
 void EVERT_TASK_SCHEDULER_SetTaskSendDataInterval(const uint32_t interval_ms);
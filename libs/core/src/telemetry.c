@@ -0,0 +1,363 @@
+#include <string.h>
+#include "crc.h"
+#include "telemetry.h"
+
+#if EVERT_HAL_CONF_TELEMETRY_ENABLE
+
+static inline uint32_t EVERT_TELEMETRY_EnterCritical(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    return primask;
+}
+
+static inline void EVERT_TELEMETRY_ExitCritical(const uint32_t primask)
+{
+    __set_PRIMASK(primask);
+}
+
+void EVERT_TELEMETRY_Init(EVERT_TELEMETRY_HandlerTypeDef *telemetry, UART_HandleTypeDef *huart)
+{
+    telemetry->huart = huart;
+    telemetry->length[0] = 0;
+    telemetry->length[1] = 0;
+    telemetry->fill = 0;
+    telemetry->busy = false;
+    telemetry->sequence = 0;
+
+    telemetry->on_receive = NULL;
+    telemetry->rx_head = 0;
+    telemetry->rx_tail = 0;
+    telemetry->rx_frame_length = 0;
+
+    telemetry->record_count = 0;
+    telemetry->drop_count = 0;
+    telemetry->error_count = 0;
+    telemetry->rx_error_count = 0;
+}
+
+/// @brief COBS encode (length) bytes, the output holds no 0x00 and is at most length + length / 254 + 1 bytes
+/// @return Encoded length, without the 0x00 delimiter
+size_t EVERT_TELEMETRY_CobsEncode(const uint8_t *source, const size_t length, uint8_t *destination)
+{
+    size_t code_index = 0;
+    size_t write_index = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        if (source[i] != 0)
+        {
+            destination[write_index++] = source[i];
+            code++;
+        }
+
+        if (source[i] == 0 || code == 0xFF)
+        {
+            destination[code_index] = code;
+            code_index = write_index++;
+            code = 1;
+        }
+    }
+
+    destination[code_index] = code;
+    return write_index;
+}
+
+/// @brief COBS decode one frame (without the 0x00 delimiter)
+/// @return Decoded length, 0 for a malformed frame
+size_t EVERT_TELEMETRY_CobsDecode(const uint8_t *source, const size_t length, uint8_t *destination)
+{
+    size_t read_index = 0;
+    size_t write_index = 0;
+
+    while (read_index < length)
+    {
+        uint8_t code = source[read_index];
+
+        // The block is the code byte and (code - 1) bytes after it, all of them in the frame
+        if (code == 0 || read_index + code > length)
+        {
+            return 0;
+        }
+
+        read_index++;
+
+        for (uint8_t i = 1; i < code; i++)
+        {
+            destination[write_index++] = source[read_index++];
+        }
+
+        if (code < 0xFF && read_index < length)
+        {
+            destination[write_index++] = 0;
+        }
+    }
+
+    return write_index;
+}
+
+/// @brief Build the framed record (header, payload, CRC, COBS, delimiter)
+/// @return Frame length
+static uint32_t EVERT_TELEMETRY_BuildFrame(EVERT_TELEMETRY_HandlerTypeDef *telemetry, const uint8_t schema, const void *payload, const uint32_t length, uint8_t *frame)
+{
+    uint8_t record[EVERT_TELEMETRY_RECORD_MAX];
+    uint32_t tick = HAL_GetTick();
+
+    uint32_t primask = EVERT_TELEMETRY_EnterCritical();
+    uint8_t sequence = telemetry->sequence++;
+    EVERT_TELEMETRY_ExitCritical(primask);
+
+    record[0] = schema;
+    record[1] = sequence;
+    memcpy(&record[2], &tick, sizeof(tick));
+    memcpy(&record[EVERT_TELEMETRY_HEADER_SIZE], payload, length);
+
+    uint32_t crc = EVERT_CRC32(record, EVERT_TELEMETRY_HEADER_SIZE + length);
+    memcpy(&record[EVERT_TELEMETRY_HEADER_SIZE + length], &crc, sizeof(crc));
+
+    size_t encoded = EVERT_TELEMETRY_CobsEncode(record, EVERT_TELEMETRY_HEADER_SIZE + length + EVERT_TELEMETRY_CRC_SIZE, frame);
+    frame[encoded++] = 0x00;
+
+    return encoded;
+}
+
+/// @brief Start sending the fill buffer if the line is idle and there is something in it
+static void EVERT_TELEMETRY_Kick(EVERT_TELEMETRY_HandlerTypeDef *telemetry)
+{
+    uint32_t primask = EVERT_TELEMETRY_EnterCritical();
+
+    uint32_t send = telemetry->fill;
+
+    if (telemetry->busy || telemetry->length[send] == 0)
+    {
+        EVERT_TELEMETRY_ExitCritical(primask);
+        return;
+    }
+
+    // Swap, new records go to the other buffer while this one is on the wire
+    telemetry->busy = true;
+    telemetry->fill = send ^ 1;
+    telemetry->length[send ^ 1] = 0;
+
+    EVERT_TELEMETRY_ExitCritical(primask);
+
+    if (HAL_UART_Transmit_DMA(telemetry->huart, telemetry->buffer[send], (uint16_t)telemetry->length[send]) != HAL_OK)
+    {
+        // Drop the buffer rather than stall, the sequence numbers show the gap
+        telemetry->error_count++;
+        telemetry->busy = false;
+    }
+}
+
+/// @brief Queue a record, never blocks
+/// @details Safe from any context, the encoding runs outside the critical section
+EVERT_TELEMETRY_StatusTypeDef EVERT_TELEMETRY_Send(EVERT_TELEMETRY_HandlerTypeDef *telemetry, const uint8_t schema, const void *payload, const uint32_t length)
+{
+    if (length > EVERT_TELEMETRY_PAYLOAD_MAX)
+    {
+        return TMS_INVALID;
+    }
+
+    uint8_t frame[EVERT_TELEMETRY_FRAME_MAX];
+    uint32_t frame_length = EVERT_TELEMETRY_BuildFrame(telemetry, schema, payload, length, frame);
+
+    uint32_t primask = EVERT_TELEMETRY_EnterCritical();
+
+    uint32_t fill = telemetry->fill;
+    uint32_t used = telemetry->length[fill];
+
+    if (used + frame_length > EVERT_TELEMETRY_BUFFER_SIZE)
+    {
+        telemetry->drop_count++;
+        EVERT_TELEMETRY_ExitCritical(primask);
+        return TMS_FULL;
+    }
+
+    memcpy(&telemetry->buffer[fill][used], frame, frame_length);
+    telemetry->length[fill] = used + frame_length;
+    telemetry->record_count++;
+
+    EVERT_TELEMETRY_ExitCritical(primask);
+    return TMS_OK;
+}
+
+/// @brief Send one record with polling, for fatal paths where the DMA/interrupts can not be relied on
+/// @details Aborts a transfer in flight, the receiver resyncs on the next delimiter
+EVERT_TELEMETRY_StatusTypeDef EVERT_TELEMETRY_SendBlocking(EVERT_TELEMETRY_HandlerTypeDef *telemetry, const uint8_t schema, const void *payload, const uint32_t length, const uint32_t timeout_ms)
+{
+    if (length > EVERT_TELEMETRY_PAYLOAD_MAX)
+    {
+        return TMS_INVALID;
+    }
+
+    if (telemetry->busy)
+    {
+        HAL_UART_AbortTransmit(telemetry->huart);
+        telemetry->busy = false;
+    }
+
+    uint8_t frame[EVERT_TELEMETRY_FRAME_MAX];
+    uint32_t frame_length = EVERT_TELEMETRY_BuildFrame(telemetry, schema, payload, length, frame);
+
+    if (HAL_UART_Transmit(telemetry->huart, frame, (uint16_t)frame_length, timeout_ms) != HAL_OK)
+    {
+        telemetry->error_count++;
+        return TMS_ERROR;
+    }
+
+    telemetry->record_count++;
+    return TMS_OK;
+}
+
+/// @brief Receive records from the host, (on_receive) is called from EVERT_TELEMETRY_Process
+void EVERT_TELEMETRY_StartReceive(EVERT_TELEMETRY_HandlerTypeDef *telemetry, EVERT_TELEMETRY_ReceiveCallbackTypeDef on_receive)
+{
+    telemetry->on_receive = on_receive;
+
+    if (HAL_UARTEx_ReceiveToIdle_IT(telemetry->huart, telemetry->rx_chunk, sizeof(telemetry->rx_chunk)) != HAL_OK)
+    {
+        telemetry->rx_error_count++;
+    }
+}
+
+/// @brief Check and hand over a complete frame
+static void EVERT_TELEMETRY_OnFrame(EVERT_TELEMETRY_HandlerTypeDef *telemetry)
+{
+    uint8_t record[EVERT_TELEMETRY_FRAME_MAX];
+    size_t length = EVERT_TELEMETRY_CobsDecode(telemetry->rx_frame, telemetry->rx_frame_length, record);
+
+    if (length < EVERT_TELEMETRY_HEADER_SIZE + EVERT_TELEMETRY_CRC_SIZE)
+    {
+        telemetry->rx_error_count++;
+        return;
+    }
+
+    uint32_t crc;
+    memcpy(&crc, &record[length - EVERT_TELEMETRY_CRC_SIZE], sizeof(crc));
+
+    if (EVERT_CRC32(record, length - EVERT_TELEMETRY_CRC_SIZE) != crc)
+    {
+        telemetry->rx_error_count++;
+        return;
+    }
+
+    if (telemetry->on_receive != NULL)
+    {
+        telemetry->on_receive(record[0], &record[EVERT_TELEMETRY_HEADER_SIZE], length - EVERT_TELEMETRY_HEADER_SIZE - EVERT_TELEMETRY_CRC_SIZE);
+    }
+}
+
+/// @brief Split the received bytes into frames
+static void EVERT_TELEMETRY_ProcessReceive(EVERT_TELEMETRY_HandlerTypeDef *telemetry)
+{
+    uint32_t tail = telemetry->rx_tail;
+
+    while (tail != telemetry->rx_head)
+    {
+        uint8_t byte = telemetry->rx_ring[tail];
+        tail = (tail + 1) & (EVERT_TELEMETRY_RX_SIZE - 1);
+
+        if (byte == 0x00)
+        {
+            if (telemetry->rx_frame_length > 0 && telemetry->rx_frame_length <= sizeof(telemetry->rx_frame))
+            {
+                EVERT_TELEMETRY_OnFrame(telemetry);
+            }
+            telemetry->rx_frame_length = 0;
+        }
+        else if (telemetry->rx_frame_length < sizeof(telemetry->rx_frame))
+        {
+            telemetry->rx_frame[telemetry->rx_frame_length++] = byte;
+        }
+        else if (telemetry->rx_frame_length == sizeof(telemetry->rx_frame))
+        {
+            // Too long, drop it up to the next delimiter
+            telemetry->rx_error_count++;
+            telemetry->rx_frame_length++;
+        }
+    }
+
+    telemetry->rx_tail = tail;
+}
+
+/// @brief Start a transfer when the line is idle and handle received records, call from the main loop
+void EVERT_TELEMETRY_Process(EVERT_TELEMETRY_HandlerTypeDef *telemetry)
+{
+    EVERT_TELEMETRY_ProcessReceive(telemetry);
+    EVERT_TELEMETRY_Kick(telemetry);
+}
+
+/// @brief Room left in the fill buffer (bytes, framed)
+uint32_t EVERT_TELEMETRY_GetFree(const EVERT_TELEMETRY_HandlerTypeDef *telemetry)
+{
+    return EVERT_TELEMETRY_BUFFER_SIZE - telemetry->length[telemetry->fill];
+}
+
+void EVERT_TELEMETRY_OnTxComplete(EVERT_TELEMETRY_HandlerTypeDef *telemetry, UART_HandleTypeDef *huart)
+{
+    if (huart != telemetry->huart)
+    {
+        return;
+    }
+
+    telemetry->busy = false;
+
+    // Back to back while records keep coming
+    EVERT_TELEMETRY_Kick(telemetry);
+}
+
+/// @brief Forward HAL_UARTEx_RxEventCallback, queues the chunk and restarts the reception
+void EVERT_TELEMETRY_OnRxEvent(EVERT_TELEMETRY_HandlerTypeDef *telemetry, UART_HandleTypeDef *huart, const uint16_t size)
+{
+    if (huart != telemetry->huart)
+    {
+        return;
+    }
+
+    uint32_t head = telemetry->rx_head;
+
+    for (uint32_t i = 0; i < size && i < sizeof(telemetry->rx_chunk); i++)
+    {
+        uint32_t next = (head + 1) & (EVERT_TELEMETRY_RX_SIZE - 1);
+
+        if (next == telemetry->rx_tail)
+        {
+            telemetry->rx_error_count++;
+            break;
+        }
+
+        telemetry->rx_ring[head] = telemetry->rx_chunk[i];
+        head = next;
+    }
+
+    telemetry->rx_head = head;
+
+    if (HAL_UARTEx_ReceiveToIdle_IT(huart, telemetry->rx_chunk, sizeof(telemetry->rx_chunk)) != HAL_OK)
+    {
+        telemetry->rx_error_count++;
+    }
+}
+
+void EVERT_TELEMETRY_OnError(EVERT_TELEMETRY_HandlerTypeDef *telemetry, UART_HandleTypeDef *huart)
+{
+    if (huart != telemetry->huart)
+    {
+        return;
+    }
+
+    telemetry->error_count++;
+
+    if (telemetry->busy && huart->gState == HAL_UART_STATE_READY)
+    {
+        telemetry->busy = false;
+    }
+
+    // Errors (framing, noise, overrun) abort the reception, restart it
+    if (telemetry->on_receive != NULL && huart->RxState == HAL_UART_STATE_READY)
+    {
+        HAL_UARTEx_ReceiveToIdle_IT(huart, telemetry->rx_chunk, sizeof(telemetry->rx_chunk));
+    }
+}
+
+#endif // EVERT_HAL_CONF_TELEMETRY_ENABLE
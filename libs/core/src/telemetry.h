@@ -0,0 +1,90 @@
+#ifndef EVERT_TELEMETRY_H_
+#define EVERT_TELEMETRY_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stm32g4xx_hal.h>
+#include "_conf_evert_hal.h"
+
+// Binary telemetry over a UART with TX DMA.
+// * Record: [schema u8][sequence u8][tick u32][payload][crc32 u32], little endian, CRC-32 (crc.h) over
+//   everything before it. The schema identifies the payload layout, the sequence exposes dropped records.
+// * Frame: the record COBS encoded and terminated with 0x00, a receiver resyncs on the next 0x00
+// * Double buffer: records are encoded into the fill buffer (any context, the copy is a short critical
+//   section) while the other one is on the wire. The DMA completion swaps them, so nothing ever waits on
+//   the UART; a record that does not fit is dropped and counted.
+// * Receive (optional): the same frames from the host, collected from HAL_UARTEx_ReceiveToIdle_IT chunks
+//   and decoded in EVERT_TELEMETRY_Process, valid records go to the receive callback
+// The application forwards the HAL UART TX complete/RX event/error callbacks and calls EVERT_TELEMETRY_Process
+// from the main loop to start a transfer when the line is idle.
+
+#if EVERT_HAL_CONF_TELEMETRY_ENABLE
+
+#define EVERT_TELEMETRY_BUFFER_SIZE (EVERT_HAL_CONF_TELEMETRY_BUFFER_SIZE)
+#define EVERT_TELEMETRY_PAYLOAD_MAX (EVERT_HAL_CONF_TELEMETRY_PAYLOAD_MAX)
+
+#ifdef EVERT_HAL_CONF_TELEMETRY_RX_SIZE
+#define EVERT_TELEMETRY_RX_SIZE EVERT_HAL_CONF_TELEMETRY_RX_SIZE
+#else
+#define EVERT_TELEMETRY_RX_SIZE (256) // Received bytes waiting for the main loop, power of 2
+#endif
+#define EVERT_TELEMETRY_RX_CHUNK_SIZE (32)
+
+#define EVERT_TELEMETRY_HEADER_SIZE (6)
+#define EVERT_TELEMETRY_CRC_SIZE (4)
+#define EVERT_TELEMETRY_RECORD_MAX (EVERT_TELEMETRY_HEADER_SIZE + EVERT_TELEMETRY_PAYLOAD_MAX + EVERT_TELEMETRY_CRC_SIZE)
+#define EVERT_TELEMETRY_FRAME_MAX (EVERT_TELEMETRY_RECORD_MAX + (EVERT_TELEMETRY_RECORD_MAX / 254) + 2) // COBS overhead + delimiter
+
+typedef enum
+{
+    TMS_OK = 0,
+    TMS_FULL = 1, // Dropped, the fill buffer has no room
+    TMS_INVALID = 2,
+    TMS_ERROR = 3
+} EVERT_TELEMETRY_StatusTypeDef;
+
+/// @brief Receive callback, called from EVERT_TELEMETRY_Process (main loop)
+typedef void (*EVERT_TELEMETRY_ReceiveCallbackTypeDef)(const uint8_t schema, const uint8_t *payload, const uint32_t length);
+
+typedef struct
+{
+    UART_HandleTypeDef *huart;
+    uint8_t buffer[2][EVERT_TELEMETRY_BUFFER_SIZE];
+    volatile uint32_t length[2];
+    volatile uint32_t fill; // Buffer records are appended to, the other one is on the wire while busy
+    volatile bool busy;
+    uint8_t sequence;
+
+    // Receive
+    EVERT_TELEMETRY_ReceiveCallbackTypeDef on_receive;
+    uint8_t rx_chunk[EVERT_TELEMETRY_RX_CHUNK_SIZE];
+    uint8_t rx_ring[EVERT_TELEMETRY_RX_SIZE];
+    volatile uint32_t rx_head; // Written by the RX event callback
+    volatile uint32_t rx_tail; // Written by the main loop
+    uint8_t rx_frame[EVERT_TELEMETRY_FRAME_MAX];
+    uint32_t rx_frame_length;
+
+    // Statistics
+    uint32_t record_count;
+    uint32_t drop_count;
+    uint32_t error_count;
+    uint32_t rx_error_count; // Overruns, bad frames
+} EVERT_TELEMETRY_HandlerTypeDef;
+
+void EVERT_TELEMETRY_Init(EVERT_TELEMETRY_HandlerTypeDef *telemetry, UART_HandleTypeDef *huart);
+EVERT_TELEMETRY_StatusTypeDef EVERT_TELEMETRY_Send(EVERT_TELEMETRY_HandlerTypeDef *telemetry, const uint8_t schema, const void *payload, const uint32_t length);
+EVERT_TELEMETRY_StatusTypeDef EVERT_TELEMETRY_SendBlocking(EVERT_TELEMETRY_HandlerTypeDef *telemetry, const uint8_t schema, const void *payload, const uint32_t length, const uint32_t timeout_ms);
+void EVERT_TELEMETRY_StartReceive(EVERT_TELEMETRY_HandlerTypeDef *telemetry, EVERT_TELEMETRY_ReceiveCallbackTypeDef on_receive);
+void EVERT_TELEMETRY_Process(EVERT_TELEMETRY_HandlerTypeDef *telemetry);
+uint32_t EVERT_TELEMETRY_GetFree(const EVERT_TELEMETRY_HandlerTypeDef *telemetry);
+
+void EVERT_TELEMETRY_OnTxComplete(EVERT_TELEMETRY_HandlerTypeDef *telemetry, UART_HandleTypeDef *huart);
+void EVERT_TELEMETRY_OnRxEvent(EVERT_TELEMETRY_HandlerTypeDef *telemetry, UART_HandleTypeDef *huart, const uint16_t size);
+void EVERT_TELEMETRY_OnError(EVERT_TELEMETRY_HandlerTypeDef *telemetry, UART_HandleTypeDef *huart);
+
+size_t EVERT_TELEMETRY_CobsEncode(const uint8_t *source, const size_t length, uint8_t *destination);
+size_t EVERT_TELEMETRY_CobsDecode(const uint8_t *source, const size_t length, uint8_t *destination);
+
+#endif // EVERT_HAL_CONF_TELEMETRY_ENABLE
+#endif // EVERT_TELEMETRY_H_
@@ -0,0 +1,214 @@
+#include "time_sync.h"
+#include <stdlib.h>
+#include <string.h>
+#include "evert_hal_dwt.h"
+
+#if EVERT_HAL_CONF_TIME_SYNC_ENABLE
+
+#define EVERT_TIME_SYNC_SLEW_MAX (4294967)           // 1000 ppm in 2^-32
+#define EVERT_TIME_SYNC_REANCHOR_US (3600000000ull)  // Holdover this long: move the anchor, elapsed * rate stays in range
+
+_Static_assert(EVERT_TIME_SYNC_RATE_MAX < EVERT_TIME_SYNC_SLEW_MAX, "EVERT_TIME_SYNC_RATE_MAX too large");
+
+EVERT_TIME_SYNC_HandlerTypeDef time_sync = {0};
+
+/// @brief DWT cycles extended to 64 bits, call with the interrupts masked
+static uint64_t EVERT_TIME_SYNC_ReadCycles(void)
+{
+    uint32_t cycles = EVERT_HAL_DWT_GetCycles();
+
+    if (cycles < time_sync.cycles_last)
+    {
+        time_sync.cycles_wraps++;
+    }
+
+    time_sync.cycles_last = cycles;
+
+    return ((uint64_t)time_sync.cycles_wraps << 32) | cycles;
+}
+
+static inline uint64_t EVERT_TIME_SYNC_CyclesToUs(const uint64_t cycles)
+{
+    uint32_t cycles_per_us = SystemCoreClock / 1000000u;
+    return cycles / (cycles_per_us > 0 ? cycles_per_us : 1);
+}
+
+static inline int32_t EVERT_TIME_SYNC_Clamp(const int64_t value, const int32_t limit)
+{
+    return value > limit ? limit : value < -limit ? -limit : (int32_t)value;
+}
+
+/// @brief Master time of a local time, call with the interrupts masked
+static uint64_t EVERT_TIME_SYNC_Model(const uint64_t local_us)
+{
+    int64_t elapsed = (int64_t)(local_us - time_sync.local_anchor_us);
+    int64_t slewed = elapsed < 0 ? 0 : elapsed < (int64_t)time_sync.slew_span_us ? elapsed : (int64_t)time_sync.slew_span_us;
+    int64_t correction = (elapsed * time_sync.rate + slewed * time_sync.slew) >> 32;
+
+    return time_sync.master_anchor_us + (uint64_t)(elapsed + correction);
+}
+
+void EVERT_TIME_SYNC_Init(void)
+{
+    memset(&time_sync, 0, sizeof(time_sync));
+
+    EVERT_HAL_DWT_EnableCycleCounter();
+    time_sync.cycles_last = EVERT_HAL_DWT_GetCycles();
+}
+
+/// @brief Count the cycle counter wraps and drop the lock without pairs, main loop
+void EVERT_TIME_SYNC_Process(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint64_t local_us = EVERT_TIME_SYNC_CyclesToUs(EVERT_TIME_SYNC_ReadCycles());
+
+    if (time_sync.valid && local_us - time_sync.local_anchor_us > EVERT_TIME_SYNC_REANCHOR_US)
+    {
+        time_sync.master_anchor_us = EVERT_TIME_SYNC_Model(local_us);
+        time_sync.local_anchor_us = local_us;
+        time_sync.slew = 0;
+        time_sync.slew_span_us = 0;
+    }
+
+    __set_PRIMASK(primask);
+
+    if (time_sync.locked && local_us - time_sync.pair_local_us > (uint64_t)EVERT_TIME_SYNC_HOLDOVER_MS * 1000u)
+    {
+        time_sync.locked = false;
+    }
+}
+
+/// @brief Local clock in us since the cycle counter started, any context
+uint64_t EVERT_TIME_SYNC_GetLocalUs(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint64_t local_us = EVERT_TIME_SYNC_CyclesToUs(EVERT_TIME_SYNC_ReadCycles());
+
+    __set_PRIMASK(primask);
+
+    return local_us;
+}
+
+/// @brief Local clock of a cycle count taken less than a wrap ago (e.g. the CAN handler rx_timestamp)
+uint64_t EVERT_TIME_SYNC_CyclesToLocalUs(const uint32_t cycles)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint64_t now = EVERT_TIME_SYNC_ReadCycles();
+    uint64_t local_us = EVERT_TIME_SYNC_CyclesToUs(now - (uint32_t)((uint32_t)now - cycles));
+
+    __set_PRIMASK(primask);
+
+    return local_us;
+}
+
+/// @brief SYNC received, main loop
+/// @param sequence Message id of the SYNC
+/// @param cycles DWT cycles at its start of frame
+void EVERT_TIME_SYNC_OnSync(const uint8_t sequence, const uint32_t cycles)
+{
+    time_sync.sync_local_us = EVERT_TIME_SYNC_CyclesToLocalUs(cycles);
+    time_sync.sync_sequence = sequence;
+    time_sync.sync_pending = true;
+}
+
+/// @brief FOLLOW-UP received, main loop: pair it with its SYNC and discipline the clock
+/// @param sequence Message id of the FOLLOW-UP
+/// @param master_us Master time of the start of frame of the SYNC
+void EVERT_TIME_SYNC_OnFollowUp(const uint8_t sequence, const uint64_t master_us)
+{
+    if (!time_sync.sync_pending || sequence != time_sync.sync_sequence)
+    {
+        time_sync.mismatch_count++;
+        return;
+    }
+
+    time_sync.sync_pending = false;
+
+    uint64_t local_us = time_sync.sync_local_us;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint64_t predicted_us = EVERT_TIME_SYNC_Model(local_us);
+    int64_t error = (int64_t)(master_us - predicted_us);
+
+    if (!time_sync.valid || llabs(error) > EVERT_TIME_SYNC_STEP_US)
+    {
+        // First pair or lost: step to the master, keep the rate learned so far
+        time_sync.local_anchor_us = local_us;
+        time_sync.master_anchor_us = master_us;
+        time_sync.slew = 0;
+        time_sync.slew_span_us = 0;
+        time_sync.valid = true;
+        time_sync.pair_count = 0;
+        time_sync.lock_count = 0;
+        time_sync.step_count++;
+    }
+    else
+    {
+        // Rate: drift of the master against the local clock between the last two pairs
+        int64_t local_span = (int64_t)(local_us - time_sync.pair_local_us);
+        int64_t master_span = (int64_t)(master_us - time_sync.pair_master_us);
+
+        if (local_span > 0 && local_span <= UINT32_MAX)
+        {
+            int64_t measured = EVERT_TIME_SYNC_Clamp((master_span - local_span) * 4294967296ll / local_span, EVERT_TIME_SYNC_RATE_MAX);
+
+            // The first interval after a step sets the rate, the filter takes the jitter out of the next ones
+            time_sync.rate += time_sync.pair_count == 0 ? (int32_t)(measured - time_sync.rate) : (int32_t)((measured - time_sync.rate) / (1 << EVERT_TIME_SYNC_RATE_GAIN_SHIFT));
+        }
+
+        // Offset: continue from the prediction and slew part of the error out until the next pair is due
+        uint32_t span_us = local_span > 0 && local_span <= UINT32_MAX ? (uint32_t)local_span : 1000000u;
+
+        time_sync.local_anchor_us = local_us;
+        time_sync.master_anchor_us = predicted_us;
+        time_sync.slew = EVERT_TIME_SYNC_Clamp((error / (1 << EVERT_TIME_SYNC_SLEW_GAIN_SHIFT)) * 4294967296ll / span_us, EVERT_TIME_SYNC_SLEW_MAX);
+        time_sync.slew_span_us = span_us;
+        time_sync.pair_count++;
+        time_sync.lock_count = llabs(error) <= EVERT_TIME_SYNC_LOCK_US ? time_sync.lock_count + 1 : 0;
+    }
+
+    __set_PRIMASK(primask);
+
+    time_sync.pair_local_us = local_us;
+    time_sync.pair_master_us = master_us;
+    time_sync.error_us = EVERT_TIME_SYNC_Clamp(error, INT32_MAX);
+    time_sync.rate_ppb = (int32_t)(((int64_t)time_sync.rate * 1000000000ll) >> 32);
+    time_sync.locked = time_sync.lock_count >= EVERT_TIME_SYNC_LOCK_PAIRS;
+}
+
+/// @brief Synchronized time of a local time (EVERT_TIME_SYNC_GetLocalUs, EVERT_TIME_SYNC_CyclesToLocalUs), 0 before the first pair
+uint64_t EVERT_TIME_SYNC_FromLocal(const uint64_t local_us)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint64_t master_us = time_sync.valid ? EVERT_TIME_SYNC_Model(local_us) : 0;
+
+    __set_PRIMASK(primask);
+
+    return master_us;
+}
+
+/// @brief Synchronized time in us, any context, 0 before the first pair
+uint64_t EVERT_TIME_SYNC_Now(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint64_t local_us = EVERT_TIME_SYNC_CyclesToUs(EVERT_TIME_SYNC_ReadCycles());
+    uint64_t master_us = time_sync.valid ? EVERT_TIME_SYNC_Model(local_us) : 0;
+
+    __set_PRIMASK(primask);
+
+    return master_us;
+}
+
+#endif // EVERT_HAL_CONF_TIME_SYNC_ENABLE
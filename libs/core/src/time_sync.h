@@ -0,0 +1,84 @@
+#ifndef EVERT_TIME_SYNC_H_
+#define EVERT_TIME_SYNC_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32g4xx_hal.h>
+#include "_conf_evert_hal.h"
+
+// Time synchronization: a microsecond clock shared by the devices on the CAN bus, the CCU is the master.
+// * Local clock: the DWT cycle counter extended to 64 bits, any context. It wraps every 25 s at 170 MHz,
+//   EVERT_TIME_SYNC_Process in the main loop reads it often enough to count the wraps.
+// * SYNC (broadcast, message id = sequence): the CAN handler takes the start of frame from the FDCAN timestamp
+//   counter (can_handler.h, rx_timestamp), the application passes it to EVERT_TIME_SYNC_OnSync
+// * FOLLOW-UP (same sequence): the master time of that start of frame, the CCU takes it when its own SYNC
+//   comes back from the bus. EVERT_TIME_SYNC_OnFollowUp pairs both and disciplines the clock:
+//   - the first pair, or an error above EVERT_TIME_SYNC_STEP_US, steps the clock to the master
+//   - after that the rate follows the drift between consecutive pairs (the first one after a step as is, then
+//     filtered) and the error of each pair is slewed out over the next interval, the synchronized time never jumps
+// * EVERT_TIME_SYNC_Now: synchronized time in us, any context, 0 until the first pair.
+//   Locked: the last EVERT_TIME_SYNC_LOCK_PAIRS errors within EVERT_TIME_SYNC_LOCK_US and a pair within
+//   EVERT_TIME_SYNC_HOLDOVER_MS.
+// Resolution: one CAN bit time on either side (2 us at 500 kbit/s), the crystals drift in between.
+
+#if EVERT_HAL_CONF_TIME_SYNC_ENABLE
+
+#define EVERT_TIME_SYNC_STEP_US (1000)       // Error that steps the clock instead of slewing it
+#define EVERT_TIME_SYNC_LOCK_US (10)         // Error of a locked clock
+#define EVERT_TIME_SYNC_LOCK_PAIRS (2)       // Pairs in a row within EVERT_TIME_SYNC_LOCK_US to lock
+#define EVERT_TIME_SYNC_HOLDOVER_MS (5000)   // Locked without a pair this long, the rate holds the clock
+#define EVERT_TIME_SYNC_RATE_MAX (2147483)   // 500 ppm in 2^-32, crystal tolerance of both ends; beyond it the pair is off
+#define EVERT_TIME_SYNC_RATE_GAIN_SHIFT (2)  // Rate filter, 1/4 of the measured drift per pair
+#define EVERT_TIME_SYNC_SLEW_GAIN_SHIFT (1)  // 1/2 of the error slewed out per interval
+
+typedef struct
+{
+    // Local clock: DWT cycles extended to 64 bits
+    uint32_t cycles_last;
+    uint32_t cycles_wraps;
+
+    // SYNC waiting for its FOLLOW-UP
+    bool sync_pending;
+    uint8_t sync_sequence;
+    uint64_t sync_local_us;
+
+    // Model: master = master_anchor_us + elapsed + elapsed * rate + min(elapsed, slew_span_us) * slew, elapsed = local - local_anchor_us
+    bool valid; // Stepped at least once
+    uint64_t local_anchor_us;
+    uint64_t master_anchor_us;
+    int32_t rate; // Master over local rate - 1, in 2^-32
+    int32_t slew; // Rate of the phase correction, in 2^-32
+    uint32_t slew_span_us;
+
+    // Last pair, the rate measurement
+    uint64_t pair_local_us;
+    uint64_t pair_master_us;
+
+    // Status
+    volatile bool locked;
+    int32_t error_us;        // Master time of the last pair less the prediction
+    int32_t rate_ppb;        // rate in parts per billion
+    uint32_t pair_count;     // Pairs since the last step
+    uint32_t lock_count;     // Pairs in a row within EVERT_TIME_SYNC_LOCK_US
+    uint32_t step_count;
+    uint32_t mismatch_count; // FOLLOW-UP without its SYNC (lost frame, reordered)
+} EVERT_TIME_SYNC_HandlerTypeDef;
+
+extern EVERT_TIME_SYNC_HandlerTypeDef time_sync;
+
+void EVERT_TIME_SYNC_Init(void);
+void EVERT_TIME_SYNC_Process(void);
+uint64_t EVERT_TIME_SYNC_GetLocalUs(void);
+uint64_t EVERT_TIME_SYNC_CyclesToLocalUs(const uint32_t cycles);
+void EVERT_TIME_SYNC_OnSync(const uint8_t sequence, const uint32_t cycles);
+void EVERT_TIME_SYNC_OnFollowUp(const uint8_t sequence, const uint64_t master_us);
+uint64_t EVERT_TIME_SYNC_FromLocal(const uint64_t local_us);
+uint64_t EVERT_TIME_SYNC_Now(void);
+
+static inline bool EVERT_TIME_SYNC_IsLocked(void)
+{
+    return time_sync.locked;
+}
+
+#endif // EVERT_HAL_CONF_TIME_SYNC_ENABLE
+#endif // EVERT_TIME_SYNC_H_
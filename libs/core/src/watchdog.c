@@ -0,0 +1,163 @@
+#include "watchdog.h"
+#include <stdio.h>
+#include <string.h>
+#include <stm32g4xx_ll_iwdg.h>
+#include <stm32g4xx_ll_wwdg.h>
+#include "fault_record.h"
+
+#if EVERT_HAL_CONF_WATCHDOG_ENABLE
+
+_Static_assert(EVERT_WATCHDOG_IWDG_TIMEOUT_MS > 0 && EVERT_WATCHDOG_IWDG_TIMEOUT_MS <= 0x0FFF, "EVERT_HAL_CONF_WATCHDOG_IWDG_TIMEOUT_MS out of range");
+_Static_assert(EVERT_WATCHDOG_CHECKPOINT_COUNT < EVERT_WATCHDOG_NONE, "EVERT_HAL_CONF_WATCHDOG_CHECKPOINT_COUNT too large");
+
+EVERT_WATCHDOG_HandlerTypeDef watchdog = {0};
+
+/// @brief Capture the cause before the watchdog resets, reported on the next boot
+static void EVERT_WATCHDOG_Capture(const char *name)
+{
+#if EVERT_HAL_CONF_FAULT_RECORD_ENABLE
+    char message[EVERT_FAULT_RECORD_MESSAGE_SIZE];
+
+    snprintf(message, sizeof(message), "Watchdog: %s", name);
+    EVERT_FAULT_RECORD_CaptureError(message, 0); // The message names the checkpoint
+#else
+    UNUSED(name);
+#endif
+}
+
+void EVERT_WATCHDOG_Init(void)
+{
+    memset(&watchdog, 0, sizeof(watchdog));
+    watchdog.expired = EVERT_WATCHDOG_NONE;
+}
+
+void EVERT_WATCHDOG_Register(const uint8_t checkpoint, const char *name, const uint32_t deadline_ms)
+{
+    if (checkpoint >= EVERT_WATCHDOG_CHECKPOINT_COUNT || deadline_ms == 0)
+    {
+        return;
+    }
+
+    watchdog.checkpoints[checkpoint].name = name;
+    watchdog.checkpoints[checkpoint].deadline_ms = deadline_ms;
+    watchdog.checkpoints[checkpoint].last_tick = HAL_GetTick();
+}
+
+/// @brief Start both watchdogs, call last in main (the deadlines run from here)
+void EVERT_WATCHDOG_Start(void)
+{
+    uint32_t now = HAL_GetTick();
+
+    for (uint32_t i = 0; i < EVERT_WATCHDOG_CHECKPOINT_COUNT; i++)
+    {
+        watchdog.checkpoints[i].last_tick = now;
+    }
+
+    // Hold both while a debugger halts the core
+    DBGMCU->APB1FZR1 |= DBGMCU_APB1FZR1_DBG_IWDG_STOP | DBGMCU_APB1FZR1_DBG_WWDG_STOP;
+
+    // IWDG: LSI (32 kHz) / 32, 1 ms per count, no window
+    LL_IWDG_Enable(IWDG);
+    LL_IWDG_EnableWriteAccess(IWDG);
+    LL_IWDG_SetPrescaler(IWDG, LL_IWDG_PRESCALER_32);
+    LL_IWDG_SetReloadCounter(IWDG, EVERT_WATCHDOG_IWDG_TIMEOUT_MS);
+
+    while (!LL_IWDG_IsReady(IWDG))
+    {
+    }
+
+    LL_IWDG_ReloadCounter(IWDG);
+
+#if EVERT_HAL_CONF_WATCHDOG_WWDG_ENABLE
+    // WWDG: PCLK1 / 4096 / 2^prescaler per count, early wakeup one count before the reset
+    __HAL_RCC_WWDG_CLK_ENABLE();
+    LL_WWDG_SetPrescaler(WWDG, EVERT_HAL_CONF_WATCHDOG_WWDG_PRESCALER);
+    LL_WWDG_SetWindow(WWDG, EVERT_HAL_CONF_WATCHDOG_WWDG_WINDOW);
+    LL_WWDG_ClearFlag_EWKUP(WWDG);
+    LL_WWDG_EnableIT_EWKUP(WWDG);
+    HAL_NVIC_SetPriority(WWDG_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(WWDG_IRQn);
+
+    watchdog.window_calls = 0;
+    WWDG->CR = WWDG_CR_WDGA | EVERT_WATCHDOG_WWDG_COUNTER;
+#endif
+
+    watchdog.started = true;
+}
+
+/// @brief Check the deadlines and refresh the IWDG while all are met, call from the main loop
+void EVERT_WATCHDOG_Process(void)
+{
+    if (!watchdog.started || watchdog.expired != EVERT_WATCHDOG_NONE)
+    {
+        return; // Expired: let the IWDG reset
+    }
+
+    uint32_t now = HAL_GetTick();
+
+    for (uint32_t i = 0; i < EVERT_WATCHDOG_CHECKPOINT_COUNT; i++)
+    {
+        EVERT_WATCHDOG_CheckpointTypeDef *checkpoint = &watchdog.checkpoints[i];
+
+        if (checkpoint->deadline_ms == 0)
+        {
+            continue;
+        }
+
+        uint32_t elapsed = now - checkpoint->last_tick;
+
+        if (elapsed > watchdog.max_late_ms)
+        {
+            watchdog.max_late_ms = elapsed;
+        }
+
+        if (elapsed > checkpoint->deadline_ms)
+        {
+            watchdog.expired = (uint8_t)i;
+
+            EVERT_WATCHDOG_EnterSafeState();
+            EVERT_WATCHDOG_Capture(checkpoint->name);
+            return;
+        }
+    }
+
+    LL_IWDG_ReloadCounter(IWDG);
+}
+
+/// @brief Keep the device alive in a blocking path (post-mortem dump), only once the outputs are off
+void EVERT_WATCHDOG_Feed(void)
+{
+    if (!watchdog.started || !watchdog.safe_state)
+    {
+        return;
+    }
+
+    LL_IWDG_ReloadCounter(IWDG);
+
+#if EVERT_HAL_CONF_WATCHDOG_WWDG_ENABLE
+    if (LL_WWDG_GetCounter(WWDG) < EVERT_HAL_CONF_WATCHDOG_WWDG_WINDOW)
+    {
+        WWDG->CR = WWDG_CR_WDGA | EVERT_WATCHDOG_WWDG_COUNTER;
+    }
+#endif
+}
+
+/// @brief Disable the outputs, any context (the hook only touches registers)
+void EVERT_WATCHDOG_EnterSafeState(void)
+{
+    EVERT_WATCHDOG_OnSafeState();
+    watchdog.safe_state = true;
+}
+
+/// @brief WWDG early wakeup (WWDG_IRQHandler), the HF ISR missed its window
+void EVERT_WATCHDOG_OnEarlyWakeup(void)
+{
+    LL_WWDG_ClearFlag_EWKUP(WWDG);
+
+    EVERT_WATCHDOG_EnterSafeState();
+    EVERT_WATCHDOG_Capture("HF ISR window");
+}
+
+__weak void EVERT_WATCHDOG_OnSafeState(void) {}
+
+#endif // EVERT_HAL_CONF_WATCHDOG_ENABLE
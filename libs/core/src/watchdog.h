@@ -0,0 +1,76 @@
+#ifndef EVERT_WATCHDOG_H_
+#define EVERT_WATCHDOG_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32g4xx_hal.h>
+#include "_conf_evert_hal.h"
+
+// Watchdog supervisor: a stalled loop or ISR must not leave the power stage running on stale duty values.
+// * Checkpoints: each supervised task/ISR checks in (EVERT_WATCHDOG_Checkin, any context) at least once
+//   per deadline. EVERT_WATCHDOG_Process (main loop) refreshes the IWDG only while every checkpoint is on
+//   time, so a stalled main loop and a missed deadline both end in an IWDG reset.
+// * Window: the HF ISR calls EVERT_WATCHDOG_WindowCheckin, which refreshes the WWDG every
+//   EVERT_HAL_CONF_WATCHDOG_WWDG_DIVIDER calls. Too slow or too fast (refresh before the window) resets.
+// * Safe state: on a missed deadline and on the WWDG early wakeup (one count before the reset) the
+//   application hook EVERT_WATCHDOG_OnSafeState disables the outputs, then the cause is captured in the
+//   fault record (fault_record.h) and the watchdog is left to reset the device.
+// Both watchdogs are frozen while a debugger halts the core. Once started they cannot be stopped.
+
+#if EVERT_HAL_CONF_WATCHDOG_ENABLE
+
+#define EVERT_WATCHDOG_CHECKPOINT_COUNT (EVERT_HAL_CONF_WATCHDOG_CHECKPOINT_COUNT)
+#define EVERT_WATCHDOG_IWDG_TIMEOUT_MS (EVERT_HAL_CONF_WATCHDOG_IWDG_TIMEOUT_MS) // LSI / 32 = 1 ms per count, max 4095
+
+#define EVERT_WATCHDOG_WWDG_COUNTER (0x7F) // Reset at 0x3F, 64 counts after a refresh
+#define EVERT_WATCHDOG_NONE (0xFF)
+
+typedef struct
+{
+    const char *name;
+    uint32_t deadline_ms; // 0: not registered
+    volatile uint32_t last_tick;
+} EVERT_WATCHDOG_CheckpointTypeDef;
+
+typedef struct
+{
+    EVERT_WATCHDOG_CheckpointTypeDef checkpoints[EVERT_WATCHDOG_CHECKPOINT_COUNT];
+    bool started;
+    volatile bool safe_state;
+    uint8_t expired; // First checkpoint that missed its deadline, EVERT_WATCHDOG_NONE if none
+    uint32_t window_calls;
+    uint32_t max_late_ms; // Worst check-in delay seen against any deadline, for tuning
+} EVERT_WATCHDOG_HandlerTypeDef;
+
+extern EVERT_WATCHDOG_HandlerTypeDef watchdog;
+
+void EVERT_WATCHDOG_Init(void);
+void EVERT_WATCHDOG_Register(const uint8_t checkpoint, const char *name, const uint32_t deadline_ms);
+void EVERT_WATCHDOG_Start(void);
+void EVERT_WATCHDOG_Process(void);
+void EVERT_WATCHDOG_Feed(void);
+void EVERT_WATCHDOG_EnterSafeState(void);
+void EVERT_WATCHDOG_OnEarlyWakeup(void);
+
+void EVERT_WATCHDOG_OnSafeState(void);
+
+/// @brief Liveness token, any context
+static inline void EVERT_WATCHDOG_Checkin(const uint8_t checkpoint)
+{
+    watchdog.checkpoints[checkpoint].last_tick = HAL_GetTick();
+}
+
+/// @brief HF ISR timing window, call once per HF ISR
+static inline void EVERT_WATCHDOG_WindowCheckin(void)
+{
+#if EVERT_HAL_CONF_WATCHDOG_WWDG_ENABLE
+    if (watchdog.started && ++watchdog.window_calls >= EVERT_HAL_CONF_WATCHDOG_WWDG_DIVIDER)
+    {
+        watchdog.window_calls = 0;
+        WWDG->CR = WWDG_CR_WDGA | EVERT_WATCHDOG_WWDG_COUNTER;
+    }
+#endif
+}
+
+#endif // EVERT_HAL_CONF_WATCHDOG_ENABLE
+#endif // EVERT_WATCHDOG_H_
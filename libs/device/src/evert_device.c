@@ -1,7 +1,11 @@
 #include "adc.h"
 #include "evert_device.h"
+#include "fault_record.h"
+
+_Static_assert((EVERT_CONSTANT_DEVICE_EVENT_QUEUE_SIZE & (EVERT_CONSTANT_DEVICE_EVENT_QUEUE_SIZE - 1)) == 0, "EVERT_CONSTANT_DEVICE_EVENT_QUEUE_SIZE must be a power of 2");
 
 static EVERT_DEVICE_BaseDeviceTypeDef device;
+EVERT_DEVICE_BootTimingTypeDef device_boot_timing;
 
 //
 // #region "Alarm Matrix"
@@ -46,6 +50,11 @@ static const EVERT_DEVICE_AlarmRegister1IndexTypeDef device_operational_warning_
 //
 
 static void EVERT_DEVICE_State_Init();
+static void EVERT_DEVICE_State_Dispatch(const EVERT_DEVICE_EventTypeDef event);
+static void EVERT_DEVICE_State_OnEnterInternal(const EVERT_DEVICE_StateTypeDef state);
+static void EVERT_DEVICE_BootTiming_OnEnterInternal(const EVERT_DEVICE_StateTypeDef state);
+static bool EVERT_DEVICE_Guard_Recovered(const EVERT_DEVICE_StateTypeDef from);
+static bool EVERT_DEVICE_Guard_NoEmergencyAlarm(const EVERT_DEVICE_StateTypeDef from);
 void EVERT_DEVICE_State_Set(const EVERT_DEVICE_StateScopeTypeDef scope, const EVERT_DEVICE_StateTypeDef state);
 EVERT_DEVICE_StateTypeDef EVERT_DEVICE_State_Get(const EVERT_DEVICE_StateScopeTypeDef scope);
 static void EVERT_DEVICE_OnDeviceStateChange(const EVERT_DEVICE_StateTypeDef new_state, const EVERT_DEVICE_StateTypeDef old_state);
@@ -64,6 +73,42 @@ static void EVERT_DEVICE_OnEnterState_EmergencyShutdown(const EVERT_DEVICE_State
 // #endregion "Forward Declarations for Device State Machine"
 //
 
+//
+// #region "Transition Table"
+//
+
+#define DS_MASK(state) (1u << (state))
+
+/// @brief States the alarm level drives once the CCU acknowledged the device
+#define DS_MASK_RUNNING (DS_MASK(DS_HANDSHAKE_ACKNOWLEDGED) | DS_MASK(DS_OPERATIONAL) | DS_MASK(DS_OPERATIONAL_WARNING) | DS_MASK(DS_NON_OPERATIONAL))
+
+/// @brief Device State Transitions (internal state), first match wins
+static const EVERT_DEVICE_TransitionTypeDef device_transitions[] = {
+    // Boot
+    {DS_MASK(DS_BOOTING_ADC), DE_BOOT_ADC_DONE, NULL, DS_BOOTING_COMMS},
+    {DS_MASK(DS_BOOTING_COMMS), DE_BOOT_COMMS_DONE, NULL, DS_BOOTING_DONE},
+    {DS_MASK(DS_BOOTING_DONE), DE_BOOT_DONE, NULL, DS_HANDSHAKE_ANNOUNCING},
+
+    // Handshake
+    {DS_MASK(DS_HANDSHAKE_ANNOUNCING), DE_HANDSHAKE_ACK, NULL, DS_HANDSHAKE_ACKNOWLEDGED},
+
+    // Alarms, critical ones shut down even before the handshake
+    {DS_MASK_RUNNING | DS_MASK(DS_HANDSHAKE_ANNOUNCING), DE_ALARMS_EMERGENCY, NULL, DS_EMERGENCY_SHUTDOWN},
+    {DS_MASK_RUNNING, DE_ALARMS_NON_OPERATIONAL, NULL, DS_NON_OPERATIONAL},
+    {DS_MASK_RUNNING, DE_ALARMS_WARNING, EVERT_DEVICE_Guard_Recovered, DS_OPERATIONAL_WARNING},
+    {DS_MASK_RUNNING, DE_ALARMS_CLEAR, EVERT_DEVICE_Guard_Recovered, DS_OPERATIONAL},
+
+    // Heartbeat lost, announce again until the CCU acknowledges
+    {DS_MASK_RUNNING, DE_HEARTBEAT_TIMEOUT, NULL, DS_HANDSHAKE_ANNOUNCING},
+
+    // Emergency shutdown latches until the CCU resets it with the critical alarms gone
+    {DS_MASK(DS_EMERGENCY_SHUTDOWN), DE_RESET, EVERT_DEVICE_Guard_NoEmergencyAlarm, DS_NON_OPERATIONAL},
+};
+
+//
+// #endregion "Transition Table"
+//
+
 //
 // #region "Device"
 //
@@ -74,8 +119,22 @@ void EVERT_DEVICE_Init()
     // Alarm Registers
     device.AlarmRegister1.reg = 0;
 
+#if EVERT_HAL_CONF_FAULT_RECORD_ENABLE
+    // Reset cause (RCC->CSR flags, read by EVERT_FAULT_RECORD_Init before they were cleared)
+    device.PeripheralStatus.ResetCause = fault_record.reset_cause;
+    device.PeripheralStatus.WatchdogStatus = (fault_record.reset_cause & (RCC_CSR_IWDGRSTF | RCC_CSR_WWDGRSTF)) != 0;
+#endif
+
     // State Group
     EVERT_DEVICE_State_Init();
+    device.StateMachine.EventHead = 0;
+    device.StateMachine.EventTail = 0;
+    device.StateMachine.EventOverflowCount = 0;
+    device.StateMachine.AlarmCheckPending = false;
+    device.StateMachine.HeartbeatTick = HAL_GetTick();
+    device.StateMachine.HeartbeatPropagated = DS_UNKNOWN;
+    device.StateMachine.AlarmLevel = DS_OPERATIONAL;
+    device.StateMachine.AlarmNonOperationalTick = HAL_GetTick();
 
     // Task Scheduler
     EVERT_TASK_SCHEDULER_Init();
@@ -84,6 +143,11 @@ void EVERT_DEVICE_Init()
     EVERT_TASK_SCHEDULER_SetTaskSendDeviceStatusInterval(EVERT_SETTING_DEVICE_TASK_SEND_STATUS_INTERVAL);
     EVERT_TASK_SCHEDULER_SetTaskSendPingInterval(EVERT_SETTING_DEVICE_TASK_SEND_PING_INTERVAL);
 
+    // Boot Timing
+    device_boot_timing = (EVERT_DEVICE_BootTimingTypeDef){0};
+    device_boot_timing.InitMs = HAL_GetTick();
+    device_boot_timing.PhaseTick = device_boot_timing.InitMs;
+
     // State
     EVERT_DEVICE_State_Set(SS_INTERNAL, DS_BOOTING_ADC);
 }
@@ -95,26 +159,135 @@ void EVERT_DEVICE_SetVersionInfo(const uint8_t major, const uint8_t minor, const
     device.DeviceVersionInfo.patch = patch;
 }
 
-/// @brief Update the Device
-/// @param tick_ms Deltatime tick in milliseconds
+/// @brief Update the Device, runs the pending state transitions (main loop)
+/// @param elapsed_ms Time since boot in milliseconds
+/// @param delta_ms Deltatime tick in milliseconds
 void EVERT_DEVICE_Update(const uint32_t elapsed_ms, const uint32_t delta_ms)
 {
     // Update the Task Scheduler
     EVERT_TASK_SCHEDULER_Update(delta_ms);
 
-    if (device.StateGroup.Result == DS_BOOTING_ADC)
+    EVERT_DEVICE_StateMachineTypeDef *machine = &device.StateMachine;
+
+    // Readings settled, the boot time is the upper bound for an application that can not tell
+    if (device.StateGroup.Internal == DS_BOOTING_ADC)
     {
-        if (elapsed_ms > EVERT_CONSTANT_DEVICE_ADC_BOOT_TIME)
+        bool settled = EVERT_DEVICE_Derived_IsAdcSettled();
+
+        if (settled || elapsed_ms > EVERT_CONSTANT_DEVICE_ADC_BOOT_TIME)
         {
-            EVERT_DEVICE_State_Set(SS_INTERNAL, DS_BOOTING_COMMS);
+            device_boot_timing.AdcTimeout = !settled;
+            EVERT_DEVICE_PostEvent(DE_BOOT_ADC_DONE);
         }
     }
+
+    // Propagated state sent with the CCU heartbeat
+    EVERT_DEVICE_StateTypeDef propagated = (EVERT_DEVICE_StateTypeDef)machine->HeartbeatPropagated;
+
+    if (propagated != device.StateGroup.Propagated)
+    {
+        EVERT_DEVICE_State_Set(SS_PROPAGATED, propagated);
+    }
+
+    // Heartbeat supervision once the CCU acknowledged the device, the CCU state is unknown without it
+    if (EVERT_SETTING_DEVICE_HEARTBEAT_TIMEOUT > 0 && (DS_MASK(device.StateGroup.Internal) & DS_MASK_RUNNING) != 0 &&
+        HAL_GetTick() - machine->HeartbeatTick > EVERT_SETTING_DEVICE_HEARTBEAT_TIMEOUT)
+    {
+        machine->HeartbeatPropagated = DS_UNKNOWN;
+        EVERT_DEVICE_State_Set(SS_PROPAGATED, DS_UNKNOWN);
+        EVERT_DEVICE_PostEvent(DE_HEARTBEAT_TIMEOUT);
+    }
+
+    // Bounded: at most one queue worth of events per pass, the rest waits for the next one
+    for (uint32_t i = 0; i < EVERT_CONSTANT_DEVICE_EVENT_QUEUE_SIZE && machine->EventTail != machine->EventHead; i++)
+    {
+        EVERT_DEVICE_EventTypeDef event = (EVERT_DEVICE_EventTypeDef)machine->Events[machine->EventTail & (EVERT_CONSTANT_DEVICE_EVENT_QUEUE_SIZE - 1)];
+        machine->EventTail++;
+
+        EVERT_DEVICE_State_Dispatch(event);
+    }
+}
+
+/// @brief Queue a state machine event, any context
+/// @param event The event, handled by the next EVERT_DEVICE_Update
+void EVERT_DEVICE_PostEvent(const EVERT_DEVICE_EventTypeDef event)
+{
+    EVERT_DEVICE_StateMachineTypeDef *machine = &device.StateMachine;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (machine->EventHead - machine->EventTail < EVERT_CONSTANT_DEVICE_EVENT_QUEUE_SIZE)
+    {
+        machine->Events[machine->EventHead & (EVERT_CONSTANT_DEVICE_EVENT_QUEUE_SIZE - 1)] = (uint8_t)event;
+        machine->EventHead++;
+    }
+    else
+    {
+        machine->EventOverflowCount++;
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/// @brief Re-evaluate the alarms, call from the LF ISR
+void EVERT_DEVICE_OnLfTick()
+{
+    if (!device.StateMachine.AlarmCheckPending)
+    {
+        device.StateMachine.AlarmCheckPending = true;
+        EVERT_DEVICE_PostEvent(DE_ALARM_CHECK);
+    }
+}
+
+/// @brief CCU heartbeat, any context
+/// @param propagated_state State the CCU propagates to the device
+void EVERT_DEVICE_Heartbeat(const EVERT_DEVICE_StateTypeDef propagated_state)
+{
+    device.StateMachine.HeartbeatTick = HAL_GetTick();
+    device.StateMachine.HeartbeatPropagated = propagated_state <= DS_EMERGENCY_SHUTDOWN ? (uint8_t)propagated_state : DS_UNKNOWN;
 }
 
 //
 // #endregion "Device"
 //
 
+//
+// #region "Peripheral Status"
+//
+
+/// @brief Refresh the peripheral status from the application, call from the main loop
+void EVERT_DEVICE_PeripheralStatus_Update()
+{
+    EVERT_DEVICE_PeripheralStatus_PopulateObject(&device.PeripheralStatus);
+}
+
+const EVERT_DEVICE_PeripheralStatusTypeDef *EVERT_DEVICE_PeripheralStatus_Get()
+{
+    return &device.PeripheralStatus;
+}
+
+/// @brief Any HAL error code set or a CAN controller bus-off
+bool EVERT_DEVICE_PeripheralStatus_HasError(EVERT_DEVICE_PeripheralStatusTypeDef *status)
+{
+    uint32_t error_codes = status->Adc1ErrorCode | status->Adc2ErrorCode | status->Adc3ErrorCode | status->Adc4ErrorCode | status->Adc5ErrorCode |
+                           status->Can1ErrorCode | status->Can2ErrorCode | status->Can3ErrorCode |
+                           status->DmaAdc1ErrorCode | status->DmaAdc2ErrorCode | status->DmaAdc3ErrorCode |
+                           status->FlashErrorCode | status->I2c1ErrorCode | status->Lpuart1ErrorCode | status->Huart3ErrorCode;
+    uint32_t bus_off = (status->Can1Psr | status->Can2Psr | status->Can3Psr) & FDCAN_PSR_BO;
+
+    return error_codes != 0 || bus_off != 0;
+}
+
+/// @brief Fill in the peripherals the application uses, the reset cause stays as EVERT_DEVICE_Init found it
+__weak void EVERT_DEVICE_PeripheralStatus_PopulateObject(EVERT_DEVICE_PeripheralStatusTypeDef *status)
+{
+    UNUSED(status);
+}
+
+//
+// #endregion "Peripheral Status"
+//
+
 //
 // #region "Device State Machine"
 //
@@ -142,37 +315,225 @@ EVERT_DEVICE_StateTypeDef EVERT_DEVICE_State_Get(const EVERT_DEVICE_StateScopeTy
     case SS_PROPAGATED:
         return device.StateGroup.Propagated;
 
+    case SS_RESULT:
+        return device.StateGroup.Result;
+
     default:
         return DS_UNKNOWN;
     }
-
-    return device.StateGroup.Result;
 }
 
-/// @brief Check the Device Alarm Register for any alarms
-/// @return The Device State
+/// @brief Check the Device Alarm Register and the derived device alarms for any alarms
+/// @return The Device State, the worst of both
 EVERT_DEVICE_StateTypeDef EVERT_DEVICE_Alarm_Check()
 {
+    EVERT_DEVICE_StateTypeDef level = DS_OPERATIONAL;
+
     // Emergency Shutdown - Critical Alarms
     if (EVERT_SR_IsAnyBitSet(&device.AlarmRegister1, device_emergency_shutdown_alarms, sizeof(device_emergency_shutdown_alarms) / sizeof(device_emergency_shutdown_alarms[0])))
     {
-        return DS_EMERGENCY_SHUTDOWN;
+        level = DS_EMERGENCY_SHUTDOWN;
     }
 
     // Non-operational - Generic/HAL Alarms
-    if (EVERT_SR_IsAnyBitSet(&device.AlarmRegister1, device_non_operational_alarms, sizeof(device_non_operational_alarms) / sizeof(device_non_operational_alarms[0])))
+    else if (EVERT_SR_IsAnyBitSet(&device.AlarmRegister1, device_non_operational_alarms, sizeof(device_non_operational_alarms) / sizeof(device_non_operational_alarms[0])))
     {
-        return DS_NON_OPERATIONAL;
+        level = DS_NON_OPERATIONAL;
     }
 
     // Warning Alarms - Operational Warning
-    if (EVERT_SR_IsAnyBitSet(&device.AlarmRegister1, device_operational_warning_alarms, sizeof(device_operational_warning_alarms) / sizeof(device_operational_warning_alarms[0])))
+    else if (EVERT_SR_IsAnyBitSet(&device.AlarmRegister1, device_operational_warning_alarms, sizeof(device_operational_warning_alarms) / sizeof(device_operational_warning_alarms[0])))
     {
-        return DS_OPERATIONAL_WARNING;
+        level = DS_OPERATIONAL_WARNING;
     }
 
-    // No alarm - Operational
-    return DS_OPERATIONAL;
+    // Derived device alarms, the state values are ordered by severity from DS_OPERATIONAL up
+    EVERT_DEVICE_StateTypeDef derived = EVERT_DEVICE_Derived_Alarm_Check();
+
+    return derived > level ? derived : level;
+}
+
+/// @brief Set or clear a Device Alarm, picked up by the next alarm check
+/// @param index The alarm
+/// @param is_set Set or clear
+void EVERT_DEVICE_Alarm_Set(const EVERT_DEVICE_AlarmRegister1IndexTypeDef index, const bool is_set)
+{
+    if (is_set)
+    {
+        EVERT_SR_SetBit(&device.AlarmRegister1, index);
+    }
+    else
+    {
+        EVERT_SR_ClearBit(&device.AlarmRegister1, index);
+    }
+}
+
+/// @brief The Device Alarm Register
+/// @return One bit per EVERT_DEVICE_AlarmRegister1IndexTypeDef
+uint32_t EVERT_DEVICE_Alarm_Get()
+{
+    return EVERT_SR_GetRegister(&device.AlarmRegister1);
+}
+
+/// @brief Run an event through the transition table (main loop)
+/// @param event The event
+static void EVERT_DEVICE_State_Dispatch(const EVERT_DEVICE_EventTypeDef event)
+{
+    EVERT_DEVICE_EventTypeDef resolved = event;
+
+    // The alarm check resolves to the alarm level event
+    if (event == DE_ALARM_CHECK)
+    {
+        device.StateMachine.AlarmCheckPending = false;
+        device.StateMachine.AlarmLevel = EVERT_DEVICE_Alarm_Check();
+
+        switch (device.StateMachine.AlarmLevel)
+        {
+        case DS_EMERGENCY_SHUTDOWN:
+            resolved = DE_ALARMS_EMERGENCY;
+            break;
+
+        case DS_NON_OPERATIONAL:
+            resolved = DE_ALARMS_NON_OPERATIONAL;
+            break;
+
+        case DS_OPERATIONAL_WARNING:
+            resolved = DE_ALARMS_WARNING;
+            break;
+
+        default:
+            resolved = DE_ALARMS_CLEAR;
+            break;
+        }
+
+        if (device.StateMachine.AlarmLevel >= DS_NON_OPERATIONAL)
+        {
+            device.StateMachine.AlarmNonOperationalTick = HAL_GetTick();
+        }
+    }
+
+    const EVERT_DEVICE_StateTypeDef from = device.StateGroup.Internal;
+
+    for (uint32_t i = 0; i < sizeof(device_transitions) / sizeof(device_transitions[0]); i++)
+    {
+        const EVERT_DEVICE_TransitionTypeDef *transition = &device_transitions[i];
+
+        if ((transition->from & DS_MASK(from)) == 0 || transition->event != resolved)
+        {
+            continue;
+        }
+
+        if (transition->guard != NULL && !transition->guard(from))
+        {
+            continue;
+        }
+
+        if (transition->to != from)
+        {
+            EVERT_DEVICE_State_Set(SS_INTERNAL, transition->to);
+            EVERT_DEVICE_State_OnEnterInternal(transition->to);
+        }
+
+        return;
+    }
+}
+
+/// @brief Internal state entry actions, completion events are queued rather than run recursively
+/// @param state The new internal state
+static void EVERT_DEVICE_State_OnEnterInternal(const EVERT_DEVICE_StateTypeDef state)
+{
+    EVERT_DEVICE_BootTiming_OnEnterInternal(state);
+
+    switch (state)
+    {
+    case DS_BOOTING_DONE:
+        EVERT_DEVICE_PostEvent(DE_BOOT_DONE);
+        break;
+
+    case DS_HANDSHAKE_ANNOUNCING:
+        // Announce until acknowledged, nothing else goes out to a CCU that does not know the device
+        EVERT_TASK_SCHEDULER_PauseTask(EVERT_TASK_SEND_DATA);
+        EVERT_TASK_SCHEDULER_PauseTask(EVERT_TASK_SEND_DEVICE_STATUS);
+        EVERT_TASK_SCHEDULER_PauseTask(EVERT_TASK_SEND_PING);
+        EVERT_TASK_SCHEDULER_ResumeTask(EVERT_TASK_SEND_ANNOUNCEMENT);
+        EVERT_TASK_SCHEDULER_TriggerTask(EVERT_TASK_SEND_ANNOUNCEMENT);
+        break;
+
+    case DS_HANDSHAKE_ACKNOWLEDGED:
+        // Stop the announcement task, start the ping, data and status task
+        EVERT_TASK_SCHEDULER_PauseTask(EVERT_TASK_SEND_ANNOUNCEMENT);
+        EVERT_TASK_SCHEDULER_ResumeTask(EVERT_TASK_SEND_DATA);
+        EVERT_TASK_SCHEDULER_ResumeTask(EVERT_TASK_SEND_DEVICE_STATUS);
+        EVERT_TASK_SCHEDULER_ResumeTask(EVERT_TASK_SEND_PING);
+
+        // The acknowledgement counts as the first heartbeat, the alarms decide where to go from here
+        device.StateMachine.HeartbeatTick = HAL_GetTick();
+        device.StateMachine.AlarmCheckPending = true;
+        EVERT_DEVICE_PostEvent(DE_ALARM_CHECK);
+        break;
+
+    default:
+        break;
+    }
+}
+
+/// @brief Close the boot phase the device left, until it got operational once
+/// @param state The new internal state
+static void EVERT_DEVICE_BootTiming_OnEnterInternal(const EVERT_DEVICE_StateTypeDef state)
+{
+    EVERT_DEVICE_BootTimingTypeDef *timing = &device_boot_timing;
+
+    if (timing->OperationalMs != 0)
+    {
+        return;
+    }
+
+    uint32_t now = HAL_GetTick();
+    uint32_t phase_ms = now - timing->PhaseTick;
+
+    switch (state)
+    {
+    case DS_BOOTING_COMMS:
+        timing->AdcMs = phase_ms;
+        break;
+
+    case DS_BOOTING_DONE:
+        timing->CommsMs = phase_ms;
+        break;
+
+    case DS_HANDSHAKE_ACKNOWLEDGED:
+        timing->HandshakeMs = phase_ms;
+        break;
+
+    case DS_OPERATIONAL:
+    case DS_OPERATIONAL_WARNING:
+        timing->OperationalMs = now - timing->InitMs;
+        break;
+
+    default:
+        break;
+    }
+
+    timing->PhaseTick = now;
+}
+
+/// @brief Leave DS_NON_OPERATIONAL only after EVERT_SETTING_DEVICE_RECOVERY_TIME without non-operational alarms
+static bool EVERT_DEVICE_Guard_Recovered(const EVERT_DEVICE_StateTypeDef from)
+{
+    if (from != DS_NON_OPERATIONAL)
+    {
+        return true;
+    }
+
+    return HAL_GetTick() - device.StateMachine.AlarmNonOperationalTick >= EVERT_SETTING_DEVICE_RECOVERY_TIME;
+}
+
+/// @brief Leave DS_EMERGENCY_SHUTDOWN only with the critical alarms gone
+static bool EVERT_DEVICE_Guard_NoEmergencyAlarm(const EVERT_DEVICE_StateTypeDef from)
+{
+    UNUSED(from);
+
+    return EVERT_DEVICE_Alarm_Check() != DS_EMERGENCY_SHUTDOWN;
 }
 
 /// @brief Set the Device State
@@ -199,7 +560,7 @@ void EVERT_DEVICE_State_Set(const EVERT_DEVICE_StateScopeTypeDef scope, const EV
         break;
     }
 
-    // Update the resultant state
+    // Update the resultant state, a propagated DS_UNKNOWN (heartbeat timeout) leaves the internal state in charge
     if (device.StateGroup.Propagated == DS_NON_OPERATIONAL || device.StateGroup.Propagated == DS_EMERGENCY_SHUTDOWN)
     {
         device.StateGroup.Result = device.StateGroup.Propagated;
@@ -209,8 +570,6 @@ void EVERT_DEVICE_State_Set(const EVERT_DEVICE_StateScopeTypeDef scope, const EV
         device.StateGroup.Result = device.StateGroup.Internal;
     }
 
-    // TODO: Add logic for state propagation based on unknown/ping timeout
-
     // If the resultant state changed from the old state, call the OnDeviceStateChange method
     if (device.StateGroup.Result != old_state)
     {
@@ -220,6 +579,10 @@ void EVERT_DEVICE_State_Set(const EVERT_DEVICE_StateScopeTypeDef scope, const EV
 
 static void EVERT_DEVICE_OnDeviceStateChange(const EVERT_DEVICE_StateTypeDef new_state, const EVERT_DEVICE_StateTypeDef old_state)
 {
+#if EVERT_HAL_CONF_FAULT_RECORD_ENABLE
+    EVERT_FAULT_RECORD_LogEvent(FRE_STATE, (uint8_t)new_state, (uint8_t)old_state, 0);
+#endif
+
     switch (new_state)
     {
     case DS_UNKNOWN:
@@ -295,33 +658,18 @@ static void EVERT_DEVICE_OnEnterState_BootingDone()
 {
     // Derived class callback
     EVERT_DEVICE_Derived_OnEnterState_BootingDone();
-
-    // Set the device state to Handshake Announcing
-    EVERT_DEVICE_State_Set(SS_INTERNAL, DS_HANDSHAKE_ANNOUNCING);
 }
 
 static void EVERT_DEVICE_OnEnterState_HandshakeAnnouncing()
 {
-    // Start the announcement task
-    EVERT_TASK_SCHEDULER_ResumeTask(EVERT_TASK_SEND_ANNOUNCEMENT);
-
     // Derived class callback
     EVERT_DEVICE_Derived_OnEnterState_HandshakeAnnouncing();
 }
 
 static void EVERT_DEVICE_OnEnterState_HandshakeAcknowledged(const EVERT_DEVICE_StateTypeDef previous_state)
 {
-    // Stop the announcement task
-    EVERT_TASK_SCHEDULER_PauseTask(EVERT_TASK_SEND_ANNOUNCEMENT);
-
-    // Start the ping, data and status task
-    EVERT_TASK_SCHEDULER_ResumeTask(EVERT_TASK_SEND_DATA);
-    EVERT_TASK_SCHEDULER_ResumeTask(EVERT_TASK_SEND_DEVICE_STATUS);
-    EVERT_TASK_SCHEDULER_ResumeTask(EVERT_TASK_SEND_PING);
-
     // Derived class callback
     EVERT_DEVICE_Derived_OnEnterState_HandshakeAcknowledged(previous_state);
-    EVERT_DEVICE_State_Set(SS_INTERNAL, DS_NON_OPERATIONAL);
 }
 
 static void EVERT_DEVICE_OnEnterState_Operational(const EVERT_DEVICE_StateTypeDef previous_state)
@@ -348,6 +696,12 @@ static void EVERT_DEVICE_OnEnterState_EmergencyShutdown(const EVERT_DEVICE_State
     EVERT_DEVICE_Derived_OnEnterState_EmergencyShutdown(previous_state);
 }
 
+/// @brief Readings settled (sample count, filters filled), DS_BOOTING_ADC waits EVERT_CONSTANT_DEVICE_ADC_BOOT_TIME without it
+__weak bool EVERT_DEVICE_Derived_IsAdcSettled()
+{
+    return false;
+}
+
 __weak void EVERT_DEVICE_Derived_OnDeviceStateChange(const EVERT_DEVICE_StateTypeDef new_state, const EVERT_DEVICE_StateTypeDef old_state)
 {
     UNUSED(new_state);
@@ -378,6 +732,10 @@ __weak void EVERT_DEVICE_Derived_OnEnterState_EmergencyShutdown(const EVERT_DEVI
 {
     UNUSED(previous_state);
 }
+__weak EVERT_DEVICE_StateTypeDef EVERT_DEVICE_Derived_Alarm_Check()
+{
+    return DS_OPERATIONAL;
+}
 
 //
 // #endregion "Device State Machine"
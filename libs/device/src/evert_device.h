@@ -29,6 +29,53 @@ typedef struct
     EVERT_DEVICE_StateTypeDef Result;
 } EVERT_DEVICE_StateGroupTypeDef;
 
+/// @brief Device State Machine Event Definition
+/// @details Posted from any context (EVERT_DEVICE_PostEvent), the transitions run in EVERT_DEVICE_Update
+typedef enum
+{
+    DE_NONE = 0,
+    DE_BOOT_ADC_DONE = 1,          // Readings settled (application) or EVERT_CONSTANT_DEVICE_ADC_BOOT_TIME elapsed
+    DE_BOOT_COMMS_DONE = 2,        // Communication peripherals up (application)
+    DE_BOOT_DONE = 3,              // Posted on entering DS_BOOTING_DONE
+    DE_HANDSHAKE_ACK = 4,          // CCU acknowledged the announcement
+    DE_HEARTBEAT_TIMEOUT = 5,      // No CCU heartbeat within EVERT_SETTING_DEVICE_HEARTBEAT_TIMEOUT
+    DE_ALARM_CHECK = 6,            // LF tick, re-evaluate the alarms (EVERT_DEVICE_Alarm_Check)
+    DE_ALARMS_CLEAR = 7,           // Alarm level, from DE_ALARM_CHECK
+    DE_ALARMS_WARNING = 8,         // Alarm level, from DE_ALARM_CHECK
+    DE_ALARMS_NON_OPERATIONAL = 9, // Alarm level, from DE_ALARM_CHECK
+    DE_ALARMS_EMERGENCY = 10,      // Alarm level, from DE_ALARM_CHECK
+    DE_RESET = 11                  // CCU cleared an emergency shutdown
+} EVERT_DEVICE_EventTypeDef;
+
+/// @brief Device State Machine Transition Definition
+/// @details First row matching the internal state (from mask), the event and the guard (NULL = none) wins
+typedef struct
+{
+    uint16_t from; // 1 << EVERT_DEVICE_StateTypeDef per state
+    EVERT_DEVICE_EventTypeDef event;
+    bool (*guard)(const EVERT_DEVICE_StateTypeDef from);
+    EVERT_DEVICE_StateTypeDef to;
+} EVERT_DEVICE_TransitionTypeDef;
+
+/// @brief Device State Machine Definition
+typedef struct
+{
+    // Event queue (multiple producers, short critical section on post)
+    volatile uint8_t Events[EVERT_CONSTANT_DEVICE_EVENT_QUEUE_SIZE];
+    volatile uint32_t EventHead;
+    volatile uint32_t EventTail;
+    uint32_t EventOverflowCount;
+    volatile bool AlarmCheckPending;
+
+    // CCU heartbeat
+    volatile uint32_t HeartbeatTick;
+    volatile uint8_t HeartbeatPropagated; // Propagated state sent with the last heartbeat, applied in EVERT_DEVICE_Update
+
+    // Alarms
+    EVERT_DEVICE_StateTypeDef AlarmLevel;
+    uint32_t AlarmNonOperationalTick; // Last alarm check at DS_NON_OPERATIONAL or worse
+} EVERT_DEVICE_StateMachineTypeDef;
+
 /// @brief Device Peripheral Status Definition
 typedef struct
 {
@@ -82,6 +129,19 @@ typedef struct
 
 } EVERT_DEVICE_PeripheralStatusTypeDef;
 
+/// @brief Device Boot Timing Definition
+/// @details Duration of each boot phase in milliseconds, recorded once per boot: a handshake lost later does not count
+typedef struct
+{
+    uint32_t InitMs;        // HAL tick at EVERT_DEVICE_Init, on the target the time from the reset (clocks, HAL, fault record)
+    uint32_t AdcMs;         // DS_BOOTING_ADC: the readings settling
+    uint32_t CommsMs;       // DS_BOOTING_COMMS
+    uint32_t HandshakeMs;   // DS_HANDSHAKE_ANNOUNCING until the CCU acknowledged
+    uint32_t OperationalMs; // EVERT_DEVICE_Init to the first DS_OPERATIONAL or DS_OPERATIONAL_WARNING, 0 = not yet
+    uint32_t PhaseTick;     // Current phase entered
+    bool AdcTimeout;        // DS_BOOTING_ADC left on EVERT_CONSTANT_DEVICE_ADC_BOOT_TIME, the readings never settled
+} EVERT_DEVICE_BootTimingTypeDef;
+
 /// @brief Base Device Type Definition
 typedef struct
 {
@@ -89,8 +149,12 @@ typedef struct
     EVERT_SR_RegisterTypeDefinitionTypeDef AlarmRegister1; // Alarm Register 1
     EVERT_DEVICE_PeripheralStatusTypeDef PeripheralStatus;
     EVERT_DEVICE_StateGroupTypeDef StateGroup;
+    EVERT_DEVICE_StateMachineTypeDef StateMachine;
 } EVERT_DEVICE_BaseDeviceTypeDef;
 
+extern EVERT_DEVICE_BootTimingTypeDef device_boot_timing;
+
+bool EVERT_DEVICE_Derived_IsAdcSettled();
 void EVERT_DEVICE_Derived_OnDeviceStateChange(const EVERT_DEVICE_StateTypeDef new_state, const EVERT_DEVICE_StateTypeDef old_state);
 void EVERT_DEVICE_Derived_OnEnterState_Booting();
 void EVERT_DEVICE_Derived_OnEnterState_BootingAdc();
@@ -102,12 +166,19 @@ void EVERT_DEVICE_Derived_OnEnterState_Operational(const EVERT_DEVICE_StateTypeD
 void EVERT_DEVICE_Derived_OnEnterState_OperationalWarning(const EVERT_DEVICE_StateTypeDef previous_state);
 void EVERT_DEVICE_Derived_OnEnterState_NonOperational(const EVERT_DEVICE_StateTypeDef previous_state);
 void EVERT_DEVICE_Derived_OnEnterState_EmergencyShutdown(const EVERT_DEVICE_StateTypeDef previous_state);
+EVERT_DEVICE_StateTypeDef EVERT_DEVICE_Derived_Alarm_Check();
 
 void EVERT_DEVICE_Init();
 void EVERT_DEVICE_SetVersionInfo(const uint8_t major, const uint8_t minor, const uint8_t patch);
 void EVERT_DEVICE_Update(const uint32_t elapsed_ms, const uint32_t delta_ms);
 
+void EVERT_DEVICE_PostEvent(const EVERT_DEVICE_EventTypeDef event);
+void EVERT_DEVICE_OnLfTick();
+void EVERT_DEVICE_Heartbeat(const EVERT_DEVICE_StateTypeDef propagated_state);
+
 EVERT_DEVICE_StateTypeDef EVERT_DEVICE_Alarm_Check();
+void EVERT_DEVICE_Alarm_Set(const EVERT_DEVICE_AlarmRegister1IndexTypeDef index, const bool is_set);
+uint32_t EVERT_DEVICE_Alarm_Get();
 void EVERT_DEVICE_State_Set(const EVERT_DEVICE_StateScopeTypeDef scope, const EVERT_DEVICE_StateTypeDef state);
 EVERT_DEVICE_StateTypeDef EVERT_DEVICE_State_Get(const EVERT_DEVICE_StateScopeTypeDef scope);
 
@@ -121,5 +192,7 @@ EVERT_DEVICE_StateTypeDef EVERT_DEVICE_State_Get(const EVERT_DEVICE_StateScopeTy
 
 void EVERT_DEVICE_PeripheralStatus_PopulateObject(EVERT_DEVICE_PeripheralStatusTypeDef *status);
 bool EVERT_DEVICE_PeripheralStatus_HasError(EVERT_DEVICE_PeripheralStatusTypeDef *status);
+void EVERT_DEVICE_PeripheralStatus_Update();
+const EVERT_DEVICE_PeripheralStatusTypeDef *EVERT_DEVICE_PeripheralStatus_Get();
 
 #endif // EVERT_DEVICE_H_
\ No newline at end of file
@@ -0,0 +1,341 @@
+"""
+Decoder for the binary telemetry stream (libs/core/src/telemetry.h).
+
+Frame:  COBS(record) 0x00
+Record: [schema u8][sequence u8][tick u32][payload][crc32 u32], little endian,
+        CRC-32 (IEEE, zlib.crc32) over everything before it.
+
+The schema table mirrors the payload structs in inverter/src/inverter_telemetry.h,
+inverter/src/inverter_scope.h and inverter/src/inverter_registry.h, keep them in sync.
+
+Registry requests go the other way on the same port, framed the same way
+(encode_request). Variable names are matched by their FNV-1a hash (name_hash).
+
+Usage:
+    python telemetry_decoder.py --port COM5 --out log            # live, 921600 baud
+    python telemetry_decoder.py --file capture.bin --out log     # raw capture
+    python telemetry_decoder.py --file capture.bin --out log --parquet
+    python telemetry_decoder.py --port COM5 --out log --list --subscribe 0x0001:10
+
+Writes one file per schema (log_fast.csv, log_slow.csv, ...), scope captures
+are written as log_scope_<n>.csv once complete.
+"""
+
+import argparse
+import csv
+import struct
+import sys
+import zlib
+
+HEADER = struct.Struct('<BBI')
+CRC = struct.Struct('<I')
+
+SCOPE_CHANNELS = ['current_u', 'current_v', 'current_w',
+                  'voltage_grid_u', 'voltage_grid_v', 'voltage_grid_w',
+                  'duty_a', 'duty_b', 'duty_c', 'theta']
+
+# schema id: (name, struct format, field names)
+SCHEMAS = {
+    1: ('fast', '<I12f', ['sample', 'current_u', 'current_v', 'current_w',
+                          'voltage_grid_u', 'voltage_grid_v', 'voltage_grid_w',
+                          'bus_voltage', 'bus_voltage_mid',
+                          'duty_a', 'duty_b', 'duty_c', 'theta']),
+    2: ('slow', '<8f3I', ['temperature_heatsink', 'temperature_coil', 'temperature_ambient',
+                          'temperature_junction_max', 'fan_demand', 'derating',
+                          'current_limit_thermal', 'current_limit_junction',
+                          'fan_failed_count', 'drop_count', 'error_count']),
+    3: ('scope_header', '<HHHBBIf', ['count', 'trigger_offset', 'decimation', 'channel_count',
+                                     'trigger_source', 'trigger_tick', 'sample_period']),
+    4: ('scope_sample', '<HH10f', ['index', 'reserved'] + SCOPE_CHANNELS),
+    6: ('registry_reply', '<BBHIBBBBI', ['operation', 'status', 'id', 'value', 'type', 'access',
+                                         'slot', 'reserved', 'name_hash']),
+    9: ('fault_chunk', '<BBHHHI48s', ['index', 'type', 'offset', 'size', 'length', 'reset_cause', 'data']),
+}
+
+SCHEMA_REGISTRY_REQUEST = 5
+SCHEMA_REGISTRY_REPLY = 6
+SCHEMA_REGISTRY_STREAM = 7  # [slot u8][value 1/2/4 bytes]..., variable length
+SCHEMA_FAULT_REQUEST = 8
+SCHEMA_FAULT_CHUNK = 9
+
+REGISTRY_READ, REGISTRY_WRITE, REGISTRY_SUBSCRIBE, REGISTRY_LIST = 1, 2, 3, 4
+REGISTRY_REQUEST = struct.Struct('<BBHI')
+
+# EVERT_REGISTRY_TypeTypeDef: (struct format, size)
+REGISTRY_TYPES = {0: ('<B', 1), 1: ('<b', 1), 2: ('<H', 2), 3: ('<h', 2),
+                  4: ('<I', 4), 5: ('<i', 4), 6: ('<f', 4), 7: ('<?', 1)}
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data) + 1:
+            raise ValueError('invalid COBS code')
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def cobs_encode(data):
+    out = bytearray()
+    block = bytearray()
+    for byte in data:
+        if byte == 0:
+            out += bytes([len(block) + 1]) + block
+            block = bytearray()
+            continue
+        block.append(byte)
+        if len(block) == 0xFE:
+            out += bytes([0xFF]) + block
+            block = bytearray()
+    out += bytes([len(block) + 1]) + block
+    return bytes(out)
+
+
+def name_hash(name):
+    """FNV-1a of the variable expression as registered (EVERT_REGISTRY_HASH), e.g. 'fi_bus_voltage'."""
+    h = 2166136261
+    for byte in name.encode()[:48]:
+        h = ((h ^ byte) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def encode_request(operation, id, value=0, sequence=0, tick=0):
+    """Frame for an ITS_REGISTRY_REQUEST, ready to write to the port."""
+    body = HEADER.pack(SCHEMA_REGISTRY_REQUEST, sequence, tick) + REGISTRY_REQUEST.pack(operation, 0, id, value & 0xFFFFFFFF)
+    return cobs_encode(body + CRC.pack(zlib.crc32(body) & 0xFFFFFFFF)) + b'\x00'
+
+
+def encode_fault_request(index, sequence=0, tick=0):
+    """Frame for an ITS_FAULT_REQUEST, index 0 is the newest record."""
+    body = HEADER.pack(SCHEMA_FAULT_REQUEST, sequence, tick) + bytes([index])
+    return cobs_encode(body + CRC.pack(zlib.crc32(body) & 0xFFFFFFFF)) + b'\x00'
+
+
+def registry_value(type, value):
+    """Reply value (u32 bits) as the variable's type."""
+    fmt, size = REGISTRY_TYPES.get(type, ('<I', 4))
+    return struct.unpack(fmt, struct.pack('<I', value & 0xFFFFFFFF)[:size])[0]
+
+
+def decode_stream(payload, slots):
+    """[slot][value]... -> [(id, value)], slots maps slot -> (id, type) from the subscribe replies."""
+    values = []
+    i = 0
+    while i < len(payload):
+        slot = payload[i]
+        if slot not in slots:
+            raise ValueError('stream: unknown slot %d' % slot)
+        id, type = slots[slot]
+        fmt, size = REGISTRY_TYPES.get(type, ('<I', 4))
+        values.append((id, struct.unpack(fmt, payload[i + 1:i + 1 + size])[0]))
+        i += 1 + size
+    return values
+
+
+def decode_record(frame):
+    """Returns (schema, sequence, tick, fields dict) or raises ValueError."""
+    record = cobs_decode(frame)
+    if len(record) < HEADER.size + CRC.size:
+        raise ValueError('short record')
+
+    body, (crc,) = record[:-CRC.size], CRC.unpack(record[-CRC.size:])
+    if zlib.crc32(body) & 0xFFFFFFFF != crc:
+        raise ValueError('CRC mismatch')
+
+    schema, sequence, tick = HEADER.unpack(body[:HEADER.size])
+    payload = body[HEADER.size:]
+
+    if schema not in SCHEMAS:
+        return schema, sequence, tick, {'raw': payload}
+
+    name, fmt, fields = SCHEMAS[schema]
+    if struct.calcsize(fmt) != len(payload):
+        raise ValueError('schema %s: %d bytes, expected %d' % (name, len(payload), struct.calcsize(fmt)))
+
+    return schema, sequence, tick, dict(zip(fields, struct.unpack(fmt, payload)))
+
+
+def frames(stream):
+    """Split a byte stream on 0x00, yields the frames in between."""
+    buffer = bytearray()
+    while True:
+        chunk = stream.read(4096)
+        if not chunk:
+            break
+        buffer += chunk
+        while True:
+            end = buffer.find(0)
+            if end < 0:
+                break
+            if end > 0:
+                yield bytes(buffer[:end])
+            del buffer[:end + 1]
+
+
+class Writer:
+    """One CSV per schema, optionally converted to Parquet at the end."""
+
+    def __init__(self, prefix, parquet):
+        self.prefix = prefix
+        self.parquet = parquet
+        self.files = {}
+        self.writers = {}
+        self.scope_header = None
+        self.scope_rows = []
+        self.scope_count = 0
+        self.slots = {}
+        self.fault = bytearray()
+
+    def write(self, name, row):
+        if name not in self.writers:
+            path = '%s_%s.csv' % (self.prefix, name)
+            self.files[name] = open(path, 'w', newline='')
+            self.writers[name] = csv.DictWriter(self.files[name], fieldnames=list(row.keys()))
+            self.writers[name].writeheader()
+        self.writers[name].writerow(row)
+
+    def scope(self, schema, fields):
+        if schema == 3:
+            self.scope_header = fields
+            self.scope_rows = []
+            return
+
+        if self.scope_header is None:
+            return
+
+        self.scope_rows.append(fields)
+        if len(self.scope_rows) == self.scope_header['count']:
+            path = '%s_scope_%d.csv' % (self.prefix, self.scope_count)
+            offset = self.scope_header['trigger_offset']
+            period = self.scope_header['sample_period']
+            with open(path, 'w', newline='') as f:
+                writer = csv.writer(f)
+                writer.writerow(['time'] + SCOPE_CHANNELS)
+                for row in self.scope_rows:
+                    writer.writerow([(row['index'] - offset) * period] + [row[c] for c in SCOPE_CHANNELS])
+            print('scope capture %d (trigger source %d) -> %s' % (self.scope_count, self.scope_header['trigger_source'], path))
+            self.scope_count += 1
+            self.scope_header = None
+
+    def registry(self, schema, tick, fields):
+        if schema == SCHEMA_REGISTRY_REPLY:
+            if fields['operation'] == REGISTRY_SUBSCRIBE and fields['status'] == 0:
+                if fields['value'] == 0:
+                    self.slots = {slot: entry for slot, entry in self.slots.items() if entry[0] != fields['id'] and fields['id'] != 0xFFFF}
+                else:
+                    self.slots[fields['slot']] = (fields['id'], fields['type'])
+            row = dict(fields)
+            row['value'] = registry_value(fields['type'], fields['value']) if fields['operation'] in (REGISTRY_READ, REGISTRY_WRITE) else fields['value']
+            print('registry: %s' % row)
+            self.write('registry_reply', dict({'tick': tick}, **row))
+            return
+
+        try:
+            values = decode_stream(fields['raw'], self.slots)
+        except (ValueError, struct.error):
+            return
+
+        for id, value in values:
+            self.write('registry_stream', {'tick': tick, 'id': id, 'value': value})
+
+    def fault_chunk(self, fields):
+        if fields['type'] == 0:
+            print('reset cause 0x%08x, no fault record' % fields['reset_cause'])
+            return
+
+        if fields['offset'] == 0:
+            self.fault = bytearray()
+        if fields['offset'] != len(self.fault):
+            return  # Missed a chunk, wait for the next record
+        self.fault += fields['data'][:fields['length']]
+
+        if len(self.fault) == fields['size']:
+            path = '%s_fault_%d.bin' % (self.prefix, fields['index'])
+            with open(path, 'wb') as f:
+                f.write(self.fault)
+            # magic, version, type, boot_count, tick, reset_cause, r0-r3, r12, lr, pc, xpsr
+            record = struct.unpack_from('<IBBHII8I', self.fault)
+            print('fault record %d: type %d, boot %d, reset cause 0x%08x, pc 0x%08x, lr 0x%08x -> %s'
+                  % (fields['index'], record[2], record[3], record[5], record[12], record[11], path))
+
+    def close(self):
+        for f in self.files.values():
+            f.close()
+
+        if self.parquet:
+            import pandas
+            for name in self.files:
+                path = '%s_%s' % (self.prefix, name)
+                pandas.read_csv(path + '.csv').to_parquet(path + '.parquet')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Evert binary telemetry decoder')
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument('--port', help='Serial port (pyserial)')
+    source.add_argument('--file', help='Raw capture file')
+    parser.add_argument('--baud', type=int, default=921600)
+    parser.add_argument('--out', default='telemetry', help='Output file prefix')
+    parser.add_argument('--parquet', action='store_true', help='Also write Parquet (pandas + pyarrow)')
+    parser.add_argument('--list', action='store_true', help='List the registry (--port only)')
+    parser.add_argument('--read', action='append', default=[], metavar='ID', help='Read a variable (--port only)')
+    parser.add_argument('--fault', type=int, action='append', default=[], metavar='INDEX', help='Read a fault record, 0 = newest (--port only)')
+    parser.add_argument('--subscribe', action='append', default=[], metavar='ID:MS', help='Subscribe to a variable, 0 ms unsubscribes (--port only)')
+    args = parser.parse_args()
+
+    if args.port:
+        import serial
+        stream = serial.Serial(args.port, args.baud, timeout=1)
+        requests = [(REGISTRY_READ, int(id, 0), 0) for id in args.read]
+        requests += [(REGISTRY_SUBSCRIBE, int(id, 0), int(period, 0)) for id, period in (s.split(':') for s in args.subscribe)]
+        if args.list:
+            requests += [(REGISTRY_LIST, index, 0) for index in range(256)]  # NOT_FOUND past the end
+        for sequence, (operation, id, value) in enumerate(requests):
+            stream.write(encode_request(operation, id, value, sequence & 0xFF))
+        for index in args.fault:
+            stream.write(encode_fault_request(index))
+    else:
+        stream = open(args.file, 'rb')
+
+    writer = Writer(args.out, args.parquet)
+    sequence = None
+    lost = 0
+    bad = 0
+
+    try:
+        for frame in frames(stream):
+            try:
+                schema, seq, tick, fields = decode_record(frame)
+            except ValueError:
+                bad += 1
+                continue
+
+            if sequence is not None:
+                lost += (seq - sequence - 1) & 0xFF
+            sequence = seq
+
+            if schema in (3, 4):
+                writer.scope(schema, fields)
+            elif schema in (SCHEMA_REGISTRY_REPLY, SCHEMA_REGISTRY_STREAM):
+                writer.registry(schema, tick, fields)
+            elif schema == SCHEMA_FAULT_CHUNK:
+                writer.fault_chunk(fields)
+            else:
+                name = SCHEMAS[schema][0] if schema in SCHEMAS else 'schema_%d' % schema
+                if 'raw' in fields:
+                    fields = {'raw': fields['raw'].hex()}
+                writer.write(name, dict({'tick': tick}, **fields))
+    except KeyboardInterrupt:
+        pass
+    finally:
+        writer.close()
+        print('lost records: %d, bad frames: %d' % (lost, bad), file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()